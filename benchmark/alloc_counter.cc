@@ -0,0 +1,71 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "alloc_counter.h"
+
+#include "serial/utils/V2/allocation_counter.h"
+
+#if !defined(DINGO_SERIAL_COUNT_ALLOCATIONS)
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocation_bytes{0};
+
+void* CountedAlloc(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
+namespace dingodb {
+namespace bench {
+
+// The library replaces operator new itself when it counts allocations, its
+// counts are then those of the calling thread.
+#if defined(DINGO_SERIAL_COUNT_ALLOCATIONS)
+uint64_t AllocationCount() {
+  return serialV2::ThreadAllocationCounts().count;
+}
+uint64_t AllocationBytes() {
+  return serialV2::ThreadAllocationCounts().bytes;
+}
+#else
+uint64_t AllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+uint64_t AllocationBytes() {
+  return allocation_bytes.load(std::memory_order_relaxed);
+}
+#endif
+
+}  // namespace bench
+}  // namespace dingodb
@@ -0,0 +1,72 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_BENCH_ALLOC_COUNTER_H_
+#define DINGO_SERIAL_BENCH_ALLOC_COUNTER_H_
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace dingodb {
+namespace bench {
+
+// Calls of the global operator new so far and the bytes they asked for, over
+// all threads. alloc_counter.cc replaces operator new for the whole
+// benchmark binary.
+uint64_t AllocationCount();
+uint64_t AllocationBytes();
+
+// Counts the allocations of the timed loop of state, Report sets them as the
+// allocs/row and alloc_bytes/row counters over rows_per_iteration rows per
+// iteration.
+class AllocationScope {
+ public:
+  explicit AllocationScope(benchmark::State& state)
+      : state_(state),
+        start_count_(AllocationCount()),
+        start_bytes_(AllocationBytes()) {}
+
+  void Report(int64_t rows_per_iteration) {
+    uint64_t count = AllocationCount() - start_count_;
+    uint64_t bytes = AllocationBytes() - start_bytes_;
+    double rows = static_cast<double>(state_.iterations()) * rows_per_iteration;
+    state_.counters["allocs/row"] = rows > 0 ? count / rows : 0;
+    state_.counters["alloc_bytes/row"] = rows > 0 ? bytes / rows : 0;
+  }
+
+ private:
+  benchmark::State& state_;
+  uint64_t start_count_;
+  uint64_t start_bytes_;
+};
+
+// The common counters of a codec benchmark: rows/s, bytes/s over bytes
+// encoded bytes per iteration, time/row (in seconds, the console prints it
+// scaled, e.g. 1.2us), allocs/row and alloc_bytes/row.
+inline void ReportRows(benchmark::State& state, AllocationScope& allocs,
+                       int64_t rows, int64_t bytes) {
+  state.SetItemsProcessed(state.iterations() * rows);
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.counters["time/row"] = benchmark::Counter(
+      static_cast<double>(rows),
+      benchmark::Counter::kIsIterationInvariantRate |
+          benchmark::Counter::kInvert);
+  allocs.Report(rows);
+}
+
+}  // namespace bench
+}  // namespace dingodb
+
+#endif
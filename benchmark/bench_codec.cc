@@ -0,0 +1,1014 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "serial/record/V2/decode_cache.h"
+#include "serial/record/V2/delta_record.h"
+#include "serial/record/V2/index_key_builder.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/record/V2/row_exporter.h"
+#include "serial/record/V2/scan_decoder.h"
+#include "serial/record/V2/static_record_codec.h"
+#include "serial/record/V2/value_diff.h"
+#include "serial/record/V2/value_rewriter.h"
+#include "serial/record/record_decoder.h"
+#include "serial/record/record_encoder.h"
+#include "serial/utils/V2/latency.h"
+
+/*
+ * Encode, decode, projected decode and key only decode of the same table
+ * with every codec: V1, V2 over std::any and the static V2 codec. Each
+ * iteration walks kRows rows, the counters are per row so that the codecs and
+ * runs compare directly, e.g. with --benchmark_format=json.
+ */
+
+using dingodb::bench::AllocationScope;
+using dingodb::bench::ReportRows;
+using dingodb::serialV2::BaseSchemaPtr;
+using dingodb::serialV2::Column;
+using dingodb::serialV2::ColumnValue;
+using dingodb::serialV2::DecodeCache;
+using dingodb::serialV2::DecodePlan;
+using dingodb::serialV2::DeltaMerger;
+using dingodb::serialV2::DeltaRecordEncoder;
+using dingodb::serialV2::DingoSchema;
+using dingodb::serialV2::ExportFormat;
+using dingodb::serialV2::FromAny;
+using dingodb::serialV2::IndexDefinition;
+using dingodb::serialV2::IndexKeyBuilder;
+using dingodb::serialV2::CycleClock;
+using dingodb::serialV2::Key;
+using dingodb::serialV2::LatencyHistogram;
+using dingodb::serialV2::Nullable;
+using dingodb::serialV2::RecordDecoderV2;
+using dingodb::serialV2::RecordEncoderV2;
+using dingodb::serialV2::RowExporter;
+using dingodb::serialV2::ScanDecoder;
+using dingodb::serialV2::StaticRecordCodec;
+using dingodb::serialV2::Value;
+using dingodb::serialV2::ValueDiff;
+using dingodb::serialV2::ValueRewriter;
+using dingodb::serialV2::ValueSlices;
+
+namespace {
+
+constexpr int64_t kRows = 1000;
+constexpr int kSchemaVersion = 1;
+constexpr long kCommonId = 100;
+
+// id, name, gender, score | addr, exist, pic, test_null, age, prev, salary
+using TableCodec =
+    StaticRecordCodec<Column<int32_t, Key>, Column<std::string, Key>,
+                      Column<std::string, Key>, Column<int64_t, Key>,
+                      Column<std::string, Value, Nullable>, Column<bool, Value>,
+                      Column<std::string, Value, Nullable>,
+                      Column<int32_t, Value, Nullable>, Column<int32_t, Value>,
+                      Column<int64_t, Value>, Column<double, Value, Nullable>>;
+
+// id, age and salary.
+const std::vector<int> kProjection = {0, 8, 10};
+
+using SchemasV1 =
+    std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>;
+
+template <typename T>
+void AddSchemaV1(const SchemasV1& schemas, int index, bool is_key,
+                 bool allow_null) {
+  auto schema = std::make_shared<dingodb::DingoSchema<std::optional<T>>>();
+  schema->SetIndex(index);
+  schema->SetIsKey(is_key);
+  schema->SetAllowNull(allow_null);
+  schemas->push_back(schema);
+}
+
+SchemasV1 MakeSchemasV1() {
+  auto schemas =
+      std::make_shared<std::vector<std::shared_ptr<dingodb::BaseSchema>>>();
+  AddSchemaV1<int32_t>(schemas, 0, true, false);
+  AddSchemaV1<std::shared_ptr<std::string>>(schemas, 1, true, false);
+  AddSchemaV1<std::shared_ptr<std::string>>(schemas, 2, true, false);
+  AddSchemaV1<int64_t>(schemas, 3, true, false);
+  AddSchemaV1<std::shared_ptr<std::string>>(schemas, 4, false, true);
+  AddSchemaV1<bool>(schemas, 5, false, false);
+  AddSchemaV1<std::shared_ptr<std::string>>(schemas, 6, false, true);
+  AddSchemaV1<int32_t>(schemas, 7, false, true);
+  AddSchemaV1<int32_t>(schemas, 8, false, false);
+  AddSchemaV1<int64_t>(schemas, 9, false, false);
+  AddSchemaV1<double>(schemas, 10, false, true);
+  return schemas;
+}
+
+// The same seed on every run, so that runs encode the same bytes.
+std::vector<TableCodec::Row> MakeRows() {
+  std::mt19937 rng(20231014);
+  std::uniform_int_distribution<int> letter('a', 'z');
+  auto random_string = [&](int len) {
+    std::string s(len, ' ');
+    for (auto& c : s) {
+      c = static_cast<char>(letter(rng));
+    }
+    return s;
+  };
+
+  std::vector<TableCodec::Row> rows;
+  rows.reserve(kRows);
+  for (int32_t i = 0; i < kRows; ++i) {
+    rows.emplace_back(i, random_string(32), random_string(8),
+                      214748364700L + i, random_string(64), i % 2 == 0,
+                      std::nullopt, std::nullopt, i % 100, -214748364700L - i,
+                      873485.4234 + i);
+  }
+  return rows;
+}
+
+template <typename T>
+std::any ToAny(const T& field) {
+  return field;
+}
+
+template <typename T>
+std::any ToAny(const std::optional<T>& field) {
+  return field.has_value() ? std::any(*field) : std::any();
+}
+
+std::vector<std::vector<std::any>> MakeRecordsV2() {
+  std::vector<std::vector<std::any>> records;
+  for (const auto& row : MakeRows()) {
+    std::vector<std::any> record;
+    std::apply(
+        [&](const auto&... fields) { (record.push_back(ToAny(fields)), ...); },
+        row);
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+std::vector<std::vector<std::any>> MakeRecordsV1() {
+  std::vector<std::vector<std::any>> records;
+  for (const auto& row : MakeRows()) {
+    auto str = [](const std::optional<std::string>& s) {
+      return s.has_value() ? std::optional<std::shared_ptr<std::string>>(
+                                 std::make_shared<std::string>(*s))
+                           : std::nullopt;
+    };
+    records.push_back({
+        std::optional<int32_t>(std::get<0>(row)),
+        str(std::get<1>(row)),
+        str(std::get<2>(row)),
+        std::optional<int64_t>(std::get<3>(row)),
+        str(std::get<4>(row)),
+        std::optional<bool>(std::get<5>(row)),
+        str(std::get<6>(row)),
+        std::get<7>(row),
+        std::optional<int32_t>(std::get<8>(row)),
+        std::optional<int64_t>(std::get<9>(row)),
+        std::get<10>(row),
+    });
+  }
+  return records;
+}
+
+// Encoded rows of a codec and their total byte count.
+struct EncodedRows {
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  int64_t bytes{0};
+
+  void Add(std::string key, std::string value) {
+    bytes += key.size() + value.size();
+    keys.push_back(std::move(key));
+    values.push_back(std::move(value));
+  }
+
+  int64_t KeyBytes() const {
+    int64_t total = 0;
+    for (const auto& key : keys) {
+      total += key.size();
+    }
+    return total;
+  }
+};
+
+template <typename Encoder>
+EncodedRows EncodeAll(Encoder& encoder,
+                      const std::vector<std::vector<std::any>>& records) {
+  EncodedRows rows;
+  for (const auto& record : records) {
+    std::string key, value;
+    encoder.Encode('r', record, key, value);
+    rows.Add(std::move(key), std::move(value));
+  }
+  return rows;
+}
+
+EncodedRows EncodeAll(const TableCodec& codec,
+                      const std::vector<TableCodec::Row>& table) {
+  EncodedRows rows;
+  for (const auto& row : table) {
+    std::string key, value;
+    codec.Encode('r', row, key, value);
+    rows.Add(std::move(key), std::move(value));
+  }
+  return rows;
+}
+
+// V1
+
+void BM_V1Encode(benchmark::State& state) {
+  auto records = MakeRecordsV1();
+  dingodb::RecordEncoderV1 encoder(kSchemaVersion, MakeSchemasV1(), kCommonId);
+  int64_t bytes = EncodeAll(encoder, records).bytes;
+  std::string key, value;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (const auto& record : records) {
+      encoder.Encode('r', record, key, value);
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+void BM_V1Decode(benchmark::State& state) {
+  auto schemas = MakeSchemasV1();
+  dingodb::RecordEncoderV1 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV1());
+  dingodb::RecordDecoderV1 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      record.clear();
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+void BM_V1DecodeProjected(benchmark::State& state) {
+  auto schemas = MakeSchemasV1();
+  dingodb::RecordEncoderV1 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV1());
+  dingodb::RecordDecoderV1 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      record.clear();
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), kProjection, record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+void BM_V1DecodeKey(benchmark::State& state) {
+  auto schemas = MakeSchemasV1();
+  dingodb::RecordEncoderV1 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV1());
+  dingodb::RecordDecoderV1 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      record.clear();
+      decoder.DecodeKey(std::string_view(rows.keys[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.KeyBytes());
+}
+
+// V2
+
+void BM_V2Encode(benchmark::State& state) {
+  auto records = MakeRecordsV2();
+  RecordEncoderV2 encoder(kSchemaVersion, TableCodec::MakeSchemas(),
+                          kCommonId);
+  int64_t bytes = EncodeAll(encoder, records).bytes;
+  std::string key, value;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (const auto& record : records) {
+      encoder.Encode('r', record, key, value);
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+// The row key and three secondary index keys of each row, by an encoder per
+// key over the index columns and by one IndexKeyBuilder pass.
+std::vector<IndexDefinition> BenchIndexes() {
+  return {{200, {4}}, {201, {7, 8}}, {202, {6, 9}, true}};
+}
+
+// The key columns of an index, followed by the table key unless unique.
+std::vector<int> IndexKeyColumns(const std::vector<BaseSchemaPtr>& schemas,
+                                 const IndexDefinition& index) {
+  std::vector<int> columns = index.columns;
+  if (!index.unique) {
+    for (const auto& schema : schemas) {
+      if (schema->IsKey()) {
+        columns.push_back(schema->GetIndex());
+      }
+    }
+  }
+  return columns;
+}
+
+void BM_V2EncodeIndexKeysSeparate(benchmark::State& state) {
+  auto records = MakeRecordsV2();
+  auto schemas = TableCodec::MakeSchemas();
+  std::vector<std::unique_ptr<RecordEncoderV2>> encoders;
+  std::vector<std::vector<int>> projections;
+  encoders.push_back(
+      std::make_unique<RecordEncoderV2>(kSchemaVersion, schemas, kCommonId));
+  projections.emplace_back();
+  for (const auto& index : BenchIndexes()) {
+    std::vector<int> columns = IndexKeyColumns(schemas, index);
+    std::vector<BaseSchemaPtr> key_schemas;
+    for (int column : columns) {
+      auto schema = schemas[column]->Clone();
+      schema->SetIndex(key_schemas.size());
+      schema->SetIsKey(true);
+      schema->SetAllowNull(schemas[column]->AllowNull());
+      key_schemas.push_back(schema);
+    }
+    encoders.push_back(std::make_unique<RecordEncoderV2>(
+        kSchemaVersion, key_schemas, index.common_id));
+    projections.push_back(columns);
+  }
+  // the index records are projected up front, only the encoding is timed.
+  std::vector<std::vector<std::vector<std::any>>> inputs(records.size());
+  for (size_t r = 0; r < records.size(); ++r) {
+    inputs[r].push_back(records[r]);
+    for (size_t i = 1; i < projections.size(); ++i) {
+      std::vector<std::any> key_record;
+      for (int column : projections[i]) {
+        key_record.push_back(records[r][column]);
+      }
+      inputs[r].push_back(std::move(key_record));
+    }
+  }
+  std::vector<std::string> keys(encoders.size());
+  int64_t bytes = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    bytes = 0;
+    for (const auto& input : inputs) {
+      for (size_t i = 0; i < encoders.size(); ++i) {
+        bytes += encoders[i]->EncodeKey('r', input[i], keys[i]);
+      }
+      benchmark::DoNotOptimize(keys.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+void BM_V2EncodeIndexKeysBuilder(benchmark::State& state) {
+  auto records = MakeRecordsV2();
+  IndexKeyBuilder builder(kCommonId, TableCodec::MakeSchemas(), BenchIndexes());
+  std::vector<std::string> keys;
+  int64_t bytes = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    bytes = 0;
+    for (const auto& record : records) {
+      builder.Build('r', record, keys);
+      for (const auto& key : keys) {
+        bytes += key.size();
+      }
+      benchmark::DoNotOptimize(keys.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+// The rows as CSV lines, by decoding each into std::any and formatting the
+// values, and by RowExporter from the encoded bytes.
+void BM_V2ExportCsvFromAny(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  auto format = [](const std::any& value, std::string& out) {
+    if (!value.has_value()) {
+      return;
+    }
+    if (const auto* s = std::any_cast<std::string>(&value)) {
+      out.append(*s);
+    } else if (const auto* i = std::any_cast<int32_t>(&value)) {
+      out.append(std::to_string(*i));
+    } else if (const auto* l = std::any_cast<int64_t>(&value)) {
+      out.append(std::to_string(*l));
+    } else if (const auto* d = std::any_cast<double>(&value)) {
+      out.append(std::to_string(*d));
+    } else if (const auto* b = std::any_cast<bool>(&value)) {
+      out.append(*b ? "true" : "false");
+    }
+  };
+  std::vector<std::any> record;
+  std::string out;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    out.clear();
+    for (int64_t i = 0; i < kRows; ++i) {
+      record.clear();
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), record);
+      for (size_t c = 0; c < record.size(); ++c) {
+        if (c > 0) {
+          out.push_back(',');
+        }
+        format(record[c], out);
+      }
+      out.push_back('\n');
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  ReportRows(state, allocs, kRows, out.size());
+}
+
+void BM_V2ExportCsv(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  auto decoder =
+      std::make_shared<RecordDecoderV2>(kSchemaVersion, schemas, kCommonId);
+  std::unordered_map<int, int> all;
+  std::vector<std::string> names;
+  for (size_t c = 0; c < schemas.size(); ++c) {
+    all[c] = c;
+    names.push_back("c" + std::to_string(c));
+  }
+  RowExporter exporter(decoder, all, names, ExportFormat::kCsv);
+  std::string out;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    out.clear();
+    for (int64_t i = 0; i < kRows; ++i) {
+      exporter.Export(rows.keys[i], rows.values[i], out);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  ReportRows(state, allocs, kRows, out.size());
+}
+
+// The long value column 9 of each row as a compaction filter reads it, from
+// the value alone.
+void BM_V2PeekColumn(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  auto peek = decoder.NewColumnPeek(9);
+  std::optional<int64_t> ts;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.Peek(peek, rows.values[i], ts);
+      benchmark::DoNotOptimize(ts);
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+// Value column 6 dropped from each row, range(0) 1 by ValueRewriter on the
+// value bytes, 0 by a decode and an encode with the schemas left.
+void BM_V2DropColumn(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<int> id_map;
+  std::unordered_map<int, int> kept;
+  for (size_t c = 0; c < schemas.size(); ++c) {
+    id_map.push_back(c == 6 ? ValueRewriter::kDrop : c);
+    if (c != 6) {
+      kept[c] = kept.size();
+    }
+  }
+  ValueRewriter rewriter(id_map);
+  auto narrow = schemas;
+  narrow.erase(narrow.begin() + 6);
+  for (size_t c = 0; c < narrow.size(); ++c) {
+    narrow[c] = narrow[c]->Clone();
+    narrow[c]->SetIndex(c);
+    narrow[c]->SetIsKey(schemas[c < 6 ? c : c + 1]->IsKey());
+    narrow[c]->SetAllowNull(schemas[c < 6 ? c : c + 1]->AllowNull());
+  }
+  RecordEncoderV2 narrow_encoder(kSchemaVersion, narrow, kCommonId);
+  std::vector<std::any> record;
+  std::string value;
+  int64_t bytes = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    bytes = 0;
+    for (int64_t i = 0; i < kRows; ++i) {
+      if (state.range(0) != 0) {
+        bytes += rewriter.Rewrite(rows.values[i], value);
+      } else {
+        record.clear();
+        decoder.Decode(std::string_view(rows.keys[i]),
+                       std::string_view(rows.values[i]), kept, record);
+        bytes += narrow_encoder.EncodeValue(record, value);
+      }
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+// Counter columns prev and salary of each row added to, range(0) 1 by a
+// DeltaMerger folding a delta record into the value bytes, 0 by a decode of
+// the row, the adds and an encode of its value.
+void BM_V2CounterMerge(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  DeltaMerger merger(kSchemaVersion, schemas);
+  DeltaRecordEncoder delta_encoder(kSchemaVersion, schemas);
+  delta_encoder.AddInt(9, 1);
+  delta_encoder.AddReal(10, 0.5);
+  std::string delta;
+  delta_encoder.Encode(delta);
+  std::string_view operand(delta);
+  std::vector<std::any> record;
+  std::string value;
+  int64_t bytes = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    bytes = 0;
+    for (int64_t i = 0; i < kRows; ++i) {
+      if (state.range(0) != 0) {
+        bytes += merger.Merge(rows.values[i], &operand, 1, value);
+      } else {
+        record.clear();
+        decoder.Decode(std::string_view(rows.keys[i]),
+                       std::string_view(rows.values[i]), record);
+        record[9] = std::any_cast<int64_t>(record[9]) + 1;
+        if (record[10].has_value()) {
+          record[10] = std::any_cast<double>(record[10]) + 0.5;
+        }
+        bytes += encoder.EncodeValue(record, value);
+      }
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+// The changed columns of each row after its age was raised, range(0) 1 by
+// ValueDiff on the value bytes, 0 by a decode of both values and a compare
+// of the strings and numbers decoded.
+void BM_V2DiffValues(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto records = MakeRecordsV2();
+  auto rows = EncodeAll(encoder, records);
+  for (auto& record : records) {
+    record[8] = std::any_cast<int32_t>(record[8]) + 1;
+  }
+  auto updated = EncodeAll(encoder, records);
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  ValueDiff diff(kSchemaVersion, schemas);
+  auto same = [](const std::any& lhs, const std::any& rhs) {
+    if (lhs.has_value() != rhs.has_value() || !lhs.has_value()) {
+      return lhs.has_value() == rhs.has_value();
+    }
+    if (lhs.type() == typeid(std::string)) {
+      return std::any_cast<const std::string&>(lhs) ==
+             std::any_cast<const std::string&>(rhs);
+    }
+    if (lhs.type() == typeid(int32_t)) {
+      return std::any_cast<int32_t>(lhs) == std::any_cast<int32_t>(rhs);
+    }
+    if (lhs.type() == typeid(int64_t)) {
+      return std::any_cast<int64_t>(lhs) == std::any_cast<int64_t>(rhs);
+    }
+    if (lhs.type() == typeid(double)) {
+      return std::any_cast<double>(lhs) == std::any_cast<double>(rhs);
+    }
+    return std::any_cast<bool>(lhs) == std::any_cast<bool>(rhs);
+  };
+  std::vector<std::any> old_record;
+  std::vector<std::any> new_record;
+  std::vector<int> changed;
+  int64_t changes = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    changes = 0;
+    for (int64_t i = 0; i < kRows; ++i) {
+      if (state.range(0) != 0) {
+        changes += diff.Diff(rows.values[i], updated.values[i], changed);
+      } else {
+        old_record.clear();
+        new_record.clear();
+        decoder.Decode(std::string_view(rows.keys[i]),
+                       std::string_view(rows.values[i]), old_record);
+        decoder.Decode(std::string_view(updated.keys[i]),
+                       std::string_view(updated.values[i]), new_record);
+        changed.clear();
+        for (size_t c = 0; c < old_record.size(); ++c) {
+          if (!schemas[c]->IsKey() && !same(old_record[c], new_record[c])) {
+            changed.push_back(c);
+          }
+        }
+        changes += changed.size();
+      }
+      benchmark::DoNotOptimize(changed.data());
+    }
+  }
+  benchmark::DoNotOptimize(changes);
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+// Encode and decode of a table of a key and 32 nullable bool flags, 1 with
+// the bools as bits of the value, 0 with an id, offset and byte each. The
+// value_bytes counter is the value size per row.
+void BM_V2BoolBits(benchmark::State& state) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  schemas.push_back(id);
+  for (int i = 1; i <= 32; ++i) {
+    auto flag = std::make_shared<DingoSchema<bool>>();
+    flag->SetIndex(i);
+    flag->SetAllowNull(true);
+    schemas.push_back(flag);
+  }
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  encoder.SetCompactValueHeader(true);
+  encoder.SetBoolBits(state.range(0) != 0);
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+
+  std::mt19937_64 rng(7);
+  std::vector<std::vector<std::any>> records(kRows);
+  for (int64_t r = 0; r < kRows; ++r) {
+    records[r].resize(schemas.size());
+    records[r][0] = r;
+    for (int i = 1; i <= 32; ++i) {
+      // one flag in eight unset.
+      uint64_t bits = rng();
+      if (bits % 8 != 0) {
+        records[r][i] = (bits & 0x100) != 0;
+      }
+    }
+  }
+
+  std::string key;
+  std::string value;
+  std::vector<std::any> decoded;
+  int64_t value_bytes = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    value_bytes = 0;
+    for (const auto& record : records) {
+      encoder.Encode('r', record, key, value);
+      decoder.Decode(key, value, decoded);
+      value_bytes += value.size();
+      benchmark::DoNotOptimize(decoded.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, value_bytes);
+  state.counters["value_bytes"] = static_cast<double>(value_bytes) / kRows;
+}
+
+// The value of a row holding a 1MB string, into one string and as slices
+// referencing the string.
+void BM_V2EncodeBlob(benchmark::State& state) {
+  auto record = MakeRecordsV2()[0];
+  record[4] = std::string(1 << 20, 'b');
+  RecordEncoderV2 encoder(kSchemaVersion, TableCodec::MakeSchemas(),
+                          kCommonId);
+  std::string value;
+  int64_t bytes = encoder.EncodeValue(record, value);
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    encoder.EncodeValue(record, value);
+    benchmark::DoNotOptimize(value.data());
+  }
+  ReportRows(state, allocs, 1, bytes);
+}
+
+void BM_V2EncodeBlobSlices(benchmark::State& state) {
+  auto record = MakeRecordsV2()[0];
+  record[4] = std::string(1 << 20, 'b');
+  RecordEncoderV2 encoder(kSchemaVersion, TableCodec::MakeSchemas(),
+                          kCommonId);
+  ValueSlices slices;
+  int64_t bytes = encoder.EncodeValue(record, slices);
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    encoder.EncodeValue(record, slices);
+    benchmark::DoNotOptimize(slices.Slices().data());
+  }
+  ReportRows(state, allocs, 1, bytes);
+}
+
+void BM_V2Decode(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+// BM_V2Decode of values trusted to be well formed, the tables read unchecked.
+void BM_V2DecodeTrusted(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  decoder.SetTrustedInput(true);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+// BM_V2Decode of checksummed values, each verified whole and then read
+// unchecked.
+void BM_V2DecodeChecksummed(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  encoder.SetChecksum(true);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  decoder.SetVerifyChecksums(true);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+// BM_V2Decode through a DecodeCache holding every row, the records are hits
+// shared with the cache.
+void BM_V2DecodeCached(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  DecodeCache cache(
+      std::make_shared<RecordDecoderV2>(kSchemaVersion, schemas, kCommonId),
+      64 << 20);
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      auto record = cache.Decode(std::string_view(rows.keys[i]),
+                                 std::string_view(rows.values[i]));
+      benchmark::DoNotOptimize(record.get());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+// The rows of BM_V2Encode / BM_V2Decode as ColumnValue records.
+void BM_V2EncodeColumnValue(benchmark::State& state) {
+  std::vector<std::vector<ColumnValue>> records;
+  for (const auto& record : MakeRecordsV2()) {
+    records.push_back(FromAny(record));
+  }
+  RecordEncoderV2 encoder(kSchemaVersion, TableCodec::MakeSchemas(),
+                          kCommonId);
+  int64_t bytes = EncodeAll(encoder, MakeRecordsV2()).bytes;
+  std::string key, value;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (const auto& record : records) {
+      encoder.Encode('r', record, key, value);
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+void BM_V2DecodeColumnValue(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<ColumnValue> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+void BM_V2DecodeProjected(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  std::unordered_map<int, int> column_indexes_serial;
+  for (size_t i = 0; i < kProjection.size(); ++i) {
+    column_indexes_serial[kProjection[i]] = i;
+  }
+  DecodePlan plan = decoder.NewDecodePlan(column_indexes_serial);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), plan, record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+// The projection of BM_V2DecodeProjected into one record reused by the rows.
+void BM_V2ScanDecodeProjected(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  auto decoder =
+      std::make_shared<RecordDecoderV2>(kSchemaVersion, schemas, kCommonId);
+  std::unordered_map<int, int> column_indexes_serial;
+  for (size_t i = 0; i < kProjection.size(); ++i) {
+    column_indexes_serial[kProjection[i]] = i;
+  }
+  ScanDecoder scan(decoder, column_indexes_serial);
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      scan.Decode(std::string_view(rows.keys[i]),
+                  std::string_view(rows.values[i]));
+      benchmark::DoNotOptimize(scan.Record().data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+void BM_V2DecodeKey(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.DecodeKey(std::string_view(rows.keys[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.KeyBytes());
+}
+
+// Every row timed on its own, for the tail of the per row latency.
+void BM_V2DecodeLatency(benchmark::State& state) {
+  auto schemas = TableCodec::MakeSchemas();
+  RecordEncoderV2 encoder(kSchemaVersion, schemas, kCommonId);
+  auto rows = EncodeAll(encoder, MakeRecordsV2());
+  RecordDecoderV2 decoder(kSchemaVersion, schemas, kCommonId);
+  std::vector<std::any> record;
+  LatencyHistogram latency;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      uint64_t start = CycleClock::Now();
+      decoder.Decode(std::string_view(rows.keys[i]),
+                     std::string_view(rows.values[i]), record);
+      latency.Record(CycleClock::Now() - start);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+  double nanos_per_tick = CycleClock::NanosPerTick();
+  state.counters["p50_ns"] = latency.Percentile(0.5) * nanos_per_tick;
+  state.counters["p99_ns"] = latency.Percentile(0.99) * nanos_per_tick;
+  state.counters["p999_ns"] = latency.Percentile(0.999) * nanos_per_tick;
+}
+
+// Static V2, it has no projected decode.
+
+void BM_StaticTableEncode(benchmark::State& state) {
+  auto table = MakeRows();
+  TableCodec codec(kSchemaVersion, kCommonId);
+  int64_t bytes = EncodeAll(codec, table).bytes;
+  std::string key, value;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (const auto& row : table) {
+      codec.Encode('r', row, key, value);
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+}
+
+void BM_StaticTableDecode(benchmark::State& state) {
+  TableCodec codec(kSchemaVersion, kCommonId);
+  auto rows = EncodeAll(codec, MakeRows());
+  TableCodec::Row row;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      codec.Decode(rows.keys[i], rows.values[i], row);
+      benchmark::DoNotOptimize(&row);
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.bytes);
+}
+
+void BM_StaticTableDecodeKey(benchmark::State& state) {
+  TableCodec codec(kSchemaVersion, kCommonId);
+  auto rows = EncodeAll(codec, MakeRows());
+  TableCodec::Row row;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      codec.DecodeKey(rows.keys[i], row);
+      benchmark::DoNotOptimize(&row);
+    }
+  }
+  ReportRows(state, allocs, kRows, rows.KeyBytes());
+}
+
+}  // namespace
+
+BENCHMARK(BM_V1Encode);
+BENCHMARK(BM_V1Decode);
+BENCHMARK(BM_V1DecodeProjected);
+BENCHMARK(BM_V1DecodeKey);
+BENCHMARK(BM_V2Encode);
+BENCHMARK(BM_V2EncodeIndexKeysSeparate);
+BENCHMARK(BM_V2EncodeIndexKeysBuilder);
+BENCHMARK(BM_V2ExportCsvFromAny);
+BENCHMARK(BM_V2ExportCsv);
+BENCHMARK(BM_V2PeekColumn);
+BENCHMARK(BM_V2DropColumn)->Arg(0)->Arg(1);
+BENCHMARK(BM_V2CounterMerge)->Arg(0)->Arg(1);
+BENCHMARK(BM_V2DiffValues)->Arg(0)->Arg(1);
+BENCHMARK(BM_V2BoolBits)->Arg(0)->Arg(1);
+BENCHMARK(BM_V2EncodeBlob);
+BENCHMARK(BM_V2EncodeBlobSlices);
+BENCHMARK(BM_V2Decode);
+BENCHMARK(BM_V2DecodeTrusted);
+BENCHMARK(BM_V2DecodeChecksummed);
+BENCHMARK(BM_V2DecodeCached);
+BENCHMARK(BM_V2EncodeColumnValue);
+BENCHMARK(BM_V2DecodeColumnValue);
+BENCHMARK(BM_V2DecodeProjected);
+BENCHMARK(BM_V2ScanDecodeProjected);
+BENCHMARK(BM_V2DecodeKey);
+BENCHMARK(BM_V2DecodeLatency);
+BENCHMARK(BM_StaticTableEncode);
+BENCHMARK(BM_StaticTableDecode);
+BENCHMARK(BM_StaticTableDecodeKey);
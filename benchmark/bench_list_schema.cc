@@ -0,0 +1,80 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "serial/schema/V2/double_list_schema.h"
+#include "serial/schema/V2/float_list_schema.h"
+#include "serial/schema/V2/integer_list_schema.h"
+#include "serial/schema/V2/long_list_schema.h"
+#include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
+
+using dingodb::serialV2::Buf;
+using dingodb::serialV2::BufView;
+using dingodb::serialV2::DingoSchema;
+
+template <typename T>
+static std::vector<T> MakeList(size_t n) {
+  std::vector<T> data(n);
+  for (size_t i = 0; i < n; ++i) {
+    data[i] = static_cast<T>(i * 7 + 1);
+  }
+  return data;
+}
+
+// Bytes processed are the element bytes, so the rate reads as GB/s of list.
+template <typename T>
+static void BM_EncodeList(benchmark::State& state) {
+  DingoSchema<std::vector<T>> schema;
+  schema.SetAllowNull(false);
+  std::any data = MakeList<T>(state.range(0));
+
+  Buf buf(state.range(0) * sizeof(T) + 4);
+  for (auto _ : state) {
+    buf.Clear();
+    benchmark::DoNotOptimize(schema.EncodeValue(data, buf));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+}
+
+template <typename T>
+static void BM_DecodeList(benchmark::State& state) {
+  DingoSchema<std::vector<T>> schema;
+  schema.SetAllowNull(false);
+  Buf buf(state.range(0) * sizeof(T) + 4);
+  schema.EncodeValue(std::any(MakeList<T>(state.range(0))), buf);
+  const std::string& bytes = buf.GetString();
+
+  for (auto _ : state) {
+    BufView view(bytes);
+    benchmark::DoNotOptimize(schema.DecodeValue(view));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+}
+
+BENCHMARK_TEMPLATE(BM_EncodeList, int32_t)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_EncodeList, int64_t)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_EncodeList, float)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_EncodeList, double)->Arg(1024)->Arg(16384);
+
+BENCHMARK_TEMPLATE(BM_DecodeList, int32_t)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DecodeList, int64_t)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DecodeList, float)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DecodeList, double)->Arg(1024)->Arg(16384);
@@ -0,0 +1,210 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "serial/record/V2/encoded_predicate.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+
+/*
+ * Projected decode through RecordDecoderV2::Decode with column_indexes_serial
+ * over a swept matrix:
+ *   range(0) columns of the table, one key column and the rest values,
+ *   range(1) percent of the nullable value columns that are null,
+ *   range(2) percent of the value columns projected, 0 for a single one,
+ *   range(3) 0 to project from the first value column on, 1 up to the last.
+ * time/column is the time per projected column, its curve over range(0)
+ * shows the cost of locating a column in a wide value.
+ */
+
+using dingodb::bench::AllocationScope;
+using dingodb::bench::ReportRows;
+using dingodb::serialV2::BaseSchemaPtr;
+using dingodb::serialV2::DingoSchema;
+using dingodb::serialV2::EncodedPredicate;
+using dingodb::serialV2::RecordDecoderV2;
+using dingodb::serialV2::RecordEncoderV2;
+
+namespace {
+
+constexpr int64_t kRows = 1000;
+
+// Value columns cycle through int, long, double and string, every other one
+// nullable.
+std::vector<BaseSchemaPtr> MakeSchemas(int column_count) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIsKey(true);
+  id->SetAllowNull(false);
+  schemas.push_back(id);
+  for (int i = 1; i < column_count; ++i) {
+    BaseSchemaPtr schema;
+    switch (i % 4) {
+      case 0:
+        schema = std::make_shared<DingoSchema<int32_t>>();
+        break;
+      case 1:
+        schema = std::make_shared<DingoSchema<int64_t>>();
+        break;
+      case 2:
+        schema = std::make_shared<DingoSchema<double>>();
+        break;
+      default:
+        schema = std::make_shared<DingoSchema<std::string>>();
+        break;
+    }
+    schema->SetIsKey(false);
+    schema->SetAllowNull(i % 2 == 0);
+    schemas.push_back(schema);
+  }
+  for (size_t i = 0; i < schemas.size(); ++i) {
+    schemas[i]->SetIndex(i);
+  }
+  return schemas;
+}
+
+std::any MakeValue(const BaseSchemaPtr& schema, int64_t row, int null_pct) {
+  int col = schema->GetIndex();
+  if (schema->AllowNull() && (row * 31 + col * 17) % 100 < null_pct) {
+    return std::any();
+  }
+  switch (schema->GetType()) {
+    case dingodb::serialV2::BaseSchema::kInteger:
+      return static_cast<int32_t>(row + col);
+    case dingodb::serialV2::BaseSchema::kLong:
+      return static_cast<int64_t>(row * 1000 + col);
+    case dingodb::serialV2::BaseSchema::kDouble:
+      return row * 0.5 + col;
+    default:
+      return "value " + std::to_string(row) + " of " + std::to_string(col);
+  }
+}
+
+void BM_DecodeProjected(benchmark::State& state) {
+  int column_count = state.range(0);
+  int null_pct = state.range(1);
+  int projection_pct = state.range(2);
+  bool from_last = state.range(3) != 0;
+
+  auto schemas = MakeSchemas(column_count);
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::vector<std::string> keys(kRows);
+  std::vector<std::string> values(kRows);
+  int64_t bytes = 0;
+  for (int64_t row = 0; row < kRows; ++row) {
+    std::vector<std::any> record;
+    for (const auto& schema : schemas) {
+      record.push_back(MakeValue(schema, row, null_pct));
+    }
+    encoder.Encode('r', record, keys[row], values[row]);
+    bytes += keys[row].size() + values[row].size();
+  }
+
+  int value_count = column_count - 1;
+  int width = std::max(1, value_count * projection_pct / 100);
+  int first = from_last ? column_count - width : 1;
+  std::unordered_map<int, int> column_indexes_serial;
+  for (int i = 0; i < width; ++i) {
+    column_indexes_serial[first + i] = i;
+  }
+
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (int64_t row = 0; row < kRows; ++row) {
+      decoder.Decode(std::string_view(keys[row]), std::string_view(values[row]),
+                     column_indexes_serial, record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, kRows, bytes);
+  state.counters["time/column"] = benchmark::Counter(
+      static_cast<double>(kRows) * width,
+      benchmark::Counter::kIsIterationInvariantRate |
+          benchmark::Counter::kInvert);
+  state.counters["projected"] = width;
+}
+
+// Three predicates on the last of four string key columns of kRows keys,
+// range(0) 0 through Evaluate locating the column each time, 1 through one
+// IndexKey per key and Evaluate on its offsets.
+void BM_EvaluateCompositeKey(benchmark::State& state) {
+  std::vector<BaseSchemaPtr> schemas;
+  for (int i = 0; i < 4; ++i) {
+    auto schema = std::make_shared<DingoSchema<std::string>>();
+    schema->SetIsKey(true);
+    schema->SetIndex(i);
+    schemas.push_back(schema);
+  }
+  auto value = std::make_shared<DingoSchema<int64_t>>();
+  value->SetIndex(4);
+  schemas.push_back(value);
+
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::vector<std::string> keys(kRows);
+  std::vector<std::string> values(kRows);
+  for (int64_t row = 0; row < kRows; ++row) {
+    std::vector<std::any> record;
+    for (int i = 0; i < 4; ++i) {
+      record.emplace_back("key column " + std::to_string(i) + " of row " +
+                          std::to_string(row));
+    }
+    record.emplace_back(row);
+    encoder.Encode('r', record, keys[row], values[row]);
+  }
+  std::vector<EncodedPredicate> predicates{
+      EncodedPredicate::Greater(3, std::string("key column 3 of row 1")),
+      EncodedPredicate::Less(3, std::string("key column 3 of row 9")),
+      EncodedPredicate::In(3, {std::string("key column 3 of row 5")})};
+
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  std::vector<uint32_t> offsets;
+  int64_t matches = 0;
+  for (auto _ : state) {
+    for (int64_t row = 0; row < kRows; ++row) {
+      if (state.range(0) != 0) {
+        decoder.IndexKey(keys[row], offsets);
+      }
+      for (const auto& predicate : predicates) {
+        bool matched = false;
+        if (state.range(0) != 0) {
+          decoder.Evaluate(keys[row], offsets, predicate, matched);
+        } else {
+          decoder.Evaluate(keys[row], values[row], predicate, matched);
+        }
+        matches += matched;
+      }
+    }
+  }
+  benchmark::DoNotOptimize(matches);
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+}  // namespace
+
+BENCHMARK(BM_EvaluateCompositeKey)->Arg(0)->Arg(1);
+BENCHMARK(BM_DecodeProjected)
+    ->ArgNames({"columns", "null_pct", "projection_pct", "from_last"})
+    ->ArgsProduct({{3, 11, 50, 200, 800}, {0, 50}, {0, 25, 100}, {0, 1}});
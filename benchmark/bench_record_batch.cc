@@ -0,0 +1,449 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "serial/record/V2/batch_wire.h"
+#include "serial/record/V2/column_batch.h"
+#include "serial/record/V2/key_comparator.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/utils/V2/keyvalue.h"
+#include "serial/utils/V2/parallel.h"
+
+using dingodb::serialV2::BaseSchemaPtr;
+using dingodb::serialV2::BatchWireReader;
+using dingodb::serialV2::ColumnArray;
+using dingodb::serialV2::ColumnBatch;
+using dingodb::serialV2::ColumnValue;
+using dingodb::serialV2::ColumnVector;
+using dingodb::serialV2::DingoSchema;
+using dingodb::serialV2::EncodeBatchWire;
+using dingodb::serialV2::EncodedBatch;
+using dingodb::serialV2::KeyComparator;
+using dingodb::serialV2::KeyValue;
+using dingodb::serialV2::ParallelOptions;
+using dingodb::serialV2::RecordDecoderV2;
+using dingodb::serialV2::RecordEncoderV2;
+
+constexpr size_t kRows = 100000;
+
+static std::vector<BaseSchemaPtr> MakeSchemas() {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  id->SetAllowNull(false);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetIsKey(false);
+  name->SetAllowNull(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(2);
+  score->SetIsKey(false);
+  score->SetAllowNull(true);
+  auto tags = std::make_shared<DingoSchema<std::vector<int32_t>>>();
+  tags->SetIndex(3);
+  tags->SetIsKey(false);
+  tags->SetAllowNull(true);
+  return {id, name, score, tags};
+}
+
+static std::vector<std::vector<std::any>> MakeRecords() {
+  std::vector<std::vector<std::any>> records(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    records[i] = {std::any(static_cast<int64_t>(i)),
+                  std::any("name of row " + std::to_string(i)),
+                  std::any(i * 0.5), std::any(std::vector<int32_t>(16, i))};
+  }
+  return records;
+}
+
+// The rows of MakeRecords column by column.
+static std::vector<ColumnVector> MakeColumns() {
+  std::vector<ColumnVector> columns;
+  for (const auto& schema : MakeSchemas()) {
+    columns.emplace_back(schema->GetType());
+  }
+  for (size_t i = 0; i < kRows; ++i) {
+    columns[0].Append(static_cast<int64_t>(i));
+    columns[1].AppendString("name of row " + std::to_string(i));
+    columns[2].Append(i * 0.5);
+    columns[3].AppendList(std::vector<int32_t>(16, i));
+  }
+  return columns;
+}
+
+static ParallelOptions Options(const benchmark::State& state) {
+  ParallelOptions options;
+  options.thread_count = state.range(0);
+  options.chunk_size = 512;
+  return options;
+}
+
+// Rows per second over kRows rows, run with 1 to 64 workers.
+static void BM_EncodeBatch(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  auto records = MakeRecords();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (auto _ : state) {
+    encoder.EncodeBatch('r', records, keys, values, Options(state));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+static void BM_DecodeBatch(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  auto records = MakeRecords();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  encoder.EncodeBatch('r', records, keys, values, Options(state));
+  std::vector<KeyValue> key_values(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    key_values[i].Set(keys[i], values[i]);
+  }
+
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  std::vector<std::vector<std::any>> decoded;
+  for (auto _ : state) {
+    decoder.DecodeBatch(key_values.data(), kRows, decoded, Options(state));
+    benchmark::DoNotOptimize(decoded.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+// The rows of BM_EncodeBatch encoded from columns on one thread.
+static void BM_EncodeColumnar(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  auto vectors = MakeColumns();
+  std::vector<ColumnArray> columns;
+  for (const auto& vector : vectors) {
+    columns.push_back(vector.Array());
+  }
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch batch;
+  for (auto _ : state) {
+    encoder.EncodeBatch('r', columns, kRows, batch);
+    benchmark::DoNotOptimize(batch.Arena().data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+// The rows of BM_EncodeBatch into one arena, and decoded from it into typed
+// columns, on one thread.
+static void BM_EncodeBatchArena(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  auto records = MakeRecords();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch batch;
+  for (auto _ : state) {
+    encoder.EncodeBatch('r', records, batch);
+    benchmark::DoNotOptimize(batch.Arena().data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+static void BM_DecodeBatchArena(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch rows;
+  encoder.EncodeBatch('r', MakeRecords(), rows);
+
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  auto plan = decoder.NewDecodePlan({{0, 0}, {1, 1}, {2, 2}, {3, 3}});
+  ColumnBatch batch;
+  for (auto _ : state) {
+    decoder.DecodeBatch(rows, plan, batch);
+    benchmark::DoNotOptimize(batch.Column(1).Chars());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+// A decoded batch into the wire form of batch_wire.h and read back, the
+// bytes are those of the wire against the encoded rows.
+static void BM_BatchWire(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch rows;
+  encoder.EncodeBatch('r', MakeRecords(), rows);
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  auto plan = decoder.NewDecodePlan({{0, 0}, {1, 1}, {2, 2}, {3, 3}});
+  ColumnBatch batch;
+  decoder.DecodeBatch(rows, plan, batch);
+
+  std::string wire;
+  BatchWireReader reader;
+  for (auto _ : state) {
+    wire.clear();
+    EncodeBatchWire(batch, wire);
+    reader.Open(wire);
+    benchmark::DoNotOptimize(reader.GetColumn(1).GetString(0).data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+  state.counters["wire_bytes/row"] = static_cast<double>(wire.size()) / kRows;
+  state.counters["row_bytes/row"] =
+      static_cast<double>(rows.Arena().size()) / kRows;
+}
+
+// Projected decode into a ColumnBatch of rows visited out of memory order,
+// as rows gathered from a scan, prefetching 0 to 16 rows ahead.
+static void BM_DecodeBatchPrefetch(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  encoder.EncodeBatch('r', MakeRecords(), keys, values);
+  std::vector<size_t> order(kRows);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937 random(7);
+  std::shuffle(order.begin(), order.end(), random);
+  std::vector<KeyValue> key_values(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    key_values[i].Set(keys[order[i]], values[order[i]]);
+  }
+
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  decoder.SetPrefetchDistance(state.range(0));
+  auto plan = decoder.NewDecodePlan({{0, 0}, {2, 1}});
+  ColumnBatch batch;
+  for (auto _ : state) {
+    decoder.DecodeBatch(key_values, plan, batch);
+    benchmark::DoNotOptimize(batch.Column(1).Size());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+// (int32, int64) primary keys of kRows rows, range(0) 0 through EncodeKey
+// row by row and 1 by EncodeKeys column by column.
+static void BM_EncodeIntegerKeys(benchmark::State& state) {
+  auto region = std::make_shared<DingoSchema<int32_t>>();
+  region->SetIndex(0);
+  region->SetIsKey(true);
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(1);
+  id->SetIsKey(true);
+  std::vector<BaseSchemaPtr> schemas{region, id};
+  ColumnVector regions(region->GetType()), ids(id->GetType());
+  std::vector<std::vector<ColumnValue>> records(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    int32_t r = static_cast<int32_t>(i % 64) - 32;
+    int64_t n = static_cast<int64_t>(i * 2654435761u);
+    regions.Append(r);
+    ids.Append(n);
+    records[i] = {ColumnValue(r), ColumnValue(n)};
+  }
+  std::vector<ColumnArray> columns{regions.Array(), ids.Array()};
+
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch keys;
+  dingodb::serialV2::Buf buf(kRows * 25);
+  for (auto _ : state) {
+    if (state.range(0) != 0) {
+      encoder.EncodeKeys('r', columns, kRows, keys);
+      benchmark::DoNotOptimize(keys.Arena().data());
+    } else {
+      buf.Clear();
+      for (const auto& record : records) {
+        encoder.EncodeKey('r', record, buf);
+      }
+      benchmark::DoNotOptimize(buf.Data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+// The keys of shuffled rows in key order, encoded then std::sort as strings
+// against EncodeAndSortKeys with 1 to 8 workers.
+static std::vector<std::vector<std::any>> ShuffledRecords() {
+  auto records = MakeRecords();
+  std::mt19937 random(7);
+  std::shuffle(records.begin(), records.end(), random);
+  return records;
+}
+
+static void BM_EncodeStdSortKeys(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  auto records = ShuffledRecords();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::vector<std::string> keys(kRows);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kRows; ++i) {
+      encoder.EncodeKey('r', records[i], keys[i]);
+    }
+    std::sort(keys.begin(), keys.end());
+    benchmark::DoNotOptimize(keys.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+static void BM_EncodeAndSortKeys(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  auto records = ShuffledRecords();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch keys;
+  std::vector<uint32_t> order;
+  for (auto _ : state) {
+    encoder.EncodeAndSortKeys('r', records, keys, order, Options(state));
+    benchmark::DoNotOptimize(order.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+static void BM_RadixSortKeys(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  auto records = ShuffledRecords();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch keys;
+  std::vector<uint32_t> order;
+  encoder.EncodeAndSortKeys('r', records, keys, order);
+  std::vector<std::string_view> views(kRows);
+  for (size_t i = 0; i < kRows; ++i) {
+    views[i] = keys.Key(i);
+  }
+  for (auto _ : state) {
+    dingodb::serialV2::RadixSortKeys(views.data(), kRows, order, Options(state));
+    benchmark::DoNotOptimize(order.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+// The same keys sorted by comparison as string_views against normalized
+// prefixes compared first.
+static std::vector<std::string_view> SortKeyViews(const EncodedBatch& keys) {
+  std::vector<std::string_view> views(keys.Size());
+  for (size_t i = 0; i < views.size(); ++i) {
+    views[i] = keys.Key(i);
+  }
+  return views;
+}
+
+static void BM_StdSortKeyViews(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  EncodedBatch keys;
+  std::vector<uint32_t> order;
+  encoder.EncodeAndSortKeys('r', ShuffledRecords(), keys, order);
+  auto shuffled = SortKeyViews(keys);
+  for (auto _ : state) {
+    auto views = shuffled;
+    std::sort(views.begin(), views.end());
+    benchmark::DoNotOptimize(views.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+static void BM_NormalizedSortKeys(benchmark::State& state) {
+  auto schemas = MakeSchemas();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  KeyComparator comparator(schemas);
+  EncodedBatch keys;
+  std::vector<uint32_t> order;
+  encoder.EncodeAndSortKeys('r', ShuffledRecords(), keys, order);
+  auto views = SortKeyViews(keys);
+  std::vector<std::pair<uint64_t, uint32_t>> entries(kRows);
+  for (auto _ : state) {
+    for (uint32_t i = 0; i < kRows; ++i) {
+      entries[i] = {comparator.NormalizedPrefix(views[i]), i};
+    }
+    std::sort(entries.begin(), entries.end(), [&](const auto& lhs, const auto& rhs) {
+      if (lhs.first != rhs.first) {
+        return lhs.first < rhs.first;
+      }
+      return views[lhs.second] < views[rhs.second];
+    });
+    benchmark::DoNotOptimize(entries.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+}
+
+// 128 dim embeddings of 20000 rows into a float matrix, range(0) 0 by
+// decoding each record and copying its vector out, otherwise DecodeEmbeddings
+// with range(0) workers.
+static void BM_DecodeEmbeddings(benchmark::State& state) {
+  constexpr size_t kDim = 128;
+  constexpr size_t kVectors = 20000;
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  id->SetAllowNull(false);
+  auto embedding = std::make_shared<DingoSchema<std::vector<float>>>();
+  embedding->SetIndex(1);
+  embedding->SetIsKey(false);
+  embedding->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, embedding};
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::vector<std::string> keys(kVectors);
+  std::vector<std::string> values(kVectors);
+  std::vector<KeyValue> key_values(kVectors);
+  for (size_t i = 0; i < kVectors; ++i) {
+    std::vector<float> vector(kDim);
+    std::iota(vector.begin(), vector.end(), static_cast<float>(i));
+    encoder.Encode('r', {std::any(static_cast<int64_t>(i)), std::any(vector)},
+                   keys[i], values[i]);
+    key_values[i].Set(keys[i], values[i]);
+  }
+
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  std::vector<float> matrix(kVectors * kDim);
+  std::vector<uint8_t> nulls(kVectors);
+  std::vector<std::any> record;
+  for (auto _ : state) {
+    if (state.range(0) == 0) {
+      for (size_t i = 0; i < kVectors; ++i) {
+        record.clear();
+        decoder.Decode(std::string_view(keys[i]), std::string_view(values[i]),
+                       record);
+        const auto& vector = std::any_cast<const std::vector<float>&>(record[1]);
+        std::copy(vector.begin(), vector.end(), matrix.begin() + i * kDim);
+      }
+    } else {
+      decoder.DecodeEmbeddings(key_values.data(), kVectors, 1, kDim,
+                               matrix.data(), kDim, nulls.data(),
+                               Options(state));
+    }
+    benchmark::DoNotOptimize(matrix.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kVectors);
+  state.SetBytesProcessed(state.iterations() * kVectors * kDim * 4);
+}
+
+BENCHMARK(BM_EncodeBatch)->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+BENCHMARK(BM_DecodeBatch)->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+BENCHMARK(BM_EncodeBatchArena)->UseRealTime();
+BENCHMARK(BM_EncodeStdSortKeys)->UseRealTime();
+BENCHMARK(BM_StdSortKeyViews)->UseRealTime();
+BENCHMARK(BM_NormalizedSortKeys)->UseRealTime();
+BENCHMARK(BM_RadixSortKeys)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK(BM_EncodeAndSortKeys)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK(BM_DecodeBatchArena)->UseRealTime();
+BENCHMARK(BM_BatchWire)->UseRealTime();
+BENCHMARK(BM_DecodeBatchPrefetch)->Arg(0)->Arg(2)->Arg(4)->Arg(8)->Arg(16)
+    ->UseRealTime();
+BENCHMARK(BM_EncodeColumnar)->UseRealTime();
+BENCHMARK(BM_EncodeIntegerKeys)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_DecodeEmbeddings)->Arg(0)->Arg(1)->Arg(4)->UseRealTime();
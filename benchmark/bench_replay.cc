@@ -0,0 +1,292 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+
+#include <any>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "serial/record/V2/common.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/record/V2/row_corpus.h"
+#include "serial/record/V2/row_peek.h"
+#include "serial/schema/V2/dingo_schema.h"
+#include "serial/utils/V2/compression.h"
+#include "serial/utils/V2/mapped_file.h"
+
+/*
+ * Replays a captured table, see RowCorpusWriter: the corpus file named by
+ * DINGO_SERIAL_CORPUS is mapped and its rows decoded, decoded projected to
+ * the columns of DINGO_SERIAL_CORPUS_COLUMNS (a comma separated list of
+ * schema positions, by default the first column and the first two value
+ * columns) and encoded again with the layout of its first value, so that a
+ * change is measured on the data of production and not only on the
+ * synthetic tables of the other suites, e.g.
+ *   DINGO_SERIAL_CORPUS=orders.dsrc bench_replay --benchmark_format=json
+ * Without DINGO_SERIAL_CORPUS a corpus of a small synthetic table is written
+ * to a temporary file and replayed, so that the path stays exercised.
+ */
+
+using dingodb::bench::AllocationScope;
+using dingodb::bench::ReportRows;
+using dingodb::serialV2::BaseSchemaPtr;
+using dingodb::serialV2::CompressionType;
+using dingodb::serialV2::DecodePlan;
+using dingodb::serialV2::DingoSchema;
+using dingodb::serialV2::MappedFile;
+using dingodb::serialV2::RecordDecoderV2;
+using dingodb::serialV2::RecordEncoderV2;
+using dingodb::serialV2::RowCorpus;
+using dingodb::serialV2::RowCorpusWriter;
+
+namespace {
+
+// id | name, score, tags, flag: a few thousand rows in the default layout.
+bool WriteSyntheticCorpus(const std::string& path) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(std::move(schema));
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<double>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false);
+  add(std::make_shared<DingoSchema<bool>>(), false);
+
+  RecordEncoderV2 encoder(1, schemas, 100);
+  RowCorpusWriter writer(1, schemas, 100);
+  std::string key;
+  std::string value;
+  for (int64_t i = 0; i < 4096; ++i) {
+    std::vector<std::any> record(schemas.size());
+    record[0] = i;
+    record[1] = "customer-" + std::to_string(i * 7919 % 1000);
+    record[2] = i * 0.25;
+    if (i % 4 != 0) {
+      record[3] = std::vector<int64_t>{i, i + 1, i + 2};
+    }
+    record[4] = i % 3 == 0;
+    encoder.Encode('r', record, key, value);
+    writer.Add(key, value);
+  }
+  std::string corpus;
+  writer.Write(corpus);
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool written = fwrite(corpus.data(), 1, corpus.size(), file) == corpus.size();
+  return fclose(file) == 0 && written;
+}
+
+std::vector<int> ParseColumns(const char* list) {
+  std::vector<int> columns;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      columns.push_back(std::atoi(item.c_str()));
+    }
+  }
+  return columns;
+}
+
+// The corpus of a run and what the benchmarks share, built once.
+struct Replay {
+  std::unique_ptr<MappedFile> file;
+  RowCorpus corpus;
+  std::unique_ptr<RecordDecoderV2> decoder;
+  std::unique_ptr<RecordEncoderV2> encoder;
+  std::unordered_map<int, int> column_indexes_serial;
+  int64_t bytes{0};
+};
+
+Replay* replay = nullptr;
+
+// An encoder set to the layout and compression the first value was written
+// with; the column encodings come with the schemas.
+std::unique_ptr<RecordEncoderV2> NewEncoder(const RowCorpus& corpus) {
+  auto encoder = std::make_unique<RecordEncoderV2>(
+      corpus.SchemaVersion(), corpus.Schemas(), corpus.CommonId(),
+      corpus.IsLe());
+  if (corpus.RowCount() == 0) {
+    return encoder;
+  }
+  namespace v2 = dingodb::serialV2;
+  std::string_view value = corpus.Value(0);
+  int format = v2::PeekValueFormat(value, corpus.IsLe());
+  if (format < 0) {
+    return encoder;
+  }
+  encoder->SetCompactValueHeader(
+      (format & (v2::VALUE_FORMAT_COMPACT_ID |
+                 v2::VALUE_FORMAT_COMPACT_OFFSET)) != 0);
+  encoder->SetNullBitmap((format & v2::VALUE_FORMAT_NULL_BITMAP) != 0);
+  encoder->SetStaticOffsets((format & v2::VALUE_FORMAT_STATIC_OFFSETS) != 0);
+  encoder->SetBoolBits((format & v2::VALUE_FORMAT_BOOL_BITS) != 0);
+  if ((format & v2::VALUE_FORMAT_COMPRESSED) != 0 && value.size() > 4) {
+    auto type = static_cast<CompressionType>(value[4]);
+    if (v2::IsCompressionSupported(type)) {
+      encoder->SetCompression(type);
+    }
+  }
+  return encoder;
+}
+
+void BM_ReplayDecode(benchmark::State& state) {
+  const RowCorpus& corpus = replay->corpus;
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (size_t i = 0; i < corpus.RowCount(); ++i) {
+      record.clear();
+      replay->decoder->Decode(corpus.Key(i), corpus.Value(i), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, corpus.RowCount(), replay->bytes);
+}
+
+void BM_ReplayDecodeProjected(benchmark::State& state) {
+  const RowCorpus& corpus = replay->corpus;
+  DecodePlan plan =
+      replay->decoder->NewDecodePlan(replay->column_indexes_serial);
+  std::vector<std::any> record;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    for (size_t i = 0; i < corpus.RowCount(); ++i) {
+      record.clear();
+      replay->decoder->Decode(corpus.Key(i), corpus.Value(i), plan, record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportRows(state, allocs, corpus.RowCount(), replay->bytes);
+}
+
+void BM_ReplayEncode(benchmark::State& state) {
+  const RowCorpus& corpus = replay->corpus;
+  std::vector<std::vector<std::any>> records(corpus.RowCount());
+  for (size_t i = 0; i < corpus.RowCount(); ++i) {
+    if (replay->decoder->Decode(corpus.Key(i), corpus.Value(i), records[i]) <
+        0) {
+      state.SkipWithError("a row of the corpus does not decode");
+      return;
+    }
+  }
+  std::string key;
+  std::string value;
+  int64_t bytes = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    bytes = 0;
+    for (size_t i = 0; i < corpus.RowCount(); ++i) {
+      char prefix = corpus.Key(i).empty() ? 'r' : corpus.Key(i)[0];
+      replay->encoder->Encode(prefix, records[i], key, value);
+      bytes += key.size() + value.size();
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportRows(state, allocs, corpus.RowCount(), bytes);
+  state.counters["bytes/row"] =
+      corpus.RowCount() > 0 ? static_cast<double>(bytes) / corpus.RowCount()
+                            : 0;
+  state.counters["captured_bytes/row"] =
+      corpus.RowCount() > 0
+          ? static_cast<double>(replay->bytes) / corpus.RowCount()
+          : 0;
+}
+
+// Maps the corpus and registers the benchmarks over it, none when it does
+// not open.
+bool RegisterReplay() {
+  const char* path = std::getenv("DINGO_SERIAL_CORPUS");
+  std::string synthetic;
+  if (path == nullptr) {
+    char name[] = "/tmp/dingo_serial_corpus_XXXXXX";
+    int fd = mkstemp(name);
+    if (fd < 0) {
+      return false;
+    }
+    close(fd);
+    synthetic = name;
+    if (!WriteSyntheticCorpus(synthetic)) {
+      unlink(synthetic.c_str());
+      return false;
+    }
+    path = synthetic.c_str();
+  }
+
+  auto state = std::make_unique<Replay>();
+  state->file = std::make_unique<MappedFile>(path);
+  state->file->WillNeed();
+  if (!synthetic.empty()) {
+    // the mapping keeps the bytes.
+    unlink(synthetic.c_str());
+  }
+  if (state->corpus.Open(state->file->Data()) < 0) {
+    fprintf(stderr, "bench_replay: %s is not a row corpus\n", path);
+    return false;
+  }
+  const RowCorpus& corpus = state->corpus;
+  state->decoder = std::make_unique<RecordDecoderV2>(
+      corpus.SchemaVersion(), corpus.Schemas(), corpus.CommonId(),
+      corpus.IsLe());
+  state->encoder = NewEncoder(corpus);
+  for (size_t i = 0; i < corpus.RowCount(); ++i) {
+    state->bytes += corpus.Key(i).size() + corpus.Value(i).size();
+  }
+
+  std::vector<int> columns;
+  const char* list = std::getenv("DINGO_SERIAL_CORPUS_COLUMNS");
+  if (list != nullptr) {
+    columns = ParseColumns(list);
+  } else if (!corpus.Schemas().empty()) {
+    columns.push_back(0);
+    for (size_t i = 1; i < corpus.Schemas().size() && columns.size() < 3;
+         ++i) {
+      if (!corpus.Schemas()[i]->IsKey()) {
+        columns.push_back(i);
+      }
+    }
+  }
+  for (size_t i = 0; i < columns.size(); ++i) {
+    state->column_indexes_serial[columns[i]] = i;
+  }
+
+  replay = state.release();
+  benchmark::RegisterBenchmark("BM_ReplayDecode", BM_ReplayDecode);
+  benchmark::RegisterBenchmark("BM_ReplayDecodeProjected",
+                               BM_ReplayDecodeProjected);
+  benchmark::RegisterBenchmark("BM_ReplayEncode", BM_ReplayEncode);
+  return true;
+}
+
+[[maybe_unused]] const bool registered = RegisterReplay();
+
+}  // namespace
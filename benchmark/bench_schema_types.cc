@@ -0,0 +1,505 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "serial/record/V2/record_encoder.h"
+#include "serial/record/record_encoder.h"
+#include "serial/schema/V2/static_column_codec.h"
+#include "serial/utils/utils.h"
+
+/*
+ * One column of each of the 12 BaseSchema types through its V1 and V2
+ * DingoSchema alone, as a key (the types that may be keys) and as a value.
+ * range(0) is the string length or list size, scalars take none. Bytes
+ * processed are the encoded bytes.
+ */
+
+namespace {
+
+template <typename T>
+struct IsVector : std::false_type {};
+template <typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+// Strings and lists are held by shared_ptr in V1 records.
+template <typename T>
+using V1Field =
+    std::conditional_t<std::is_same_v<T, std::string> || IsVector<T>::value,
+                       std::optional<std::shared_ptr<T>>, std::optional<T>>;
+
+template <typename T>
+V1Field<T> ToV1(const T& data) {
+  if constexpr (std::is_same_v<V1Field<T>, std::optional<T>>) {
+    return data;
+  } else {
+    return std::make_shared<T>(data);
+  }
+}
+
+std::string MakeString(int64_t n, int64_t seed) {
+  std::string s(n, ' ');
+  for (int64_t i = 0; i < n; ++i) {
+    s[i] = static_cast<char>('a' + (i * 7 + seed) % 26);
+  }
+  return s;
+}
+
+template <typename T>
+T MakeData(int64_t n) {
+  if constexpr (std::is_same_v<T, bool>) {
+    return true;
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    return MakeString(n, 0);
+  } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+    T data(n);
+    for (int64_t i = 0; i < n; ++i) {
+      data[i] = MakeString(16, i);
+    }
+    return data;
+  } else if constexpr (IsVector<T>::value) {
+    T data(n);
+    for (int64_t i = 0; i < n; ++i) {
+      data[i] = static_cast<typename T::value_type>(i * 7 + 1);
+    }
+    return data;
+  } else {
+    return static_cast<T>(-123456);
+  }
+}
+
+template <typename T>
+int64_t Size(const benchmark::State& state) {
+  if constexpr (std::is_same_v<T, std::string> || IsVector<T>::value) {
+    return state.range(0);
+  } else {
+    return 0;
+  }
+}
+
+template <typename T>
+dingodb::serialV2::DingoSchema<T> MakeSchemaV2(bool is_key) {
+  dingodb::serialV2::DingoSchema<T> schema;
+  schema.SetIsKey(is_key);
+  schema.SetAllowNull(true);
+  return schema;
+}
+
+template <typename T>
+dingodb::DingoSchema<V1Field<T>> MakeSchemaV1(bool is_key) {
+  dingodb::DingoSchema<V1Field<T>> schema;
+  schema.SetIsKey(is_key);
+  schema.SetAllowNull(true);
+  return schema;
+}
+
+// V2
+
+template <typename T>
+void BM_V2EncodeKey(benchmark::State& state) {
+  auto schema = MakeSchemaV2<T>(true);
+  std::any data = MakeData<T>(Size<T>(state));
+  dingodb::serialV2::Buf buf(1024);
+  size_t bytes = 0;
+  for (auto _ : state) {
+    buf.Clear();
+    bytes = schema.EncodeKey(data, buf);
+    benchmark::DoNotOptimize(buf.Data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+template <typename T>
+void BM_V2DecodeKey(benchmark::State& state) {
+  auto schema = MakeSchemaV2<T>(true);
+  dingodb::serialV2::Buf buf(1024);
+  schema.EncodeKey(std::any(MakeData<T>(Size<T>(state))), buf);
+  const std::string& bytes = buf.GetString();
+  for (auto _ : state) {
+    dingodb::serialV2::BufView view(bytes);
+    benchmark::DoNotOptimize(schema.DecodeKey(view));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+template <typename T>
+void BM_V2EncodeValue(benchmark::State& state) {
+  auto schema = MakeSchemaV2<T>(false);
+  std::any data = MakeData<T>(Size<T>(state));
+  dingodb::serialV2::Buf buf(1024);
+  size_t bytes = 0;
+  for (auto _ : state) {
+    buf.Clear();
+    bytes = schema.EncodeValue(data, buf);
+    benchmark::DoNotOptimize(buf.Data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+template <typename T>
+void BM_V2DecodeValue(benchmark::State& state) {
+  auto schema = MakeSchemaV2<T>(false);
+  dingodb::serialV2::Buf buf(1024);
+  schema.EncodeValue(std::any(MakeData<T>(Size<T>(state))), buf);
+  const std::string& bytes = buf.GetString();
+  for (auto _ : state) {
+    dingodb::serialV2::BufView view(bytes);
+    benchmark::DoNotOptimize(schema.DecodeValue(view));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+// V1, its buf does not grow on every write, so the encode buf is sized from
+// a first encode and rewound on each iteration.
+
+template <typename T, bool kIsKey>
+std::string EncodeV1(dingodb::DingoSchema<V1Field<T>>& schema,
+                     const V1Field<T>& data) {
+  dingodb::Buf buf(1024);
+  if constexpr (kIsKey) {
+    schema.EncodeKey(&buf, data);
+  } else {
+    schema.EncodeValue(&buf, data);
+  }
+  return buf.GetString();
+}
+
+template <typename T>
+void BM_V1EncodeKey(benchmark::State& state) {
+  auto schema = MakeSchemaV1<T>(true);
+  auto data = ToV1(MakeData<T>(Size<T>(state)));
+  size_t bytes = EncodeV1<T, true>(schema, data).size();
+  dingodb::Buf buf(bytes + 1024);
+  for (auto _ : state) {
+    buf.SetForwardPos(0);
+    schema.EncodeKey(&buf, data);
+    benchmark::DoNotOptimize(&buf);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+template <typename T>
+void BM_V1DecodeKey(benchmark::State& state) {
+  auto schema = MakeSchemaV1<T>(true);
+  std::string bytes =
+      EncodeV1<T, true>(schema, ToV1(MakeData<T>(Size<T>(state))));
+  for (auto _ : state) {
+    dingodb::Buf view(std::string_view(bytes), dingodb::IsLE());
+    benchmark::DoNotOptimize(schema.DecodeKey(&view));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+template <typename T>
+void BM_V1EncodeValue(benchmark::State& state) {
+  auto schema = MakeSchemaV1<T>(false);
+  auto data = ToV1(MakeData<T>(Size<T>(state)));
+  size_t bytes = EncodeV1<T, false>(schema, data).size();
+  dingodb::Buf buf(bytes + 1024);
+  for (auto _ : state) {
+    buf.SetForwardPos(0);
+    schema.EncodeValue(&buf, data);
+    benchmark::DoNotOptimize(&buf);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+template <typename T>
+void BM_V1DecodeValue(benchmark::State& state) {
+  auto schema = MakeSchemaV1<T>(false);
+  std::string bytes =
+      EncodeV1<T, false>(schema, ToV1(MakeData<T>(Size<T>(state))));
+  for (auto _ : state) {
+    dingodb::Buf view(std::string_view(bytes), dingodb::IsLE());
+    benchmark::DoNotOptimize(schema.DecodeValue(&view));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+// float / double keys of random sign, as geo coordinates or deltas are, by
+// the static codec and by the sign branch it replaced.
+
+template <typename T>
+std::vector<T> MixedSignData() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<T> dist(-180, 180);
+  std::vector<T> data(4096);
+  for (auto& value : data) {
+    value = dist(rng);
+  }
+  return data;
+}
+
+template <typename T>
+void EncodeKeyBranchy(T data, dingodb::serialV2::Buf& buf) {
+  if constexpr (sizeof(T) == 4) {
+    uint32_t bits;
+    memcpy(&bits, &data, 4);
+    if (data >= 0) {
+      buf.WriteIntWithFirstBitNegation(bits);
+    } else {
+      buf.WriteIntWithNegation(bits);
+    }
+  } else {
+    uint64_t bits;
+    memcpy(&bits, &data, 8);
+    if (data >= 0) {
+      buf.WriteLongWithFirstBitNegation(bits);
+    } else {
+      buf.WriteLongWithNegation(bits);
+    }
+  }
+}
+
+template <typename T>
+T DecodeKeyBranchy(dingodb::serialV2::BufView& buf) {
+  T data;
+  if constexpr (sizeof(T) == 4) {
+    uint32_t bits = buf.Peek() >= 0x80 ? buf.ReadIntWithFirstBitNegation()
+                                       : buf.ReadIntWithNegation();
+    memcpy(&data, &bits, 4);
+  } else {
+    uint64_t bits = buf.Peek() >= 0x80 ? buf.ReadLongWithFirstBitNegation()
+                                       : buf.ReadLongWithNegation();
+    memcpy(&data, &bits, 8);
+  }
+  return data;
+}
+
+// range(0) 1 for the branch free codec, 0 for the branch.
+template <typename T>
+void BM_V2EncodeKeyMixedSign(benchmark::State& state) {
+  std::vector<T> data = MixedSignData<T>();
+  dingodb::serialV2::Buf buf(data.size() * sizeof(T));
+  for (auto _ : state) {
+    buf.Clear();
+    for (T value : data) {
+      if (state.range(0) != 0) {
+        dingodb::serialV2::StaticColumnCodec<T>::EncodeKey(value, buf);
+      } else {
+        EncodeKeyBranchy(value, buf);
+      }
+    }
+    benchmark::DoNotOptimize(buf.Data());
+  }
+  state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+template <typename T>
+void BM_V2DecodeKeyMixedSign(benchmark::State& state) {
+  std::vector<T> data = MixedSignData<T>();
+  dingodb::serialV2::Buf buf(data.size() * sizeof(T));
+  for (T value : data) {
+    dingodb::serialV2::StaticColumnCodec<T>::EncodeKey(value, buf);
+  }
+  const std::string& bytes = buf.GetString();
+  for (auto _ : state) {
+    dingodb::serialV2::BufView view(bytes);
+    T sum = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+      T value;
+      if (state.range(0) != 0) {
+        dingodb::serialV2::StaticColumnCodec<T>::DecodeKey(view, value);
+      } else {
+        value = DecodeKeyBranchy<T>(view);
+      }
+      sum += value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+// A time series of 4096 elements: timestamps a second apart with jitter, or
+// readings drifting slowly.
+template <typename T>
+std::vector<T> SeriesData() {
+  std::vector<T> data;
+  for (int i = 0; i < 4096; ++i) {
+    if constexpr (std::is_integral_v<T>) {
+      data.push_back(static_cast<T>(1700000000000L + i * 1000 + (i * 7) % 13));
+    } else {
+      data.push_back(20.0 + (i / 10) * 0.25);
+    }
+  }
+  return data;
+}
+
+template <typename T>
+std::shared_ptr<dingodb::serialV2::DingoSchema<std::vector<T>>> SeriesSchema(
+    bool encoded) {
+  auto schema = std::make_shared<dingodb::serialV2::DingoSchema<std::vector<T>>>();
+  if constexpr (std::is_integral_v<T>) {
+    schema->SetDeltaEncoded(encoded);
+  } else {
+    schema->SetXorEncoded(encoded);
+  }
+  return schema;
+}
+
+// range(0) 1 for the series encoded list, 0 for the plain one.
+template <typename T>
+void BM_V2EncodeSeriesList(benchmark::State& state) {
+  std::any data = SeriesData<T>();
+  auto schema = SeriesSchema<T>(state.range(0) != 0);
+  dingodb::serialV2::Buf buf(64 * 1024);
+  for (auto _ : state) {
+    buf.Clear();
+    schema->EncodeValue(data, buf);
+    benchmark::DoNotOptimize(buf.Data());
+  }
+  state.counters["bytes"] = buf.Size();
+  state.SetItemsProcessed(state.iterations() * 4096);
+}
+
+template <typename T>
+void BM_V2DecodeSeriesList(benchmark::State& state) {
+  auto schema = SeriesSchema<T>(state.range(0) != 0);
+  dingodb::serialV2::Buf buf(64 * 1024);
+  schema->EncodeValue(std::any(SeriesData<T>()), buf);
+  const std::string& bytes = buf.GetString();
+  for (auto _ : state) {
+    dingodb::serialV2::BufView view(bytes);
+    benchmark::DoNotOptimize(schema->DecodeValue(view, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * 4096);
+}
+
+// The last 16 elements of a plain series, range(0) 1 through DecodeRange, 0
+// by decoding the whole list.
+void BM_V2DecodeListTail(benchmark::State& state) {
+  auto schema = SeriesSchema<int64_t>(false);
+  dingodb::serialV2::Buf buf(64 * 1024);
+  schema->EncodeValue(std::any(SeriesData<int64_t>()), buf);
+  const std::string& bytes = buf.GetString();
+  std::vector<int64_t> tail;
+  for (auto _ : state) {
+    dingodb::serialV2::BufView view(bytes);
+    if (state.range(0) != 0) {
+      schema->DecodeRange(view, 0, 4096 - 16, 4096, tail);
+    } else {
+      auto all = std::any_cast<std::vector<int64_t>>(schema->DecodeValue(view, 0));
+      tail.assign(all.end() - 16, all.end());
+    }
+    benchmark::DoNotOptimize(tail.data());
+  }
+}
+
+// A 16 byte id key, range(0) 1 for the fixed length schema, 0 for any length.
+std::shared_ptr<dingodb::serialV2::DingoSchema<std::string>> IdSchema(
+    bool fixed) {
+  auto schema = std::make_shared<dingodb::serialV2::DingoSchema<std::string>>();
+  schema->SetAllowNull(true);
+  schema->SetFixedLength(fixed ? 16 : 0);
+  return schema;
+}
+
+void BM_V2EncodeFixedStringKey(benchmark::State& state) {
+  auto schema = IdSchema(state.range(0) != 0);
+  std::any data = std::string("0123456789abcdef");
+  dingodb::serialV2::Buf buf(64);
+  for (auto _ : state) {
+    buf.Clear();
+    schema->EncodeKey(data, buf);
+    benchmark::DoNotOptimize(buf.Data());
+  }
+  state.counters["bytes"] = buf.Size();
+}
+
+void BM_V2SkipFixedStringKey(benchmark::State& state) {
+  auto schema = IdSchema(state.range(0) != 0);
+  dingodb::serialV2::Buf buf(64);
+  schema->EncodeKey(std::any(std::string("0123456789abcdef")), buf);
+  const std::string& bytes = buf.GetString();
+  for (auto _ : state) {
+    dingodb::serialV2::BufView view(bytes);
+    benchmark::DoNotOptimize(schema->SkipKey(view));
+  }
+}
+
+// String lengths, short and long, and list sizes.
+void StringSizes(benchmark::internal::Benchmark* b) {
+  b->Arg(8)->Arg(256)->Arg(4096);
+}
+
+void ListSizes(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(100)->Range(1, 100000);
+}
+
+}  // namespace
+
+#define DINGO_BENCH_KEY_TYPE(T, ...)                       \
+  BENCHMARK_TEMPLATE(BM_V1EncodeKey, T) __VA_ARGS__;       \
+  BENCHMARK_TEMPLATE(BM_V1DecodeKey, T) __VA_ARGS__;       \
+  BENCHMARK_TEMPLATE(BM_V2EncodeKey, T) __VA_ARGS__;       \
+  BENCHMARK_TEMPLATE(BM_V2DecodeKey, T) __VA_ARGS__
+
+#define DINGO_BENCH_VALUE_TYPE(T, ...)                     \
+  BENCHMARK_TEMPLATE(BM_V1EncodeValue, T) __VA_ARGS__;     \
+  BENCHMARK_TEMPLATE(BM_V1DecodeValue, T) __VA_ARGS__;     \
+  BENCHMARK_TEMPLATE(BM_V2EncodeValue, T) __VA_ARGS__;     \
+  BENCHMARK_TEMPLATE(BM_V2DecodeValue, T) __VA_ARGS__
+
+DINGO_BENCH_KEY_TYPE(bool);
+DINGO_BENCH_KEY_TYPE(int32_t);
+DINGO_BENCH_KEY_TYPE(float);
+DINGO_BENCH_KEY_TYPE(int64_t);
+DINGO_BENCH_KEY_TYPE(double);
+DINGO_BENCH_KEY_TYPE(std::string, ->Apply(StringSizes));
+
+BENCHMARK_TEMPLATE(BM_V2EncodeKeyMixedSign, float)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_V2DecodeKeyMixedSign, float)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_V2EncodeKeyMixedSign, double)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_V2DecodeKeyMixedSign, double)->Arg(0)->Arg(1);
+
+BENCHMARK_TEMPLATE(BM_V2EncodeSeriesList, int64_t)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_V2DecodeSeriesList, int64_t)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_V2EncodeSeriesList, double)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_V2DecodeSeriesList, double)->Arg(0)->Arg(1);
+
+BENCHMARK(BM_V2DecodeListTail)->Arg(0)->Arg(1);
+BENCHMARK(BM_V2EncodeFixedStringKey)->Arg(0)->Arg(1);
+BENCHMARK(BM_V2SkipFixedStringKey)->Arg(0)->Arg(1);
+
+DINGO_BENCH_VALUE_TYPE(bool);
+DINGO_BENCH_VALUE_TYPE(int32_t);
+DINGO_BENCH_VALUE_TYPE(float);
+DINGO_BENCH_VALUE_TYPE(int64_t);
+DINGO_BENCH_VALUE_TYPE(double);
+DINGO_BENCH_VALUE_TYPE(std::string, ->Apply(StringSizes));
+DINGO_BENCH_VALUE_TYPE(std::vector<bool>, ->Apply(ListSizes));
+DINGO_BENCH_VALUE_TYPE(std::vector<int32_t>, ->Apply(ListSizes));
+DINGO_BENCH_VALUE_TYPE(std::vector<float>, ->Apply(ListSizes));
+DINGO_BENCH_VALUE_TYPE(std::vector<int64_t>, ->Apply(ListSizes));
+DINGO_BENCH_VALUE_TYPE(std::vector<double>, ->Apply(ListSizes));
+DINGO_BENCH_VALUE_TYPE(std::vector<std::string>, ->Apply(ListSizes));
@@ -0,0 +1,98 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/record/V2/static_record_codec.h"
+
+using dingodb::serialV2::Column;
+using dingodb::serialV2::Key;
+using dingodb::serialV2::Nullable;
+using dingodb::serialV2::RecordDecoderV2;
+using dingodb::serialV2::RecordEncoderV2;
+using dingodb::serialV2::StaticRecordCodec;
+using dingodb::serialV2::Value;
+
+// A lock table row: the key, its owner, lock ts and ttl.
+using LockCodec =
+    StaticRecordCodec<Column<std::string, Key>, Column<int64_t, Key>,
+                      Column<std::string, Value, Nullable>,
+                      Column<int64_t, Value>, Column<int32_t, Value>,
+                      Column<bool, Value>>;
+
+static LockCodec::Row MakeRow() {
+  return {"lock key of the row", 42L, "owner", 1000L, 30, true};
+}
+
+static std::vector<std::any> MakeRecord() {
+  return {std::string("lock key of the row"), int64_t(42),
+          std::string("owner"), int64_t(1000), int32_t(30), true};
+}
+
+static void BM_StaticEncode(benchmark::State& state) {
+  LockCodec codec(0, 0L);
+  auto row = MakeRow();
+  std::string key, value;
+  for (auto _ : state) {
+    codec.Encode('r', row, key, value);
+    benchmark::DoNotOptimize(value.data());
+  }
+}
+
+static void BM_DynamicEncode(benchmark::State& state) {
+  RecordEncoderV2 encoder(0, LockCodec::MakeSchemas(), 0L);
+  auto record = MakeRecord();
+  std::string key, value;
+  for (auto _ : state) {
+    encoder.Encode('r', record, key, value);
+    benchmark::DoNotOptimize(value.data());
+  }
+}
+
+static void BM_StaticDecode(benchmark::State& state) {
+  LockCodec codec(0, 0L);
+  std::string key, value;
+  codec.Encode('r', MakeRow(), key, value);
+  LockCodec::Row row;
+  for (auto _ : state) {
+    codec.Decode(key, value, row);
+    benchmark::DoNotOptimize(&row);
+  }
+}
+
+static void BM_DynamicDecode(benchmark::State& state) {
+  auto schemas = LockCodec::MakeSchemas();
+  RecordEncoderV2 encoder(0, schemas, 0L);
+  std::string key, value;
+  encoder.Encode('r', MakeRecord(), key, value);
+  RecordDecoderV2 decoder(0, schemas, 0L);
+  std::vector<std::any> record;
+  for (auto _ : state) {
+    decoder.Decode(key, value, record);
+    benchmark::DoNotOptimize(record.data());
+  }
+}
+
+BENCHMARK(BM_StaticEncode);
+BENCHMARK(BM_DynamicEncode);
+BENCHMARK(BM_StaticDecode);
+BENCHMARK(BM_DynamicDecode);
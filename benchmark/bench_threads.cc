@@ -0,0 +1,154 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+
+/*
+ * Encode and decode from 1 to all cpus threads, every thread either sharing
+ * one encoder / decoder (and so its schemas) or holding codecs of its own
+ * over schemas of its own. rows/s is over all threads, rows/s/thread the mean of
+ * one thread: the scaling efficiency at n threads is rows/s/thread at n over
+ * rows/s/thread at 1, Shared falling behind PerThread points at contention
+ * in the shared codec.
+ */
+
+using dingodb::serialV2::BaseSchemaPtr;
+using dingodb::serialV2::DingoSchema;
+using dingodb::serialV2::RecordDecoderV2;
+using dingodb::serialV2::RecordEncoderV2;
+
+namespace {
+
+constexpr int64_t kRows = 1000;
+
+std::vector<BaseSchemaPtr> MakeSchemas() {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIsKey(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIsKey(true);
+  auto age = std::make_shared<DingoSchema<int32_t>>();
+  age->SetAllowNull(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetAllowNull(true);
+  auto addr = std::make_shared<DingoSchema<std::string>>();
+  addr->SetAllowNull(true);
+  auto tags = std::make_shared<DingoSchema<std::vector<int64_t>>>();
+  tags->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, name, age, score, addr, tags};
+  for (size_t i = 0; i < schemas.size(); ++i) {
+    schemas[i]->SetIndex(i);
+  }
+  return schemas;
+}
+
+// The read only inputs of every thread and the shared codecs.
+struct Fixture {
+  std::vector<BaseSchemaPtr> schemas = MakeSchemas();
+  std::vector<std::vector<std::any>> records;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  RecordEncoderV2 encoder{0, schemas, 0L};
+  RecordDecoderV2 decoder{0, schemas, 0L};
+
+  Fixture() {
+    for (int64_t i = 0; i < kRows; ++i) {
+      records.push_back({std::any(i), std::any("name " + std::to_string(i)),
+                         std::any(static_cast<int32_t>(i % 100)),
+                         std::any(i * 0.25),
+                         std::any("address of row " + std::to_string(i)),
+                         std::any(std::vector<int64_t>(8, i))});
+    }
+    keys.resize(kRows);
+    values.resize(kRows);
+    for (int64_t i = 0; i < kRows; ++i) {
+      encoder.Encode('r', records[i], keys[i], values[i]);
+    }
+  }
+};
+
+std::unique_ptr<Fixture> fixture;
+
+void SetUp(const benchmark::State&) { fixture = std::make_unique<Fixture>(); }
+void TearDown(const benchmark::State&) { fixture.reset(); }
+
+void ReportThreadRows(benchmark::State& state) {
+  state.SetItemsProcessed(state.iterations() * kRows);
+  state.counters["rows/s/thread"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * kRows),
+      benchmark::Counter::kIsRate | benchmark::Counter::kAvgThreads);
+}
+
+void EncodeRows(benchmark::State& state, const RecordEncoderV2& encoder) {
+  std::string key, value;
+  for (auto _ : state) {
+    for (const auto& record : fixture->records) {
+      encoder.Encode('r', record, key, value);
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  ReportThreadRows(state);
+}
+
+void DecodeRows(benchmark::State& state, const RecordDecoderV2& decoder) {
+  std::vector<std::any> record;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kRows; ++i) {
+      decoder.Decode(std::string_view(fixture->keys[i]),
+                     std::string_view(fixture->values[i]), record);
+      benchmark::DoNotOptimize(record.data());
+    }
+  }
+  ReportThreadRows(state);
+}
+
+void BM_SharedEncode(benchmark::State& state) {
+  EncodeRows(state, fixture->encoder);
+}
+
+void BM_PerThreadEncode(benchmark::State& state) {
+  RecordEncoderV2 encoder(0, MakeSchemas(), 0L);
+  EncodeRows(state, encoder);
+}
+
+void BM_SharedDecode(benchmark::State& state) {
+  DecodeRows(state, fixture->decoder);
+}
+
+void BM_PerThreadDecode(benchmark::State& state) {
+  RecordDecoderV2 decoder(0, MakeSchemas(), 0L);
+  DecodeRows(state, decoder);
+}
+
+void Threads(benchmark::internal::Benchmark* b) {
+  int cpus = std::max(1u, std::thread::hardware_concurrency());
+  b->ThreadRange(1, cpus)->UseRealTime()->Setup(SetUp)->Teardown(TearDown);
+}
+
+}  // namespace
+
+BENCHMARK(BM_SharedEncode)->Apply(Threads);
+BENCHMARK(BM_PerThreadEncode)->Apply(Threads);
+BENCHMARK(BM_SharedDecode)->Apply(Threads);
+BENCHMARK(BM_PerThreadDecode)->Apply(Threads);
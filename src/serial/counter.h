@@ -68,7 +68,7 @@ class Clock {
 
   void Start() {
     if (!m_isStart_) {
-      clock_gettime(CLOCK_REALTIME, &m_start_);
+      clock_gettime(CLOCK_MONOTONIC, &m_start_);
       m_isStart_ = true;
     }
   }
@@ -76,7 +76,7 @@ class Clock {
   void Stop() {
     if (m_isStart_) {
       struct timespec end;
-      clock_gettime(CLOCK_REALTIME, &end);
+      clock_gettime(CLOCK_MONOTONIC, &end);
       Add(m_total_, Diff(m_start_, end));
       m_isStart_ = false;
     }
@@ -92,7 +92,7 @@ class Clock {
   static void Add(struct timespec& dst, const struct timespec& src) {
     dst.tv_sec += src.tv_sec;
     dst.tv_nsec += src.tv_nsec;
-    if (dst.tv_nsec > 1000000000) {
+    if (dst.tv_nsec >= 1000000000) {
       dst.tv_nsec -= 1000000000;
       dst.tv_sec++;
     }
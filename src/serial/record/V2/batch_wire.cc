@@ -0,0 +1,388 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/batch_wire.h"
+
+#include <stdexcept>
+#include <unordered_map>
+
+#include "serial/utils/V2/varint.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+constexpr uint8_t kLittleEndian = 1;
+constexpr uint8_t kBigEndian = 2;
+
+uint8_t WireByteOrder() {
+  uint16_t probe = 1;
+  uint8_t first;
+  memcpy(&first, &probe, 1);
+  return first == 1 ? kLittleEndian : kBigEndian;
+}
+
+bool IsList(BaseSchema::Type type) { return type >= BaseSchema::kBoolList; }
+
+// Bytes of an element of type, 0 for strings.
+int ElementWidth(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::kBool:
+    case BaseSchema::kBoolList:
+      return 1;
+    case BaseSchema::kInteger:
+    case BaseSchema::kFloat:
+    case BaseSchema::kIntegerList:
+    case BaseSchema::kFloatList:
+      return 4;
+    case BaseSchema::kLong:
+    case BaseSchema::kDouble:
+    case BaseSchema::kLongList:
+    case BaseSchema::kDoubleList:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+void PutVarint(std::string& output, uint64_t v) {
+  while (v >= 0x80) {
+    output.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  output.push_back(static_cast<char>(v));
+}
+
+std::string_view ElementString(const ColumnVector& column, size_t i) {
+  const int32_t* offsets = column.Offsets();
+  return std::string_view(column.Chars() + offsets[i],
+                          offsets[i + 1] - offsets[i]);
+}
+
+// The strings [begin, end) of column as varint lengths then their bytes.
+void PutStrings(const ColumnVector& column, size_t begin, size_t end,
+                std::string& body) {
+  const int32_t* offsets = column.Offsets();
+  for (size_t i = begin; i < end; ++i) {
+    PutVarint(body, offsets[i + 1] - offsets[i]);
+  }
+  body.append(column.Chars() + offsets[begin], offsets[end] - offsets[begin]);
+}
+
+// The distinct strings of the rows of column, false when there are more than
+// limit of them.
+bool CollectDictionary(
+    const ColumnVector& column, size_t rows, size_t limit,
+    std::vector<std::string_view>& values,
+    std::unordered_map<std::string_view, uint32_t>& codes) {
+  for (size_t r = 0; r < rows; ++r) {
+    if (column.IsNull(r)) {
+      continue;
+    }
+    auto [it, inserted] = codes.emplace(ElementString(column, r),
+                                        static_cast<uint32_t>(values.size()));
+    if (inserted) {
+      if (values.size() == limit) {
+        return false;
+      }
+      values.push_back(it->first);
+    }
+  }
+  return true;
+}
+
+template <typename T>
+uint64_t ZigZag(T value) {
+  if constexpr (sizeof(T) == 4) {
+    return ZigZagEncode32(value);
+  } else {
+    return ZigZagEncode64(value);
+  }
+}
+
+// The slots of an int32 / int64 column as varints, false when they would not
+// be smaller than the slots.
+template <typename T>
+bool PutVarints(const ColumnVector& column, size_t rows, std::string& body) {
+  size_t size = 0;
+  for (size_t r = 0; r < rows; ++r) {
+    size += VarintLength(ZigZag(column.Get<T>(r)));
+  }
+  if (size >= rows * sizeof(T)) {
+    return false;
+  }
+  body.reserve(size);
+  for (size_t r = 0; r < rows; ++r) {
+    PutVarint(body, ZigZag(column.Get<T>(r)));
+  }
+  return true;
+}
+
+// Reads the wire with the bounds checked.
+struct WireCursor {
+  const char* data;
+  size_t size;
+  size_t pos{0};
+
+  bool Byte(uint8_t& value) {
+    if (pos >= size) {
+      return false;
+    }
+    value = static_cast<uint8_t>(data[pos++]);
+    return true;
+  }
+  bool Varint(uint64_t& value) {
+    int len = ReadVarint(data + pos, size - pos, value);
+    pos += len;
+    return len > 0;
+  }
+  bool Bytes(size_t len, const char*& bytes) {
+    if (len > size - pos) {
+      return false;
+    }
+    bytes = data + pos;
+    pos += len;
+    return true;
+  }
+};
+
+// count strings of varint lengths then their bytes.
+bool ReadStrings(WireCursor& body, size_t count,
+                 std::vector<std::string_view>& strings) {
+  strings.resize(count);
+  std::vector<uint64_t> lengths(count);
+  uint64_t total = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (!body.Varint(lengths[i]) || lengths[i] > body.size) {
+      return false;
+    }
+    total += lengths[i];
+  }
+  const char* chars;
+  if (!body.Bytes(total, chars)) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    strings[i] = std::string_view(chars, lengths[i]);
+    chars += lengths[i];
+  }
+  return true;
+}
+
+}  // namespace
+
+int EncodeBatchWire(const ColumnBatch& batch, const BatchWireOptions& options,
+                    std::string& output) {
+  size_t start = output.size();
+  size_t rows = batch.NumRows();
+  output.push_back(static_cast<char>(BatchWireReader::kVersion));
+  output.push_back(static_cast<char>(WireByteOrder()));
+  PutVarint(output, rows);
+  PutVarint(output, batch.NumColumns());
+
+  std::string body;
+  std::vector<std::string_view> values;
+  std::unordered_map<std::string_view, uint32_t> codes;
+  for (size_t i = 0; i < batch.NumColumns(); ++i) {
+    const ColumnVector& column = batch.Column(i);
+    if (column.Size() != rows) {
+      throw std::runtime_error("Column size differs from batch rows.");
+    }
+    BaseSchema::Type type = column.GetType();
+    int width = ElementWidth(type);
+    auto encoding = BatchWireReader::kPlain;
+    body.clear();
+
+    if (IsList(type)) {
+      const int32_t* list_offsets = column.ListOffsets();
+      for (size_t r = 0; r < rows; ++r) {
+        PutVarint(body, list_offsets[r + 1] - list_offsets[r]);
+      }
+      size_t count = list_offsets[rows];
+      if (width > 0) {
+        body.append(column.Values(), count * width);
+      } else {
+        PutStrings(column, 0, count, body);
+      }
+    } else if (type == BaseSchema::kString) {
+      values.clear();
+      codes.clear();
+      if (options.dictionary && options.dictionary_ratio > 0 && rows > 0 &&
+          CollectDictionary(column, rows, rows / options.dictionary_ratio,
+                            values, codes)) {
+        encoding = BatchWireReader::kDictionary;
+        PutVarint(body, values.size());
+        for (auto value : values) {
+          PutVarint(body, value.size());
+        }
+        for (auto value : values) {
+          body.append(value.data(), value.size());
+        }
+        for (size_t r = 0; r < rows; ++r) {
+          PutVarint(body, column.IsNull(r) ? 0
+                                           : codes[ElementString(column, r)]);
+        }
+      } else {
+        PutStrings(column, 0, rows, body);
+      }
+    } else if (options.varint && type == BaseSchema::kInteger &&
+               PutVarints<int32_t>(column, rows, body)) {
+      encoding = BatchWireReader::kVarint;
+    } else if (options.varint && type == BaseSchema::kLong &&
+               PutVarints<int64_t>(column, rows, body)) {
+      encoding = BatchWireReader::kVarint;
+    } else {
+      body.assign(column.Values(), rows * width);
+    }
+
+    bool has_nulls = column.NullCount() > 0;
+    output.push_back(static_cast<char>(type));
+    output.push_back(static_cast<char>(encoding));
+    output.push_back(has_nulls ? 1 : 0);
+    size_t validity_size = has_nulls ? (rows + 7) / 8 : 0;
+    PutVarint(output, validity_size + body.size());
+    output.append(reinterpret_cast<const char*>(column.Validity()),
+                  validity_size);
+    output.append(body);
+  }
+  return output.size() - start;
+}
+
+int EncodeBatchWire(const ColumnBatch& batch, std::string& output) {
+  return EncodeBatchWire(batch, BatchWireOptions(), output);
+}
+
+int BatchWireReader::Open(std::string_view data) {
+  num_rows_ = 0;
+  columns_.clear();
+
+  WireCursor wire{data.data(), data.size()};
+  uint8_t version, order;
+  uint64_t rows, column_cnt;
+  if (!wire.Byte(version) || version != kVersion || !wire.Byte(order) ||
+      order != WireByteOrder() || !wire.Varint(rows) ||
+      !wire.Varint(column_cnt) || rows > data.size() * 8 ||
+      column_cnt > data.size()) {
+    return -1;
+  }
+
+  columns_.resize(column_cnt);
+  for (auto& column : columns_) {
+    uint8_t type, encoding, has_nulls;
+    uint64_t body_size;
+    const char* body_data;
+    if (!wire.Byte(type) || type > BaseSchema::kStringList ||
+        !wire.Byte(encoding) || encoding > kDictionary ||
+        !wire.Byte(has_nulls) || !wire.Varint(body_size) ||
+        !wire.Bytes(body_size, body_data)) {
+      return -1;
+    }
+    column.type_ = static_cast<BaseSchema::Type>(type);
+    column.encoding_ = static_cast<Encoding>(encoding);
+    int width = ElementWidth(column.type_);
+
+    WireCursor body{body_data, body_size};
+    column.validity_ = nullptr;
+    if (has_nulls != 0 && !body.Bytes((rows + 7) / 8, column.validity_)) {
+      return -1;
+    }
+
+    if (IsList(column.type_)) {
+      if (encoding != kPlain) {
+        return -1;
+      }
+      column.list_offsets_.resize(rows + 1);
+      column.list_offsets_[0] = 0;
+      for (size_t r = 0; r < rows; ++r) {
+        uint64_t size;
+        if (!body.Varint(size) || size > body_size) {
+          return -1;
+        }
+        column.list_offsets_[r + 1] = column.list_offsets_[r] + size;
+      }
+      size_t count = column.list_offsets_[rows];
+      if (width > 0) {
+        if (!body.Bytes(count * width, column.values_)) {
+          return -1;
+        }
+      } else if (!ReadStrings(body, count, column.strings_)) {
+        return -1;
+      }
+    } else if (column.type_ == BaseSchema::kString) {
+      if (encoding == kDictionary) {
+        uint64_t value_cnt;
+        std::vector<std::string_view> values;
+        if (!body.Varint(value_cnt) || value_cnt > body_size ||
+            !ReadStrings(body, value_cnt, values)) {
+          return -1;
+        }
+        column.strings_.resize(rows);
+        for (size_t r = 0; r < rows; ++r) {
+          uint64_t code;
+          if (!body.Varint(code)) {
+            return -1;
+          }
+          if (column.IsNull(r)) {
+            column.strings_[r] = std::string_view();
+          } else if (code < value_cnt) {
+            column.strings_[r] = values[code];
+          } else {
+            return -1;
+          }
+        }
+      } else if (encoding != kPlain ||
+                 !ReadStrings(body, rows, column.strings_)) {
+        return -1;
+      }
+    } else if (encoding == kVarint) {
+      if (column.type_ != BaseSchema::kInteger &&
+          column.type_ != BaseSchema::kLong) {
+        return -1;
+      }
+      column.expanded_.resize(rows * width);
+      char* slot = column.expanded_.data();
+      for (size_t r = 0; r < rows; ++r, slot += width) {
+        uint64_t v;
+        if (!body.Varint(v)) {
+          return -1;
+        }
+        if (width == 4) {
+          int32_t value = ZigZagDecode32(static_cast<uint32_t>(v));
+          memcpy(slot, &value, 4);
+        } else {
+          int64_t value = ZigZagDecode64(v);
+          memcpy(slot, &value, 8);
+        }
+      }
+      column.values_ = column.expanded_.data();
+    } else if (encoding != kPlain ||
+               !body.Bytes(rows * width, column.values_)) {
+      return -1;
+    }
+
+    if (body.pos != body.size) {
+      return -1;
+    }
+  }
+
+  if (wire.pos != wire.size) {
+    return -1;
+  }
+  num_rows_ = rows;
+  return 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,147 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_BATCH_WIRE_V2_H_
+#define DINGO_SERIAL_BATCH_WIRE_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/column_batch.h"
+#include "serial/schema/V2/base_schema.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * The wire form of a decoded ColumnBatch, for scan results sent from the
+ * store to an executor that knows the projection: column after column, no
+ * key prefix, codec version or value header per row.
+ *
+ *   version(1) | byte order(1) | rows(varint) | columns(varint) | column...
+ *   column: type(1) | encoding(1) | has nulls(1) | body size(varint) |
+ *           [validity bitmap] | body
+ *
+ * A fixed width column is its slots in the byte order of the writer, or with
+ * kVarint zigzag varints. A string column is varint lengths then the bytes,
+ * or with kDictionary its distinct values then a varint code per row. A list
+ * column is varint list sizes then its elements as the plain element column.
+ * Null rows keep a zero or empty slot. Both ends must share the byte order,
+ * which the reader checks.
+ */
+struct BatchWireOptions {
+  // int32 / int64 columns as varints when that is smaller.
+  bool varint{true};
+  // string columns with at most one distinct value in dictionary_ratio rows
+  // as dictionary codes.
+  bool dictionary{true};
+  int dictionary_ratio{4};
+};
+
+// Append batch to output in the wire form, returns the appended length.
+int EncodeBatchWire(const ColumnBatch& batch, const BatchWireOptions& options,
+                    std::string& output);
+int EncodeBatchWire(const ColumnBatch& batch, std::string& output);
+
+class BatchWireReader {
+ public:
+  static constexpr uint8_t kVersion = 1;
+
+  enum Encoding : uint8_t {
+    kPlain = 0,
+    kVarint = 1,
+    kDictionary = 2,
+  };
+
+  // One column read from the wire. Fixed width plain slots and all string
+  // bytes are read in place, varints are expanded once by Open.
+  class Column {
+   public:
+    BaseSchema::Type GetType() const { return type_; }
+    Encoding GetEncoding() const { return encoding_; }
+
+    bool IsNull(size_t row) const {
+      return validity_ != nullptr &&
+             (static_cast<uint8_t>(validity_[row >> 3]) & (1 << (row & 7))) ==
+                 0;
+    }
+
+    template <typename T>
+    T Get(size_t row) const {
+      return Element<T>(row);
+    }
+    std::string_view GetString(size_t row) const { return strings_[row]; }
+
+    size_t ListSize(size_t row) const {
+      return list_offsets_[row + 1] - list_offsets_[row];
+    }
+    template <typename T>
+    T GetListElement(size_t row, size_t i) const {
+      return Element<T>(list_offsets_[row] + i);
+    }
+    std::string_view GetListString(size_t row, size_t i) const {
+      return strings_[list_offsets_[row] + i];
+    }
+
+   private:
+    friend class BatchWireReader;
+
+    template <typename T>
+    T Element(size_t i) const {
+      T value;
+      memcpy(&value, values_ + i * sizeof(T), sizeof(T));
+      return value;
+    }
+
+    BaseSchema::Type type_{BaseSchema::kBool};
+    Encoding encoding_{kPlain};
+    const char* validity_{nullptr};
+    // into the wire, or expanded_.
+    const char* values_{nullptr};
+    std::string expanded_;
+    std::vector<std::string_view> strings_;
+    std::vector<uint32_t> list_offsets_;
+  };
+
+  BatchWireReader() = default;
+  // the columns point into themselves.
+  BatchWireReader(const BatchWireReader&) = delete;
+  BatchWireReader& operator=(const BatchWireReader&) = delete;
+
+  // Parse data, which must outlive the reader. Returns -1 when data is not a
+  // well formed batch of this version and byte order.
+  int Open(std::string_view data);
+
+  size_t NumRows() const { return num_rows_; }
+  size_t NumColumns() const { return columns_.size(); }
+  const Column& GetColumn(size_t i) const { return columns_[i]; }
+
+ private:
+  size_t num_rows_{0};
+  std::vector<Column> columns_;
+};
+
+template <>
+inline bool BatchWireReader::Column::Element<bool>(size_t i) const {
+  return values_[i] != 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,239 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "chunked_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "serial/record/V2/common.h"
+#include "serial/record/V2/value_header.h"
+#include "serial/utils/V2/buf_view.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// the layouts whose column bytes are not found from the tables alone, or
+// are only known good once the value is complete.
+constexpr int kWholeValueFlags =
+    VALUE_FORMAT_COMPRESSED | VALUE_FORMAT_CHECKSUM |
+    VALUE_FORMAT_STATIC_OFFSETS | VALUE_FORMAT_BOOL_BITS;
+
+}  // namespace
+
+ChunkedValueDecoder::ChunkedValueDecoder(const RecordDecoderV2& decoder)
+    : decoder_(decoder) {
+  for (const auto& column : decoder_.columns_) {
+    if (column.schema == nullptr || column.is_key || column.index < 0) {
+      continue;
+    }
+    if (static_cast<size_t>(column.index) >= by_index_.size()) {
+      by_index_.resize(column.index + 1, nullptr);
+    }
+    by_index_[column.index] = &column;
+  }
+}
+
+int ChunkedValueDecoder::Begin(std::string_view key, RowSink& sink) {
+  state_ = State::kIdle;
+  sink_ = &sink;
+  key_.assign(key.data(), key.size());
+  buffer_.clear();
+  base_ = 0;
+  peak_buffered_ = 0;
+  spans_.clear();
+  next_span_ = 0;
+  decoded_columns_ = 0;
+
+  // the prefix, common id and reverse tag as RecordDecoderV2::Decode checks
+  // them.
+  if (key.size() < 13 ||
+      memcmp(key.data() + 1, decoder_.encoded_common_id_, 8) != 0 ||
+      BufView(key, decoder_.le_).ReadInt(key.size() - 4) !=
+          decoder_.codec_version_) {
+    return Fail();
+  }
+  state_ = State::kHeader;
+  return 0;
+}
+
+int ChunkedValueDecoder::Append(std::string_view chunk) {
+  switch (state_) {
+    case State::kHeader: {
+      Hold(chunk);
+      int ret = ReadHeader();
+      if (ret <= 0) {
+        return ret;
+      }
+      return DecodeReady(false);
+    }
+    case State::kColumns:
+      Hold(chunk);
+      return DecodeReady(false);
+    case State::kWhole:
+      Hold(chunk);
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+int ChunkedValueDecoder::Finish() {
+  switch (state_) {
+    case State::kHeader:
+      // the tables never came in whole.
+      return Fail();
+    case State::kColumns:
+      if (DecodeReady(true) < 0) {
+        return -1;
+      }
+      break;
+    case State::kWhole:
+      if (decoder_.Decode(key_, buffer_, *sink_) < 0) {
+        return Fail();
+      }
+      decoded_columns_ = by_index_.size() - std::count(by_index_.begin(),
+                                                       by_index_.end(),
+                                                       nullptr);
+      break;
+    default:
+      return -1;
+  }
+  buffer_.clear();
+  state_ = State::kDone;
+  return 0;
+}
+
+int ChunkedValueDecoder::Fail() {
+  state_ = State::kFailed;
+  return decoder_.DecodeFailure();
+}
+
+void ChunkedValueDecoder::Hold(std::string_view chunk) {
+  buffer_.append(chunk.data(), chunk.size());
+  peak_buffered_ = std::max(peak_buffered_, buffer_.size());
+}
+
+int ChunkedValueDecoder::ReadHeader() {
+  if (buffer_.size() < 4) {
+    return 0;
+  }
+  BufView value_buf(buffer_, decoder_.le_);
+  int32_t version = value_buf.ReadInt();
+  int format = GetValueFormat(version);
+  if ((format & ~kValueFormatKnownFlags) != 0 ||
+      (version & kSchemaVersionMask) > decoder_.schema_version_ ||
+      (decoder_.verify_checksums_ && !(format & VALUE_FORMAT_CHECKSUM))) {
+    return Fail();
+  }
+  if (format & kWholeValueFlags) {
+    state_ = State::kWhole;
+    return 0;
+  }
+  if (buffer_.size() < 8) {
+    return 0;
+  }
+
+  ValueHeader header(value_buf, format);
+  if (header.cnt_not_null_col < 0 || header.cnt_null_col < 0) {
+    return Fail();
+  }
+  if (buffer_.size() < static_cast<size_t>(header.data_pos)) {
+    return 0;
+  }
+
+  std::vector<bool> not_null(by_index_.size(), false);
+  for (int i = 0; i < header.entry_cnt; ++i) {
+    int offset = header.ReadOffset(value_buf, i);
+    if (offset == -1) {
+      continue;
+    }
+    if (offset < header.data_pos) {
+      return Fail();
+    }
+    int id = header.ReadId(value_buf, i);
+    const RecordDecoderV2::Column* column =
+        id >= 0 && static_cast<size_t>(id) < by_index_.size() ? by_index_[id]
+                                                              : nullptr;
+    if (column != nullptr) {
+      not_null[id] = true;
+    }
+    spans_.push_back({offset, column});
+  }
+  std::stable_sort(
+      spans_.begin(), spans_.end(),
+      [](const Span& lhs, const Span& rhs) { return lhs.offset < rhs.offset; });
+
+  // the key columns and the null ones need nothing more.
+  BufView key_buf(key_, decoder_.le_);
+  key_buf.Skip(9);
+  for (const auto& column : decoder_.columns_) {
+    if (column.schema != nullptr && column.is_key) {
+      column.schema->DecodeKey(key_buf, *sink_, column.index);
+    }
+  }
+  for (size_t id = 0; id < by_index_.size(); ++id) {
+    if (by_index_[id] != nullptr && !not_null[id]) {
+      sink_->OnNull(id);
+      ++decoded_columns_;
+    }
+  }
+
+  buffer_.erase(0, header.data_pos);
+  base_ = header.data_pos;
+  state_ = State::kColumns;
+  return 1;
+}
+
+int ChunkedValueDecoder::DecodeReady(bool complete) {
+  size_t held_end = base_ + buffer_.size();
+  for (; next_span_ < spans_.size(); ++next_span_) {
+    const Span& span = spans_[next_span_];
+    size_t end;
+    if (next_span_ + 1 < spans_.size()) {
+      end = spans_[next_span_ + 1].offset;
+    } else if (complete) {
+      end = held_end;
+    } else {
+      // the last column runs to the value end, unknown until Finish.
+      break;
+    }
+    if (end > held_end) {
+      if (complete) {
+        return Fail();
+      }
+      break;
+    }
+    if (span.column != nullptr) {
+      BufView column_buf(
+          std::string_view(buffer_).substr(0, end - base_), decoder_.le_);
+      span.column->schema->DecodeValue(column_buf, span.offset - base_,
+                                       *sink_, span.column->index);
+      ++decoded_columns_;
+    }
+  }
+
+  // keep the bytes from the first column not decoded on.
+  size_t keep_from = next_span_ < spans_.size()
+                         ? static_cast<size_t>(spans_[next_span_].offset)
+                         : held_end;
+  buffer_.erase(0, keep_from - base_);
+  base_ = keep_from;
+  return 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
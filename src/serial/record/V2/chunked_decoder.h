@@ -0,0 +1,114 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_CHUNKED_DECODER_V2_H_
+#define DINGO_SERIAL_CHUNKED_DECODER_V2_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/record_decoder.h"
+#include "serial/schema/V2/row_sink.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Decodes a row whose value arrives in chunks, e.g. a large value read from
+ * the network or a paged store, without waiting for the whole of it.
+ *
+ * Once the header and the id and offset tables are in, the key columns and
+ * the null ones go to the sink, then every value column as soon as the
+ * bytes up to the next column are, in the order of their offsets. The bytes
+ * of a column decoded are let go, a row holds its tables and about its
+ * largest column instead of the whole value. A column is decoded whole, the
+ * elements of a list once it is complete: the delta, xor and packed list
+ * encodings need all of their bytes.
+ *
+ * The plain, compact header, null bitmap and sparse layouts are decoded so;
+ * a value compressed, checksummed, with static offsets or bool bits is kept
+ * whole and decoded at Finish as by RecordDecoderV2::Decode.
+ *
+ *   ChunkedValueDecoder chunked(decoder);
+ *   chunked.Begin(key, sink);
+ *   while (...) chunked.Append(chunk);
+ *   chunked.Finish();
+ *
+ * One row at a time, the decoder and the sink must outlive the row; not
+ * thread safe.
+ */
+class ChunkedValueDecoder {
+ public:
+  explicit ChunkedValueDecoder(const RecordDecoderV2& decoder);
+
+  ChunkedValueDecoder(const ChunkedValueDecoder&) = delete;
+  ChunkedValueDecoder& operator=(const ChunkedValueDecoder&) = delete;
+
+  // Start the row of key, the columns go to sink by schema index as in
+  // RecordDecoderV2::Decode. key is copied. Returns -1 when it is not a key
+  // of the decoder's table.
+  int Begin(std::string_view key, RowSink& sink);
+  // The next bytes of the value. Returns -1 when the value fails its checks
+  // or the row failed before, the sink then holds a part of the row.
+  int Append(std::string_view chunk);
+  // The value is complete, decode the rest. Returns -1 when it fails its
+  // checks or ends before a column but the last; one cut inside the last
+  // column throws std::out_of_range as RecordDecoderV2::Decode.
+  int Finish();
+
+  // value columns passed to the sink so far, null ones included.
+  int DecodedColumns() const { return decoded_columns_; }
+  // value bytes held, and the most held at once since Begin.
+  size_t BufferedBytes() const { return buffer_.size(); }
+  size_t PeakBufferedBytes() const { return peak_buffered_; }
+
+ private:
+  enum class State { kIdle, kHeader, kColumns, kWhole, kDone, kFailed };
+
+  // a column of the value tables, column nullptr for one the decoder does
+  // not know, its bytes are skipped.
+  struct Span {
+    int offset;
+    const RecordDecoderV2::Column* column;
+  };
+
+  int Fail();
+  // parse the tables once buffered, -1 when they are wrong.
+  int ReadHeader();
+  // decode the columns whose bytes are in, all of them when complete.
+  int DecodeReady(bool complete);
+  void Hold(std::string_view chunk);
+
+  const RecordDecoderV2& decoder_;
+  // value column of a schema index, nullptr for none.
+  std::vector<const RecordDecoderV2::Column*> by_index_;
+
+  State state_{State::kIdle};
+  RowSink* sink_{nullptr};
+  std::string key_;
+  // the value bytes from value offset base_ on.
+  std::string buffer_;
+  size_t base_{0};
+  size_t peak_buffered_{0};
+  std::vector<Span> spans_;
+  size_t next_span_{0};
+  int decoded_columns_{0};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,59 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DINGO_SERIAL_COLUMN_AGGREGATE_V2_H_
+#define DINGO_SERIAL_COLUMN_AGGREGATE_V2_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace dingodb {
+namespace serialV2 {
+
+// COUNT, SUM, MIN and MAX of a value column, see RecordDecoderV2::Aggregate.
+// Integer columns fill the int_ fields, their sum wrapping as int64 does,
+// float and double columns the double ones, NaN is summed but not ranked.
+// Min and max keep their start values until a value is ranked.
+struct ColumnAggregate {
+  int64_t count{0};
+  int64_t null_count{0};
+
+  int64_t int_sum{0};
+  int64_t int_min{std::numeric_limits<int64_t>::max()};
+  int64_t int_max{std::numeric_limits<int64_t>::min()};
+
+  double sum{0};
+  double min{std::numeric_limits<double>::infinity()};
+  double max{-std::numeric_limits<double>::infinity()};
+
+  // Add the rows of other, e.g. aggregated by another thread.
+  void Merge(const ColumnAggregate& other) {
+    count += other.count;
+    null_count += other.null_count;
+    int_sum = static_cast<int64_t>(static_cast<uint64_t>(int_sum) +
+                                   static_cast<uint64_t>(other.int_sum));
+    int_min = std::min(int_min, other.int_min);
+    int_max = std::max(int_max, other.int_max);
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
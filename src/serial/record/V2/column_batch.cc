@@ -0,0 +1,113 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "column_batch.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+ColumnVector::ColumnVector(BaseSchema::Type type) : type_(type) {}
+
+int ColumnVector::ElementWidth() const {
+  switch (type_) {
+    case BaseSchema::kBool:
+    case BaseSchema::kBoolList:
+      return 1;
+    case BaseSchema::kInteger:
+    case BaseSchema::kFloat:
+    case BaseSchema::kIntegerList:
+    case BaseSchema::kFloatList:
+      return 4;
+    case BaseSchema::kLong:
+    case BaseSchema::kDouble:
+    case BaseSchema::kLongList:
+    case BaseSchema::kDoubleList:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+void ColumnVector::Clear() {
+  size_ = 0;
+  null_count_ = 0;
+  validity_.clear();
+  values_.clear();
+  offsets_.resize(1);
+  chars_.clear();
+  list_offsets_.resize(1);
+}
+
+void ColumnVector::AppendValid() {
+  if ((size_ & 7) == 0) {
+    validity_.push_back(0);
+  }
+  validity_.back() |= 1 << (size_ & 7);
+  ++size_;
+}
+
+void ColumnVector::AppendNull() {
+  if ((size_ & 7) == 0) {
+    validity_.push_back(0);
+  }
+  ++size_;
+  ++null_count_;
+
+  // keep one slot per row.
+  if (IsList()) {
+    list_offsets_.push_back(list_offsets_.back());
+  } else if (HasStringElements()) {
+    offsets_.push_back(chars_.size());
+  } else {
+    values_.append(ElementWidth(), 0);
+  }
+}
+
+void ColumnVector::AppendString(std::string_view value) {
+  AppendValid();
+  AppendElement(value);
+}
+
+void ColumnVector::AppendStringList(const std::vector<std::string>& value) {
+  AppendValid();
+  for (const auto& element : value) {
+    AppendElement(std::string_view(element));
+  }
+  list_offsets_.push_back(list_offsets_.back() + value.size());
+}
+
+void ColumnBatch::Reset(const std::vector<BaseSchema::Type>& types) {
+  num_rows_ = 0;
+
+  bool same = types.size() == columns_.size();
+  for (size_t i = 0; same && i < types.size(); ++i) {
+    same = columns_[i].GetType() == types[i];
+  }
+
+  if (!same) {
+    columns_.clear();
+    columns_.reserve(types.size());
+    for (auto type : types) {
+      columns_.emplace_back(type);
+    }
+    return;
+  }
+
+  for (auto& column : columns_) {
+    column.Clear();
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
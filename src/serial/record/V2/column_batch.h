@@ -0,0 +1,294 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_COLUMN_BATCH_V2_H_
+#define DINGO_SERIAL_COLUMN_BATCH_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+#include "serial/schema/V2/row_sink.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * The buffers of one column of a batch, borrowed from their owner (a
+ * ColumnVector, or an Arrow array with bools widened to 1 byte), laid out as
+ * ColumnVector below describes. validity may be nullptr when no row is null,
+ * the buffers a type does not use are left nullptr.
+ */
+struct ColumnArray {
+  BaseSchema::Type type;
+  const uint8_t* validity{nullptr};
+  const char* values{nullptr};
+  const int32_t* offsets{nullptr};
+  const char* chars{nullptr};
+  const int32_t* list_offsets{nullptr};
+
+  bool IsNull(size_t row) const {
+    return validity != nullptr && (validity[row >> 3] & (1 << (row & 7))) == 0;
+  }
+
+  template <typename T>
+  T Get(size_t row) const {
+    T value;
+    memcpy(&value, values + row * sizeof(T), sizeof(T));
+    return value;
+  }
+  std::string_view GetString(size_t row) const {
+    return std::string_view(chars + offsets[row],
+                            offsets[row + 1] - offsets[row]);
+  }
+
+  // List accessors, the elements of row are [ListBegin, ListEnd) of the
+  // values or strings.
+  size_t ListBegin(size_t row) const { return list_offsets[row]; }
+  size_t ListEnd(size_t row) const { return list_offsets[row + 1]; }
+};
+
+template <>
+inline bool ColumnArray::Get<bool>(size_t row) const {
+  return values[row] != 0;
+}
+
+/*
+ * One decoded column of a batch, laid out Arrow style:
+ *   validity: bit i set when row i is not null.
+ *   fixed width types: values holds one element per row (bool as 1 byte).
+ *   strings: offsets (rows + 1 entries) into chars.
+ *   lists: list_offsets (rows + 1 entries) into the elements, which are
+ *   stored in values or offsets/chars like above.
+ * Null rows still take an (empty or zero) slot.
+ */
+class ColumnVector {
+ public:
+  explicit ColumnVector(BaseSchema::Type type);
+
+  BaseSchema::Type GetType() const { return type_; }
+  size_t Size() const { return size_; }
+  size_t NullCount() const { return null_count_; }
+
+  bool IsNull(size_t row) const {
+    return (validity_[row >> 3] & (1 << (row & 7))) == 0;
+  }
+
+  // Fixed width value of row, T must match the column type.
+  template <typename T>
+  T Get(size_t row) const {
+    return GetElement<T>(row);
+  }
+  std::string_view GetString(size_t row) const { return GetStringElement(row); }
+
+  // List accessors, i is the position inside the list of row.
+  size_t ListSize(size_t row) const {
+    return list_offsets_[row + 1] - list_offsets_[row];
+  }
+  template <typename T>
+  T GetListElement(size_t row, size_t i) const {
+    return GetElement<T>(list_offsets_[row] + i);
+  }
+  std::string_view GetListString(size_t row, size_t i) const {
+    return GetStringElement(list_offsets_[row] + i);
+  }
+
+  // The buffers as a ColumnArray, valid until the next append or Clear.
+  ColumnArray Array() const {
+    return {type_,          validity_.data(), values_.data(),
+            offsets_.data(), chars_.data(),    list_offsets_.data()};
+  }
+
+  // raw buffers.
+  const uint8_t* Validity() const { return validity_.data(); }
+  const char* Values() const { return values_.data(); }
+  const int32_t* Offsets() const { return offsets_.data(); }
+  const char* Chars() const { return chars_.data(); }
+  const int32_t* ListOffsets() const { return list_offsets_.data(); }
+
+  // Drop all rows, the buffers keep their capacity.
+  void Clear();
+
+  // appenders.
+  void AppendNull();
+  template <typename T>
+  void Append(T value) {
+    AppendValid();
+    AppendElement(value);
+  }
+  void AppendString(std::string_view value);
+  template <typename T>
+  void AppendList(const std::vector<T>& value) {
+    AppendValid();
+    for (const auto& element : value) {
+      AppendElement(static_cast<T>(element));
+    }
+    list_offsets_.push_back(list_offsets_.back() + value.size());
+  }
+  void AppendStringList(const std::vector<std::string>& value);
+
+ private:
+  bool IsList() const { return type_ >= BaseSchema::kBoolList; }
+  bool HasStringElements() const {
+    return type_ == BaseSchema::kString || type_ == BaseSchema::kStringList;
+  }
+  int ElementWidth() const;
+
+  void AppendValid();
+
+  template <typename T>
+  void AppendElement(T value) {
+    values_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  void AppendElement(bool value) { values_.push_back(value ? 1 : 0); }
+  void AppendElement(std::string_view value) {
+    chars_.append(value.data(), value.size());
+    offsets_.push_back(chars_.size());
+  }
+
+  template <typename T>
+  T GetElement(size_t i) const {
+    T value;
+    memcpy(&value, values_.data() + i * sizeof(T), sizeof(T));
+    return value;
+  }
+  std::string_view GetStringElement(size_t i) const {
+    return std::string_view(chars_.data() + offsets_[i],
+                            offsets_[i + 1] - offsets_[i]);
+  }
+
+  BaseSchema::Type type_;
+  size_t size_{0};
+  size_t null_count_{0};
+
+  std::vector<uint8_t> validity_;
+  std::string values_;
+  std::vector<int32_t> offsets_{0};
+  std::string chars_;
+  std::vector<int32_t> list_offsets_{0};
+};
+
+template <>
+inline bool ColumnVector::GetElement<bool>(size_t i) const {
+  return values_[i] != 0;
+}
+
+// Decoded columns of a batch of rows, one ColumnVector per output slot.
+class ColumnBatch {
+ public:
+  ColumnBatch() = default;
+
+  size_t NumRows() const { return num_rows_; }
+  size_t NumColumns() const { return columns_.size(); }
+
+  ColumnVector& Column(size_t i) { return columns_[i]; }
+  const ColumnVector& Column(size_t i) const { return columns_[i]; }
+
+  // Set up (reusing the buffers when the types are unchanged) the columns.
+  void Reset(const std::vector<BaseSchema::Type>& types);
+  void SetNumRows(size_t num_rows) { num_rows_ = num_rows; }
+
+ private:
+  size_t num_rows_{0};
+  std::vector<ColumnVector> columns_;
+};
+
+// RowSink appending every value to the matching column of a batch.
+class ColumnBatchSink : public RowSink {
+ public:
+  explicit ColumnBatchSink(ColumnBatch& batch) : batch_(batch) {}
+
+  void OnNull(int col) override { batch_.Column(col).AppendNull(); }
+
+  void OnBool(int col, bool value) override { batch_.Column(col).Append(value); }
+  void OnInt32(int col, int32_t value) override {
+    batch_.Column(col).Append(value);
+  }
+  void OnInt64(int col, int64_t value) override {
+    batch_.Column(col).Append(value);
+  }
+  void OnFloat(int col, float value) override {
+    batch_.Column(col).Append(value);
+  }
+  void OnDouble(int col, double value) override {
+    batch_.Column(col).Append(value);
+  }
+  void OnString(int col, std::string_view value) override {
+    batch_.Column(col).AppendString(value);
+  }
+
+  void OnBoolList(int col, std::vector<bool>&& value) override {
+    Append(col, value, bools_);
+  }
+  void OnInt32List(int col, std::vector<int32_t>&& value) override {
+    Append(col, value, ints_);
+  }
+  void OnInt64List(int col, std::vector<int64_t>&& value) override {
+    Append(col, value, longs_);
+  }
+  void OnFloatList(int col, std::vector<float>&& value) override {
+    Append(col, value, floats_);
+  }
+  void OnDoubleList(int col, std::vector<double>&& value) override {
+    Append(col, value, doubles_);
+  }
+  void OnStringList(int col, std::vector<std::string>&& value) override {
+    batch_.Column(col).AppendStringList(value);
+    strings_.swap(value);
+  }
+
+  // The lists are decoded into the same scratch row after row, their
+  // elements are copied into the column.
+  void ReuseList(int, std::vector<bool>& list) override { list.swap(bools_); }
+  void ReuseList(int, std::vector<int32_t>& list) override {
+    list.swap(ints_);
+  }
+  void ReuseList(int, std::vector<int64_t>& list) override {
+    list.swap(longs_);
+  }
+  void ReuseList(int, std::vector<float>& list) override {
+    list.swap(floats_);
+  }
+  void ReuseList(int, std::vector<double>& list) override {
+    list.swap(doubles_);
+  }
+  void ReuseList(int, std::vector<std::string>& list) override {
+    list.swap(strings_);
+  }
+
+ private:
+  template <typename T>
+  void Append(int col, std::vector<T>& value, std::vector<T>& scratch) {
+    batch_.Column(col).AppendList(value);
+    scratch.swap(value);
+  }
+
+  ColumnBatch& batch_;
+
+  std::vector<bool> bools_;
+  std::vector<int32_t> ints_;
+  std::vector<int64_t> longs_;
+  std::vector<float> floats_;
+  std::vector<double> doubles_;
+  std::vector<std::string> strings_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,98 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_COLUMN_DESCRIPTOR_V2_H_
+#define DINGO_SERIAL_COLUMN_DESCRIPTOR_V2_H_
+
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+#include "serial/schema/V2/string_schema.h"
+#include "serial/utils/V2/buf_view.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * What the per row loops of the codecs need to know of a column, copied out
+ * of its schema once so that a row walks one contiguous array instead of
+ * following a pointer per column. Schemas are still how columns are declared,
+ * schema is kept for the encodings the loops leave to it.
+ */
+struct ColumnDescriptor {
+  // nullptr for a null schema, the other fields are then meaningless.
+  BaseSchema* schema;
+  BaseSchema::Type type;
+  // the schema index, the column id of a value column.
+  int index;
+  bool is_key;
+  bool allow_null;
+  // bytes of the key with its null flag, 0 when it varies.
+  int key_length;
+  // bytes of a not null value, 0 when it varies.
+  int value_length;
+  // position among the value columns, -1 for key columns.
+  int value_slot;
+
+  void SkipKey(BufView& buf) const {
+    if (key_length > 0) {
+      buf.Skip(key_length);
+    } else {
+      schema->SkipKey(buf);
+    }
+  }
+};
+
+inline bool IsFixedLengthType(BaseSchema::Type type) {
+  return type <= BaseSchema::kDouble && type != BaseSchema::kString;
+}
+
+// The fixed length types and the fixed length strings.
+inline bool HasFixedLength(BaseSchema* schema) {
+  return IsFixedLengthType(schema->GetType()) ||
+         (schema->GetType() == BaseSchema::kString &&
+          static_cast<DingoSchema<std::string>*>(schema)->GetFixedLength() > 0);
+}
+
+// One descriptor per schema, at the same positions. Compile again when the
+// schemas are changed.
+inline std::vector<ColumnDescriptor> CompileColumnDescriptors(
+    const std::vector<BaseSchemaPtr>& schemas) {
+  std::vector<ColumnDescriptor> columns;
+  columns.reserve(schemas.size());
+  int value_slot = 0;
+  for (const auto& schema : schemas) {
+    if (schema == nullptr) {
+      columns.push_back({nullptr, BaseSchema::kBool, -1, false, false, 0, 0, -1});
+      continue;
+    }
+
+    bool fixed = HasFixedLength(schema.get());
+    ColumnDescriptor column{schema.get(),
+                            schema->GetType(),
+                            schema->GetIndex(),
+                            schema->IsKey(),
+                            schema->AllowNull(),
+                            fixed ? schema->GetLengthForKey() : 0,
+                            fixed ? schema->GetLengthForValue() : 0,
+                            schema->IsKey() ? -1 : value_slot++};
+    columns.push_back(column);
+  }
+  return columns;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
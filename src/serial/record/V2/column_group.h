@@ -0,0 +1,59 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_COLUMN_GROUP_V2_H_
+#define DINGO_SERIAL_COLUMN_GROUP_V2_H_
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Keys of the column groups of a row, see RecordEncoderV2::
+ * EncodeColumnGroups. Group 0 is the row proper and keeps the key of the row,
+ * group g > 0 is stored under that key followed by the byte g, so that the
+ * groups of a row sort right behind it. The decoders are given the key of the
+ * row for every group.
+ */
+constexpr int kMaxColumnGroups = 256;
+
+inline std::string ColumnGroupKey(std::string_view key, int group) {
+  if (group < 0 || group >= kMaxColumnGroups) {
+    throw std::runtime_error("Column group out of range.");
+  }
+  std::string group_key(key);
+  if (group > 0) {
+    group_key.push_back(static_cast<char>(group));
+  }
+  return group_key;
+}
+
+// The key of the row a group key of group belongs to.
+inline std::string_view RowKeyOfColumnGroup(std::string_view key, int group) {
+  if (group > 0) {
+    if (key.empty()) {
+      throw std::runtime_error("Key too short for a column group.");
+    }
+    key.remove_suffix(1);
+  }
+  return key;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
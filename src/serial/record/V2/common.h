@@ -27,6 +27,99 @@ enum offsetUnitFlag { OFFSET_2_BYTE = 0x02, OFFSET_4_BYTE = 0x04 };
 
 enum codecVersion { CODEC_VERSION_V1 = 0x01, CODEC_VERSION_V2 = 0x02 };
 
+// Layout flags of a value, kept in the top byte of its schema version so that
+// decoders not knowing a flag reject the value instead of misreading it. Bit
+// 31 stays clear: a negative version passes the schema_version <= check of
+// older decoders. The other flags take the top bits of the version below the
+// top byte, which older decoders see as a newer schema version and reject as
+// well.
+enum valueFormatFlag {
+  VALUE_FORMAT_COMPACT_ID = 0x01,      // 1 byte ids.
+  VALUE_FORMAT_COMPACT_OFFSET = 0x02,  // 2 bytes offsets, 0xFFFF for null.
+  VALUE_FORMAT_NULL_BITMAP = 0x04,     // nulls in a bitmap, not in the tables.
+  VALUE_FORMAT_VARINT = 0x08,          // some integer columns are varints.
+  VALUE_FORMAT_PACKED_BOOLS = 0x10,    // some bool lists are bit packed.
+  VALUE_FORMAT_QUANTIZED_FLOATS = 0x20,  // some float lists are quantized.
+  VALUE_FORMAT_DICT_STRINGS = 0x40,      // some strings are dictionary codes.
+  VALUE_FORMAT_COMPRESSED = 0x80,        // the rest is compressed, unknown
+                                         // compression types are rejected;
+                                         // at bit 18, not 31.
+  VALUE_FORMAT_STATIC_OFFSETS = 0x100,   // fixed width columns first, at
+                                         // offsets known from the schemas.
+  VALUE_FORMAT_SERIES_LISTS = 0x200,     // some int, long or double lists are
+                                         // delta or xor encoded.
+  VALUE_FORMAT_FIXED_STRINGS = 0x400,    // some strings are fixed length, no
+                                         // length in front of them.
+  VALUE_FORMAT_BOOL_BITS = 0x800,        // bool columns are bits of a section
+                                         // behind the tables, not in them.
+  VALUE_FORMAT_CHECKSUM = 0x1000,        // a CRC-32C of the value behind it.
+};
+
+constexpr int kValueFormatShift = 24;
+// the flags of the top byte, bits 24 to 30.
+constexpr int kValueFormatTopFlags = 0x7F;
+// flags below the top byte, from bit 23 of the schema version down.
+constexpr int kValueFormatExtShift = 15;
+// VALUE_FORMAT_COMPRESSED, at bit 18 below them.
+constexpr int kValueFormatCompressedShift = 11;
+constexpr int kSchemaVersionMask = 0x0003FFFF;
+constexpr int kValueFormatKnownFlags = VALUE_FORMAT_COMPACT_ID |
+                                       VALUE_FORMAT_COMPACT_OFFSET |
+                                       VALUE_FORMAT_NULL_BITMAP |
+                                       VALUE_FORMAT_VARINT |
+                                       VALUE_FORMAT_PACKED_BOOLS |
+                                       VALUE_FORMAT_QUANTIZED_FLOATS |
+                                       VALUE_FORMAT_DICT_STRINGS |
+                                       VALUE_FORMAT_COMPRESSED |
+                                       VALUE_FORMAT_STATIC_OFFSETS |
+                                       VALUE_FORMAT_SERIES_LISTS |
+                                       VALUE_FORMAT_FIXED_STRINGS |
+                                       VALUE_FORMAT_BOOL_BITS |
+                                       VALUE_FORMAT_CHECKSUM;
+
+// flags changing how the data of a column is written, not where.
+constexpr int kValueDataFormatFlags = VALUE_FORMAT_VARINT |
+                                      VALUE_FORMAT_PACKED_BOOLS |
+                                      VALUE_FORMAT_QUANTIZED_FLOATS |
+                                      VALUE_FORMAT_DICT_STRINGS |
+                                      VALUE_FORMAT_SERIES_LISTS |
+                                      VALUE_FORMAT_FIXED_STRINGS;
+
+// schema version | compression type(1 byte) | raw size(4 bytes), in front of
+// the compressed bytes.
+constexpr int kCompressedHeaderSize = 9;
+
+// {crc: 4byte} behind a value flagged VALUE_FORMAT_CHECKSUM, the CRC-32C of
+// all its bytes before, the schema version and flags included.
+constexpr int kValueChecksumSize = 4;
+
+// null offset and the size bound of a value with 2 bytes offsets.
+constexpr int kCompactOffsetNull = 0xFFFF;
+
+inline int GetValueFormat(int32_t schema_version) {
+  uint32_t version = static_cast<uint32_t>(schema_version);
+  return ((version >> kValueFormatShift) & kValueFormatTopFlags) |
+         ((version >> kValueFormatCompressedShift) & 0x80) |
+         ((version >> kValueFormatExtShift) & 0x100) |
+         ((version >> (kValueFormatExtShift - 2)) & 0x200) |
+         ((version >> (kValueFormatExtShift - 4)) & 0x400) |
+         ((version >> (kValueFormatExtShift - 6)) & 0x800) |
+         ((version >> (kValueFormatExtShift - 8)) & 0x1000);
+}
+
+inline int32_t SetValueFormat(int32_t schema_version, int format) {
+  uint32_t flags = static_cast<uint32_t>(format);
+  return (schema_version & kSchemaVersionMask) |
+         static_cast<int32_t>(
+             ((flags & kValueFormatTopFlags) << kValueFormatShift) |
+             ((flags & 0x80) << kValueFormatCompressedShift) |
+             ((flags & 0x100) << kValueFormatExtShift) |
+             ((flags & 0x200) << (kValueFormatExtShift - 2)) |
+             ((flags & 0x400) << (kValueFormatExtShift - 4)) |
+             ((flags & 0x800) << (kValueFormatExtShift - 6)) |
+             ((flags & 0x1000) << (kValueFormatExtShift - 8)));
+}
+
 inline int CalcIdUnit(int not_null_id_cnt, int null_id_cnt) {
   return (not_null_id_cnt + null_id_cnt) < 255 ? ID_1_BYTE : ID_2_BYTE;
 }
@@ -0,0 +1,184 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "decode_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "serial/utils/V2/hash.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+DecodeCache::DecodeCache(RecordDecoderPtr decoder, size_t capacity,
+                         size_t shard_count)
+    : decoder_(std::move(decoder)), capacity_(capacity) {
+  shard_count = std::max<size_t>(shard_count, 1);
+  shard_capacity_ = capacity_ / shard_count;
+  for (size_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+DecodeCache::DecodeCache(
+    RecordDecoderPtr decoder,
+    const std::unordered_map<int, int>& column_indexes_serial, size_t capacity,
+    size_t shard_count)
+    : DecodeCache(std::move(decoder), capacity, shard_count) {
+  projected_ = true;
+  plan_ = decoder_->NewDecodePlan(column_indexes_serial);
+}
+
+DecodeCache::Shard& DecodeCache::ShardOf(std::string_view key) {
+  return *shards_[Hash64(key.data(), key.size()) % shards_.size()];
+}
+
+DecodeCache::RecordPtr DecodeCache::Decode(std::string_view key,
+                                           std::string_view value) {
+  Shard& shard = ShardOf(key);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end() && it->second->value == value) {
+      shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return it->second->record;
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+
+  // decoded outside the lock, a row decoded by two threads at once is
+  // cached by the later.
+  auto record = std::make_shared<std::vector<std::any>>();
+  int ret = projected_ ? decoder_->Decode(key, value, plan_, *record)
+                       : decoder_->Decode(key, value, *record);
+  if (ret != 0) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  Insert(shard, key, value, record);
+  return record;
+}
+
+int DecodeCache::Decode(std::string_view key, std::string_view value,
+                        std::vector<std::any>& record) {
+  RecordPtr cached = Decode(key, value);
+  if (cached == nullptr) {
+    return -1;
+  }
+  record = *cached;
+  return 0;
+}
+
+void DecodeCache::Insert(Shard& shard, std::string_view key,
+                         std::string_view value, RecordPtr record) {
+  auto it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    shard.charge -= it->second->charge;
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+  }
+
+  size_t charge = sizeof(Entry) + key.size() + value.size() +
+                  RecordCharge(*record);
+  if (charge > shard_capacity_) {
+    return;
+  }
+  while (shard.charge + charge > shard_capacity_) {
+    const Entry& last = shard.lru.back();
+    shard.charge -= last.charge;
+    shard.index.erase(last.key);
+    shard.lru.pop_back();
+  }
+
+  shard.lru.push_front(
+      Entry{std::string(key), std::string(value), std::move(record), charge});
+  shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+  shard.charge += charge;
+}
+
+void DecodeCache::Erase(std::string_view key) {
+  Shard& shard = ShardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    shard.charge -= it->second->charge;
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+  }
+}
+
+void DecodeCache::Clear() {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->index.clear();
+    shard->lru.clear();
+    shard->charge = 0;
+  }
+}
+
+size_t DecodeCache::Size() const {
+  size_t size = 0;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    size += shard->lru.size();
+  }
+  return size;
+}
+
+size_t DecodeCache::Charge() const {
+  size_t charge = 0;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    charge += shard->charge;
+  }
+  return charge;
+}
+
+template <typename T>
+static size_t ListCharge(const std::any& value) {
+  const auto* list = std::any_cast<std::vector<T>>(&value);
+  return list == nullptr ? 0 : list->size() * sizeof(T);
+}
+
+// The heap held by a decoded record, roughly: the bytes of its strings and
+// lists over the anys. Bool lists are counted as a byte per element.
+size_t DecodeCache::RecordCharge(const std::vector<std::any>& record) {
+  size_t charge = record.size() * sizeof(std::any);
+  for (const auto& value : record) {
+    if (!value.has_value()) {
+      continue;
+    }
+    if (const auto* str = std::any_cast<std::string>(&value)) {
+      charge += str->size();
+    } else if (const auto* strs =
+                   std::any_cast<std::vector<std::string>>(&value)) {
+      for (const auto& s : *strs) {
+        charge += sizeof(std::string) + s.size();
+      }
+    } else {
+      charge += ListCharge<bool>(value) + ListCharge<int32_t>(value) +
+                ListCharge<int64_t>(value) + ListCharge<float>(value) +
+                ListCharge<double>(value);
+    }
+  }
+  return charge;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
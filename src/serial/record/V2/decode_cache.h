@@ -0,0 +1,125 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_DECODE_CACHE_V2_H_
+#define DINGO_SERIAL_DECODE_CACHE_V2_H_
+
+#include <any>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "serial/record/V2/decode_plan.h"
+#include "serial/record/V2/record_decoder.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Decoded rows of a RecordDecoderV2 kept for tables read over and over with
+ * the same keys, so that a hot row is decoded once.
+ *
+ * Rows are looked up by their key bytes, a hit also needs the value to be
+ * the bytes the row was decoded from: a row written again under its key
+ * misses and its new record replaces the cached one, so nothing is to be
+ * invalidated on writes. Rows are decoded in full, or by the projection given
+ * at construction.
+ *
+ * The cache is split into shards by a hash of the key, each an LRU list under
+ * its own mutex holding an equal part of capacity. An entry is charged its key
+ * and value bytes plus an estimate of its record, rows above a shard's part
+ * are decoded but not kept. Safe to share between threads, the decoder must
+ * outlive the cache.
+ */
+class DecodeCache {
+ public:
+  using RecordPtr = std::shared_ptr<const std::vector<std::any>>;
+
+  // capacity in bytes, over shard_count shards (at least 1).
+  DecodeCache(RecordDecoderPtr decoder, size_t capacity,
+              size_t shard_count = kDefaultShardCount);
+  DecodeCache(RecordDecoderPtr decoder,
+              const std::unordered_map<int, int>& column_indexes_serial,
+              size_t capacity, size_t shard_count = kDefaultShardCount);
+
+  DecodeCache(const DecodeCache&) = delete;
+  DecodeCache& operator=(const DecodeCache&) = delete;
+
+  static constexpr size_t kDefaultShardCount = 16;
+
+  // The record of the row, cached or decoded and cached. nullptr when the row
+  // fails the checks. The record is shared with the cache and outlives its
+  // eviction.
+  RecordPtr Decode(std::string_view key, std::string_view value);
+  // A copy of it in record, -1 when the row fails the checks.
+  int Decode(std::string_view key, std::string_view value,
+             std::vector<std::any>& record /*output*/);
+
+  // Drop the row of key, as when it is deleted.
+  void Erase(std::string_view key);
+  void Clear();
+
+  size_t Capacity() const { return capacity_; }
+  // entries and bytes charged over all shards.
+  size_t Size() const;
+  size_t Charge() const;
+
+  uint64_t Hits() const { return hits_.load(std::memory_order_relaxed); }
+  uint64_t Misses() const { return misses_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    RecordPtr record;
+    size_t charge;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    // most recently used first.
+    std::list<Entry> lru;
+    // by the key of the entry, which the list keeps in place.
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    size_t charge{0};
+  };
+
+  Shard& ShardOf(std::string_view key);
+  void Insert(Shard& shard, std::string_view key, std::string_view value,
+              RecordPtr record);
+  static size_t RecordCharge(const std::vector<std::any>& record);
+
+  RecordDecoderPtr decoder_;
+  bool projected_{false};
+  DecodePlan plan_;
+
+  size_t capacity_;
+  size_t shard_capacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_DECODE_PLAN_H_
+#define DINGO_SERIAL_DECODE_PLAN_H_
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * A projection resolved against a schema list, build it once per query and
+ * reuse it for every row.
+ *
+ * column_indexes_serial has the same meaning as in the projected
+ * RecordDecoderV2::Decode: it maps the position of a column among the non null
+ * schemas to its slot in the output record.
+ */
+class DecodePlan {
+ public:
+  static constexpr int kSkip = -1;
+
+  DecodePlan() = default;
+
+  DecodePlan(const std::vector<BaseSchemaPtr>& schemas,
+             const std::unordered_map<int, int>& column_indexes_serial)
+      : slots_(schemas.size(), kSkip),
+        output_size_(column_indexes_serial.size()) {
+    int decode_col_count = 0;
+    for (size_t i = 0; i < schemas.size(); ++i) {
+      if (schemas[i] == nullptr) {
+        continue;
+      }
+
+      auto it = column_indexes_serial.find(decode_col_count++);
+      if (it != column_indexes_serial.end()) {
+        slots_[i] = it->second;
+        end_ = i + 1;
+        if (schemas[i]->IsKey()) {
+          key_end_ = i + 1;
+        } else {
+          value_columns_.push_back(i);
+        }
+      }
+    }
+  }
+
+  // Output slot of the schema at position i, or kSkip.
+  int Slot(size_t i) const { return slots_[i]; }
+
+  // Number of schemas the plan was built for.
+  size_t SchemaCount() const { return slots_.size(); }
+
+  size_t OutputSize() const { return output_size_; }
+
+  // Schemas at or after End() are not projected, decoding stops there.
+  size_t End() const { return end_; }
+
+  // The key is parsed up to KeyEnd(), past the last projected key column, a
+  // value column is found by its offset so only the projected ones are
+  // visited, positions in schema order.
+  size_t KeyEnd() const { return key_end_; }
+  const std::vector<size_t>& ValueColumns() const { return value_columns_; }
+
+ private:
+  std::vector<int> slots_;
+  size_t output_size_{0};
+  size_t end_{0};
+  size_t key_end_{0};
+  std::vector<size_t> value_columns_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
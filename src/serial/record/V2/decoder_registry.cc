@@ -0,0 +1,147 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "decoder_registry.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include "serial/record/V2/common.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+DecoderRegistry::DecoderRegistry() : DecoderRegistry(IsLE()) {}
+
+DecoderRegistry::DecoderRegistry(bool le) : le_(le) {}
+
+int DecoderRegistry::Register(long common_id, int schema_version,
+                              const std::vector<BaseSchemaPtr>& schemas,
+                              std::vector<std::any> defaults) {
+  Entry entry;
+  for (const auto& schema : schemas) {
+    if (schema != nullptr) {
+      entry.indexes.push_back(schema->GetIndex());
+    }
+  }
+  std::sort(entry.indexes.begin(), entry.indexes.end());
+  entry.defaults = std::move(defaults);
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto key = std::make_pair(common_id, schema_version & kSchemaVersionMask);
+  if (entries_.count(key) > 0) {
+    return -1;
+  }
+  // built under the lock, FormatSchema writes to schemas another version may
+  // share.
+  entry.decoder = std::make_shared<RecordDecoderV2>(key.second, schemas,
+                                                    common_id, le_);
+  entries_.emplace(key, std::move(entry));
+  return 0;
+}
+
+void DecoderRegistry::Remove(long common_id) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  entries_.erase(entries_.lower_bound({common_id, 0}),
+                 entries_.upper_bound({common_id, kSchemaVersionMask}));
+}
+
+size_t DecoderRegistry::Size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return entries_.size();
+}
+
+int DecoderRegistry::ValueSchemaVersion(std::string_view value) const {
+  if (value.size() < 4) {
+    return -1;
+  }
+  // a compressed value keeps its schema version in front too.
+  return BufView(value, le_).ReadInt(0) & kSchemaVersionMask;
+}
+
+DecoderRegistry::EntryMap::const_iterator DecoderRegistry::Newest(
+    long common_id) const {
+  auto it = entries_.upper_bound({common_id, kSchemaVersionMask});
+  if (it == entries_.begin() || (--it)->first.first != common_id) {
+    return entries_.end();
+  }
+  return it;
+}
+
+RecordDecoderPtr DecoderRegistry::Get(long common_id) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = Newest(common_id);
+  return it == entries_.end() ? nullptr : it->second.decoder;
+}
+
+RecordDecoderPtr DecoderRegistry::Get(long common_id,
+                                      int schema_version) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = entries_.find({common_id, schema_version & kSchemaVersionMask});
+  return it == entries_.end() ? nullptr : it->second.decoder;
+}
+
+RecordDecoderPtr DecoderRegistry::Get(long common_id,
+                                      std::string_view value) const {
+  int schema_version = ValueSchemaVersion(value);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = Newest(common_id);
+  if (schema_version < 0 || it == entries_.end() ||
+      it->first.second < schema_version) {
+    return nullptr;
+  }
+  return it->second.decoder;
+}
+
+int DecoderRegistry::Decode(long common_id, std::string_view key,
+                            std::string_view value,
+                            std::vector<std::any>& record) const {
+  int schema_version = ValueSchemaVersion(value);
+  if (schema_version < 0) {
+    return -1;
+  }
+
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = Newest(common_id);
+  if (it == entries_.end()) {
+    return -1;
+  }
+  const Entry& entry = it->second;
+  int ret = entry.decoder->Decode(key, value, record);
+  if (ret != 0 || entry.defaults.empty() ||
+      it->first.second == schema_version) {
+    return ret;
+  }
+
+  // the newest version not above the row's.
+  auto row = entries_.upper_bound({common_id, schema_version});
+  if (row == entries_.begin() || (--row)->first.first != common_id) {
+    return 0;
+  }
+  const auto& row_indexes = row->second.indexes;
+  for (size_t i = 0; i < record.size() && i < entry.defaults.size(); ++i) {
+    if (!record[i].has_value() && entry.defaults[i].has_value() &&
+        !std::binary_search(row_indexes.begin(), row_indexes.end(),
+                            static_cast<int>(i))) {
+      record[i] = entry.defaults[i];
+    }
+  }
+  return 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,91 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_DECODER_REGISTRY_V2_H_
+#define DINGO_SERIAL_DECODER_REGISTRY_V2_H_
+
+#include <any>
+#include <map>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "serial/record/V2/record_decoder.h"
+#include "serial/schema/V2/base_schema.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * The decoders of every registered (common_id, schema_version), built once at
+ * Register and shared by all callers, lookups only take a shared lock.
+ *
+ * Rows are read with the newest registered version of their table, it reads
+ * rows of any version not above it. Columns the row's version did not have
+ * decode as null, or as the default given for them at Register. Which columns
+ * a row's version had is taken from the newest registered version not above
+ * it.
+ */
+class DecoderRegistry {
+ public:
+  DecoderRegistry();
+  explicit DecoderRegistry(bool le);
+
+  DecoderRegistry(const DecoderRegistry&) = delete;
+  DecoderRegistry& operator=(const DecoderRegistry&) = delete;
+
+  // defaults is by record index, an empty std::any or a shorter vector leaves
+  // the column null. Returns -1 when the version is already registered.
+  int Register(long common_id, int schema_version,
+               const std::vector<BaseSchemaPtr>& schemas,
+               std::vector<std::any> defaults = {});
+  void Remove(long common_id);
+  size_t Size() const;
+
+  // Decoder of the newest version, nullptr for an unknown table.
+  RecordDecoderPtr Get(long common_id) const;
+  // Decoder of exactly schema_version, nullptr when it is not registered.
+  RecordDecoderPtr Get(long common_id, int schema_version) const;
+  // Decoder of the newest version when it can read value, by the schema
+  // version in its header.
+  RecordDecoderPtr Get(long common_id, std::string_view value) const;
+
+  // Decode with the decoder for value and fill in the defaults, returns -1
+  // when there is none or the row fails its checks.
+  int Decode(long common_id, std::string_view key, std::string_view value,
+             std::vector<std::any>& record /*output*/) const;
+
+ private:
+  struct Entry {
+    RecordDecoderPtr decoder;
+    // schema indexes of the version, sorted.
+    std::vector<int> indexes;
+    std::vector<std::any> defaults;
+  };
+  using EntryMap = std::map<std::pair<long, int>, Entry>;
+
+  int ValueSchemaVersion(std::string_view value) const;
+  // Newest entry of the table, end() for an unknown table.
+  EntryMap::const_iterator Newest(long common_id) const;
+
+  bool le_;
+  mutable std::shared_mutex mutex_;
+  EntryMap entries_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,473 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/delta_record.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "serial/record/V2/common.h"
+#include "serial/record/V2/value_header.h"
+#include "serial/schema/V2/boolean_list_schema.h"
+#include "serial/schema/V2/double_list_schema.h"
+#include "serial/schema/V2/float_list_schema.h"
+#include "serial/schema/V2/integer_list_schema.h"
+#include "serial/schema/V2/integer_schema.h"
+#include "serial/schema/V2/long_list_schema.h"
+#include "serial/schema/V2/long_schema.h"
+#include "serial/schema/V2/string_schema.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// schema_version(4 bytes) + op count (2 bytes).
+constexpr size_t kDeltaHeaderSize = 6;
+// column id (2 bytes) + kind (1 byte).
+constexpr size_t kDeltaOpHeaderSize = 3;
+
+bool IsIntType(BaseSchema::Type type) {
+  return type == BaseSchema::kInteger || type == BaseSchema::kLong;
+}
+
+bool IsRealType(BaseSchema::Type type) {
+  return type == BaseSchema::kFloat || type == BaseSchema::kDouble;
+}
+
+// The data format flags a value column written by its schema calls for, as
+// RecordEncoderV2 flags them.
+int ColumnDataFormat(BaseSchema* schema) {
+  switch (schema->GetType()) {
+    case BaseSchema::kInteger:
+      return static_cast<DingoSchema<int32_t>*>(schema)->IsVarint()
+                 ? VALUE_FORMAT_VARINT
+                 : 0;
+    case BaseSchema::kLong:
+      return static_cast<DingoSchema<int64_t>*>(schema)->IsVarint()
+                 ? VALUE_FORMAT_VARINT
+                 : 0;
+    case BaseSchema::kString: {
+      auto* string_schema = static_cast<DingoSchema<std::string>*>(schema);
+      if (string_schema->GetFixedLength() > 0) {
+        return VALUE_FORMAT_FIXED_STRINGS;
+      }
+      return string_schema->GetDictionary() != nullptr
+                 ? VALUE_FORMAT_DICT_STRINGS
+                 : 0;
+    }
+    case BaseSchema::kBoolList:
+      return static_cast<DingoSchema<std::vector<bool>>*>(schema)->IsPacked()
+                 ? VALUE_FORMAT_PACKED_BOOLS
+                 : 0;
+    case BaseSchema::kFloatList:
+      return static_cast<DingoSchema<std::vector<float>>*>(schema)
+                         ->GetQuantization() != FloatQuantization::kNone
+                 ? VALUE_FORMAT_QUANTIZED_FLOATS
+                 : 0;
+    case BaseSchema::kIntegerList:
+      return static_cast<DingoSchema<std::vector<int32_t>>*>(schema)
+                     ->IsDeltaEncoded()
+                 ? VALUE_FORMAT_SERIES_LISTS
+                 : 0;
+    case BaseSchema::kLongList:
+      return static_cast<DingoSchema<std::vector<int64_t>>*>(schema)
+                     ->IsDeltaEncoded()
+                 ? VALUE_FORMAT_SERIES_LISTS
+                 : 0;
+    case BaseSchema::kDoubleList:
+      return static_cast<DingoSchema<std::vector<double>>*>(schema)
+                     ->IsXorEncoded()
+                 ? VALUE_FORMAT_SERIES_LISTS
+                 : 0;
+    default:
+      return 0;
+  }
+}
+
+int64_t DoubleBits(double value) {
+  int64_t bits;
+  memcpy(&bits, &value, 8);
+  return bits;
+}
+
+double BitsDouble(int64_t bits) {
+  double value;
+  memcpy(&value, &bits, 8);
+  return value;
+}
+
+// A column an op touches: the bytes its value is in, or the number the adds
+// so far came to.
+struct Update {
+  int id;
+  BaseSchema* schema;
+  bool is_null;
+  std::string_view bytes;
+  bool has_number;
+  int64_t integer;
+  double real;
+  // where the number is encoded in the scratch of the merge.
+  size_t number_pos;
+  size_t number_size;
+};
+
+// Start the adds of update from the value it holds, zero for a null.
+void LoadNumber(Update& update, bool le) {
+  if (update.has_number) {
+    return;
+  }
+  update.has_number = true;
+  update.integer = 0;
+  update.real = 0;
+  if (update.is_null) {
+    update.is_null = false;
+    return;
+  }
+  BufView view(update.bytes, le);
+  std::any data = update.schema->DecodeValue(view, 0);
+  switch (update.schema->GetType()) {
+    case BaseSchema::kInteger:
+      update.integer = std::any_cast<int32_t>(data);
+      break;
+    case BaseSchema::kLong:
+      update.integer = std::any_cast<int64_t>(data);
+      break;
+    case BaseSchema::kFloat:
+      update.real = std::any_cast<float>(data);
+      break;
+    default:
+      update.real = std::any_cast<double>(data);
+      break;
+  }
+}
+
+std::any NumberOf(const Update& update) {
+  switch (update.schema->GetType()) {
+    case BaseSchema::kInteger:
+      return std::any(static_cast<int32_t>(update.integer));
+    case BaseSchema::kLong:
+      return std::any(update.integer);
+    case BaseSchema::kFloat:
+      return std::any(static_cast<float>(update.real));
+    default:
+      return std::any(update.real);
+  }
+}
+
+}  // namespace
+
+DeltaRecordEncoder::DeltaRecordEncoder(
+    int schema_version, const std::vector<BaseSchemaPtr>& schemas)
+    : DeltaRecordEncoder(schema_version, schemas, IsLE()) {}
+
+DeltaRecordEncoder::DeltaRecordEncoder(
+    int schema_version, const std::vector<BaseSchemaPtr>& schemas, bool le)
+    : schema_version_(schema_version),
+      le_(le),
+      schemas_(schemas),
+      ops_(64, le) {
+  FormatSchema(schemas_, le);
+}
+
+BaseSchema* DeltaRecordEncoder::ValueColumn(int column) const {
+  if (column < 0 || column >= static_cast<int>(schemas_.size()) ||
+      schemas_[column] == nullptr || schemas_[column]->IsKey()) {
+    throw std::runtime_error("Not a value column.");
+  }
+  return schemas_[column].get();
+}
+
+void DeltaRecordEncoder::WriteOp(int column, DeltaOp op) {
+  ops_.WriteShort(column);
+  ops_.Write(static_cast<uint8_t>(op));
+  ++op_count_;
+}
+
+void DeltaRecordEncoder::AddInt(int column, int64_t delta) {
+  if (!IsIntType(ValueColumn(column)->GetType())) {
+    throw std::runtime_error("Not an integer column.");
+  }
+  WriteOp(column, DeltaOp::kAddInt);
+  ops_.WriteLong(delta);
+}
+
+void DeltaRecordEncoder::AddReal(int column, double delta) {
+  if (!IsRealType(ValueColumn(column)->GetType())) {
+    throw std::runtime_error("Not a float or double column.");
+  }
+  WriteOp(column, DeltaOp::kAddReal);
+  ops_.WriteLong(DoubleBits(delta));
+}
+
+void DeltaRecordEncoder::Set(int column, const std::any& data) {
+  BaseSchema* schema = ValueColumn(column);
+  if (!data.has_value()) {
+    if (!schema->AllowNull()) {
+      throw std::runtime_error("Not allow null, but data not has value.");
+    }
+    WriteOp(column, DeltaOp::kSetNull);
+    return;
+  }
+  WriteOp(column, DeltaOp::kSet);
+  size_t length_pos = ops_.Size();
+  ops_.WriteInt(0);
+  int length = schema->EncodeValue(data, ops_);
+  ops_.WriteInt(length_pos, length);
+}
+
+void DeltaRecordEncoder::SetBytes(int column, std::string_view bytes) {
+  ValueColumn(column);
+  WriteOp(column, DeltaOp::kSet);
+  ops_.WriteInt(bytes.size());
+  size_t pos = ops_.Size();
+  ops_.Enlarge(bytes.size());
+  memcpy(ops_.Data() + pos, bytes.data(), bytes.size());
+}
+
+void DeltaRecordEncoder::Clear() {
+  ops_.Clear();
+  op_count_ = 0;
+}
+
+int DeltaRecordEncoder::Encode(std::string& output) const {
+  if (op_count_ > 0xFFFF) {
+    throw std::runtime_error("Too many delta ops.");
+  }
+  Buf buf(std::move(output), le_);
+  buf.Clear();
+  buf.Reserve(kDeltaHeaderSize + ops_.Size());
+  buf.WriteInt(schema_version_ & kSchemaVersionMask);
+  buf.WriteShort(op_count_);
+  buf.Enlarge(ops_.Size());
+  memcpy(buf.Data() + kDeltaHeaderSize, ops_.Data(), ops_.Size());
+  buf.GetString(output);
+  return output.size();
+}
+
+DeltaMerger::DeltaMerger(int schema_version,
+                         const std::vector<BaseSchemaPtr>& schemas)
+    : DeltaMerger(schema_version, schemas, IsLE()) {}
+
+DeltaMerger::DeltaMerger(int schema_version,
+                         const std::vector<BaseSchemaPtr>& schemas, bool le)
+    : schema_version_(schema_version & kSchemaVersionMask),
+      le_(le),
+      schemas_(schemas) {
+  FormatSchema(schemas_, le);
+  for (const auto& schema : schemas_) {
+    column_formats_.push_back(schema != nullptr && !schema->IsKey()
+                                  ? ColumnDataFormat(schema.get())
+                                  : -1);
+  }
+}
+
+int DeltaMerger::Merge(std::string_view base, const std::string_view* deltas,
+                       size_t count, std::string& output) const {
+  thread_local std::vector<ValueSpan> spans;
+  thread_local std::vector<Update> updates;
+  int format = 0;
+  spans.clear();
+  updates.clear();
+  if (!base.empty()) {
+    thread_local std::string inflated;
+    int32_t version;
+    if (HasValueChecksum(base, le_) || !InflateValue(base, inflated, le_) ||
+        ReadValueSpans(base, le_, version, spans) < 0 ||
+        (version & kSchemaVersionMask) > schema_version_) {
+      return -1;
+    }
+    format = GetValueFormat(version) & kValueDataFormatFlags;
+  }
+
+  for (size_t d = 0; d < count; ++d) {
+    std::string_view delta = deltas[d];
+    if (delta.size() < kDeltaHeaderSize) {
+      return -1;
+    }
+    BufView view(delta, le_);
+    if ((view.ReadInt(0) & kSchemaVersionMask) > schema_version_) {
+      return -1;
+    }
+    int ops = static_cast<uint16_t>(view.ReadShort(4));
+    size_t pos = kDeltaHeaderSize;
+    for (int i = 0; i < ops; ++i) {
+      if (delta.size() - pos < kDeltaOpHeaderSize) {
+        return -1;
+      }
+      int id = static_cast<uint16_t>(view.ReadShort(pos));
+      auto op = static_cast<DeltaOp>(view.Read(pos + 2));
+      pos += kDeltaOpHeaderSize;
+      if (id >= static_cast<int>(schemas_.size()) || column_formats_[id] < 0) {
+        return -1;
+      }
+      BaseSchema* schema = schemas_[id].get();
+
+      auto it = std::find_if(updates.begin(), updates.end(),
+                             [id](const Update& update) {
+                               return update.id == id;
+                             });
+      if (it == updates.end()) {
+        // the column as base holds it, absent for null.
+        Update update{id, schema, true, {}, false, 0, 0, 0, 0};
+        for (const auto& span : spans) {
+          if (span.id == id) {
+            update.is_null = false;
+            update.bytes = base.substr(span.offset, span.end - span.offset);
+            break;
+          }
+        }
+        updates.push_back(update);
+        it = updates.end() - 1;
+      }
+      Update& update = *it;
+
+      switch (op) {
+        case DeltaOp::kAddInt:
+        case DeltaOp::kAddReal: {
+          bool int_op = op == DeltaOp::kAddInt;
+          if ((int_op ? !IsIntType(schema->GetType())
+                      : !IsRealType(schema->GetType())) ||
+              delta.size() - pos < 8) {
+            return -1;
+          }
+          int64_t word = view.ReadLong(pos);
+          pos += 8;
+          LoadNumber(update, le_);
+          if (schema->GetType() == BaseSchema::kInteger) {
+            update.integer = static_cast<int32_t>(
+                static_cast<uint32_t>(update.integer) +
+                static_cast<uint32_t>(word));
+          } else if (int_op) {
+            update.integer = static_cast<int64_t>(
+                static_cast<uint64_t>(update.integer) +
+                static_cast<uint64_t>(word));
+          } else if (schema->GetType() == BaseSchema::kFloat) {
+            update.real = static_cast<float>(update.real + BitsDouble(word));
+          } else {
+            update.real += BitsDouble(word);
+          }
+          break;
+        }
+        case DeltaOp::kSet: {
+          if (delta.size() - pos < 4) {
+            return -1;
+          }
+          size_t length = static_cast<uint32_t>(view.ReadInt(pos));
+          pos += 4;
+          if (delta.size() - pos < length) {
+            return -1;
+          }
+          update.is_null = false;
+          update.has_number = false;
+          update.bytes = delta.substr(pos, length);
+          pos += length;
+          break;
+        }
+        case DeltaOp::kSetNull:
+          if (!schema->AllowNull()) {
+            return -1;
+          }
+          update.is_null = true;
+          update.has_number = false;
+          break;
+        default:
+          return -1;
+      }
+    }
+    if (pos != delta.size()) {
+      return -1;
+    }
+  }
+
+  // the numbers are encoded first, the bytes of every column then stay put.
+  thread_local std::string numbers;
+  Buf number_buf(std::move(numbers), le_);
+  number_buf.Clear();
+  for (auto& update : updates) {
+    if (update.has_number) {
+      update.number_pos = number_buf.Size();
+      update.schema->EncodeValue(NumberOf(update), number_buf);
+      update.number_size = number_buf.Size() - update.number_pos;
+    }
+  }
+  number_buf.GetString(numbers);
+  for (auto& update : updates) {
+    if (update.has_number) {
+      update.bytes = std::string_view(numbers).substr(update.number_pos,
+                                                      update.number_size);
+    }
+  }
+
+  // the untouched columns of base by their old offset, the touched ones
+  // after them; a span of a touched column points into its update.
+  thread_local std::vector<std::string_view> sources;
+  sources.clear();
+  size_t kept = 0;
+  for (const auto& span : spans) {
+    if (std::none_of(updates.begin(), updates.end(),
+                     [&span](const Update& update) {
+                       return update.id == span.id;
+                     })) {
+      spans[kept++] = span;
+      sources.push_back(base.substr(span.offset, span.end - span.offset));
+    }
+  }
+  spans.resize(kept);
+  for (const auto& update : updates) {
+    if (!update.is_null) {
+      spans.push_back({update.id, 0, 0, 0});
+      sources.push_back(update.bytes);
+      format |= column_formats_[update.id];
+    }
+  }
+
+  size_t data_size = 0;
+  bool compact_ids = true;
+  for (size_t i = 0; i < spans.size(); ++i) {
+    data_size += sources[i].size();
+    compact_ids = compact_ids && spans[i].id < 255;
+  }
+  PlainValueTables tables =
+      PlanPlainValueTables(spans.size(), compact_ids, data_size);
+
+  Buf buf(std::move(output), le_);
+  buf.Clear();
+  buf.Reserve(tables.data_pos + data_size);
+  buf.WriteInt(SetValueFormat(schema_version_, format | tables.format));
+  buf.WriteShort(spans.size());
+  buf.WriteShort(0);
+  buf.Enlarge(tables.data_pos - 8 + data_size);
+  int offset = tables.data_pos;
+  for (size_t i = 0; i < spans.size(); ++i) {
+    memcpy(buf.Data() + offset, sources[i].data(), sources[i].size());
+    spans[i].new_offset = offset;
+    offset += sources[i].size();
+  }
+  std::sort(spans.begin(), spans.end(),
+            [](const ValueSpan& lhs, const ValueSpan& rhs) {
+              return lhs.id < rhs.id;
+            });
+  WritePlainValueTables(buf, tables, spans);
+
+  buf.GetString(output);
+  return output.size();
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,132 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_DELTA_RECORD_V2_H_
+#define DINGO_SERIAL_DELTA_RECORD_V2_H_
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/buf.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Delta records, the merge operands of counter style updates: a few value
+ * columns of a row added to or overwritten, folded into its value by a
+ * DeltaMerger from a merge operator instead of a read, decode, encode and
+ * write of the row.
+ *
+ *   {schema_version: 4byte} | {op count: 2byte} | {op}*
+ *   op: {column id: 2byte} | {kind: 1byte} | {payload}
+ *
+ *   kAddInt:  {delta: 8byte}, to an int or long column.
+ *   kAddReal: {delta: 8byte double}, to a float or double column.
+ *   kSet:     {length: 4byte} | {the column value as a value encodes it}
+ *   kSetNull: nothing.
+ *
+ * The ops of a record apply in order. Only value columns take ops, the adds
+ * only the number ones; a key column is written with its row.
+ */
+enum class DeltaOp : uint8_t {
+  kAddInt = 1,
+  kAddReal = 2,
+  kSet = 3,
+  kSetNull = 4,
+};
+
+// Builds delta records of the value columns of schemas, columns are their
+// positions in schemas as in a record. Not thread safe.
+class DeltaRecordEncoder {
+ public:
+  DeltaRecordEncoder(int schema_version,
+                     const std::vector<BaseSchemaPtr>& schemas);
+  DeltaRecordEncoder(int schema_version,
+                     const std::vector<BaseSchemaPtr>& schemas, bool le);
+
+  // Throw runtime_error for a column that is not a value column of the
+  // type, int or long for AddInt, float or double for AddReal. Integer sums
+  // wrap in the width of the column.
+  void AddInt(int column, int64_t delta);
+  void AddReal(int column, double delta);
+  // An empty data sets the column null, throws runtime_error then when it
+  // does not allow null, or for a column that is not a value column.
+  void Set(int column, const std::any& data);
+  // Set the column to bytes in the form a value holds it, as taken from the
+  // data of another value of the schemas. Throws as Set.
+  void SetBytes(int column, std::string_view bytes);
+
+  size_t OpCount() const { return op_count_; }
+  void Clear();
+
+  // Write the record of the ops so far to output, returns its size.
+  int Encode(std::string& output /*output*/) const;
+
+ private:
+  BaseSchema* ValueColumn(int column) const;
+  void WriteOp(int column, DeltaOp op);
+
+  int schema_version_;
+  bool le_;
+  std::vector<BaseSchemaPtr> schemas_;
+  size_t op_count_{0};
+  Buf ops_;
+};
+
+/*
+ * Folds delta records into a value of RecordEncoderV2 at the byte level.
+ *
+ * The columns no op touches are copied as their bytes, only the touched ones
+ * are decoded, a number an op adds to, and encoded again. A null or missing
+ * column adds from zero. The merged value takes the plain layout with the
+ * null columns left out of its tables, as ValueRewriter writes, and the
+ * schema version of the merger; the key is not touched.
+ *
+ * A merger is immutable once built and may be shared by threads.
+ */
+class DeltaMerger {
+ public:
+  DeltaMerger(int schema_version, const std::vector<BaseSchemaPtr>& schemas);
+  DeltaMerger(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+              bool le);
+
+  // Write base with deltas[0, count) applied in order to output, which must
+  // not hold the bytes of any input. An empty base is a row with no value
+  // yet, all its columns null, a compressed base is inflated first. Returns
+  // the bytes written, or -1 when base or a delta has a newer schema version
+  // than the merger, base has static offsets, bool bits, a checksum or a
+  // layout or compression type unknown to this build, or a delta is
+  // truncated or holds an op its column does not take.
+  int Merge(std::string_view base, const std::string_view* deltas,
+            size_t count, std::string& output /*output*/) const;
+
+ private:
+  int schema_version_;
+  bool le_;
+  std::vector<BaseSchemaPtr> schemas_;
+  // per schema the data format flags its values call for, -1 for the key
+  // columns.
+  std::vector<int> column_formats_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
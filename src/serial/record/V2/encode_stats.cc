@@ -0,0 +1,220 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "encode_stats.h"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "serial/utils/V2/hash.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+template <typename T>
+static uint64_t HashValue(const T& value) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    return Hash64(value.data(), value.size());
+  } else if constexpr (std::is_same_v<T, std::vector<bool>>) {
+    // 64 elements a word.
+    uint64_t hash = value.size();
+    uint64_t word = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+      word |= static_cast<uint64_t>(value[i]) << (i % 64);
+      if (i % 64 == 63 || i == value.size() - 1) {
+        hash = Hash64(reinterpret_cast<const char*>(&word), 8, hash);
+        word = 0;
+      }
+    }
+    return hash;
+  } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+    uint64_t hash = value.size();
+    for (const auto& str : value) {
+      hash = Hash64(str.data(), str.size(), hash);
+    }
+    return hash;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    // 0.0 and -0.0 are the same value.
+    T normalized = value == 0 ? 0 : value;
+    return Hash64(reinterpret_cast<const char*>(&normalized), sizeof(T));
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    return Hash64(reinterpret_cast<const char*>(&value), sizeof(T));
+  } else {
+    return Hash64(reinterpret_cast<const char*>(value.data()),
+                  value.size() * sizeof(typename T::value_type));
+  }
+}
+
+template <typename T>
+static void AddRange(ColumnStats& stats, const T& value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(value)) {
+      return;
+    }
+  }
+  if (!stats.min.has_value()) {
+    stats.min = value;
+    stats.max = value;
+  } else if (value < std::any_cast<const T&>(stats.min)) {
+    stats.min = value;
+  } else if (std::any_cast<const T&>(stats.max) < value) {
+    stats.max = value;
+  }
+}
+
+template <typename T>
+static void AddValue(ColumnStats& stats, const std::any& data) {
+  const auto& value = std::any_cast<const T&>(data);
+  stats.distinct.Add(HashValue(value));
+  if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, std::string>) {
+    AddRange(stats, value);
+  }
+}
+
+template <typename T>
+static void MergeRange(ColumnStats& stats, const ColumnStats& other) {
+  if (other.min.has_value()) {
+    AddRange(stats, std::any_cast<const T&>(other.min));
+    AddRange(stats, std::any_cast<const T&>(other.max));
+  }
+}
+
+EncodeStatsCollector::EncodeStatsCollector(
+    const std::vector<BaseSchemaPtr>& schemas)
+    : columns_(CompileColumnDescriptors(schemas)), stats_(columns_.size()) {
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].schema != nullptr) {
+      stats_[i].index = columns_[i].index;
+      stats_[i].type = columns_[i].type;
+    }
+  }
+}
+
+void EncodeStatsCollector::Add(const std::vector<std::any>& record) {
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].schema == nullptr) {
+      continue;
+    }
+
+    auto& stats = stats_[i];
+    const auto& data = record.at(i);
+    if (!data.has_value()) {
+      stats.null_count++;
+      continue;
+    }
+    stats.value_count++;
+
+    switch (stats.type) {
+      case BaseSchema::kBool:
+        AddValue<bool>(stats, data);
+        break;
+      case BaseSchema::kInteger:
+        AddValue<int32_t>(stats, data);
+        break;
+      case BaseSchema::kFloat:
+        AddValue<float>(stats, data);
+        break;
+      case BaseSchema::kLong:
+        AddValue<int64_t>(stats, data);
+        break;
+      case BaseSchema::kDouble:
+        AddValue<double>(stats, data);
+        break;
+      case BaseSchema::kString:
+        AddValue<std::string>(stats, data);
+        break;
+      case BaseSchema::kBoolList:
+        AddValue<std::vector<bool>>(stats, data);
+        break;
+      case BaseSchema::kIntegerList:
+        AddValue<std::vector<int32_t>>(stats, data);
+        break;
+      case BaseSchema::kFloatList:
+        AddValue<std::vector<float>>(stats, data);
+        break;
+      case BaseSchema::kLongList:
+        AddValue<std::vector<int64_t>>(stats, data);
+        break;
+      case BaseSchema::kDoubleList:
+        AddValue<std::vector<double>>(stats, data);
+        break;
+      case BaseSchema::kStringList:
+        AddValue<std::vector<std::string>>(stats, data);
+        break;
+    }
+  }
+  row_count_++;
+}
+
+void EncodeStatsCollector::Merge(const EncodeStatsCollector& other) {
+  if (other.stats_.size() != stats_.size()) {
+    throw std::runtime_error("Merge stats of other schemas.");
+  }
+  for (size_t i = 0; i < stats_.size(); ++i) {
+    if (other.stats_[i].index != stats_[i].index ||
+        other.stats_[i].type != stats_[i].type) {
+      throw std::runtime_error("Merge stats of other schemas.");
+    }
+  }
+
+  for (size_t i = 0; i < stats_.size(); ++i) {
+    auto& stats = stats_[i];
+    const auto& other_stats = other.stats_[i];
+    stats.null_count += other_stats.null_count;
+    stats.value_count += other_stats.value_count;
+    stats.distinct.Merge(other_stats.distinct);
+
+    switch (stats.type) {
+      case BaseSchema::kBool:
+        MergeRange<bool>(stats, other_stats);
+        break;
+      case BaseSchema::kInteger:
+        MergeRange<int32_t>(stats, other_stats);
+        break;
+      case BaseSchema::kFloat:
+        MergeRange<float>(stats, other_stats);
+        break;
+      case BaseSchema::kLong:
+        MergeRange<int64_t>(stats, other_stats);
+        break;
+      case BaseSchema::kDouble:
+        MergeRange<double>(stats, other_stats);
+        break;
+      case BaseSchema::kString:
+        MergeRange<std::string>(stats, other_stats);
+        break;
+      default:
+        break;
+    }
+  }
+  row_count_ += other.row_count_;
+}
+
+void EncodeStatsCollector::Reset() {
+  for (auto& stats : stats_) {
+    stats.null_count = 0;
+    stats.value_count = 0;
+    stats.min.reset();
+    stats.max.reset();
+    stats.distinct.Clear();
+  }
+  row_count_ = 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,82 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DINGO_SERIAL_ENCODE_STATS_V2_H_
+#define DINGO_SERIAL_ENCODE_STATS_V2_H_
+
+#include <any>
+#include <cstdint>
+#include <vector>
+
+#include "serial/record/V2/column_descriptor.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/distinct_sketch.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// What was seen of one column over the rows added.
+struct ColumnStats {
+  // the schema index, -1 for a null schema.
+  int index{-1};
+  BaseSchema::Type type{BaseSchema::kBool};
+
+  int64_t null_count{0};
+  int64_t value_count{0};
+
+  // the smallest and largest not null value, as held in a record. Empty for
+  // lists and until a value is seen, NaN is left out.
+  std::any min;
+  std::any max;
+
+  // over the hashes of the not null values.
+  DistinctSketch distinct;
+};
+
+/*
+ * Per column null counts, min/max and distinct sketches of the rows of a
+ * block, for zone maps built while the rows are encoded, see the Encode
+ * overloads of RecordEncoderV2 taking one. A collector is not thread safe,
+ * keep one per writer or thread and Merge them.
+ */
+class EncodeStatsCollector {
+ public:
+  explicit EncodeStatsCollector(const std::vector<BaseSchemaPtr>& schemas);
+
+  // Add the columns of record, laid out as the schemas.
+  void Add(const std::vector<std::any>& record);
+
+  // Add the rows of other, collected over the same schemas. Throws
+  // runtime_error for other schemas.
+  void Merge(const EncodeStatsCollector& other);
+
+  // Forget the rows added, e.g. once a block is flushed.
+  void Reset();
+
+  int64_t RowCount() const { return row_count_; }
+
+  // one per schema, at the same positions.
+  const std::vector<ColumnStats>& Columns() const { return stats_; }
+
+ private:
+  std::vector<ColumnDescriptor> columns_;
+  std::vector<ColumnStats> stats_;
+  int64_t row_count_{0};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,87 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ENCODED_BATCH_V2_H_
+#define DINGO_SERIAL_ENCODED_BATCH_V2_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/schema/V2/column_value.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+class RecordEncoderV2;
+
+// The keys and values of a batch encoded in one arena, row after row, each
+// row its key then its value. Key and Value are views into the arena, valid
+// until the batch is encoded into again, and the rows are freed together
+// with it. Reusing a batch reuses its arena and scratch.
+class EncodedBatch {
+ public:
+  size_t Size() const { return offsets_.size() / 2; }
+
+  std::string_view Key(size_t row) const {
+    return std::string_view(arena_.data() + offsets_[2 * row],
+                            offsets_[2 * row + 1] - offsets_[2 * row]);
+  }
+  std::string_view Value(size_t row) const {
+    return std::string_view(arena_.data() + offsets_[2 * row + 1],
+                            offsets_[2 * row + 2] - offsets_[2 * row + 1]);
+  }
+
+  // The rows back to back.
+  const std::string& Arena() const { return arena_; }
+
+  void Clear() {
+    arena_.clear();
+    offsets_.resize(1);
+  }
+
+ private:
+  friend class RecordEncoderV2;
+
+  // A fixed width value column encoded across the batch, the word of row i
+  // at i * width of data. width is 0 for a column left to the schema row by
+  // row.
+  struct ColumnRun {
+    std::string data;
+    int width{0};
+
+    std::string_view Row(size_t row) const {
+      return std::string_view(data.data() + row * width, width);
+    }
+  };
+
+  std::string arena_;
+  // row i spans [offsets_[2i], offsets_[2i + 2]), its value starting at
+  // offsets_[2i + 1].
+  std::vector<size_t> offsets_{0};
+
+  // scratch kept for its storage: the runs of the value columns in plan
+  // order, a record holding the values handed to the schemas and the keys
+  // built column by column.
+  std::vector<ColumnRun> value_runs_;
+  std::vector<ColumnValue> record_;
+  // the fixed width keys of the rows, back to back.
+  std::string fixed_keys_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,140 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "encoded_predicate.h"
+
+#include <stdexcept>
+#include <typeinfo>
+#include <utility>
+
+namespace dingodb {
+namespace serialV2 {
+
+EncodedPredicate::EncodedPredicate(int column, Op op,
+                                   const std::vector<std::any>& operands)
+    : column_(column), op_(op) {
+  size_t expect = op == kIsNull ? 0 : (op == kBetween ? 2 : 1);
+  if (op == kIn ? operands.empty() : operands.size() != expect) {
+    throw std::runtime_error("Wrong operand count for predicate.");
+  }
+
+  operands_.reserve(operands.size());
+  for (const auto& any : operands) {
+    Operand operand;
+    const auto& type = any.type();
+    if (type == typeid(bool)) {
+      operand.kind = Operand::kInt;
+      operand.i = std::any_cast<bool>(any);
+    } else if (type == typeid(int32_t)) {
+      operand.kind = Operand::kInt;
+      operand.i = std::any_cast<int32_t>(any);
+    } else if (type == typeid(int64_t)) {
+      operand.kind = Operand::kInt;
+      operand.i = std::any_cast<int64_t>(any);
+    } else if (type == typeid(float)) {
+      operand.kind = Operand::kDouble;
+      operand.d = std::any_cast<float>(any);
+    } else if (type == typeid(double)) {
+      operand.kind = Operand::kDouble;
+      operand.d = std::any_cast<double>(any);
+    } else if (type == typeid(std::string)) {
+      operand.kind = Operand::kString;
+      operand.s = std::any_cast<const std::string&>(any);
+    } else {
+      throw std::runtime_error("Unsupport predicate operand type.");
+    }
+    operands_.push_back(std::move(operand));
+  }
+}
+
+int EncodedPredicate::Compare(int64_t value, const Operand& operand) {
+  if (operand.kind == Operand::kInt) {
+    return value < operand.i ? -1 : (value > operand.i ? 1 : 0);
+  }
+  return Compare(static_cast<double>(value), operand);
+}
+
+int EncodedPredicate::Compare(double value, const Operand& operand) {
+  double d;
+  if (operand.kind == Operand::kDouble) {
+    d = operand.d;
+  } else if (operand.kind == Operand::kInt) {
+    d = static_cast<double>(operand.i);
+  } else {
+    return kIncomparable;
+  }
+
+  if (value < d) {
+    return -1;
+  } else if (value > d) {
+    return 1;
+  } else if (value == d) {
+    return 0;
+  }
+  return kIncomparable;
+}
+
+int EncodedPredicate::Compare(std::string_view value, const Operand& operand) {
+  if (operand.kind != Operand::kString) {
+    return kIncomparable;
+  }
+  int cmp = value.compare(operand.s);
+  return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+}
+
+template <typename T>
+bool EncodedPredicate::MatchImpl(T value) const {
+  switch (op_) {
+    case kEqual:
+      return Compare(value, operands_[0]) == 0;
+    case kLess:
+      return Compare(value, operands_[0]) == -1;
+    case kLessEqual: {
+      int cmp = Compare(value, operands_[0]);
+      return cmp == -1 || cmp == 0;
+    }
+    case kGreater:
+      return Compare(value, operands_[0]) == 1;
+    case kGreaterEqual: {
+      int cmp = Compare(value, operands_[0]);
+      return cmp == 1 || cmp == 0;
+    }
+    case kBetween: {
+      int low = Compare(value, operands_[0]);
+      int high = Compare(value, operands_[1]);
+      return (low == 1 || low == 0) && (high == -1 || high == 0);
+    }
+    case kIn:
+      for (const auto& operand : operands_) {
+        if (Compare(value, operand) == 0) {
+          return true;
+        }
+      }
+      return false;
+    case kIsNull:
+    default:
+      return false;
+  }
+}
+
+bool EncodedPredicate::Match(int64_t value) const { return MatchImpl(value); }
+
+bool EncodedPredicate::Match(double value) const { return MatchImpl(value); }
+
+bool EncodedPredicate::Match(std::string_view value) const {
+  return MatchImpl(value);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
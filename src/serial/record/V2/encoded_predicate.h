@@ -0,0 +1,156 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ENCODED_PREDICATE_V2_H_
+#define DINGO_SERIAL_ENCODED_PREDICATE_V2_H_
+
+#include <any>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/schema/V2/row_sink.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * A single column condition evaluated by RecordDecoderV2::Evaluate on the
+ * encoded row, only the column itself is located and read.
+ *
+ * column is the position in the decoder's schemas. Operands are std::any of
+ * bool, int32_t, int64_t, float, double or std::string; integers and floating
+ * point numbers compare with each other, strings bytewise. A null column only
+ * matches kIsNull, list columns never match.
+ */
+class EncodedPredicate {
+ public:
+  enum Op {
+    kEqual,
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+    kBetween,  // both bounds included.
+    kIsNull,
+    kIn,
+  };
+
+  EncodedPredicate(int column, Op op, const std::vector<std::any>& operands);
+
+  static EncodedPredicate Equal(int column, const std::any& operand) {
+    return EncodedPredicate(column, kEqual, {operand});
+  }
+  static EncodedPredicate Less(int column, const std::any& operand) {
+    return EncodedPredicate(column, kLess, {operand});
+  }
+  static EncodedPredicate LessEqual(int column, const std::any& operand) {
+    return EncodedPredicate(column, kLessEqual, {operand});
+  }
+  static EncodedPredicate Greater(int column, const std::any& operand) {
+    return EncodedPredicate(column, kGreater, {operand});
+  }
+  static EncodedPredicate GreaterEqual(int column, const std::any& operand) {
+    return EncodedPredicate(column, kGreaterEqual, {operand});
+  }
+  static EncodedPredicate Between(int column, const std::any& low,
+                                  const std::any& high) {
+    return EncodedPredicate(column, kBetween, {low, high});
+  }
+  static EncodedPredicate IsNull(int column) {
+    return EncodedPredicate(column, kIsNull, {});
+  }
+  static EncodedPredicate In(int column, const std::vector<std::any>& operands) {
+    return EncodedPredicate(column, kIn, operands);
+  }
+
+  int Column() const { return column_; }
+  Op GetOp() const { return op_; }
+
+  bool MatchNull() const { return op_ == kIsNull; }
+  bool Match(int64_t value) const;
+  bool Match(double value) const;
+  bool Match(std::string_view value) const;
+
+ private:
+  struct Operand {
+    enum Kind { kInt, kDouble, kString, kNone };
+    Kind kind{kNone};
+    int64_t i{0};
+    double d{0};
+    std::string s;
+  };
+
+  // -1, 0 or 1, kIncomparable for another kind or NaN.
+  static constexpr int kIncomparable = 2;
+  static int Compare(int64_t value, const Operand& operand);
+  static int Compare(double value, const Operand& operand);
+  static int Compare(std::string_view value, const Operand& operand);
+
+  template <typename T>
+  bool MatchImpl(T value) const;
+
+  int column_;
+  Op op_;
+  std::vector<Operand> operands_;
+};
+
+// Feeds one decoded column into a predicate, no value outlives the call.
+class PredicateSink : public RowSink {
+ public:
+  explicit PredicateSink(const EncodedPredicate& predicate)
+      : predicate_(predicate) {}
+
+  bool Matched() const { return matched_; }
+
+  void OnNull(int) override { matched_ = predicate_.MatchNull(); }
+
+  void OnBool(int, bool value) override {
+    matched_ = predicate_.Match(static_cast<int64_t>(value));
+  }
+  void OnInt32(int, int32_t value) override {
+    matched_ = predicate_.Match(static_cast<int64_t>(value));
+  }
+  void OnInt64(int, int64_t value) override {
+    matched_ = predicate_.Match(value);
+  }
+  void OnFloat(int, float value) override {
+    matched_ = predicate_.Match(static_cast<double>(value));
+  }
+  void OnDouble(int, double value) override {
+    matched_ = predicate_.Match(value);
+  }
+  void OnString(int, std::string_view value) override {
+    matched_ = predicate_.Match(value);
+  }
+
+  void OnBoolList(int, std::vector<bool>&&) override { matched_ = false; }
+  void OnInt32List(int, std::vector<int32_t>&&) override { matched_ = false; }
+  void OnInt64List(int, std::vector<int64_t>&&) override { matched_ = false; }
+  void OnFloatList(int, std::vector<float>&&) override { matched_ = false; }
+  void OnDoubleList(int, std::vector<double>&&) override { matched_ = false; }
+  void OnStringList(int, std::vector<std::string>&&) override {
+    matched_ = false;
+  }
+
+ private:
+  const EncodedPredicate& predicate_;
+  bool matched_{false};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
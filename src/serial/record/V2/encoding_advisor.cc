@@ -0,0 +1,472 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/encoding_advisor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <type_traits>
+#include <unordered_set>
+
+#include "serial/schema/V2/column_value.h"
+#include "serial/schema/V2/dingo_schema.h"
+#include "serial/schema/V2/string_dictionary.h"
+#include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/latency.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// The encodings besides the plain one a column of type takes.
+std::vector<ColumnEncoding> EncodingsOf(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::kInteger:
+    case BaseSchema::kLong:
+      return {ColumnEncoding::kVarint};
+    case BaseSchema::kString:
+      return {ColumnEncoding::kDictionary, ColumnEncoding::kFixedLength};
+    case BaseSchema::kIntegerList:
+    case BaseSchema::kLongList:
+      return {ColumnEncoding::kDelta};
+    case BaseSchema::kDoubleList:
+      return {ColumnEncoding::kXor};
+    case BaseSchema::kBoolList:
+      return {ColumnEncoding::kPacked};
+    default:
+      return {};
+  }
+}
+
+// Set encoding on schema, of a type taking it.
+void SetEncoding(BaseSchema* schema, ColumnEncoding encoding,
+                 const ColumnAdvice& advice) {
+  switch (encoding) {
+    case ColumnEncoding::kPlain:
+      break;
+    case ColumnEncoding::kVarint:
+      if (schema->GetType() == BaseSchema::kInteger) {
+        static_cast<DingoSchema<int32_t>*>(schema)->SetVarint(true);
+      } else {
+        static_cast<DingoSchema<int64_t>*>(schema)->SetVarint(true);
+      }
+      break;
+    case ColumnEncoding::kDictionary:
+      static_cast<DingoSchema<std::string>*>(schema)->SetDictionary(
+          std::make_shared<const StringDictionary>(advice.dictionary));
+      break;
+    case ColumnEncoding::kFixedLength:
+      static_cast<DingoSchema<std::string>*>(schema)->SetFixedLength(
+          advice.max_length);
+      break;
+    case ColumnEncoding::kDelta:
+      if (schema->GetType() == BaseSchema::kIntegerList) {
+        static_cast<DingoSchema<std::vector<int32_t>>*>(schema)
+            ->SetDeltaEncoded(true);
+      } else {
+        static_cast<DingoSchema<std::vector<int64_t>>*>(schema)
+            ->SetDeltaEncoded(true);
+      }
+      break;
+    case ColumnEncoding::kXor:
+      static_cast<DingoSchema<std::vector<double>>*>(schema)->SetXorEncoded(
+          true);
+      break;
+    case ColumnEncoding::kPacked:
+      static_cast<DingoSchema<std::vector<bool>>*>(schema)->SetPacked(true);
+      break;
+  }
+}
+
+template <typename T>
+void AddInteger(ColumnAdvice& advice, T value, bool first) {
+  int64_t number = value;
+  advice.min_integer = first ? number : std::min(advice.min_integer, number);
+  advice.max_integer = first ? number : std::max(advice.max_integer, number);
+}
+
+template <typename T>
+void AddReal(ColumnAdvice& advice, T value, bool first) {
+  double number = value;
+  advice.min_real = first ? number : std::min(advice.min_real, number);
+  advice.max_real = first ? number : std::max(advice.max_real, number);
+}
+
+// Ranges of the elements of the number list at value, first when no element
+// was seen before. Returns the list length.
+template <typename T>
+size_t AddList(ColumnAdvice& advice, const std::any& value, bool& first) {
+  const auto& list = *DataOf<std::vector<T>>(value);
+  for (const auto& element : list) {
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+      AddInteger(advice, element, first);
+      first = false;
+    } else if constexpr (std::is_floating_point_v<T>) {
+      AddReal(advice, element, first);
+      first = false;
+    }
+  }
+  return list.size();
+}
+
+}  // namespace
+
+const char* ColumnTypeName(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::kBool:
+      return "bool";
+    case BaseSchema::kInteger:
+      return "int";
+    case BaseSchema::kFloat:
+      return "float";
+    case BaseSchema::kLong:
+      return "long";
+    case BaseSchema::kDouble:
+      return "double";
+    case BaseSchema::kString:
+      return "string";
+    case BaseSchema::kBoolList:
+      return "bool list";
+    case BaseSchema::kIntegerList:
+      return "int list";
+    case BaseSchema::kFloatList:
+      return "float list";
+    case BaseSchema::kLongList:
+      return "long list";
+    case BaseSchema::kDoubleList:
+      return "double list";
+    case BaseSchema::kStringList:
+      return "string list";
+  }
+  return "unknown";
+}
+
+const char* ColumnEncodingName(ColumnEncoding encoding) {
+  switch (encoding) {
+    case ColumnEncoding::kPlain:
+      return "plain";
+    case ColumnEncoding::kVarint:
+      return "varint";
+    case ColumnEncoding::kDictionary:
+      return "dictionary";
+    case ColumnEncoding::kFixedLength:
+      return "fixed length";
+    case ColumnEncoding::kDelta:
+      return "delta";
+    case ColumnEncoding::kXor:
+      return "xor";
+    case ColumnEncoding::kPacked:
+      return "packed";
+  }
+  return "unknown";
+}
+
+const char* ValueLayoutName(ValueLayout layout) {
+  switch (layout) {
+    case ValueLayout::kPlain:
+      return "plain";
+    case ValueLayout::kNullBitmap:
+      return "null bitmap";
+    case ValueLayout::kSparse:
+      return "sparse";
+    case ValueLayout::kStaticOffsets:
+      return "static offsets";
+    case ValueLayout::kBoolBits:
+      return "bool bits";
+  }
+  return "unknown";
+}
+
+void EncodingAdvice::ApplyTo(std::vector<BaseSchemaPtr>& schemas) const {
+  for (const auto& advice : columns) {
+    if (advice.column >= static_cast<int>(schemas.size()) ||
+        schemas[advice.column] == nullptr ||
+        schemas[advice.column]->GetType() != advice.type) {
+      continue;
+    }
+    SetEncoding(schemas[advice.column].get(), advice.recommended, advice);
+  }
+}
+
+void EncodingAdvice::ApplyTo(RecordEncoderV2& encoder) const {
+  ValueLayout layout = recommended_layout.layout;
+  encoder.SetCompactValueHeader(recommended_layout.compact_header);
+  encoder.SetNullBitmap(layout == ValueLayout::kNullBitmap);
+  encoder.SetSparseValues(layout == ValueLayout::kSparse);
+  encoder.SetStaticOffsets(layout == ValueLayout::kStaticOffsets);
+  encoder.SetBoolBits(layout == ValueLayout::kBoolBits);
+}
+
+std::string EncodingAdvice::ToString() const {
+  std::string out = "rows " + std::to_string(rows) + "\n";
+  char number[32];
+  for (const auto& advice : columns) {
+    out += "column " + std::to_string(advice.column) + " " +
+           ColumnTypeName(advice.type) +
+           ": nulls " + std::to_string(advice.nulls) + ", distinct " +
+           std::to_string(advice.distinct) +
+           (advice.distinct_capped ? "+" : "");
+    if (advice.type == BaseSchema::kString ||
+        advice.type >= BaseSchema::kBoolList) {
+      out += ", length " + std::to_string(advice.min_length) + ".." +
+             std::to_string(advice.max_length);
+    }
+    for (const auto& estimate : advice.estimates) {
+      snprintf(number, sizeof(number), "%.1f", estimate.decode_ns);
+      out += estimate.encoding == ColumnEncoding::kPlain ? "; " : ", ";
+      out += std::string(ColumnEncodingName(estimate.encoding)) + " " +
+             std::to_string(estimate.bytes) + "B " + number + "ns";
+    }
+    out += std::string(" -> ") + ColumnEncodingName(advice.recommended) + "\n";
+  }
+  out += "layout";
+  for (size_t i = 0; i < layouts.size(); ++i) {
+    const auto& estimate = layouts[i];
+    out += std::string(i == 0 ? " " : ", ") + ValueLayoutName(estimate.layout) +
+           (estimate.compact_header ? " compact " : " ") +
+           std::to_string(estimate.bytes) + "B";
+  }
+  out += std::string(" -> ") + ValueLayoutName(recommended_layout.layout) +
+         (recommended_layout.compact_header ? " compact" : "") + "\n";
+  return out;
+}
+
+EncodingAdvisor::EncodingAdvisor(int schema_version,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 long common_id)
+    : EncodingAdvisor(schema_version, schemas, common_id, IsLE()) {}
+
+EncodingAdvisor::EncodingAdvisor(int schema_version,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 long common_id, bool le)
+    : schema_version_(schema_version),
+      schemas_(schemas),
+      common_id_(common_id),
+      le_(le),
+      decoder_(schema_version, schemas, common_id, le) {}
+
+int EncodingAdvisor::AddRow(std::string_view key, std::string_view value) {
+  std::vector<std::any> record;
+  if (decoder_.Decode(key, value, record) != 0) {
+    return -1;
+  }
+  records_.push_back(std::move(record));
+  return 0;
+}
+
+long EncodingAdvisor::AddRows(const KeyValue* rows, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (AddRow(rows[i].GetKey(), rows[i].GetValue()) != 0) {
+      return -1;
+    }
+  }
+  return count;
+}
+
+EncodingEstimate EncodingAdvisor::Estimate(int column, ColumnEncoding encoding,
+                                           BaseSchema* schema) const {
+  EncodingEstimate estimate{encoding, 0, 0};
+  Buf buf(1024, le_);
+  std::vector<int> offsets;
+  for (const auto& record : records_) {
+    const auto& value = record[column];
+    if (value.has_value()) {
+      offsets.push_back(buf.Size());
+      estimate.bytes += schema->EncodeValue(value, buf);
+    }
+  }
+  if (offsets.empty()) {
+    return estimate;
+  }
+
+  std::string bytes;
+  buf.GetString(bytes);
+  BufView view(bytes, le_);
+  uint64_t start = CycleClock::Now();
+  for (int offset : offsets) {
+    schema->DecodeValue(view, offset);
+  }
+  uint64_t ticks = CycleClock::Now() - start;
+  estimate.decode_ns = ticks * CycleClock::NanosPerTick() / offsets.size();
+  return estimate;
+}
+
+ColumnAdvice EncodingAdvisor::AdviseColumn(int column) const {
+  BaseSchema* schema = schemas_[column].get();
+  ColumnAdvice advice;
+  advice.column = column;
+  advice.type = schema->GetType();
+
+  BaseSchemaPtr plain = schema->Clone();
+  plain->SetIsLe(le_);
+  plain->SetAllowNull(true);
+  std::unordered_set<std::string> distinct;
+  std::unordered_set<std::string> strings;
+  bool first_element = true;
+  size_t total_length = 0;
+  for (const auto& record : records_) {
+    const auto& value = record[column];
+    advice.rows++;
+    if (!value.has_value()) {
+      advice.nulls++;
+      continue;
+    }
+    bool first = advice.rows - advice.nulls == 1;
+
+    size_t length = 0;
+    switch (advice.type) {
+      case BaseSchema::kInteger:
+        AddInteger(advice, *DataOf<int32_t>(value), first);
+        break;
+      case BaseSchema::kLong:
+        AddInteger(advice, *DataOf<int64_t>(value), first);
+        break;
+      case BaseSchema::kFloat:
+        AddReal(advice, *DataOf<float>(value), first);
+        break;
+      case BaseSchema::kDouble:
+        AddReal(advice, *DataOf<double>(value), first);
+        break;
+      case BaseSchema::kString: {
+        const auto& str = *DataOf<std::string>(value);
+        length = str.size();
+        if (strings.size() < kMaxDistinct && strings.insert(str).second) {
+          advice.dictionary.push_back(str);
+        }
+        break;
+      }
+      case BaseSchema::kBoolList:
+        length = AddList<bool>(advice, value, first_element);
+        break;
+      case BaseSchema::kIntegerList:
+        length = AddList<int32_t>(advice, value, first_element);
+        break;
+      case BaseSchema::kFloatList:
+        length = AddList<float>(advice, value, first_element);
+        break;
+      case BaseSchema::kLongList:
+        length = AddList<int64_t>(advice, value, first_element);
+        break;
+      case BaseSchema::kDoubleList:
+        length = AddList<double>(advice, value, first_element);
+        break;
+      case BaseSchema::kStringList:
+        length = AddList<std::string>(advice, value, first_element);
+        break;
+      default:
+        break;
+    }
+    advice.min_length = first ? length : std::min(advice.min_length, length);
+    advice.max_length = std::max(advice.max_length, length);
+    total_length += length;
+
+    if (distinct.size() < kMaxDistinct) {
+      Buf buf(64, le_);
+      plain->EncodeValue(value, buf);
+      std::string bytes;
+      buf.GetString(bytes);
+      distinct.insert(std::move(bytes));
+    } else {
+      advice.distinct_capped = true;
+    }
+  }
+  advice.distinct = distinct.size();
+  size_t not_null = advice.rows - advice.nulls;
+  advice.mean_length =
+      not_null == 0 ? 0 : static_cast<double>(total_length) / not_null;
+
+  advice.estimates.push_back(
+      Estimate(column, ColumnEncoding::kPlain, plain.get()));
+  for (auto encoding : EncodingsOf(advice.type)) {
+    // a dictionary of every sampled value when they recur, values seen once
+    // tell of a column whose later values miss the dictionary; a fixed
+    // length of the one seen.
+    if ((encoding == ColumnEncoding::kDictionary &&
+         (advice.distinct_capped || advice.dictionary.empty() ||
+          advice.dictionary.size() * 2 > not_null)) ||
+        (encoding == ColumnEncoding::kFixedLength &&
+         (not_null == 0 || advice.min_length != advice.max_length ||
+          advice.max_length == 0))) {
+      continue;
+    }
+    BaseSchemaPtr candidate = schema->Clone();
+    candidate->SetIsLe(le_);
+    candidate->SetAllowNull(true);
+    SetEncoding(candidate.get(), encoding, advice);
+    advice.estimates.push_back(Estimate(column, encoding, candidate.get()));
+  }
+
+  const EncodingEstimate* best = &advice.estimates[0];
+  for (const auto& estimate : advice.estimates) {
+    if (estimate.bytes < best->bytes) {
+      best = &estimate;
+    }
+  }
+  size_t plain_bytes = advice.estimates[0].bytes;
+  if (plain_bytes - best->bytes >= kMinSaving * plain_bytes &&
+      best->bytes < plain_bytes) {
+    advice.recommended = best->encoding;
+  }
+  if (advice.recommended != ColumnEncoding::kDictionary) {
+    advice.dictionary.clear();
+  }
+  return advice;
+}
+
+EncodingAdvice EncodingAdvisor::Advise() const {
+  EncodingAdvice advice;
+  advice.rows = records_.size();
+  bool has_bools = false;
+  for (size_t i = 0; i < schemas_.size(); ++i) {
+    if (schemas_[i] == nullptr || schemas_[i]->IsKey()) {
+      continue;
+    }
+    has_bools |= schemas_[i]->GetType() == BaseSchema::kBool;
+    advice.columns.push_back(AdviseColumn(i));
+  }
+
+  std::vector<ValueLayout> layouts{
+      ValueLayout::kPlain, ValueLayout::kNullBitmap, ValueLayout::kSparse,
+      ValueLayout::kStaticOffsets};
+  if (has_bools) {
+    layouts.push_back(ValueLayout::kBoolBits);
+  }
+  for (bool compact : {false, true}) {
+    for (auto layout : layouts) {
+      LayoutEstimate estimate{layout, compact, 0};
+      RecordEncoderV2 encoder(schema_version_, schemas_, common_id_, le_);
+      EncodingAdvice trial;
+      trial.recommended_layout = estimate;
+      trial.ApplyTo(encoder);
+      for (const auto& record : records_) {
+        estimate.bytes += encoder.EncodedValueSize(record);
+      }
+      advice.layouts.push_back(estimate);
+    }
+  }
+  advice.recommended_layout = advice.layouts[0];
+  for (const auto& estimate : advice.layouts) {
+    if (estimate.bytes < advice.recommended_layout.bytes) {
+      advice.recommended_layout = estimate;
+    }
+  }
+  return advice;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
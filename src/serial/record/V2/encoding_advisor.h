@@ -0,0 +1,174 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ENCODING_ADVISOR_V2_H_
+#define DINGO_SERIAL_ENCODING_ADVISOR_V2_H_
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/keyvalue.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+const char* ColumnTypeName(BaseSchema::Type type);
+
+// The lossless value encodings of a column, see the setters of the schemas.
+enum class ColumnEncoding {
+  kPlain,
+  kVarint,       // int and long, SetVarint.
+  kDictionary,   // string, SetDictionary of the sampled values, when each
+                 // recurs twice on average.
+  kFixedLength,  // string, SetFixedLength of the one sampled length.
+  kDelta,        // int and long list, SetDeltaEncoded.
+  kXor,          // double list, SetXorEncoded.
+  kPacked,       // bool list, SetPacked.
+};
+
+const char* ColumnEncodingName(ColumnEncoding encoding);
+
+// The value layouts of RecordEncoderV2, each with or without the compact
+// header.
+enum class ValueLayout {
+  kPlain,
+  kNullBitmap,     // SetNullBitmap.
+  kSparse,         // SetSparseValues.
+  kStaticOffsets,  // SetStaticOffsets.
+  kBoolBits,       // SetBoolBits.
+};
+
+const char* ValueLayoutName(ValueLayout layout);
+
+// Bytes the sampled values of a column take under an encoding, and the
+// nanoseconds a decode of one took on this host.
+struct EncodingEstimate {
+  ColumnEncoding encoding;
+  size_t bytes;
+  double decode_ns;
+};
+
+struct ColumnAdvice {
+  int column;
+  BaseSchema::Type type;
+
+  size_t rows{0};
+  size_t nulls{0};
+  // distinct values up to EncodingAdvisor::kMaxDistinct, capped past it.
+  size_t distinct{0};
+  bool distinct_capped{false};
+  // range of the int and long columns and of the elements of their lists.
+  int64_t min_integer{0};
+  int64_t max_integer{0};
+  // range of the float and double columns and of their list elements.
+  double min_real{0};
+  double max_real{0};
+  // bytes of a string or elements of a list, over the not null values.
+  size_t min_length{0};
+  size_t max_length{0};
+  double mean_length{0};
+
+  // plain first, then the other encodings the column takes.
+  std::vector<EncodingEstimate> estimates;
+  ColumnEncoding recommended{ColumnEncoding::kPlain};
+  // the sampled strings in first seen order, for a recommended dictionary.
+  std::vector<std::string> dictionary;
+};
+
+// Bytes the sampled values take in a layout, with the current column
+// encodings.
+struct LayoutEstimate {
+  ValueLayout layout;
+  bool compact_header;
+  size_t bytes;
+};
+
+struct EncodingAdvice {
+  size_t rows{0};
+  // the value columns in schema order.
+  std::vector<ColumnAdvice> columns;
+  std::vector<LayoutEstimate> layouts;
+  LayoutEstimate recommended_layout{ValueLayout::kPlain, false, 0};
+
+  // Set the recommended encodings on the value columns of schemas, those
+  // the advice was made for. The values then change form: write them with
+  // a new schema version, keeping the old schemas to decode older rows.
+  void ApplyTo(std::vector<BaseSchemaPtr>& schemas) const;
+  // Set the recommended layout on encoder.
+  void ApplyTo(RecordEncoderV2& encoder) const;
+
+  // One line per value column and layout, the estimates and the choice.
+  std::string ToString() const;
+};
+
+/*
+ * Picks the encodings of the value columns of a table from a sample of its
+ * encoded rows.
+ *
+ * The sampled rows are decoded with the schemas and kept; Advise gathers the
+ * statistics of every value column and encodes its values under each
+ * encoding the column takes, with schemas set for it, so that the sizes are
+ * the ones the encoder would write and the decode times measured. The
+ * encoding taking the fewest bytes is recommended when it saves at least
+ * kMinSaving of the plain bytes, the plain form decoding the fastest
+ * otherwise. The value layouts are estimated likewise with encoders of the
+ * schemas, the smallest recommended.
+ *
+ * Lossy encodings, the float quantizations, and compression are left to the
+ * caller, as are the key columns, whose encoding keeps the sort order. Not
+ * thread safe.
+ */
+class EncodingAdvisor {
+ public:
+  static constexpr size_t kMaxDistinct = 4096;
+  static constexpr double kMinSaving = 1.0 / 16;
+
+  EncodingAdvisor(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                  long common_id);
+  EncodingAdvisor(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                  long common_id, bool le);
+
+  // Add a sampled row. Returns -1 when the decoder rejects it.
+  int AddRow(std::string_view key, std::string_view value);
+  // Returns the rows added, or -1 at the first row rejected.
+  long AddRows(const KeyValue* rows, size_t count);
+  size_t RowCount() const { return records_.size(); }
+
+  EncodingAdvice Advise() const;
+
+ private:
+  ColumnAdvice AdviseColumn(int column) const;
+  // Estimate of the sampled values of column under schema, set to encoding.
+  EncodingEstimate Estimate(int column, ColumnEncoding encoding,
+                            BaseSchema* schema) const;
+
+  int schema_version_;
+  std::vector<BaseSchemaPtr> schemas_;
+  long common_id_;
+  bool le_;
+  RecordDecoderV2 decoder_;
+  std::vector<std::vector<std::any>> records_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
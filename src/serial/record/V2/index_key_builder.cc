@@ -0,0 +1,147 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/index_key_builder.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "serial/record/V2/common.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+int EncodeFragment(BaseSchema* schema, const std::any& data, Buf& buf) {
+  return schema->EncodeKey(data, buf);
+}
+int EncodeFragment(BaseSchema* schema, const ColumnValue& data, Buf& buf) {
+  return schema->EncodeKeyVariant(data, buf);
+}
+
+}  // namespace
+
+IndexKeyBuilder::IndexKeyBuilder(int64_t common_id,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 std::vector<IndexDefinition> indexes)
+    : IndexKeyBuilder(common_id, schemas, std::move(indexes), IsLE()) {}
+
+IndexKeyBuilder::IndexKeyBuilder(int64_t common_id,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 std::vector<IndexDefinition> indexes, bool le)
+    : le_(le),
+      schemas_(schemas),
+      indexes_(std::move(indexes)),
+      arena_(256, le) {
+  FormatSchema(schemas_, le);
+
+  Buf version(4, le);
+  version.WriteInt(CODEC_VERSION_V2);
+  version.GetString(codec_version_);
+
+  std::vector<int> key_columns;
+  for (size_t i = 0; i < schemas_.size(); ++i) {
+    if (schemas_[i] != nullptr && schemas_[i]->IsKey()) {
+      key_columns.push_back(i);
+    }
+  }
+  keys_.push_back(PlanKey(common_id, key_columns));
+
+  for (const auto& index : indexes_) {
+    std::vector<int> columns = index.columns;
+    if (!index.unique) {
+      for (int column : key_columns) {
+        if (std::find(columns.begin(), columns.end(), column) ==
+            columns.end()) {
+          columns.push_back(column);
+        }
+      }
+    }
+    keys_.push_back(PlanKey(index.common_id, columns));
+  }
+  ends_.resize(columns_.size() + 1);
+}
+
+IndexKeyBuilder::KeyPlan IndexKeyBuilder::PlanKey(
+    int64_t common_id, const std::vector<int>& columns) {
+  KeyPlan plan;
+  Buf head(9, le_);
+  head.Write(0);
+  head.WriteLong(common_id);
+  head.GetString(plan.head);
+
+  for (int column : columns) {
+    if (column < 0 || static_cast<size_t>(column) >= schemas_.size() ||
+        schemas_[column] == nullptr) {
+      throw std::runtime_error("Index column out of range.");
+    }
+    if (schemas_[column]->GetType() >= BaseSchema::kBoolList) {
+      throw std::runtime_error("Unsupport encoding key list type");
+    }
+    auto it = std::find(columns_.begin(), columns_.end(), column);
+    if (it == columns_.end()) {
+      it = columns_.insert(columns_.end(), column);
+    }
+    plan.fragments.push_back(it - columns_.begin());
+  }
+  return plan;
+}
+
+template <typename Record>
+int IndexKeyBuilder::BuildImpl(char prefix, const Record& record,
+                               std::vector<std::string>& keys) {
+  arena_.Clear();
+  ends_[0] = 0;
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    int column = columns_[i];
+    EncodeFragment(schemas_[column].get(), record.at(column), arena_);
+    ends_[i + 1] = arena_.Size();
+  }
+
+  const char* fragments = arena_.Data();
+  keys.resize(keys_.size());
+  for (size_t k = 0; k < keys_.size(); ++k) {
+    const auto& plan = keys_[k];
+    size_t size = plan.head.size() + codec_version_.size();
+    for (int f : plan.fragments) {
+      size += ends_[f + 1] - ends_[f];
+    }
+
+    std::string& key = keys[k];
+    key.clear();
+    key.reserve(size);
+    key.append(plan.head);
+    key[0] = prefix;
+    for (int f : plan.fragments) {
+      key.append(fragments + ends_[f], ends_[f + 1] - ends_[f]);
+    }
+    key.append(codec_version_);
+  }
+  return keys.size();
+}
+
+int IndexKeyBuilder::Build(char prefix, const std::vector<std::any>& record,
+                           std::vector<std::string>& keys) {
+  return BuildImpl(prefix, record, keys);
+}
+
+int IndexKeyBuilder::Build(char prefix, const std::vector<ColumnValue>& record,
+                           std::vector<std::string>& keys) {
+  return BuildImpl(prefix, record, keys);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,101 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_INDEX_KEY_BUILDER_V2_H_
+#define DINGO_SERIAL_INDEX_KEY_BUILDER_V2_H_
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+#include "serial/schema/V2/column_value.h"
+#include "serial/utils/V2/buf.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// A secondary index of a table: its common id and the positions in the table
+// schemas, as in a record, of its columns in key order. The key of a unique
+// index holds its columns alone, the others are followed by the table key
+// columns not among them.
+struct IndexDefinition {
+  int64_t common_id;
+  std::vector<int> columns;
+  bool unique{false};
+};
+
+/*
+ * The row key and the secondary index keys of a record in one pass.
+ *
+ * Each column any key needs is encoded in its comparable key form once, then
+ * every key is assembled from these fragments:
+ *
+ *   prefix | common_id | {column fragment}* | codec version
+ *
+ * The row key is the one RecordEncoderV2::EncodeKey writes for the schemas,
+ * an index key the one it writes for schemas with the index columns as its
+ * key columns in the order above, a value column taking the key form of its
+ * schema. Lists have no key form, an index on one throws runtime_error.
+ */
+class IndexKeyBuilder {
+ public:
+  IndexKeyBuilder(int64_t common_id, const std::vector<BaseSchemaPtr>& schemas,
+                  std::vector<IndexDefinition> indexes);
+  IndexKeyBuilder(int64_t common_id, const std::vector<BaseSchemaPtr>& schemas,
+                  std::vector<IndexDefinition> indexes, bool le);
+
+  size_t IndexCount() const { return indexes_.size(); }
+
+  // keys[0] is the row key, keys[1 + i] the key of index i, strings already
+  // in keys are reused. Returns the number of keys. Not thread safe, the
+  // fragments go to a buffer of the builder.
+  int Build(char prefix, const std::vector<std::any>& record,
+            std::vector<std::string>& keys /*output*/);
+  int Build(char prefix, const std::vector<ColumnValue>& record,
+            std::vector<std::string>& keys /*output*/);
+
+ private:
+  // the fragment positions of a key and its common id, encoded.
+  struct KeyPlan {
+    std::string head;
+    std::vector<int> fragments;
+  };
+
+  KeyPlan PlanKey(int64_t common_id, const std::vector<int>& columns);
+
+  template <typename Record>
+  int BuildImpl(char prefix, const Record& record,
+                std::vector<std::string>& keys);
+
+  bool le_;
+  std::vector<BaseSchemaPtr> schemas_;
+  std::vector<IndexDefinition> indexes_;
+  // the columns encoded per row, each once, fragment i of columns_[i].
+  std::vector<int> columns_;
+  std::vector<KeyPlan> keys_;
+  std::string codec_version_;
+
+  Buf arena_;
+  // fragment i spans [ends_[i], ends_[i + 1]) of the arena.
+  std::vector<size_t> ends_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,296 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "key_block.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/varint.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+constexpr size_t kBlockHeaderSize = 8;
+// prefix(1) | common_id(8)
+constexpr size_t kKeyColumnsPos = 9;
+constexpr int kBlockVersion = KeyBlockBuilder::kBlockVersion;
+constexpr size_t kRestartInterval = KeyBlockBuilder::kRestartInterval;
+
+KeyBlockBuilder::KeyBlockBuilder(bool le) : le_(le), keys_(0, le) {}
+
+int KeyBlockBuilder::Add(std::string_view key) {
+  if (key_count_ > 0 && key <= std::string_view(last_key_)) {
+    return -1;
+  }
+
+  size_t shared = 0;
+  if (key_count_ % kRestartInterval == 0) {
+    restarts_.push_back(keys_.Size());
+  } else {
+    size_t limit = std::min(key.size(), last_key_.size());
+    while (shared < limit && key[shared] == last_key_[shared]) {
+      ++shared;
+    }
+  }
+
+  WriteVarint(keys_, shared);
+  WriteVarint(keys_, key.size() - shared);
+  size_t pos = keys_.Size();
+  keys_.Enlarge(key.size() - shared);
+  memcpy(keys_.Data() + pos, key.data() + shared, key.size() - shared);
+
+  last_key_.assign(key);
+  ++key_count_;
+  return 0;
+}
+
+size_t KeyBlockBuilder::EstimatedSize() const {
+  return kBlockHeaderSize + keys_.Size() + restarts_.size() * 4 + 4;
+}
+
+int KeyBlockBuilder::Finish(std::string& output) {
+  Buf buf(EstimatedSize(), le_);
+  buf.WriteInt(kBlockVersion);
+  buf.WriteInt(key_count_);
+
+  size_t pos = buf.Size();
+  buf.Enlarge(keys_.Size());
+  memcpy(buf.Data() + pos, keys_.Data(), keys_.Size());
+
+  for (uint32_t offset : restarts_) {
+    buf.WriteInt(offset);
+  }
+  buf.WriteInt(restarts_.size());
+
+  buf.GetString(output);
+  Reset();
+  return output.size();
+}
+
+void KeyBlockBuilder::Reset() {
+  key_count_ = 0;
+  keys_.Clear();
+  last_key_.clear();
+  restarts_.clear();
+}
+
+KeyBlockReader::KeyBlockReader(int schema_version,
+                               const std::vector<BaseSchemaPtr>& schemas,
+                               long common_id, bool le)
+    : le_(le),
+      schemas_(schemas),
+      decoder_(schema_version, schemas, common_id, le) {}
+
+int KeyBlockReader::Open(std::string_view block) {
+  block_ = std::string_view();
+  key_count_ = 0;
+  key_index_ = 0;
+
+  if (block.size() < kBlockHeaderSize + 4) {
+    return -1;
+  }
+  BufView buf(block, le_);
+  if (buf.ReadInt(0) != kBlockVersion) {
+    return -1;
+  }
+
+  size_t key_count = static_cast<uint32_t>(buf.ReadInt(4));
+  size_t restart_count = static_cast<uint32_t>(buf.ReadInt(block.size() - 4));
+  if (restart_count != (key_count + kRestartInterval - 1) / kRestartInterval ||
+      kBlockHeaderSize + restart_count * 4 + 4 > block.size()) {
+    return -1;
+  }
+
+  block_ = block;
+  key_count_ = key_count;
+  restart_count_ = restart_count;
+  restarts_pos_ = block.size() - 4 - restart_count * 4;
+  keys_end_ = restarts_pos_;
+  SeekToFirst();
+  return 0;
+}
+
+void KeyBlockReader::SeekToFirst() {
+  if (restart_count_ > 0) {
+    SeekToRestart(0);
+  } else {
+    key_index_ = 0;
+  }
+}
+
+void KeyBlockReader::Seek(std::string_view key) {
+  // the last restart below key, the keys before it are all below key too.
+  size_t lo = 0;
+  size_t hi = restart_count_;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (RestartKey(mid) < key) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  SeekToFirst();
+  if (restart_count_ == 0) {
+    return;
+  }
+  SeekToRestart(lo);
+
+  std::string last_key;
+  while (!AtEnd()) {
+    size_t key_pos = key_pos_;
+    last_key = key_;
+    ReadKey();
+    if (std::string_view(key_) >= key) {
+      key_pos_ = key_pos;
+      key_.swap(last_key);
+      return;
+    }
+    ++key_index_;
+  }
+}
+
+bool KeyBlockReader::Next() {
+  if (AtEnd()) {
+    return false;
+  }
+
+  ReadKey();
+  ++key_index_;
+  return true;
+}
+
+bool KeyBlockReader::Next(std::vector<std::any>& record) {
+  if (!Next()) {
+    return false;
+  }
+
+  if (decoder_.DecodeKey(std::string_view(key_), record) != 0) {
+    throw std::runtime_error("Invalid key in key block.");
+  }
+  return true;
+}
+
+int KeyBlockReader::NextBatch(const DecodePlan& plan, size_t max_rows,
+                              ColumnBatch& batch) {
+  if (plan.SchemaCount() != schemas_.size()) {
+    return -1;
+  }
+
+  std::vector<BaseSchema::Type> types(plan.OutputSize(), BaseSchema::kBool);
+  for (size_t i = 0; i < plan.End(); ++i) {
+    int col = plan.Slot(i);
+    // kSkip is below 0.
+    if (schemas_[i] != nullptr && col >= 0 &&
+        static_cast<size_t>(col) < types.size()) {
+      types[col] = schemas_[i]->GetType();
+    }
+  }
+  batch.Reset(types);
+
+  std::vector<bool> decoded(plan.OutputSize(), false);
+  size_t count = std::min(max_rows, key_count_ - std::min(key_index_, key_count_));
+  ColumnBatchSink sink(batch);
+  for (size_t r = 0; r < count; ++r) {
+    ReadKey();
+    BufView key_buf(key_, le_);
+    key_buf.Skip(kKeyColumnsPos);
+    for (size_t i = 0; i < plan.End(); ++i) {
+      const auto& schema = schemas_[i];
+      if (schema == nullptr || !schema->IsKey()) {
+        continue;
+      }
+      int col = plan.Slot(i);
+      if (col == DecodePlan::kSkip) {
+        schema->SkipKey(key_buf);
+      } else {
+        schema->DecodeKey(key_buf, sink, col);
+        decoded[col] = true;
+      }
+    }
+    ++key_index_;
+  }
+
+  // the value columns, and slots not backed by any schema, are all null.
+  for (size_t col = 0; col < decoded.size(); ++col) {
+    if (!decoded[col]) {
+      for (size_t r = 0; r < count; ++r) {
+        batch.Column(col).AppendNull();
+      }
+    }
+  }
+
+  batch.SetNumRows(count);
+  return count;
+}
+
+void KeyBlockReader::ReadKey() {
+  uint64_t shared = 0;
+  uint64_t unshared = 0;
+  size_t end = keys_end_;
+  const char* data = block_.data();
+  int len = ReadVarint(data + key_pos_, end - key_pos_, shared);
+  if (DINGO_UNLIKELY(len == 0)) {
+    throw std::runtime_error("Invalid key in key block.");
+  }
+  key_pos_ += len;
+  len = ReadVarint(data + key_pos_, end - key_pos_, unshared);
+  if (DINGO_UNLIKELY(len == 0 || shared > key_.size() ||
+                     unshared > end - key_pos_ - len)) {
+    throw std::runtime_error("Invalid key in key block.");
+  }
+  key_pos_ += len;
+
+  key_.resize(shared);
+  key_.append(data + key_pos_, unshared);
+  key_pos_ += unshared;
+}
+
+void KeyBlockReader::SeekToRestart(size_t i) {
+  BufView buf(block_, le_);
+  key_pos_ = kBlockHeaderSize +
+             static_cast<uint32_t>(buf.ReadInt(restarts_pos_ + i * 4));
+  if (DINGO_UNLIKELY(key_pos_ > keys_end_)) {
+    throw std::runtime_error("Invalid restart in key block.");
+  }
+  key_.clear();
+  key_index_ = i * kRestartInterval;
+}
+
+std::string_view KeyBlockReader::RestartKey(size_t i) const {
+  BufView buf(block_, le_);
+  size_t pos = kBlockHeaderSize +
+               static_cast<uint32_t>(buf.ReadInt(restarts_pos_ + i * 4));
+
+  size_t end = keys_end_;
+  uint64_t shared = 1;
+  uint64_t unshared = 0;
+  int len = pos < end ? ReadVarint(block_.data() + pos, end - pos, shared) : 0;
+  if (DINGO_UNLIKELY(len == 0 || shared != 0)) {
+    throw std::runtime_error("Invalid key in key block.");
+  }
+  pos += len;
+  len = ReadVarint(block_.data() + pos, end - pos, unshared);
+  if (DINGO_UNLIKELY(len == 0 || unshared > end - pos - len)) {
+    throw std::runtime_error("Invalid key in key block.");
+  }
+  return block_.substr(pos + len, unshared);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,135 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_KEY_BLOCK_V2_H_
+#define DINGO_SERIAL_KEY_BLOCK_V2_H_
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/column_batch.h"
+#include "serial/record/V2/decode_plan.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/buf.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Sorted keys of RecordEncoderV2 front coded in a single block, for sending
+ * the keys of a scan and for sorted runs held in memory:
+ *
+ *   block version(4) | key count(4) |
+ *   keys: {shared(varint) | unshared(varint) | unshared bytes} * keys |
+ *   restarts: {key entry offset(4)} * restart count | restart count(4)
+ *
+ * A key shares its leading bytes with the previous key, the prefix, common id
+ * and leading key columns of a table mostly, except at the restarts taken
+ * every kRestartInterval keys, where it is stored whole so that a reader may
+ * seek to it. Unlike a record block the keys keep their codec version, they
+ * may be any keys of the encoder.
+ */
+class KeyBlockBuilder {
+ public:
+  static constexpr int kBlockVersion = 1;
+  static constexpr size_t kRestartInterval = 16;
+
+  explicit KeyBlockBuilder(bool le);
+
+  // Append a key. Keys must be added in increasing order, returns -1 for a
+  // key not above the previous one.
+  int Add(std::string_view key);
+
+  size_t KeyCount() const { return key_count_; }
+  bool Empty() const { return key_count_ == 0; }
+  // Bytes the block would take if finished now.
+  size_t EstimatedSize() const;
+
+  // Write the block to output and start an empty one, returns its size.
+  int Finish(std::string& output);
+  void Reset();
+
+ private:
+  bool le_;
+  size_t key_count_{0};
+  Buf keys_;
+  std::string last_key_;
+  std::vector<uint32_t> restarts_;
+};
+
+// Streaming reader over a block written by KeyBlockBuilder, the block bytes
+// must outlive the reader. The keys are those of the encoder of schemas
+// when decoded into columns.
+class KeyBlockReader {
+ public:
+  KeyBlockReader(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                 long common_id, bool le);
+
+  // Returns -1 when the block is malformed or of another block version.
+  int Open(std::string_view block);
+
+  size_t KeyCount() const { return key_count_; }
+  // Position of the next key to read.
+  size_t Position() const { return key_index_; }
+  bool AtEnd() const { return key_index_ >= key_count_; }
+
+  void SeekToFirst();
+  // Move before the first key not below key.
+  void Seek(std::string_view key);
+
+  // Read the next key into Key(), false at the end.
+  bool Next();
+  // The same and decode its key columns into record as
+  // RecordDecoderV2::DecodeKey does, throws runtime_error for a key the
+  // decoder rejects.
+  bool Next(std::vector<std::any>& record /*output*/);
+  const std::string& Key() const { return key_; }
+
+  // Read up to max_rows keys into batch with the columns of plan, the value
+  // columns of plan are null. Returns the key count read, -1 when plan was
+  // built for other schemas.
+  int NextBatch(const DecodePlan& plan, size_t max_rows,
+                ColumnBatch& batch /*output*/);
+
+ private:
+  // Restore the next key into key_ and step over its entry.
+  void ReadKey();
+  // Position at restart i.
+  void SeekToRestart(size_t i);
+  std::string_view RestartKey(size_t i) const;
+
+  bool le_;
+  std::vector<BaseSchemaPtr> schemas_;
+  RecordDecoderV2 decoder_;
+
+  std::string_view block_;
+  size_t key_count_{0};
+  size_t keys_end_{0};
+  size_t restart_count_{0};
+  size_t restarts_pos_{0};
+
+  size_t key_index_{0};
+  size_t key_pos_{0};
+  std::string key_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,98 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "key_comparator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// prefix(1 byte) + common id(8 bytes).
+constexpr size_t kKeyPrefixSize = 9;
+
+KeyComparator::KeyComparator(const std::vector<BaseSchemaPtr>& schemas)
+    : KeyComparator(schemas, IsLE()) {}
+
+KeyComparator::KeyComparator(const std::vector<BaseSchemaPtr>& schemas,
+                             bool le)
+    : le_(le), schemas_(schemas) {
+  for (const auto& column : CompileColumnDescriptors(schemas_)) {
+    if (column.schema != nullptr && column.is_key) {
+      key_columns_.push_back(column);
+    }
+  }
+
+  size_t end = kKeyPrefixSize;
+  fixed_ends_.push_back(end);
+  for (const auto& column : key_columns_) {
+    if (column.key_length == 0) {
+      break;
+    }
+    end += column.key_length;
+    fixed_ends_.push_back(end);
+  }
+}
+
+size_t KeyComparator::ColumnsEnd(std::string_view key,
+                                 int column_count) const {
+  size_t count = std::min<size_t>(std::max(column_count, 0),
+                                  key_columns_.size());
+  size_t fixed = std::min(count, fixed_ends_.size() - 1);
+  size_t end = fixed_ends_[fixed];
+  if (DINGO_UNLIKELY(key.size() < end)) {
+    throw std::runtime_error("Out of range.");
+  }
+  if (fixed == count) {
+    return end;
+  }
+
+  BufView key_buf(key, this->le_);
+  key_buf.SetReadOffset(end);
+  for (size_t i = fixed; i < count; ++i) {
+    key_columns_[i].SkipKey(key_buf);
+  }
+  return key_buf.ReadOffset();
+}
+
+std::string_view KeyComparator::Prefix(std::string_view key,
+                                       int column_count) const {
+  return key.substr(0, ColumnsEnd(key, column_count));
+}
+
+std::string_view KeyComparator::Columns(std::string_view key,
+                                        int column_count) const {
+  size_t end = ColumnsEnd(key, column_count);
+  return key.substr(kKeyPrefixSize, end - kKeyPrefixSize);
+}
+
+int KeyComparator::Compare(std::string_view lhs, std::string_view rhs,
+                           int column_count) const {
+  // no column encoding is the start of another, the bytes compare as the
+  // columns in order do.
+  return Prefix(lhs, column_count).compare(Prefix(rhs, column_count));
+}
+
+int KeyComparator::Compare(std::string_view lhs, std::string_view rhs) const {
+  return Compare(lhs, rhs, key_columns_.size());
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_KEY_COMPARATOR_V2_H_
+#define DINGO_SERIAL_KEY_COMPARATOR_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/column_descriptor.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/byte_order.h"
+#include "serial/utils/V2/compiler.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Compares keys written by RecordEncoderV2 on their leading key columns.
+ *
+ * Every key column is written memory comparable and ends where its bytes say
+ * so, the columns are found by skipping them as the decoder does and the
+ * bytes up to a column compare as the columns do, nothing is decoded. Keys of
+ * other schemas, or too short for theirs, throw runtime_error. A version key
+ * of version_key.h compares as its key, the ts suffix is not read.
+ */
+class KeyComparator {
+ public:
+  explicit KeyComparator(const std::vector<BaseSchemaPtr>& schemas);
+  KeyComparator(const std::vector<BaseSchemaPtr>& schemas, bool le);
+
+  int KeyColumnCount() const { return key_columns_.size(); }
+
+  // key up to the end of its first column_count key columns, from the
+  // prefix on, the key EncodeKeyPrefix gives for them.
+  std::string_view Prefix(std::string_view key, int column_count) const;
+  // the first column_count key columns alone, without prefix and common id.
+  std::string_view Columns(std::string_view key, int column_count) const;
+
+  // Order of lhs and rhs by prefix, common id and their first column_count
+  // key columns, < 0, 0 or > 0.
+  int Compare(std::string_view lhs, std::string_view rhs,
+              int column_count) const;
+  // by all key columns, the codec version is left out.
+  int Compare(std::string_view lhs, std::string_view rhs) const;
+
+  // The 8 key bytes at offset as a big endian integer, zero padded when the
+  // key ends before. Of two keys of one table the one of the smaller
+  // normalized prefix is the smaller, only equal prefixes need the bytes
+  // compared, so sort and merge loops compare integers first. The default
+  // offset is behind prefix and common id, kNormalizedPrefixOffset + 8 gives
+  // the next 8 bytes for a 16 bytes prefix.
+  static constexpr size_t kNormalizedPrefixOffset = 9;
+  uint64_t NormalizedPrefix(std::string_view key,
+                            size_t offset = kNormalizedPrefixOffset) const {
+    uint64_t word = 0;
+    if (DINGO_LIKELY(key.size() >= offset + sizeof(word))) {
+      memcpy(&word, key.data() + offset, sizeof(word));
+    } else if (key.size() > offset) {
+      memcpy(&word, key.data() + offset, key.size() - offset);
+    }
+    return le_ ? ByteOrder<true>::Convert(word) : word;
+  }
+
+ private:
+  size_t ColumnsEnd(std::string_view key, int column_count) const;
+
+  bool le_;
+  std::vector<BaseSchemaPtr> schemas_;
+  std::vector<ColumnDescriptor> key_columns_;
+  // end of the first i key columns, for as long as they are of fixed length.
+  std::vector<size_t> fixed_ends_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
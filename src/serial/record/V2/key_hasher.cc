@@ -0,0 +1,107 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "key_hasher.h"
+
+#include <stdexcept>
+
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/hash.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// prefix(1 byte) + common id(8 bytes).
+constexpr size_t kKeyPrefixSize = 9;
+
+KeyHasher::KeyHasher(const std::vector<BaseSchemaPtr>& schemas,
+                     const std::vector<int>& columns, uint64_t seed)
+    : schemas_(schemas), seed_(seed) {
+  auto descriptors = CompileColumnDescriptors(schemas_);
+  std::vector<bool> chosen(descriptors.size(), false);
+  for (int column : columns) {
+    if (column < 0 || static_cast<size_t>(column) >= descriptors.size() ||
+        descriptors[column].schema == nullptr || !descriptors[column].is_key) {
+      throw std::runtime_error("Hashed column is no key column.");
+    }
+    chosen[column] = true;
+  }
+
+  for (size_t i = 0; i < descriptors.size(); ++i) {
+    if (descriptors[i].schema != nullptr && descriptors[i].is_key) {
+      key_columns_.push_back(descriptors[i]);
+      hashed_.push_back(chosen[i]);
+    }
+  }
+  while (!hashed_.empty() && !hashed_.back()) {
+    hashed_.pop_back();
+  }
+
+  size_t end = kKeyPrefixSize;
+  for (size_t i = 0; fixed_ && i < hashed_.size(); ++i) {
+    const auto& column = key_columns_[i];
+    if (column.key_length == 0) {
+      fixed_ = false;
+      break;
+    }
+    if (hashed_[i]) {
+      fixed_ranges_.emplace_back(end, end + column.key_length);
+    }
+    end += column.key_length;
+  }
+}
+
+uint64_t KeyHasher::Hash(std::string_view key) const {
+  uint64_t hash = seed_;
+  if (fixed_) {
+    if (DINGO_UNLIKELY(!fixed_ranges_.empty() &&
+                       key.size() < fixed_ranges_.back().second)) {
+      throw std::runtime_error("Out of range.");
+    }
+    for (const auto& [begin, end] : fixed_ranges_) {
+      hash = Hash64(key.data() + begin, end - begin, hash);
+    }
+    return hash;
+  }
+
+  // the bytes of a key column do not depend on the byte order flag.
+  BufView key_buf(key, true);
+  key_buf.SetReadOffset(kKeyPrefixSize);
+  for (size_t i = 0; i < hashed_.size(); ++i) {
+    size_t begin = key_buf.ReadOffset();
+    key_columns_[i].SkipKey(key_buf);
+    if (hashed_[i]) {
+      hash = Hash64(key.data() + begin, key_buf.ReadOffset() - begin, hash);
+    }
+  }
+  return hash;
+}
+
+void KeyHasher::HashBatch(const std::string_view* keys, size_t count,
+                          uint64_t* hashes) const {
+  for (size_t i = 0; i < count; ++i) {
+    hashes[i] = Hash(keys[i]);
+  }
+}
+
+void KeyHasher::HashBatch(const KeyValue* key_values, size_t count,
+                          uint64_t* hashes) const {
+  for (size_t i = 0; i < count; ++i) {
+    hashes[i] = Hash(key_values[i].GetKey());
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
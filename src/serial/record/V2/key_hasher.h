@@ -0,0 +1,71 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_KEY_HASHER_V2_H_
+#define DINGO_SERIAL_KEY_HASHER_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "serial/record/V2/column_descriptor.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/keyvalue.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Hashes chosen key columns of keys written by RecordEncoderV2 on their
+ * encoded bytes, for hash partitioning and hash joins, nothing is decoded.
+ *
+ * The hash chains Hash64 over the bytes of each chosen column in key order,
+ * so it only depends on them: keys of other tables agree when the chosen
+ * columns have the same types, nullability and values. Keys too short for
+ * the schemas throw runtime_error.
+ */
+class KeyHasher {
+ public:
+  // columns are positions in schemas, as in a record, of key columns.
+  // Throws runtime_error for other columns.
+  KeyHasher(const std::vector<BaseSchemaPtr>& schemas,
+            const std::vector<int>& columns, uint64_t seed = 0);
+
+  uint64_t Hash(std::string_view key) const;
+
+  // hashes[i] is the hash of the i-th key.
+  void HashBatch(const std::string_view* keys, size_t count,
+                 uint64_t* hashes /*output*/) const;
+  void HashBatch(const KeyValue* key_values, size_t count,
+                 uint64_t* hashes /*output*/) const;
+
+ private:
+  std::vector<BaseSchemaPtr> schemas_;
+  std::vector<ColumnDescriptor> key_columns_;
+  // per key column whether it is hashed, the ones after the last are unread.
+  std::vector<bool> hashed_;
+  uint64_t seed_;
+
+  // with every key column up to the last hashed one of fixed length, the
+  // [begin, end) of the hashed ones, the same in every key.
+  bool fixed_{true};
+  std::vector<std::pair<size_t, size_t>> fixed_ranges_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
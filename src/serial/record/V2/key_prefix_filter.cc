@@ -0,0 +1,85 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "key_prefix_filter.h"
+
+#include <stdexcept>
+
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/hash.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// prefix(1 byte) + common id(8 bytes).
+constexpr size_t kKeyPrefixSize = 9;
+
+static int CheckColumnCount(const KeyComparator& comparator,
+                            int column_count) {
+  if (column_count < 1 || column_count > comparator.KeyColumnCount()) {
+    throw std::runtime_error("Filter column count out of the key columns.");
+  }
+  return column_count;
+}
+
+static inline uint64_t HashColumns(std::string_view columns) {
+  return Hash64(columns.data(), columns.size());
+}
+
+KeyPrefixFilterBuilder::KeyPrefixFilterBuilder(
+    const std::vector<BaseSchemaPtr>& schemas, int column_count,
+    size_t key_count, int bits_per_key)
+    : comparator_(schemas),
+      column_count_(CheckColumnCount(comparator_, column_count)),
+      filter_(key_count, bits_per_key) {}
+
+void KeyPrefixFilterBuilder::AddKey(std::string_view key) {
+  std::string_view columns = comparator_.Columns(key, column_count_);
+  if (has_last_ && columns == last_columns_) {
+    return;
+  }
+  filter_.Add(HashColumns(columns));
+  last_columns_.assign(columns.data(), columns.size());
+  has_last_ = true;
+}
+
+void KeyPrefixFilterBuilder::AddKeys(const KeyValue* key_values,
+                                     size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    AddKey(key_values[i].GetKey());
+  }
+}
+
+KeyPrefixFilter::KeyPrefixFilter(const std::vector<BaseSchemaPtr>& schemas,
+                                 int column_count, std::string_view data)
+    : comparator_(schemas),
+      column_count_(CheckColumnCount(comparator_, column_count)),
+      data_(data) {}
+
+bool KeyPrefixFilter::MayContainKey(std::string_view key) const {
+  return BlockedBloomFilter::MayContain(
+      data_, HashColumns(comparator_.Columns(key, column_count_)));
+}
+
+bool KeyPrefixFilter::MayContainPrefix(std::string_view prefix) const {
+  if (DINGO_UNLIKELY(prefix.size() < kKeyPrefixSize)) {
+    throw std::runtime_error("Out of range.");
+  }
+  return BlockedBloomFilter::MayContain(
+      data_, HashColumns(prefix.substr(kKeyPrefixSize)));
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,87 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DINGO_SERIAL_KEY_PREFIX_FILTER_V2_H_
+#define DINGO_SERIAL_KEY_PREFIX_FILTER_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/key_comparator.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/bloom_filter.h"
+#include "serial/utils/V2/keyvalue.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Bloom filters over the first column_count key columns of the keys of a
+ * file, written by RecordEncoderV2::EncodeKey, so that a lookup by these
+ * columns skips the files that can not hold them. The bytes of the columns
+ * are hashed as they are, nothing is decoded, prefix and common id are left
+ * out.
+ *
+ * column_count is from 1 to the key column count, others throw
+ * runtime_error, as do keys too short for the schemas.
+ */
+class KeyPrefixFilterBuilder {
+ public:
+  // key_count is the expected number of distinct prefixes, the filter is
+  // sized for it.
+  KeyPrefixFilterBuilder(const std::vector<BaseSchemaPtr>& schemas,
+                         int column_count, size_t key_count,
+                         int bits_per_key = 10);
+
+  void AddKey(std::string_view key);
+  void AddKeys(const KeyValue* key_values, size_t count);
+
+  // The filter bytes, to be stored along with the file.
+  const std::string& Data() const { return filter_.Data(); }
+
+ private:
+  KeyComparator comparator_;
+  int column_count_;
+  BlockedBloomFilter filter_;
+  // sorted keys repeat their prefix, it is hashed once.
+  std::string last_columns_;
+  bool has_last_{false};
+};
+
+class KeyPrefixFilter {
+ public:
+  // data is the filter of a builder over the same schemas and column_count,
+  // it is not copied and has to outlive the filter.
+  KeyPrefixFilter(const std::vector<BaseSchemaPtr>& schemas, int column_count,
+                  std::string_view data);
+
+  // By the first column_count key columns of key.
+  bool MayContainKey(std::string_view key) const;
+  // prefix is what EncodeKeyPrefix gives for column_count key columns.
+  bool MayContainPrefix(std::string_view prefix) const;
+
+ private:
+  KeyComparator comparator_;
+  int column_count_;
+  std::string_view data_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
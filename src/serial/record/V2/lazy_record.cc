@@ -0,0 +1,108 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lazy_record.h"
+
+#include <stdexcept>
+
+#include "serial/record/V2/record_decoder.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+void LazyRecordV2::Reset(const RecordDecoderV2* decoder, BufView key_buf,
+                         BufView value_buf, const ValueHeader& value_header) {
+  size_t size = decoder->columns_.size();
+
+  decoder_ = decoder;
+  key_buf_ = key_buf;
+  value_buf_ = value_buf;
+  value_header_ = value_header;
+
+  values_.assign(size, std::any());
+  decoded_.assign(size, 0);
+  key_offsets_.assign(size, -1);
+  key_scan_column_ = 0;
+  key_scan_offset_ = key_buf_.ReadOffset();
+}
+
+int LazyRecordV2::KeyOffset(int column) {
+  const auto& columns = decoder_->columns_;
+  while (key_scan_column_ <= column) {
+    const auto& scan = columns[key_scan_column_];
+    if (scan.schema != nullptr && scan.is_key) {
+      key_offsets_[key_scan_column_] = key_scan_offset_;
+      if (key_scan_column_ < column) {
+        key_buf_.SetReadOffset(key_scan_offset_);
+        scan.SkipKey(key_buf_);
+        key_scan_offset_ = key_buf_.ReadOffset();
+      }
+    }
+    if (key_scan_column_ == column) {
+      break;
+    }
+    ++key_scan_column_;
+  }
+
+  return key_offsets_[column];
+}
+
+int LazyRecordV2::ValueOffset(int column) {
+  if (value_buf_.IsEnd()) {
+    return -1;
+  }
+  return decoder_->ValueOffset(decoder_->columns_[column], value_buf_,
+                               value_header_);
+}
+
+bool LazyRecordV2::IsNull(int column) {
+  if (decoded_.at(column)) {
+    return !values_[column].has_value();
+  }
+
+  const auto& col = decoder_->columns_[column];
+  if (col.schema == nullptr) {
+    return true;
+  }
+  // a value column is null exactly when it has no offset.
+  if (!col.is_key) {
+    return ValueOffset(column) == -1;
+  }
+
+  return !Get(column).has_value();
+}
+
+const std::any& LazyRecordV2::Get(int column) {
+  if (decoder_ == nullptr) {
+    throw std::runtime_error("Lazy record is not decoded.");
+  }
+  if (decoded_.at(column)) {
+    return values_[column];
+  }
+
+  const auto& col = decoder_->columns_[column];
+  if (col.schema != nullptr) {
+    if (col.is_key) {
+      key_buf_.SetReadOffset(KeyOffset(column));
+    }
+    col.decode(col, key_buf_, value_buf_, values_, column, false,
+               value_header_);
+  }
+
+  decoded_[column] = 1;
+  return values_[column];
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
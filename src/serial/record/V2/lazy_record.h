@@ -0,0 +1,89 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_LAZY_RECORD_V2_H_
+#define DINGO_SERIAL_LAZY_RECORD_V2_H_
+
+#include <any>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "serial/record/V2/value_header.h"
+#include "serial/utils/V2/buf_view.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+class RecordDecoderV2;
+
+/*
+ * A row whose columns are decoded on demand.
+ *
+ * RecordDecoderV2::DecodeLazy checks the key prefix, codec version and schema
+ * version and parses the value header once, Get/IsNull then decode only the
+ * requested column through the offset table and keep the result for the next
+ * call. column is the position in the decoder's schemas.
+ *
+ * The record reads the key and value bytes in place, they and the decoder
+ * must outlive it.
+ */
+class LazyRecordV2 {
+ public:
+  LazyRecordV2() = default;
+  ~LazyRecordV2() = default;
+
+  size_t Size() const { return values_.size(); }
+
+  bool IsNull(int column);
+
+  const std::any& Get(int column);
+
+  // throws std::bad_any_cast when the column is null or of another type.
+  template <typename T>
+  T Get(int column) {
+    return std::any_cast<T>(Get(column));
+  }
+
+ private:
+  friend class RecordDecoderV2;
+
+  void Reset(const RecordDecoderV2* decoder, BufView key_buf,
+             BufView value_buf, const ValueHeader& value_header);
+
+  // Start of a key column, key columns in front of it are skipped once.
+  int KeyOffset(int column);
+  int ValueOffset(int column);
+
+  const RecordDecoderV2* decoder_{nullptr};
+  BufView key_buf_;
+  BufView value_buf_;
+  // the decompressed value when the row is compressed.
+  std::string scratch_;
+  ValueHeader value_header_;
+
+  std::vector<std::any> values_;
+  std::vector<uint8_t> decoded_;
+
+  // start of every key column found so far, -1 when not yet known.
+  std::vector<int> key_offsets_;
+  // next column to scan for key offsets and where it starts.
+  int key_scan_column_{0};
+  int key_scan_offset_{0};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
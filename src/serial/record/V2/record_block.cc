@@ -0,0 +1,467 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "record_block.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "serial/utils/V2/bit_pack.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/varint.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+constexpr size_t kBlockHeaderSize = 20;
+constexpr size_t kCodecSuffixSize = 4;
+// prefix(1) | common_id(8)
+constexpr size_t kKeyColumnsPos = 9;
+constexpr int kBlockVersion = RecordBlockBuilder::kBlockVersion;
+constexpr size_t kRestartInterval = RecordBlockBuilder::kRestartInterval;
+
+RecordBlockBuilder::RecordBlockBuilder(
+    int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+    long common_id, bool le)
+    : le_(le),
+      schema_version_(schema_version),
+      schemas_(schemas),
+      encoder_(schema_version, schemas, common_id, le),
+      keys_(0, le) {
+  for (const auto& schema : schemas_) {
+    if (schema != nullptr && !schema->IsKey()) {
+      value_columns_.push_back(
+          ValueColumn{schema.get(), schema->GetIndex(), {}, Buf(0, le)});
+    }
+  }
+}
+
+int RecordBlockBuilder::Add(char prefix, const std::vector<std::any>& record) {
+  encoder_.EncodeKey(prefix, record, key_);
+  if (DINGO_UNLIKELY(key_.size() < kCodecSuffixSize)) {
+    return -1;
+  }
+
+  std::string_view suffix(key_.data() + key_.size() - kCodecSuffixSize,
+                          kCodecSuffixSize);
+  if (row_count_ > 0 && suffix != key_suffix_) {
+    return -1;
+  }
+  std::string_view key(key_.data(), key_.size() - kCodecSuffixSize);
+  if (row_count_ > 0 && key <= std::string_view(last_key_)) {
+    return -1;
+  }
+
+  // Encode the values first, a throwing column leaves the block unchanged.
+  std::vector<size_t> sizes;
+  sizes.reserve(value_columns_.size());
+  for (auto& column : value_columns_) {
+    sizes.push_back(column.data.Size());
+  }
+  try {
+    for (auto& column : value_columns_) {
+      const auto& value = record.at(column.index);
+      if (column.schema->isNull(value)) {
+        column.nulls.push_back(true);
+      } else {
+        column.schema->EncodeValue(value, column.data);
+        column.nulls.push_back(false);
+      }
+    }
+  } catch (...) {
+    for (size_t i = 0; i < value_columns_.size(); ++i) {
+      auto& column = value_columns_[i];
+      column.data.ReSize(sizes[i]);
+      column.nulls.resize(row_count_);
+    }
+    throw;
+  }
+
+  size_t shared = 0;
+  if (row_count_ % kRestartInterval == 0) {
+    restarts_.push_back(keys_.Size());
+    for (size_t size : sizes) {
+      restarts_.push_back(size);
+    }
+  } else {
+    size_t limit = std::min(key.size(), last_key_.size());
+    while (shared < limit && key[shared] == last_key_[shared]) {
+      ++shared;
+    }
+  }
+
+  WriteVarint(keys_, shared);
+  WriteVarint(keys_, key.size() - shared);
+  size_t pos = keys_.Size();
+  keys_.Enlarge(key.size() - shared);
+  memcpy(keys_.Data() + pos, key.data() + shared, key.size() - shared);
+
+  if (row_count_ == 0) {
+    key_suffix_.assign(suffix);
+  }
+  last_key_.assign(key);
+  ++row_count_;
+  return 0;
+}
+
+size_t RecordBlockBuilder::EstimatedSize() const {
+  size_t size = kBlockHeaderSize + keys_.Size();
+  for (const auto& column : value_columns_) {
+    size += PackedBitsSize(row_count_) + column.data.Size() + 4;
+  }
+  return size + 4 + restarts_.size() * 4 + 4;
+}
+
+int RecordBlockBuilder::Finish(std::string& output) {
+  Buf buf(EstimatedSize(), le_);
+  buf.WriteInt(kBlockVersion);
+  buf.WriteInt(schema_version_);
+  buf.WriteInt(row_count_);
+  buf.WriteInt(value_columns_.size());
+  if (key_suffix_.empty()) {
+    // an empty block, any suffix will do.
+    key_suffix_.assign(kCodecSuffixSize, '\0');
+  }
+  buf.WriteString(key_suffix_);
+
+  size_t pos = buf.Size();
+  buf.Enlarge(keys_.Size());
+  memcpy(buf.Data() + pos, keys_.Data(), keys_.Size());
+
+  std::vector<uint32_t> section_offsets;
+  section_offsets.reserve(value_columns_.size());
+  size_t bitmap_size = PackedBitsSize(row_count_);
+  for (auto& column : value_columns_) {
+    section_offsets.push_back(buf.Size());
+    pos = buf.Size();
+    buf.Enlarge(bitmap_size + column.data.Size());
+    PackBools(column.nulls, reinterpret_cast<uint8_t*>(buf.Data() + pos));
+    memcpy(buf.Data() + pos + bitmap_size, column.data.Data(),
+           column.data.Size());
+  }
+
+  size_t index_offset = buf.Size();
+  for (uint32_t offset : section_offsets) {
+    buf.WriteInt(offset);
+  }
+  buf.WriteInt(restarts_.size() / (1 + value_columns_.size()));
+  for (uint32_t value : restarts_) {
+    buf.WriteInt(value);
+  }
+  buf.WriteInt(index_offset);
+
+  buf.GetString(output);
+  Reset();
+  return output.size();
+}
+
+void RecordBlockBuilder::Reset() {
+  row_count_ = 0;
+  keys_.Clear();
+  last_key_.clear();
+  key_suffix_.clear();
+  restarts_.clear();
+  for (auto& column : value_columns_) {
+    column.nulls.clear();
+    column.data.Clear();
+  }
+}
+
+RecordBlockReader::RecordBlockReader(
+    int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+    long common_id, bool le)
+    : le_(le),
+      schema_version_(schema_version),
+      schemas_(schemas),
+      decoder_(schema_version, schemas, common_id, le) {
+  for (size_t i = 0; i < schemas_.size(); ++i) {
+    if (schemas_[i] != nullptr && !schemas_[i]->IsKey()) {
+      value_schema_positions_.push_back(i);
+      value_columns_.push_back(ValueColumn{schemas_[i].get(), 0, 0, 0});
+    }
+  }
+}
+
+int RecordBlockReader::Open(std::string_view block) {
+  block_ = std::string_view();
+  row_count_ = 0;
+  row_ = 0;
+
+  size_t column_count = value_columns_.size();
+  if (block.size() < kBlockHeaderSize + 8) {
+    return -1;
+  }
+  BufView buf(block, le_);
+  if (buf.ReadInt(0) != kBlockVersion || buf.ReadInt(4) > schema_version_ ||
+      static_cast<size_t>(buf.ReadInt(12)) != column_count) {
+    return -1;
+  }
+
+  size_t row_count = static_cast<uint32_t>(buf.ReadInt(8));
+  size_t index_offset = static_cast<uint32_t>(buf.ReadInt(block.size() - 4));
+  if (index_offset < kBlockHeaderSize ||
+      index_offset + column_count * 4 + 8 > block.size()) {
+    return -1;
+  }
+  size_t restart_count =
+      static_cast<uint32_t>(buf.ReadInt(index_offset + column_count * 4));
+  size_t restarts_pos = index_offset + column_count * 4 + 4;
+  if (restart_count != (row_count + kRestartInterval - 1) / kRestartInterval ||
+      restarts_pos + restart_count * (1 + column_count) * 4 + 4 !=
+          block.size()) {
+    return -1;
+  }
+
+  size_t bitmap_size = PackedBitsSize(row_count);
+  size_t end = index_offset;
+  for (size_t i = column_count; i-- > 0;) {
+    size_t offset = static_cast<uint32_t>(buf.ReadInt(index_offset + i * 4));
+    if (offset < kBlockHeaderSize || offset + bitmap_size > end) {
+      return -1;
+    }
+    value_columns_[i].bitmap_pos = offset;
+    value_columns_[i].data_pos = offset + bitmap_size;
+    end = offset;
+  }
+
+  block_ = block;
+  row_count_ = row_count;
+  key_suffix_.assign(block.data() + 16, kCodecSuffixSize);
+  keys_pos_ = kBlockHeaderSize;
+  keys_end_ = end;
+  restart_count_ = restart_count;
+  restarts_pos_ = restarts_pos;
+  SeekToFirst();
+  return 0;
+}
+
+void RecordBlockReader::SeekToFirst() {
+  if (restart_count_ > 0) {
+    SeekToRestart(0);
+  } else {
+    row_ = 0;
+  }
+}
+
+void RecordBlockReader::Seek(std::string_view key) {
+  // the last restart below key, the rows before it are all below key too.
+  size_t lo = 0;
+  size_t hi = restart_count_;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    std::string restart_key(RestartKey(mid));
+    restart_key.append(key_suffix_);
+    if (restart_key < key) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  SeekToFirst();
+  if (restart_count_ == 0) {
+    return;
+  }
+  SeekToRestart(lo);
+
+  std::string last_key;
+  while (!AtEnd()) {
+    size_t key_pos = key_pos_;
+    last_key = key_;
+    ReadKey();
+    if (std::string_view(key_) >= key) {
+      key_pos_ = key_pos;
+      key_.swap(last_key);
+      return;
+    }
+    for (auto& column : value_columns_) {
+      NextValueOffset(column);
+    }
+    ++row_;
+  }
+}
+
+bool RecordBlockReader::Next(std::vector<std::any>& record) {
+  if (AtEnd()) {
+    return false;
+  }
+
+  ReadKey();
+  if (decoder_.DecodeKey(std::string_view(key_), record) != 0) {
+    throw std::runtime_error("Invalid key in record block.");
+  }
+
+  BufView buf(block_, le_);
+  for (auto& column : value_columns_) {
+    int offset = NextValueOffset(column);
+    if (offset < 0) {
+      record.at(column.schema->GetIndex()) = std::any();
+    } else {
+      record.at(column.schema->GetIndex()) =
+          column.schema->DecodeValue(buf, offset);
+    }
+  }
+
+  ++row_;
+  return true;
+}
+
+int RecordBlockReader::NextBatch(const DecodePlan& plan, size_t max_rows,
+                                 ColumnBatch& batch) {
+  if (plan.SchemaCount() != schemas_.size()) {
+    return -1;
+  }
+
+  std::vector<BaseSchema::Type> types(plan.OutputSize(), BaseSchema::kBool);
+  std::vector<bool> assigned(plan.OutputSize(), false);
+  for (size_t i = 0; i < plan.End(); ++i) {
+    int col = plan.Slot(i);
+    if (schemas_[i] != nullptr && col >= 0 &&
+        static_cast<size_t>(col) < types.size()) {
+      types[col] = schemas_[i]->GetType();
+      assigned[col] = true;
+    }
+  }
+  batch.Reset(types);
+
+  size_t count = std::min(max_rows, row_count_ - std::min(row_, row_count_));
+  ColumnBatchSink sink(batch);
+  BufView buf(block_, le_);
+  for (size_t r = 0; r < count; ++r) {
+    ReadKey();
+    BufView key_buf(key_, le_);
+    key_buf.Skip(kKeyColumnsPos);
+    for (size_t i = 0; i < plan.End(); ++i) {
+      const auto& schema = schemas_[i];
+      if (schema == nullptr || !schema->IsKey()) {
+        continue;
+      }
+      int col = plan.Slot(i);
+      if (col == DecodePlan::kSkip) {
+        schema->SkipKey(key_buf);
+      } else {
+        schema->DecodeKey(key_buf, sink, col);
+      }
+    }
+
+    for (size_t j = 0; j < value_columns_.size(); ++j) {
+      auto& column = value_columns_[j];
+      int offset = NextValueOffset(column);
+      int col = plan.Slot(value_schema_positions_[j]);
+      if (col == DecodePlan::kSkip) {
+        continue;
+      }
+      if (offset < 0) {
+        sink.OnNull(col);
+      } else {
+        column.schema->DecodeValue(buf, offset, sink, col);
+      }
+    }
+    ++row_;
+  }
+
+  // slots not backed by any schema are all null.
+  for (size_t col = 0; col < assigned.size(); ++col) {
+    if (!assigned[col]) {
+      for (size_t r = 0; r < count; ++r) {
+        batch.Column(col).AppendNull();
+      }
+    }
+  }
+
+  batch.SetNumRows(count);
+  return count;
+}
+
+void RecordBlockReader::ReadKey() {
+  uint64_t shared = 0;
+  uint64_t unshared = 0;
+  size_t end = keys_end_;
+  const char* data = block_.data();
+  int len = ReadVarint(data + key_pos_, end - key_pos_, shared);
+  if (DINGO_UNLIKELY(len == 0)) {
+    throw std::runtime_error("Invalid key in record block.");
+  }
+  key_pos_ += len;
+  len = ReadVarint(data + key_pos_, end - key_pos_, unshared);
+  size_t prefix_size =
+      key_.size() >= kCodecSuffixSize ? key_.size() - kCodecSuffixSize : 0;
+  if (DINGO_UNLIKELY(len == 0 || shared > prefix_size ||
+                     unshared > end - key_pos_ - len)) {
+    throw std::runtime_error("Invalid key in record block.");
+  }
+  key_pos_ += len;
+
+  key_.resize(shared);
+  key_.append(data + key_pos_, unshared);
+  key_.append(key_suffix_);
+  key_pos_ += unshared;
+}
+
+void RecordBlockReader::SeekToRestart(size_t i) {
+  BufView buf(block_, le_);
+  size_t pos = restarts_pos_ + i * (1 + value_columns_.size()) * 4;
+  key_pos_ = keys_pos_ + static_cast<uint32_t>(buf.ReadInt(pos));
+  if (DINGO_UNLIKELY(key_pos_ > keys_end_)) {
+    throw std::runtime_error("Invalid restart in record block.");
+  }
+  for (auto& column : value_columns_) {
+    pos += 4;
+    column.cursor = column.data_pos + static_cast<uint32_t>(buf.ReadInt(pos));
+  }
+  key_.clear();
+  row_ = i * kRestartInterval;
+}
+
+bool RecordBlockReader::IsNullValue(const ValueColumn& column) const {
+  auto byte = static_cast<uint8_t>(block_[column.bitmap_pos + row_ / 8]);
+  return (byte >> (row_ % 8)) & 1;
+}
+
+int RecordBlockReader::NextValueOffset(ValueColumn& column) {
+  if (IsNullValue(column)) {
+    return -1;
+  }
+
+  BufView buf(block_, le_);
+  int offset = column.cursor;
+  buf.SetReadOffset(offset);
+  column.cursor += column.schema->SkipValue(buf);
+  return offset;
+}
+
+std::string_view RecordBlockReader::RestartKey(size_t i) const {
+  BufView buf(block_, le_);
+  size_t pos = restarts_pos_ + i * (1 + value_columns_.size()) * 4;
+  pos = keys_pos_ + static_cast<uint32_t>(buf.ReadInt(pos));
+
+  size_t end = keys_end_;
+  uint64_t shared = 1;
+  uint64_t unshared = 0;
+  int len = pos < end ? ReadVarint(block_.data() + pos, end - pos, shared) : 0;
+  if (DINGO_UNLIKELY(len == 0 || shared != 0)) {
+    throw std::runtime_error("Invalid key in record block.");
+  }
+  pos += len;
+  len = ReadVarint(block_.data() + pos, end - pos, unshared);
+  if (DINGO_UNLIKELY(len == 0 || unshared > end - pos - len)) {
+    throw std::runtime_error("Invalid key in record block.");
+  }
+  return block_.substr(pos + len, unshared);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,171 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_RECORD_BLOCK_V2_H_
+#define DINGO_SERIAL_RECORD_BLOCK_V2_H_
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/column_batch.h"
+#include "serial/record/V2/decode_plan.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/buf.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Many rows of one schema in a single block, for bulk load:
+ *
+ *   block version(4) | schema version(4) | row count(4) |
+ *   value column count(4) | key suffix(4) |
+ *   keys: {shared(varint) | unshared(varint) | unshared bytes} * rows |
+ *   value sections, one per value column in schema order:
+ *     null bitmap((rows + 7) / 8) | the not null values as EncodeValue wrote
+ *     them |
+ *   index: {value section offset(4)} * value column count |
+ *     restart count(4) | {key entry offset(4) |
+ *     value cursor(4) * value column count} * restart count |
+ *   index offset(4)
+ *
+ * Keys are stored without their codec version suffix, which every key of a
+ * block shares, and share their prefix with the previous key except at the
+ * restarts, taken every kRestartInterval rows. A restart also records where
+ * its row starts in every value section, so a reader may seek to it.
+ */
+class RecordBlockBuilder {
+ public:
+  static constexpr int kBlockVersion = 1;
+  static constexpr size_t kRestartInterval = 16;
+
+  RecordBlockBuilder(int schema_version,
+                     const std::vector<BaseSchemaPtr>& schemas, long common_id,
+                     bool le);
+
+  // Append a row. Keys must be added in increasing order, returns -1 for a
+  // key not above the previous one.
+  int Add(char prefix, const std::vector<std::any>& record);
+
+  size_t RowCount() const { return row_count_; }
+  bool Empty() const { return row_count_ == 0; }
+  // Bytes the block would take if finished now.
+  size_t EstimatedSize() const;
+
+  // Write the block to output and start an empty one, returns its size.
+  int Finish(std::string& output);
+  void Reset();
+
+ private:
+  struct ValueColumn {
+    BaseSchema* schema;
+    int index;
+    std::vector<bool> nulls;
+    Buf data;
+  };
+
+  bool le_;
+  int schema_version_;
+  std::vector<BaseSchemaPtr> schemas_;
+  RecordEncoderV2 encoder_;
+  std::vector<ValueColumn> value_columns_;
+
+  size_t row_count_{0};
+  Buf keys_;
+  std::string key_;
+  std::string last_key_;
+  std::string key_suffix_;
+  // per restart, the key entry offset then the value cursors.
+  std::vector<uint32_t> restarts_;
+};
+
+// Streaming reader over a block written by RecordBlockBuilder, the block bytes
+// must outlive the reader.
+class RecordBlockReader {
+ public:
+  RecordBlockReader(int schema_version,
+                    const std::vector<BaseSchemaPtr>& schemas, long common_id,
+                    bool le);
+
+  // Returns -1 when the block is malformed, newer than our schema version or
+  // written with other value columns.
+  int Open(std::string_view block);
+
+  size_t RowCount() const { return row_count_; }
+  // Position of the next row to read.
+  size_t Position() const { return row_; }
+  bool AtEnd() const { return row_ >= row_count_; }
+
+  void SeekToFirst();
+  // Move before the first row whose key is not below key.
+  void Seek(std::string_view key);
+
+  // Read the next row, false at the end. record is laid out as in
+  // RecordDecoderV2::Decode, Key() gives the full key of the row.
+  bool Next(std::vector<std::any>& record /*output*/);
+  const std::string& Key() const { return key_; }
+
+  // Read up to max_rows rows into batch with the columns of plan, returns the
+  // row count read, -1 when plan was built for other schemas.
+  int NextBatch(const DecodePlan& plan, size_t max_rows,
+                ColumnBatch& batch /*output*/);
+
+ private:
+  struct ValueColumn {
+    BaseSchema* schema;
+    size_t bitmap_pos;
+    size_t data_pos;
+    size_t cursor;
+  };
+
+  // Restore the key of the current row into key_ and step over its entry.
+  void ReadKey();
+  // Position at restart i.
+  void SeekToRestart(size_t i);
+  bool IsNullValue(const ValueColumn& column) const;
+  // Offset of the current row's value in the column, -1 for null, the cursor
+  // steps over it.
+  int NextValueOffset(ValueColumn& column);
+  std::string_view RestartKey(size_t i) const;
+
+  bool le_;
+  int schema_version_;
+  std::vector<BaseSchemaPtr> schemas_;
+  RecordDecoderV2 decoder_;
+  std::vector<int> value_schema_positions_;
+
+  std::string_view block_;
+  size_t row_count_{0};
+  std::string key_suffix_;
+  size_t keys_pos_{0};
+  size_t keys_end_{0};
+  size_t restart_count_{0};
+  size_t restarts_pos_{0};
+  std::vector<ValueColumn> value_columns_;
+
+  size_t row_{0};
+  size_t key_pos_{0};
+  std::string key_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -15,13 +15,21 @@
 #include "record_decoder.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <map>
 #include <memory>
+#include <limits>
 #include <utility>
+#include <variant>
 #include <vector>
+#include <type_traits>
 #include <unordered_map>
 
+#include "serial/utils/V2/byte_order.h"
+#include "serial/utils/V2/byte_swap.h"
+#include "serial/utils/V2/probes.h"
 #include "serial/utils/V2/utils.h"
 #include "serial/record/V2/value_header.h"
 
@@ -31,49 +39,113 @@ namespace serialV2 {
 // The worker buffer capacity.
 constexpr int kBufInitCapacity = 2048;
 
-using CastAndDecodeOrSkipFuncPointer =
-    void (*)(BaseSchemaPtr schema, Buf& key_buf, Buf& value_buf,
-             std::vector<std::any>& record, int record_index, bool skip,
-             dingodb::serialV2::ValueHeader& valueHeader);
+using CastAndDecodeOrSkipFuncPointer = RecordDecoderV2::DecodeFunc;
 
-template <typename T>
-void CastAndDecodeOrSkip(BaseSchemaPtr schema, Buf& key_buf, Buf& value_buf,
-                         std::vector<std::any>& record, int record_index,
-                         bool is_skip, dingodb::serialV2::ValueHeader& valueHeader) {
-
-  auto getOffset = [&valueHeader, &value_buf](int index) -> int {
-      int start = valueHeader.ids_pos;
-      int end = valueHeader.offset_pos - 2;
-
-      while (start <= end) {
-        int mid = (start/2 + (end/2 - start/2) / 2) * 2;
-        int cur_id = value_buf.ReadShort(mid);
-        if (cur_id == index) {
-          int offsetPos = (mid - valueHeader.ids_pos)/2;
-          return value_buf.ReadInt(valueHeader.offset_pos + offsetPos * 4);
-        } else if (cur_id < index) {
-          start = mid + 2;
-        } else {
-          end = mid - 2;
-        }
+// Offset of a value column in a static offsets value. Written with other
+// schemas, the fixed width columns ahead of it are summed up by their lengths.
+template <bool kChecked = true>
+static int GetStaticValueOffset(const RecordDecoderV2::Column& column,
+                                BufView& value_buf,
+                                const ValueHeader& valueHeader) {
+  if (valueHeader.ids_match) {
+    if (column.static_offset >= 0) {
+      return valueHeader.IsNullColumn<kChecked>(value_buf, column.static_slot)
+                 ? -1
+                 : valueHeader.data_pos + column.static_offset;
+    }
+    return valueHeader.ReadOffset<kChecked>(
+        value_buf, column.static_slot - valueHeader.fixed_cnt);
+  }
+
+  if (DINGO_UNLIKELY(valueHeader.fixed_cnt > valueHeader.entry_cnt)) {
+    throw std::out_of_range("Out of range.");
+  }
+  int offset = valueHeader.data_pos;
+  for (int i = 0; i < valueHeader.entry_cnt; ++i) {
+    int id = valueHeader.ReadId<kChecked>(value_buf, i);
+    if (i >= valueHeader.fixed_cnt) {
+      if (id == column.index) {
+        return valueHeader.ReadOffset<kChecked>(value_buf,
+                                                i - valueHeader.fixed_cnt);
       }
+      continue;
+    }
+    if (id == column.index) {
+      return valueHeader.IsNullColumn<kChecked>(value_buf, i) ? -1 : offset;
+    }
 
-      return -1; //should not come here.
-  };
+    const auto& lengths = *valueHeader.fixed_lengths;
+    if (DINGO_UNLIKELY(static_cast<size_t>(id) >= lengths.size() ||
+                       lengths[id] == 0)) {
+      throw std::runtime_error("Unknown fixed width column in value.");
+    }
+    offset += lengths[id];
+  }
+
+  return -1;
+}
+
+// Offset of a value column's data, -1 when the column is null or absent.
+// Without kChecked the tables of valueHeader are known to be in range.
+template <bool kChecked = true>
+static int GetValueOffset(const RecordDecoderV2::Column& column,
+                          BufView& value_buf, const ValueHeader& valueHeader) {
+  if (valueHeader.HasStaticOffsets()) {
+    return GetStaticValueOffset<kChecked>(column, value_buf, valueHeader);
+  }
+  if (column.type == BaseSchema::kBool && valueHeader.HasBoolBits()) {
+    return valueHeader.ReadBoolOffset<kChecked>(value_buf, column.index);
+  }
+  if (valueHeader.ids_match) {
+    int ordinal = column.value_slot;
+    if (valueHeader.HasNullBitmap()) {
+      if (valueHeader.IsNullColumn<kChecked>(value_buf, ordinal)) {
+        return -1;
+      }
+      ordinal = valueHeader.NotNullRank<kChecked>(value_buf, ordinal);
+    }
+    return valueHeader.ReadOffset<kChecked>(value_buf, ordinal);
+  }
+
+  int index = column.index;
+  int start = 0;
+  int end = valueHeader.entry_cnt - 1;
+
+  while (start <= end) {
+    int mid = start + (end - start) / 2;
+    int cur_id = valueHeader.ReadId<kChecked>(value_buf, mid);
+    if (cur_id == index) {
+      return valueHeader.ReadOffset<kChecked>(value_buf, mid);
+    } else if (cur_id < index) {
+      start = mid + 1;
+    } else {
+      end = mid - 1;
+    }
+  }
+
+  return -1;
+}
 
-  auto dingo_schema = std::dynamic_pointer_cast<DingoSchema<T>>(schema);
+// The table below dispatches on GetType(), so schema is known to be a
+// DingoSchema<T> and a static cast is enough.
+template <typename T>
+void CastAndDecodeOrSkip(const RecordDecoderV2::Column& column, BufView& key_buf,
+                         BufView& value_buf, std::vector<std::any>& record,
+                         int record_index, bool is_skip,
+                         dingodb::serialV2::ValueHeader& valueHeader) {
+  auto* dingo_schema = static_cast<DingoSchema<T>*>(column.schema);
   if (is_skip) {
-    if (schema->IsKey()) {
-      dingo_schema->SkipKey(key_buf);
+    if (column.is_key) {
+      column.SkipKey(key_buf);
     }
   } else {
-    if (schema->IsKey()) {
+    if (column.is_key) {
       record.at(record_index) = dingo_schema->DecodeKey(key_buf);
     } else {
       if (value_buf.IsEnd()) {
         record.at(record_index) = std::any();
       } else {
-        int offset = getOffset(schema->GetIndex());
+        int offset = GetValueOffset(column, value_buf, valueHeader);
         if (offset != -1) {
           record.at(record_index) = dingo_schema->DecodeValue(value_buf, offset);
         } else {
@@ -99,6 +171,69 @@ CastAndDecodeOrSkipFuncPointer cast_and_decode_or_skip_func_ptrs[] = {
     CastAndDecodeOrSkip<std::vector<std::string>>,
 };
 
+// Number value columns read their word straight from the value, in the byte
+// order fixed at construction instead of looked up per word. Without
+// kChecked the value is trusted: its tables were checked once by
+// ReadValueHeader, the offsets in them and the record slot are not.
+template <typename T, typename Order, bool kChecked = true>
+void DecodeFixedValue(const RecordDecoderV2::Column& column,
+                      BufView& /*key_buf*/, BufView& value_buf,
+                      std::vector<std::any>& record, int record_index,
+                      bool is_skip,
+                      dingodb::serialV2::ValueHeader& valueHeader) {
+  if (is_skip) {
+    return;
+  }
+
+  int offset = value_buf.IsEnd()
+                   ? -1
+                   : GetValueOffset<kChecked>(column, value_buf, valueHeader);
+  if constexpr (kChecked) {
+    if (offset == -1) {
+      record.at(record_index) = std::any();
+      return;
+    }
+    if (DINGO_UNLIKELY(offset < 0 ||
+                       offset + sizeof(T) > value_buf.Size())) {
+      throw std::out_of_range("Out of range.");
+    }
+    record.at(record_index) =
+        std::any(Order::template LoadValue<T>(value_buf.Data() + offset));
+  } else {
+    if (offset == -1) {
+      record[record_index].reset();
+      return;
+    }
+    record[record_index] =
+        std::any(Order::template LoadValue<T>(value_buf.Data() + offset));
+  }
+}
+
+template <typename Order, bool kChecked>
+static RecordDecoderV2::DecodeFunc ValueDecodeFunc(BaseSchema* schema) {
+  switch (schema->GetType()) {
+    case BaseSchema::kBool:
+      return DecodeFixedValue<bool, Order, kChecked>;
+    case BaseSchema::kInteger:
+      if (!static_cast<DingoSchema<int32_t>*>(schema)->IsVarint()) {
+        return DecodeFixedValue<int32_t, Order, kChecked>;
+      }
+      break;
+    case BaseSchema::kFloat:
+      return DecodeFixedValue<float, Order, kChecked>;
+    case BaseSchema::kLong:
+      if (!static_cast<DingoSchema<int64_t>*>(schema)->IsVarint()) {
+        return DecodeFixedValue<int64_t, Order, kChecked>;
+      }
+      break;
+    case BaseSchema::kDouble:
+      return DecodeFixedValue<double, Order, kChecked>;
+    default:
+      break;
+  }
+  return cast_and_decode_or_skip_func_ptrs[static_cast<int>(schema->GetType())];
+}
+
 RecordDecoderV2::RecordDecoderV2(int schema_version,
                                  const std::vector<BaseSchemaPtr>& schemas,
                                  long common_id)
@@ -112,97 +247,287 @@ RecordDecoderV2::RecordDecoderV2(int schema_version,
       common_id_(common_id),
       schemas_(schemas) {
   FormatSchema(schemas_, le);
-  key_buf_ = Buf(kBufInitCapacity, le);
-  value_buf_ = Buf(kBufInitCapacity, le);
+
+  Buf common_id_buf(8, le);
+  common_id_buf.WriteLong(common_id);
+  memcpy(encoded_common_id_, common_id_buf.Data(), 8);
+
+  Buf value_ids(schemas_.size() * ID_2_BYTE, le);
+  Buf compact_value_ids(schemas_.size() * ID_1_BYTE, le);
+  bool compact_ids = true;
+  columns_.reserve(schemas_.size());
+  for (const auto& descriptor : CompileColumnDescriptors(schemas_)) {
+    BaseSchema* schema = descriptor.schema;
+    if (schema == nullptr) {
+      columns_.push_back({descriptor, nullptr});
+      continue;
+    }
+
+    if (descriptor.is_key) {
+      columns_.push_back(
+          {descriptor, cast_and_decode_or_skip_func_ptrs[descriptor.type]});
+    } else {
+      columns_.push_back({descriptor, ValueDecodeFuncOf(schema)});
+      value_ids.WriteShort(descriptor.index);
+      value_indexes_.push_back(descriptor.index);
+      compact_ids = compact_ids && descriptor.index < 255;
+      compact_value_ids.Write(descriptor.index);
+    }
+  }
+  value_ids.GetString(value_ids_);
+  if (compact_ids) {
+    compact_value_ids.GetString(compact_value_ids_);
+  }
+
+  // static offsets layout, the value columns in the order of the encoder.
+  std::vector<Column*> static_columns;
+  for (auto& column : columns_) {
+    if (column.schema != nullptr && !column.is_key) {
+      static_columns.push_back(&column);
+    }
+  }
+  std::stable_sort(static_columns.begin(), static_columns.end(),
+                   [](const Column* a, const Column* b) {
+                     return ValueLayoutBefore(a->schema, b->schema);
+                   });
+  Buf static_ids(schemas_.size() * ID_2_BYTE, le);
+  Buf compact_static_ids(schemas_.size() * ID_1_BYTE, le);
+  int static_slot = 0;
+  int static_offset = 0;
+  for (Column* column : static_columns) {
+    column->static_slot = static_slot++;
+    if (column->value_length > 0) {
+      column->static_offset = static_offset;
+      static_offset += column->value_length;
+      static_fixed_cnt_++;
+      if (fixed_lengths_.size() <= static_cast<size_t>(column->index)) {
+        fixed_lengths_.resize(column->index + 1, 0);
+      }
+      fixed_lengths_[column->index] = column->value_length;
+    }
+    static_ids.WriteShort(column->index);
+    compact_static_ids.Write(column->index);
+  }
+  static_ids.GetString(static_value_ids_);
+  if (compact_ids) {
+    compact_static_ids.GetString(compact_static_value_ids_);
+  }
+}
+
+RecordDecoderV2::DecodeFunc RecordDecoderV2::ValueDecodeFuncOf(
+    BaseSchema* schema) const {
+  if (trusted_input_) {
+    return le_ ? ValueDecodeFunc<SwappedByteOrder, false>(schema)
+               : ValueDecodeFunc<HostByteOrder, false>(schema);
+  }
+  return le_ ? ValueDecodeFunc<SwappedByteOrder, true>(schema)
+             : ValueDecodeFunc<HostByteOrder, true>(schema);
 }
 
-inline bool RecordDecoderV2::CheckPrefix(Buf& buf) const {
-  // skip name space
-  buf.Skip(1);
-  return buf.ReadLong() == common_id_;
+void RecordDecoderV2::SetPrefetchDistance(int rows) {
+  if (rows < 0) {
+    throw std::out_of_range("Prefetch distance out of range.");
+  }
+  prefetch_distance_ = rows;
+}
+
+void RecordDecoderV2::SetTrustedInput(bool trusted) {
+  trusted_input_ = trusted;
+  for (auto& column : columns_) {
+    if (column.schema != nullptr && !column.is_key) {
+      column.decode = ValueDecodeFuncOf(column.schema);
+    }
+  }
+}
+
+void RecordDecoderV2::ReadValueHeader(BufView& value_buf,
+                                      ValueHeader& value_header) const {
+  value_header = ValueHeader(value_buf, GetValueFormat(value_buf.ReadInt(0)));
+  // the one check of a trusted value, its tables are then read unchecked.
+  if (trusted_input_ && DINGO_UNLIKELY(!value_header.InRange(value_buf.Size()))) {
+    throw std::out_of_range("Out of range.");
+  }
+
+  // Rows written with the current schemas carry exactly our id table.
+  if (value_header.HasStaticOffsets()) {
+    const std::string& ids = value_header.id_unit == ID_1_BYTE
+                                 ? compact_static_value_ids_
+                                 : static_value_ids_;
+    value_header.fixed_lengths = &fixed_lengths_;
+    value_header.ids_match =
+        value_header.fixed_cnt == static_fixed_cnt_ &&
+        static_cast<size_t>(value_header.total_col_cnt *
+                            value_header.id_unit) == ids.size() &&
+        value_buf.Size() >= value_header.ids_pos + ids.size() &&
+        memcmp(value_buf.Data() + value_header.ids_pos, ids.data(),
+               ids.size()) == 0;
+    return;
+  }
+  if (value_header.HasBoolBits()) {
+    // the id table lacks the bools and the nulls, columns are searched for.
+    return;
+  }
+  if (value_header.HasNullBitmap()) {
+    // the id table holds the not null columns the bitmap leaves.
+    bool match = static_cast<size_t>(value_header.total_col_cnt) ==
+                 value_indexes_.size();
+    int entry = 0;
+    for (int i = 0; match && i < value_header.total_col_cnt; ++i) {
+      if (!value_header.IsNullColumn(value_buf, i)) {
+        match = value_header.ReadId(value_buf, entry++) == value_indexes_[i];
+      }
+    }
+    value_header.ids_match = match;
+    return;
+  }
+
+  const std::string& ids = value_header.id_unit == ID_1_BYTE
+                               ? compact_value_ids_
+                               : value_ids_;
+  size_t ids_size = ids.size();
+  value_header.ids_match =
+      static_cast<size_t>(value_header.total_col_cnt *
+                          value_header.id_unit) == ids_size &&
+      value_buf.Size() >= value_header.ids_pos + ids_size &&
+      memcmp(value_buf.Data() + value_header.ids_pos, ids.data(),
+             ids_size) == 0;
+}
+
+inline bool RecordDecoderV2::CheckPrefix(BufView& buf) const {
+  // any name space, then the common_id bytes.
+  size_t pos = buf.ReadOffset();
+  buf.Skip(9);
+  return memcmp(buf.Data() + pos + 1, encoded_common_id_, 8) == 0;
 }
 
-inline bool RecordDecoderV2::CheckReverseTag(Buf& buf) const {
+inline bool RecordDecoderV2::CheckReverseTag(BufView& buf) const {
   if (buf.ReadInt(buf.Size() - 4) == codec_version_) {
     return true;
   }
   return false;
 }
 
-inline int RecordDecoderV2::GetCodecVersion(Buf& buf) const {
+int RecordDecoderV2::GetCodecVersion(Buf& buf) const {
   return buf.ReadInt(buf.Size() - 4);
 }
 
-inline bool RecordDecoderV2::CheckSchemaVersion(Buf& buf) const {
-  return buf.ReadInt() <= schema_version_;
+int RecordDecoderV2::GetCodecVersion(BufView& buf) const {
+  return buf.ReadInt(buf.Size() - 4);
 }
 
-void DecodeOrSkip(BaseSchemaPtr schema, Buf& key_buf, Buf& value_buf,
-                  std::vector<std::any>& record, int record_index, bool skip,
-                  dingodb::serialV2::ValueHeader& valueHeader) {
-  cast_and_decode_or_skip_func_ptrs[static_cast<int>(schema->GetType())](
-      schema, key_buf, value_buf, record, record_index, skip, valueHeader);
+inline bool RecordDecoderV2::CheckSchemaVersion(BufView& buf) const {
+  int32_t version = buf.ReadInt();
+  if ((GetValueFormat(version) & ~kValueFormatKnownFlags) != 0) {
+    return false;
+  }
+  return (version & kSchemaVersionMask) <= schema_version_;
 }
 
-int RecordDecoderV2::Decode(const std::string& key, const std::string& value,
-                            std::vector<std::any>& record /*output*/) {
-  Buf key_buf(key, this->le_);
-  Buf value_buf(value, this->le_);
+// Decompressed values of the calling thread, reused from row to row.
+static std::string& ThreadScratch() {
+  thread_local std::string scratch;
+  return scratch;
+}
 
-  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
-      !CheckSchemaVersion(value_buf)) {
-    return -1;
-  }
+int RecordDecoderV2::DecodeFailure() const {
+  DINGO_SERIAL_PROBE2(decode_failure, common_id_, schema_version_);
+  DINGO_CODEC_STATS(stats_, AddDecodeFailure());
+  return -1;
+}
 
-  ValueHeader value_header(value_buf);
-  if (value_header.total_col_cnt != value_header.cnt_null_col) {
-    value_buf.SetReadOffset(value_header.data_pos);
-  }
+size_t RecordDecoderV2::MemoryUsage() const {
+  return sizeof(*this) + HeapSize(schemas_) + HeapSize(columns_) +
+         HeapSize(value_ids_) + HeapSize(compact_value_ids_) +
+         HeapSize(value_indexes_) + HeapSize(static_value_ids_) +
+         HeapSize(compact_static_value_ids_) + HeapSize(fixed_lengths_);
+}
 
-  record.resize(schemas_.size());
-  for (const auto& bs : schemas_) {
-    if (bs) {
-      DecodeOrSkip(bs, key_buf, value_buf, record, bs->GetIndex(), false,
-                   value_header);
+void RecordDecoderV2::SetVerifyChecksums(bool verify) {
+  verify_checksums_ = verify;
+  SetTrustedInput(verify);
+}
+
+bool RecordDecoderV2::Inflate(std::string_view& value,
+                              std::string& scratch) const {
+  if (value.size() >= 4) {
+    BufView version_buf(value, this->le_);
+    if (!CheckSchemaVersion(version_buf)) {
+      return false;
     }
   }
+  if (verify_checksums_ && VerifyValueChecksum(value, this->le_) <= 0) {
+    return false;
+  }
+  return InflateValue(value, scratch, this->le_);
+}
 
-  return 0;
+inline void DecodeOrSkip(const RecordDecoderV2::Column& column, BufView& key_buf,
+                         BufView& value_buf, std::vector<std::any>& record,
+                         int record_index, bool skip,
+                         dingodb::serialV2::ValueHeader& valueHeader) {
+  column.decode(column, key_buf, value_buf, record, record_index, skip,
+                valueHeader);
+}
+
+int RecordDecoderV2::Decode(const std::string& key, const std::string& value,
+                            std::vector<std::any>& record /*output*/) const {
+  return Decode(std::string_view(key), std::string_view(value), record);
 }
 
 int RecordDecoderV2::Decode(std::string&& key, std::string&& value,
-                            std::vector<std::any>& record) {
-  Buf key_buf(std::move(key), this->le_);
-  Buf value_buf(std::move(value), this->le_);
+                            std::vector<std::any>& record) const {
+  return Decode(std::string_view(key), std::string_view(value), record);
+}
+
+int RecordDecoderV2::Decode(std::string_view key, std::string_view value,
+                            std::vector<std::any>& record /*output*/) const {
+  DINGO_SERIAL_PROBE4(decode_start, common_id_, schema_version_, key.size(),
+                      value.size());
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  if (!Inflate(value, ThreadScratch())) {
+    return DecodeFailure();
+  }
+  BufView key_buf(key, this->le_);
+  BufView value_buf(value, this->le_);
 
   if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
       !CheckSchemaVersion(value_buf)) {
-    return -1;
+    return DecodeFailure();
   }
 
-  ValueHeader value_header(value_buf);
+  ValueHeader value_header;
+  ReadValueHeader(value_buf, value_header);
   if (value_header.total_col_cnt != value_header.cnt_null_col) {
-    // If not means all value fields are null.
     value_buf.SetReadOffset(value_header.data_pos);
   }
 
   record.resize(schemas_.size());
-  for (const auto& bs : schemas_) {
-    if (bs) {
-      DecodeOrSkip(bs, key_buf, value_buf, record, bs->GetIndex(), false,
+  for (const auto& column : columns_) {
+    if (column.schema) {
+      DecodeOrSkip(column, key_buf, value_buf, record, column.index, false,
                    value_header);
     }
   }
 
+  DINGO_CODEC_STATS(stats_, AddDecode(key.size() + value.size(),
+                                      columns_.size(), 0, sample_start));
+  DINGO_SERIAL_PROBE3(decode_done, common_id_, schema_version_,
+                      columns_.size());
   return 0;
 }
 
 int RecordDecoderV2::DecodeKey(const std::string& key,
-                               std::vector<std::any>& record /*output*/) {
-  Buf key_buf(key, this->le_);
+                               std::vector<std::any>& record /*output*/) const {
+  return DecodeKey(std::string_view(key), record);
+}
+
+int RecordDecoderV2::DecodeKey(std::string_view key,
+                               std::vector<std::any>& record /*output*/) const {
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  BufView key_buf(key, this->le_);
 
   if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf)) {
-    return -1;
+    return DecodeFailure();
   }
 
   std::unordered_map<int, int> id_offset_map;
@@ -211,33 +536,53 @@ int RecordDecoderV2::DecodeKey(const std::string& key,
 
   record.resize(schemas_.size());
   int index = 0;
-  for (const auto& bs : schemas_) {
-    if (bs && bs->IsKey()) {
-      DecodeOrSkip(bs, key_buf, key_buf, record, index, false, value_header);
+  size_t key_columns = 0;
+  for (const auto& column : columns_) {
+    if (column.schema && column.is_key) {
+      DecodeOrSkip(column, key_buf, key_buf, record, index, false,
+                   value_header);
+      key_columns++;
     }
     index++;
   }
 
+  DINGO_CODEC_STATS(stats_,
+                    AddDecode(key.size(), key_columns,
+                              columns_.size() - key_columns, sample_start));
   return 0;
 }
 
 int RecordDecoderV2::Decode(const KeyValue& key_value,
-                            std::vector<std::any>& record) {
+                            std::vector<std::any>& record) const {
   return Decode(key_value.GetKey(), key_value.GetValue(), record);
 }
 
 int RecordDecoderV2::Decode(const std::string& key, const std::string& value,
                             std::unordered_map<int, int>& column_indexes_serial,
-                            std::vector<std::any>& record) {
-  Buf key_buf(key, this->le_);
-  Buf value_buf(value, this->le_);
+                            std::vector<std::any>& record) const {
+  return Decode(std::string_view(key), std::string_view(value),
+                column_indexes_serial, record);
+}
+
+int RecordDecoderV2::Decode(std::string_view key, std::string_view value,
+                            std::unordered_map<int, int>& column_indexes_serial,
+                            std::vector<std::any>& record) const {
+  DINGO_SERIAL_PROBE4(decode_projected_start, common_id_, schema_version_,
+                      key.size(), value.size());
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  if (!Inflate(value, ThreadScratch())) {
+    return DecodeFailure();
+  }
+  BufView key_buf(key, this->le_);
+  BufView value_buf(value, this->le_);
 
   if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
       !CheckSchemaVersion(value_buf)) {
-    return -1;
+    return DecodeFailure();
   }
 
-  ValueHeader value_header(value_buf);
+  ValueHeader value_header;
+  ReadValueHeader(value_buf, value_header);
   if (value_header.total_col_cnt != value_header.cnt_null_col) {
     value_buf.SetReadOffset(value_header.data_pos);
   }
@@ -245,32 +590,1333 @@ int RecordDecoderV2::Decode(const std::string& key, const std::string& value,
   uint32_t size = column_indexes_serial.size();
   record.resize(size);
 
+  // stops after the last projected column, the schemas behind it are not
+  // looked at.
   uint32_t decode_col_count = 0;
-  for (uint32_t i = 0; i < schemas_.size(); ++i) {
-    auto& schema = schemas_[i];
-    if (schema == nullptr) {
+  uint32_t decoded = 0;
+  for (const auto& column : columns_) {
+    if (decoded == size) {
+      break;
+    }
+    if (column.schema == nullptr) {
+      continue;
+    }
+
+    auto it = column_indexes_serial.find(decode_col_count++);
+    if (it == column_indexes_serial.end()) {
+      DecodeOrSkip(column, key_buf, value_buf, record, -1, true, value_header);
+    } else {
+      DecodeOrSkip(column, key_buf, value_buf, record, it->second, false,
+                   value_header);
+      decoded++;
+    }
+  }
+
+  DINGO_CODEC_STATS(stats_,
+                    AddDecode(key.size() + value.size(), size,
+                              columns_.size() - size, sample_start));
+  DINGO_SERIAL_PROBE3(decode_projected_done, common_id_, schema_version_,
+                      size);
+  return 0;
+}
+
+inline void RecordDecoderV2::DecodeColumn(const Column& column,
+                                          BufView& key_buf, BufView& value_buf,
+                                          ValueHeader& value_header,
+                                          RowSink& sink, int col) const {
+  BaseSchema* schema = column.schema;
+  if (column.is_key) {
+    schema->DecodeKey(key_buf, sink, col);
+    return;
+  }
+
+  int offset =
+      value_buf.IsEnd() ? -1 : GetValueOffset(column, value_buf, value_header);
+  if (offset == -1) {
+    sink.OnNull(col);
+  } else {
+    schema->DecodeValue(value_buf, offset, sink, col);
+  }
+}
+
+int RecordDecoderV2::Decode(std::string_view key, std::string_view value,
+                            RowSink& sink) const {
+  if (!Inflate(value, ThreadScratch())) {
+    return -1;
+  }
+  BufView key_buf(key, this->le_);
+  BufView value_buf(value, this->le_);
+
+  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
+      !CheckSchemaVersion(value_buf)) {
+    return -1;
+  }
+
+  ValueHeader value_header;
+  ReadValueHeader(value_buf, value_header);
+  if (value_header.total_col_cnt != value_header.cnt_null_col) {
+    value_buf.SetReadOffset(value_header.data_pos);
+  }
+
+  for (const auto& column : columns_) {
+    if (column.schema) {
+      DecodeColumn(column, key_buf, value_buf, value_header, sink,
+                   column.index);
+    }
+  }
+
+  return 0;
+}
+
+int RecordDecoderV2::Decode(std::string_view key, std::string_view value,
+                            const DecodePlan& plan, RowSink& sink) const {
+  if (plan.SchemaCount() != schemas_.size()) {
+    return -1;
+  }
+
+  if (!Inflate(value, ThreadScratch())) {
+    return -1;
+  }
+  BufView key_buf(key, this->le_);
+  BufView value_buf(value, this->le_);
+
+  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
+      !CheckSchemaVersion(value_buf)) {
+    return -1;
+  }
+
+  ValueHeader value_header;
+  ReadValueHeader(value_buf, value_header);
+  if (value_header.total_col_cnt != value_header.cnt_null_col) {
+    value_buf.SetReadOffset(value_header.data_pos);
+  }
+
+  for (size_t i = 0; i < plan.KeyEnd(); ++i) {
+    const auto& column = columns_[i];
+    if (column.schema == nullptr || !column.is_key) {
+      continue;
+    }
+
+    int col = plan.Slot(i);
+    if (col == DecodePlan::kSkip) {
+      column.SkipKey(key_buf);
+    } else {
+      DecodeColumn(column, key_buf, value_buf, value_header, sink, col);
+    }
+  }
+  for (size_t i : plan.ValueColumns()) {
+    DecodeColumn(columns_[i], key_buf, value_buf, value_header, sink,
+                 plan.Slot(i));
+  }
+
+  return 0;
+}
+
+namespace {
+
+// Writes the columns of a row into a record of ColumnValue, a string or list
+// is assigned into the one the slot already holds.
+class ColumnValueSink : public RowSink {
+ public:
+  explicit ColumnValueSink(std::vector<ColumnValue>& record)
+      : record_(record) {}
+
+  void OnNull(int col) override {
+    if (Valid(col)) {
+      record_[col] = std::monostate();
+    }
+  }
+
+  void OnBool(int col, bool value) override { Assign(col, value); }
+  void OnInt32(int col, int32_t value) override { Assign(col, value); }
+  void OnInt64(int col, int64_t value) override { Assign(col, value); }
+  void OnFloat(int col, float value) override { Assign(col, value); }
+  void OnDouble(int col, double value) override { Assign(col, value); }
+
+  void OnString(int col, std::string_view value) override {
+    if (!Valid(col)) {
+      return;
+    }
+    if (auto* held = std::get_if<std::string>(&record_[col])) {
+      held->assign(value.data(), value.size());
+    } else {
+      record_[col].emplace<std::string>(value);
+    }
+  }
+
+  void OnBoolList(int col, std::vector<bool>&& value) override {
+    Assign(col, std::move(value));
+  }
+  void OnInt32List(int col, std::vector<int32_t>&& value) override {
+    Assign(col, std::move(value));
+  }
+  void OnInt64List(int col, std::vector<int64_t>&& value) override {
+    Assign(col, std::move(value));
+  }
+  void OnFloatList(int col, std::vector<float>&& value) override {
+    Assign(col, std::move(value));
+  }
+  void OnDoubleList(int col, std::vector<double>&& value) override {
+    Assign(col, std::move(value));
+  }
+  void OnStringList(int col, std::vector<std::string>&& value) override {
+    Assign(col, std::move(value));
+  }
+
+  void ReuseList(int col, std::vector<bool>& list) override {
+    Reuse(col, list);
+  }
+  void ReuseList(int col, std::vector<int32_t>& list) override {
+    Reuse(col, list);
+  }
+  void ReuseList(int col, std::vector<int64_t>& list) override {
+    Reuse(col, list);
+  }
+  void ReuseList(int col, std::vector<float>& list) override {
+    Reuse(col, list);
+  }
+  void ReuseList(int col, std::vector<double>& list) override {
+    Reuse(col, list);
+  }
+  void ReuseList(int col, std::vector<std::string>& list) override {
+    Reuse(col, list);
+  }
+
+ private:
+  bool Valid(int col) const {
+    return col >= 0 && col < static_cast<int>(record_.size());
+  }
+
+  template <typename T>
+  void Assign(int col, T&& value) {
+    if (!Valid(col)) {
+      return;
+    }
+    if (auto* held = std::get_if<std::decay_t<T>>(&record_[col])) {
+      *held = std::forward<T>(value);
+    } else {
+      record_[col].emplace<std::decay_t<T>>(std::forward<T>(value));
+    }
+  }
+
+  template <typename T>
+  void Reuse(int col, std::vector<T>& list) {
+    if (Valid(col)) {
+      if (auto* held = std::get_if<std::vector<T>>(&record_[col])) {
+        list.swap(*held);
+      }
+    }
+  }
+
+  std::vector<ColumnValue>& record_;
+};
+
+}  // namespace
+
+int RecordDecoderV2::Decode(std::string_view key, std::string_view value,
+                            std::vector<ColumnValue>& record) const {
+  DINGO_SERIAL_PROBE4(decode_start, common_id_, schema_version_, key.size(),
+                      value.size());
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  record.resize(schemas_.size());
+  ColumnValueSink sink(record);
+  if (Decode(key, value, sink) != 0) {
+    return DecodeFailure();
+  }
+
+  DINGO_CODEC_STATS(stats_, AddDecode(key.size() + value.size(),
+                                      columns_.size(), 0, sample_start));
+  DINGO_SERIAL_PROBE3(decode_done, common_id_, schema_version_,
+                      columns_.size());
+  return 0;
+}
+
+int RecordDecoderV2::Decode(std::string_view key, std::string_view value,
+                            const DecodePlan& plan,
+                            std::vector<ColumnValue>& record) const {
+  DINGO_SERIAL_PROBE4(decode_projected_start, common_id_, schema_version_,
+                      key.size(), value.size());
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  record.resize(plan.OutputSize());
+  ColumnValueSink sink(record);
+  if (Decode(key, value, plan, sink) != 0) {
+    return DecodeFailure();
+  }
+
+  DINGO_CODEC_STATS(stats_,
+                    AddDecode(key.size() + value.size(), plan.OutputSize(),
+                              columns_.size() - plan.OutputSize(),
+                              sample_start));
+  DINGO_SERIAL_PROBE3(decode_projected_done, common_id_, schema_version_,
+                      plan.OutputSize());
+  return 0;
+}
+
+template <typename RowAt>
+int RecordDecoderV2::DecodeBatchImpl(size_t count, RowAt row_at,
+                                     const DecodePlan& plan,
+                                     ColumnBatch& batch) const {
+  if (plan.SchemaCount() != schemas_.size()) {
+    return -1;
+  }
+
+  std::vector<BaseSchema::Type> types(plan.OutputSize(), BaseSchema::kBool);
+  std::vector<bool> assigned(plan.OutputSize(), false);
+  for (size_t i = 0; i < plan.End(); ++i) {
+    int col = plan.Slot(i);
+    if (columns_[i].schema != nullptr && col >= 0 &&
+        static_cast<size_t>(col) < types.size()) {
+      types[col] = columns_[i].type;
+      assigned[col] = true;
+    }
+  }
+  batch.Reset(types);
+
+  // Check every row and parse its value header once.
+  std::vector<BufView> key_bufs;
+  std::vector<BufView> value_bufs;
+  std::vector<ValueHeader> value_headers(count);
+  key_bufs.reserve(count);
+  value_bufs.reserve(count);
+  thread_local std::vector<std::string> scratches;
+  if (scratches.size() < count) {
+    scratches.resize(count);
+  }
+  // The rows are apart in memory, so the header of the row prefetch_distance_
+  // ahead is fetched while this one is checked.
+  size_t distance = prefetch_distance_;
+  for (size_t r = 0; r < count; ++r) {
+    if (distance > 0 && r + distance < count) {
+      auto [next_key, next_value] = row_at(r + distance);
+      DINGO_PREFETCH(next_key.data());
+      DINGO_PREFETCH(next_value.data());
+    }
+    auto [key, value] = row_at(r);
+    key_bufs.emplace_back(key, this->le_);
+    if (!Inflate(value, scratches[r])) {
+      return -1;
+    }
+    value_bufs.emplace_back(value, this->le_);
+    BufView& key_buf = key_bufs.back();
+    BufView& value_buf = value_bufs.back();
+
+    if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
+        !CheckSchemaVersion(value_buf)) {
+      return -1;
+    }
+
+    ReadValueHeader(value_buf, value_headers[r]);
+    if (value_headers[r].total_col_cnt != value_headers[r].cnt_null_col) {
+      value_buf.SetReadOffset(value_headers[r].data_pos);
+    }
+  }
+
+  // Column at a time, key columns are visited in schema order so every row's
+  // key cursor stays in step.
+  ColumnBatchSink sink(batch);
+  auto decode_column = [&](const Column& column, int col) {
+    for (size_t r = 0; r < count; ++r) {
+      if (distance > 0 && r + distance < count) {
+        const auto& next = column.is_key ? key_bufs[r + distance]
+                                         : value_bufs[r + distance];
+        DINGO_PREFETCH(next.Data() + next.ReadOffset());
+      }
+      DecodeColumn(column, key_bufs[r], value_bufs[r], value_headers[r], sink,
+                   col);
+    }
+  };
+  for (size_t i = 0; i < plan.KeyEnd(); ++i) {
+    const auto& column = columns_[i];
+    if (column.schema == nullptr || !column.is_key) {
       continue;
     }
-    // if (decode_col_count == size) {
-    //   break;
-    // }
 
-    if(column_indexes_serial.find(decode_col_count) == column_indexes_serial.end()) {
-      DecodeOrSkip(schema, key_buf, value_buf, record, -1, true, value_header);
-      decode_col_count++;
+    int col = plan.Slot(i);
+    if (col == DecodePlan::kSkip) {
+      for (size_t r = 0; r < count; ++r) {
+        column.SkipKey(key_bufs[r]);
+      }
     } else {
-      int result_index = column_indexes_serial[decode_col_count++];
-      DecodeOrSkip(schema, key_buf, value_buf, record, result_index,
-                   false, value_header);
+      decode_column(column, col);
     }
   }
+  for (size_t i : plan.ValueColumns()) {
+    decode_column(columns_[i], plan.Slot(i));
+  }
+
+  // slots not backed by any schema are all null.
+  for (size_t col = 0; col < assigned.size(); ++col) {
+    if (!assigned[col]) {
+      for (size_t r = 0; r < count; ++r) {
+        batch.Column(col).AppendNull();
+      }
+    }
+  }
+
+  batch.SetNumRows(count);
+  return 0;
+}
+
+int RecordDecoderV2::DecodeBatch(const KeyValue* key_values, size_t count,
+                                 const DecodePlan& plan,
+                                 ColumnBatch& batch) const {
+  return DecodeBatchImpl(
+      count,
+      [key_values](size_t r) {
+        return std::make_pair(std::string_view(key_values[r].GetKey()),
+                              std::string_view(key_values[r].GetValue()));
+      },
+      plan, batch);
+}
+
+int RecordDecoderV2::DecodeBatch(const std::vector<KeyValue>& key_values,
+                                 const DecodePlan& plan,
+                                 ColumnBatch& batch) const {
+  return DecodeBatch(key_values.data(), key_values.size(), plan, batch);
+}
+
+int RecordDecoderV2::DecodeBatch(const EncodedBatch& rows,
+                                 const DecodePlan& plan,
+                                 ColumnBatch& batch) const {
+  return DecodeBatchImpl(
+      rows.Size(),
+      [&rows](size_t r) { return std::make_pair(rows.Key(r), rows.Value(r)); },
+      plan, batch);
+}
+
+int RecordDecoderV2::SelectByKey(const KeyValue* key_values, size_t count,
+                                 const std::vector<EncodedPredicate>& predicates,
+                                 std::vector<uint32_t>& selection) const {
+  selection.clear();
+
+  // the predicates by key column, the key is read up to the last of them.
+  std::vector<std::vector<const EncodedPredicate*>> by_column;
+  for (const auto& predicate : predicates) {
+    int pos = predicate.Column();
+    if (pos < 0 || static_cast<size_t>(pos) >= columns_.size() ||
+        columns_[pos].schema == nullptr || !columns_[pos].is_key) {
+      return -1;
+    }
+    if (static_cast<size_t>(pos) >= by_column.size()) {
+      by_column.resize(pos + 1);
+    }
+    by_column[pos].push_back(&predicate);
+  }
+
+  for (size_t r = 0; r < count; ++r) {
+    BufView key_buf(key_values[r].GetKey(), this->le_);
+    if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf)) {
+      return -1;
+    }
+
+    bool matched = true;
+    for (size_t i = 0; i < by_column.size() && matched; ++i) {
+      const auto& column = columns_[i];
+      if (column.schema == nullptr || !column.is_key) {
+        continue;
+      }
+      for (const auto* predicate : by_column[i]) {
+        BufView at = key_buf;
+        PredicateSink sink(*predicate);
+        column.schema->DecodeKey(at, sink, i);
+        if (!sink.Matched()) {
+          matched = false;
+          break;
+        }
+      }
+      column.SkipKey(key_buf);
+    }
+    if (matched) {
+      selection.push_back(r);
+    }
+  }
+  return 0;
+}
+
+int RecordDecoderV2::SelectByKey(const std::vector<KeyValue>& key_values,
+                                 const std::vector<EncodedPredicate>& predicates,
+                                 std::vector<uint32_t>& selection) const {
+  return SelectByKey(key_values.data(), key_values.size(), predicates,
+                     selection);
+}
+
+int RecordDecoderV2::DecodeBatch(const KeyValue* key_values,
+                                 const std::vector<uint32_t>& selection,
+                                 const DecodePlan& plan,
+                                 ColumnBatch& batch) const {
+  return DecodeBatchImpl(
+      selection.size(),
+      [key_values, &selection](size_t r) {
+        const auto& key_value = key_values[selection[r]];
+        return std::make_pair(std::string_view(key_value.GetKey()),
+                              std::string_view(key_value.GetValue()));
+      },
+      plan, batch);
+}
+
+int RecordDecoderV2::DecodeBatch(const std::vector<KeyValue>& key_values,
+                                 const std::vector<uint32_t>& selection,
+                                 const DecodePlan& plan,
+                                 ColumnBatch& batch) const {
+  return DecodeBatch(key_values.data(), selection, plan, batch);
+}
+
+int RecordDecoderV2::DecodeBatch(const KeyValue* key_values, size_t count,
+                                 std::vector<std::vector<std::any>>& records,
+                                 const ParallelOptions& options) const {
+  records.resize(count);
+  std::atomic<bool> failed{false};
+  ParallelFor(count, options, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (Decode(std::string_view(key_values[i].GetKey()),
+                 std::string_view(key_values[i].GetValue()), records[i]) != 0) {
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  });
+  return failed.load() ? -1 : 0;
+}
+
+int RecordDecoderV2::DecodeColumnGroups(
+    std::string_view key, const std::vector<std::string_view>& values,
+    std::vector<std::any>& record) const {
+  if (values.empty() || values[0].empty()) {
+    return DecodeFailure();
+  }
+  if (Decode(key, values[0], record) != 0) {
+    return -1;
+  }
+
+  // every group value holds the columns of its group alone, the others
+  // decode as null from it.
+  std::vector<std::any> group_record;
+  for (size_t group = 1; group < values.size(); ++group) {
+    if (values[group].empty()) {
+      continue;
+    }
+    if (Decode(key, values[group], group_record) != 0) {
+      return -1;
+    }
+    for (const auto& column : columns_) {
+      if (column.schema != nullptr && !column.is_key &&
+          static_cast<size_t>(column.schema->GetColumnGroup()) == group) {
+        record[column.index] = std::move(group_record[column.index]);
+      }
+    }
+  }
+  return 0;
+}
+
+int RecordDecoderV2::DecodeColumnGroups(
+    std::string_view key, const std::vector<std::string_view>& values,
+    std::unordered_map<int, int>& column_indexes_serial,
+    std::vector<std::any>& record) const {
+  if (values.empty() || values[0].empty()) {
+    return DecodeFailure();
+  }
+  if (Decode(key, values[0], column_indexes_serial, record) != 0) {
+    return -1;
+  }
+
+  std::vector<std::any> group_record;
+  for (size_t group = 1; group < values.size(); ++group) {
+    if (values[group].empty()) {
+      continue;
+    }
+    if (Decode(key, values[group], column_indexes_serial, group_record) != 0) {
+      return -1;
+    }
+    // the projection counts the schemas that are not null.
+    int serial = 0;
+    for (const auto& column : columns_) {
+      if (column.schema == nullptr) {
+        continue;
+      }
+      auto it = column_indexes_serial.find(serial++);
+      if (it != column_indexes_serial.end() && !column.is_key &&
+          static_cast<size_t>(column.schema->GetColumnGroup()) == group) {
+        record[it->second] = std::move(group_record[it->second]);
+      }
+    }
+  }
+  return 0;
+}
+
+std::vector<int> RecordDecoderV2::ColumnGroups(
+    const std::unordered_map<int, int>& column_indexes_serial) const {
+  std::vector<int> groups{0};
+  int serial = 0;
+  for (const auto& column : columns_) {
+    if (column.schema == nullptr) {
+      continue;
+    }
+    if (column_indexes_serial.count(serial++) > 0 && !column.is_key) {
+      groups.push_back(column.schema->GetColumnGroup());
+    }
+  }
+  std::sort(groups.begin(), groups.end());
+  groups.erase(std::unique(groups.begin(), groups.end()), groups.end());
+  return groups;
+}
+
+int RecordDecoderV2::DecodeLazy(std::string_view key, std::string_view value,
+                                LazyRecordV2& record) const {
+  if (!Inflate(value, record.scratch_)) {
+    return -1;
+  }
+  BufView key_buf(key, this->le_);
+  BufView value_buf(value, this->le_);
+
+  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
+      !CheckSchemaVersion(value_buf)) {
+    return -1;
+  }
+
+  ValueHeader value_header;
+  ReadValueHeader(value_buf, value_header);
+  if (value_header.total_col_cnt != value_header.cnt_null_col) {
+    value_buf.SetReadOffset(value_header.data_pos);
+  }
+
+  record.Reset(this, key_buf, value_buf, value_header);
+  return 0;
+}
+
+int RecordDecoderV2::IndexKey(std::string_view key,
+                              std::vector<uint32_t>& offsets) const {
+  BufView key_buf(key, this->le_);
+  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf)) {
+    return -1;
+  }
+
+  // the columns lie between the prefix and the codec version.
+  size_t pos = key_buf.ReadOffset();
+  size_t end = key.size() - 4;
+  offsets.resize(columns_.size() + 1);
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    offsets[i] = pos;
+    const auto& column = columns_[i];
+    if (column.schema == nullptr || !column.is_key) {
+      continue;
+    }
+
+    int len = column.key_length;
+    if (len == 0 && column.type == BaseSchema::kString) {
+      len = static_cast<DingoSchema<std::string>*>(column.schema)
+                ->ScanKeyLength(key.data() + pos, end - pos);
+    } else if (len == 0) {
+      BufView at(key.data(), end, this->le_);
+      at.SetReadOffset(pos);
+      len = column.schema->SkipKey(at);
+    }
+    if (len <= 0 || static_cast<size_t>(len) > end - pos) {
+      return -1;
+    }
+    pos += len;
+  }
+  offsets[columns_.size()] = pos;
+  return 0;
+}
+
+int RecordDecoderV2::DecodeKey(std::string_view key,
+                               const std::vector<uint32_t>& offsets,
+                               const DecodePlan& plan, RowSink& sink) const {
+  if (plan.SchemaCount() != schemas_.size() ||
+      offsets.size() != columns_.size() + 1) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < plan.KeyEnd(); ++i) {
+    const auto& column = columns_[i];
+    int col = plan.Slot(i);
+    if (column.schema == nullptr || !column.is_key ||
+        col == DecodePlan::kSkip) {
+      continue;
+    }
+    BufView at(key.data(), offsets[i + 1], this->le_);
+    at.SetReadOffset(offsets[i]);
+    column.schema->DecodeKey(at, sink, col);
+  }
+  return 0;
+}
+
+int RecordDecoderV2::DecodeKey(std::string_view key,
+                               const std::vector<uint32_t>& offsets,
+                               const DecodePlan& plan,
+                               std::vector<ColumnValue>& record) const {
+  record.resize(plan.OutputSize());
+  ColumnValueSink sink(record);
+  return DecodeKey(key, offsets, plan, sink);
+}
+
+int RecordDecoderV2::Evaluate(std::string_view key,
+                              const std::vector<uint32_t>& offsets,
+                              const EncodedPredicate& predicate,
+                              bool& matched) const {
+  int pos = predicate.Column();
+  if (pos < 0 || static_cast<size_t>(pos) >= columns_.size() ||
+      columns_[pos].schema == nullptr || !columns_[pos].is_key ||
+      offsets.size() != columns_.size() + 1) {
+    return -1;
+  }
+
+  BufView at(key.data(), offsets[pos + 1], this->le_);
+  at.SetReadOffset(offsets[pos]);
+  PredicateSink sink(predicate);
+  columns_[pos].schema->DecodeKey(at, sink, pos);
+  matched = sink.Matched();
+  return 0;
+}
+
+int RecordDecoderV2::Evaluate(std::string_view key, std::string_view value,
+                              const EncodedPredicate& predicate,
+                              bool& matched) const {
+  int pos = predicate.Column();
+  if (pos < 0 || static_cast<size_t>(pos) >= columns_.size()) {
+    return -1;
+  }
+
+  if (!Inflate(value, ThreadScratch())) {
+    return -1;
+  }
+  BufView key_buf(key, this->le_);
+  BufView value_buf(value, this->le_);
+
+  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
+      !CheckSchemaVersion(value_buf)) {
+    return -1;
+  }
+
+  const auto& column = columns_[pos];
+  if (column.schema == nullptr) {
+    matched = predicate.MatchNull();
+    return 0;
+  }
+
+  PredicateSink sink(predicate);
+  if (column.is_key) {
+    for (int i = 0; i < pos; ++i) {
+      if (columns_[i].schema != nullptr && columns_[i].is_key) {
+        columns_[i].SkipKey(key_buf);
+      }
+    }
+    column.schema->DecodeKey(key_buf, sink, pos);
+  } else {
+    ValueHeader value_header;
+    ReadValueHeader(value_buf, value_header);
+    int offset = value_header.total_col_cnt == value_header.cnt_null_col
+                     ? -1
+                     : GetValueOffset(column, value_buf, value_header);
+    if (offset == -1) {
+      sink.OnNull(pos);
+    } else {
+      column.schema->DecodeValue(value_buf, offset, sink, pos);
+    }
+  }
+
+  matched = sink.Matched();
+  return 0;
+}
+
+int RecordDecoderV2::LocateValue(std::string_view key, std::string_view& value,
+                                 int column, BaseSchema::Type type,
+                                 int& offset) const {
+  if (column < 0 || static_cast<size_t>(column) >= columns_.size()) {
+    return -1;
+  }
+  const auto& col = columns_[column];
+  if (col.schema == nullptr || col.is_key || col.type != type) {
+    return -1;
+  }
+
+  BufView key_buf(key, this->le_);
+  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf)) {
+    return -1;
+  }
+  return LocateValue(value, col, offset);
+}
+
+int RecordDecoderV2::LocateValue(std::string_view& value, const Column& column,
+                                 int& offset) const {
+  if (!Inflate(value, ThreadScratch())) {
+    return -1;
+  }
+  BufView value_buf(value, this->le_);
+  if (!CheckSchemaVersion(value_buf)) {
+    return -1;
+  }
+
+  ValueHeader value_header;
+  ReadValueHeader(value_buf, value_header);
+  offset = value_header.total_col_cnt == value_header.cnt_null_col
+               ? -1
+               : GetValueOffset(column, value_buf, value_header);
+  return 0;
+}
+
+template <typename View>
+int RecordDecoderV2::DecodeView(std::string_view key, std::string_view value,
+                                int column, BaseSchema::Type type,
+                                View& view) const {
+  int offset = -1;
+  if (LocateValue(key, value, column, type, offset) < 0) {
+    return -1;
+  }
+
+  view = View();
+  if (offset == -1) {
+    return 0;
+  }
+  if (offset < 0 || static_cast<size_t>(offset) >= value.size()) {
+    throw std::runtime_error("Out of range.");
+  }
+  if constexpr (!std::is_same_v<View, EncodedStringListView>) {
+    // A quantized or series encoded list, flagged in its count, has no view.
+    BufView value_buf(value, this->le_);
+    if (static_cast<size_t>(offset) + 4 <= value.size() &&
+        value_buf.ReadInt(offset) < 0) {
+      return -1;
+    }
+  }
+  if (!view.Reset(value.data() + offset, value.size() - offset, this->le_)) {
+    throw std::runtime_error("Out of range.");
+  }
+  return 0;
+}
+
+int RecordDecoderV2::DecodeListView(std::string_view key,
+                                    std::string_view value, int column,
+                                    EncodedListView<int32_t>& view) const {
+  return DecodeView(key, value, column, BaseSchema::kIntegerList, view);
+}
+
+int RecordDecoderV2::DecodeListView(std::string_view key,
+                                    std::string_view value, int column,
+                                    EncodedListView<int64_t>& view) const {
+  return DecodeView(key, value, column, BaseSchema::kLongList, view);
+}
+
+int RecordDecoderV2::DecodeListView(std::string_view key,
+                                    std::string_view value, int column,
+                                    EncodedListView<float>& view) const {
+  return DecodeView(key, value, column, BaseSchema::kFloatList, view);
+}
+
+int RecordDecoderV2::DecodeListView(std::string_view key,
+                                    std::string_view value, int column,
+                                    EncodedListView<double>& view) const {
+  return DecodeView(key, value, column, BaseSchema::kDoubleList, view);
+}
+
+int RecordDecoderV2::DecodeListView(std::string_view key,
+                                    std::string_view value, int column,
+                                    EncodedStringListView& view) const {
+  return DecodeView(key, value, column, BaseSchema::kStringList, view);
+}
+
+template <typename T>
+int RecordDecoderV2::DecodeRange(std::string_view key, std::string_view value,
+                                 int column, BaseSchema::Type type,
+                                 size_t begin, size_t end,
+                                 std::vector<T>& data) const {
+  int offset = -1;
+  if (LocateValue(key, value, column, type, offset) < 0) {
+    return -1;
+  }
+
+  data.clear();
+  if (offset == -1) {
+    return 0;
+  }
+  if (offset < 0 || static_cast<size_t>(offset) >= value.size()) {
+    throw std::runtime_error("Out of range.");
+  }
+  BufView value_buf(value, this->le_);
+  static_cast<DingoSchema<std::vector<T>>*>(columns_[column].schema)
+      ->DecodeRange(value_buf, offset, begin, end, data);
+  return 0;
+}
+
+int RecordDecoderV2::DecodeListRange(std::string_view key,
+                                     std::string_view value, int column,
+                                     size_t begin, size_t end,
+                                     std::vector<bool>& data) const {
+  return DecodeRange(key, value, column, BaseSchema::kBoolList, begin, end,
+                     data);
+}
+
+int RecordDecoderV2::DecodeListRange(std::string_view key,
+                                     std::string_view value, int column,
+                                     size_t begin, size_t end,
+                                     std::vector<int32_t>& data) const {
+  return DecodeRange(key, value, column, BaseSchema::kIntegerList, begin, end,
+                     data);
+}
+
+int RecordDecoderV2::DecodeListRange(std::string_view key,
+                                     std::string_view value, int column,
+                                     size_t begin, size_t end,
+                                     std::vector<int64_t>& data) const {
+  return DecodeRange(key, value, column, BaseSchema::kLongList, begin, end,
+                     data);
+}
+
+int RecordDecoderV2::DecodeListRange(std::string_view key,
+                                     std::string_view value, int column,
+                                     size_t begin, size_t end,
+                                     std::vector<float>& data) const {
+  return DecodeRange(key, value, column, BaseSchema::kFloatList, begin, end,
+                     data);
+}
+
+int RecordDecoderV2::DecodeListRange(std::string_view key,
+                                     std::string_view value, int column,
+                                     size_t begin, size_t end,
+                                     std::vector<double>& data) const {
+  return DecodeRange(key, value, column, BaseSchema::kDoubleList, begin, end,
+                     data);
+}
+
+int RecordDecoderV2::ListLength(std::string_view key, std::string_view value,
+                                int column, int& length) const {
+  if (column < 0 || static_cast<size_t>(column) >= columns_.size() ||
+      columns_[column].schema == nullptr ||
+      columns_[column].type < BaseSchema::kBoolList) {
+    return -1;
+  }
+  // the lists share the element count in front, the top bit flags another
+  // form of the elements.
+  int offset = -1;
+  if (LocateValue(key, value, column, columns_[column].type, offset) < 0) {
+    return -1;
+  }
+
+  length = -1;
+  if (offset != -1) {
+    BufView value_buf(value, this->le_);
+    length = static_cast<uint32_t>(value_buf.ReadInt(offset)) & 0x7FFFFFFF;
+  }
+  return 0;
+}
+
+int RecordDecoderV2::DecodeStringView(std::string_view key,
+                                      std::string_view value, int column,
+                                      std::string_view& view) const {
+  int offset = -1;
+  if (LocateValue(key, value, column, BaseSchema::kString, offset) < 0) {
+    return -1;
+  }
+
+  view = std::string_view();
+  if (offset != -1) {
+    BufView value_buf(value, this->le_);
+    view = static_cast<DingoSchema<std::string>*>(columns_[column].schema)
+               ->DecodeValueView(value_buf, offset);
+  }
+  return 0;
+}
+
+int RecordDecoderV2::DecodeDictionaryCode(std::string_view key,
+                                          std::string_view value, int column,
+                                          int32_t& code) const {
+  int offset = -1;
+  if (LocateValue(key, value, column, BaseSchema::kString, offset) < 0) {
+    return -1;
+  }
+
+  code = StringDictionary::kNoCode;
+  if (offset != -1) {
+    BufView value_buf(value, this->le_);
+    code = static_cast<DingoSchema<std::string>*>(columns_[column].schema)
+               ->DecodeCode(value_buf, offset);
+  }
+  return 0;
+}
+
+int RecordDecoderV2::Distance(std::string_view key, std::string_view value,
+                              int column, DistanceMetric metric,
+                              const float* query, size_t dim,
+                              float& distance) const {
+  int offset = -1;
+  if (LocateValue(key, value, column, BaseSchema::kFloatList, offset) < 0) {
+    return -1;
+  }
+  if (offset == -1) {
+    distance = std::numeric_limits<float>::quiet_NaN();
+    return 0;
+  }
+
+  BufView value_buf(value, this->le_);
+  auto layout = DingoSchema<std::vector<float>>::ReadLayout(value_buf, offset);
+  if (layout.size != dim) {
+    return -1;
+  }
+
+  distance = serialV2::Distance(metric, layout.quantization,
+                                value.data() + layout.data_offset, layout.scale,
+                                query, dim, this->le_);
+  return 0;
+}
+
+int RecordDecoderV2::DistanceBatch(const KeyValue* key_values, size_t count,
+                                   int column, DistanceMetric metric,
+                                   const float* query, size_t dim,
+                                   float* distances) const {
+  for (size_t i = 0; i < count; ++i) {
+    if (Distance(key_values[i].GetKey(), key_values[i].GetValue(), column,
+                 metric, query, dim, distances[i]) < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int RecordDecoderV2::DecodeEmbeddings(const KeyValue* key_values,
+                                      size_t count, int column, size_t dim,
+                                      float* matrix, size_t stride,
+                                      uint8_t* nulls,
+                                      const ParallelOptions& options) const {
+  if (column < 0 || static_cast<size_t>(column) >= columns_.size() ||
+      columns_[column].schema == nullptr ||
+      columns_[column].type != BaseSchema::kFloatList || stride < dim) {
+    return -1;
+  }
+
+  std::atomic<bool> failed{false};
+  ParallelFor(count, options, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      float* row = matrix + i * stride;
+      std::string_view key = key_values[i].GetKey();
+      std::string_view value = key_values[i].GetValue();
+      int offset = -1;
+      bool null = false;
+      bool ok = LocateValue(key, value, column, BaseSchema::kFloatList,
+                            offset) >= 0;
+      if (ok && offset == -1) {
+        null = true;
+      } else if (ok) {
+        BufView value_buf(value, this->le_);
+        auto layout =
+            DingoSchema<std::vector<float>>::ReadLayout(value_buf, offset);
+        ok = layout.size == dim;
+        if (ok) {
+          Dequantize(layout.quantization, value.data() + layout.data_offset,
+                     dim, layout.scale, row, this->le_);
+        }
+      }
+      if (!ok || null) {
+        std::fill(row, row + dim, 0.0f);
+      }
+      if (!ok) {
+        failed.store(true, std::memory_order_relaxed);
+      }
+      if (nulls != nullptr) {
+        nulls[i] = null ? 1 : 0;
+      }
+    }
+  });
+  return failed.load() ? -1 : 0;
+}
+
+// Rows whose number words are gathered before they are swapped and added up.
+constexpr size_t kAggregateChunk = 256;
+
+template <typename T>
+static void AggregateNumbers(const T* values, size_t count,
+                             ColumnAggregate& result) {
+  if constexpr (std::is_integral_v<T>) {
+    uint64_t sum = 0;
+    int64_t min = result.int_min;
+    int64_t max = result.int_max;
+    for (size_t i = 0; i < count; ++i) {
+      sum += static_cast<uint64_t>(static_cast<int64_t>(values[i]));
+      min = std::min<int64_t>(min, values[i]);
+      max = std::max<int64_t>(max, values[i]);
+    }
+    result.int_sum = static_cast<int64_t>(static_cast<uint64_t>(result.int_sum) + sum);
+    result.int_min = min;
+    result.int_max = max;
+  } else {
+    double sum = 0;
+    double min = result.min;
+    double max = result.max;
+    for (size_t i = 0; i < count; ++i) {
+      double value = values[i];
+      sum += value;
+      // comparisons with NaN are false, it is not ranked.
+      min = value < min ? value : min;
+      max = value > max ? value : max;
+    }
+    result.sum += sum;
+    result.min = min;
+    result.max = max;
+  }
+}
+
+// words are count values of T in buffer byte order, swapped when swap.
+template <typename T>
+static void AggregateWords(const char* words, size_t count, bool swap,
+                           ColumnAggregate& result) {
+  T values[kAggregateChunk];
+  if constexpr (sizeof(T) == 4) {
+    CopyWords32(reinterpret_cast<char*>(values), words, count, swap);
+  } else {
+    CopyWords64(reinterpret_cast<char*>(values), words, count, swap);
+  }
+  AggregateNumbers(values, count, result);
+}
+
+static void AggregateWords(BaseSchema::Type type, const char* words,
+                           size_t count, bool swap, ColumnAggregate& result) {
+  switch (type) {
+    case BaseSchema::kInteger:
+      AggregateWords<int32_t>(words, count, swap, result);
+      break;
+    case BaseSchema::kLong:
+      AggregateWords<int64_t>(words, count, swap, result);
+      break;
+    case BaseSchema::kFloat:
+      AggregateWords<float>(words, count, swap, result);
+      break;
+    case BaseSchema::kDouble:
+      AggregateWords<double>(words, count, swap, result);
+      break;
+    default:
+      break;
+  }
+}
+
+template <typename Row>
+int RecordDecoderV2::AggregateRows(const Row* rows, size_t count, int column,
+                                   ColumnAggregate& result) const {
+  if (column < 0 || static_cast<size_t>(column) >= columns_.size()) {
+    return -1;
+  }
+  const auto& col = columns_[column];
+  if (col.schema == nullptr || col.is_key) {
+    return -1;
+  }
+
+  bool number = col.type == BaseSchema::kInteger ||
+                col.type == BaseSchema::kLong ||
+                col.type == BaseSchema::kFloat ||
+                col.type == BaseSchema::kDouble;
+  // 0 for a varint, read by its schema.
+  int width = number ? col.value_length : 0;
+
+  char words[kAggregateChunk * 8];
+  size_t pending = 0;
+  for (size_t i = 0; i < count; ++i) {
+    std::string_view value;
+    if constexpr (std::is_same_v<Row, KeyValue>) {
+      BufView key_buf(rows[i].GetKey(), this->le_);
+      if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf)) {
+        AggregateWords(col.type, words, pending, this->le_, result);
+        return -1;
+      }
+      value = rows[i].GetValue();
+    } else {
+      value = rows[i];
+    }
+
+    int offset = -1;
+    if (LocateValue(value, col, offset) < 0) {
+      AggregateWords(col.type, words, pending, this->le_, result);
+      return -1;
+    }
+    if (offset == -1) {
+      result.null_count++;
+      continue;
+    }
+    result.count++;
+    if (!number) {
+      continue;
+    }
+
+    if (width == 0) {
+      BufView value_buf(value, this->le_);
+      std::any data = col.schema->DecodeValue(value_buf, offset);
+      if (col.type == BaseSchema::kInteger) {
+        AggregateNumbers(&std::any_cast<const int32_t&>(data), 1, result);
+      } else {
+        AggregateNumbers(&std::any_cast<const int64_t&>(data), 1, result);
+      }
+      continue;
+    }
+
+    if (DINGO_UNLIKELY(offset < 0 ||
+                       static_cast<size_t>(offset) + width > value.size())) {
+      throw std::runtime_error("Out of range.");
+    }
+    memcpy(words + pending * width, value.data() + offset, width);
+    if (++pending == kAggregateChunk) {
+      AggregateWords(col.type, words, pending, this->le_, result);
+      pending = 0;
+    }
+  }
+  AggregateWords(col.type, words, pending, this->le_, result);
+  return 0;
+}
+
+int RecordDecoderV2::Aggregate(const KeyValue* key_values, size_t count,
+                               int column, ColumnAggregate& result) const {
+  return AggregateRows(key_values, count, column, result);
+}
+
+int RecordDecoderV2::Aggregate(const std::string_view* values, size_t count,
+                               int column, ColumnAggregate& result) const {
+  return AggregateRows(values, count, column, result);
+}
+
+// Keeps the number a value schema hands over, as int64_t or double.
+template <typename T>
+class PeekSink : public RowSink {
+ public:
+  explicit PeekSink(std::optional<T>& data) : data_(data) {}
+
+  void OnNull(int) override { data_.reset(); }
+  void OnBool(int, bool value) override { data_ = value; }
+  void OnInt32(int, int32_t value) override { data_ = value; }
+  void OnInt64(int, int64_t value) override { data_ = value; }
+  void OnFloat(int, float value) override { data_ = value; }
+  void OnDouble(int, double value) override { data_ = value; }
+  void OnString(int, std::string_view) override {}
+
+  void OnBoolList(int, std::vector<bool>&&) override {}
+  void OnInt32List(int, std::vector<int32_t>&&) override {}
+  void OnInt64List(int, std::vector<int64_t>&&) override {}
+  void OnFloatList(int, std::vector<float>&&) override {}
+  void OnDoubleList(int, std::vector<double>&&) override {}
+  void OnStringList(int, std::vector<std::string>&&) override {}
+
+ private:
+  std::optional<T>& data_;
+};
+
+ColumnPeek RecordDecoderV2::NewColumnPeek(int column) const {
+  if (column < 0 || static_cast<size_t>(column) >= columns_.size() ||
+      columns_[column].schema == nullptr || columns_[column].is_key) {
+    throw std::runtime_error("Peek column is no value column.");
+  }
+  BaseSchema::Type type = columns_[column].type;
+  if (type != BaseSchema::kBool && type != BaseSchema::kInteger &&
+      type != BaseSchema::kLong && type != BaseSchema::kFloat &&
+      type != BaseSchema::kDouble) {
+    throw std::runtime_error("Peek column is no fixed width column.");
+  }
+  return ColumnPeek{column, type};
+}
+
+template <typename T>
+int RecordDecoderV2::PeekNumber(const ColumnPeek& peek, std::string_view value,
+                                std::optional<T>& data) const {
+  if (peek.column < 0 ||
+      static_cast<size_t>(peek.column) >= columns_.size() ||
+      columns_[peek.column].type != peek.type) {
+    return -1;
+  }
+  bool integral = peek.type == BaseSchema::kBool ||
+                  peek.type == BaseSchema::kInteger ||
+                  peek.type == BaseSchema::kLong;
+  if (integral != std::is_integral_v<T>) {
+    return -1;
+  }
+
+  const auto& col = columns_[peek.column];
+  int offset = -1;
+  if (LocateValue(value, col, offset) < 0) {
+    return -1;
+  }
+  data.reset();
+  if (offset == -1) {
+    return 0;
+  }
+  if (DINGO_UNLIKELY(offset < 0 ||
+                     static_cast<size_t>(offset) >= value.size())) {
+    throw std::runtime_error("Out of range.");
+  }
+  BufView value_buf(value, this->le_);
+  PeekSink<T> sink(data);
+  col.schema->DecodeValue(value_buf, offset, sink, peek.column);
+  return 0;
+}
+
+int RecordDecoderV2::Peek(const ColumnPeek& peek, std::string_view value,
+                          std::optional<int64_t>& data) const {
+  return PeekNumber(peek, value, data);
+}
+
+int RecordDecoderV2::Peek(const ColumnPeek& peek, std::string_view value,
+                          std::optional<double>& data) const {
+  return PeekNumber(peek, value, data);
+}
+
+int RecordDecoderV2::ValueOffset(const Column& column, BufView& value_buf,
+                                 const ValueHeader& value_header) const {
+  return GetValueOffset(column, value_buf, value_header);
+}
+
+DecodePlan RecordDecoderV2::NewDecodePlan(
+    const std::unordered_map<int, int>& column_indexes_serial) const {
+  return DecodePlan(schemas_, column_indexes_serial);
+}
+
+int RecordDecoderV2::Decode(std::string_view key, std::string_view value,
+                            const DecodePlan& plan,
+                            std::vector<std::any>& record) const {
+  DINGO_SERIAL_PROBE4(decode_projected_start, common_id_, schema_version_,
+                      key.size(), value.size());
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  if (plan.SchemaCount() != schemas_.size()) {
+    return DecodeFailure();
+  }
+
+  if (!Inflate(value, ThreadScratch())) {
+    return DecodeFailure();
+  }
+  BufView key_buf(key, this->le_);
+  BufView value_buf(value, this->le_);
+
+  if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
+      !CheckSchemaVersion(value_buf)) {
+    return DecodeFailure();
+  }
+
+  ValueHeader value_header;
+  ReadValueHeader(value_buf, value_header);
+  if (value_header.total_col_cnt != value_header.cnt_null_col) {
+    value_buf.SetReadOffset(value_header.data_pos);
+  }
+
+  record.resize(plan.OutputSize());
+
+  for (size_t i = 0; i < plan.KeyEnd(); ++i) {
+    const auto& column = columns_[i];
+    if (column.schema == nullptr || !column.is_key) {
+      continue;
+    }
+
+    int result_index = plan.Slot(i);
+    DecodeOrSkip(column, key_buf, value_buf, record, result_index,
+                 result_index == DecodePlan::kSkip, value_header);
+  }
+  for (size_t i : plan.ValueColumns()) {
+    DecodeOrSkip(columns_[i], key_buf, value_buf, record, plan.Slot(i), false,
+                 value_header);
+  }
 
+  DINGO_CODEC_STATS(stats_,
+                    AddDecode(key.size() + value.size(), plan.OutputSize(),
+                              columns_.size() - plan.OutputSize(),
+                              sample_start));
+  DINGO_SERIAL_PROBE3(decode_projected_done, common_id_, schema_version_,
+                      plan.OutputSize());
   return 0;
 }
 
 int RecordDecoderV2::Decode(const KeyValue& key_value,
                             std::unordered_map<int, int>& column_indexes_serial,
-                            std::vector<std::any>& record) {
+                            std::vector<std::any>& record) const {
   return Decode(key_value.GetKey(), key_value.GetValue(), column_indexes_serial,
                 record);
 }
@@ -17,17 +17,28 @@
 
 #include <map>
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 
 #include "any"
 #include "common.h"
 #include "functional"                              // IWYU pragma: keep
 #include "optional"                                // IWYU pragma: keep
+#include "serial/record/V2/column_aggregate.h"
+#include "serial/record/V2/column_batch.h"
+#include "serial/record/V2/column_descriptor.h"
+#include "serial/record/V2/column_group.h"
+#include "serial/record/V2/decode_plan.h"
+#include "serial/record/V2/encoded_batch.h"
+#include "serial/record/V2/encoded_predicate.h"
+#include "serial/record/V2/lazy_record.h"
+#include "serial/record/V2/value_header.h"
 #include "serial/schema/V2/boolean_list_schema.h"  // IWYU pragma: keep
 #include "serial/schema/V2/boolean_schema.h"       // IWYU pragma: keep
 #include "serial/schema/V2/double_list_schema.h"   // IWYU pragma: keep
 #include "serial/schema/V2/double_list_schema.h"
 #include "serial/schema/V2/double_schema.h"        // IWYU pragma: keep
+#include "serial/schema/V2/encoded_list_view.h"
 #include "serial/schema/V2/float_list_schema.h"    // IWYU pragma: keep
 #include "serial/schema/V2/float_schema.h"         // IWYU pragma: keep
 #include "serial/schema/V2/integer_list_schema.h"  // IWYU pragma: keep
@@ -36,7 +47,12 @@
 #include "serial/schema/V2/long_schema.h"          // IWYU pragma: keep
 #include "serial/schema/V2/string_list_schema.h"   // IWYU pragma: keep
 #include "serial/schema/V2/string_schema.h"        // IWYU pragma: keep
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/codec_stats.h"
+#include "serial/utils/V2/compression.h"
+#include "serial/utils/V2/float_distance.h"
 #include "serial/utils/V2/keyvalue.h"              // IWYU pragma: keep
+#include "serial/utils/V2/parallel.h"
 #include "serial/utils/V2/keyvalue.h"
 #include "serial/utils/V2/utils.h"  // IWYU pragma: keep
 #include "serial/utils/V2/utils.h"  // IWYU pragma: keep
@@ -47,6 +63,16 @@ namespace serialV2 {
 class RecordDecoderV2;
 using RecordDecoderPtr = std::shared_ptr<RecordDecoderV2>;
 
+// A fixed width value column resolved for RecordDecoderV2::Peek.
+struct ColumnPeek {
+  int column{-1};
+  BaseSchema::Type type{BaseSchema::kLong};
+};
+
+// Immutable once constructed, every decode keeps its state on the stack, in
+// the caller's outputs or in per thread buffers, so one decoder may serve all
+// threads at once. Construction formats the schemas for le, they must not be
+// changed while the decoder is in use, nor SetStats called.
 class RecordDecoderV2 {
  public:
   RecordDecoderV2(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
@@ -61,38 +87,393 @@ class RecordDecoderV2 {
                                              common_id);
   }
 
-  bool dataIsNull(int id);
+  // Count the std::any decodes and their failures in stats, nullptr stops
+  // counting. Only with DINGO_SERIAL_CODEC_STATS, see codec_stats.h.
+  void SetStats(CodecStats* stats) { stats_ = stats; }
+
+  // Trust the values decoded, as for rows read back from checksummed
+  // storage: the tables of a value are checked to be in range once per row
+  // and then read unchecked, and the number columns are read at their offsets
+  // unchecked into the record. Keep the default for input from the network,
+  // a corrupt trusted value is undefined behaviour. Call before use, as
+  // SetStats.
+  void SetTrustedInput(bool trusted);
+  bool IsTrustedInput() const { return trusted_input_; }
+
+  // Verify the checksum trailer of every value before decoding it, see
+  // RecordEncoderV2::SetChecksum: a value without one or whose trailer
+  // differs is rejected with -1, and the values verified are trusted, as by
+  // SetTrustedInput(verify). Call before use, as SetStats.
+  void SetVerifyChecksums(bool verify);
+  bool IsVerifyingChecksums() const { return verify_checksums_; }
+
+  // Rows ahead of the one decoded whose key and value header DecodeBatch into
+  // a ColumnBatch prefetches, 0 for none. Call before use, as SetStats.
+  static constexpr int kDefaultPrefetchDistance = 4;
+  void SetPrefetchDistance(int rows);
+  int GetPrefetchDistance() const { return prefetch_distance_; }
+
+  // The null state of a column without a decode is peeked at with
+  // PeekIsNull, see row_peek.h.
   int Decode(const KeyValue& key_value,
-             std::vector<std::any>& record /*output*/);
+             std::vector<std::any>& record /*output*/) const;
   int Decode(const std::string& key, const std::string& value,
-             std::vector<std::any>& record /*output*/);
+             std::vector<std::any>& record /*output*/) const;
   int Decode(std::string&& key, std::string&& value,
-             std::vector<std::any>& record /*output*/);
+             std::vector<std::any>& record /*output*/) const;
   int DecodeKey(const std::string& key,
-                std::vector<std::any>& record /*output*/);
+                std::vector<std::any>& record /*output*/) const;
+
+  // Zero-copy decode, key and value bytes are read in place and must outlive
+  // the call.
+  int Decode(std::string_view key, std::string_view value,
+             std::vector<std::any>& record /*output*/) const;
+  int DecodeKey(std::string_view key,
+                std::vector<std::any>& record /*output*/) const;
 
   int Decode(const KeyValue& key_value,
              std::unordered_map<int, int>& column_indexes_serial,
-             std::vector<std::any>& record /*output*/);
+             std::vector<std::any>& record /*output*/) const;
 
   int Decode(const std::string& key, const std::string& value,
              std::unordered_map<int, int>& column_indexes_serial,
-             std::vector<std::any>& record /*output*/);
+             std::vector<std::any>& record /*output*/) const;
+  int Decode(std::string_view key, std::string_view value,
+             std::unordered_map<int, int>& column_indexes_serial,
+             std::vector<std::any>& record /*output*/) const;
+
+  // Projected decode with a plan built once from column_indexes_serial, see
+  // NewDecodePlan. Returns -1 when the plan was built for other schemas.
+  int Decode(std::string_view key, std::string_view value,
+             const DecodePlan& plan,
+             std::vector<std::any>& record /*output*/) const;
+  DecodePlan NewDecodePlan(
+      const std::unordered_map<int, int>& column_indexes_serial) const;
+
+  // Typed decode without std::any, every column is passed to sink. The full
+  // decode uses the schema index as column, the projected one the plan slot.
+  int Decode(std::string_view key, std::string_view value,
+             RowSink& sink) const;
+  int Decode(std::string_view key, std::string_view value,
+             const DecodePlan& plan, RowSink& sink) const;
+
+  // Decode into a record of ColumnValue, see column_value.h, resized to the
+  // schema count (the full decode, by schema index) or the plan output size.
+  // The strings and lists the record already holds are reused for the
+  // columns of the same type.
+  int Decode(std::string_view key, std::string_view value,
+             std::vector<ColumnValue>& record /*output*/) const;
+  int Decode(std::string_view key, std::string_view value,
+             const DecodePlan& plan,
+             std::vector<ColumnValue>& record /*output*/) const;
+
+  // Decode the projected columns of many rows into typed column arrays,
+  // column at a time. Returns -1 when any row fails the checks.
+  int DecodeBatch(const KeyValue* key_values, size_t count,
+                  const DecodePlan& plan,
+                  ColumnBatch& batch /*output*/) const;
+  int DecodeBatch(const std::vector<KeyValue>& key_values,
+                  const DecodePlan& plan,
+                  ColumnBatch& batch /*output*/) const;
+  // The rows of an encoded batch, read in place from its arena. The strings
+  // and lists land in the buffers of batch rather than a string or vector
+  // per value.
+  int DecodeBatch(const EncodedBatch& rows, const DecodePlan& plan,
+                  ColumnBatch& batch /*output*/) const;
+
+  // Two phase scan of rows filtered on key columns. SelectByKey sets
+  // selection to the rows of key_values whose key matches every predicate,
+  // in order, reading the key bytes alone. The projected DecodeBatch then
+  // decodes the selected rows only, row r of batch is key_values[
+  // selection[r]], the values of the others are never touched. Returns -1
+  // when a predicate is on no key column of the schemas or a key fails the
+  // checks.
+  int SelectByKey(const KeyValue* key_values, size_t count,
+                  const std::vector<EncodedPredicate>& predicates,
+                  std::vector<uint32_t>& selection /*output*/) const;
+  int SelectByKey(const std::vector<KeyValue>& key_values,
+                  const std::vector<EncodedPredicate>& predicates,
+                  std::vector<uint32_t>& selection /*output*/) const;
+  int DecodeBatch(const KeyValue* key_values,
+                  const std::vector<uint32_t>& selection,
+                  const DecodePlan& plan,
+                  ColumnBatch& batch /*output*/) const;
+  int DecodeBatch(const std::vector<KeyValue>& key_values,
+                  const std::vector<uint32_t>& selection,
+                  const DecodePlan& plan,
+                  ColumnBatch& batch /*output*/) const;
+
+  // Decode count rows into records, resized to count, spread over the
+  // workers of options. Returns -1 when any row fails the checks, the other
+  // rows are decoded still.
+  int DecodeBatch(const KeyValue* key_values, size_t count,
+                  std::vector<std::vector<std::any>>& records /*output*/,
+                  const ParallelOptions& options = {}) const;
+
+  // Decode a row split into column groups, see RecordEncoderV2::
+  // EncodeColumnGroups. key is the key of the row and values[g] the value
+  // stored under ColumnGroupKey(key, g). Group 0 must be given, a group left
+  // out (an empty view, or past the end of values) decodes its columns as
+  // null, the projected form is meant to be given the groups of ColumnGroups.
+  int DecodeColumnGroups(std::string_view key,
+                         const std::vector<std::string_view>& values,
+                         std::vector<std::any>& record /*output*/) const;
+  int DecodeColumnGroups(std::string_view key,
+                         const std::vector<std::string_view>& values,
+                         std::unordered_map<int, int>& column_indexes_serial,
+                         std::vector<std::any>& record /*output*/) const;
+  // The groups to read for the projection, ascending, group 0 always first.
+  std::vector<int> ColumnGroups(
+      const std::unordered_map<int, int>& column_indexes_serial) const;
+
+  // Check the row and parse its value header, the columns are decoded when
+  // first asked for through record.
+  int DecodeLazy(std::string_view key, std::string_view value,
+                 LazyRecordV2& record /*output*/) const;
+
+  // Random access into the key columns of one key. IndexKey sets offsets to
+  // one entry per schema plus one, column i spanning [offsets[i],
+  // offsets[i + 1]) of key with its null flag, empty for value and null
+  // columns. They are found in one scan: fixed width columns by their length
+  // and strings by their markers, nothing is decoded. The offsets serve any
+  // number of the calls below on the same key, which read their column in
+  // place. Returns -1 when the key fails the checks or ends early.
+  int IndexKey(std::string_view key,
+               std::vector<uint32_t>& offsets /*output*/) const;
+  // The projected key columns of plan, the value columns are left alone.
+  // Returns -1 when plan or offsets were built for other schemas.
+  int DecodeKey(std::string_view key, const std::vector<uint32_t>& offsets,
+                const DecodePlan& plan, RowSink& sink) const;
+  int DecodeKey(std::string_view key, const std::vector<uint32_t>& offsets,
+                const DecodePlan& plan,
+                std::vector<ColumnValue>& record /*output*/) const;
+  // Returns -1 when predicate is on no key column.
+  int Evaluate(std::string_view key, const std::vector<uint32_t>& offsets,
+               const EncodedPredicate& predicate, bool& matched /*output*/) const;
+
+  // Evaluate predicate on the encoded row, only its column is read and no
+  // record is built. Returns -1 when the row fails the checks.
+  int Evaluate(std::string_view key, std::string_view value,
+               const EncodedPredicate& predicate, bool& matched /*output*/) const;
+
+  // Views into a list column of value, nothing is decoded up front and the
+  // bytes must outlive the view, for a compressed value the view points into a
+  // per thread buffer overwritten by the next decode. A null column gives a
+  // null view. Returns -1
+  // when the row fails the checks, column is no list of that element type, a
+  // quantized float list or a series encoded list.
+  int DecodeListView(std::string_view key, std::string_view value, int column,
+                     EncodedListView<int32_t>& view /*output*/) const;
+  int DecodeListView(std::string_view key, std::string_view value, int column,
+                     EncodedListView<int64_t>& view /*output*/) const;
+  int DecodeListView(std::string_view key, std::string_view value, int column,
+                     EncodedListView<float>& view /*output*/) const;
+  int DecodeListView(std::string_view key, std::string_view value, int column,
+                     EncodedListView<double>& view /*output*/) const;
+  int DecodeListView(std::string_view key, std::string_view value, int column,
+                     EncodedStringListView& view /*output*/) const;
+
+  // The string column of value without a copy, for hashing or comparing it:
+  // view points into value, or into the dictionary for a code, and is valid
+  // while they live, for a compressed value into a per thread buffer
+  // overwritten by the next decode. view.data() is nullptr for null. Returns
+  // -1 when the row fails the checks or column is no string value.
+  int DecodeStringView(std::string_view key, std::string_view value,
+                       int column, std::string_view& view /*output*/) const;
+
+  // Elements [begin, end) of a list column of value, end clamped to the list
+  // size, such as list[i] or its last n elements: only their bytes are read,
+  // a series encoded list is decoded whole. A null column gives no elements,
+  // ListLength tells it from an empty list. Returns -1 when the row fails the
+  // checks or column is no list of that element type.
+  int DecodeListRange(std::string_view key, std::string_view value, int column,
+                      size_t begin, size_t end,
+                      std::vector<bool>& data /*output*/) const;
+  int DecodeListRange(std::string_view key, std::string_view value, int column,
+                      size_t begin, size_t end,
+                      std::vector<int32_t>& data /*output*/) const;
+  int DecodeListRange(std::string_view key, std::string_view value, int column,
+                      size_t begin, size_t end,
+                      std::vector<int64_t>& data /*output*/) const;
+  int DecodeListRange(std::string_view key, std::string_view value, int column,
+                      size_t begin, size_t end,
+                      std::vector<float>& data /*output*/) const;
+  int DecodeListRange(std::string_view key, std::string_view value, int column,
+                      size_t begin, size_t end,
+                      std::vector<double>& data /*output*/) const;
+
+  // Element count of a list column of value, of any element type and form,
+  // -1 for null. Returns -1 when the row fails the checks or column is no
+  // list.
+  int ListLength(std::string_view key, std::string_view value, int column,
+                 int& length /*output*/) const;
+
+  // Dictionary code of the string column of value, so that rows can be
+  // grouped without resolving the strings. code is StringDictionary::kNoCode
+  // for null or a value missing from the dictionary. Returns -1 when the row
+  // fails the checks or column is no string value.
+  int DecodeDictionaryCode(std::string_view key, std::string_view value,
+                           int column, int32_t& code /*output*/) const;
+
+  // Distance between the float list column of value and a query of dim
+  // floats, computed on the encoded bytes. A null column gives NaN. Returns -1
+  // when the row fails the checks, column is no float list or its size is not
+  // dim.
+  int Distance(std::string_view key, std::string_view value, int column,
+               DistanceMetric metric, const float* query, size_t dim,
+               float& distance /*output*/) const;
+  // Distance for count rows into distances[0, count), stops at the first row
+  // that fails.
+  int DistanceBatch(const KeyValue* key_values, size_t count, int column,
+                    DistanceMetric metric, const float* query, size_t dim,
+                    float* distances /*output*/) const;
+
+  // The float list column of count rows into a matrix for a vector index
+  // build: row i goes to matrix[i * stride, i * stride + dim), stride >= dim
+  // so that rows may be padded to an alignment, each list byte swapped or
+  // dequantized in one pass over its bytes. nulls, when given, gets 1 for a
+  // null row and 0 otherwise, a null row is zero filled. Spread over the
+  // workers of options. Returns -1 when column is no float list or stride is
+  // below dim, or when a row fails the checks or its size is not dim, the
+  // row is then zero filled and the other rows are decoded still.
+  int DecodeEmbeddings(const KeyValue* key_values, size_t count, int column,
+                       size_t dim, float* matrix /*output*/, size_t stride,
+                       uint8_t* nulls /*output*/ = nullptr,
+                       const ParallelOptions& options = {}) const;
+
+  // Add the value column of count rows to result, read at its offset in
+  // each value, the number words of a chunk of rows byte swapped at once, no
+  // row is decoded. Columns of other types than numbers are only counted.
+  // Returns -1 when a row fails the checks, result then holds the rows
+  // before it, or column is no value column.
+  int Aggregate(const KeyValue* key_values, size_t count, int column,
+                ColumnAggregate& result /*output*/) const;
+  // Values alone, the key checks are left out.
+  int Aggregate(const std::string_view* values, size_t count, int column,
+                ColumnAggregate& result /*output*/) const;
+
+  // One bool, int, long, float or double value column read from a value
+  // alone, as a compaction filter deciding expiry from a timestamp column
+  // does: the key is not looked at, the value header and the column are read
+  // in place. NewColumnPeek resolves column once, it throws runtime_error for
+  // a key column or another type. Peek gives data no value for null or a
+  // column the writer lacked; bool, int and long give an int64_t, float and
+  // double a double. Returns -1 when value fails the checks or data is of
+  // the other kind.
+  ColumnPeek NewColumnPeek(int column) const;
+  int Peek(const ColumnPeek& peek, std::string_view value,
+           std::optional<int64_t>& data /*output*/) const;
+  int Peek(const ColumnPeek& peek, std::string_view value,
+           std::optional<double>& data /*output*/) const;
+
   int GetCodecVersion(Buf& buf) const;
+  int GetCodecVersion(BufView& buf) const;
+  int GetSchemaVersion() const { return schema_version_; }
+  long GetCommonId() const { return common_id_; }
+  bool IsLe() const { return le_; }
+  const std::vector<BaseSchemaPtr>& GetSchemas() const { return schemas_; }
+
+  // Bytes the decoder holds, itself and the tables built from its schemas;
+  // the schemas are shared with the caller and not counted.
+  size_t MemoryUsage() const;
+
+  struct Column;
+  using DecodeFunc = void (*)(const Column& column, BufView& key_buf,
+                              BufView& value_buf, std::vector<std::any>& record,
+                              int record_index, bool skip,
+                              ValueHeader& value_header);
+
+  // A column descriptor with its typed decode function resolved at
+  // construction, the per column path needs no RTTI nor shared_ptr copies.
+  struct Column : ColumnDescriptor {
+    DecodeFunc decode;
+    // position in a static offsets value, fixed width columns first, and
+    // offset in its fixed width area, -1 for the other columns.
+    int static_slot{-1};
+    int static_offset{-1};
+  };
 
  private:
-  bool CheckPrefix(Buf& buf) const;
-  bool CheckReverseTag(Buf& buf) const;
-  bool CheckSchemaVersion(Buf& buf) const;
+  friend class ChunkedValueDecoder;
+  friend class LazyRecordV2;
+
+  // -1, counted as a decode failure.
+  int DecodeFailure() const;
+
+  // DecodeBatch over count rows, row_at(r) gives the key and value of row r.
+  template <typename RowAt>
+  int DecodeBatchImpl(size_t count, RowAt row_at, const DecodePlan& plan,
+                      ColumnBatch& batch) const;
+
+  // the decode of a value column for the byte order and trusted_input_.
+  DecodeFunc ValueDecodeFuncOf(BaseSchema* schema) const;
+
+  bool CheckPrefix(BufView& buf) const;
+  bool CheckReverseTag(BufView& buf) const;
+  bool CheckSchemaVersion(BufView& buf) const;
+  void ReadValueHeader(BufView& value_buf, ValueHeader& value_header) const;
+  // Point a compressed value at its decompressed form written to scratch, false
+  // when the compression type is unknown, the checksum is not verified or the
+  // flags and version are rejected, which are checked before inflating.
+  bool Inflate(std::string_view& value, std::string& scratch) const;
+  void DecodeColumn(const Column& column, BufView& key_buf, BufView& value_buf,
+                    ValueHeader& value_header, RowSink& sink, int col) const;
+  int ValueOffset(const Column& column, BufView& value_buf,
+                  const ValueHeader& value_header) const;
+
+  // Offset of the type list column in value, -1 for null. Returns -1 when
+  // the row fails the checks or the column is of another type.
+  // value is turned into the decompressed one.
+  int LocateValue(std::string_view key, std::string_view& value, int column,
+                  BaseSchema::Type type, int& offset) const;
+  // LocateValue for a value alone.
+  int LocateValue(std::string_view& value, const Column& column,
+                  int& offset) const;
+  template <typename Row>
+  int AggregateRows(const Row* rows, size_t count, int column,
+                    ColumnAggregate& result) const;
+  template <typename T>
+  int PeekNumber(const ColumnPeek& peek, std::string_view value,
+                 std::optional<T>& data) const;
+
+  template <typename T>
+  int DecodeRange(std::string_view key, std::string_view value, int column,
+                  BaseSchema::Type type, size_t begin, size_t end,
+                  std::vector<T>& data) const;
+  template <typename View>
+  int DecodeView(std::string_view key, std::string_view value, int column,
+                 BaseSchema::Type type, View& view) const;
 
   bool le_;
-  Buf key_buf_;
-  Buf value_buf_;
+  bool trusted_input_{false};
+  bool verify_checksums_{false};
+  int prefetch_distance_{kDefaultPrefetchDistance};
   int codec_version_{CODEC_VERSION_V2};
+  CodecStats* stats_{nullptr};
   int schema_version_;
   long common_id_;
+  // common_id_ in buffer byte order, as every key holds it behind the prefix.
+  char encoded_common_id_[8];
 
   std::vector<BaseSchemaPtr> schemas_;
+
+  // same positions as schemas_, in one array, schema is nullptr for a null
+  // schema.
+  std::vector<Column> columns_;
+
+  // id table the encoder writes for these schemas, in buffer byte order, and
+  // its 1 byte form (empty when an index does not fit).
+  std::string value_ids_;
+  std::string compact_value_ids_;
+  // index of every value column by value_slot.
+  std::vector<int> value_indexes_;
+  // the same for static offsets values, whose id table lists the fixed width
+  // columns first.
+  std::string static_value_ids_;
+  std::string compact_static_value_ids_;
+  int static_fixed_cnt_{0};
+  // value length by column id, 0 for columns not of fixed width.
+  std::vector<int> fixed_lengths_;
 };
 
 }  // namespace serialV2
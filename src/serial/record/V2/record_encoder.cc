@@ -15,14 +15,23 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <variant>
 
 #include "common.h"
+#include "serial/record/V2/value_header.h"
 
 // #include "common/helper.h"
+#include "serial/utils/V2/byte_order.h"
 #include "serial/utils/V2/keyvalue.h"  // IWYU pragma: keep
+#include "serial/utils/V2/probes.h"
+#include "serial/utils/V2/utils.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -42,24 +51,408 @@ RecordEncoderV2::RecordEncoderV2(int schema_version,
       schema_version_(schema_version),
       common_id_(common_id),
       schemas_(schemas) {
+  Buf common_id_buf(8, le);
+  common_id_buf.WriteLong(common_id);
+  memcpy(encoded_common_id_, common_id_buf.Data(), 8);
+
   FormatSchema(schemas_, le);
+  BuildPlan();
+}
+
+void RecordEncoderV2::Refresh() {
+  FormatSchema(schemas_, le_);
+  BuildPlan();
+}
+
+void RecordEncoderV2::SetCompactValueHeader(bool compact) {
+  compact_value_header_ = compact;
+  BuildPlan();
+}
+
+// Varint values are flagged so that decoders predating them reject the value.
+static bool IsVarintColumn(BaseSchema* schema) {
+  switch (schema->GetType()) {
+    case BaseSchema::kInteger:
+      return static_cast<DingoSchema<int32_t>*>(schema)->IsVarint();
+    case BaseSchema::kLong:
+      return static_cast<DingoSchema<int64_t>*>(schema)->IsVarint();
+    default:
+      return false;
+  }
+}
+
+// The schema calls for either form of a column value.
+static int EncodeSchemaKey(BaseSchema* schema, const std::any& data,
+                           Buf& buf) {
+  return schema->EncodeKey(data, buf);
+}
+static int EncodeSchemaKey(BaseSchema* schema, const ColumnValue& data,
+                           Buf& buf) {
+  return schema->EncodeKeyVariant(data, buf);
+}
+static int SchemaKeyLength(BaseSchema* schema, const std::any& data) {
+  return schema->GetEncodedKeyLength(data);
+}
+static int SchemaKeyLength(BaseSchema* schema, const ColumnValue& data) {
+  return schema->GetEncodedKeyLengthVariant(data);
+}
+static int SchemaValueLength(BaseSchema* schema, const std::any& data) {
+  return schema->GetEncodedValueLength(data);
+}
+static int SchemaValueLength(BaseSchema* schema, const ColumnValue& data) {
+  return schema->GetEncodedValueLengthVariant(data);
+}
+
+static int EncodeSchemaValue(BaseSchema* schema, const std::any& data,
+                             Buf& buf) {
+  return schema->EncodeValue(data, buf);
+}
+static int EncodeSchemaValue(BaseSchema* schema, const ColumnValue& data,
+                             Buf& buf) {
+  return schema->EncodeValueVariant(data, buf);
+}
+
+// Number values are stored as their word in the byte order of the encoder,
+// fixed at plan time instead of looked up per word.
+template <typename T, typename Order, typename Data>
+static int EncodeFixedValue(BaseSchema*, const Data& data, Buf& buf) {
+  size_t pos = buf.Size();
+  buf.Enlarge(sizeof(T));
+  Order::StoreValue(buf.Data() + pos, *DataOf<T>(data));
+  return sizeof(T);
+}
+
+template <typename Data>
+using EncodeFuncOf = int (*)(BaseSchema* schema, const Data& data, Buf& buf);
+
+template <typename Order, typename Data>
+static EncodeFuncOf<Data> ValueEncodeFunc(BaseSchema* schema) {
+  EncodeFuncOf<Data> encode_schema = EncodeSchemaValue;
+  switch (schema->GetType()) {
+    case BaseSchema::kBool:
+      return EncodeFixedValue<bool, Order, Data>;
+    case BaseSchema::kInteger:
+      return IsVarintColumn(schema) ? encode_schema
+                                    : EncodeFixedValue<int32_t, Order, Data>;
+    case BaseSchema::kFloat:
+      return EncodeFixedValue<float, Order, Data>;
+    case BaseSchema::kLong:
+      return IsVarintColumn(schema) ? encode_schema
+                                    : EncodeFixedValue<int64_t, Order, Data>;
+    case BaseSchema::kDouble:
+      return EncodeFixedValue<double, Order, Data>;
+    default:
+      return encode_schema;
+  }
+}
+
+void RecordEncoderV2::SetCompression(CompressionType type, size_t threshold) {
+  if (type != CompressionType::kNone && !IsCompressionSupported(type)) {
+    throw std::runtime_error("Unsupported compression type.");
+  }
+  compression_ = type;
+  compression_threshold_ = threshold;
+  for (auto& group : group_encoders_) {
+    group->SetCompression(type, threshold);
+  }
+}
+
+size_t RecordEncoderV2::MemoryUsage() const {
+  size_t size = sizeof(*this) + HeapSize(schemas_) +
+                HeapSize(plan_.key_columns) + HeapSize(plan_.value_columns) +
+                HeapSize(plan_.value_header) + HeapSize(group_encoders_);
+  for (const auto& group : group_encoders_) {
+    size += group->MemoryUsage();
+  }
+  return size;
+}
+
+void RecordEncoderV2::SetChecksum(bool checksum) {
+  checksum_ = checksum;
+  for (auto& group : group_encoders_) {
+    group->SetChecksum(checksum);
+  }
+}
+
+void RecordEncoderV2::SetNullBitmap(bool null_bitmap) {
+  null_bitmap_ = null_bitmap;
+  BuildPlan();
+}
+
+void RecordEncoderV2::SetStaticOffsets(bool static_offsets) {
+  static_offsets_ = static_offsets;
+  BuildPlan();
+}
+
+void RecordEncoderV2::SetSparseValues(bool sparse) {
+  sparse_values_ = sparse;
+  BuildPlan();
+}
+
+void RecordEncoderV2::SetBoolBits(bool bool_bits) {
+  bool_bits_ = bool_bits;
+  BuildPlan();
+}
+
+void RecordEncoderV2::BuildColumnGroups() {
+  group_encoders_.clear();
+  int max_group = 0;
+  for (const auto& schema : schemas_) {
+    if (schema != nullptr && !schema->IsKey()) {
+      int group = schema->GetColumnGroup();
+      if (group < 0 || group >= kMaxColumnGroups) {
+        throw std::runtime_error("Column group out of range.");
+      }
+      max_group = std::max(max_group, group);
+    }
+  }
+  if (max_group == 0) {
+    return;
+  }
+
+  for (int group = 0; group <= max_group; ++group) {
+    auto encoder = std::make_shared<RecordEncoderV2>(*this);
+    encoder->column_group_ = group;
+    for (auto& schema : encoder->schemas_) {
+      if (schema != nullptr && !schema->IsKey() &&
+          schema->GetColumnGroup() != group) {
+        schema = nullptr;
+      }
+    }
+    encoder->BuildPlan();
+    group_encoders_.push_back(std::move(encoder));
+  }
+}
+
+void RecordEncoderV2::BuildPlan() {
+  if (column_group_ < 0) {
+    BuildColumnGroups();
+  }
+
+  EncodePlan plan;
+
+  auto descriptors = CompileColumnDescriptors(schemas_);
+  for (size_t i = 0; i < descriptors.size(); ++i) {
+    const auto& descriptor = descriptors[i];
+    BaseSchema* schema = descriptor.schema;
+    if (schema == nullptr) {
+      continue;
+    }
+
+    if (descriptor.is_key) {
+      plan.key_columns.push_back(
+          {descriptor, static_cast<int>(i), nullptr, nullptr});
+    } else {
+      plan.value_columns.push_back(
+          {descriptor, descriptor.index,
+           le_ ? ValueEncodeFunc<SwappedByteOrder, std::any>(schema)
+               : ValueEncodeFunc<HostByteOrder, std::any>(schema),
+           le_ ? ValueEncodeFunc<SwappedByteOrder, ColumnValue>(schema)
+               : ValueEncodeFunc<HostByteOrder, ColumnValue>(schema)});
+      plan.value_columns.back().in_place =
+          descriptor.type == BaseSchema::kStringList ||
+          (descriptor.type == BaseSchema::kString &&
+           descriptor.value_length == 0 &&
+           static_cast<DingoSchema<std::string>*>(schema)->GetDictionary() ==
+               nullptr);
+      if (IsVarintColumn(schema)) {
+        plan.format |= VALUE_FORMAT_VARINT;
+      }
+      if (descriptor.type == BaseSchema::kBoolList &&
+          static_cast<DingoSchema<std::vector<bool>>*>(schema)
+              ->IsPacked()) {
+        plan.format |= VALUE_FORMAT_PACKED_BOOLS;
+      }
+      if (descriptor.type == BaseSchema::kFloatList &&
+          static_cast<DingoSchema<std::vector<float>>*>(schema)
+                  ->GetQuantization() != FloatQuantization::kNone) {
+        plan.format |= VALUE_FORMAT_QUANTIZED_FLOATS;
+      }
+      if (descriptor.type == BaseSchema::kString &&
+          descriptor.value_length == 0 &&
+          static_cast<DingoSchema<std::string>*>(schema)
+                  ->GetDictionary() != nullptr) {
+        plan.format |= VALUE_FORMAT_DICT_STRINGS;
+      }
+      if (descriptor.type == BaseSchema::kString &&
+          descriptor.value_length > 0) {
+        plan.format |= VALUE_FORMAT_FIXED_STRINGS;
+      }
+      if ((descriptor.type == BaseSchema::kIntegerList &&
+           static_cast<DingoSchema<std::vector<int32_t>>*>(schema)
+               ->IsDeltaEncoded()) ||
+          (descriptor.type == BaseSchema::kLongList &&
+           static_cast<DingoSchema<std::vector<int64_t>>*>(schema)
+               ->IsDeltaEncoded()) ||
+          (descriptor.type == BaseSchema::kDoubleList &&
+           static_cast<DingoSchema<std::vector<double>>*>(schema)
+               ->IsXorEncoded())) {
+        plan.format |= VALUE_FORMAT_SERIES_LISTS;
+      }
+    }
+  }
+
+  // prefix | key columns | codec version
+  plan.fixed_key_size = 9 + 4;
+  for (const auto& column : plan.key_columns) {
+    if (!IsFixedLengthType(column.type) || column.key_length == 0) {
+      plan.fixed_key_size = 0;
+      break;
+    }
+    plan.fixed_key_size += column.key_length;
+  }
+
+  int id_unit = ID_2_BYTE;
+  if (compact_value_header_) {
+    plan.compact_offsets = !static_offsets_;
+    bool compact_ids = std::all_of(
+        plan.value_columns.begin(), plan.value_columns.end(),
+        [](const ColumnPlan& column) { return column.index < 255; });
+    if (compact_ids) {
+      plan.format |= VALUE_FORMAT_COMPACT_ID;
+      id_unit = ID_1_BYTE;
+    }
+  }
+
+  int col_cnt = plan.value_columns.size();
+  plan.id_unit = id_unit;
+  plan.cnt_not_null_col_pos = 4;
+  plan.cnt_null_col_pos = plan.cnt_not_null_col_pos + 2;
+  plan.ids_pos = plan.cnt_null_col_pos + 2;
+
+  if (static_offsets_) {
+    // Fixed width columns keep their place, null or not, so all but the
+    // offsets of the other columns is constant. They go first, hot ones
+    // ahead, and lists last; the id table records the order for decoders.
+    std::stable_sort(plan.value_columns.begin(), plan.value_columns.end(),
+                     [](const ColumnPlan& a, const ColumnPlan& b) {
+                       return ValueLayoutBefore(a.schema, b.schema);
+                     });
+    plan.static_offsets = true;
+    plan.format |= VALUE_FORMAT_STATIC_OFFSETS;
+    plan.fixed_cnt = std::count_if(
+        plan.value_columns.begin(), plan.value_columns.end(),
+        [](const ColumnPlan& column) { return column.value_length > 0; });
+
+    // fixed_cnt(2 bytes) | ids | null bitmap | offsets, then the data.
+    plan.ids_pos += 2;
+    plan.null_bitmap_pos = plan.ids_pos + col_cnt * id_unit;
+    plan.null_bitmap_size = (plan.fixed_cnt + 7) / 8;
+    plan.offset_pos = plan.null_bitmap_pos + plan.null_bitmap_size;
+    plan.data_pos = plan.offset_pos + (col_cnt - plan.fixed_cnt) * 4;
+
+    Buf header(plan.data_pos, this->le_);
+    EncodeSchemaVersion(header, plan.format);
+    header.WriteShort(0);
+    header.WriteShort(0);
+    header.WriteShort(plan.fixed_cnt);
+    for (const auto& column : plan.value_columns) {
+      if (id_unit == ID_1_BYTE) {
+        header.Write(column.index);
+      } else {
+        header.WriteShort(column.index);
+      }
+    }
+    header.ReSize(plan.data_pos);
+    header.GetString(plan.value_header);
+
+    plan_ = std::move(plan);
+    return;
+  }
+
+  bool has_bools = std::any_of(
+      plan.value_columns.begin(), plan.value_columns.end(),
+      [](const ColumnPlan& column) {
+        return column.type == BaseSchema::kBool;
+      });
+  if (bool_bits_ && has_bools) {
+    // The tables and the bool section depend on the row, only the counts
+    // are constant.
+    plan.bool_bits = true;
+    plan.format |= VALUE_FORMAT_BOOL_BITS;
+    plan.ids_pos += 2;
+    plan.offset_pos = plan.ids_pos;
+    plan.data_pos = plan.ids_pos;
+
+    Buf header(plan.ids_pos, this->le_);
+    EncodeSchemaVersion(header, plan.format);
+    header.WriteShort(0);
+    header.WriteShort(0);
+    header.WriteShort(0);
+    header.GetString(plan.value_header);
+
+    plan_ = std::move(plan);
+    return;
+  }
+
+  if (null_bitmap_) {
+    // The tables depend on the row, only the bitmap room is constant.
+    plan.format |= VALUE_FORMAT_NULL_BITMAP;
+    plan.null_bitmap_pos = plan.ids_pos;
+    plan.null_bitmap_size = (col_cnt + 7) / 8;
+    plan.ids_pos += plan.null_bitmap_size;
+    plan.offset_pos = plan.ids_pos;
+    plan.data_pos = plan.ids_pos;
+
+    Buf header(plan.ids_pos, this->le_);
+    EncodeSchemaVersion(header, plan.format);
+    header.WriteShort(0);
+    header.WriteShort(0);
+    header.ReSize(plan.ids_pos);
+    header.GetString(plan.value_header);
+
+    plan_ = std::move(plan);
+    return;
+  }
+
+  plan.offset_pos = plan.ids_pos + col_cnt * id_unit;
+  plan.data_pos = plan.offset_pos + col_cnt * 4;
+  plan.sparse_values = sparse_values_;
+
+  // The id table lists every value column, null or not, so it is constant.
+  Buf header(plan.offset_pos, this->le_);
+  EncodeSchemaVersion(header, plan.format);
+  header.WriteShort(0);
+  header.WriteShort(0);
+  for (const auto& column : plan.value_columns) {
+    if (id_unit == ID_1_BYTE) {
+      header.Write(column.index);
+    } else {
+      header.WriteShort(column.index);
+    }
+  }
+  header.GetString(plan.value_header);
+
+  plan_ = std::move(plan);
 }
 
 inline void RecordEncoderV2::EncodePrefix(Buf& buf, char prefix) const {
-  buf.Write(prefix);
-  buf.WriteLong(common_id_);
+  size_t pos = buf.Size();
+  buf.Enlarge(9);
+  char* data = buf.Data() + pos;
+  data[0] = prefix;
+  memcpy(data + 1, encoded_common_id_, 8);
+}
+
+std::string RecordEncoderV2::KeyPrefix(char prefix) const {
+  std::string output(9, prefix);
+  memcpy(output.data() + 1, encoded_common_id_, 8);
+  return output;
 }
 
 void RecordEncoderV2::EncodeCodecVersion(Buf& buf) const {
   buf.WriteInt(codec_version_);
 }
 
-inline void RecordEncoderV2::EncodeSchemaVersion(Buf& buf) const {
-  buf.WriteInt(schema_version_);
+inline void RecordEncoderV2::EncodeSchemaVersion(Buf& buf, int format) const {
+  buf.WriteInt(SetValueFormat(schema_version_, format));
 }
 
-int RecordEncoderV2::Encode(char prefix, const std::vector<std::any>& record,
-                            std::string& key, std::string& value) {
+template <typename Record>
+int RecordEncoderV2::EncodeImpl(char prefix, const Record& record,
+                                std::string& key, std::string& value) const {
+  DINGO_SERIAL_PROBE2(encode_start, common_id_, schema_version_);
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
   int ret = EncodeKey(prefix, record, key);
   if (ret < 0) {
     return ret;
@@ -68,94 +461,1579 @@ int RecordEncoderV2::Encode(char prefix, const std::vector<std::any>& record,
   if (ret < 0) {
     return ret;
   }
+  DINGO_CODEC_STATS(stats_,
+                    AddEncode(1, key.size() + value.size(), sample_start));
+  DINGO_SERIAL_PROBE4(encode_done, common_id_, schema_version_, key.size(),
+                      value.size());
   return 0;
 }
 
-int RecordEncoderV2::EncodeKey(char prefix, const std::vector<std::any>& record,
-                               std::string& output) {
-  Buf buf(kBufInitCapacity, this->le_);
+int RecordEncoderV2::EncodeColumnGroups(
+    char prefix, const std::vector<std::any>& record, std::string& key,
+    std::vector<std::string>& values) const {
+  return EncodeColumnGroupsImpl(prefix, record, key, values);
+}
 
-  // namespace | common_id | ... | codecVersion
-  EncodePrefix(buf, prefix);
+int RecordEncoderV2::EncodeColumnGroups(
+    char prefix, const std::vector<ColumnValue>& record, std::string& key,
+    std::vector<std::string>& values) const {
+  return EncodeColumnGroupsImpl(prefix, record, key, values);
+}
 
-  // loop meta schemas.
-  for (int i = 0; i < schemas_.size(); ++i) {
-    const auto& schema = schemas_.at(i);
+template <typename Record>
+int RecordEncoderV2::EncodeColumnGroupsImpl(
+    char prefix, const Record& record, std::string& key,
+    std::vector<std::string>& values) const {
+  int ret = EncodeKey(prefix, record, key);
+  if (ret < 0) {
+    return ret;
+  }
+  values.resize(ColumnGroupCount());
+  if (group_encoders_.empty()) {
+    ret = EncodeValue(record, values[0]);
+    return ret < 0 ? ret : 0;
+  }
+  for (size_t group = 0; group < group_encoders_.size(); ++group) {
+    ret = group_encoders_[group]->EncodeValue(record, values[group]);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
 
-    if (schema->IsKey()) {
-      const auto& column = record.at(i);
-      schema->EncodeKey(column, buf);
+int RecordEncoderV2::EncodeBatch(
+    char prefix, const std::vector<std::vector<std::any>>& records,
+    std::vector<std::string>& keys, std::vector<std::string>& values,
+    const ParallelOptions& options) const {
+  keys.resize(records.size());
+  values.resize(records.size());
+  ParallelFor(records.size(), options, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      EncodeKey(prefix, records[i], keys[i]);
+      EncodeValue(records[i], values[i]);
     }
+#if defined(DINGO_SERIAL_CODEC_STATS)
+    CountEncoded(keys, values, begin, end);
+#endif
+  });
+  return 0;
+}
+
+int RecordEncoderV2::EncodeBatch(
+    char prefix, const std::vector<std::vector<std::any>>& records,
+    EncodedBatch& output) const {
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  Buf buf = AcquireBuf(output.arena_, output.arena_.capacity());
+  output.offsets_.resize(1);
+  output.offsets_.reserve(2 * records.size() + 1);
+  for (const auto& record : records) {
+    EncodeKey(prefix, record, buf);
+    output.offsets_.push_back(buf.Size());
+    EncodeValue(record, buf);
+    output.offsets_.push_back(buf.Size());
   }
 
-  EncodeCodecVersion(buf);
+  DINGO_CODEC_STATS(stats_,
+                    AddEncode(records.size(), buf.Size(), sample_start));
+  buf.GetString(output.arena_);
+  return 0;
+}
 
-  buf.GetString(output);
-  return output.size();
+int RecordEncoderV2::EncodeAndSortKeys(
+    char prefix, const std::vector<std::vector<std::any>>& records,
+    EncodedBatch& keys, std::vector<uint32_t>& order,
+    const ParallelOptions& options) const {
+  Buf buf = AcquireBuf(keys.arena_, keys.arena_.capacity());
+  keys.offsets_.resize(1);
+  keys.offsets_.reserve(2 * records.size() + 1);
+  for (const auto& record : records) {
+    EncodeKey(prefix, record, buf);
+    keys.offsets_.push_back(buf.Size());
+    keys.offsets_.push_back(buf.Size());
+  }
+  buf.GetString(keys.arena_);
+
+  std::vector<std::string_view> views(records.size());
+  for (size_t i = 0; i < views.size(); ++i) {
+    views[i] = keys.Key(i);
+  }
+  RadixSortKeys(views.data(), views.size(), order, options);
+  return 0;
 }
 
-int RecordEncoderV2::EncodeValue(const std::vector<std::any>& record,
-                                 std::string& output) {
-  Buf buf(kBufInitCapacity, this->le_);
+int RecordEncoderV2::Encode(char prefix, const std::vector<std::any>& record,
+                            std::string& key, std::string& value,
+                            EncodeStatsCollector& stats) const {
+  int ret = Encode(prefix, record, key, value);
+  if (ret < 0) {
+    return ret;
+  }
+  stats.Add(record);
+  return 0;
+}
 
-  // get total value size.
-  int col_cnt = 0;
-  for (const auto& schema : schemas_) {
-    col_cnt += (schema->IsKey() ? 0 : 1);
+int RecordEncoderV2::EncodeBatch(
+    char prefix, const std::vector<std::vector<std::any>>& records,
+    std::vector<std::string>& keys, std::vector<std::string>& values,
+    EncodeStatsCollector& stats, const ParallelOptions& options) const {
+  keys.resize(records.size());
+  values.resize(records.size());
+  std::mutex mutex;
+  ParallelFor(records.size(), options, [&](size_t begin, size_t end) {
+    EncodeStatsCollector chunk_stats = NewStatsCollector();
+    for (size_t i = begin; i < end; ++i) {
+      EncodeKey(prefix, records[i], keys[i]);
+      EncodeValue(records[i], values[i]);
+      chunk_stats.Add(records[i]);
+    }
+#if defined(DINGO_SERIAL_CODEC_STATS)
+    CountEncoded(keys, values, begin, end);
+#endif
+    std::lock_guard<std::mutex> guard(mutex);
+    stats.Merge(chunk_stats);
+  });
+  return 0;
+}
+
+// The value of row in the schema form, cell keeps the storage of the strings
+// and lists it held.
+template <typename T>
+static T& CellOf(ColumnValue& cell) {
+  if (auto* held = std::get_if<T>(&cell)) {
+    return *held;
+  }
+  return cell.emplace<T>();
+}
+
+template <typename T>
+static void LoadList(const ColumnArray& array, size_t row, ColumnValue& cell) {
+  auto& list = CellOf<std::vector<T>>(cell);
+  size_t begin = array.ListBegin(row);
+  list.resize(array.ListEnd(row) - begin);
+  for (size_t i = 0; i < list.size(); ++i) {
+    list[i] = array.Get<T>(begin + i);
   }
+}
 
-  EncodeSchemaVersion(buf);
+static const ColumnValue& LoadCell(const ColumnArray& array, size_t row,
+                                   ColumnValue& cell) {
+  static const ColumnValue kNullCell;
+  if (array.IsNull(row)) {
+    return kNullCell;
+  }
 
-  int cnt_not_null_col = 0;
-  int cnt_null_col = 0;
+  switch (array.type) {
+    case BaseSchema::kBool:
+      cell = array.Get<bool>(row);
+      break;
+    case BaseSchema::kInteger:
+      cell = array.Get<int32_t>(row);
+      break;
+    case BaseSchema::kFloat:
+      cell = array.Get<float>(row);
+      break;
+    case BaseSchema::kLong:
+      cell = array.Get<int64_t>(row);
+      break;
+    case BaseSchema::kDouble:
+      cell = array.Get<double>(row);
+      break;
+    case BaseSchema::kString:
+      CellOf<std::string>(cell).assign(array.GetString(row));
+      break;
+    case BaseSchema::kBoolList:
+      LoadList<bool>(array, row, cell);
+      break;
+    case BaseSchema::kIntegerList:
+      LoadList<int32_t>(array, row, cell);
+      break;
+    case BaseSchema::kFloatList:
+      LoadList<float>(array, row, cell);
+      break;
+    case BaseSchema::kLongList:
+      LoadList<int64_t>(array, row, cell);
+      break;
+    case BaseSchema::kDoubleList:
+      LoadList<double>(array, row, cell);
+      break;
+    case BaseSchema::kStringList: {
+      auto& list = CellOf<std::vector<std::string>>(cell);
+      size_t begin = array.ListBegin(row);
+      list.resize(array.ListEnd(row) - begin);
+      for (size_t i = 0; i < list.size(); ++i) {
+        list[i].assign(array.GetString(begin + i));
+      }
+      break;
+    }
+  }
+  return cell;
+}
 
-  int cnt_not_null_col_pos = 4;
-  int cnt_null_col_pos = cnt_not_null_col_pos + 2;
-  int ids_pos = cnt_null_col_pos + 2;
-  int offset_pos = ids_pos + col_cnt * 2;
-  int data_pos = offset_pos + col_cnt * 4;
+// A fixed width value column across the batch, the words of the null rows
+// are written too and left out when the rows are put together.
+template <typename T, typename Order>
+static void EncodeFixedRun(const ColumnArray& array, size_t rows,
+                           std::string& data) {
+  data.resize(rows * sizeof(T));
+  char* out = data.data();
+  for (size_t i = 0; i < rows; ++i) {
+    Order::StoreValue(out + i * sizeof(T), array.Get<T>(i));
+  }
+}
 
-  buf.ReSize(data_pos);
+template <typename Order>
+static bool EncodeFixedRunOf(const ColumnArray& array, size_t rows,
+                             std::string& data) {
+  switch (array.type) {
+    case BaseSchema::kBool:
+      EncodeFixedRun<bool, Order>(array, rows, data);
+      return true;
+    case BaseSchema::kInteger:
+      EncodeFixedRun<int32_t, Order>(array, rows, data);
+      return true;
+    case BaseSchema::kFloat:
+      EncodeFixedRun<float, Order>(array, rows, data);
+      return true;
+    case BaseSchema::kLong:
+      EncodeFixedRun<int64_t, Order>(array, rows, data);
+      return true;
+    case BaseSchema::kDouble:
+      EncodeFixedRun<double, Order>(array, rows, data);
+      return true;
+    default:
+      return false;
+  }
+}
 
-  // append data.
-  for (const auto& schema : schemas_) {
-    if (!schema->IsKey()) {
-      int index = schema->GetIndex();
-      const auto& column = record.at(index);
-      if (schema->isNull(column)) {
-        cnt_null_col++;
+// The key word of a fixed width column as its schema writes it, in host
+// order: ints with their first bit flipped, floats in their comparable form.
+template <typename Order>
+static uint8_t KeyWord(bool data) {
+  return data ? 0x1 : 0x0;
+}
+template <typename Order>
+static uint32_t KeyWord(int32_t data) {
+  return static_cast<uint32_t>(data) ^ Order::template FirstBitMask<uint32_t>();
+}
+template <typename Order>
+static uint64_t KeyWord(int64_t data) {
+  return static_cast<uint64_t>(data) ^ Order::template FirstBitMask<uint64_t>();
+}
+template <typename Order>
+static uint32_t KeyWord(float data) {
+  uint32_t bits;
+  memcpy(&bits, &data, 4);
+  return ToComparableFloatWord(bits, !(data >= 0),
+                               Order::template FirstBitMask<uint32_t>());
+}
+template <typename Order>
+static uint64_t KeyWord(double data) {
+  uint64_t bits;
+  memcpy(&bits, &data, 8);
+  return ToComparableFloatWord(bits, !(data >= 0),
+                               Order::template FirstBitMask<uint64_t>());
+}
 
-        // write id
-        buf.WriteShort(ids_pos, index);
-        ids_pos += 2;
+// A fixed width key column across the batch into the keys at out, stride
+// bytes apart. The not null rows are written without a branch, the null
+// rows are patched afterwards.
+template <typename T, typename Order>
+static void EncodeKeyRun(const ColumnDescriptor& column,
+                         const ColumnArray& array, size_t rows, char* out,
+                         size_t stride) {
+  using Word = decltype(KeyWord<Order>(T()));
+  int flag_size = column.allow_null ? 1 : 0;
+  bool descending = column.schema->IsDescending();
+  Word invert = descending ? static_cast<Word>(~Word(0)) : Word(0);
+  char not_null = static_cast<char>(descending ? ~0x1 : 0x1);
 
-        // write offset
-        buf.WriteInt(offset_pos, -1);
-        offset_pos += 4;
-      } else {
-        cnt_not_null_col++;
+  char* dst = out;
+  for (size_t i = 0; i < rows; ++i, dst += stride) {
+    if (flag_size > 0) {
+      dst[0] = not_null;
+    }
+    Order::Store(dst + flag_size,
+                 static_cast<Word>(KeyWord<Order>(array.Get<T>(i)) ^ invert));
+  }
+
+  if (array.validity == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < rows; ++i) {
+    if (array.IsNull(i)) {
+      if (DINGO_UNLIKELY(flag_size == 0)) {
+        throw std::runtime_error("Not allow null, but data not has value.");
+      }
+      // the null flag and a zero word.
+      memset(out + i * stride, descending ? 0xff : 0x0, 1 + sizeof(Word));
+    }
+  }
+}
+
+template <typename Order>
+static void EncodeKeyRunOf(const ColumnDescriptor& column,
+                           const ColumnArray& array, size_t rows, char* out,
+                           size_t stride) {
+  switch (array.type) {
+    case BaseSchema::kBool:
+      EncodeKeyRun<bool, Order>(column, array, rows, out, stride);
+      break;
+    case BaseSchema::kInteger:
+      EncodeKeyRun<int32_t, Order>(column, array, rows, out, stride);
+      break;
+    case BaseSchema::kFloat:
+      EncodeKeyRun<float, Order>(column, array, rows, out, stride);
+      break;
+    case BaseSchema::kLong:
+      EncodeKeyRun<int64_t, Order>(column, array, rows, out, stride);
+      break;
+    case BaseSchema::kDouble:
+      EncodeKeyRun<double, Order>(column, array, rows, out, stride);
+      break;
+    default:
+      throw std::runtime_error("Not a fixed width key column.");
+  }
+}
+
+// Whether every column of plans is in columns with the type of its schema.
+template <typename Plans>
+static bool ColumnsMatch(const Plans& plans,
+                         const std::vector<ColumnArray>& columns) {
+  return std::all_of(plans.begin(), plans.end(), [&columns](const auto& column) {
+    return static_cast<size_t>(column.record_index) < columns.size() &&
+           columns[column.record_index].type == column.type;
+  });
+}
+
+static int AppendBytes(Buf& buf, std::string_view bytes) {
+  size_t pos = buf.Size();
+  buf.Enlarge(bytes.size());
+  memcpy(buf.Data() + pos, bytes.data(), bytes.size());
+  return bytes.size();
+}
+
+void RecordEncoderV2::EncodeValueRun(const ColumnPlan& column,
+                                     const ColumnArray& array, size_t rows,
+                                     EncodedBatch::ColumnRun& run) const {
+  run.width = 0;
+  if (column.value_length > 0 && !IsVarintColumn(column.schema) &&
+      (le_ ? EncodeFixedRunOf<SwappedByteOrder>(array, rows, run.data)
+           : EncodeFixedRunOf<HostByteOrder>(array, rows, run.data))) {
+    run.width = column.value_length;
+  }
+}
+
+void RecordEncoderV2::EncodeFixedKeys(char prefix,
+                                      const std::vector<ColumnArray>& columns,
+                                      size_t rows, char* out) const {
+  size_t key_size = plan_.fixed_key_size;
+  Buf frame(key_size, le_);
+  EncodePrefix(frame, prefix);
+  frame.Enlarge(key_size - 9 - 4);
+  EncodeCodecVersion(frame);
+  for (size_t row = 0; row < rows; ++row) {
+    memcpy(out + row * key_size, frame.Data(), key_size);
+  }
+
+  size_t pos = 9;
+  for (const auto& column : plan_.key_columns) {
+    if (le_) {
+      EncodeKeyRunOf<SwappedByteOrder>(column, columns[column.record_index],
+                                       rows, out + pos, key_size);
+    } else {
+      EncodeKeyRunOf<HostByteOrder>(column, columns[column.record_index],
+                                    rows, out + pos, key_size);
+    }
+    pos += column.key_length;
+  }
+}
+
+int RecordEncoderV2::EncodeKeys(char prefix,
+                                const std::vector<ColumnArray>& columns,
+                                size_t rows, EncodedBatch& keys) const {
+  if (!ColumnsMatch(plan_.key_columns, columns)) {
+    return -1;
+  }
 
-        // write id
-        buf.WriteShort(ids_pos, index);
-        ids_pos += 2;
+  keys.offsets_.resize(1);
+  keys.offsets_.reserve(2 * rows + 1);
+  size_t key_size = plan_.fixed_key_size;
+  if (key_size > 0) {
+    keys.arena_.resize(rows * key_size);
+    EncodeFixedKeys(prefix, columns, rows, keys.arena_.data());
+    for (size_t row = 1; row <= rows; ++row) {
+      keys.offsets_.push_back(row * key_size);
+      keys.offsets_.push_back(row * key_size);
+    }
+    return 0;
+  }
+
+  auto& record = keys.record_;
+  record.resize(columns.size());
+  Buf buf = AcquireBuf(keys.arena_, keys.arena_.capacity());
+  for (size_t row = 0; row < rows; ++row) {
+    EncodePrefix(buf, prefix);
+    for (const auto& column : plan_.key_columns) {
+      EncodeSchemaKey(column.schema,
+                      LoadCell(columns[column.record_index], row,
+                               record[column.record_index]),
+                      buf);
+    }
+    EncodeCodecVersion(buf);
+    keys.offsets_.push_back(buf.Size());
+    keys.offsets_.push_back(buf.Size());
+  }
+  buf.GetString(keys.arena_);
+  return 0;
+}
+
+int RecordEncoderV2::EncodeBatch(char prefix,
+                                 const std::vector<ColumnArray>& columns,
+                                 size_t rows, EncodedBatch& output) const {
+  DINGO_CODEC_STATS_SAMPLE(stats_, sample_start);
+  if (!ColumnsMatch(plan_.key_columns, columns) ||
+      !ColumnsMatch(plan_.value_columns, columns)) {
+    return -1;
+  }
+
+  size_t key_size = plan_.fixed_key_size;
+  if (key_size > 0) {
+    output.fixed_keys_.resize(rows * key_size);
+    EncodeFixedKeys(prefix, columns, rows, output.fixed_keys_.data());
+  }
+
+  // The values are put together from the runs in the layout with 4 bytes
+  // offsets, the other layouts and sparse rows are left to EncodeValue row by
+  // row.
+  bool from_runs = !plan_.static_offsets && plan_.null_bitmap_size == 0 &&
+                   !plan_.sparse_values && !plan_.bool_bits;
+  output.value_runs_.resize(from_runs ? plan_.value_columns.size() : 0);
+  // at least the prefixes, the value headers and the fixed width words.
+  size_t size = rows * (9 + 4 + plan_.data_pos);
+  for (size_t i = 0; i < output.value_runs_.size(); ++i) {
+    const auto& column = plan_.value_columns[i];
+    EncodeValueRun(column, columns[column.record_index], rows,
+                   output.value_runs_[i]);
+    size += output.value_runs_[i].data.size();
+  }
+
+  auto& record = output.record_;
+  record.resize(columns.size());
+  Buf buf = AcquireBuf(output.arena_, size);
+  output.offsets_.resize(1);
+  output.offsets_.reserve(2 * rows + 1);
+  for (size_t row = 0; row < rows; ++row) {
+    // namespace | common_id | ... | codecVersion
+    if (key_size > 0) {
+      AppendBytes(buf, std::string_view(
+                           output.fixed_keys_.data() + row * key_size,
+                           key_size));
+    } else {
+      EncodePrefix(buf, prefix);
+      for (const auto& column : plan_.key_columns) {
+        EncodeSchemaKey(
+            column.schema,
+            LoadCell(columns[column.record_index], row,
+                     record[column.record_index]),
+            buf);
+      }
+      EncodeCodecVersion(buf);
+    }
+    output.offsets_.push_back(buf.Size());
+
+    if (!from_runs) {
+      for (const auto& column : plan_.value_columns) {
+        const auto& array = columns[column.record_index];
+        auto& value = record[column.record_index];
+        if (array.IsNull(row)) {
+          value = std::monostate();
+        } else {
+          LoadCell(array, row, value);
+        }
+      }
+      EncodeValue(record, buf);
+      output.offsets_.push_back(buf.Size());
+      continue;
+    }
 
-        // write offset
-        buf.WriteInt(offset_pos, data_pos);
-        offset_pos += 4;
+    // As EncodeValueWithOffsets, positions relative to the start of the value.
+    size_t start = buf.Size();
+    buf.WriteString(plan_.value_header);
+    buf.ReSize(start + plan_.data_pos);
 
-        // write data.
-        data_pos += schema->EncodeValue(column, buf);
+    int cnt_null_col = 0;
+    int offset_pos = plan_.offset_pos;
+    int data_pos = plan_.data_pos;
+    for (size_t i = 0; i < plan_.value_columns.size(); ++i) {
+      const auto& column = plan_.value_columns[i];
+      const auto& array = columns[column.record_index];
+      const auto& run = output.value_runs_[i];
+      if (array.IsNull(row)) {
+        cnt_null_col++;
+        buf.WriteInt(start + offset_pos, -1);
+      } else {
+        buf.WriteInt(start + offset_pos, data_pos);
+        data_pos += run.width > 0
+                        ? AppendBytes(buf, run.Row(row))
+                        : column.Encode(LoadCell(array, row,
+                                                 record[column.record_index]),
+                                        buf);
       }
+      offset_pos += 4;
+    }
+
+    buf.WriteShort(start + plan_.cnt_not_null_col_pos,
+                   plan_.value_columns.size() - cnt_null_col);
+    buf.WriteShort(start + plan_.cnt_null_col_pos, cnt_null_col);
+
+    if (plan_.compact_offsets) {
+      CompactOffsets(buf, start, plan_.offset_pos, plan_.data_pos,
+                     plan_.value_columns.size());
+    }
+    if (compression_ != CompressionType::kNone &&
+        buf.Size() - start >= compression_threshold_) {
+      CompressValue(buf, start);
     }
+    if (checksum_) {
+      AppendChecksum(buf, start);
+    }
+    output.offsets_.push_back(buf.Size());
+  }
+
+  DINGO_CODEC_STATS(stats_, AddEncode(rows, buf.Size(), sample_start));
+  buf.GetString(output.arena_);
+  return 0;
+}
+
+void RecordEncoderV2::CountEncoded(const std::vector<std::string>& keys,
+                                   const std::vector<std::string>& values,
+                                   size_t begin, size_t end) const {
+  if (stats_ == nullptr) {
+    return;
   }
+  uint64_t bytes = 0;
+  for (size_t i = begin; i < end; ++i) {
+    bytes += keys[i].size() + values[i].size();
+  }
+  stats_->AddEncode(end - begin, bytes);
+}
+
+// Take over the storage of output so that its capacity is reused.
+inline Buf RecordEncoderV2::AcquireBuf(std::string& output,
+                                       size_t size) const {
+  Buf buf(std::move(output), this->le_);
+  buf.Clear();
+  if (buf.Capacity() < size) {
+    buf.Reserve(size);
+  }
+  return buf;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeKeyImpl(char prefix, const Record& record,
+                                   std::string& output) const {
+  Buf buf = AcquireBuf(output, EncodedKeySize(record));
+
+  EncodeKey(prefix, record, buf);
+
+  buf.GetString(output);
+  return output.size();
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeKeyImpl(char prefix, const Record& record,
+                                   Buf& buf) const {
+  size_t start = buf.Size();
+
+  // namespace | common_id | ... | codecVersion
+  EncodePrefix(buf, prefix);
+
+  for (const auto& column : plan_.key_columns) {
+    EncodeSchemaKey(column.schema, record.at(column.record_index), buf);
+  }
+
+  EncodeCodecVersion(buf);
+
+  return buf.Size() - start;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeVersionKeyImpl(char prefix, const Record& record,
+                                          int64_t ts,
+                                          std::string& output) const {
+  Buf buf = AcquireBuf(output, EncodedKeySize(record) + kTsLength);
+
+  EncodeKey(prefix, record, buf);
+  AppendTs(buf, ts);
+
+  buf.GetString(output);
+  return output.size();
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeValueImpl(const Record& record,
+                                     std::string& output) const {
+  int entry_cnt;
+  Buf buf = AcquireBuf(output, WideValueSize(record, entry_cnt) +
+                                   (checksum_ ? kValueChecksumSize : 0));
 
-  buf.WriteShort(cnt_not_null_col_pos, cnt_not_null_col);
-  buf.WriteShort(cnt_null_col_pos, cnt_null_col);
+  EncodeValue(record, buf);
 
   buf.GetString(output);
   return output.size();
 }
 
+template <typename Record>
+int RecordEncoderV2::EncodeValueImpl(const Record& record, Buf& buf,
+                                     ValueSlices* slices) const {
+  size_t start = buf.Size();
+  if (plan_.static_offsets) {
+    EncodeValueWithStaticOffsets(record, buf, slices);
+  } else if (plan_.bool_bits) {
+    EncodeValueWithBoolBits(record, buf, slices);
+  } else if (plan_.null_bitmap_size > 0) {
+    EncodeValueWithNullBitmap(record, buf, slices);
+  } else if (int cnt = NotNullCount(record); IsSparseRow(cnt)) {
+    EncodeSparseValue(record, cnt, buf, slices);
+  } else {
+    EncodeValueWithOffsets(record, buf, slices);
+  }
+
+  if (compression_ != CompressionType::kNone &&
+      buf.Size() - start >= compression_threshold_) {
+    CompressValue(buf, start);
+  }
+  if (checksum_) {
+    AppendChecksum(buf, start);
+  }
+  return buf.Size() - start;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeValueImpl(const Record& record,
+                                     ValueSlices& output) const {
+  output.Reset();
+  // a compressed or checksummed value is rewritten or read as a whole, it
+  // takes one slice.
+  if (compression_ != CompressionType::kNone || checksum_) {
+    EncodeValueImpl(record, output.scratch_);
+    output.Finish();
+    return output.Size();
+  }
+
+  int entry_cnt;
+  Buf buf = AcquireBuf(output.scratch_,
+                       WideValueSize(record, entry_cnt) -
+                           InPlaceSize(record, output.threshold_));
+
+  EncodeValueImpl(record, buf, &output);
+
+  buf.GetString(output.scratch_);
+  output.Finish();
+  return output.Size();
+}
+
+template <typename Record>
+size_t RecordEncoderV2::InPlaceSize(const Record& record,
+                                    size_t threshold) const {
+  size_t size = 0;
+  for (const auto& column : plan_.value_columns) {
+    const auto& value = record.at(column.record_index);
+    if (!column.in_place || IsNull(value)) {
+      continue;
+    }
+    if (column.type == BaseSchema::kStringList) {
+      for (const auto& str : *DataOf<std::vector<std::string>>(value)) {
+        size += str.size() >= threshold ? str.size() : 0;
+      }
+    } else if (const auto& str = *DataOf<std::string>(value);
+               str.size() >= threshold) {
+      size += str.size();
+    }
+  }
+  return size;
+}
+
+int RecordEncoderV2::EncodeStringList(const std::vector<std::string>& data,
+                                      Buf& buf, ValueSlices& slices) {
+  size_t threshold = slices.threshold_;
+  int size = 4;
+  buf.WriteInt(data.size());
+  for (const std::string& str : data) {
+    buf.WriteInt(str.size());
+    if (str.size() >= threshold) {
+      slices.AddHole(buf.Size(), str);
+    } else {
+      buf.WriteString(str);
+    }
+    size += str.size() + 4;
+  }
+  return size;
+}
+
+template <typename Value>
+int RecordEncoderV2::EncodeColumn(const ColumnPlan& column, const Value& value,
+                                  Buf& buf, ValueSlices* slices) {
+  if (slices != nullptr && column.in_place) {
+    if (column.type == BaseSchema::kStringList) {
+      return EncodeStringList(*DataOf<std::vector<std::string>>(value), buf,
+                              *slices);
+    }
+    const std::string* data = DataOf<std::string>(value);
+    if (data->size() >= slices->threshold_) {
+      buf.WriteInt(data->size());
+      slices->AddHole(buf.Size(), *data);
+      return data->size() + 4;
+    }
+  }
+  return column.Encode(value, buf);
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeKeyToImpl(char prefix, const Record& record,
+                                     char* dst, size_t cap) const {
+  int size = EncodedKeySizeImpl(record);
+  if (static_cast<size_t>(size) > cap) {
+    return size;
+  }
+  Buf buf(dst, cap, this->le_);
+  return EncodeKeyImpl(prefix, record, buf);
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeValueToImpl(const Record& record, char* dst,
+                                       size_t cap) const {
+  // the value is written with wide offsets, then narrowed or compressed.
+  int entry_cnt;
+  size_t wide_size = WideValueSize(record, entry_cnt) +
+                     (checksum_ ? kValueChecksumSize : 0);
+  if (wide_size <= cap) {
+    Buf buf(dst, cap, this->le_);
+    return EncodeValueImpl(record, buf, nullptr);
+  }
+  // exact without compression, the compressed size is only known encoded.
+  if (compression_ == CompressionType::kNone) {
+    int size = EncodedValueSizeImpl(record);
+    if (static_cast<size_t>(size) > cap) {
+      return size;
+    }
+  }
+  // fits narrowed or compressed but not as written, encoded aside.
+  std::string value;
+  EncodeValueImpl(record, value);
+  if (value.size() <= cap) {
+    memcpy(dst, value.data(), value.size());
+  }
+  return value.size();
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodedKeySizeImpl(const Record& record) const {
+  // prefix | common_id | ... | codec version.
+  int size = 9 + 4;
+  for (const auto& column : plan_.key_columns) {
+    size += column.key_length > 0 ? column.key_length
+                                  : SchemaKeyLength(
+                                        column.schema,
+                                        record.at(column.record_index));
+  }
+  return size;
+}
+
+template <typename Record>
+int RecordEncoderV2::WideValueSize(const Record& record,
+                                   int& entry_cnt) const {
+  int data_size = 0;
+  int cnt_not_null_col = 0;
+  int bool_cnt = 0;
+  for (const auto& column : plan_.value_columns) {
+    const auto& value = record.at(column.record_index);
+    if (plan_.bool_bits && column.type == BaseSchema::kBool) {
+      bool_cnt += !IsNull(value);
+    } else if (!IsNull(value)) {
+      cnt_not_null_col++;
+      data_size += column.value_length > 0
+                       ? column.value_length
+                       : SchemaValueLength(column.schema, value);
+    } else if (plan_.static_offsets) {
+      // a null fixed width column keeps its room.
+      data_size += column.value_length;
+    }
+  }
+
+  if (plan_.static_offsets) {
+    entry_cnt = 0;
+    return plan_.data_pos + data_size;
+  }
+  if (plan_.bool_bits) {
+    // the bool ids, their bits and the 0 and 1 bytes behind the tables.
+    entry_cnt = cnt_not_null_col;
+    return plan_.ids_pos + entry_cnt * (plan_.id_unit + OFFSET_4_BYTE) +
+           bool_cnt * plan_.id_unit + (bool_cnt + 7) / 8 + 2 + data_size;
+  }
+  if (plan_.null_bitmap_size > 0 || IsSparseRow(cnt_not_null_col)) {
+    entry_cnt = cnt_not_null_col;
+    return plan_.ids_pos + entry_cnt * (plan_.id_unit + OFFSET_4_BYTE) +
+           data_size;
+  }
+  entry_cnt = plan_.value_columns.size();
+  return plan_.data_pos + data_size;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodedValueSizeImpl(const Record& record) const {
+  int entry_cnt;
+  int size = WideValueSize(record, entry_cnt);
+
+  // the same test as CompactOffsets.
+  int shrink = entry_cnt * (OFFSET_4_BYTE - OFFSET_2_BYTE);
+  if (plan_.compact_offsets && entry_cnt > 0 &&
+      size - shrink < kCompactOffsetNull) {
+    size -= shrink;
+  }
+  return checksum_ ? size + kValueChecksumSize : size;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeValueWithOffsets(const Record& record, Buf& buf,
+                                            ValueSlices* slices) const {
+  // All positions below are relative to the start of this value.
+  size_t start = buf.Size();
+
+  buf.WriteString(plan_.value_header);
+  buf.ReSize(start + plan_.data_pos);
+
+  int cnt_not_null_col = 0;
+  int cnt_null_col = 0;
+  int offset_pos = plan_.offset_pos;
+  int data_pos = plan_.data_pos;
+
+  // append data.
+  for (const auto& column : plan_.value_columns) {
+    const auto& value = record.at(column.record_index);
+    if (IsNull(value)) {
+      cnt_null_col++;
+
+      // write offset
+      buf.WriteInt(start + offset_pos, -1);
+    } else {
+      cnt_not_null_col++;
+
+      // write offset
+      buf.WriteInt(start + offset_pos, data_pos);
+
+      // write data.
+      data_pos += EncodeColumn(column, value, buf, slices);
+    }
+    offset_pos += 4;
+  }
+
+  buf.WriteShort(start + plan_.cnt_not_null_col_pos, cnt_not_null_col);
+  buf.WriteShort(start + plan_.cnt_null_col_pos, cnt_null_col);
+
+  if (plan_.compact_offsets) {
+    CompactOffsets(buf, start, plan_.offset_pos, plan_.data_pos,
+                   plan_.value_columns.size(), slices);
+  }
+
+  return buf.Size() - start;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeValueWithNullBitmap(const Record& record, Buf& buf,
+                                               ValueSlices* slices) const {
+  size_t start = buf.Size();
+  buf.WriteString(plan_.value_header);
+
+  // null bits first, the table sizes follow from them.
+  int cnt_null_col = 0;
+  uint8_t bits = 0;
+  int col_cnt = plan_.value_columns.size();
+  for (int i = 0; i < col_cnt; ++i) {
+    const auto& column = plan_.value_columns[i];
+    if (IsNull(record.at(column.record_index))) {
+      bits |= 1 << (i % 8);
+      cnt_null_col++;
+    }
+    if (i % 8 == 7 || i == col_cnt - 1) {
+      buf.WriteByte(start + plan_.null_bitmap_pos + i / 8, bits);
+      bits = 0;
+    }
+  }
+
+  int cnt_not_null_col = col_cnt - cnt_null_col;
+  int ids_pos = plan_.ids_pos;
+  int offset_pos = ids_pos + cnt_not_null_col * plan_.id_unit;
+  int data_pos = offset_pos + cnt_not_null_col * 4;
+  int data_start = data_pos;
+  buf.ReSize(start + data_pos);
+
+  for (const auto& column : plan_.value_columns) {
+    const auto& value = record.at(column.record_index);
+    if (IsNull(value)) {
+      continue;
+    }
+
+    if (plan_.id_unit == ID_1_BYTE) {
+      buf.WriteByte(start + ids_pos, column.index);
+    } else {
+      buf.WriteShort(start + ids_pos, column.index);
+    }
+    ids_pos += plan_.id_unit;
+
+    buf.WriteInt(start + offset_pos, data_pos);
+    offset_pos += 4;
+
+    data_pos += EncodeColumn(column, value, buf, slices);
+  }
+
+  buf.WriteShort(start + plan_.cnt_not_null_col_pos, cnt_not_null_col);
+  buf.WriteShort(start + plan_.cnt_null_col_pos, cnt_null_col);
+
+  if (plan_.compact_offsets) {
+    CompactOffsets(buf, start, plan_.ids_pos + cnt_not_null_col * plan_.id_unit,
+                   data_start, cnt_not_null_col, slices);
+  }
+
+  return buf.Size() - start;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeValueWithBoolBits(const Record& record, Buf& buf,
+                                             ValueSlices* slices) const {
+  size_t start = buf.Size();
+  buf.WriteString(plan_.value_header);
+
+  int entry_cnt = 0;
+  int bool_cnt = 0;
+  for (const auto& column : plan_.value_columns) {
+    if (IsNull(record.at(column.record_index))) {
+      continue;
+    }
+    if (column.type == BaseSchema::kBool) {
+      bool_cnt++;
+    } else {
+      entry_cnt++;
+    }
+  }
+
+  // ids | offsets | bool ids | bool bits | 0 | 1, then the data.
+  int ids_pos = plan_.ids_pos;
+  int offset_pos = ids_pos + entry_cnt * plan_.id_unit;
+  int bool_ids_pos = offset_pos + entry_cnt * 4;
+  int bool_bits_pos = bool_ids_pos + bool_cnt * plan_.id_unit;
+  int truth_pos = bool_bits_pos + (bool_cnt + 7) / 8;
+  int data_pos = truth_pos + 2;
+  buf.ReSize(start + data_pos);
+  buf.WriteByte(start + truth_pos + 1, 1);
+
+  int bool_ordinal = 0;
+  for (const auto& column : plan_.value_columns) {
+    const auto& value = record.at(column.record_index);
+    if (IsNull(value)) {
+      continue;
+    }
+
+    if (column.type == BaseSchema::kBool) {
+      if (plan_.id_unit == ID_1_BYTE) {
+        buf.WriteByte(start + bool_ids_pos, column.index);
+      } else {
+        buf.WriteShort(start + bool_ids_pos, column.index);
+      }
+      bool_ids_pos += plan_.id_unit;
+      if (*DataOf<bool>(value)) {
+        size_t pos = start + bool_bits_pos + bool_ordinal / 8;
+        buf.WriteByte(pos, buf.Read(pos) | (1 << (bool_ordinal % 8)));
+      }
+      bool_ordinal++;
+      continue;
+    }
+
+    if (plan_.id_unit == ID_1_BYTE) {
+      buf.WriteByte(start + ids_pos, column.index);
+    } else {
+      buf.WriteShort(start + ids_pos, column.index);
+    }
+    ids_pos += plan_.id_unit;
+
+    buf.WriteInt(start + offset_pos, data_pos);
+    offset_pos += 4;
+
+    data_pos += EncodeColumn(column, value, buf, slices);
+  }
+
+  buf.WriteShort(start + plan_.cnt_not_null_col_pos, entry_cnt + bool_cnt);
+  buf.WriteShort(start + plan_.cnt_null_col_pos, 0);
+  buf.WriteShort(start + plan_.ids_pos - 2, bool_cnt);
+
+  // the bool section moves down with the data.
+  if (plan_.compact_offsets) {
+    CompactOffsets(buf, start, plan_.ids_pos + entry_cnt * plan_.id_unit,
+                   plan_.ids_pos + entry_cnt * (plan_.id_unit + 4), entry_cnt,
+                   slices);
+  }
+
+  return buf.Size() - start;
+}
+
+template <typename Record>
+int RecordEncoderV2::NotNullCount(const Record& record) const {
+  if (!plan_.sparse_values) {
+    return plan_.value_columns.size();
+  }
+  int cnt_not_null_col = 0;
+  for (const auto& column : plan_.value_columns) {
+    cnt_not_null_col += !IsNull(record.at(column.record_index));
+  }
+  return cnt_not_null_col;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeSparseValue(const Record& record,
+                                       int cnt_not_null_col, Buf& buf,
+                                       ValueSlices* slices) const {
+  // the header of the plain layout up to its id table.
+  size_t start = buf.Size();
+  buf.Enlarge(plan_.ids_pos);
+  memcpy(buf.Data() + start, plan_.value_header.data(), plan_.ids_pos);
+
+  int ids_pos = plan_.ids_pos;
+  int offset_pos = ids_pos + cnt_not_null_col * plan_.id_unit;
+  int data_pos = offset_pos + cnt_not_null_col * 4;
+  int data_start = data_pos;
+  buf.ReSize(start + data_pos);
+
+  for (const auto& column : plan_.value_columns) {
+    const auto& value = record.at(column.record_index);
+    if (IsNull(value)) {
+      continue;
+    }
+
+    if (plan_.id_unit == ID_1_BYTE) {
+      buf.WriteByte(start + ids_pos, column.index);
+    } else {
+      buf.WriteShort(start + ids_pos, column.index);
+    }
+    ids_pos += plan_.id_unit;
+
+    buf.WriteInt(start + offset_pos, data_pos);
+    offset_pos += 4;
+
+    data_pos += EncodeColumn(column, value, buf, slices);
+  }
+
+  buf.WriteShort(start + plan_.cnt_not_null_col_pos, cnt_not_null_col);
+  buf.WriteShort(start + plan_.cnt_null_col_pos, 0);
+
+  if (plan_.compact_offsets) {
+    CompactOffsets(buf, start, plan_.ids_pos + cnt_not_null_col * plan_.id_unit,
+                   data_start, cnt_not_null_col, slices);
+  }
+
+  return buf.Size() - start;
+}
+
+template <typename Record>
+int RecordEncoderV2::EncodeValueWithStaticOffsets(const Record& record,
+                                                  Buf& buf,
+                                                  ValueSlices* slices) const {
+  size_t start = buf.Size();
+  buf.WriteString(plan_.value_header);
+
+  // the fixed width columns back to back, zeros for a null one.
+  int cnt_null_col = 0;
+  uint8_t bits = 0;
+  for (int i = 0; i < plan_.fixed_cnt; ++i) {
+    const auto& column = plan_.value_columns[i];
+    const auto& value = record.at(column.record_index);
+    if (IsNull(value)) {
+      bits |= 1 << (i % 8);
+      cnt_null_col++;
+      buf.Enlarge(column.value_length);
+    } else {
+      column.Encode(value, buf);
+    }
+    if (i % 8 == 7 || i == plan_.fixed_cnt - 1) {
+      buf.WriteByte(start + plan_.null_bitmap_pos + i / 8, bits);
+      bits = 0;
+    }
+  }
+
+  int col_cnt = plan_.value_columns.size();
+  int offset_pos = plan_.offset_pos;
+  int data_pos = buf.Size() - start;
+  for (int i = plan_.fixed_cnt; i < col_cnt; ++i) {
+    const auto& column = plan_.value_columns[i];
+    const auto& value = record.at(column.record_index);
+    if (IsNull(value)) {
+      cnt_null_col++;
+      buf.WriteInt(start + offset_pos, -1);
+    } else {
+      buf.WriteInt(start + offset_pos, data_pos);
+      data_pos += EncodeColumn(column, value, buf, slices);
+    }
+    offset_pos += 4;
+  }
+
+  buf.WriteShort(start + plan_.cnt_not_null_col_pos, col_cnt - cnt_null_col);
+  buf.WriteShort(start + plan_.cnt_null_col_pos, cnt_null_col);
+
+  return buf.Size() - start;
+}
+
+int RecordEncoderV2::Encode(char prefix, const std::vector<std::any>& record,
+                            std::string& key, std::string& value) const {
+  return EncodeImpl(prefix, record, key, value);
+}
+
+int RecordEncoderV2::Encode(char prefix,
+                            const std::vector<ColumnValue>& record,
+                            std::string& key, std::string& value) const {
+  return EncodeImpl(prefix, record, key, value);
+}
+
+int RecordEncoderV2::EncodeKey(char prefix, const std::vector<std::any>& record,
+                               std::string& output) const {
+  return EncodeKeyImpl(prefix, record, output);
+}
+
+int RecordEncoderV2::EncodeKey(char prefix,
+                               const std::vector<ColumnValue>& record,
+                               std::string& output) const {
+  return EncodeKeyImpl(prefix, record, output);
+}
+
+int RecordEncoderV2::EncodeKey(char prefix, const std::vector<std::any>& record,
+                               Buf& buf) const {
+  return EncodeKeyImpl(prefix, record, buf);
+}
+
+int RecordEncoderV2::EncodeKey(char prefix,
+                               const std::vector<ColumnValue>& record,
+                               Buf& buf) const {
+  return EncodeKeyImpl(prefix, record, buf);
+}
+
+int RecordEncoderV2::EncodeVersionKey(char prefix,
+                                      const std::vector<std::any>& record,
+                                      int64_t ts, std::string& output) const {
+  return EncodeVersionKeyImpl(prefix, record, ts, output);
+}
+
+int RecordEncoderV2::EncodeVersionKey(char prefix,
+                                      const std::vector<ColumnValue>& record,
+                                      int64_t ts, std::string& output) const {
+  return EncodeVersionKeyImpl(prefix, record, ts, output);
+}
+
+int RecordEncoderV2::EncodeValue(const std::vector<std::any>& record,
+                                 std::string& output) const {
+  return EncodeValueImpl(record, output);
+}
+
+int RecordEncoderV2::EncodeValue(const std::vector<ColumnValue>& record,
+                                 std::string& output) const {
+  return EncodeValueImpl(record, output);
+}
+
+int RecordEncoderV2::EncodeValue(const std::vector<std::any>& record,
+                                 ValueSlices& output) const {
+  return EncodeValueImpl(record, output);
+}
+
+int RecordEncoderV2::EncodeValue(const std::vector<ColumnValue>& record,
+                                 ValueSlices& output) const {
+  return EncodeValueImpl(record, output);
+}
+
+int RecordEncoderV2::EncodeValue(const std::vector<std::any>& record,
+                                 Buf& buf) const {
+  return EncodeValueImpl(record, buf);
+}
+
+int RecordEncoderV2::EncodeValue(const std::vector<ColumnValue>& record,
+                                 Buf& buf) const {
+  return EncodeValueImpl(record, buf);
+}
+
+int RecordEncoderV2::EncodeKeyTo(char prefix,
+                                 const std::vector<std::any>& record, char* dst,
+                                 size_t cap) const {
+  return EncodeKeyToImpl(prefix, record, dst, cap);
+}
+
+int RecordEncoderV2::EncodeValueTo(const std::vector<std::any>& record,
+                                   char* dst, size_t cap) const {
+  return EncodeValueToImpl(record, dst, cap);
+}
+
+int RecordEncoderV2::EncodeKeyTo(char prefix,
+                                 const std::vector<ColumnValue>& record,
+                                 char* dst, size_t cap) const {
+  return EncodeKeyToImpl(prefix, record, dst, cap);
+}
+
+int RecordEncoderV2::EncodeValueTo(const std::vector<ColumnValue>& record,
+                                   char* dst, size_t cap) const {
+  return EncodeValueToImpl(record, dst, cap);
+}
+
+int RecordEncoderV2::EncodedKeySize(
+    const std::vector<std::any>& record) const {
+  return EncodedKeySizeImpl(record);
+}
+
+int RecordEncoderV2::EncodedKeySize(
+    const std::vector<ColumnValue>& record) const {
+  return EncodedKeySizeImpl(record);
+}
+
+int RecordEncoderV2::EncodedValueSize(
+    const std::vector<std::any>& record) const {
+  return EncodedValueSizeImpl(record);
+}
+
+int RecordEncoderV2::EncodedValueSize(
+    const std::vector<ColumnValue>& record) const {
+  return EncodedValueSizeImpl(record);
+}
+
+const RecordEncoderV2::ColumnPlan* RecordEncoderV2::FindValueColumn(
+    int index) const {
+  for (const auto& column : plan_.value_columns) {
+    if (column.record_index == index) {
+      return &column;
+    }
+  }
+  return nullptr;
+}
+
+int RecordEncoderV2::UpdateValue(std::string_view value,
+                                 const std::map<int, std::any>& updates,
+                                 std::string& output) const {
+  thread_local std::string scratch;
+  if (!InflateValue(value, scratch, this->le_) || value.size() < 8) {
+    return -1;
+  }
+
+  BufView value_buf(value, this->le_);
+  int format = GetValueFormat(value_buf.ReadInt(0));
+  if ((format & ~kValueFormatKnownFlags) != 0 ||
+      (format & VALUE_FORMAT_BOOL_BITS) ||
+      (format & kValueDataFormatFlags) !=
+          (plan_.format & kValueDataFormatFlags)) {
+    return -1;
+  }
+  value_buf.Skip(4);
+  ValueHeader header(value_buf, format);
+  int entry_cnt = header.entry_cnt;
+  int fixed_cnt = header.fixed_cnt;
+  if (static_cast<size_t>(header.data_pos) > value.size() ||
+      fixed_cnt > entry_cnt) {
+    return -1;
+  }
+
+  // Every table entry with its data [offset, end), -1 for null. The fixed
+  // width columns of a static offsets value also keep their pos when null.
+  struct Entry {
+    const ColumnPlan* column;
+    int pos;
+    int offset;
+    int end;
+    const std::any* update;
+  };
+  thread_local std::vector<Entry> entries;
+  entries.assign(entry_cnt, {nullptr, -1, -1, -1, nullptr});
+  int data_start = header.data_pos;
+  for (int i = 0; i < entry_cnt; ++i) {
+    auto& entry = entries[i];
+    entry.column = FindValueColumn(header.ReadId(value_buf, i));
+    if (i < fixed_cnt) {
+      if (entry.column == nullptr || entry.column->value_length == 0) {
+        return -1;
+      }
+      entry.pos = data_start;
+      entry.offset = header.IsNullColumn(value_buf, i) ? -1 : data_start;
+      data_start += entry.column->value_length;
+      entry.end = data_start;
+    } else {
+      entry.offset = header.ReadOffset(value_buf, i - fixed_cnt);
+      entry.pos = entry.offset;
+    }
+  }
+  if (static_cast<size_t>(data_start) > value.size()) {
+    return -1;
+  }
+  // the data follows the table order, a column ends where the next starts.
+  int end = value.size();
+  for (int i = entry_cnt - 1; i >= fixed_cnt; --i) {
+    auto& entry = entries[i];
+    if (entry.offset == -1) {
+      continue;
+    }
+    if (entry.offset < data_start || entry.offset > end) {
+      return -1;
+    }
+    entry.end = end;
+    end = entry.offset;
+  }
+
+  bool in_place = true;
+  for (const auto& [index, data] : updates) {
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [index = index](const Entry& entry) {
+                             return entry.column != nullptr &&
+                                    entry.column->record_index == index;
+                           });
+    // the tables of a null bitmap value only hold not null columns.
+    if (it == entries.end() || (header.HasNullBitmap() && !data.has_value())) {
+      return -1;
+    }
+    it->update = &data;
+    // a fixed width column has room for the new data where it is.
+    in_place = in_place && (it - entries.begin() < fixed_cnt ||
+                            (it->column->value_length > 0 &&
+                             it->offset != -1 && data.has_value()));
+  }
+
+  Buf buf = AcquireBuf(output, kBufInitCapacity);
+  auto write_offset = [&](int i, int offset) {
+    if (header.offset_unit == OFFSET_2_BYTE) {
+      buf.WriteShort(header.offset_pos + i * OFFSET_2_BYTE,
+                     offset == -1 ? kCompactOffsetNull : offset);
+    } else {
+      buf.WriteInt(header.offset_pos + i * OFFSET_4_BYTE, offset);
+    }
+  };
+
+  int cnt_null_col = header.cnt_null_col;
+  buf.Enlarge(in_place ? value.size() : data_start);
+  memcpy(buf.Data(), value.data(), buf.Size());
+  if (!in_place) {
+    for (int i = fixed_cnt; i < entry_cnt; ++i) {
+      const auto& entry = entries[i];
+      int offset = buf.Size();
+      if (entry.update == nullptr) {
+        if (entry.offset != -1) {
+          write_offset(i - fixed_cnt, offset);
+          buf.Enlarge(entry.end - entry.offset);
+          memcpy(buf.Data() + offset, value.data() + entry.offset,
+                 entry.end - entry.offset);
+        }
+        continue;
+      }
+
+      if (!entry.update->has_value()) {
+        write_offset(i - fixed_cnt, -1);
+        cnt_null_col += entry.offset == -1 ? 0 : 1;
+      } else {
+        write_offset(i - fixed_cnt, offset);
+        entry.column->encode(entry.column->schema, *entry.update, buf);
+        cnt_null_col -= entry.offset == -1 ? 1 : 0;
+      }
+    }
+  }
+
+  // fixed width columns in place, a static offsets value keeps the nulls too.
+  Buf word(8, this->le_);
+  for (int i = 0; i < entry_cnt; ++i) {
+    const auto& entry = entries[i];
+    if (entry.update == nullptr || (!in_place && i >= fixed_cnt)) {
+      continue;
+    }
+    char* data = buf.Data() + entry.pos;
+    if (entry.update->has_value()) {
+      word.Clear();
+      entry.column->encode(entry.column->schema, *entry.update, word);
+      memcpy(data, word.Data(), entry.column->value_length);
+      cnt_null_col -= entry.offset == -1 ? 1 : 0;
+    } else {
+      memset(data, 0, entry.column->value_length);
+      cnt_null_col += entry.offset == -1 ? 0 : 1;
+    }
+    if (i < fixed_cnt) {
+      uint8_t bit = 1 << (i % 8);
+      char& bits = buf.Data()[header.null_bitmap_pos + i / 8];
+      bits = entry.update->has_value() ? (bits & ~bit) : (bits | bit);
+    }
+  }
+
+  if (header.offset_unit == OFFSET_2_BYTE && buf.Size() >= kCompactOffsetNull) {
+    buf.GetString(output);
+    return -1;
+  }
+  buf.WriteShort(plan_.cnt_not_null_col_pos,
+                 header.total_col_cnt - cnt_null_col);
+  buf.WriteShort(plan_.cnt_null_col_pos, cnt_null_col);
+  // the trailer of value was left behind, the flag follows checksum_.
+  if (format & VALUE_FORMAT_CHECKSUM) {
+    buf.WriteInt(0, SetValueFormat(buf.ReadInt(0),
+                                   format & ~VALUE_FORMAT_CHECKSUM));
+  }
+
+  if (compression_ != CompressionType::kNone &&
+      buf.Size() >= compression_threshold_) {
+    CompressValue(buf, 0);
+  }
+  if (checksum_) {
+    AppendChecksum(buf, 0);
+  }
+  buf.GetString(output);
+  return output.size();
+}
+
+void RecordEncoderV2::CompressValue(Buf& buf, size_t start) const {
+  size_t rest = buf.Size() - start - 4;
+  if (rest > INT32_MAX) {
+    return;
+  }
+
+  // compressed bytes before they are copied behind the header.
+  thread_local std::string scratch;
+  scratch.resize(MaxCompressedSize(compression_, rest));
+  size_t len = Compress(compression_, buf.Data() + start + 4, rest,
+                        scratch.data(), scratch.size());
+  if (len == 0 || kCompressedHeaderSize + len >= rest + 4) {
+    return;
+  }
+
+  int32_t version = buf.ReadInt(start);
+  buf.WriteInt(start, SetValueFormat(version, GetValueFormat(version) |
+                                                  VALUE_FORMAT_COMPRESSED));
+  buf.WriteByte(start + 4, static_cast<uint8_t>(compression_));
+  buf.WriteInt(start + 5, rest);
+  memcpy(buf.Data() + start + kCompressedHeaderSize, scratch.data(), len);
+  buf.ReSize(start + kCompressedHeaderSize + len);
+}
+
+void RecordEncoderV2::AppendChecksum(Buf& buf, size_t start) const {
+  int32_t version = buf.ReadInt(start);
+  buf.WriteInt(start, SetValueFormat(version, GetValueFormat(version) |
+                                                  VALUE_FORMAT_CHECKSUM));
+  uint32_t crc = Crc32c(buf.Data() + start, buf.Size() - start);
+  buf.WriteInt(static_cast<int32_t>(crc));
+}
+
+void RecordEncoderV2::CompactOffsets(Buf& buf, size_t start, int offset_pos,
+                                     int data_pos, int entry_cnt,
+                                     ValueSlices* slices) const {
+  int shrink = entry_cnt * (OFFSET_4_BYTE - OFFSET_2_BYTE);
+  size_t size = buf.Size() - start + (slices != nullptr ? slices->external_ : 0);
+  if (entry_cnt == 0 || size - shrink >= kCompactOffsetNull) {
+    return;
+  }
+
+  // The i-th narrow offset never overlaps a wide one still to be read.
+  size_t table_pos = start + offset_pos;
+  for (int i = 0; i < entry_cnt; ++i) {
+    int offset = buf.ReadInt(table_pos + i * OFFSET_4_BYTE);
+    buf.WriteShort(table_pos + i * OFFSET_2_BYTE,
+                   offset == -1 ? kCompactOffsetNull : offset - shrink);
+  }
+
+  size_t data_start = start + data_pos;
+  memmove(buf.Data() + data_start - shrink, buf.Data() + data_start,
+          buf.Size() - data_start);
+  buf.ReSize(buf.Size() - shrink);
+  if (slices != nullptr) {
+    slices->ShiftHoles(data_start, shrink);
+  }
+
+  buf.WriteInt(start, SetValueFormat(schema_version_,
+                                     plan_.format | VALUE_FORMAT_COMPACT_OFFSET));
+}
+
+int RecordEncoderV2::EncodeKeyPrefix(char prefix,
+                                     const std::vector<std::any>& record,
+                                     int column_count,
+                                     std::string& output) const {
+  Buf buf = AcquireBuf(output, kBufInitCapacity);
+
+  EncodePrefix(buf, prefix);
+
+  int count = std::min(column_count, static_cast<int>(plan_.key_columns.size()));
+  for (int i = 0; i < count; ++i) {
+    const auto& column = plan_.key_columns[i];
+    column.schema->EncodeKey(record.at(column.record_index), buf);
+  }
+
+  buf.GetString(output);
+  return output.size();
+}
+
+int RecordEncoderV2::EncodeKeyPrefix(char prefix,
+                                     const std::vector<std::string>& keys,
+                                     std::string& output) const {
+  Buf buf = AcquireBuf(output, kBufInitCapacity);
+
+  EncodePrefix(buf, prefix);
+
+  size_t count = std::min(keys.size(), plan_.key_columns.size());
+  for (size_t i = 0; i < count; ++i) {
+    BaseSchema* schema = plan_.key_columns[i].schema;
+    const auto& key = keys[i];
+    switch (schema->GetType()) {
+      case BaseSchema::kBool:
+        schema->EncodeKey(std::any(StringToBool(key)), buf);
+        break;
+      case BaseSchema::kInteger:
+        schema->EncodeKey(std::any(StringToInt32(key)), buf);
+        break;
+      case BaseSchema::kFloat:
+        schema->EncodeKey(std::any(StringToFloat(key)), buf);
+        break;
+      case BaseSchema::kLong:
+        schema->EncodeKey(std::any(StringToInt64(key)), buf);
+        break;
+      case BaseSchema::kDouble:
+        schema->EncodeKey(std::any(StringToDouble(key)), buf);
+        break;
+      case BaseSchema::kString:
+        schema->EncodeKey(std::any(key), buf);
+        break;
+      default:
+        throw std::runtime_error("Unsupport encoding key list type");
+    }
+  }
+
+  buf.GetString(output);
+  return output.size();
+}
+
+bool RecordEncoderV2::PrefixSuccessor(std::string& output) {
+  // drop trailing 0xFF bytes and increase the last one left.
+  while (!output.empty()) {
+    auto& last = reinterpret_cast<uint8_t&>(output.back());
+    if (last != 0xFF) {
+      ++last;
+      return true;
+    }
+    output.pop_back();
+  }
+  return false;
+}
+
+int RecordEncoderV2::EncodeKeyPrefixSuccessor(
+    char prefix, const std::vector<std::any>& record, int column_count,
+    std::string& output) const {
+  EncodeKeyPrefix(prefix, record, column_count, output);
+  if (!PrefixSuccessor(output)) {
+    return -1;
+  }
+  return output.size();
+}
+
+int RecordEncoderV2::EncodeKeyPrefixSuccessor(
+    char prefix, const std::vector<std::string>& keys,
+    std::string& output) const {
+  EncodeKeyPrefix(prefix, keys, output);
+  if (!PrefixSuccessor(output)) {
+    return -1;
+  }
+  return output.size();
+}
+
 int RecordEncoderV2::EncodeMaxKeyPrefix(char prefix,
                                         std::string& output) const {
   if (common_id_ == INT64_MAX) {
@@ -18,9 +18,19 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "any"
 #include "common.h"
+#include "serial/record/V2/column_batch.h"
+#include "serial/record/V2/column_descriptor.h"
+#include "serial/record/V2/column_group.h"
+#include "serial/record/V2/encoded_batch.h"
+#include "serial/record/V2/encode_stats.h"
+#include "serial/record/V2/value_slices.h"
+#include "serial/record/V2/version_key.h"
+#include "serial/utils/V2/codec_stats.h"
 #include "functional"  // IWYU pragma: keep
 #include "optional"    // IWYU pragma: keep
 #include "serial/schema/V2/boolean_list_schema.h" // IWYU pragma: keep
@@ -35,6 +45,9 @@
 #include "serial/schema/V2/long_schema.h"  // IWYU pragma: keep
 #include "serial/schema/V2/string_list_schema.h" // IWYU pragma: keep
 #include "serial/schema/V2/string_schema.h"  // IWYU pragma: keep
+#include "serial/utils/V2/compression.h"
+#include "serial/utils/V2/parallel.h"
+#include "serial/utils/V2/radix_sort.h"
 #include "serial/utils/V2/keyvalue.h"        // IWYU pragma: keep
 #include "serial/utils/V2/utils.h" // IWYU pragma: keep
 #include "serial/utils/V2/utils.h"  // IWYU pragma: keep
@@ -45,6 +58,9 @@ namespace serialV2 {
 class RecordEncoderV2;
 using RecordEncoderPtr = std::shared_ptr<RecordEncoderV2>;
 
+// The Set* calls and Refresh configure the encoder, once configured every
+// Encode* call only reads it and keeps its scratch in the caller's outputs or
+// per thread buffers, so one encoder may serve all threads at once.
 class RecordEncoderV2 {
  public:
   RecordEncoderV2(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
@@ -60,19 +76,448 @@ class RecordEncoderV2 {
   }
 
   int Encode(char prefix, const std::vector<std::any>& record, std::string& key,
-             std::string& value);
+             std::string& value) const;
 
+  // The same for a record of ColumnValue, see column_value.h, its strings and
+  // lists are read in place and its numbers without an any_cast. The
+  // EncodeKey / EncodeValue / EncodedSize overloads below take both forms.
+  int Encode(char prefix, const std::vector<ColumnValue>& record,
+             std::string& key, std::string& value) const;
+
+  // Encode into output, the storage already held by output is reused, so
+  // passing the same string on every call encodes without allocation once it
+  // has grown large enough.
+  int EncodeKey(char prefix, const std::vector<std::any>& record,
+                std::string& output) const;
+  int EncodeValue(const std::vector<std::any>& record,
+                  std::string& output) const;
+  int EncodeKey(char prefix, const std::vector<ColumnValue>& record,
+                std::string& output) const;
+  int EncodeValue(const std::vector<ColumnValue>& record,
+                  std::string& output) const;
+
+  // The value of EncodeValue as slices, see value_slices.h: the bytes of its
+  // large strings are referenced in the record instead of copied, the rest is
+  // encoded into the scratch of output sized exactly. Returns the value size.
+  int EncodeValue(const std::vector<std::any>& record,
+                  ValueSlices& output) const;
+  int EncodeValue(const std::vector<ColumnValue>& record,
+                  ValueSlices& output) const;
+
+  // The key of the version ts of record, EncodeKey followed by the ts
+  // suffix of version_key.h, written in one go. The same bytes are the seek
+  // key for the latest version of record at or before ts.
+  int EncodeVersionKey(char prefix, const std::vector<std::any>& record,
+                       int64_t ts, std::string& output) const;
+  int EncodeVersionKey(char prefix, const std::vector<ColumnValue>& record,
+                       int64_t ts, std::string& output) const;
+
+  // The row split into its column groups, see column_group.h: values is
+  // resized to ColumnGroupCount() and values[g] holds the value columns of
+  // group g (BaseSchema::SetColumnGroup), in the layout of EncodeValue with
+  // the columns of the other groups left out, to be stored under
+  // ColumnGroupKey(key, g). A read then fetches only the groups it projects,
+  // see RecordDecoderV2::DecodeColumnGroups. Encode keeps writing every
+  // column into one value.
+  int EncodeColumnGroups(char prefix, const std::vector<std::any>& record,
+                         std::string& key,
+                         std::vector<std::string>& values /*output*/) const;
+  int EncodeColumnGroups(char prefix, const std::vector<ColumnValue>& record,
+                         std::string& key,
+                         std::vector<std::string>& values /*output*/) const;
+  // The highest group of the value columns plus one.
+  int ColumnGroupCount() const {
+    return group_encoders_.empty() ? 1 : group_encoders_.size();
+  }
+
+  // Encode records[i] into keys[i] and values[i], both resized to the record
+  // count with the storage of their strings reused. The rows are spread over
+  // the workers of options, exceptions are rethrown here.
+  int EncodeBatch(char prefix,
+                  const std::vector<std::vector<std::any>>& records,
+                  std::vector<std::string>& keys /*output*/,
+                  std::vector<std::string>& values /*output*/,
+                  const ParallelOptions& options = {}) const;
+
+  // Encode records into the arena of output, row after row on the calling
+  // thread, instead of a string per key and value.
+  int EncodeBatch(char prefix,
+                  const std::vector<std::vector<std::any>>& records,
+                  EncodedBatch& output /*output*/) const;
+
+  // Encode the keys of records into the arena of keys, row i its key and an
+  // empty value, and set order to the rows sorted by key bytes, the order of
+  // the keys in storage, see RadixSortKeys. The keys are encoded on the
+  // calling thread and sorted over the workers of options.
+  int EncodeAndSortKeys(char prefix,
+                        const std::vector<std::vector<std::any>>& records,
+                        EncodedBatch& keys /*output*/,
+                        std::vector<uint32_t>& order /*output*/,
+                        const ParallelOptions& options = {}) const;
+
+  // Encode the rows of a batch held column by column into output, columns
+  // being laid out as a record, one ColumnArray per schema with the values of
+  // all rows (the column of a null schema is not read). The fixed width
+  // value columns are encoded across the batch first, then the rows are put
+  // together in the arena, the bytes are those of EncodeKey / EncodeValue for
+  // each row. Returns -1 when a column does not have the type of its schema.
+  int EncodeBatch(char prefix, const std::vector<ColumnArray>& columns,
+                  size_t rows, EncodedBatch& output /*output*/) const;
+
+  // Encode the keys of a batch held column by column into the arena of keys,
+  // row i its key and an empty value, the bytes are those of EncodeKey. When
+  // every key column has a fixed width (bool, int32, int64, float, double)
+  // the keys are built with one pass per key column over the batch, its
+  // order flip and byte swap done word after word, instead of the schemas
+  // row by row. Returns -1 when a column does not have the type of its
+  // schema.
+  int EncodeKeys(char prefix, const std::vector<ColumnArray>& columns,
+                 size_t rows, EncodedBatch& keys /*output*/) const;
+
+  // Encode as above and add the columns of the rows to stats, a collector
+  // over the schemas of this encoder, see NewStatsCollector. The batch
+  // workers collect their chunks apart and merge them into stats.
+  int Encode(char prefix, const std::vector<std::any>& record, std::string& key,
+             std::string& value, EncodeStatsCollector& stats) const;
+  int EncodeBatch(char prefix,
+                  const std::vector<std::vector<std::any>>& records,
+                  std::vector<std::string>& keys /*output*/,
+                  std::vector<std::string>& values /*output*/,
+                  EncodeStatsCollector& stats,
+                  const ParallelOptions& options = {}) const;
+
+  EncodeStatsCollector NewStatsCollector() const {
+    return EncodeStatsCollector(schemas_);
+  }
+
+  // Append the encoded key/value at the end of buf (e.g. a per thread scratch
+  // buffer), return the appended length.
   int EncodeKey(char prefix, const std::vector<std::any>& record,
-                std::string& output);
-  int EncodeValue(const std::vector<std::any>& record, std::string& output);
+                Buf& buf) const;
+  int EncodeValue(const std::vector<std::any>& record, Buf& buf) const;
+  int EncodeKey(char prefix, const std::vector<ColumnValue>& record,
+                Buf& buf) const;
+  int EncodeValue(const std::vector<ColumnValue>& record, Buf& buf) const;
+
+  // Write the encoded key/value into the cap bytes at dst, e.g. a registered
+  // memory region. Returns the bytes of the encoding, when more than cap
+  // nothing is written and the call is repeated with that much room. The
+  // encoding is written in place, the large strings of a value copied once,
+  // straight from the record.
+  int EncodeKeyTo(char prefix, const std::vector<std::any>& record, char* dst,
+                  size_t cap) const;
+  int EncodeValueTo(const std::vector<std::any>& record, char* dst,
+                    size_t cap) const;
+  int EncodeKeyTo(char prefix, const std::vector<ColumnValue>& record,
+                  char* dst, size_t cap) const;
+  int EncodeValueTo(const std::vector<ColumnValue>& record, char* dst,
+                    size_t cap) const;
+
+  // Bytes EncodeKey / EncodeValue write for record, from the string lengths,
+  // list sizes and nulls of its columns without encoding them. Exact unless
+  // the value gets compressed, the size is then an upper bound.
+  int EncodedKeySize(const std::vector<std::any>& record) const;
+  int EncodedValueSize(const std::vector<std::any>& record) const;
+  int EncodedSize(const std::vector<std::any>& record) const {
+    return EncodedKeySize(record) + EncodedValueSize(record);
+  }
+  int EncodedKeySize(const std::vector<ColumnValue>& record) const;
+  int EncodedValueSize(const std::vector<ColumnValue>& record) const;
+  int EncodedSize(const std::vector<ColumnValue>& record) const {
+    return EncodedKeySize(record) + EncodedValueSize(record);
+  }
+
+  // Set the value columns of updates, schema index to new value (an empty
+  // any for null), in value, a row of these schemas, into output without
+  // decoding the other columns: a fixed width column is overwritten in place,
+  // the others are spliced in and the data behind them moved. Returns -1 when
+  // value can not be patched, e.g. for a key column or one the row lacks, a
+  // null change with a null bitmap, a bool bits value, other data format
+  // flags or 2 bytes offsets outgrown, decode and encode the row then.
+  int UpdateValue(std::string_view value,
+                  const std::map<int, std::any>& updates,
+                  std::string& output) const;
+
+  // Encode prefix | common_id | the first column_count key columns, every
+  // key starting with these columns has output as its prefix. keys holds the
+  // leading key column values as strings.
+  int EncodeKeyPrefix(char prefix, const std::vector<std::any>& record,
+                      int column_count, std::string& output) const;
+  int EncodeKeyPrefix(char prefix, const std::vector<std::string>& keys,
+                      std::string& output) const;
+
+  // The smallest key greater than every key with the encoded prefix, the end
+  // of the prefix range scan. Returns -1 when there is no such key.
+  int EncodeKeyPrefixSuccessor(char prefix, const std::vector<std::any>& record,
+                               int column_count, std::string& output) const;
+  int EncodeKeyPrefixSuccessor(char prefix, const std::vector<std::string>& keys,
+                               std::string& output) const;
+
+  // The 9 bytes every key of this table in namespace prefix starts with,
+  // prefix | common_id, e.g. the start of a scan over the table.
+  std::string KeyPrefix(char prefix) const;
 
   int EncodeMaxKeyPrefix(char prefix, std::string& output) const;
   int EncodeMinKeyPrefix(char prefix, std::string& output) const;
+
+  // Count the rows of Encode and EncodeBatch in stats, nullptr stops
+  // counting. Only with DINGO_SERIAL_CODEC_STATS, see codec_stats.h.
+  void SetStats(CodecStats* stats) { stats_ = stats; }
+
+  // Rebuild the encode plan, call it after the schemas have been changed.
   void Refresh();
 
+  int GetSchemaVersion() const { return schema_version_; }
+  long GetCommonId() const { return common_id_; }
+  bool IsLe() const { return le_; }
+  const std::vector<BaseSchemaPtr>& GetSchemas() const { return schemas_; }
+
+  // Bytes the encoder holds, itself, its plans and those of its group
+  // encoders; the schemas are shared with the caller and not counted.
+  size_t MemoryUsage() const;
+
+  // Write values with 1 byte ids when every value column index is below 255
+  // and 2 bytes offsets when the value is below 64KB. Values so written are
+  // flagged and rejected by decoders predating the compact header.
+  void SetCompactValueHeader(bool compact);
+
+  // Write values with the null columns in a bitmap over the value columns,
+  // leaving them out of the id and offset tables. Flagged like the compact
+  // header.
+  void SetNullBitmap(bool null_bitmap);
+
+  // Write a value with at least half its value columns null with the not
+  // null columns alone in the id and offset tables, the others with all
+  // columns. The layout is the plain one with fewer ids, decoders find the
+  // missing ids null as for columns added since a row was written, so the
+  // values are not flagged. A value so written loses the constant id table
+  // its columns are looked up by position with, they are then searched for.
+  // Only for the plain layout, the null bitmap and static offsets ones keep
+  // theirs.
+  void SetSparseValues(bool sparse);
+
+  // Write values with the fixed width columns first, at offsets known from
+  // the schemas, and their nulls in a bitmap, only the other columns get an
+  // offset. Takes the place of the null bitmap and the 2 bytes offsets, the
+  // ids may still be compact. Flagged like the compact header, a decoder
+  // needs the length of every fixed width column of the writer, so decode
+  // such rows with the schemas of their version once columns are dropped.
+  // The columns are laid out by ValueLayoutBefore, so the hot fixed width
+  // ones of BaseSchema::SetAccessFrequency share the first cache line.
+  void SetStaticOffsets(bool static_offsets);
+
+  // Write the not null bool value columns of a value as one bit each in a
+  // section behind the id and offset tables, by their sorted ids, instead of
+  // an id, an offset and a byte each, the null columns left out. Values of
+  // schemas without a bool value column keep their layout. Takes the place
+  // of the null bitmap and sparse values, static offsets take its place.
+  // Flagged like the compact header.
+  void SetBoolBits(bool bool_bits);
+
+  // Compress values of at least threshold bytes, a value is kept raw when
+  // compression does not make it smaller. Compressed values are
+  // schema version | type(1 byte) | raw size(4 bytes) | compressed rest, the
+  // schema version carries the flags of the raw value and
+  // VALUE_FORMAT_COMPRESSED. Throws runtime_error when type is not built in.
+  void SetCompression(CompressionType type,
+                      size_t threshold = kDefaultCompressionThreshold);
+
+  static constexpr size_t kDefaultCompressionThreshold = 256;
+
+  // Append a CRC-32C of every value, compressed or not, behind it and flag
+  // it, see VALUE_FORMAT_CHECKSUM: a receiver checks the whole value once
+  // with VerifyValueChecksum or RecordDecoderV2::SetVerifyChecksums and then
+  // decodes it without the bounds checks. Costs 4 bytes per value.
+  void SetChecksum(bool checksum);
+
+  // Writes the not null value of a column, resolved once at plan time.
+  using EncodeFunc = int (*)(BaseSchema* schema, const std::any& data,
+                             Buf& buf);
+  using VariantEncodeFunc = int (*)(BaseSchema* schema,
+                                    const ColumnValue& data, Buf& buf);
+
  private:
+  // A column resolved for encoding, record_index is its position in the
+  // record.
+  struct ColumnPlan : ColumnDescriptor {
+    int record_index;
+    // value columns only.
+    EncodeFunc encode;
+    VariantEncodeFunc encode_variant;
+    // a string written in the plain form or a string list, ValueSlices may
+    // reference their bytes.
+    bool in_place{false};
+
+    int Encode(const std::any& data, Buf& buf) const {
+      return encode(schema, data, buf);
+    }
+    int Encode(const ColumnValue& data, Buf& buf) const {
+      return encode_variant(schema, data, buf);
+    }
+  };
+
+  // Everything derived from the schemas that does not change between rows.
+  struct EncodePlan {
+    std::vector<ColumnPlan> key_columns;
+    std::vector<ColumnPlan> value_columns;
+
+    // value header layout.
+    int cnt_not_null_col_pos{0};
+    int cnt_null_col_pos{0};
+    int ids_pos{0};
+    int offset_pos{0};
+    int data_pos{0};
+
+    // value format flags known at plan time, and whether to try narrowing
+    // the offsets once the value size is known.
+    int format{0};
+    bool compact_offsets{false};
+
+    int id_unit{ID_2_BYTE};
+    // with a null bitmap, ids_pos is right behind it and the tables only hold
+    // the not null columns.
+    int null_bitmap_pos{0};
+    int null_bitmap_size{0};
+
+    // rows with at least half the value columns null are written sparse.
+    bool sparse_values{false};
+
+    // with static offsets the value columns are ordered fixed width first,
+    // the bitmap at null_bitmap_pos covers them and the offsets the others.
+    bool static_offsets{false};
+    int fixed_cnt{0};
+
+    // with bool bits the bool value columns, bool_cnt(2 bytes) in front of
+    // ids_pos, go to the section behind the tables.
+    bool bool_bits{false};
+
+    // schema version | zero counts | id table, copied in front of every value.
+    std::string value_header;
+
+    // bytes of every key when all key columns have a fixed width, 0 when
+    // the keys vary.
+    size_t fixed_key_size{0};
+  };
+
+  void BuildPlan();
+  // A copy of this encoder per column group of the value columns, each with
+  // the columns of the other groups left out, none without groups.
+  void BuildColumnGroups();
+
+  // The value column of schema index, nullptr for none.
+  const ColumnPlan* FindValueColumn(int index) const;
+
+  // The encode of both record forms, Record is a vector of std::any or of
+  // ColumnValue.
+  template <typename Record>
+  int EncodeImpl(char prefix, const Record& record, std::string& key,
+                 std::string& value) const;
+  template <typename Record>
+  int EncodeKeyImpl(char prefix, const Record& record,
+                    std::string& output) const;
+  template <typename Record>
+  int EncodeKeyImpl(char prefix, const Record& record, Buf& buf) const;
+  template <typename Record>
+  int EncodeColumnGroupsImpl(char prefix, const Record& record,
+                             std::string& key,
+                             std::vector<std::string>& values) const;
+  template <typename Record>
+  int EncodeVersionKeyImpl(char prefix, const Record& record, int64_t ts,
+                           std::string& output) const;
+  template <typename Record>
+  int EncodeValueImpl(const Record& record, std::string& output) const;
+  template <typename Record>
+  int EncodeValueImpl(const Record& record, Buf& buf,
+                      ValueSlices* slices = nullptr) const;
+  template <typename Record>
+  int EncodeValueImpl(const Record& record, ValueSlices& output) const;
+  template <typename Record>
+  int EncodeKeyToImpl(char prefix, const Record& record, char* dst,
+                      size_t cap) const;
+  template <typename Record>
+  int EncodeValueToImpl(const Record& record, char* dst, size_t cap) const;
+  template <typename Record>
+  int EncodedKeySizeImpl(const Record& record) const;
+  template <typename Record>
+  int EncodedValueSizeImpl(const Record& record) const;
+
+  // The layouts, a string of at least the threshold of slices is left out of
+  // buf and recorded in slices when given.
+  template <typename Record>
+  int EncodeValueWithOffsets(const Record& record, Buf& buf,
+                             ValueSlices* slices) const;
+  template <typename Record>
+  int EncodeValueWithNullBitmap(const Record& record, Buf& buf,
+                                ValueSlices* slices) const;
+  template <typename Record>
+  int EncodeValueWithStaticOffsets(const Record& record, Buf& buf,
+                                   ValueSlices* slices) const;
+  template <typename Record>
+  int EncodeValueWithBoolBits(const Record& record, Buf& buf,
+                              ValueSlices* slices) const;
+  // The plain layout with the cnt_not_null_col not null columns alone.
+  template <typename Record>
+  int EncodeSparseValue(const Record& record, int cnt_not_null_col, Buf& buf,
+                        ValueSlices* slices) const;
+  // column.Encode, or the length alone of a string slices references.
+  template <typename Value>
+  static int EncodeColumn(const ColumnPlan& column, const Value& value,
+                          Buf& buf, ValueSlices* slices);
+  // As EncodeStringListNotComparable, the elements of at least the threshold
+  // of slices referenced.
+  static int EncodeStringList(const std::vector<std::string>& data, Buf& buf,
+                              ValueSlices& slices);
+  // Bytes of record the slices of threshold reference.
+  template <typename Record>
+  size_t InPlaceSize(const Record& record, size_t threshold) const;
+  // The not null value columns of record, and whether the row is written
+  // sparse with that many.
+  template <typename Record>
+  int NotNullCount(const Record& record) const;
+  bool IsSparseRow(int cnt_not_null_col) const {
+    return plan_.sparse_values &&
+           cnt_not_null_col * 2 <= static_cast<int>(plan_.value_columns.size());
+  }
+
+  // Encode a fixed width value column over rows into run, left empty for the
+  // other columns.
+  void EncodeValueRun(const ColumnPlan& column, const ColumnArray& array,
+                      size_t rows, EncodedBatch::ColumnRun& run) const;
+
+  // The keys of rows of a batch, plan_.fixed_key_size bytes each, written
+  // back to back at out.
+  void EncodeFixedKeys(char prefix, const std::vector<ColumnArray>& columns,
+                       size_t rows, char* out) const;
+
+  // Compress the value starting at start in place if it is worth it.
+  void CompressValue(Buf& buf, size_t start) const;
+  // Flag the value starting at start and append its checksum.
+  void AppendChecksum(Buf& buf, size_t start) const;
+
+  // Narrow the entry_cnt 4 bytes offsets of the value starting at start to 2
+  // bytes if the value allows it, positions are relative to start. The bytes
+  // slices references count in the value.
+  void CompactOffsets(Buf& buf, size_t start, int offset_pos, int data_pos,
+                      int entry_cnt, ValueSlices* slices = nullptr) const;
+
+  // Size of the value of record with 4 bytes offsets, as it is written before
+  // CompactOffsets, entry_cnt is set to its offset count.
+  template <typename Record>
+  int WideValueSize(const Record& record, int& entry_cnt) const;
+
+  // Count the rows [begin, end) of a batch in stats_.
+  void CountEncoded(const std::vector<std::string>& keys,
+                    const std::vector<std::string>& values, size_t begin,
+                    size_t end) const;
+
+  // Take over the storage of output with room for at least size bytes.
+  Buf AcquireBuf(std::string& output, size_t size) const;
+
+  // Turn a key prefix into its successor in place, false if none exists.
+  static bool PrefixSuccessor(std::string& output);
+
   void EncodePrefix(Buf& buf, char prefix) const;
-  void EncodeSchemaVersion(Buf& buf) const;
+  void EncodeSchemaVersion(Buf& buf, int format) const;
   void EncodeCodecVersion(Buf& buf) const;
 
   // Flag for little end or not.
@@ -83,8 +528,26 @@ class RecordEncoderV2 {
 
   int schema_version_{0x01};
   long common_id_;
+  // common_id_ in buffer byte order, copied behind the prefix of every key.
+  char encoded_common_id_[8];
 
   std::vector<BaseSchemaPtr> schemas_;
+
+  bool compact_value_header_{false};
+  bool null_bitmap_{false};
+  bool static_offsets_{false};
+  bool sparse_values_{false};
+  bool bool_bits_{false};
+  CompressionType compression_{CompressionType::kNone};
+  size_t compression_threshold_{kDefaultCompressionThreshold};
+  bool checksum_{false};
+  CodecStats* stats_{nullptr};
+
+  EncodePlan plan_;
+
+  // the group a group encoder writes, -1 for the encoder of whole rows.
+  int column_group_{-1};
+  std::vector<std::shared_ptr<RecordEncoderV2>> group_encoders_;
 };
 
 }  // namespace serialV2
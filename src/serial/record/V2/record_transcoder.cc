@@ -0,0 +1,250 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "record_transcoder.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "serial/record/V2/common.h"
+#include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/schema_converter.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// prefix(1 byte) + common id(8 bytes).
+constexpr size_t kKeyPrefixSize = 9;
+// V1 codec tag at the key end, the codec version in its last byte.
+constexpr size_t kV1TagSize = 4;
+constexpr uint8_t kV1NotNull = 1;
+
+// Width of a fixed size type, or of a list element after the list size.
+static int FixedWidth(dingodb::BaseSchema::Type type) {
+  switch (type) {
+    case dingodb::BaseSchema::kBool:
+    case dingodb::BaseSchema::kBoolList:
+      return 1;
+    case dingodb::BaseSchema::kInteger:
+    case dingodb::BaseSchema::kFloat:
+    case dingodb::BaseSchema::kIntegerList:
+    case dingodb::BaseSchema::kFloatList:
+      return 4;
+    case dingodb::BaseSchema::kLong:
+    case dingodb::BaseSchema::kDouble:
+    case dingodb::BaseSchema::kLongList:
+    case dingodb::BaseSchema::kDoubleList:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+static bool IsFixed(dingodb::BaseSchema::Type type) {
+  return type <= dingodb::BaseSchema::kDouble &&
+         type != dingodb::BaseSchema::kString;
+}
+
+RecordTranscoder::RecordTranscoder(
+    int schema_version,
+    const std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>&
+        schemas,
+    long common_id)
+    : RecordTranscoder(schema_version, schemas, common_id, IsLE()) {}
+
+RecordTranscoder::RecordTranscoder(
+    int schema_version,
+    const std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>&
+        schemas,
+    long common_id, bool le)
+    : le_(le),
+      schema_version_(schema_version),
+      common_id_(common_id),
+      schemas_(ConvertSchemasV2(schemas)) {
+  for (const auto& schema : *schemas) {
+    if (schema == nullptr) {
+      continue;
+    }
+    if (schema->IsKey()) {
+      if (schema->GetType() == dingodb::BaseSchema::kString) {
+        string_key_cnt_++;
+      }
+    } else {
+      value_columns_.push_back(
+          {schema->GetType(), schema->AllowNull(), schema->GetIndex()});
+    }
+  }
+}
+
+int RecordTranscoder::Transcode(std::string_view key, std::string_view value,
+                                std::string& key_output,
+                                std::string& value_output) const {
+  if (TranscodeKey(key, key_output) < 0) {
+    return -1;
+  }
+  if (TranscodeValue(value, value_output) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int RecordTranscoder::TranscodeKey(std::string_view key,
+                                   std::string& output) const {
+  size_t reverse_size = kV1TagSize + 4 * string_key_cnt_;
+  if (key.size() < kKeyPrefixSize + reverse_size) {
+    return -1;
+  }
+  BufView key_buf(key, this->le_);
+  if (key_buf.ReadLong(1) != common_id_ ||
+      key_buf.Read(key.size() - 1) > CODEC_VERSION_V1) {
+    return -1;
+  }
+
+  size_t forward_size = key.size() - reverse_size;
+  Buf buf(std::move(output), this->le_);
+  buf.Clear();
+  buf.ReSize(forward_size);
+  memcpy(buf.Data(), key.data(), forward_size);
+  buf.WriteInt(CODEC_VERSION_V2);
+
+  buf.GetString(output);
+  return output.size();
+}
+
+int RecordTranscoder::ValueLength(const ValueColumn& column,
+                                  std::string_view value, size_t pos) const {
+  if (IsFixed(column.type)) {
+    return FixedWidth(column.type);
+  }
+
+  BufView value_buf(value, this->le_);
+  if (pos + 4 > value.size()) {
+    return -1;
+  }
+  int64_t cnt = value_buf.ReadInt(pos);
+  if (cnt < 0) {
+    return -1;
+  }
+  switch (column.type) {
+    case dingodb::BaseSchema::kString:
+      return 4 + cnt;
+    case dingodb::BaseSchema::kStringList: {
+      size_t end = pos + 4;
+      for (int64_t i = 0; i < cnt; ++i) {
+        if (end + 4 > value.size()) {
+          return -1;
+        }
+        int len = value_buf.ReadInt(end);
+        if (len < 0) {
+          return -1;
+        }
+        end += 4 + len;
+      }
+      return end - pos;
+    }
+    default:
+      return 4 + cnt * FixedWidth(column.type);
+  }
+}
+
+int RecordTranscoder::TranscodeValue(std::string_view value,
+                                     std::string& output) const {
+  if (value.size() < 4) {
+    return -1;
+  }
+  BufView value_buf(value, this->le_);
+  int schema_version = value_buf.ReadInt(0);
+  if (schema_version > schema_version_) {
+    return -1;
+  }
+
+  // schema_version(4 bytes) + col_cnt(2 bytes + 2 bytes), then 2 byte ids and
+  // 4 byte offsets, as RecordEncoderV2 writes them.
+  int col_cnt = value_columns_.size();
+  int offset_pos = 8 + col_cnt * ID_2_BYTE;
+  int data_pos = offset_pos + col_cnt * OFFSET_4_BYTE;
+
+  Buf buf(std::move(output), this->le_);
+  buf.Clear();
+  buf.Reserve(data_pos + value.size());
+  buf.WriteInt(schema_version);
+  buf.WriteShort(0);
+  buf.WriteShort(0);
+  for (const auto& column : value_columns_) {
+    buf.WriteShort(column.index);
+  }
+  buf.ReSize(data_pos);
+
+  int cnt_null_col = 0;
+  size_t pos = 4;
+  for (const auto& column : value_columns_) {
+    bool is_null = false;
+    if (column.allow_null) {
+      if (pos >= value.size()) {
+        return -1;
+      }
+      is_null = value_buf.Read(pos++) != kV1NotNull;
+    }
+
+    if (is_null) {
+      // V1 still writes zeros for a null of a fixed size type.
+      pos += IsFixed(column.type) ? FixedWidth(column.type) : 0;
+      cnt_null_col++;
+      buf.WriteInt(offset_pos, -1);
+    } else {
+      int len = ValueLength(column, value, pos);
+      if (len < 0 || pos + len > value.size()) {
+        return -1;
+      }
+      buf.WriteInt(offset_pos, buf.Size());
+      size_t end = buf.Size();
+      buf.ReSize(end + len);
+      memcpy(buf.Data() + end, value.data() + pos, len);
+      pos += len;
+    }
+    offset_pos += OFFSET_4_BYTE;
+  }
+  if (pos > value.size()) {
+    return -1;
+  }
+
+  buf.WriteShort(4, col_cnt - cnt_null_col);
+  buf.WriteShort(6, cnt_null_col);
+
+  buf.GetString(output);
+  return output.size();
+}
+
+int RecordTranscoder::TranscodeBatch(const KeyValue* key_values, size_t count,
+                                     std::vector<std::string>& keys,
+                                     std::vector<std::string>& values,
+                                     const ParallelOptions& options) const {
+  keys.resize(count);
+  values.resize(count);
+  std::atomic<bool> failed{false};
+  ParallelFor(count, options, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (Transcode(key_values[i].GetKey(), key_values[i].GetValue(), keys[i],
+                    values[i]) != 0) {
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  });
+  return failed.load() ? -1 : 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
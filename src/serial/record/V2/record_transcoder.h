@@ -0,0 +1,99 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_RECORD_TRANSCODER_V2_H_
+#define DINGO_SERIAL_RECORD_TRANSCODER_V2_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+#include "serial/schema/base_schema.h"
+#include "serial/utils/V2/keyvalue.h"
+#include "serial/utils/V2/parallel.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Rewrites rows encoded by RecordEncoderV1 into the bytes RecordEncoderV2
+ * writes for the same record, without decoding them.
+ *
+ * Both versions encode the key columns alike, a V2 key is the forward part of
+ * the V1 key, without the string lengths V1 keeps at its end, followed by the
+ * V2 codec version, so keys keep their order. Values are laid out again: the
+ * V1 column bytes are copied behind a V2 id and offset table, the row keeps
+ * its schema version.
+ *
+ * The output is the plain V2 layout, no value format flag set, as the schemas
+ * of GetSchemas() read it. Readers must not enable varint, packed bools,
+ * quantized floats or a dictionary on them.
+ */
+class RecordTranscoder {
+ public:
+  RecordTranscoder(
+      int schema_version,
+      const std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>&
+          schemas,
+      long common_id);
+  RecordTranscoder(
+      int schema_version,
+      const std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>&
+          schemas,
+      long common_id, bool le);
+
+  // Returns -1 for a row of another table, a newer codec or schema version
+  // or one too short for its schemas.
+  int Transcode(std::string_view key, std::string_view value,
+                std::string& key_output, std::string& value_output) const;
+  int TranscodeKey(std::string_view key, std::string& output) const;
+  int TranscodeValue(std::string_view value, std::string& output) const;
+
+  // Transcode count rows, split over options.thread_count workers. Returns -1
+  // when any row fails, the others are still written.
+  int TranscodeBatch(const KeyValue* key_values, size_t count,
+                     std::vector<std::string>& keys /*output*/,
+                     std::vector<std::string>& values /*output*/,
+                     const ParallelOptions& options = {}) const;
+
+  // The V2 schemas the output is encoded for.
+  const std::vector<BaseSchemaPtr>& GetSchemas() const { return schemas_; }
+
+ private:
+  struct ValueColumn {
+    dingodb::BaseSchema::Type type;
+    bool allow_null;
+    int index;
+  };
+
+  // Bytes of the not null value at pos, -1 when it runs past the value.
+  int ValueLength(const ValueColumn& column, std::string_view value,
+                  size_t pos) const;
+
+  bool le_;
+  int schema_version_;
+  long common_id_;
+  // key columns of type string, V1 keeps a length for each at the key end.
+  int string_key_cnt_{0};
+  std::vector<ValueColumn> value_columns_;
+  std::vector<BaseSchemaPtr> schemas_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,458 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/row_corpus.h"
+
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <unordered_set>
+
+#include "serial/schema/V2/boolean_list_schema.h"
+#include "serial/schema/V2/boolean_schema.h"
+#include "serial/schema/V2/dingo_schema.h"
+#include "serial/schema/V2/double_list_schema.h"
+#include "serial/schema/V2/double_schema.h"
+#include "serial/schema/V2/float_list_schema.h"
+#include "serial/schema/V2/float_schema.h"
+#include "serial/schema/V2/integer_list_schema.h"
+#include "serial/schema/V2/integer_schema.h"
+#include "serial/schema/V2/long_list_schema.h"
+#include "serial/schema/V2/long_schema.h"
+#include "serial/schema/V2/string_dictionary.h"
+#include "serial/schema/V2/string_list_schema.h"
+#include "serial/schema/V2/string_schema.h"
+#include "serial/utils/V2/utils.h"
+#include "serial/utils/V2/varint.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+constexpr char kMagic[4] = {'D', 'S', 'R', 'C'};
+
+void PutVarint(std::string& output, uint64_t v) {
+  while (v >= 0x80) {
+    output.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  output.push_back(static_cast<char>(v));
+}
+
+void PutString(std::string& output, std::string_view s) {
+  PutVarint(output, s.size());
+  output.append(s);
+}
+
+// The encoding flags a schema of type may carry.
+uint8_t TypeFlags(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::kInteger:
+    case BaseSchema::kLong:
+      return RowCorpus::kVarint;
+    case BaseSchema::kString:
+      return RowCorpus::kEscapedKey;
+    case BaseSchema::kIntegerList:
+    case BaseSchema::kLongList:
+      return RowCorpus::kDeltaEncoded;
+    case BaseSchema::kDoubleList:
+      return RowCorpus::kXorEncoded;
+    case BaseSchema::kBoolList:
+      return RowCorpus::kPacked;
+    default:
+      return 0;
+  }
+}
+
+uint8_t FlagsOf(BaseSchema* schema) {
+  uint8_t flags = 0;
+  if (schema->IsKey()) {
+    flags |= RowCorpus::kIsKey;
+  }
+  if (schema->AllowNull()) {
+    flags |= RowCorpus::kAllowNull;
+  }
+  if (schema->IsDescending()) {
+    flags |= RowCorpus::kDescending;
+  }
+  bool set = false;
+  switch (schema->GetType()) {
+    case BaseSchema::kInteger:
+      set = static_cast<DingoSchema<int32_t>*>(schema)->IsVarint();
+      break;
+    case BaseSchema::kLong:
+      set = static_cast<DingoSchema<int64_t>*>(schema)->IsVarint();
+      break;
+    case BaseSchema::kString:
+      set = static_cast<DingoSchema<std::string>*>(schema)->IsEscapedKey();
+      break;
+    case BaseSchema::kIntegerList:
+      set = static_cast<DingoSchema<std::vector<int32_t>>*>(schema)
+                ->IsDeltaEncoded();
+      break;
+    case BaseSchema::kLongList:
+      set = static_cast<DingoSchema<std::vector<int64_t>>*>(schema)
+                ->IsDeltaEncoded();
+      break;
+    case BaseSchema::kDoubleList:
+      set = static_cast<DingoSchema<std::vector<double>>*>(schema)
+                ->IsXorEncoded();
+      break;
+    case BaseSchema::kBoolList:
+      set = static_cast<DingoSchema<std::vector<bool>>*>(schema)->IsPacked();
+      break;
+    default:
+      break;
+  }
+  return set ? flags | TypeFlags(schema->GetType()) : flags;
+}
+
+void PutSchema(std::string& output, BaseSchema* schema) {
+  output.push_back(static_cast<char>(schema->GetType()));
+  output.push_back(static_cast<char>(FlagsOf(schema)));
+  PutVarint(output, schema->GetIndex());
+  PutString(output, schema->GetName());
+  PutVarint(output, schema->GetColumnGroup());
+  PutVarint(output, ZigZagEncode32(schema->GetAccessFrequency()));
+
+  int fixed_length = 0;
+  uint8_t quantization = 0;
+  const std::vector<std::string>* dictionary = nullptr;
+  if (schema->GetType() == BaseSchema::kString) {
+    auto* string_schema = static_cast<DingoSchema<std::string>*>(schema);
+    fixed_length = string_schema->GetFixedLength();
+    if (string_schema->GetDictionary() != nullptr) {
+      dictionary = &string_schema->GetDictionary()->Values();
+    }
+  } else if (schema->GetType() == BaseSchema::kFloatList) {
+    quantization = static_cast<uint8_t>(
+        static_cast<DingoSchema<std::vector<float>>*>(schema)
+            ->GetQuantization());
+  }
+  PutVarint(output, fixed_length);
+  output.push_back(static_cast<char>(quantization));
+  PutVarint(output, dictionary == nullptr ? 0 : dictionary->size());
+  if (dictionary != nullptr) {
+    for (const auto& value : *dictionary) {
+      PutString(output, value);
+    }
+  }
+}
+
+// Reads the corpus with the bounds checked.
+struct CorpusCursor {
+  const char* data;
+  size_t size;
+  size_t pos{0};
+
+  bool Byte(uint8_t& value) {
+    if (pos >= size) {
+      return false;
+    }
+    value = static_cast<uint8_t>(data[pos++]);
+    return true;
+  }
+  bool Varint(uint64_t& value) {
+    int len = ReadVarint(data + pos, size - pos, value);
+    pos += len;
+    return len > 0;
+  }
+  // a varint of at most max.
+  template <typename T>
+  bool Varint(T& value, uint64_t max) {
+    uint64_t v;
+    if (!Varint(v) || v > max) {
+      return false;
+    }
+    value = static_cast<T>(v);
+    return true;
+  }
+  bool String(std::string_view& value) {
+    uint64_t len;
+    if (!Varint(len) || len > size - pos) {
+      return false;
+    }
+    value = std::string_view(data + pos, len);
+    pos += len;
+    return true;
+  }
+};
+
+BaseSchemaPtr NewSchema(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::kBool:
+      return std::make_shared<DingoSchema<bool>>();
+    case BaseSchema::kInteger:
+      return std::make_shared<DingoSchema<int32_t>>();
+    case BaseSchema::kFloat:
+      return std::make_shared<DingoSchema<float>>();
+    case BaseSchema::kLong:
+      return std::make_shared<DingoSchema<int64_t>>();
+    case BaseSchema::kDouble:
+      return std::make_shared<DingoSchema<double>>();
+    case BaseSchema::kString:
+      return std::make_shared<DingoSchema<std::string>>();
+    case BaseSchema::kBoolList:
+      return std::make_shared<DingoSchema<std::vector<bool>>>();
+    case BaseSchema::kIntegerList:
+      return std::make_shared<DingoSchema<std::vector<int32_t>>>();
+    case BaseSchema::kFloatList:
+      return std::make_shared<DingoSchema<std::vector<float>>>();
+    case BaseSchema::kLongList:
+      return std::make_shared<DingoSchema<std::vector<int64_t>>>();
+    case BaseSchema::kDoubleList:
+      return std::make_shared<DingoSchema<std::vector<double>>>();
+    case BaseSchema::kStringList:
+      return std::make_shared<DingoSchema<std::vector<std::string>>>();
+    default:
+      return nullptr;
+  }
+}
+
+BaseSchemaPtr ReadSchema(CorpusCursor& cursor, bool le) {
+  uint8_t type;
+  uint8_t flags;
+  if (!cursor.Byte(type) || !cursor.Byte(flags)) {
+    return nullptr;
+  }
+  if (type > BaseSchema::kStringList) {
+    return nullptr;
+  }
+  BaseSchemaPtr schema = NewSchema(static_cast<BaseSchema::Type>(type));
+  constexpr uint8_t kCommonFlags =
+      RowCorpus::kIsKey | RowCorpus::kAllowNull | RowCorpus::kDescending;
+  if (schema == nullptr ||
+      (flags & ~(kCommonFlags | TypeFlags(schema->GetType()))) != 0) {
+    return nullptr;
+  }
+
+  int index;
+  std::string_view name;
+  int column_group;
+  uint64_t frequency;
+  int fixed_length;
+  uint8_t quantization;
+  size_t dictionary_size;
+  if (!cursor.Varint(index, INT_MAX) || !cursor.String(name) ||
+      !cursor.Varint(column_group, INT_MAX) ||
+      !cursor.Varint(frequency, UINT32_MAX) ||
+      !cursor.Varint(fixed_length, INT_MAX) || !cursor.Byte(quantization) ||
+      !cursor.Varint(dictionary_size, cursor.size - cursor.pos)) {
+    return nullptr;
+  }
+  schema->SetIndex(index);
+  schema->SetName(std::string(name));
+  schema->SetIsLe(le);
+  schema->SetIsKey((flags & RowCorpus::kIsKey) != 0);
+  schema->SetAllowNull((flags & RowCorpus::kAllowNull) != 0);
+  schema->SetDescending((flags & RowCorpus::kDescending) != 0);
+  schema->SetColumnGroup(column_group);
+  schema->SetAccessFrequency(
+      ZigZagDecode32(static_cast<uint32_t>(frequency)));
+
+  if ((fixed_length != 0 || dictionary_size != 0) &&
+      schema->GetType() != BaseSchema::kString) {
+    return nullptr;
+  }
+  if (quantization != 0 &&
+      (schema->GetType() != BaseSchema::kFloatList ||
+       quantization > static_cast<uint8_t>(FloatQuantization::kInt8))) {
+    return nullptr;
+  }
+
+  bool set = (flags & TypeFlags(schema->GetType())) != 0;
+  switch (schema->GetType()) {
+    case BaseSchema::kInteger:
+      static_cast<DingoSchema<int32_t>*>(schema.get())->SetVarint(set);
+      break;
+    case BaseSchema::kLong:
+      static_cast<DingoSchema<int64_t>*>(schema.get())->SetVarint(set);
+      break;
+    case BaseSchema::kIntegerList:
+      static_cast<DingoSchema<std::vector<int32_t>>*>(schema.get())
+          ->SetDeltaEncoded(set);
+      break;
+    case BaseSchema::kLongList:
+      static_cast<DingoSchema<std::vector<int64_t>>*>(schema.get())
+          ->SetDeltaEncoded(set);
+      break;
+    case BaseSchema::kDoubleList:
+      static_cast<DingoSchema<std::vector<double>>*>(schema.get())
+          ->SetXorEncoded(set);
+      break;
+    case BaseSchema::kBoolList:
+      static_cast<DingoSchema<std::vector<bool>>*>(schema.get())
+          ->SetPacked(set);
+      break;
+    case BaseSchema::kFloatList:
+      static_cast<DingoSchema<std::vector<float>>*>(schema.get())
+          ->SetQuantization(static_cast<FloatQuantization>(quantization));
+      break;
+    case BaseSchema::kString: {
+      auto* string_schema =
+          static_cast<DingoSchema<std::string>*>(schema.get());
+      string_schema->SetEscapedKey(set);
+      string_schema->SetFixedLength(fixed_length);
+      if (dictionary_size == 0) {
+        break;
+      }
+      // StringDictionary throws on duplicates, which a corpus is not to
+      // cause.
+      std::vector<std::string> values;
+      std::unordered_set<std::string_view> seen;
+      values.reserve(dictionary_size);
+      for (size_t i = 0; i < dictionary_size; ++i) {
+        std::string_view value;
+        if (!cursor.String(value) || !seen.insert(value).second) {
+          return nullptr;
+        }
+        values.emplace_back(value);
+      }
+      string_schema->SetDictionary(
+          std::make_shared<StringDictionary>(std::move(values)));
+      break;
+    }
+    default:
+      break;
+  }
+  return schema;
+}
+
+}  // namespace
+
+RowCorpusWriter::RowCorpusWriter(int schema_version,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 long common_id)
+    : RowCorpusWriter(schema_version, schemas, common_id, IsLE()) {}
+
+RowCorpusWriter::RowCorpusWriter(int schema_version,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 long common_id, bool le)
+    : schema_version_(schema_version),
+      schemas_(schemas),
+      common_id_(common_id),
+      le_(le) {}
+
+void RowCorpusWriter::SetSampleRate(size_t one_in) {
+  sample_rate_ = one_in == 0 ? 1 : one_in;
+  offered_ = 0;
+}
+
+void RowCorpusWriter::Add(std::string_view key, std::string_view value) {
+  PutString(rows_, key);
+  PutString(rows_, value);
+  ++row_count_;
+}
+
+void RowCorpusWriter::Add(const KeyValue* rows, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    Add(rows[i].GetKey(), rows[i].GetValue());
+  }
+}
+
+bool RowCorpusWriter::Sample(std::string_view key, std::string_view value) {
+  if (++offered_ < sample_rate_) {
+    return false;
+  }
+  offered_ = 0;
+  Add(key, value);
+  return true;
+}
+
+void RowCorpusWriter::Clear() {
+  offered_ = 0;
+  row_count_ = 0;
+  rows_.clear();
+}
+
+size_t RowCorpusWriter::Write(std::string& output) const {
+  size_t start = output.size();
+  output.append(kMagic, sizeof(kMagic));
+  output.push_back(static_cast<char>(RowCorpus::kVersion));
+  output.push_back(static_cast<char>(le_ ? 1 : 0));
+  PutVarint(output, static_cast<uint32_t>(schema_version_));
+  PutVarint(output, ZigZagEncode64(common_id_));
+  size_t schema_count = 0;
+  for (const auto& schema : schemas_) {
+    schema_count += schema != nullptr ? 1 : 0;
+  }
+  PutVarint(output, schema_count);
+  for (const auto& schema : schemas_) {
+    if (schema != nullptr) {
+      PutSchema(output, schema.get());
+    }
+  }
+  PutVarint(output, row_count_);
+  output.append(rows_);
+  return output.size() - start;
+}
+
+int RowCorpus::Open(std::string_view data) {
+  schemas_.clear();
+  keys_.clear();
+  values_.clear();
+  auto fail = [this]() {
+    schemas_.clear();
+    keys_.clear();
+    values_.clear();
+    return -1;
+  };
+
+  if (data.size() < sizeof(kMagic) ||
+      memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    return -1;
+  }
+  CorpusCursor cursor{data.data(), data.size(), sizeof(kMagic)};
+  uint8_t version;
+  uint8_t le;
+  uint32_t schema_version;
+  uint64_t common_id;
+  size_t schema_count;
+  if (!cursor.Byte(version) || version != kVersion || !cursor.Byte(le) ||
+      le > 1 || !cursor.Varint(schema_version, UINT32_MAX) ||
+      !cursor.Varint(common_id) ||
+      !cursor.Varint(schema_count, cursor.size - cursor.pos)) {
+    return -1;
+  }
+  schema_version_ = static_cast<int>(schema_version);
+  common_id_ = ZigZagDecode64(common_id);
+  le_ = le == 1;
+
+  schemas_.reserve(schema_count);
+  for (size_t i = 0; i < schema_count; ++i) {
+    BaseSchemaPtr schema = ReadSchema(cursor, le_);
+    if (schema == nullptr) {
+      return fail();
+    }
+    schemas_.push_back(std::move(schema));
+  }
+
+  // a row takes two bytes at least.
+  size_t row_count;
+  if (!cursor.Varint(row_count, (cursor.size - cursor.pos) / 2)) {
+    return fail();
+  }
+  keys_.resize(row_count);
+  values_.resize(row_count);
+  for (size_t r = 0; r < row_count; ++r) {
+    if (!cursor.String(keys_[r]) || !cursor.String(values_[r])) {
+      return fail();
+    }
+  }
+  return cursor.pos == cursor.size ? 0 : fail();
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
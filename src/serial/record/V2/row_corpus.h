@@ -0,0 +1,125 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ROW_CORPUS_V2_H_
+#define DINGO_SERIAL_ROW_CORPUS_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/keyvalue.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * A captured sample of a table, its schemas and encoded rows as the store
+ * holds them, to replay the decodes and encodes of production data offline,
+ * see benchmark/bench_replay.cc.
+ *
+ *   "DSRC" | version(1) | le(1) | schema version(varint) |
+ *   common id(zigzag varint) | schemas(varint) | schema... | rows(varint) |
+ *   row...
+ *   schema: type(1) | flags(1) | index(varint) | name | column group(varint) |
+ *           access frequency(zigzag varint) | fixed length(varint) |
+ *           quantization(1) | dictionary values(varint) | value...
+ *   row:    key | value
+ *
+ * A name, value, key or row value is a varint length then its bytes, the
+ * flags those of RowCorpus::SchemaFlag. The rows are kept as they were
+ * captured, so that a replay reads the layouts, encodings and compression of
+ * the writer; le is the byte order of the schemas.
+ */
+class RowCorpusWriter {
+ public:
+  RowCorpusWriter(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                  long common_id);
+  RowCorpusWriter(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                  long common_id, bool le);
+
+  // Keep one row in every one_in offered to Sample, 1 keeps them all.
+  void SetSampleRate(size_t one_in);
+
+  void Add(std::string_view key, std::string_view value);
+  void Add(const KeyValue* rows, size_t count);
+  // Add the row when it is the one_in-th offered since the last kept, returns
+  // whether it was.
+  bool Sample(std::string_view key, std::string_view value);
+
+  size_t RowCount() const { return row_count_; }
+  void Clear();
+
+  // Append the corpus of the rows so far to output, returns its size.
+  size_t Write(std::string& output /*output*/) const;
+
+ private:
+  int schema_version_;
+  std::vector<BaseSchemaPtr> schemas_;
+  long common_id_;
+  bool le_;
+  size_t sample_rate_{1};
+  size_t offered_{0};
+  size_t row_count_{0};
+  // the rows in their corpus form.
+  std::string rows_;
+};
+
+// A corpus read in place, the keys and values are views into its bytes.
+class RowCorpus {
+ public:
+  static constexpr uint8_t kVersion = 1;
+
+  enum SchemaFlag : uint8_t {
+    kIsKey = 0x01,
+    kAllowNull = 0x02,
+    kDescending = 0x04,
+    kVarint = 0x08,        // int and long.
+    kEscapedKey = 0x10,    // string.
+    kDeltaEncoded = 0x20,  // int and long list.
+    kXorEncoded = 0x40,    // double list.
+    kPacked = 0x80,        // bool list.
+  };
+
+  // Read the corpus in data, which must outlive the corpus. Returns -1 when
+  // data is not a corpus of kVersion, is truncated, or holds a schema this
+  // build does not know.
+  int Open(std::string_view data);
+
+  int SchemaVersion() const { return schema_version_; }
+  long CommonId() const { return common_id_; }
+  bool IsLe() const { return le_; }
+  // Schemas built anew from the corpus, those the rows were written with.
+  const std::vector<BaseSchemaPtr>& Schemas() const { return schemas_; }
+
+  size_t RowCount() const { return keys_.size(); }
+  std::string_view Key(size_t row) const { return keys_[row]; }
+  std::string_view Value(size_t row) const { return values_[row]; }
+
+ private:
+  int schema_version_{0};
+  long common_id_{0};
+  bool le_{true};
+  std::vector<BaseSchemaPtr> schemas_;
+  std::vector<std::string_view> keys_;
+  std::vector<std::string_view> values_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
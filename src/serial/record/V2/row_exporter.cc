@@ -0,0 +1,385 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/row_exporter.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+constexpr size_t kNullField = std::string::npos;
+
+// Integers in decimal, floats in the shortest form that reads back the same
+// value. A NaN or infinity is null in JSON.
+template <typename T>
+void AppendNumber(std::string& out, T value, bool json) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (!std::isfinite(value)) {
+      if (json) {
+        out.append("null");
+      } else {
+        out.append(std::isnan(value) ? "nan" : value > 0 ? "inf" : "-inf");
+      }
+      return;
+    }
+  }
+  char digits[32];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  out.append(digits, result.ptr - digits);
+}
+
+// The bytes of the UTF-8 sequence value starts with, 0 when it does not
+// start with one: overlong forms, surrogates and code points past U+10FFFF
+// are not.
+size_t Utf8SequenceLength(std::string_view value) {
+  auto byte = [&](size_t i) { return static_cast<unsigned char>(value[i]); };
+  unsigned char c = byte(0);
+  // the range of the second byte.
+  unsigned char low = 0x80;
+  unsigned char high = 0xBF;
+  size_t length;
+  if (c >= 0xC2 && c <= 0xDF) {
+    length = 2;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    length = 3;
+    low = c == 0xE0 ? 0xA0 : low;
+    high = c == 0xED ? 0x9F : high;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    length = 4;
+    low = c == 0xF0 ? 0x90 : low;
+    high = c == 0xF4 ? 0x8F : high;
+  } else {
+    return 0;
+  }
+  if (value.size() < length || byte(1) < low || byte(1) > high) {
+    return 0;
+  }
+  for (size_t i = 2; i < length; ++i) {
+    if ((byte(i) & 0xC0) != 0x80) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+void AppendJsonString(std::string& out, std::string_view value) {
+  static const char kHex[] = "0123456789abcdef";
+  out.push_back('"');
+  size_t plain = 0;
+  for (size_t i = 0; i < value.size(); ++i) {
+    auto c = static_cast<unsigned char>(value[i]);
+    if (c >= 0x80) {
+      size_t length = Utf8SequenceLength(value.substr(i));
+      if (length > 0) {
+        i += length - 1;
+        continue;
+      }
+      // a byte of no character reads as the replacement character.
+      out.append(value.data() + plain, i - plain);
+      plain = i + 1;
+      out.append("\\ufffd");
+      continue;
+    }
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out.append(value.data() + plain, i - plain);
+    plain = i + 1;
+    out.push_back('\\');
+    switch (c) {
+      case '"':
+      case '\\':
+        out.push_back(c);
+        break;
+      case '\n':
+        out.push_back('n');
+        break;
+      case '\r':
+        out.push_back('r');
+        break;
+      case '\t':
+        out.push_back('t');
+        break;
+      default:
+        out.append("u00");
+        out.push_back(kHex[c >> 4]);
+        out.push_back(kHex[c & 0xF]);
+        break;
+    }
+  }
+  out.append(value.data() + plain, value.size() - plain);
+  out.push_back('"');
+}
+
+// An empty string is quoted so that it reads apart from a null.
+void AppendCsvField(std::string& out, std::string_view value) {
+  if (!value.empty() && value.find_first_of(",\"\r\n") == std::string::npos) {
+    out.append(value);
+    return;
+  }
+  out.push_back('"');
+  size_t plain = 0;
+  for (size_t quote = value.find('"'); quote != std::string::npos;
+       quote = value.find('"', quote + 1)) {
+    out.append(value.data() + plain, quote + 1 - plain);
+    out.push_back('"');
+    plain = quote + 1;
+  }
+  out.append(value.data() + plain, value.size() - plain);
+  out.push_back('"');
+}
+
+}  // namespace
+
+RowExporter::RowExporter(
+    RecordDecoderPtr decoder,
+    const std::unordered_map<int, int>& column_indexes_serial,
+    std::vector<std::string> names, ExportFormat format)
+    : decoder_(std::move(decoder)),
+      plan_(decoder_->NewDecodePlan(column_indexes_serial)),
+      format_(format),
+      fields_(plan_.OutputSize()) {
+  if (names.size() != plan_.OutputSize()) {
+    throw std::runtime_error("Export column names mismatch.");
+  }
+  // kept escaped for the format, a CSV field or a JSON key.
+  for (const auto& name : names) {
+    std::string escaped;
+    if (Csv()) {
+      AppendCsvField(escaped, name);
+    } else {
+      AppendJsonString(escaped, name);
+      escaped.push_back(':');
+    }
+    names_.push_back(std::move(escaped));
+  }
+}
+
+void RowExporter::Header(std::string& out) const {
+  if (!Csv()) {
+    return;
+  }
+  for (size_t i = 0; i < names_.size(); ++i) {
+    if (i > 0) {
+      out.push_back(',');
+    }
+    out.append(names_[i]);
+  }
+  out.push_back('\n');
+}
+
+int RowExporter::Export(std::string_view key, std::string_view value,
+                        std::string& out) {
+  text_.clear();
+  fields_.assign(fields_.size(), {kNullField, kNullField});
+  if (decoder_->Decode(key, value, plan_, sink_) != 0) {
+    return -1;
+  }
+
+  if (!Csv()) {
+    out.push_back('{');
+  }
+  for (size_t i = 0; i < fields_.size(); ++i) {
+    if (i > 0) {
+      out.push_back(',');
+    }
+    if (!Csv()) {
+      out.append(names_[i]);
+    }
+    const auto& field = fields_[i];
+    if (field.first != kNullField) {
+      out.append(text_, field.first, field.second - field.first);
+    } else if (!Csv()) {
+      out.append("null");
+    }
+  }
+  if (!Csv()) {
+    out.push_back('}');
+  }
+  out.push_back('\n');
+  return 0;
+}
+
+long RowExporter::Export(const KeyValue* key_values, size_t count,
+                         std::string& out) {
+  for (size_t i = 0; i < count; ++i) {
+    if (Export(key_values[i].GetKey(), key_values[i].GetValue(), out) != 0) {
+      return -1;
+    }
+  }
+  return count;
+}
+
+bool RowExporter::TextSink::Begin(int col) {
+  if (col < 0 || col >= static_cast<int>(exporter_->fields_.size())) {
+    return false;
+  }
+  exporter_->fields_[col].first = exporter_->text_.size();
+  return true;
+}
+
+void RowExporter::TextSink::End(int col) {
+  exporter_->fields_[col].second = exporter_->text_.size();
+}
+
+void RowExporter::TextSink::OnNull(int col) {
+  if (col >= 0 && col < static_cast<int>(exporter_->fields_.size())) {
+    exporter_->fields_[col] = {kNullField, kNullField};
+  }
+}
+
+void RowExporter::TextSink::OnBool(int col, bool value) {
+  if (Begin(col)) {
+    exporter_->text_.append(value ? "true" : "false");
+    End(col);
+  }
+}
+
+template <typename T>
+void RowExporter::TextSink::OnNumber(int col, T value) {
+  if (Begin(col)) {
+    AppendNumber(exporter_->text_, value, !exporter_->Csv());
+    End(col);
+  }
+}
+
+void RowExporter::TextSink::OnInt32(int col, int32_t value) {
+  OnNumber(col, value);
+}
+
+void RowExporter::TextSink::OnInt64(int col, int64_t value) {
+  OnNumber(col, value);
+}
+
+void RowExporter::TextSink::OnFloat(int col, float value) {
+  OnNumber(col, value);
+}
+
+void RowExporter::TextSink::OnDouble(int col, double value) {
+  OnNumber(col, value);
+}
+
+void RowExporter::TextSink::OnString(int col, std::string_view value) {
+  if (Begin(col)) {
+    if (exporter_->Csv()) {
+      AppendCsvField(exporter_->text_, value);
+    } else {
+      AppendJsonString(exporter_->text_, value);
+    }
+    End(col);
+  }
+}
+
+// The JSON array text of the list, quoted as one field in CSV.
+template <typename T>
+void RowExporter::TextSink::OnList(int col, const std::vector<T>& value) {
+  if (!Begin(col)) {
+    return;
+  }
+  std::string& out = exporter_->Csv() ? exporter_->list_text_ : exporter_->text_;
+  if (exporter_->Csv()) {
+    out.clear();
+  }
+  out.push_back('[');
+  bool first = true;
+  for (const auto& element : value) {
+    if (!first) {
+      out.push_back(',');
+    }
+    first = false;
+    if constexpr (std::is_same_v<T, bool>) {
+      out.append(element ? "true" : "false");
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      AppendJsonString(out, element);
+    } else {
+      AppendNumber(out, element, true);
+    }
+  }
+  out.push_back(']');
+  if (exporter_->Csv()) {
+    AppendCsvField(exporter_->text_, out);
+  }
+  End(col);
+}
+
+template <typename T>
+void RowExporter::TextSink::KeepList(std::vector<T>& kept,
+                                     std::vector<T>&& value) {
+  kept.swap(value);
+}
+
+void RowExporter::TextSink::OnBoolList(int col, std::vector<bool>&& value) {
+  OnList(col, value);
+  KeepList(exporter_->bools_, std::move(value));
+}
+
+void RowExporter::TextSink::OnInt32List(int col, std::vector<int32_t>&& value) {
+  OnList(col, value);
+  KeepList(exporter_->ints_, std::move(value));
+}
+
+void RowExporter::TextSink::OnInt64List(int col, std::vector<int64_t>&& value) {
+  OnList(col, value);
+  KeepList(exporter_->longs_, std::move(value));
+}
+
+void RowExporter::TextSink::OnFloatList(int col, std::vector<float>&& value) {
+  OnList(col, value);
+  KeepList(exporter_->floats_, std::move(value));
+}
+
+void RowExporter::TextSink::OnDoubleList(int col, std::vector<double>&& value) {
+  OnList(col, value);
+  KeepList(exporter_->doubles_, std::move(value));
+}
+
+void RowExporter::TextSink::OnStringList(int col,
+                                         std::vector<std::string>&& value) {
+  OnList(col, value);
+  KeepList(exporter_->strings_, std::move(value));
+}
+
+void RowExporter::TextSink::ReuseList(int, std::vector<bool>& list) {
+  list.swap(exporter_->bools_);
+}
+
+void RowExporter::TextSink::ReuseList(int, std::vector<int32_t>& list) {
+  list.swap(exporter_->ints_);
+}
+
+void RowExporter::TextSink::ReuseList(int, std::vector<int64_t>& list) {
+  list.swap(exporter_->longs_);
+}
+
+void RowExporter::TextSink::ReuseList(int, std::vector<float>& list) {
+  list.swap(exporter_->floats_);
+}
+
+void RowExporter::TextSink::ReuseList(int, std::vector<double>& list) {
+  list.swap(exporter_->doubles_);
+}
+
+void RowExporter::TextSink::ReuseList(int, std::vector<std::string>& list) {
+  list.swap(exporter_->strings_);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,149 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ROW_EXPORTER_V2_H_
+#define DINGO_SERIAL_ROW_EXPORTER_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "serial/record/V2/decode_plan.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/schema/V2/row_sink.h"
+#include "serial/utils/V2/keyvalue.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+enum class ExportFormat {
+  // RFC 4180: fields quoted when they hold a comma, quote or line break, null
+  // as an empty field, lists as their JSON array text.
+  kCsv,
+  // one JSON object per row keyed by the column names, NaN and infinities as
+  // null, the bytes of strings that are not UTF-8 as U+FFFD.
+  kJsonLines,
+};
+
+/*
+ * Writer of encoded rows as text for export jobs.
+ *
+ * The projection is resolved once at construction, column_indexes_serial as
+ * in the projected RecordDecoderV2::Decode, names[slot] naming the column of
+ * each output slot. A row is decoded through a RowSink straight into text,
+ * numbers formatted with std::to_chars and strings copied from the row bytes,
+ * no std::any or temporary string is made per value. Every row ends with a
+ * '\n'.
+ *
+ * An exporter belongs to one export, it is not thread safe; the decoder it
+ * reads with must outlive it.
+ */
+class RowExporter {
+ public:
+  // Throws runtime_error when names holds no name per output slot.
+  RowExporter(RecordDecoderPtr decoder,
+              const std::unordered_map<int, int>& column_indexes_serial,
+              std::vector<std::string> names, ExportFormat format);
+
+  // the sink points back at the exporter.
+  RowExporter(const RowExporter&) = delete;
+  RowExporter& operator=(const RowExporter&) = delete;
+
+  // Append the CSV header line to out, nothing for JSON lines.
+  void Header(std::string& out /*output*/) const;
+
+  // Append the row to out. Returns -1 when the row fails the checks, out is
+  // then left as it was.
+  int Export(std::string_view key, std::string_view value,
+             std::string& out /*output*/);
+  // Append count rows to out. Returns the rows appended, or -1 when a row
+  // fails the checks, out then ends with the row before it.
+  long Export(const KeyValue* key_values, size_t count,
+              std::string& out /*output*/);
+
+  const DecodePlan& Plan() const { return plan_; }
+
+ private:
+  // Formats every column of a row into the field text of its slot.
+  class TextSink : public RowSink {
+   public:
+    explicit TextSink(RowExporter* exporter) : exporter_(exporter) {}
+
+    void OnNull(int col) override;
+
+    void OnBool(int col, bool value) override;
+    void OnInt32(int col, int32_t value) override;
+    void OnInt64(int col, int64_t value) override;
+    void OnFloat(int col, float value) override;
+    void OnDouble(int col, double value) override;
+    void OnString(int col, std::string_view value) override;
+
+    void OnBoolList(int col, std::vector<bool>&& value) override;
+    void OnInt32List(int col, std::vector<int32_t>&& value) override;
+    void OnInt64List(int col, std::vector<int64_t>&& value) override;
+    void OnFloatList(int col, std::vector<float>&& value) override;
+    void OnDoubleList(int col, std::vector<double>&& value) override;
+    void OnStringList(int col, std::vector<std::string>&& value) override;
+
+    void ReuseList(int col, std::vector<bool>& list) override;
+    void ReuseList(int col, std::vector<int32_t>& list) override;
+    void ReuseList(int col, std::vector<int64_t>& list) override;
+    void ReuseList(int col, std::vector<float>& list) override;
+    void ReuseList(int col, std::vector<double>& list) override;
+    void ReuseList(int col, std::vector<std::string>& list) override;
+
+   private:
+    bool Begin(int col);
+    void End(int col);
+    template <typename T>
+    void OnNumber(int col, T value);
+    template <typename T>
+    void OnList(int col, const std::vector<T>& value);
+    template <typename T>
+    void KeepList(std::vector<T>& kept, std::vector<T>&& value);
+
+    RowExporter* exporter_;
+  };
+
+  bool Csv() const { return format_ == ExportFormat::kCsv; }
+
+  RecordDecoderPtr decoder_;
+  DecodePlan plan_;
+  std::vector<std::string> names_;
+  ExportFormat format_;
+
+  // the field text of slot i spans [fields_[i].first, fields_[i].second) of
+  // text_, an empty span before any column of the row is a null.
+  std::string text_;
+  std::vector<std::pair<size_t, size_t>> fields_;
+  // a CSV list is written as JSON here first, then quoted into text_.
+  std::string list_text_;
+  // the last list of each element type, its capacity given back to the next.
+  std::vector<bool> bools_;
+  std::vector<int32_t> ints_;
+  std::vector<int64_t> longs_;
+  std::vector<float> floats_;
+  std::vector<double> doubles_;
+  std::vector<std::string> strings_;
+  TextSink sink_{this};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,402 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/row_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "serial/utils/V2/crc32c.h"
+#include "serial/utils/V2/utils.h"
+#include "serial/utils/V2/varint.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+constexpr char kMagic[4] = {'D', 'S', 'R', 'F'};
+// magic and version.
+constexpr size_t kHeaderSize = sizeof(kMagic) + 1;
+// footer offset and magic.
+constexpr size_t kTrailerSize = 8 + sizeof(kMagic);
+constexpr size_t kCrcSize = 4;
+
+void PutVarint(std::string& output, uint64_t v) {
+  while (v >= 0x80) {
+    output.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  output.push_back(static_cast<char>(v));
+}
+
+void PutString(std::string& output, std::string_view s) {
+  PutVarint(output, s.size());
+  output.append(s);
+}
+
+void PutFixed(std::string& output, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; ++i) {
+    output.push_back(static_cast<char>(v >> (8 * i)));
+  }
+}
+
+uint64_t GetFixed(const char* data, int bytes) {
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i) {
+    v |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+  }
+  return v;
+}
+
+struct FileCursor {
+  const char* data;
+  size_t size;
+  size_t pos{0};
+
+  bool Varint(uint64_t& value) {
+    int len = ReadVarint(data + pos, size - pos, value);
+    pos += len;
+    return len > 0;
+  }
+  // a varint of at most max.
+  template <typename T>
+  bool Varint(T& value, uint64_t max) {
+    uint64_t v;
+    if (!Varint(v) || v > max) {
+      return false;
+    }
+    value = static_cast<T>(v);
+    return true;
+  }
+  bool String(std::string_view& value) {
+    uint64_t len;
+    if (!Varint(len) || len > size - pos) {
+      return false;
+    }
+    value = std::string_view(data + pos, len);
+    pos += len;
+    return true;
+  }
+};
+
+}  // namespace
+
+RowFileWriter::RowFileWriter(int schema_version,
+                             const std::vector<BaseSchemaPtr>& schemas,
+                             long common_id)
+    : RowFileWriter(schema_version, schemas, common_id, IsLE()) {}
+
+RowFileWriter::RowFileWriter(int schema_version,
+                             const std::vector<BaseSchemaPtr>& schemas,
+                             long common_id, bool le)
+    : schema_version_(schema_version),
+      schemas_(schemas),
+      common_id_(common_id),
+      le_(le) {
+  Reset();
+}
+
+void RowFileWriter::SetBlockSize(size_t bytes) {
+  block_size_ = std::max<size_t>(bytes, 1);
+}
+
+int RowFileWriter::Add(std::string_view key, std::string_view value) {
+  if (row_count_ > 0 && key <= last_key_) {
+    return -1;
+  }
+  if (block_rows_ == 0) {
+    block_first_key_.assign(key.data(), key.size());
+  }
+  PutString(block_, key);
+  PutString(block_, value);
+  last_key_.assign(key.data(), key.size());
+  ++block_rows_;
+  ++row_count_;
+  key_bytes_ += key.size();
+  value_bytes_ += value.size();
+  if (block_.size() >= block_size_) {
+    CloseBlock();
+  }
+  return 0;
+}
+
+long RowFileWriter::Add(const KeyValue* rows, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (Add(rows[i].GetKey(), rows[i].GetValue()) != 0) {
+      return -1;
+    }
+  }
+  return count;
+}
+
+void RowFileWriter::CloseBlock() {
+  if (block_rows_ == 0) {
+    return;
+  }
+  uint64_t offset = flushed_ + pending_.size();
+  pending_.append(block_);
+  PutFixed(pending_, Crc32c(block_.data(), block_.size()), kCrcSize);
+  blocks_.push_back(
+      {offset, block_.size(), block_rows_, block_first_key_, last_key_});
+  block_.clear();
+  block_rows_ = 0;
+}
+
+size_t RowFileWriter::Flush(std::string& output) {
+  size_t size = pending_.size();
+  output.append(pending_);
+  flushed_ += size;
+  pending_.clear();
+  return size;
+}
+
+size_t RowFileWriter::Finish(std::string& output) {
+  CloseBlock();
+  uint64_t footer_offset = flushed_ + pending_.size();
+  PutVarint(pending_, blocks_.size());
+  for (const auto& block : blocks_) {
+    PutVarint(pending_, block.offset);
+    PutVarint(pending_, block.size);
+    PutVarint(pending_, block.rows);
+    PutString(pending_, block.first_key);
+    PutString(pending_, block.last_key);
+  }
+  PutVarint(pending_, row_count_);
+  PutVarint(pending_, key_bytes_);
+  PutVarint(pending_, value_bytes_);
+  std::string schemas;
+  RowCorpusWriter(schema_version_, schemas_, common_id_, le_).Write(schemas);
+  PutString(pending_, schemas);
+  PutFixed(pending_, footer_offset, 8);
+  pending_.append(kMagic, sizeof(kMagic));
+
+  size_t size = Flush(output);
+  Reset();
+  return size;
+}
+
+void RowFileWriter::Reset() {
+  flushed_ = 0;
+  pending_.assign(kMagic, sizeof(kMagic));
+  pending_.push_back(static_cast<char>(kVersion));
+  block_.clear();
+  block_rows_ = 0;
+  last_key_.clear();
+  blocks_.clear();
+  row_count_ = 0;
+  key_bytes_ = 0;
+  value_bytes_ = 0;
+}
+
+int RowFileReader::Open(std::string_view data) {
+  file_.reset();
+  data_ = std::string_view();
+  blocks_.clear();
+  row_count_ = 0;
+  key_bytes_ = 0;
+  value_bytes_ = 0;
+  auto fail = [this]() {
+    data_ = std::string_view();
+    blocks_.clear();
+    return -1;
+  };
+
+  if (data.size() < kHeaderSize + kTrailerSize ||
+      memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+      static_cast<uint8_t>(data[sizeof(kMagic)]) != RowFileWriter::kVersion ||
+      memcmp(data.data() + data.size() - sizeof(kMagic), kMagic,
+             sizeof(kMagic)) != 0) {
+    return -1;
+  }
+  uint64_t footer_offset =
+      GetFixed(data.data() + data.size() - kTrailerSize, 8);
+  if (footer_offset < kHeaderSize ||
+      footer_offset > data.size() - kTrailerSize) {
+    return -1;
+  }
+
+  FileCursor cursor{data.data(), data.size() - kTrailerSize, footer_offset};
+  size_t block_count;
+  // an index entry takes five bytes at least.
+  if (!cursor.Varint(block_count, (cursor.size - cursor.pos) / 5)) {
+    return fail();
+  }
+  blocks_.resize(block_count);
+  uint64_t block_end = kHeaderSize;
+  for (auto& block : blocks_) {
+    if (!cursor.Varint(block.offset, footer_offset) ||
+        !cursor.Varint(block.size, footer_offset) ||
+        !cursor.Varint(block.rows, block.size) ||
+        !cursor.String(block.first_key) || !cursor.String(block.last_key)) {
+      return fail();
+    }
+    // the blocks in order, apart and before the footer.
+    if (block.offset < block_end || block.rows == 0 ||
+        block.offset + block.size + kCrcSize > footer_offset ||
+        block.last_key < block.first_key ||
+        (&block != &blocks_[0] && block.first_key <= (&block - 1)->last_key)) {
+      return fail();
+    }
+    block_end = block.offset + block.size + kCrcSize;
+  }
+
+  std::string_view schemas;
+  if (!cursor.Varint(row_count_) || !cursor.Varint(key_bytes_) ||
+      !cursor.Varint(value_bytes_) || !cursor.String(schemas) ||
+      cursor.pos != cursor.size || schemas_.Open(schemas) < 0) {
+    return fail();
+  }
+  data_ = data;
+  return 0;
+}
+
+int RowFileReader::OpenFile(const char* path) {
+  auto file = std::make_unique<MappedFile>(path);
+  if (!file->IsOpen() || Open(file->Data()) < 0) {
+    return -1;
+  }
+  file_ = std::move(file);
+  return 0;
+}
+
+size_t RowFileReader::SeekBlock(std::string_view key) const {
+  auto it = std::lower_bound(blocks_.begin(), blocks_.end(), key,
+                             [](const RowFileBlock& block,
+                                std::string_view key) {
+                               return block.last_key < key;
+                             });
+  return it - blocks_.begin();
+}
+
+int RowFileReader::ReadBlock(size_t block, std::vector<std::string_view>& keys,
+                             std::vector<std::string_view>& values) const {
+  keys.clear();
+  values.clear();
+  const RowFileBlock& entry = blocks_.at(block);
+  const char* data = data_.data() + entry.offset;
+  if (verify_checksums_ &&
+      Crc32c(data, entry.size) != GetFixed(data + entry.size, kCrcSize)) {
+    return -1;
+  }
+
+  FileCursor cursor{data, entry.size};
+  keys.reserve(entry.rows);
+  values.reserve(entry.rows);
+  for (size_t r = 0; r < entry.rows; ++r) {
+    std::string_view key;
+    std::string_view value;
+    if (!cursor.String(key) || !cursor.String(value)) {
+      keys.clear();
+      values.clear();
+      return -1;
+    }
+    keys.push_back(key);
+    values.push_back(value);
+  }
+  if (cursor.pos != cursor.size) {
+    keys.clear();
+    values.clear();
+    return -1;
+  }
+  return 0;
+}
+
+void RowFileReader::Iterator::SeekToFirst() { Load(0, 0); }
+
+void RowFileReader::Iterator::Seek(std::string_view key) {
+  Load(reader_.SeekBlock(key), 0);
+  if (Valid()) {
+    row_ = std::lower_bound(keys_.begin(), keys_.end(), key) - keys_.begin();
+    if (!Valid()) {
+      Load(block_ + 1, 0);
+    }
+  }
+}
+
+void RowFileReader::Iterator::Next() {
+  if (++row_ >= keys_.size()) {
+    Load(block_ + 1, 0);
+  }
+}
+
+void RowFileReader::Iterator::Load(size_t block, size_t row) {
+  for (;; ++block, row = 0) {
+    block_ = block;
+    row_ = 0;
+    if (block >= reader_.BlockCount()) {
+      keys_.clear();
+      values_.clear();
+      return;
+    }
+    if (reader_.ReadBlock(block, keys_, values_) < 0) {
+      status_ = -1;
+      return;
+    }
+    if (row < keys_.size()) {
+      row_ = row;
+      return;
+    }
+  }
+}
+
+long RowFileReader::Scan(
+    std::string_view begin, std::string_view end,
+    const std::function<bool(std::string_view key, std::string_view value)>&
+        visit) const {
+  Iterator it(*this);
+  it.Seek(begin);
+  long rows = 0;
+  for (; it.Valid(); it.Next()) {
+    if (!end.empty() && it.Key() >= end) {
+      break;
+    }
+    ++rows;
+    if (!visit(it.Key(), it.Value())) {
+      break;
+    }
+  }
+  return it.Status() < 0 ? -1 : rows;
+}
+
+long RowFileReader::ParallelScan(
+    const ParallelOptions& options,
+    const std::function<void(size_t block, std::string_view key,
+                             std::string_view value)>& visit) const {
+  // a worker takes a block at a time.
+  ParallelOptions block_options = options;
+  block_options.chunk_size = 1;
+  std::atomic<long> rows{0};
+  std::atomic<bool> failed{false};
+  ParallelFor(BlockCount(), block_options, [&](size_t begin, size_t end) {
+    std::vector<std::string_view> keys;
+    std::vector<std::string_view> values;
+    for (size_t block = begin; block < end; ++block) {
+      if (ReadBlock(block, keys, values) < 0) {
+        failed = true;
+        continue;
+      }
+      for (size_t r = 0; r < keys.size(); ++r) {
+        visit(block, keys[r], values[r]);
+      }
+      rows += keys.size();
+    }
+  });
+  return failed ? -1 : rows.load();
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
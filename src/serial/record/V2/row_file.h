@@ -0,0 +1,218 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ROW_FILE_V2_H_
+#define DINGO_SERIAL_ROW_FILE_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/row_corpus.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/keyvalue.h"
+#include "serial/utils/V2/mapped_file.h"
+#include "serial/utils/V2/parallel.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Encoded rows spilled to a file in key order, to be read back in place:
+ *
+ *   "DSRF" | version(1) | block... | footer | footer offset(8) | "DSRF"
+ *   block:  {key | value} * rows | crc(4)
+ *   footer: blocks(varint) | {offset(varint) | size(varint) | rows(varint) |
+ *           first key | last key} * blocks | rows(varint) | key bytes(varint) |
+ *           value bytes(varint) | schemas
+ *
+ * A key or value is a varint length then its bytes, the rows as the codecs
+ * wrote them, so that a reader decodes them with RecordDecoderV2 without
+ * transcoding; rows of any value layout and compression mix. crc is the
+ * CRC-32C of the block rows, schemas a RowCorpus without rows of the schemas,
+ * schema version and common id of the table. The fixed width words are little
+ * endian.
+ *
+ * The footer indexes the blocks by their first and last keys, a reader seeks
+ * to a key by a binary search of the blocks then of the rows of one, and
+ * scans blocks independently of each other.
+ */
+class RowFileWriter {
+ public:
+  static constexpr uint8_t kVersion = 1;
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+  RowFileWriter(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                long common_id);
+  RowFileWriter(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                long common_id, bool le);
+
+  // Bytes of rows a block is closed at, the last row may cross it.
+  void SetBlockSize(size_t bytes);
+
+  // Append a row. Keys must be added in increasing order, returns -1 for a
+  // key not above the previous one.
+  int Add(std::string_view key, std::string_view value);
+  // Returns the rows added, or -1 at the first row out of order.
+  long Add(const KeyValue* rows, size_t count);
+
+  size_t RowCount() const { return row_count_; }
+
+  // Move the bytes of the file written so far to the end of output, to
+  // write a large file out as it grows. Returns their size.
+  size_t Flush(std::string& output /*output*/);
+  // Close the last block, write the footer and flush, the writer then starts
+  // a new file. Returns the bytes appended.
+  size_t Finish(std::string& output /*output*/);
+
+ private:
+  struct BlockEntry {
+    uint64_t offset;
+    size_t size;
+    size_t rows;
+    std::string first_key;
+    std::string last_key;
+  };
+
+  void CloseBlock();
+  void Reset();
+
+  int schema_version_;
+  std::vector<BaseSchemaPtr> schemas_;
+  long common_id_;
+  bool le_;
+  size_t block_size_{kDefaultBlockSize};
+
+  // bytes flushed, the file offset of pending_.
+  uint64_t flushed_{0};
+  std::string pending_;
+  std::string block_;
+  size_t block_rows_{0};
+  std::string block_first_key_;
+  std::string last_key_;
+  std::vector<BlockEntry> blocks_;
+  size_t row_count_{0};
+  size_t key_bytes_{0};
+  size_t value_bytes_{0};
+};
+
+// A block of a row file as the footer indexes it, the keys are views into
+// the file.
+struct RowFileBlock {
+  uint64_t offset;
+  size_t size;
+  size_t rows;
+  std::string_view first_key;
+  std::string_view last_key;
+};
+
+// A row file read in place, from bytes or a file it maps.
+class RowFileReader {
+ public:
+  // Read the file in data, which must outlive the reader. Returns -1 when
+  // data is not a row file of kVersion or its footer is malformed, the
+  // blocks are checked as they are read.
+  int Open(std::string_view data);
+  // Map the file at path and open it. Returns -1 when it does not map or
+  // open.
+  int OpenFile(const char* path);
+
+  // Check the CRC of every block read, off by default.
+  void SetVerifyChecksums(bool verify) { verify_checksums_ = verify; }
+
+  int SchemaVersion() const { return schemas_.SchemaVersion(); }
+  long CommonId() const { return schemas_.CommonId(); }
+  bool IsLe() const { return schemas_.IsLe(); }
+  const std::vector<BaseSchemaPtr>& Schemas() const {
+    return schemas_.Schemas();
+  }
+
+  size_t RowCount() const { return row_count_; }
+  size_t KeyBytes() const { return key_bytes_; }
+  size_t ValueBytes() const { return value_bytes_; }
+  size_t BlockCount() const { return blocks_.size(); }
+  const RowFileBlock& Block(size_t block) const { return blocks_[block]; }
+
+  // The first block whose last key is not below key, BlockCount() when every
+  // key is below it.
+  size_t SeekBlock(std::string_view key) const;
+
+  // The rows of block, views into the file. Returns -1 when the block is
+  // malformed or fails its CRC.
+  int ReadBlock(size_t block, std::vector<std::string_view>& keys /*output*/,
+                std::vector<std::string_view>& values /*output*/) const;
+
+  // Rows in key order from a position, reading a block at a time.
+  class Iterator {
+   public:
+    explicit Iterator(const RowFileReader& reader) : reader_(reader) {}
+
+    void SeekToFirst();
+    // Move to the first row whose key is not below key.
+    void Seek(std::string_view key);
+    bool Valid() const { return row_ < keys_.size(); }
+    void Next();
+    // -1 once a block failed to read, the iterator is then not valid.
+    int Status() const { return status_; }
+
+    std::string_view Key() const { return keys_[row_]; }
+    std::string_view Value() const { return values_[row_]; }
+
+   private:
+    // Read block and stand at its row, the next blocks while past the end.
+    void Load(size_t block, size_t row);
+
+    const RowFileReader& reader_;
+    size_t block_{0};
+    size_t row_{0};
+    std::vector<std::string_view> keys_;
+    std::vector<std::string_view> values_;
+    int status_{0};
+  };
+
+  // Call visit(key, value) over the rows of [begin, end) in key order, an
+  // empty end goes to the last row. visit returns false to stop. Returns the
+  // rows visited, -1 when a block fails to read.
+  long Scan(std::string_view begin, std::string_view end,
+            const std::function<bool(std::string_view key,
+                                     std::string_view value)>& visit) const;
+
+  // Call visit(block, key, value) over every row, the blocks spread over
+  // the workers of options, options.chunk_size counting blocks; the rows of
+  // a block are visited in order by one worker. Returns the rows visited, -1
+  // when a block fails to read.
+  long ParallelScan(
+      const ParallelOptions& options,
+      const std::function<void(size_t block, std::string_view key,
+                               std::string_view value)>& visit) const;
+
+ private:
+  std::unique_ptr<MappedFile> file_;
+  std::string_view data_;
+  bool verify_checksums_{false};
+  RowCorpus schemas_;
+  std::vector<RowFileBlock> blocks_;
+  size_t row_count_{0};
+  size_t key_bytes_{0};
+  size_t value_bytes_{0};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
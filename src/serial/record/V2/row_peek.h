@@ -0,0 +1,153 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ROW_PEEK_V2_H_
+#define DINGO_SERIAL_ROW_PEEK_V2_H_
+
+#include <cstdint>
+#include <string_view>
+
+#include "serial/record/V2/common.h"
+#include "serial/record/V2/value_header.h"
+#include "serial/utils/V2/buf_view.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Peeks at the header of an encoded row without a decoder, for routing rows
+ * or telling whether a projection needs a decode at all. The bytes are read
+ * in place in the byte order le of the encoder, nothing is copied nor
+ * checked beyond what is read: a row may still fail a decode its peeks
+ * passed.
+ *
+ * The peeks return -1 for bytes too short for what they read. The column
+ * peeks also do for compressed values, whose tables are compressed with the
+ * data, and for values with layout flags unknown to this build.
+ */
+
+// The codec version at the end of key.
+inline int PeekCodecVersion(std::string_view key, bool le) {
+  if (key.size() < 4) {
+    return -1;
+  }
+  return BufView(key, le).ReadInt(key.size() - 4);
+}
+
+// The schema version of value, without its layout flags, and the flags, see
+// GetValueFormat.
+inline int PeekSchemaVersion(std::string_view value, bool le) {
+  if (value.size() < 4) {
+    return -1;
+  }
+  return BufView(value, le).ReadInt(0) & kSchemaVersionMask;
+}
+inline int PeekValueFormat(std::string_view value, bool le) {
+  if (value.size() < 4) {
+    return -1;
+  }
+  return GetValueFormat(BufView(value, le).ReadInt(0));
+}
+
+// The not null and null value columns the writer of value had.
+inline int PeekColumnCounts(std::string_view value, bool le,
+                            int& cnt_not_null_col /*output*/,
+                            int& cnt_null_col /*output*/) {
+  int format = PeekValueFormat(value, le);
+  if (format < 0 || (format & ~kValueFormatKnownFlags) != 0 ||
+      (format & VALUE_FORMAT_COMPRESSED) || value.size() < 8) {
+    return -1;
+  }
+  BufView value_buf(value, le);
+  cnt_not_null_col = value_buf.ReadShort(4);
+  cnt_null_col = value_buf.ReadShort(6);
+  return 0;
+}
+
+// Whether value column (the column id, the schema index) is null in value,
+// read from its id, offset and null tables. A column the writer did not have
+// is null, as the decoders read it.
+inline int PeekIsNull(std::string_view value, bool le, int column,
+                      bool& is_null /*output*/) {
+  int format = PeekValueFormat(value, le);
+  if (format < 0 || (format & ~kValueFormatKnownFlags) != 0 ||
+      (format & VALUE_FORMAT_COMPRESSED) || value.size() < 8) {
+    return -1;
+  }
+  // the trailer is not verified, see VerifyValueChecksum.
+  if (format & VALUE_FORMAT_CHECKSUM) {
+    if (value.size() < 8 + kValueChecksumSize) {
+      return -1;
+    }
+    value.remove_suffix(kValueChecksumSize);
+  }
+  if ((format & (VALUE_FORMAT_STATIC_OFFSETS | VALUE_FORMAT_BOOL_BITS)) &&
+      value.size() < 10) {
+    return -1;
+  }
+
+  BufView value_buf(value, le);
+  value_buf.Skip(4);
+  ValueHeader header(value_buf, format);
+  if (value.size() < static_cast<size_t>(header.data_pos)) {
+    return -1;
+  }
+
+  if (header.HasStaticOffsets()) {
+    // fixed width columns first, unsorted, the bitmap covers them.
+    if (header.fixed_cnt > header.entry_cnt) {
+      return -1;
+    }
+    for (int i = 0; i < header.entry_cnt; ++i) {
+      if (header.ReadId(value_buf, i) != column) {
+        continue;
+      }
+      is_null = i < header.fixed_cnt
+                    ? header.IsNullColumn(value_buf, i)
+                    : header.ReadOffset(value_buf, i - header.fixed_cnt) == -1;
+      return 0;
+    }
+    is_null = true;
+    return 0;
+  }
+
+  if (header.HasBoolBits() && header.ReadBoolOffset(value_buf, column) != -1) {
+    is_null = false;
+    return 0;
+  }
+
+  // sorted ids, only the not null columns with a null bitmap or bool bits.
+  int start = 0;
+  int end = header.entry_cnt - 1;
+  while (start <= end) {
+    int mid = start + (end - start) / 2;
+    int id = header.ReadId(value_buf, mid);
+    if (id == column) {
+      is_null = header.ReadOffset(value_buf, mid) == -1;
+      return 0;
+    }
+    if (id < column) {
+      start = mid + 1;
+    } else {
+      end = mid - 1;
+    }
+  }
+  is_null = true;
+  return 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,71 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/scan_decoder.h"
+
+#include <utility>
+
+namespace dingodb {
+namespace serialV2 {
+
+ScanDecoder::ScanDecoder(
+    RecordDecoderPtr decoder,
+    const std::unordered_map<int, int>& column_indexes_serial)
+    : decoder_(std::move(decoder)),
+      plan_(decoder_->NewDecodePlan(column_indexes_serial)),
+      record_(plan_.OutputSize()),
+      spares_(plan_.OutputSize()) {}
+
+int ScanDecoder::Decode(std::string_view key, std::string_view value) {
+  return decoder_->Decode(key, value, plan_, sink_);
+}
+
+std::any* ScanDecoder::ReuseSink::Slot(int col) {
+  if (col < 0 || col >= static_cast<int>(scan_->record_.size())) {
+    return nullptr;
+  }
+
+  std::any& slot = scan_->record_[col];
+  if (!slot.has_value() && scan_->spares_[col].has_value()) {
+    slot.swap(scan_->spares_[col]);
+  }
+  return &slot;
+}
+
+void ScanDecoder::ReuseSink::OnNull(int col) {
+  if (col < 0 || col >= static_cast<int>(scan_->record_.size())) {
+    return;
+  }
+
+  std::any& slot = scan_->record_[col];
+  if (slot.has_value()) {
+    slot.swap(scan_->spares_[col]);
+    slot.reset();
+  }
+}
+
+void ScanDecoder::ReuseSink::OnString(int col, std::string_view value) {
+  std::any* slot = Slot(col);
+  if (slot == nullptr) {
+    return;
+  }
+  if (auto* held = std::any_cast<std::string>(slot)) {
+    held->assign(value.data(), value.size());
+  } else {
+    *slot = std::string(value);
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
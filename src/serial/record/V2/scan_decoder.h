@@ -0,0 +1,190 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_SCAN_DECODER_V2_H_
+#define DINGO_SERIAL_SCAN_DECODER_V2_H_
+
+#include <any>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "serial/record/V2/decode_plan.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/schema/V2/row_sink.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Decoder of the rows of a scan into one record reused from row to row.
+ *
+ * The projection is resolved once at construction, column_indexes_serial as
+ * in the projected RecordDecoderV2::Decode. Every row is then decoded into the
+ * slots of the previous one: a string or list column of the same type is
+ * assigned into the storage the slot already holds and a number overwrites
+ * it, so once the slots have grown a row decodes without allocation. A null
+ * column keeps its storage aside for the next value of the column.
+ *
+ * Rows are pulled one at a time with Decode or pushed from a storage iterator
+ * with Scan. A scan decoder belongs to one scan, it is not thread safe; the
+ * decoder it reads with must outlive it.
+ */
+class ScanDecoder {
+ public:
+  ScanDecoder(RecordDecoderPtr decoder,
+              const std::unordered_map<int, int>& column_indexes_serial);
+
+  // the sink points back at the decoder.
+  ScanDecoder(const ScanDecoder&) = delete;
+  ScanDecoder& operator=(const ScanDecoder&) = delete;
+
+  // Decode the row into Record(). Returns -1 when the row fails the checks,
+  // the record then holds a mix of this row and the one before.
+  int Decode(std::string_view key, std::string_view value);
+
+  // The last decoded row, the projected column of column_indexes_serial at
+  // its slot. Valid until the next row is decoded, a column moved out of it
+  // only loses its storage.
+  const std::vector<std::any>& Record() const { return record_; }
+  std::vector<std::any>& MutableRecord() { return record_; }
+
+  // Decode every row in front of iter and pass it to on_row(record), from
+  // iter.Valid() to iter.Next(). iter.key() and iter.value() give the row
+  // bytes as anything with data() and size(), as a RocksDB iterator does.
+  // Stops when on_row returns false. Returns the rows decoded, or -1 when a
+  // row fails the checks, iter then points at that row.
+  template <typename Iterator, typename OnRow>
+  long Scan(Iterator& iter, OnRow&& on_row) {
+    long rows = 0;
+    for (; iter.Valid(); iter.Next()) {
+      auto key = iter.key();
+      auto value = iter.value();
+      if (Decode(std::string_view(key.data(), key.size()),
+                 std::string_view(value.data(), value.size())) != 0) {
+        return -1;
+      }
+      ++rows;
+      if (!on_row(static_cast<const std::vector<std::any>&>(record_))) {
+        break;
+      }
+    }
+    return rows;
+  }
+
+  const DecodePlan& Plan() const { return plan_; }
+
+ private:
+  // Writes the columns of a row into the slots of the record.
+  class ReuseSink : public RowSink {
+   public:
+    explicit ReuseSink(ScanDecoder* scan) : scan_(scan) {}
+
+    void OnNull(int col) override;
+
+    void OnBool(int col, bool value) override { Assign(col, value); }
+    void OnInt32(int col, int32_t value) override { Assign(col, value); }
+    void OnInt64(int col, int64_t value) override { Assign(col, value); }
+    void OnFloat(int col, float value) override { Assign(col, value); }
+    void OnDouble(int col, double value) override { Assign(col, value); }
+    void OnString(int col, std::string_view value) override;
+
+    void OnBoolList(int col, std::vector<bool>&& value) override {
+      Assign(col, std::move(value));
+    }
+    void OnInt32List(int col, std::vector<int32_t>&& value) override {
+      Assign(col, std::move(value));
+    }
+    void OnInt64List(int col, std::vector<int64_t>&& value) override {
+      Assign(col, std::move(value));
+    }
+    void OnFloatList(int col, std::vector<float>&& value) override {
+      Assign(col, std::move(value));
+    }
+    void OnDoubleList(int col, std::vector<double>&& value) override {
+      Assign(col, std::move(value));
+    }
+    void OnStringList(int col, std::vector<std::string>&& value) override {
+      Assign(col, std::move(value));
+    }
+
+    void ReuseList(int col, std::vector<bool>& list) override {
+      Reuse(col, list);
+    }
+    void ReuseList(int col, std::vector<int32_t>& list) override {
+      Reuse(col, list);
+    }
+    void ReuseList(int col, std::vector<int64_t>& list) override {
+      Reuse(col, list);
+    }
+    void ReuseList(int col, std::vector<float>& list) override {
+      Reuse(col, list);
+    }
+    void ReuseList(int col, std::vector<double>& list) override {
+      Reuse(col, list);
+    }
+    void ReuseList(int col, std::vector<std::string>& list) override {
+      Reuse(col, list);
+    }
+
+   private:
+    // The slot of col with the storage put aside by a null back, nullptr
+    // for a col outside the record.
+    std::any* Slot(int col);
+
+    template <typename T>
+    void Assign(int col, T&& value) {
+      std::any* slot = Slot(col);
+      if (slot == nullptr) {
+        return;
+      }
+      if (auto* held = std::any_cast<std::decay_t<T>>(slot)) {
+        *held = std::forward<T>(value);
+      } else {
+        *slot = std::forward<T>(value);
+      }
+    }
+
+    // Hand the list held by the slot to the schema to decode into, Assign
+    // moves it back.
+    template <typename T>
+    void Reuse(int col, std::vector<T>& list) {
+      std::any* slot = Slot(col);
+      if (slot == nullptr) {
+        return;
+      }
+      if (auto* held = std::any_cast<std::vector<T>>(slot)) {
+        list.swap(*held);
+      }
+    }
+
+    ScanDecoder* scan_;
+  };
+
+  RecordDecoderPtr decoder_;
+  DecodePlan plan_;
+  ReuseSink sink_{this};
+
+  std::vector<std::any> record_;
+  // the storage of slots last decoded as null, by slot.
+  std::vector<std::any> spares_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,350 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_STATIC_RECORD_CODEC_V2_H_
+#define DINGO_SERIAL_STATIC_RECORD_CODEC_V2_H_
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "serial/record/V2/common.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/schema/V2/static_column_codec.h"
+#include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// Column roles and options of a StaticRecordCodec.
+struct Key {};
+struct Value {};
+struct Nullable {};
+
+template <typename T, typename Role, typename... Options>
+struct Column {
+  static_assert(std::is_same_v<Role, Key> || std::is_same_v<Role, Value>,
+                "A column is a Key or a Value.");
+
+  using Type = T;
+  using Codec = StaticColumnCodec<T>;
+  static constexpr bool kIsKey = std::is_same_v<Role, Key>;
+  static constexpr bool kNullable = (std::is_same_v<Options, Nullable> || ...);
+  // member of the row tuple.
+  using Field = std::conditional_t<kNullable, std::optional<T>, T>;
+
+  static_assert(!kIsKey || Codec::kKeyAllowed, "A list can not be a key.");
+};
+
+/*
+ * Codec of a schema known at compile time, e.g.
+ *
+ *   StaticRecordCodec<Column<int64_t, Key>,
+ *                     Column<std::string, Value, Nullable>>
+ *
+ * reads and writes std::tuple<int64_t, std::optional<std::string>>. The n-th
+ * column has schema index n, the bytes equal those of RecordEncoderV2 over
+ * MakeSchemas() with no value format option set. Nothing goes through
+ * std::any or a virtual call, every column is encoded by the code of its
+ * type.
+ *
+ * Decoding takes only the plain value layout, a value written with a format
+ * flag returns -1. Values of an older schema version may lack columns, those
+ * decode as nullopt, or fail for a column that is not Nullable.
+ */
+template <typename... Columns>
+class StaticRecordCodec {
+ public:
+  using Row = std::tuple<typename Columns::Field...>;
+
+  static constexpr size_t kColumnCount = sizeof...(Columns);
+  static constexpr size_t kValueColumnCount =
+      (static_cast<size_t>(!Columns::kIsKey) + ... + 0);
+
+  StaticRecordCodec(int schema_version, long common_id)
+      : StaticRecordCodec(schema_version, common_id, IsLE()) {}
+  StaticRecordCodec(int schema_version, long common_id, bool le)
+      : le_(le), schema_version_(schema_version), common_id_(common_id) {
+    Buf header(kDataPos, le_);
+    header.WriteInt(schema_version_);
+    header.WriteShort(0);
+    header.WriteShort(0);
+    for (size_t i = 0; i < kColumnCount; ++i) {
+      if (!kIsKeyColumn[i]) {
+        header.WriteShort(i);
+      }
+    }
+    header.GetString(value_header_);
+  }
+
+  int Encode(char prefix, const Row& row, std::string& key,
+             std::string& value) const {
+    EncodeKey(prefix, row, key);
+    EncodeValue(row, value);
+    return 0;
+  }
+
+  int EncodeKey(char prefix, const Row& row, std::string& output) const {
+    Buf buf(std::move(output), le_);
+    buf.Clear();
+    buf.Write(prefix);
+    buf.WriteLong(common_id_);
+    EncodeKeyColumns(row, buf, std::index_sequence_for<Columns...>{});
+    buf.WriteInt(CODEC_VERSION_V2);
+
+    buf.GetString(output);
+    return output.size();
+  }
+
+  int EncodeValue(const Row& row, std::string& output) const {
+    Buf buf(std::move(output), le_);
+    buf.Clear();
+    buf.WriteString(value_header_);
+    buf.ReSize(kDataPos);
+
+    int cnt_null_col = 0;
+    EncodeValueColumns(row, buf, cnt_null_col,
+                       std::index_sequence_for<Columns...>{});
+    buf.WriteShort(4, kValueColumnCount - cnt_null_col);
+    buf.WriteShort(6, cnt_null_col);
+
+    buf.GetString(output);
+    return output.size();
+  }
+
+  // Returns -1 for a row of another table or schema version, or a value not
+  // in the plain layout.
+  int Decode(std::string_view key, std::string_view value, Row& row) const {
+    if (DecodeKey(key, row) != 0) {
+      return -1;
+    }
+    return DecodeValue(value, row);
+  }
+
+  int DecodeKey(std::string_view key, Row& row) const {
+    BufView buf(key, le_);
+    // prefix(1 byte) + common id(8 bytes) + codec version(4 bytes).
+    if (DINGO_UNLIKELY(key.size() < 13 || buf.ReadLong(1) != common_id_ ||
+                       buf.ReadInt(key.size() - 4) != CODEC_VERSION_V2)) {
+      return -1;
+    }
+    buf.Skip(9);
+    bool ok = DecodeKeyColumns(buf, row, std::index_sequence_for<Columns...>{});
+    return ok ? 0 : -1;
+  }
+
+  int DecodeValue(std::string_view value, Row& row) const {
+    if (DINGO_UNLIKELY(value.size() < 8)) {
+      return -1;
+    }
+    BufView buf(value, le_);
+    int32_t version = buf.ReadInt(0);
+    if (GetValueFormat(version) != 0 ||
+        (version & kSchemaVersionMask) > schema_version_) {
+      return -1;
+    }
+
+    int entry_cnt = static_cast<uint16_t>(buf.ReadShort(4)) +
+                    static_cast<uint16_t>(buf.ReadShort(6));
+    if (DINGO_UNLIKELY(value.size() < 8 + entry_cnt * 6UL)) {
+      return -1;
+    }
+    // the id table of an older version may differ from ours.
+    bool ids_match = entry_cnt == kValueColumnCount &&
+                     memcmp(value.data() + 8, value_header_.data() + 8,
+                            kValueColumnCount * ID_2_BYTE) == 0;
+    bool ok = DecodeValueColumns(buf, entry_cnt, ids_match, row,
+                                 std::index_sequence_for<Columns...>{});
+    return ok ? 0 : -1;
+  }
+
+  // Schemas of the same layout, for RecordEncoderV2 and RecordDecoderV2.
+  static std::vector<BaseSchemaPtr> MakeSchemas() {
+    std::vector<BaseSchemaPtr> schemas;
+    (schemas.push_back(MakeSchema<Columns>(schemas.size())), ...);
+    return schemas;
+  }
+
+ private:
+  static constexpr std::array<bool, kColumnCount> kIsKeyColumn{
+      Columns::kIsKey...};
+
+  // value columns before column i, which is its entry in the tables.
+  static constexpr int ValueOrdinal(size_t i) {
+    int n = 0;
+    for (size_t c = 0; c < i; ++c) {
+      n += kIsKeyColumn[c] ? 0 : 1;
+    }
+    return n;
+  }
+
+  // schema_version(4 bytes) + col_cnt(2 bytes + 2 bytes) + ids + offsets.
+  static constexpr int kOffsetPos = 8 + kValueColumnCount * ID_2_BYTE;
+  static constexpr int kDataPos =
+      kOffsetPos + kValueColumnCount * OFFSET_4_BYTE;
+
+  template <size_t I>
+  using ColumnAt = std::tuple_element_t<I, std::tuple<Columns...>>;
+
+  template <typename C>
+  static BaseSchemaPtr MakeSchema(size_t index) {
+    auto schema = std::make_shared<DingoSchema<typename C::Type>>();
+    schema->SetIndex(index);
+    schema->SetIsKey(C::kIsKey);
+    schema->SetAllowNull(C::kNullable);
+    return schema;
+  }
+
+  template <size_t... I>
+  void EncodeKeyColumns(const Row& row, Buf& buf,
+                        std::index_sequence<I...>) const {
+    (EncodeKeyColumn<I>(std::get<I>(row), buf), ...);
+  }
+
+  template <size_t I, typename F>
+  void EncodeKeyColumn(const F& field, Buf& buf) const {
+    using C = ColumnAt<I>;
+    if constexpr (C::kIsKey) {
+      if constexpr (C::kNullable) {
+        if (field.has_value()) {
+          buf.Write(kNotNull);
+          C::Codec::EncodeKey(*field, buf);
+        } else {
+          buf.Write(kNull);
+          C::Codec::EncodeNullKey(buf);
+        }
+      } else {
+        C::Codec::EncodeKey(field, buf);
+      }
+    }
+  }
+
+  template <size_t... I>
+  void EncodeValueColumns(const Row& row, Buf& buf, int& cnt_null_col,
+                          std::index_sequence<I...>) const {
+    (EncodeValueColumn<I>(std::get<I>(row), buf, cnt_null_col), ...);
+  }
+
+  template <size_t I, typename F>
+  void EncodeValueColumn(const F& field, Buf& buf, int& cnt_null_col) const {
+    using C = ColumnAt<I>;
+    if constexpr (!C::kIsKey) {
+      constexpr size_t kSlot = kOffsetPos + ValueOrdinal(I) * OFFSET_4_BYTE;
+      if constexpr (C::kNullable) {
+        if (!field.has_value()) {
+          cnt_null_col++;
+          buf.WriteInt(kSlot, -1);
+          return;
+        }
+        buf.WriteInt(kSlot, buf.Size());
+        C::Codec::EncodeValue(*field, buf);
+      } else {
+        buf.WriteInt(kSlot, buf.Size());
+        C::Codec::EncodeValue(field, buf);
+      }
+    }
+  }
+
+  template <size_t... I>
+  bool DecodeKeyColumns(BufView& buf, Row& row,
+                        std::index_sequence<I...>) const {
+    return (DecodeKeyColumn<I>(buf, std::get<I>(row)) && ...);
+  }
+
+  template <size_t I, typename F>
+  bool DecodeKeyColumn(BufView& buf, F& field) const {
+    using C = ColumnAt<I>;
+    if constexpr (C::kIsKey) {
+      if constexpr (C::kNullable) {
+        if (buf.Read() == kNull) {
+          buf.Skip(C::Codec::kKeyLength);
+          field.reset();
+          return true;
+        }
+        return C::Codec::DecodeKey(buf, field.emplace());
+      } else {
+        return C::Codec::DecodeKey(buf, field);
+      }
+    }
+    return true;
+  }
+
+  template <size_t... I>
+  bool DecodeValueColumns(const BufView& buf, int entry_cnt, bool ids_match,
+                          Row& row, std::index_sequence<I...>) const {
+    return (DecodeValueColumn<I>(buf, entry_cnt, ids_match, std::get<I>(row)) &&
+            ...);
+  }
+
+  // Offset of column id, -1 when it is null or missing from the table.
+  static int FindOffset(const BufView& buf, int entry_cnt, int id) {
+    int offset_pos = 8 + entry_cnt * ID_2_BYTE;
+    for (int i = 0; i < entry_cnt; ++i) {
+      if (buf.ReadShort(8 + i * ID_2_BYTE) == id) {
+        return buf.ReadInt(offset_pos + i * OFFSET_4_BYTE);
+      }
+    }
+    return -1;
+  }
+
+  template <size_t I, typename F>
+  bool DecodeValueColumn(const BufView& buf, int entry_cnt, bool ids_match,
+                         F& field) const {
+    using C = ColumnAt<I>;
+    if constexpr (!C::kIsKey) {
+      int offset =
+          ids_match ? buf.ReadInt(kOffsetPos + ValueOrdinal(I) * OFFSET_4_BYTE)
+                    : FindOffset(buf, entry_cnt, I);
+      if constexpr (C::kNullable) {
+        if (offset == -1) {
+          field.reset();
+          return true;
+        }
+        C::Codec::DecodeValue(buf, offset, field.emplace());
+      } else {
+        if (offset == -1) {
+          return false;
+        }
+        C::Codec::DecodeValue(buf, offset, field);
+      }
+    }
+    return true;
+  }
+
+  static constexpr uint8_t kNull = 0;
+  static constexpr uint8_t kNotNull = 1;
+
+  bool le_;
+  int schema_version_;
+  long common_id_;
+  // schema version, zero counts and the id table.
+  std::string value_header_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
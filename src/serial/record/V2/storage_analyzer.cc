@@ -0,0 +1,364 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/storage_analyzer.h"
+
+#include <algorithm>
+#include <any>
+#include <cstdio>
+#include <utility>
+
+#include "serial/record/V2/common.h"
+#include "serial/record/V2/value_header.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// the key bytes around the columns: the name space, common id and codec
+// version.
+constexpr size_t kKeyPrefixSize = 9;
+constexpr size_t kCodecVersionSize = 4;
+
+// The order of StorageAnalysis::header_estimates.
+constexpr ValueLayout kEstimatedLayouts[] = {
+    ValueLayout::kPlain, ValueLayout::kSparse, ValueLayout::kNullBitmap};
+
+void AppendParts(std::string& out, const StorageBreakdown& bytes,
+                 double rows) {
+  std::pair<const char*, size_t> parts[] = {
+      {"key prefix", bytes.key_prefix},
+      {"codec version", bytes.codec_version},
+      {"null flags", bytes.null_flags},
+      {"string padding", bytes.string_padding},
+      {"value header", bytes.value_header},
+      {"null entries", bytes.null_entries},
+      {"payload", bytes.payload},
+      {"checksum", bytes.checksum}};
+  char number[32];
+  bool first = true;
+  for (const auto& part : parts) {
+    if (part.second == 0) {
+      continue;
+    }
+    snprintf(number, sizeof(number), "%.1f", rows > 0 ? part.second / rows : 0);
+    out += std::string(first ? " " : ", ") + part.first + " " + number + "B";
+    first = false;
+  }
+}
+
+}  // namespace
+
+size_t StorageBreakdown::Total() const {
+  return key_prefix + codec_version + null_flags + string_padding +
+         value_header + null_entries + payload + checksum;
+}
+
+void StorageBreakdown::Add(const StorageBreakdown& other) {
+  key_prefix += other.key_prefix;
+  codec_version += other.codec_version;
+  null_flags += other.null_flags;
+  string_padding += other.string_padding;
+  value_header += other.value_header;
+  null_entries += other.null_entries;
+  payload += other.payload;
+  checksum += other.checksum;
+}
+
+double StorageAnalysis::BytesPerRow(size_t bytes) const {
+  return rows > 0 ? static_cast<double>(bytes) / rows : 0;
+}
+
+std::string StorageAnalysis::ToString() const {
+  char number[32];
+  snprintf(number, sizeof(number), "%.1f",
+           BytesPerRow(key_bytes + stored_value_bytes));
+  std::string out = "rows " + std::to_string(rows) + ", " + number + "B/row";
+  if (compressed_values > 0) {
+    snprintf(number, sizeof(number), "%.1f", BytesPerRow(value_bytes));
+    out += std::string(", values inflated ") + number + "B/row";
+  }
+  out += "\ntable:";
+  AppendParts(out, bytes, rows);
+  out += "\n";
+  for (const auto& column : columns) {
+    out += "column " + std::to_string(column.column) + " " +
+           ColumnTypeName(column.type) + (column.is_key ? " key" : "") +
+           ": nulls " + std::to_string(column.nulls) + ";";
+    AppendParts(out, column.bytes, rows);
+    out += "\n";
+  }
+  out += "header";
+  for (size_t i = 0; i < header_estimates.size(); ++i) {
+    const auto& estimate = header_estimates[i];
+    snprintf(number, sizeof(number), "%.1f", BytesPerRow(estimate.bytes));
+    out += std::string(i == 0 ? " " : ", ") + ValueLayoutName(estimate.layout) +
+           (estimate.compact_header ? " compact " : " ") + number + "B";
+  }
+  out += "\n";
+  return out;
+}
+
+StorageAnalyzer::StorageAnalyzer(int schema_version,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 long common_id)
+    : StorageAnalyzer(schema_version, schemas, common_id, IsLE()) {}
+
+StorageAnalyzer::StorageAnalyzer(int schema_version,
+                                 const std::vector<BaseSchemaPtr>& schemas,
+                                 long common_id, bool le)
+    : schemas_(schemas),
+      le_(le),
+      decoder_(schema_version, schemas, common_id, le) {
+  for (const auto& schema : schemas_) {
+    if (schema == nullptr || schema->IsKey()) {
+      continue;
+    }
+    ++value_columns_;
+    compact_ids_ = compact_ids_ && schema->GetIndex() < 255;
+  }
+  Clear();
+}
+
+void StorageAnalyzer::Clear() {
+  analysis_ = StorageAnalysis();
+  position_of_.clear();
+  for (const auto& schema : schemas_) {
+    if (schema == nullptr) {
+      continue;
+    }
+    int index = schema->GetIndex();
+    if (index >= 0) {
+      if (static_cast<size_t>(index) >= position_of_.size()) {
+        position_of_.resize(index + 1, -1);
+      }
+      position_of_[index] = analysis_.columns.size();
+    }
+    ColumnStorage column;
+    column.column = index;
+    column.type = schema->GetType();
+    column.is_key = schema->IsKey();
+    analysis_.columns.push_back(column);
+  }
+  for (ValueLayout layout : kEstimatedLayouts) {
+    analysis_.header_estimates.push_back({layout, false, 0});
+    analysis_.header_estimates.push_back({layout, true, 0});
+  }
+}
+
+int StorageAnalyzer::AddRow(std::string_view key, std::string_view value) {
+  std::vector<std::any> record;
+  if (decoder_.Decode(key, value, record) != 0) {
+    return -1;
+  }
+
+  row_.bytes = StorageBreakdown();
+  row_.stored_value_bytes = 0;
+  row_.value_bytes = 0;
+  row_.compressed = false;
+  row_.unattributed = false;
+  row_.columns.assign(analysis_.columns.size(), StorageBreakdown());
+  size_t data_size = 0;
+  if (AddKey(key, row_) < 0 || AddValue(value, row_, data_size) < 0) {
+    return -1;
+  }
+
+  // read through, the analysis takes the row.
+  analysis_.bytes.Add(row_.bytes);
+  for (size_t i = 0; i < row_.columns.size(); ++i) {
+    analysis_.columns[i].bytes.Add(row_.columns[i]);
+  }
+  analysis_.stored_value_bytes += row_.stored_value_bytes;
+  analysis_.value_bytes += row_.value_bytes;
+  analysis_.compressed_values += row_.compressed ? 1 : 0;
+  analysis_.unattributed_values += row_.unattributed ? 1 : 0;
+
+  int not_null = 0;
+  for (size_t i = 0; i < schemas_.size(); ++i) {
+    const auto& schema = schemas_[i];
+    if (schema == nullptr || schema->GetIndex() < 0) {
+      continue;
+    }
+    size_t index = schema->GetIndex();
+    auto& column = analysis_.columns[position_of_[index]];
+    ++column.rows;
+    if (index >= record.size() || !record[index].has_value()) {
+      ++column.nulls;
+    } else if (!schema->IsKey()) {
+      ++not_null;
+    }
+  }
+
+  ++analysis_.rows;
+  analysis_.key_bytes += key.size();
+  AddHeaderEstimates(not_null, data_size, analysis_);
+  return 0;
+}
+
+long StorageAnalyzer::AddRows(const KeyValue* rows, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (AddRow(rows[i].GetKey(), rows[i].GetValue()) != 0) {
+      return -1;
+    }
+  }
+  return count;
+}
+
+int StorageAnalyzer::AddKey(std::string_view key, RowStorage& row) const {
+  StorageBreakdown& bytes = row.bytes;
+  if (key.size() < kKeyPrefixSize + kCodecVersionSize) {
+    return -1;
+  }
+  bytes.key_prefix += kKeyPrefixSize;
+  bytes.codec_version += kCodecVersionSize;
+
+  // the key columns in schema order, as the decoder reads them.
+  BufView key_buf(key.substr(0, key.size() - kCodecVersionSize), le_);
+  key_buf.Skip(kKeyPrefixSize);
+  for (const auto& schema : schemas_) {
+    if (schema == nullptr || !schema->IsKey()) {
+      continue;
+    }
+    size_t start = key_buf.ReadOffset();
+    std::any data = schema->DecodeKey(key_buf);
+    size_t length = key_buf.ReadOffset() - start;
+
+    StorageBreakdown column;
+    if (!data.has_value()) {
+      column.null_entries = length;
+    } else {
+      size_t flag = schema->AllowNull() ? 1 : 0;
+      size_t payload = length - flag;
+      if (schema->GetType() == BaseSchema::kString) {
+        payload = std::any_cast<const std::string&>(data).size();
+        column.string_padding = length - flag - payload;
+      }
+      column.null_flags = flag;
+      column.payload = payload;
+    }
+    bytes.Add(column);
+    if (schema->GetIndex() >= 0) {
+      row.columns[position_of_[schema->GetIndex()]].Add(column);
+    }
+  }
+  // bytes past the columns of these schemas.
+  bytes.payload += key_buf.Size() - key_buf.ReadOffset();
+  return 0;
+}
+
+int StorageAnalyzer::AddValue(std::string_view value, RowStorage& row,
+                              size_t& data_size) const {
+  StorageBreakdown& bytes = row.bytes;
+  std::vector<StorageBreakdown>& columns = row.columns;
+  row.stored_value_bytes += value.size();
+  if (value.size() < 8) {
+    // a value of the key columns alone.
+    bytes.payload += value.size();
+    row.value_bytes += value.size();
+    return 0;
+  }
+
+  int stored_format = GetValueFormat(BufView(value, le_).ReadInt(0));
+  if (stored_format & VALUE_FORMAT_CHECKSUM) {
+    bytes.checksum += kValueChecksumSize;
+  }
+  std::string scratch;
+  if (!InflateValue(value, scratch, le_)) {
+    return -1;
+  }
+  row.value_bytes += value.size();
+  row.compressed = (stored_format & VALUE_FORMAT_COMPRESSED) != 0;
+
+  BufView value_buf(value, le_);
+  int format = GetValueFormat(value_buf.ReadInt());
+  ValueHeader header(value_buf, format);
+  if (!header.InRange(value.size())) {
+    return -1;
+  }
+  data_size = value.size() - header.data_pos;
+  if (format & (VALUE_FORMAT_STATIC_OFFSETS | VALUE_FORMAT_BOOL_BITS)) {
+    // the column bytes are not in the tables.
+    bytes.value_header += header.data_pos;
+    bytes.payload += data_size;
+    row.unattributed = true;
+    return 0;
+  }
+
+  size_t entry_size = header.id_unit + header.offset_unit;
+  size_t null_entries = 0;
+  // (offset, position in columns or -1) of the not null entries.
+  std::vector<std::pair<int, int>> spans;
+  for (int i = 0; i < header.entry_cnt; ++i) {
+    int id = header.ReadId(value_buf, i);
+    int position = id >= 0 && static_cast<size_t>(id) < position_of_.size()
+                       ? position_of_[id]
+                       : -1;
+    int offset = header.ReadOffset(value_buf, i);
+    if (offset == -1) {
+      null_entries += entry_size;
+      if (position >= 0) {
+        columns[position].null_entries += entry_size;
+      }
+      continue;
+    }
+    if (offset < header.data_pos ||
+        static_cast<size_t>(offset) > value.size()) {
+      return -1;
+    }
+    if (position >= 0) {
+      columns[position].value_header += entry_size;
+    }
+    spans.emplace_back(offset, position);
+  }
+  bytes.null_entries += null_entries;
+  bytes.value_header += header.data_pos - null_entries;
+  bytes.payload += data_size;
+
+  // the data of a column runs to the next one, the last to the value end.
+  std::sort(spans.begin(), spans.end());
+  for (size_t i = 0; i < spans.size(); ++i) {
+    size_t end = i + 1 < spans.size() ? spans[i + 1].first : value.size();
+    if (spans[i].second >= 0) {
+      columns[spans[i].second].payload += end - spans[i].first;
+    }
+  }
+  return 0;
+}
+
+void StorageAnalyzer::AddHeaderEstimates(int not_null, size_t data_size,
+                                         StorageAnalysis& analysis) const {
+  size_t count = value_columns_;
+  size_t bitmap = (count + 7) / 8;
+  size_t sparse = 2 * not_null <= value_columns_ ? not_null : count;
+  // the layouts as RecordEncoderV2 writes them, the compact tables with 2
+  // byte offsets while the value fits them.
+  size_t estimates[] = {
+      8 + count * (ID_2_BYTE + OFFSET_4_BYTE),
+      PlanPlainValueTables(count, compact_ids_, data_size).data_pos,
+      8 + sparse * (ID_2_BYTE + OFFSET_4_BYTE),
+      PlanPlainValueTables(sparse, compact_ids_, data_size).data_pos,
+      8 + bitmap + not_null * (ID_2_BYTE + OFFSET_4_BYTE),
+      bitmap +
+          PlanPlainValueTables(not_null, compact_ids_, data_size + bitmap)
+              .data_pos};
+  for (size_t i = 0; i < analysis.header_estimates.size(); ++i) {
+    analysis.header_estimates[i].bytes += estimates[i];
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,157 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_STORAGE_ANALYZER_V2_H_
+#define DINGO_SERIAL_STORAGE_ANALYZER_V2_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/encoding_advisor.h"
+#include "serial/record/V2/record_decoder.h"
+#include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/keyvalue.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// Where the bytes of the sampled rows go, summed over them.
+struct StorageBreakdown {
+  // the name space byte and common id leading every key, 9 a key.
+  size_t key_prefix{0};
+  // the codec version closing every key, 4 a key.
+  size_t codec_version{0};
+  // the null flag byte of the not null values of nullable key columns.
+  size_t null_flags{0};
+  // the group markers and zero padding of comparable key strings.
+  size_t string_padding{0};
+  // schema version, column counts, null bitmap and the table entries of the
+  // not null columns.
+  size_t value_header{0};
+  // the bytes of null values: their key filler and flag, their table
+  // entries in values that list them.
+  size_t null_entries{0};
+  // the column data.
+  size_t payload{0};
+  // the CRC-32C trailers.
+  size_t checksum{0};
+
+  size_t Total() const;
+  void Add(const StorageBreakdown& other);
+};
+
+struct ColumnStorage {
+  int column{-1};
+  BaseSchema::Type type{};
+  bool is_key{false};
+
+  size_t rows{0};
+  size_t nulls{0};
+  // the parts of the column, key_prefix, codec_version and checksum are 0;
+  // value_header is its table entries.
+  StorageBreakdown bytes;
+};
+
+struct StorageAnalysis {
+  size_t rows{0};
+  size_t key_bytes{0};
+  // as stored, and inflated: decompressed and without checksums, which the
+  // breakdown is of.
+  size_t stored_value_bytes{0};
+  size_t value_bytes{0};
+  size_t compressed_values{0};
+  // values with static offsets or bool bits, whose data is counted in the
+  // table payload but not the column ones.
+  size_t unattributed_values{0};
+
+  StorageBreakdown bytes;
+  // in schema order.
+  std::vector<ColumnStorage> columns;
+  // The value header bytes the sample would take in the plain, sparse and
+  // null bitmap layouts, without and with the compact header, from the
+  // counts of its not null columns: what turning them on saves on headers.
+  std::vector<LayoutEstimate> header_estimates;
+
+  double BytesPerRow(size_t bytes) const;
+
+  // One line for the table and per column, the parts per row.
+  std::string ToString() const;
+};
+
+/*
+ * Tells what the bytes of a table go to from a sample of its encoded rows,
+ * for capacity planning: every key is walked column by column and every
+ * value through its tables, so that the framing the codec adds is told from
+ * the column data, per column and for the table, without encoding anything
+ * again. See EncodingAdvisor to size the column encodings and whole values
+ * under other layouts.
+ *
+ * Values that are compressed are measured decompressed, the saving is in
+ * stored_value_bytes. Not thread safe.
+ */
+class StorageAnalyzer {
+ public:
+  StorageAnalyzer(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                  long common_id);
+  StorageAnalyzer(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+                  long common_id, bool le);
+
+  // Add a sampled row. Returns -1 when the decoder rejects it, the analysis
+  // is then unchanged.
+  int AddRow(std::string_view key, std::string_view value);
+  // Returns the rows added, or -1 at the first row rejected.
+  long AddRows(const KeyValue* rows, size_t count);
+  size_t RowCount() const { return analysis_.rows; }
+  void Clear();
+
+  const StorageAnalysis& Analyze() const { return analysis_; }
+
+ private:
+  // The bytes of a row, added to the analysis once all of it is read.
+  struct RowStorage {
+    StorageBreakdown bytes;
+    size_t stored_value_bytes{0};
+    size_t value_bytes{0};
+    bool compressed{false};
+    bool unattributed{false};
+    // by position in StorageAnalysis::columns.
+    std::vector<StorageBreakdown> columns;
+  };
+
+  // the parts of a row read into row.
+  int AddKey(std::string_view key, RowStorage& row) const;
+  int AddValue(std::string_view value, RowStorage& row,
+               size_t& data_size) const;
+  void AddHeaderEstimates(int not_null, size_t data_size,
+                          StorageAnalysis& analysis) const;
+
+  std::vector<BaseSchemaPtr> schemas_;
+  bool le_;
+  RecordDecoderV2 decoder_;
+  // the value columns, and the position in schemas_ of a column index.
+  int value_columns_{0};
+  std::vector<int> position_of_;
+  bool compact_ids_{true};
+
+  StorageAnalysis analysis_;
+  // reused from row to row.
+  RowStorage row_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,141 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/value_diff.h"
+
+#include <algorithm>
+
+#include "serial/record/V2/common.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// The spans of value by id and its data format flags, value pointed at its
+// inflated form in scratch when compressed.
+int ReadSpansById(std::string_view& value, std::string& scratch, bool le,
+                  int& format, std::vector<ValueSpan>& spans) {
+  if (HasValueChecksum(value, le) || !InflateValue(value, scratch, le)) {
+    return -1;
+  }
+  int32_t version;
+  if (ReadValueSpans(value, le, version, spans) < 0) {
+    return -1;
+  }
+  format = GetValueFormat(version) & kValueDataFormatFlags;
+  std::sort(spans.begin(), spans.end(),
+            [](const ValueSpan& lhs, const ValueSpan& rhs) {
+              return lhs.id < rhs.id;
+            });
+  return 0;
+}
+
+std::string_view SpanBytes(std::string_view value, const ValueSpan& span) {
+  return value.substr(span.offset, span.end - span.offset);
+}
+
+}  // namespace
+
+ValueDiff::ValueDiff(int schema_version,
+                     const std::vector<BaseSchemaPtr>& schemas)
+    : ValueDiff(schema_version, schemas, IsLE()) {}
+
+ValueDiff::ValueDiff(int schema_version,
+                     const std::vector<BaseSchemaPtr>& schemas, bool le)
+    : schemas_(schemas), le_(le), patch_(schema_version, schemas, le) {}
+
+int ValueDiff::DiffSpans(std::string_view& old_value,
+                         std::string_view& new_value) {
+  changed_.clear();
+  int old_format;
+  int new_format;
+  if (ReadSpansById(old_value, old_scratch_, le_, old_format, old_spans_) <
+          0 ||
+      ReadSpansById(new_value, new_scratch_, le_, new_format, new_spans_) < 0) {
+    return -1;
+  }
+  // the same bytes may read as another value under other flags.
+  bool same_format = old_format == new_format;
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < old_spans_.size() || j < new_spans_.size()) {
+    if (j == new_spans_.size() ||
+        (i < old_spans_.size() && old_spans_[i].id < new_spans_[j].id)) {
+      changed_.push_back(old_spans_[i++].id);
+    } else if (i == old_spans_.size() || new_spans_[j].id < old_spans_[i].id) {
+      changed_.push_back(new_spans_[j++].id);
+    } else {
+      if (!same_format || SpanBytes(old_value, old_spans_[i]) !=
+                              SpanBytes(new_value, new_spans_[j])) {
+        changed_.push_back(old_spans_[i].id);
+      }
+      ++i;
+      ++j;
+    }
+  }
+  return changed_.size();
+}
+
+int ValueDiff::Diff(std::string_view old_value, std::string_view new_value,
+                    std::vector<int>& changed) {
+  if (DiffSpans(old_value, new_value) < 0) {
+    return -1;
+  }
+  changed = changed_;
+  return changed.size();
+}
+
+int ValueDiff::Patch(std::string_view old_value, std::string_view new_value,
+                     std::string& output) {
+  if (DiffSpans(old_value, new_value) < 0) {
+    return -1;
+  }
+  patch_.Clear();
+  auto span = new_spans_.begin();
+  for (int id : changed_) {
+    if (id >= static_cast<int>(schemas_.size()) || schemas_[id] == nullptr ||
+        schemas_[id]->IsKey()) {
+      return -1;
+    }
+    while (span != new_spans_.end() && span->id < id) {
+      ++span;
+    }
+    if (span != new_spans_.end() && span->id == id) {
+      patch_.SetBytes(id, SpanBytes(new_value, *span));
+    } else if (schemas_[id]->AllowNull()) {
+      patch_.Set(id, std::any());
+    } else {
+      return -1;
+    }
+  }
+  return patch_.Encode(output);
+}
+
+int ValueDiff::IsNoOpUpdate(const RecordEncoderV2& encoder,
+                            std::string_view old_value,
+                            const std::vector<std::any>& record) {
+  encoder.EncodeValue(record, record_value_);
+  std::string_view new_value(record_value_);
+  int changed = DiffSpans(old_value, new_value);
+  if (changed < 0) {
+    return -1;
+  }
+  return changed == 0 ? 1 : 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
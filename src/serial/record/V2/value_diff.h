@@ -0,0 +1,91 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_VALUE_DIFF_V2_H_
+#define DINGO_SERIAL_VALUE_DIFF_V2_H_
+
+#include <any>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serial/record/V2/delta_record.h"
+#include "serial/record/V2/record_encoder.h"
+#include "serial/record/V2/value_header.h"
+#include "serial/schema/V2/base_schema.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * The value columns that differ between two values of a row, found on their
+ * bytes, for change data capture and replication to ship the changed columns
+ * instead of the row image.
+ *
+ * The data of each column is located from the id and offset tables of both
+ * values and compared byte wise, a column null in one value and not in the
+ * other differs. Values with other data format flags may hold a column in
+ * other bytes, every column present in either then differs. Compressed values
+ * are inflated first; static offsets, bool bits and checksummed values are
+ * not taken.
+ *
+ * A patch is a delta record, see delta_record.h, of the changed columns set
+ * to their new bytes or to null, which a DeltaMerger of the schemas folds
+ * into the old value.
+ *
+ * Not thread safe, the inflated values and the patch are built in buffers of
+ * the diff.
+ */
+class ValueDiff {
+ public:
+  ValueDiff(int schema_version, const std::vector<BaseSchemaPtr>& schemas);
+  ValueDiff(int schema_version, const std::vector<BaseSchemaPtr>& schemas,
+            bool le);
+
+  // The ids of the changed columns in ascending order into changed. Returns
+  // their count, or -1 for a value the diff does not take.
+  int Diff(std::string_view old_value, std::string_view new_value,
+           std::vector<int>& changed /*output*/);
+
+  // Write the patch of old_value to new_value to output. Returns its size,
+  // or -1 as Diff and for a changed column that is not a value column of the
+  // schemas or left null in new_value while it does not allow null.
+  int Patch(std::string_view old_value, std::string_view new_value,
+            std::string& output /*output*/);
+
+  // Whether writing record, encoded by encoder, over old_value changes no
+  // value column: 1 for a no-op update, 0 when a column changes, -1 as Diff.
+  int IsNoOpUpdate(const RecordEncoderV2& encoder, std::string_view old_value,
+                   const std::vector<std::any>& record);
+
+ private:
+  // Diff into changed_, the values pointed at their inflated forms and the
+  // spans of both left by id.
+  int DiffSpans(std::string_view& old_value, std::string_view& new_value);
+
+  std::vector<BaseSchemaPtr> schemas_;
+  bool le_;
+  DeltaRecordEncoder patch_;
+  std::string old_scratch_;
+  std::string new_scratch_;
+  std::string record_value_;
+  std::vector<ValueSpan> old_spans_;
+  std::vector<ValueSpan> new_spans_;
+  std::vector<int> changed_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
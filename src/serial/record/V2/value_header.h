@@ -15,9 +15,21 @@
 #ifndef DINGO_SERIAL_VALUE_HEADER_H_
 #define DINGO_SERIAL_VALUE_HEADER_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
+
 #include "common.h"
 #include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/compression.h"
+#include "serial/utils/V2/crc32c.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -28,24 +40,385 @@ class ValueHeader {
   int cnt_null_col;
   int total_col_cnt;
 
+  // entries of the id/offset tables, only the not null columns when the
+  // nulls are in the bitmap.
+  int entry_cnt;
+
+  int null_bitmap_pos{0};
+  // leading fixed width columns of a static offsets value, its null bitmap
+  // covers them only and the offset table the other columns.
+  int fixed_cnt{0};
   int ids_pos;
   int offset_pos;
   int data_pos;
 
+  // the not null bool columns of a bool bits value, out of the tables: their
+  // sorted ids, a bit each, and a 0 and a 1 byte their offsets point at.
+  int bool_cnt{0};
+  int bool_ids_pos{0};
+  int bool_bits_pos{0};
+  int truth_pos{0};
+
+  // layout flags from the schema version, see valueFormatFlag.
+  int format{0};
+  int id_unit{ID_2_BYTE};
+  int offset_unit{OFFSET_4_BYTE};
+
+  // The id table equals the one of the decoding schemas, the offset of the
+  // n-th value column is then the n-th offset (the NotNullRank-th one with a
+  // null bitmap).
+  bool ids_match{false};
+
+  // value length of the fixed width columns by id, for static offsets values
+  // not written with the decoding schemas.
+  const std::vector<int>* fixed_lengths{nullptr};
+
   ValueHeader() = default;
 
-  ValueHeader(Buf& value_buf) {
+  template <typename B>
+  ValueHeader(B& value_buf, int value_format = 0) : format(value_format) {
     cnt_not_null_col = value_buf.ReadShort();
     cnt_null_col = value_buf.ReadShort();
     total_col_cnt = cnt_not_null_col + cnt_null_col;
 
+    if (format & VALUE_FORMAT_COMPACT_ID) {
+      id_unit = ID_1_BYTE;
+    }
+    if (format & VALUE_FORMAT_COMPACT_OFFSET) {
+      offset_unit = OFFSET_2_BYTE;
+    }
+
     // schema_version(4 bytes) + col_cnt (2 bytes + 2bytes) = 8 bytes.
     ids_pos = 8;
-    offset_pos = ids_pos + ID_2_BYTE * total_col_cnt;
-    data_pos = offset_pos + OFFSET_4_BYTE * total_col_cnt;
+    entry_cnt = total_col_cnt;
+    if (format & VALUE_FORMAT_STATIC_OFFSETS) {
+      // fixed_cnt(2 bytes) | ids | null bitmap | offsets | fixed columns.
+      fixed_cnt = value_buf.ReadShort();
+      ids_pos += 2;
+      null_bitmap_pos = ids_pos + id_unit * entry_cnt;
+      offset_pos = null_bitmap_pos + (fixed_cnt + 7) / 8;
+      data_pos = offset_pos + offset_unit * (entry_cnt - fixed_cnt);
+      return;
+    }
+    if (format & VALUE_FORMAT_BOOL_BITS) {
+      // bool_cnt(2 bytes) | ids | offsets | bool ids | bool bits | 0 | 1, the
+      // null columns left out and the bools counted not null. The 0 and 1
+      // bytes lead the data, a row of bools alone has some.
+      bool_cnt = value_buf.ReadShort();
+      ids_pos += 2;
+      entry_cnt = cnt_not_null_col - bool_cnt;
+      offset_pos = ids_pos + id_unit * entry_cnt;
+      bool_ids_pos = offset_pos + offset_unit * entry_cnt;
+      bool_bits_pos = bool_ids_pos + id_unit * bool_cnt;
+      truth_pos = bool_bits_pos + (bool_cnt + 7) / 8;
+      data_pos = truth_pos;
+      return;
+    }
+    if (format & VALUE_FORMAT_NULL_BITMAP) {
+      // one bit per value column of the writer, set for null.
+      null_bitmap_pos = ids_pos;
+      ids_pos += (total_col_cnt + 7) / 8;
+      entry_cnt = cnt_not_null_col;
+    }
+    offset_pos = ids_pos + id_unit * entry_cnt;
+    data_pos = offset_pos + offset_unit * entry_cnt;
+  }
+
+  bool HasNullBitmap() const {
+    return (format & (VALUE_FORMAT_NULL_BITMAP | VALUE_FORMAT_STATIC_OFFSETS |
+                      VALUE_FORMAT_BOOL_BITS)) == VALUE_FORMAT_NULL_BITMAP;
+  }
+  bool HasStaticOffsets() const { return format & VALUE_FORMAT_STATIC_OFFSETS; }
+  bool HasBoolBits() const {
+    return (format & (VALUE_FORMAT_BOOL_BITS | VALUE_FORMAT_STATIC_OFFSETS)) ==
+           VALUE_FORMAT_BOOL_BITS;
+  }
+
+  // The table readers below read through the range checks of B unless
+  // kChecked is false, for values whose tables were checked to be in range
+  // once, see InRange.
+
+  // null bit of the writer's ordinal-th value column.
+  template <bool kChecked = true, typename B>
+  bool IsNullColumn(B& value_buf, int ordinal) const {
+    return (ReadByteAt<kChecked>(value_buf, null_bitmap_pos + ordinal / 8) >>
+            (ordinal % 8)) &
+           1;
+  }
+
+  // table entry of the ordinal-th value column, i.e. the not null ones in
+  // front of it.
+  template <bool kChecked = true, typename B>
+  int NotNullRank(B& value_buf, int ordinal) const {
+    int rank = 0;
+    int pos = null_bitmap_pos;
+    for (int i = 0; i < ordinal / 8; ++i) {
+      rank += 8 - __builtin_popcount(ReadByteAt<kChecked>(value_buf, pos + i));
+    }
+    int rest = ordinal % 8;
+    if (rest > 0) {
+      uint8_t bits = ReadByteAt<kChecked>(value_buf, pos + ordinal / 8) &
+                     ((1U << rest) - 1);
+      rank += rest - __builtin_popcount(bits);
+    }
+    return rank;
+  }
+
+  // id of the i-th entry of the id table.
+  template <bool kChecked = true, typename B>
+  int ReadId(B& value_buf, int i) const {
+    if (id_unit == ID_1_BYTE) {
+      return ReadByteAt<kChecked>(value_buf, ids_pos + i);
+    }
+    return ReadShortAt<kChecked>(value_buf, ids_pos + i * ID_2_BYTE);
+  }
+
+  // i-th offset, -1 for a null column.
+  template <bool kChecked = true, typename B>
+  int ReadOffset(B& value_buf, int i) const {
+    if (offset_unit == OFFSET_2_BYTE) {
+      int offset = static_cast<uint16_t>(
+          ReadShortAt<kChecked>(value_buf, offset_pos + i * OFFSET_2_BYTE));
+      return offset == kCompactOffsetNull ? -1 : offset;
+    }
+    if constexpr (kChecked) {
+      return value_buf.ReadInt(offset_pos + i * OFFSET_4_BYTE);
+    } else {
+      return value_buf.ReadIntUnchecked(offset_pos + i * OFFSET_4_BYTE);
+    }
+  }
+
+  // Offset of the byte, 0 or 1, the bool column id reads as in a bool bits
+  // value, -1 for a null column.
+  template <bool kChecked = true, typename B>
+  int ReadBoolOffset(B& value_buf, int id) const {
+    int start = 0;
+    int end = bool_cnt - 1;
+    while (start <= end) {
+      int mid = start + (end - start) / 2;
+      int cur_id = id_unit == ID_1_BYTE
+                       ? ReadByteAt<kChecked>(value_buf, bool_ids_pos + mid)
+                       : ReadShortAt<kChecked>(value_buf,
+                                               bool_ids_pos + mid * ID_2_BYTE);
+      if (cur_id == id) {
+        uint8_t bits = ReadByteAt<kChecked>(value_buf, bool_bits_pos + mid / 8);
+        return truth_pos + ((bits >> (mid % 8)) & 1);
+      }
+      if (cur_id < id) {
+        start = mid + 1;
+      } else {
+        end = mid - 1;
+      }
+    }
+    return -1;
+  }
+
+  // The tables, and the bitmap or bool section, lie within the size bytes of
+  // the value.
+  bool InRange(size_t size) const {
+    return ids_pos >= 0 && offset_pos >= ids_pos && data_pos >= offset_pos &&
+           bool_cnt >= 0 && null_bitmap_pos <= data_pos &&
+           static_cast<size_t>(data_pos) <= size;
+  }
+
+ private:
+  template <bool kChecked, typename B>
+  static uint8_t ReadByteAt(B& value_buf, size_t pos) {
+    if constexpr (kChecked) {
+      return value_buf.Read(pos);
+    } else {
+      return value_buf.ReadUnchecked(pos);
+    }
+  }
+  template <bool kChecked, typename B>
+  static int16_t ReadShortAt(B& value_buf, int pos) {
+    if constexpr (kChecked) {
+      return value_buf.ReadShort(pos);
+    } else {
+      return value_buf.ReadShortUnchecked(pos);
+    }
+  }
+};
+
+// A not null column of a plain value, its data spanning [offset, end), and
+// new_offset for a writer of the column into another value.
+struct ValueSpan {
+  int id;
+  int offset;
+  int end;
+  int new_offset;
+};
+
+// The not null columns of value by offset, and its schema version, for the
+// byte level rewriters of values. Returns -1 for a value too short for its
+// tables, compressed, with static offsets, bool bits, a checksum or layout
+// flags unknown to this build, whose column bytes are not all found from the
+// tables alone.
+inline int ReadValueSpans(std::string_view value, bool le, int32_t& version,
+                          std::vector<ValueSpan>& spans) {
+  spans.clear();
+  if (value.size() < 8) {
+    return -1;
+  }
+  BufView value_buf(value, le);
+  version = value_buf.ReadInt();
+  int format = GetValueFormat(version);
+  if ((format & ~kValueFormatKnownFlags) != 0 ||
+      (format & (VALUE_FORMAT_COMPRESSED | VALUE_FORMAT_STATIC_OFFSETS |
+                 VALUE_FORMAT_BOOL_BITS | VALUE_FORMAT_CHECKSUM))) {
+    return -1;
+  }
+  ValueHeader header(value_buf, format);
+  if (!header.InRange(value.size())) {
+    return -1;
+  }
+
+  for (int i = 0; i < header.entry_cnt; ++i) {
+    int offset = header.ReadOffset(value_buf, i);
+    if (offset == -1) {
+      continue;
+    }
+    if (offset < header.data_pos ||
+        static_cast<size_t>(offset) > value.size()) {
+      return -1;
+    }
+    spans.push_back({header.ReadId(value_buf, i), offset, 0, 0});
+  }
+
+  // the data of a column runs to the next one, the last to the value end.
+  std::sort(spans.begin(), spans.end(),
+            [](const ValueSpan& lhs, const ValueSpan& rhs) {
+              return lhs.offset < rhs.offset;
+            });
+  for (size_t i = 0; i < spans.size(); ++i) {
+    spans[i].end = i + 1 < spans.size() ? spans[i + 1].offset : value.size();
   }
+  return 0;
+}
+
+// The tables of a plain value of count not null columns and data_size bytes
+// of data, null columns left out: ids of one byte when all are below 255,
+// offsets of two when the whole value fits them.
+struct PlainValueTables {
+  int id_unit;
+  int offset_unit;
+  size_t data_pos;
+  // the compact flags of the units.
+  int format;
 };
 
+inline PlainValueTables PlanPlainValueTables(size_t count, bool compact_ids,
+                                             size_t data_size) {
+  PlainValueTables tables{compact_ids ? ID_1_BYTE : ID_2_BYTE, OFFSET_2_BYTE,
+                          0, 0};
+  tables.data_pos = 8 + count * (tables.id_unit + tables.offset_unit);
+  if (tables.data_pos + data_size >= kCompactOffsetNull) {
+    tables.offset_unit = OFFSET_4_BYTE;
+    tables.data_pos = 8 + count * (tables.id_unit + tables.offset_unit);
+  }
+  if (compact_ids) {
+    tables.format |= VALUE_FORMAT_COMPACT_ID;
+  }
+  if (tables.offset_unit == OFFSET_2_BYTE) {
+    tables.format |= VALUE_FORMAT_COMPACT_OFFSET;
+  }
+  return tables;
+}
+
+// Write the ids and new offsets of spans, sorted by id, to their tables in
+// buf, which already spans them.
+inline void WritePlainValueTables(Buf& buf, const PlainValueTables& tables,
+                                  const std::vector<ValueSpan>& spans) {
+  size_t ids_pos = 8;
+  size_t offset_pos = ids_pos + spans.size() * tables.id_unit;
+  for (size_t i = 0; i < spans.size(); ++i) {
+    if (tables.id_unit == ID_1_BYTE) {
+      buf.WriteByte(ids_pos + i, spans[i].id);
+    } else {
+      buf.WriteShort(ids_pos + i * ID_2_BYTE, spans[i].id);
+    }
+    if (tables.offset_unit == OFFSET_2_BYTE) {
+      buf.WriteShort(offset_pos + i * OFFSET_2_BYTE, spans[i].new_offset);
+    } else {
+      buf.WriteInt(offset_pos + i * OFFSET_4_BYTE, spans[i].new_offset);
+    }
+  }
+}
+
+// Whether the checksum trailer of value matches its bytes: 1 when it does,
+// 0 for a value without one, -1 for a value too short for its trailer or
+// whose trailer differs. Nothing else of the value is checked.
+inline int VerifyValueChecksum(std::string_view value, bool le) {
+  if (value.size() < 4) {
+    return 0;
+  }
+  BufView value_buf(value, le);
+  if (!(GetValueFormat(value_buf.ReadInt(0)) & VALUE_FORMAT_CHECKSUM)) {
+    return 0;
+  }
+  if (value.size() < 4 + kValueChecksumSize) {
+    return -1;
+  }
+  size_t size = value.size() - kValueChecksumSize;
+  uint32_t crc = static_cast<uint32_t>(value_buf.ReadInt(size));
+  return Crc32c(value.data(), size) == crc ? 1 : -1;
+}
+
+// Whether value has a checksum trailer, which the byte level rewriters of
+// values do not take: compressed or not, their output would drop it.
+inline bool HasValueChecksum(std::string_view value, bool le) {
+  return value.size() >= 4 &&
+         (GetValueFormat(BufView(value, le).ReadInt(0)) &
+          VALUE_FORMAT_CHECKSUM) != 0;
+}
+
+// Point value before its checksum trailer, not verified, and a compressed
+// value at its decompressed form written to scratch, the version keeps the
+// flags of the raw value. False when the compression type is unknown to this
+// build, throws when the value is corrupt. Call once per value, the flag of
+// the trailer stays on a value not compressed.
+inline bool InflateValue(std::string_view& value, std::string& scratch,
+                         bool le) {
+  if (value.size() < 4) {
+    return true;
+  }
+  BufView value_buf(value, le);
+  int32_t version = value_buf.ReadInt(0);
+  int format = GetValueFormat(version);
+  if (format & VALUE_FORMAT_CHECKSUM) {
+    if (DINGO_UNLIKELY(value.size() < 4 + kValueChecksumSize)) {
+      throw std::runtime_error("Out of range.");
+    }
+    value.remove_suffix(kValueChecksumSize);
+  }
+  if (!(format & VALUE_FORMAT_COMPRESSED)) {
+    return true;
+  }
+
+  if (DINGO_UNLIKELY(value.size() < kCompressedHeaderSize)) {
+    throw std::runtime_error("Out of range.");
+  }
+  // like an unknown flag, a type this build lacks rejects the value.
+  auto type = static_cast<CompressionType>(value_buf.Read(4));
+  if (!IsCompressionSupported(type)) {
+    return false;
+  }
+  uint32_t raw_size = value_buf.ReadInt(5);
+
+  scratch.resize(4 + static_cast<size_t>(raw_size));
+  Buf version_buf(4, le);
+  version_buf.WriteInt(SetValueFormat(
+      version, format & ~(VALUE_FORMAT_COMPRESSED | VALUE_FORMAT_CHECKSUM)));
+  memcpy(scratch.data(), version_buf.Data(), 4);
+  if (DINGO_UNLIKELY(!Decompress(type, value.data() + kCompressedHeaderSize,
+                                 value.size() - kCompressedHeaderSize,
+                                 scratch.data() + 4, raw_size))) {
+    throw std::runtime_error("Decompress value failed.");
+  }
+  value = scratch;
+  return true;
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
 
@@ -0,0 +1,130 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/value_rewriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "serial/record/V2/common.h"
+#include "serial/record/V2/value_header.h"
+#include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/utils.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+ValueRewriter::ValueRewriter(std::vector<int> id_map)
+    : ValueRewriter(std::move(id_map), IsLE()) {}
+
+ValueRewriter::ValueRewriter(std::vector<int> id_map, bool le)
+    : id_map_(std::move(id_map)), le_(le) {
+  std::vector<int> new_ids;
+  for (int id : id_map_) {
+    if (id == kDrop) {
+      continue;
+    }
+    if (id < 0 || id > 0x7FFF) {
+      throw std::runtime_error("Rewrite column id out of range.");
+    }
+    new_ids.push_back(id);
+  }
+  std::sort(new_ids.begin(), new_ids.end());
+  if (std::adjacent_find(new_ids.begin(), new_ids.end()) != new_ids.end()) {
+    throw std::runtime_error("Rewrite column ids collide.");
+  }
+}
+
+int ValueRewriter::Affects(std::string_view value) const {
+  thread_local std::vector<ValueSpan> spans;
+  int32_t version;
+  if (ReadValueSpans(value, le_, version, spans) < 0) {
+    return -1;
+  }
+  return std::any_of(spans.begin(), spans.end(),
+                     [this](const ValueSpan& span) {
+                       return NewId(span.id) != span.id;
+                     })
+             ? 1
+             : 0;
+}
+
+int ValueRewriter::Rewrite(std::string_view value, std::string& output) const {
+  thread_local std::vector<ValueSpan> spans;
+  int32_t version;
+  if (ReadValueSpans(value, le_, version, spans) < 0) {
+    return -1;
+  }
+
+  // the kept columns, their data in the order it had.
+  size_t data_size = 0;
+  bool compact_ids = true;
+  size_t kept = 0;
+  for (const auto& span : spans) {
+    int id = NewId(span.id);
+    if (id == kDrop) {
+      continue;
+    }
+    spans[kept++] = {id, span.offset, span.end, 0};
+    data_size += span.end - span.offset;
+    compact_ids = compact_ids && id < 255;
+  }
+  spans.resize(kept);
+
+  PlainValueTables tables = PlanPlainValueTables(kept, compact_ids, data_size);
+  int format =
+      (GetValueFormat(version) & kValueDataFormatFlags) | tables.format;
+  int schema_version =
+      schema_version_ >= 0 ? schema_version_ : (version & kSchemaVersionMask);
+
+  Buf buf(std::move(output), le_);
+  buf.Clear();
+  buf.Reserve(tables.data_pos + data_size);
+  buf.WriteInt(SetValueFormat(schema_version, format));
+  buf.WriteShort(kept);
+  buf.WriteShort(0);
+  buf.Enlarge(tables.data_pos - 8);
+
+  // the tables go by id, the data by its old offset.
+  int offset = tables.data_pos;
+  for (auto& span : spans) {
+    int length = span.end - span.offset;
+    buf.Enlarge(length);
+    memcpy(buf.Data() + offset, value.data() + span.offset, length);
+    span.new_offset = offset;
+    offset += length;
+  }
+  std::sort(spans.begin(), spans.end(),
+            [](const ValueSpan& lhs, const ValueSpan& rhs) {
+              return lhs.id < rhs.id;
+            });
+  // a column moved past id_map onto one that kept its id there.
+  for (size_t i = 1; i < kept; ++i) {
+    if (DINGO_UNLIKELY(spans[i].id == spans[i - 1].id)) {
+      output.clear();
+      return -1;
+    }
+  }
+  WritePlainValueTables(buf, tables, spans);
+
+  buf.GetString(output);
+  return output.size();
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
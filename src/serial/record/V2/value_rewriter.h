@@ -0,0 +1,79 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_VALUE_REWRITER_V2_H_
+#define DINGO_SERIAL_VALUE_REWRITER_V2_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Drops and renumbers value columns of encoded values in their bytes, so
+ * that a compaction filter can reclaim the space of a dropped column from
+ * the values it sees without a decode and encode of the table.
+ *
+ * id_map[id] is the new id of value column id, kDrop to drop it, the columns
+ * past its end keep their ids. The data of the kept columns is copied as it
+ * is behind a new id and offset table: the null columns are left out of it,
+ * as a decoder reads an absent column as null, and the ids and offsets take
+ * one and two bytes when they fit. The key is not touched, nor are the data
+ * format flags, which only tell how a column's bytes read.
+ *
+ * Values compressed, with static offsets, bool bits or a checksum, whose
+ * column bytes are not all found from the tables alone, are left to a full
+ * rewrite.
+ */
+class ValueRewriter {
+ public:
+  static constexpr int kDrop = -1;
+
+  // Throws runtime_error when two columns of id_map map to the same id or a
+  // new id does not fit the 2 bytes of an id.
+  explicit ValueRewriter(std::vector<int> id_map);
+  ValueRewriter(std::vector<int> id_map, bool le);
+
+  // The schema version of the output, once the change is a new version of
+  // the table, instead of the one of each value.
+  void SetSchemaVersion(int schema_version) { schema_version_ = schema_version; }
+
+  // Write the rewritten value to output, which must not hold the bytes of
+  // value. Returns the bytes written, or -1 for a value too short for its
+  // tables, compressed, with static offsets, bool bits, a checksum or layout
+  // flags unknown to this build, or one holding a column past id_map at the
+  // new id of another.
+  int Rewrite(std::string_view value, std::string& output /*output*/) const;
+
+  // Whether Rewrite changes value: it holds a dropped or renumbered column
+  // that is not null. -1 as Rewrite for the values it does not take.
+  int Affects(std::string_view value) const;
+
+ private:
+  int NewId(int id) const {
+    return id >= 0 && static_cast<size_t>(id) < id_map_.size() ? id_map_[id]
+                                                                : id;
+  }
+
+  std::vector<int> id_map_;
+  bool le_;
+  int schema_version_{-1};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
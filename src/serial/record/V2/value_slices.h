@@ -0,0 +1,111 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_VALUE_SLICES_V2_H_
+#define DINGO_SERIAL_VALUE_SLICES_V2_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+class RecordEncoderV2;
+
+// A value encoded as the slices that make it up back to back, for a storage
+// layer taking a value as an iovec or rope (e.g. RocksDB SliceParts). The
+// strings of at least Threshold() bytes of the string and string list value
+// columns are not copied: their slice points into the record, the rest is
+// encoded into a scratch of this object sized exactly once. The slices are
+// valid until the next encode into this object and while the record's
+// strings are left alone. Compressed values are one slice of scratch.
+class ValueSlices {
+ public:
+  static constexpr size_t kDefaultThreshold = 4096;
+
+  explicit ValueSlices(size_t threshold = kDefaultThreshold)
+      : threshold_(threshold) {}
+
+  size_t Threshold() const { return threshold_; }
+
+  size_t SliceCount() const { return slices_.size(); }
+  std::string_view Slice(size_t i) const { return slices_[i]; }
+  const std::vector<std::string_view>& Slices() const { return slices_; }
+
+  // bytes of the value, and those referenced from the record.
+  size_t Size() const { return scratch_.size() + external_; }
+  size_t ExternalSize() const { return external_; }
+
+  // The value in one piece, as EncodeValue writes it.
+  void Flatten(std::string& output) const {
+    output.clear();
+    output.reserve(Size());
+    for (const auto& slice : slices_) {
+      output.append(slice);
+    }
+  }
+
+ private:
+  friend class RecordEncoderV2;
+
+  // bytes referenced in place of the scratch bytes from pos on.
+  struct Hole {
+    size_t pos;
+    std::string_view bytes;
+  };
+
+  void Reset() {
+    holes_.clear();
+    slices_.clear();
+    external_ = 0;
+  }
+  void AddHole(size_t pos, std::string_view bytes) {
+    holes_.push_back({pos, bytes});
+    external_ += bytes.size();
+  }
+  // the scratch bytes from pos on moved back by shift.
+  void ShiftHoles(size_t pos, size_t shift) {
+    for (auto& hole : holes_) {
+      if (hole.pos >= pos) {
+        hole.pos -= shift;
+      }
+    }
+  }
+  void Finish() {
+    size_t pos = 0;
+    for (const auto& hole : holes_) {
+      if (hole.pos > pos) {
+        slices_.emplace_back(scratch_.data() + pos, hole.pos - pos);
+      }
+      slices_.push_back(hole.bytes);
+      pos = hole.pos;
+    }
+    if (scratch_.size() > pos) {
+      slices_.emplace_back(scratch_.data() + pos, scratch_.size() - pos);
+    }
+  }
+
+  size_t threshold_;
+  std::string scratch_;
+  std::vector<Hole> holes_;
+  size_t external_{0};
+  std::vector<std::string_view> slices_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/record/V2/version_key.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "serial/utils/V2/compiler.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+static void StoreTs(char* out, int64_t ts) {
+  if (DINGO_UNLIKELY(ts < 0)) {
+    throw std::runtime_error("Negative ts.");
+  }
+  uint64_t word = ~static_cast<uint64_t>(ts);
+  for (int i = kTsLength - 1; i >= 0; --i) {
+    out[i] = static_cast<char>(word & 0xFF);
+    word >>= 8;
+  }
+}
+
+int AppendTs(std::string& key, int64_t ts) {
+  char bytes[kTsLength];
+  StoreTs(bytes, ts);
+  key.append(bytes, kTsLength);
+  return kTsLength;
+}
+
+int AppendTs(Buf& buf, int64_t ts) {
+  buf.Enlarge(kTsLength);
+  StoreTs(buf.Data() + buf.Size() - kTsLength, ts);
+  return kTsLength;
+}
+
+std::string_view StripTs(std::string_view key) {
+  if (DINGO_UNLIKELY(key.size() < kTsLength)) {
+    throw std::runtime_error("Key without ts.");
+  }
+  return key.substr(0, key.size() - kTsLength);
+}
+
+int64_t DecodeTs(std::string_view key) {
+  if (DINGO_UNLIKELY(key.size() < kTsLength)) {
+    throw std::runtime_error("Key without ts.");
+  }
+  const auto* in = reinterpret_cast<const uint8_t*>(key.data() + key.size() - kTsLength);
+  uint64_t word = 0;
+  for (size_t i = 0; i < kTsLength; ++i) {
+    word = (word << 8) | in[i];
+  }
+  return static_cast<int64_t>(~word);
+}
+
+int CompareIgnoringTs(std::string_view lhs, std::string_view rhs) {
+  return StripTs(lhs).compare(StripTs(rhs));
+}
+
+std::string SeekKey(std::string_view key, int64_t ts) {
+  std::string seek;
+  seek.reserve(key.size() + kTsLength);
+  seek.append(key);
+  AppendTs(seek, ts);
+  return seek;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,59 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_VERSION_KEY_V2_H_
+#define DINGO_SERIAL_VERSION_KEY_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "serial/utils/V2/buf.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Keys of the versions of a row: the key of RecordEncoderV2::EncodeKey
+ * followed by the commit ts of the version, 8 bytes big endian inverted, so
+ * that the versions of a key sort next to each other newest first.
+ *
+ * The key before the ts is a key of the encoder again, StripTs gives it to
+ * the decoders and comparators without a copy. ts is not negative, a
+ * negative one throws runtime_error, as do keys shorter than a ts.
+ */
+constexpr size_t kTsLength = 8;
+
+// Append the ts suffix to a key, returns the appended length.
+int AppendTs(std::string& key, int64_t ts);
+int AppendTs(Buf& buf, int64_t ts);
+
+// The key without its ts suffix, and the ts.
+std::string_view StripTs(std::string_view key);
+int64_t DecodeTs(std::string_view key);
+
+// Order of the keys the versions of lhs and rhs belong to, the ts are left
+// out, < 0, 0 or > 0.
+int CompareIgnoringTs(std::string_view lhs, std::string_view rhs);
+
+// The key to seek a forward scan to for the latest version of key at or
+// before ts, key being one without ts: the first version key at or after it
+// is that version when it is one of key.
+std::string SeekKey(std::string_view key, int64_t ts);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -124,6 +124,11 @@ void DecodeOrSkip(const std::shared_ptr<BaseSchema>& schema, Buf& key_buf,
 
 int RecordDecoderV1::Decode(const std::string& key, const std::string& value,
                             std::vector<std::any>& record) {
+  return Decode(std::string_view(key), std::string_view(value), record);
+}
+
+int RecordDecoderV1::Decode(std::string_view key, std::string_view value,
+                            std::vector<std::any>& record) {
   Buf key_buf(key, this->le_);
   Buf value_buf(value, this->le_);
   if (!CheckPrefix(key_buf)) {
@@ -153,6 +158,11 @@ int RecordDecoderV1::Decode(const std::string& key, const std::string& value,
 
 int RecordDecoderV1::DecodeKey(const std::string& key,
                                std::vector<std::any>& record /*output*/) {
+  return DecodeKey(std::string_view(key), record);
+}
+
+int RecordDecoderV1::DecodeKey(std::string_view key,
+                               std::vector<std::any>& record /*output*/) {
   Buf key_buf(key, this->le_);
 
   if (!CheckPrefix(key_buf)) {
@@ -201,6 +211,13 @@ inline bool IsSkipOnly(
 int RecordDecoderV1::Decode(const std::string& key, const std::string& value,
                             const std::vector<int>& column_indexes,
                             std::vector<std::any>& record) {
+  return Decode(std::string_view(key), std::string_view(value), column_indexes,
+                record);
+}
+
+int RecordDecoderV1::Decode(std::string_view key, std::string_view value,
+                            const std::vector<int>& column_indexes,
+                            std::vector<std::any>& record) {
   Buf key_buf(key, this->le_);
   Buf value_buf(value, this->le_);
   if (!CheckPrefix(key_buf) || !CheckReverseTag(key_buf) ||
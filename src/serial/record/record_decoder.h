@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "../utils/keyvalue.h"
 #include "any"
@@ -71,11 +72,20 @@ class RecordDecoderV1 {
   int DecodeKey(const std::string& key,
                 std::vector<std::any>& record /*output*/);
 
+  // Decode key and value in place, they must outlive the call.
+  int Decode(std::string_view key, std::string_view value,
+             std::vector<std::any>& record /*output*/);
+  int DecodeKey(std::string_view key,
+                std::vector<std::any>& record /*output*/);
+
   int Decode(const KeyValue& key_value, const std::vector<int>& column_indexes,
              std::vector<std::any>& record /*output*/);
   int Decode(const std::string& key, const std::string& value,
              const std::vector<int>& column_indexes,
              std::vector<std::any>& record /*output*/);
+  int Decode(std::string_view key, std::string_view value,
+             const std::vector<int>& column_indexes,
+             std::vector<std::any>& record /*output*/);
   int GetCodecVersion(Buf& buf);
 };
 
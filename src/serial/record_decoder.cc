@@ -11,9 +11,11 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+
 #include "record_decoder.h"
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -22,6 +24,7 @@
 #include "serial/schema/V2/base_schema.h"
 #include "serial/schema/base_schema.h"
 #include "serial/utils/V2/schema_converter.h"
+#include "serial/utils/V2/utils.h"
 
 namespace dingodb {
 
@@ -29,47 +32,76 @@ namespace dingodb {
 RecordDecoder::RecordDecoder(
     int schema_version,
     std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
-    long common_id) {
-  codec_version_ = serialV2::CODEC_VERSION_V2;
-  schemas_v1_ = schemas;
-  schemas_v2_ = ConvertSchemasV2(schemas);
-  re_v1_ = new RecordDecoderV1(schema_version, schemas, common_id);
-  re_v2_ =
-      new serialV2::RecordDecoderV2(schema_version, schemas_v2_, common_id);
-}
+    long common_id)
+    : re_v2_(std::make_shared<serialV2::RecordDecoderV2>(
+          schema_version, ConvertSchemasV2(schemas), common_id)),
+      schemas_v1_(schemas),
+      le_v1_(serialV2::IsLE()) {}
 
 // constructor for v1.
 RecordDecoder::RecordDecoder(
     int schema_version,
     std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
-    long common_id, bool le) {
-  codec_version_ = serialV2::CODEC_VERSION_V2;
-  schemas_v1_ = schemas;
-  schemas_v2_ = ConvertSchemasV2(schemas);
-  re_v1_ = new RecordDecoderV1(schema_version, schemas, common_id, le);
-  re_v2_ =
-      new serialV2::RecordDecoderV2(schema_version, schemas_v2_, common_id);
-}
+    long common_id, bool le)
+    : re_v2_(std::make_shared<serialV2::RecordDecoderV2>(
+          schema_version, ConvertSchemasV2(schemas), common_id)),
+      schemas_v1_(schemas),
+      le_v1_(le) {}
 
 // constructor for v2.
 RecordDecoder::RecordDecoder(
     int schema_version, const std::vector<serialV2::BaseSchemaPtr>& schemas,
-    long common_id) {
-  codec_version_ = serialV2::CODEC_VERSION_V2;
-  schemas_v1_ = ConvertSchemasV1(schemas);
-  re_v1_ = new RecordDecoderV1(schema_version, schemas_v1_, common_id);
-  re_v2_ = new serialV2::RecordDecoderV2(schema_version, schemas, common_id);
-}
+    long common_id)
+    : re_v2_(std::make_shared<serialV2::RecordDecoderV2>(schema_version,
+                                                         schemas, common_id)),
+      le_v1_(serialV2::IsLE()) {}
 
 // constructor for v2.
 RecordDecoder::RecordDecoder(
     int schema_version, const std::vector<serialV2::BaseSchemaPtr>& schemas,
-    long common_id, bool le) {
-  codec_version_ = serialV2::CODEC_VERSION_V2;
-  schemas_v1_ = ConvertSchemasV1(schemas);
-  re_v1_ = new RecordDecoderV1(schema_version, schemas_v1_, common_id, le);
-  re_v2_ =
-      new serialV2::RecordDecoderV2(schema_version, schemas, common_id, le);
+    long common_id, bool le)
+    : re_v2_(std::make_shared<serialV2::RecordDecoderV2>(
+          schema_version, schemas, common_id, le)),
+      le_v1_(le) {}
+
+// constructor from both forms.
+RecordDecoder::RecordDecoder(int schema_version,
+                             const DualSchemasPtr& schemas, long common_id)
+    : re_v2_(std::make_shared<serialV2::RecordDecoderV2>(
+          schema_version, schemas->v2, common_id)),
+      schemas_v1_(schemas->v1),
+      le_v1_(serialV2::IsLE()) {}
+
+// constructor from both forms.
+RecordDecoder::RecordDecoder(int schema_version,
+                             const DualSchemasPtr& schemas, long common_id,
+                             bool le)
+    : re_v2_(std::make_shared<serialV2::RecordDecoderV2>(
+          schema_version, schemas->v2, common_id, le)),
+      schemas_v1_(schemas->v1),
+      le_v1_(le) {}
+
+RecordDecoder::RecordDecoder(serialV2::RecordDecoderPtr decoder)
+    : re_v2_(std::move(decoder)), le_v1_(re_v2_->IsLe()) {}
+
+RecordDecoderV1* RecordDecoder::V1() const {
+  std::call_once(v1_once_, [this]() {
+    if (schemas_v1_ == nullptr) {
+      schemas_v1_ = ConvertSchemasV1(re_v2_->GetSchemas());
+    }
+    re_v1_ = std::make_unique<RecordDecoderV1>(
+        re_v2_->GetSchemaVersion(), schemas_v1_, re_v2_->GetCommonId(),
+        le_v1_);
+  });
+  return re_v1_.get();
+}
+
+size_t RecordDecoder::MemoryUsage() const {
+  size_t size = sizeof(*this) + re_v2_->MemoryUsage();
+  if (re_v1_ != nullptr) {
+    size += sizeof(RecordDecoderV1);
+  }
+  return size;
 }
 
 }  // namespace dingodb
@@ -16,12 +16,15 @@
 #define DINGO_RECORD_DECODER_WRAPPER_H_
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
 #include "serial/record/V2/record_decoder.h"
 #include "serial/record/record_decoder.h"
 #include "serial/schema/base_schema.h"
+#include "serial/utils/V2/probes.h"
+#include "serial/utils/V2/schema_converter.h"
 #include "utils/V2/keyvalue.h"
 #include "utils/keyvalue.h"
 
@@ -29,13 +32,27 @@ namespace dingodb {
 
 class RecordDecoder {
  private:
-  int codec_version_;
-  std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>
+  int codec_version_{serialV2::CODEC_VERSION_V2};
+
+  std::shared_ptr<dingodb::serialV2::RecordDecoderV2> re_v2_;
+  // built at the first V1 row, most tables have none left.
+  mutable std::unique_ptr<dingodb::RecordDecoderV1> re_v1_;
+  mutable std::once_flag v1_once_;
+  // what re_v1_ is built with: the V1 schemas when given, otherwise
+  // converted from those of re_v2_ then, and its byte order.
+  mutable std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>
       schemas_v1_;
-  std::vector<serialV2::BaseSchemaPtr> schemas_v2_;
+  bool le_v1_;
+  serialV2::CodecStats* stats_{nullptr};
 
-  dingodb::RecordDecoderV1* re_v1_;
-  dingodb::serialV2::RecordDecoderV2* re_v2_;
+  dingodb::RecordDecoderV1* V1() const;
+
+  // a row of the V1 codec decoded in place of the V2 one.
+  void OnV1Fallback(size_t key_size, size_t value_size) {
+    DINGO_SERIAL_PROBE4(v1_fallback, re_v2_->GetCommonId(),
+                        re_v2_->GetSchemaVersion(), key_size, value_size);
+    DINGO_CODEC_STATS(stats_, AddV1Fallback());
+  }
 
   // converter from v2 schemas to v1 schemas.
   // std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>
@@ -61,33 +78,48 @@ class RecordDecoder {
                 const std::vector<serialV2::BaseSchemaPtr>& schemas,
                 long common_id, bool le);
 
-  ~RecordDecoder() {
-    delete re_v1_;
-    delete re_v2_;
+  // constructors from both forms converted before, see SchemaConversionCache.
+  RecordDecoder(int schema_version, const DualSchemasPtr& schemas,
+                long common_id);
+  RecordDecoder(int schema_version, const DualSchemasPtr& schemas,
+                long common_id, bool le);
+
+  // over a V2 decoder shared with other wrappers, e.g. the one of a
+  // DecoderRegistry for every region of a table; SetStats sets its stats.
+  explicit RecordDecoder(serialV2::RecordDecoderPtr decoder);
+
+  RecordDecoder(const RecordDecoder&) = delete;
+  RecordDecoder& operator=(const RecordDecoder&) = delete;
+
+  // Bytes the wrapper holds with its decoders, a shared V2 one counted whole;
+  // the schemas are not counted. Not while another thread decodes.
+  size_t MemoryUsage() const;
+
+  // Count the V2 decodes and the V1 rows decoded in their place in stats.
+  void SetStats(serialV2::CodecStats* stats) {
+    stats_ = stats;
+    re_v2_->SetStats(stats);
   }
 
   void Init(int schema_version,
             std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
             long common_id) {
-    re_v1_->Init(schema_version, schemas, common_id);
+    V1()->Init(schema_version, schemas, common_id);
   }
 
   // decode for v1.
   int Decode(const KeyValue& key_value, std::vector<std::any>& record) {
-    return re_v1_->Decode(key_value, record);
+    return V1()->Decode(key_value, record);
   }
 
   // decode for v2.
   int Decode(const serialV2::KeyValue& key_value,
              std::vector<std::any>& record) {
     if (DINGO_UNLIKELY(key_value.GetVersion() == serialV2::CODEC_VERSION_V1)) {
-      // This code branch is inefficient, but factly the code will not run here
-      // except the scenario that we are running the new verison(v2) on old
-      // data(v1), so we just keep the code like this.
-      auto key_value_v1 =
-          KeyValue(std::make_shared<std::string>(key_value.GetKey()),
-                   std::make_shared<std::string>(key_value.GetValue()));
-      return re_v1_->Decode(key_value_v1, record);
+      // old data(v1) read by the new version(v2), decoded in place.
+      OnV1Fallback(key_value.GetKey().size(), key_value.GetValue().size());
+      return V1()->Decode(std::string_view(key_value.GetKey()),
+                            std::string_view(key_value.GetValue()), record);
     } else {
       return re_v2_->Decode(key_value, record);
     }
@@ -106,7 +138,8 @@ class RecordDecoder {
     const char* p = key.data();
     char a = key.at(key_len - 1);
     if (key.at(key.size() - 1) == dingodb::serialV2::CODEC_VERSION_V1) {
-      return re_v1_->Decode(key, value, record);
+      OnV1Fallback(key.size(), value.size());
+      return V1()->Decode(key, value, record);
     } else {
       return re_v2_->Decode(key, value, record);
     }
@@ -121,7 +154,8 @@ class RecordDecoder {
 
   int DecodeKey(const std::string& key, std::vector<std::any>& record) {
     if (key.at(key.size() - 1) == dingodb::serialV2::CODEC_VERSION_V1) {
-      return re_v1_->DecodeKey(key, record);
+      OnV1Fallback(key.size(), 0);
+      return V1()->DecodeKey(key, record);
     } else {
       return re_v2_->DecodeKey(key, record);
     }
@@ -137,7 +171,7 @@ class RecordDecoder {
   // decode for v1.
   int Decode(const KeyValue& key_value, const std::vector<int>& column_indexes,
              std::vector<std::any>& record) {
-    return re_v1_->Decode(key_value, column_indexes, record);
+    return V1()->Decode(key_value, column_indexes, record);
   }
 
   // decode for v2.
@@ -152,7 +186,8 @@ class RecordDecoder {
              std::unordered_map<int, int>& column_indexes_serial,
              std::vector<std::any>& record) {
     if (key.at(key.size() - 1) == dingodb::serialV2::CODEC_VERSION_V1) {
-      return re_v1_->Decode(key, value, column_indexes, record);
+      OnV1Fallback(key.size(), value.size());
+      return V1()->Decode(key, value, column_indexes, record);
     } else {
       return re_v2_->Decode(key, value, column_indexes_serial, record);
     }
@@ -11,68 +11,96 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+
 #include "record_encoder.h"
 
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "serial/record/V2/common.h"
 #include "serial/record/V2/record_encoder.h"
 #include "serial/record/record_encoder.h"
 #include "serial/utils/V2/schema_converter.h"
+#include "serial/utils/V2/utils.h"
 
 namespace dingodb {
 
 RecordEncoder::RecordEncoder(
     int schema_version,
     std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
-    long common_id) {
-  this->codec_version_ = serialV2::CODEC_VERSION_V2;
-  schemas_v1_ = schemas;
-  schemas_v2_ = ConvertSchemasV2(schemas);
-  this->re_v1_ = new RecordEncoderV1(schema_version, schemas, common_id);
-  this->re_v2_ =
-      new serialV2::RecordEncoderV2(schema_version, schemas_v2_, common_id);
-}
+    long common_id)
+    : re_v2_(std::make_shared<serialV2::RecordEncoderV2>(
+          schema_version, ConvertSchemasV2(schemas), common_id)),
+      schemas_v1_(schemas),
+      le_v1_(serialV2::IsLE()) {}
 
 RecordEncoder::RecordEncoder(
     int schema_version,
     std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
-    long common_id, bool le) {
-  this->codec_version_ = serialV2::CODEC_VERSION_V2;
-  schemas_v1_ = schemas;
-  schemas_v2_ = ConvertSchemasV2(schemas);
-  this->re_v1_ = new RecordEncoderV1(schema_version, schemas, common_id, le);
-  this->re_v2_ =
-      new serialV2::RecordEncoderV2(schema_version, schemas_v2_, common_id, le);
-}
+    long common_id, bool le)
+    : re_v2_(std::make_shared<serialV2::RecordEncoderV2>(
+          schema_version, ConvertSchemasV2(schemas), common_id, le)),
+      schemas_v1_(schemas),
+      le_v1_(le) {}
 
 RecordEncoder::RecordEncoder(
     int schema_version, const std::vector<serialV2::BaseSchemaPtr>& schemas,
-    long common_id) {
-  this->codec_version_ = serialV2::CODEC_VERSION_V2;
-  this->schemas_v1_ = ConvertSchemasV1(schemas);
-  this->schemas_v2_ = schemas;
-  this->re_v1_ = new RecordEncoderV1(schema_version, schemas_v1_, common_id);
-  this->re_v2_ =
-      new serialV2::RecordEncoderV2(schema_version, schemas, common_id);
-}
+    long common_id)
+    : re_v2_(std::make_shared<serialV2::RecordEncoderV2>(schema_version,
+                                                         schemas, common_id)),
+      le_v1_(serialV2::IsLE()) {}
+
 RecordEncoder::RecordEncoder(
     int schema_version, const std::vector<serialV2::BaseSchemaPtr>& schemas,
-    long common_id, bool le) {
-  this->codec_version_ = serialV2::CODEC_VERSION_V2;
-  this->schemas_v1_ = ConvertSchemasV1(schemas);
-  this->schemas_v2_ = schemas;
-  this->re_v1_ =
-      new RecordEncoderV1(schema_version, schemas_v1_, common_id, le);
-  this->re_v2_ =
-      new serialV2::RecordEncoderV2(schema_version, schemas, common_id, le);
+    long common_id, bool le)
+    : re_v2_(std::make_shared<serialV2::RecordEncoderV2>(
+          schema_version, schemas, common_id, le)),
+      le_v1_(le) {}
+
+RecordEncoder::RecordEncoder(int schema_version,
+                             const DualSchemasPtr& schemas, long common_id)
+    : re_v2_(std::make_shared<serialV2::RecordEncoderV2>(
+          schema_version, schemas->v2, common_id)),
+      schemas_v1_(schemas->v1),
+      le_v1_(serialV2::IsLE()) {}
+
+RecordEncoder::RecordEncoder(int schema_version,
+                             const DualSchemasPtr& schemas, long common_id,
+                             bool le)
+    : re_v2_(std::make_shared<serialV2::RecordEncoderV2>(
+          schema_version, schemas->v2, common_id, le)),
+      schemas_v1_(schemas->v1),
+      le_v1_(le) {}
+
+RecordEncoder::RecordEncoder(serialV2::RecordEncoderPtr encoder)
+    : re_v2_(std::move(encoder)), le_v1_(re_v2_->IsLe()) {}
+
+RecordEncoderV1* RecordEncoder::V1() const {
+  std::call_once(v1_once_, [this]() {
+    if (schemas_v1_ == nullptr) {
+      schemas_v1_ = ConvertSchemasV1(re_v2_->GetSchemas());
+    }
+    re_v1_ = std::make_unique<RecordEncoderV1>(
+        re_v2_->GetSchemaVersion(), schemas_v1_, re_v2_->GetCommonId(),
+        le_v1_);
+  });
+  return re_v1_.get();
+}
+
+size_t RecordEncoder::MemoryUsage() const {
+  size_t size = sizeof(*this) + re_v2_->MemoryUsage();
+  if (re_v1_ != nullptr) {
+    size += sizeof(RecordEncoderV1);
+  }
+  return size;
 }
 
 inline void RecordEncoder::Init(
     int schema_version,
     std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
     long common_id) {
-  re_v1_->Init(schema_version, schemas, common_id);
+  V1()->Init(schema_version, schemas, common_id);
 }
 
 }  // namespace dingodb
@@ -17,6 +17,7 @@
 
 #include <any>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -30,13 +31,19 @@ namespace dingodb {
 
 class RecordEncoder {
  private:
-  int codec_version_;
-  std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>
+  int codec_version_{serialV2::CODEC_VERSION_V2};
+
+  std::shared_ptr<dingodb::serialV2::RecordEncoderV2> re_v2_;
+  // built at the first use of the V1 codec, see SetCodecVersion.
+  mutable std::unique_ptr<dingodb::RecordEncoderV1> re_v1_;
+  mutable std::once_flag v1_once_;
+  // what re_v1_ is built with: the V1 schemas when given, otherwise
+  // converted from those of re_v2_ then, and its byte order.
+  mutable std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>
       schemas_v1_;
-  std::vector<serialV2::BaseSchemaPtr> schemas_v2_;
+  bool le_v1_;
 
-  dingodb::RecordEncoderV1* re_v1_;
-  dingodb::serialV2::RecordEncoderV2* re_v2_;
+  dingodb::RecordEncoderV1* V1() const;
 
  public:
   // constructors for version 1.
@@ -57,10 +64,22 @@ class RecordEncoder {
                 const std::vector<serialV2::BaseSchemaPtr>& schemas,
                 long common_id, bool le);
 
-  ~RecordEncoder() {
-    delete re_v1_;
-    delete re_v2_;
-  }
+  // constructors from both forms converted before, see SchemaConversionCache.
+  RecordEncoder(int schema_version, const DualSchemasPtr& schemas,
+                long common_id);
+  RecordEncoder(int schema_version, const DualSchemasPtr& schemas,
+                long common_id, bool le);
+
+  // over a V2 encoder shared with other wrappers, e.g. one per table
+  // version for all its regions.
+  explicit RecordEncoder(serialV2::RecordEncoderPtr encoder);
+
+  RecordEncoder(const RecordEncoder&) = delete;
+  RecordEncoder& operator=(const RecordEncoder&) = delete;
+
+  // Bytes the wrapper holds with its encoders, a shared V2 one counted whole;
+  // the schemas are not counted. Not while another thread encodes.
+  size_t MemoryUsage() const;
 
   void SetCodecVersion(int v) { this->codec_version_ = v; }
 
@@ -73,7 +92,7 @@ class RecordEncoder {
   int Encode(char prefix, const std::vector<std::any>& record, std::string& key,
              std::string& value) {
     if (DINGO_UNLIKELY(codec_version_ == serialV2::CODEC_VERSION_V1)) {
-      return re_v1_->Encode(prefix, record, key, value);
+      return V1()->Encode(prefix, record, key, value);
     } else {
       return re_v2_->Encode(prefix, record, key, value);
     }
@@ -82,7 +101,7 @@ class RecordEncoder {
   int EncodeKey(char prefix, const std::vector<std::any>& record,
                 std::string& output) {
     if (DINGO_UNLIKELY(codec_version_ == serialV2::CODEC_VERSION_V1)) {
-      return re_v1_->EncodeKey(prefix, record, output);
+      return V1()->EncodeKey(prefix, record, output);
     } else {
       return re_v2_->EncodeKey(prefix, record, output);
     }
@@ -90,7 +109,7 @@ class RecordEncoder {
 
   int EncodeValue(const std::vector<std::any>& record, std::string& output) {
     if (DINGO_UNLIKELY(codec_version_ == serialV2::CODEC_VERSION_V1)) {
-      return re_v1_->EncodeValue(record, output);
+      return V1()->EncodeValue(record, output);
     } else {
       return re_v2_->EncodeValue(record, output);
     }
@@ -99,24 +118,24 @@ class RecordEncoder {
   int EncodeKeyPrefix(char prefix, const std::vector<std::any>& record,
                       int column_count, std::string& output) {
     if (DINGO_UNLIKELY(codec_version_ == serialV2::CODEC_VERSION_V1)) {
-      return re_v1_->EncodeKeyPrefix(prefix, record, column_count, output);
+      return V1()->EncodeKeyPrefix(prefix, record, column_count, output);
     } else {
-      throw std::runtime_error("Unsupport function EncodeKeyPrefix.");
+      return re_v2_->EncodeKeyPrefix(prefix, record, column_count, output);
     }
   }
 
   int EncodeKeyPrefix(char prefix, const std::vector<std::string>& keys,
                       std::string& output) {
     if (DINGO_UNLIKELY(codec_version_ == serialV2::CODEC_VERSION_V1)) {
-      return re_v1_->EncodeKeyPrefix(prefix, keys, output);
+      return V1()->EncodeKeyPrefix(prefix, keys, output);
     } else {
-      throw std::runtime_error("Unsupport function EncodeKeyPrefix.");
+      return re_v2_->EncodeKeyPrefix(prefix, keys, output);
     }
   }
 
   int EncodeMaxKeyPrefix(char prefix, std::string& output) const {
     if (DINGO_UNLIKELY(codec_version_ == serialV2::CODEC_VERSION_V1)) {
-      return re_v1_->EncodeMaxKeyPrefix(prefix, output);
+      return V1()->EncodeMaxKeyPrefix(prefix, output);
     } else {
       return re_v2_->EncodeMaxKeyPrefix(prefix, output);
     }
@@ -124,7 +143,7 @@ class RecordEncoder {
 
   int EncodeMinKeyPrefix(char prefix, std::string& output) const {
     if (DINGO_UNLIKELY(codec_version_ == serialV2::CODEC_VERSION_V1)) {
-      return re_v1_->EncodeMaxKeyPrefix(prefix, output);
+      return V1()->EncodeMaxKeyPrefix(prefix, output);
     } else {
       return re_v2_->EncodeMaxKeyPrefix(prefix, output);
     }
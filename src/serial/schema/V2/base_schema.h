@@ -18,10 +18,14 @@
 #include <any>
 #include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
+#include "serial/schema/V2/row_sink.h"
+#include "serial/schema/V2/column_value.h"
 #include "serial/schema/dingo_schema.h"
 #include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -99,26 +103,111 @@ class BaseSchema {
   void SetAllowNull(bool allow_null) { allow_null_ = allow_null; }
   bool isNull(const std::any& data) { return data.has_value() ? false : true; }
 
+  // A descending key column is written as every byte of its ascending form
+  // inverted, null flag included, so that it sorts the other way round and a
+  // descending scan is a forward one. Writer and reader schemas must agree.
+  void SetDescending(bool descending) { descending_ = descending; }
+  bool IsDescending() const { return descending_; }
+
+  // The column group of a value column, see RecordEncoderV2::
+  // EncodeColumnGroups, 0 to kMaxColumnGroups - 1. Key columns are in none.
+  void SetColumnGroup(int group) { column_group_ = group; }
+  int GetColumnGroup() const { return column_group_; }
+
+  // How often a value column is read relative to the others, higher is
+  // hotter. The static offsets layout puts hotter columns first within each
+  // width class, see ValueLayoutBefore. Writer and reader schemas should agree,
+  // only the fast path of a decoder is lost when they do not.
+  void SetAccessFrequency(int frequency) { access_frequency_ = frequency; }
+  int GetAccessFrequency() const { return access_frequency_; }
+
   virtual int SkipKey(Buf& buf) = 0;
   virtual int SkipValue(Buf& buf) = 0;
 
   virtual int EncodeKey(const std::any& data, Buf& buf) = 0;
   virtual int EncodeValue(const std::any& data, Buf& buf) = 0;
 
+  // Bytes EncodeKey / EncodeValue write for data, worked out without
+  // encoding it. Schemas whose length depends on the data override them.
+  virtual int GetEncodedKeyLength(const std::any& /*data*/) {
+    return GetLengthForKey();
+  }
+  virtual int GetEncodedValueLength(const std::any& data) {
+    return data.has_value() ? GetLengthForValue() : 0;
+  }
+
+  // The same for a ColumnValue, through the std::any of it unless overridden.
+  // The schemas override them to read the value in place. Named apart so that
+  // a call with a plain value is not ambiguous.
+  virtual int EncodeKeyVariant(const ColumnValue& data, Buf& buf) {
+    return EncodeKey(ToAny(data), buf);
+  }
+  virtual int EncodeValueVariant(const ColumnValue& data, Buf& buf) {
+    return EncodeValue(ToAny(data), buf);
+  }
+  virtual int GetEncodedKeyLengthVariant(const ColumnValue& data) {
+    return GetEncodedKeyLength(ToAny(data));
+  }
+  virtual int GetEncodedValueLengthVariant(const ColumnValue& data) {
+    return IsNull(data) ? 0 : GetEncodedValueLength(ToAny(data));
+  }
+
   virtual std::any DecodeKey(Buf& buf) = 0;
   virtual std::any DecodeValue(Buf& buf) = 0;
   virtual std::any DecodeValue(Buf& buf, int offset) = 0;
 
+  // Zero-copy readers, decode from bytes owned by the caller.
+  virtual int SkipKey(BufView& buf) = 0;
+  virtual int SkipValue(BufView& buf) = 0;
+
+  virtual std::any DecodeKey(BufView& buf) = 0;
+  virtual std::any DecodeValue(BufView& buf) = 0;
+  virtual std::any DecodeValue(BufView& buf, int offset) = 0;
+
+  // Typed decode, the value (or null) is passed to sink as column col.
+  virtual void DecodeKey(BufView& buf, RowSink& sink, int col) = 0;
+  virtual void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) = 0;
+
  protected:
   const uint8_t k_null = 0;
   const uint8_t k_not_null = 1;
 
+  // Invert the len bytes a key encode has just written to buf when the column
+  // is descending, returns len.
+  int OrderKey(Buf& buf, int len) const {
+    if (descending_) {
+      char* data = buf.Data() + buf.Size() - len;
+      for (int i = 0; i < len; ++i) {
+        data[i] = static_cast<char>(~data[i]);
+      }
+    }
+    return len;
+  }
+
+  // The len bytes of the descending key at the read offset of buf inverted
+  // back into out, buf is stepped over them. Returns a view of out.
+  template <typename B>
+  static BufView AscendingKey(B& buf, size_t len, char* out) {
+    if (DINGO_UNLIKELY(buf.RestReadableSize() < len)) {
+      throw std::runtime_error("Out of range.");
+    }
+    const char* data = buf.Data() + buf.ReadOffset();
+    for (size_t i = 0; i < len; ++i) {
+      out[i] = static_cast<char>(~data[i]);
+    }
+    buf.Skip(len);
+    return BufView(out, len, buf.IsLe());
+  }
+
  private:
   std::string name_;
 
   bool le_{true};
   bool is_key_{false};
   bool allow_null_{false};
+  bool descending_{false};
+  int column_group_{0};
+  int access_frequency_{0};
   int index_;
 };
 
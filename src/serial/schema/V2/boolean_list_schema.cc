@@ -14,17 +14,67 @@
 
 #include "boolean_list_schema.h"
 
+#include <algorithm>
 #include <any>
 #include <cstdint>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include "serial/utils/V2/bit_pack.h"
 #include "serial/utils/V2/compiler.h"
 
 namespace dingodb {
 namespace serialV2 {
 
+// top bit of the element count, set for the bit packed form.
+constexpr uint32_t kPackedFlag = 0x80000000;
+
+template <typename B>
+int DingoSchema<std::vector<bool>>::DecodeBoolList(B& buf, size_t offset,
+                                                   std::vector<bool>& data) {
+  uint32_t raw = buf.ReadInt(offset);
+  bool packed = raw & kPackedFlag;
+  size_t size = raw & ~kPackedFlag;
+  size_t len = packed ? PackedBitsSize(size) : size;
+  offset += 4;
+  if (DINGO_UNLIKELY(buf.Size() < offset + len)) {
+    throw std::runtime_error("Out of range.");
+  }
+
+  const auto* bytes = reinterpret_cast<const uint8_t*>(buf.Data() + offset);
+  if (packed) {
+    UnpackBools(bytes, size, data);
+  } else {
+    data.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      data[i] = bytes[i];
+    }
+  }
+
+  return len + 4;
+}
+
+void DingoSchema<std::vector<bool>>::DecodeRange(BufView& buf, int offset,
+                                                 size_t begin, size_t end,
+                                                 std::vector<bool>& data) {
+  uint32_t raw = buf.ReadInt(offset);
+  bool packed = raw & kPackedFlag;
+  end = std::min<size_t>(end, raw & ~kPackedFlag);
+  begin = std::min(begin, end);
+  size_t len = packed ? PackedBitsSize(end) : end;
+  offset += 4;
+  if (DINGO_UNLIKELY(buf.Size() < offset + len)) {
+    throw std::runtime_error("Out of range.");
+  }
+
+  const auto* bytes = reinterpret_cast<const uint8_t*>(buf.Data() + offset);
+  data.resize(end - begin);
+  for (size_t i = begin; i < end; ++i) {
+    data[i - begin] = packed ? (bytes[i / 8] >> (i % 8)) & 1 : bytes[i] != 0;
+  }
+}
+
 int DingoSchema<std::vector<bool>>::GetLengthForKey() {
   throw std::runtime_error("bool list unsupport length");
   return -1;
@@ -35,13 +85,19 @@ int DingoSchema<std::vector<bool>>::GetLengthForValue() {
   return -1;
 }
 
-int DingoSchema<std::vector<bool>>::SkipKey(Buf&) {
+template <typename B>
+int DingoSchema<std::vector<bool>>::SkipKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
   return -1;
 }
 
-int DingoSchema<std::vector<bool>>::SkipValue(Buf& buf) {
-  const int32_t size = buf.ReadInt();
+template <typename B>
+int DingoSchema<std::vector<bool>>::SkipValueImpl(B& buf) {
+  uint32_t raw = buf.ReadInt();
+  size_t size = raw & ~kPackedFlag;
+  if (raw & kPackedFlag) {
+    size = PackedBitsSize(size);
+  }
   buf.Skip(size);
 
   return size + 4;
@@ -52,15 +108,24 @@ int DingoSchema<std::vector<bool>>::EncodeKey(const std::any&, Buf&) {
   return -1;
 }
 
-// {n:4byte} | {value: 1byte}*n
-int DingoSchema<std::vector<bool>>::EncodeValue(const std::any& data,
-                                                Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+// {n:4byte} | {value: 1byte}*n, or packed as {n | 0x80000000:4byte} | {bits}
+int DingoSchema<std::vector<bool>>::EncodeValueData(
+    const std::vector<bool>* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but no value in data.");
   }
 
-  if (DINGO_LIKELY(data.has_value())) {
-    const auto& ref_data = std::any_cast<const std::vector<bool>&>(data);
+  if (DINGO_LIKELY(data != nullptr)) {
+    const auto& ref_data = *data;
+
+    if (packed_) {
+      size_t len = PackedBitsSize(ref_data.size());
+      buf.WriteInt(ref_data.size() | kPackedFlag);
+      size_t start = buf.Size();
+      buf.Enlarge(len);
+      PackBools(ref_data, reinterpret_cast<uint8_t*>(buf.Data() + start));
+      return len + 4;
+    }
 
     // if (!ref_data.empty()) {
     buf.WriteInt(ref_data.size());
@@ -75,31 +140,88 @@ int DingoSchema<std::vector<bool>>::EncodeValue(const std::any& data,
   return 0;
 }
 
-std::any DingoSchema<std::vector<bool>>::DecodeKey(Buf&) {
-  throw std::runtime_error("Unsupport decoding key list type");
+int DingoSchema<std::vector<bool>>::EncodeValue(const std::any& data,
+                                                Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<bool>>(data), buf);
 }
 
-std::any DingoSchema<std::vector<bool>>::DecodeValue(Buf& buf) {
-  int size = buf.ReadInt();
+int DingoSchema<std::vector<bool>>::EncodeValueVariant(const ColumnValue& data,
+                                                       Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<bool>>(data), buf);
+}
 
-  std::vector<bool> data(size, false);
-  for (int i = 0; i < size; ++i) {
-    data[i] = buf.Read();
+int DingoSchema<std::vector<bool>>::EncodedValueLength(
+    const std::vector<bool>* data) {
+  if (data == nullptr) {
+    return 0;
   }
+  size_t size = data->size();
+  return (packed_ ? PackedBitsSize(size) : size) + 4;
+}
+
+int DingoSchema<std::vector<bool>>::GetEncodedValueLength(
+    const std::any& data) {
+  return EncodedValueLength(DataOf<std::vector<bool>>(data));
+}
+
+int DingoSchema<std::vector<bool>>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<std::vector<bool>>(data));
+}
+
+template <typename B>
+std::any DingoSchema<std::vector<bool>>::DecodeKeyImpl(B&) {
+  throw std::runtime_error("Unsupport decoding key list type");
+}
+
+template <typename B>
+std::any DingoSchema<std::vector<bool>>::DecodeValueImpl(B& buf) {
+  std::vector<bool> data;
+  buf.Skip(DecodeBoolList(buf, buf.ReadOffset(), data));
 
   return std::move(std::any(std::move(data)));
 }
 
-std::any DingoSchema<std::vector<bool>>::DecodeValue(Buf& buf, int offset) {
-  int size = buf.ReadInt(offset);
-  offset += 4;
-  std::vector<bool> data(size, false);
-  for (int i = 0; i < size; ++i) {
-    data[i] = buf.Read(offset++);
-  }
+template <typename B>
+std::any DingoSchema<std::vector<bool>>::DecodeValueImpl(B& buf, int offset) {
+  std::vector<bool> data;
+  DecodeBoolList(buf, offset, data);
 
   return std::move(std::any(std::move(data)));
 }
 
+int DingoSchema<std::vector<bool>>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<std::vector<bool>>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<std::vector<bool>>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<std::vector<bool>>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<std::vector<bool>>::DecodeKey(Buf& buf) { return DecodeKeyImpl(buf); }
+std::any DingoSchema<std::vector<bool>>::DecodeKey(BufView& buf) { return DecodeKeyImpl(buf); }
+
+std::any DingoSchema<std::vector<bool>>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<std::vector<bool>>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<std::vector<bool>>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<std::vector<bool>>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<std::vector<bool>>::DecodeKey(BufView&, RowSink&, int) {
+  throw std::runtime_error("Unsupport encoding key list type");
+}
+
+void DingoSchema<std::vector<bool>>::DecodeValue(BufView& buf, int offset,
+                                                 RowSink& sink, int col) {
+  std::vector<bool> data;
+  sink.ReuseList(col, data);
+
+  DecodeBoolList(buf, offset, data);
+
+  sink.OnBoolList(col, std::move(data));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -39,10 +39,56 @@ class DingoSchema<std::vector<bool>> : public BaseSchema {
 
   int EncodeKey(const std::any& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
+  int GetEncodedValueLength(const std::any& data) override;
+  int GetEncodedValueLengthVariant(const ColumnValue& data) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
+
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
+  // Write values bit packed, {n | 0x80000000: 4byte} | {bits: (n + 7) / 8
+  // byte}. Both forms are decoded whatever the setting.
+  void SetPacked(bool packed) { packed_ = packed; }
+  bool IsPacked() const { return packed_; }
+
+  // Elements [begin, end) of the list value at offset, end clamped to the
+  // list size, only their bytes are read.
+  void DecodeRange(BufView& buf, int offset, size_t begin, size_t end,
+                   std::vector<bool>& data);
+
+ private:
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeValueData(const std::vector<bool>* data, Buf& buf);
+  int EncodedValueLength(const std::vector<bool>* data);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
+  // Decode the list at offset, return its encoded length.
+  template <typename B>
+  static int DecodeBoolList(B& buf, size_t offset, std::vector<bool>& data);
+
+  bool packed_{false};
 };
 
 }  // namespace serialV2
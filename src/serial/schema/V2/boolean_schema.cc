@@ -54,25 +54,27 @@ inline int DingoSchema<bool>::GetLengthForKey() {
 
 inline int DingoSchema<bool>::GetLengthForValue() { return kDataLength; }
 
-int DingoSchema<bool>::SkipKey(Buf& buf) {
+template <typename B>
+int DingoSchema<bool>::SkipKeyImpl(B& buf) {
   int len = GetLengthForKey();
   buf.Skip(len);
   return len;
 }
 
-int DingoSchema<bool>::SkipValue(Buf& buf) {
+template <typename B>
+int DingoSchema<bool>::SkipValueImpl(B& buf) {
   buf.Skip(kDataLength);
   return kDataLength;
 }
 
-inline int DingoSchema<bool>::Encode(const std::any& data, Buf& buf,
+inline int DingoSchema<bool>::Encode(const bool* data, Buf& buf,
                                      bool forKey) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const bool&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
     if (forKey) {
       buf.Write(k_not_null);
     }
@@ -89,15 +91,15 @@ inline int DingoSchema<bool>::Encode(const std::any& data, Buf& buf,
   return forKey ? GetLengthForKey() : kDataLength;
 }
 
-int DingoSchema<bool>::EncodeKey(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<bool>::EncodeKeyData(const bool* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
   if (AllowNull()) {
-    if (data.has_value()) {
+    if (data != nullptr) {
       buf.Write(k_not_null);
-      const auto& ref_data = std::any_cast<const bool&>(data);
+      const auto& ref_data = *data;
       buf.Write(ref_data ? 0x1 : 0x0);
     } else {
       buf.Write(k_null);
@@ -106,18 +108,35 @@ int DingoSchema<bool>::EncodeKey(const std::any& data, Buf& buf) {
 
     return kDataLengthWithNull;
   } else {
-    const auto& ref_data = std::any_cast<const bool&>(data);
+    const auto& ref_data = *data;
     buf.Write(ref_data ? 0x1 : 0x0);
 
     return kDataLength;
   }
 }
 
-int DingoSchema<bool>::EncodeValue(const std::any& data, Buf& buf) {
+int DingoSchema<bool>::EncodeKey(const std::any& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<bool>(data), buf));
+}
+
+int DingoSchema<bool>::EncodeKeyVariant(const ColumnValue& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<bool>(data), buf));
+}
+
+int DingoSchema<bool>::EncodeValueData(const bool* data, Buf& buf) {
   return Encode(data, buf, false);
 }
 
-std::any DingoSchema<bool>::DecodeKey(Buf& buf) {
+int DingoSchema<bool>::EncodeValue(const std::any& data, Buf& buf) {
+  return EncodeValueData(DataOf<bool>(data), buf);
+}
+
+int DingoSchema<bool>::EncodeValueVariant(const ColumnValue& data, Buf& buf) {
+  return EncodeValueData(DataOf<bool>(data), buf);
+}
+
+template <typename B>
+std::any DingoSchema<bool>::DecodeKeyImpl(B& buf) {
   if (AllowNull()) {
     if (buf.Read() == k_null) {
       buf.Skip(kDataLength);  // The null flag has already been read.
@@ -128,13 +147,75 @@ std::any DingoSchema<bool>::DecodeKey(Buf& buf) {
   return std::any(static_cast<bool>(buf.Read()));
 }
 
-std::any DingoSchema<bool>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<bool>::DecodeValueImpl(B& buf) {
   return std::any(static_cast<bool>(buf.Read()));
 }
 
-std::any DingoSchema<bool>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<bool>::DecodeValueImpl(B& buf, int offset) {
   return std::any(static_cast<bool>(buf.Read(offset)));
 }
 
+int DingoSchema<bool>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<bool>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<bool>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<bool>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<bool>::DecodeKey(Buf& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+std::any DingoSchema<bool>::DecodeKey(BufView& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+
+std::any DingoSchema<bool>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<bool>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<bool>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<bool>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<bool>::DecodeKeyImpl(BufView& buf, RowSink& sink, int col) {
+  if (AllowNull()) {
+    if (buf.Read() == k_null) {
+      buf.Skip(kDataLength);
+      sink.OnNull(col);
+      return;
+    }
+  }
+
+  sink.OnBool(col, static_cast<bool>(buf.Read()));
+}
+
+void DingoSchema<bool>::DecodeKey(BufView& buf, RowSink& sink, int col) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    DecodeKeyImpl(key, sink, col);
+    return;
+  }
+  DecodeKeyImpl(buf, sink, col);
+}
+
+void DingoSchema<bool>::DecodeValue(BufView& buf, int offset, RowSink& sink,
+                                    int col) {
+  sink.OnBool(col, static_cast<bool>(buf.Read(offset)));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -35,14 +35,43 @@ class DingoSchema<bool> : public BaseSchema {
   int SkipValue(Buf& buf) override;
 
   int EncodeKey(const std::any& data, Buf& buf) override;
+  int EncodeKeyVariant(const ColumnValue& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
 
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
  private:
-  int Encode(const std::any& data, Buf& buf, bool nullFlag);
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeKeyData(const bool* data, Buf& buf);
+  int EncodeValueData(const bool* data, Buf& buf);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  void DecodeKeyImpl(BufView& buf, RowSink& sink, int col);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
+  int Encode(const bool* data, Buf& buf, bool nullFlag);
 };
 
 }  // namespace serialV2
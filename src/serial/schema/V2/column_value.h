@@ -0,0 +1,154 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_COLUMN_VALUE_V2_H_
+#define DINGO_SERIAL_COLUMN_VALUE_V2_H_
+
+#include <any>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * A column value held in place, the alternative to std::any for records.
+ *
+ * Numbers live inside the value and strings and lists in their own object,
+ * no holder is allocated around them and reading one is a check of the
+ * index instead of an any_cast. std::monostate is null. The alternatives
+ * follow BaseSchema::Type, the one of type t is at index t + 1.
+ *
+ * Construct strings as std::string, a char pointer would pick bool on older
+ * standard libraries. (Value is taken by the column tag of
+ * StaticRecordCodec.)
+ */
+using ColumnValue =
+    std::variant<std::monostate, bool, int32_t, float, int64_t, double,
+                 std::string, std::vector<bool>, std::vector<int32_t>,
+                 std::vector<float>, std::vector<int64_t>, std::vector<double>,
+                 std::vector<std::string>>;
+
+inline bool IsNull(const ColumnValue& value) { return value.index() == 0; }
+inline bool IsNull(const std::any& value) { return !value.has_value(); }
+
+// The T of a not null value, nullptr for null. Throws std::bad_any_cast or
+// std::bad_variant_access when the value holds another type.
+template <typename T>
+const T* DataOf(const std::any& value) {
+  return value.has_value() ? &std::any_cast<const T&>(value) : nullptr;
+}
+
+template <typename T>
+const T* DataOf(const ColumnValue& value) {
+  return IsNull(value) ? nullptr : &std::get<T>(value);
+}
+
+// The std::any of the same value, empty for null.
+inline std::any ToAny(const ColumnValue& value) {
+  return std::visit(
+      [](const auto& data) -> std::any {
+        using T = std::decay_t<decltype(data)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+          return std::any();
+        } else {
+          return std::any(data);
+        }
+      },
+      value);
+}
+
+inline std::any ToAny(ColumnValue&& value) {
+  return std::visit(
+      [](auto&& data) -> std::any {
+        using T = std::decay_t<decltype(data)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+          return std::any();
+        } else {
+          return std::any(std::move(data));
+        }
+      },
+      std::move(value));
+}
+
+namespace internal {
+
+// Set value to the alternative data holds, moved out of a non const data.
+// False when data holds none of them.
+template <size_t I = 1, typename Any>
+bool AnyToValue(Any& data, ColumnValue& value) {
+  if constexpr (I < std::variant_size_v<ColumnValue>) {
+    using Alternative = std::variant_alternative_t<I, ColumnValue>;
+    if (auto* held = std::any_cast<Alternative>(&data)) {
+      if constexpr (std::is_const_v<Any>) {
+        value.template emplace<I>(*held);
+      } else {
+        value.template emplace<I>(std::move(*held));
+      }
+      return true;
+    }
+    return AnyToValue<I + 1>(data, value);
+  } else {
+    return false;
+  }
+}
+
+}  // namespace internal
+
+// The ColumnValue of data, which holds one of its types or nothing.
+// Throws runtime_error for another type. The rvalue form moves the string or
+// list out of data.
+inline ColumnValue FromAny(const std::any& data) {
+  ColumnValue value;
+  if (data.has_value() && !internal::AnyToValue(data, value)) {
+    throw std::runtime_error("Unsupported value type.");
+  }
+  return value;
+}
+
+inline ColumnValue FromAny(std::any&& data) {
+  ColumnValue value;
+  if (data.has_value() && !internal::AnyToValue(data, value)) {
+    throw std::runtime_error("Unsupported value type.");
+  }
+  return value;
+}
+
+inline std::vector<ColumnValue> FromAny(const std::vector<std::any>& record) {
+  std::vector<ColumnValue> values;
+  values.reserve(record.size());
+  for (const auto& data : record) {
+    values.push_back(FromAny(data));
+  }
+  return values;
+}
+
+inline std::vector<std::any> ToAny(const std::vector<ColumnValue>& values) {
+  std::vector<std::any> record;
+  record.reserve(values.size());
+  for (const auto& value : values) {
+    record.push_back(ToAny(value));
+  }
+  return record;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -38,6 +38,16 @@ class DingoSchema : public BaseSchema {
   std::any DecodeKey(Buf& buf /*NOLINT*/) override { return std::any(); }
   std::any DecodeValue(Buf& buf /*NOLINT*/) override { return std::any(); }
   std::any DecodeValue(Buf& buf /*NOLINT*/, int offset) override { return std::any(); }
+
+  int SkipKey(BufView& /*buf*/) override { return 0; }
+  int SkipValue(BufView& /*buf*/) override { return 0; }
+
+  std::any DecodeKey(BufView& buf /*NOLINT*/) override { return std::any(); }
+  std::any DecodeValue(BufView& buf /*NOLINT*/) override { return std::any(); }
+  std::any DecodeValue(BufView& buf /*NOLINT*/, int offset) override { return std::any(); }
+
+  void DecodeKey(BufView& /*buf*/, RowSink& /*sink*/, int /*col*/) override {}
+  void DecodeValue(BufView& /*buf*/, int /*offset*/, RowSink& /*sink*/, int /*col*/) override {}
 };
 
 }  // namespace serialV2
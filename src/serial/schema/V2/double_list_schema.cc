@@ -20,132 +20,36 @@
 #include <stdexcept>
 #include <utility>
 
+#include "serial/utils/V2/byte_swap.h"
 #include "serial/utils/V2/compiler.h"
+#include "serial/schema/V2/series_list.h"
 
 namespace dingodb {
 namespace serialV2 {
 
-void DingoSchema<std::vector<double>>::EncodeDoubleList(
+int DingoSchema<std::vector<double>>::EncodeDoubleList(
     const std::vector<double>& data, Buf& buf) {
-  buf.WriteInt(data.size());
-
-  if (IsLe()) {
-    for (const double& value : data) {
-      uint64_t bits;
-      memcpy(&bits, &value, 8);
-      buf.Write(bits >> 56);
-      buf.Write(bits >> 48);
-      buf.Write(bits >> 40);
-      buf.Write(bits >> 32);
-      buf.Write(bits >> 24);
-      buf.Write(bits >> 16);
-      buf.Write(bits >> 8);
-      buf.Write(bits);
-    }
-  } else {
-    for (const double& value : data) {
-      uint64_t bits;
-      memcpy(&bits, &value, 8);
-      buf.Write(bits);
-      buf.Write(bits >> 8);
-      buf.Write(bits >> 16);
-      buf.Write(bits >> 24);
-      buf.Write(bits >> 32);
-      buf.Write(bits >> 40);
-      buf.Write(bits >> 48);
-      buf.Write(bits >> 56);
-    }
+  if (xor_encoded_) {
+    return EncodeXorList(data, buf, IsLe());
   }
+  EncodePlainSeries(data, buf, IsLe());
+  return PlainSeriesLength<double>(data.size());
 }
 
-void DingoSchema<std::vector<double>>::DecodeDoubleList(
-    Buf& buf, std::vector<double>& data) {
-  const int size = buf.ReadInt();
-  data.resize(size);
-
-  if (IsLe()) {
-    for (int i = 0; i < size; ++i) {
-      uint64_t l = 0;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read()) & 0xFF);
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<double*>(v);
-    }
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint64_t l = 0;
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 0));
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 1));
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 2));
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 3));
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 4));
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 5));
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 6));
-      l |= ((static_cast<uint64_t>(buf.Read()) & 0xFF) << (8 * 7));
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<double*>(v);
-    }
-  }
+template <typename B>
+void DingoSchema<std::vector<double>>::DecodeDoubleList(B& buf, std::vector<double>& data) {
+  buf.Skip(DecodeSeriesList(buf, buf.ReadOffset(), data, IsLe()));
 }
 
-void DingoSchema<std::vector<double>>::DecodeDoubleList(
-    Buf& buf, std::vector<double>& data, int offset) {
-  const int size = buf.ReadInt(offset);
-  data.resize(size);
-  offset += 4;
-  if (IsLe()) {
-    for (int i = 0; i < size; ++i) {
-      uint64_t l = 0;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint64_t>(buf.Read(offset++)) & 0xFF);
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<double*>(v);
-    }
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint64_t l = 0;
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 0));
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 1));
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 2));
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 3));
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 4));
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 5));
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 6));
-      l |= ((static_cast<uint64_t>(buf.Read(offset++)) & 0xFF) << (8 * 7));
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<double*>(v);
-    }
-  }
+template <typename B>
+void DingoSchema<std::vector<double>>::DecodeDoubleList(B& buf, std::vector<double>& data, int offset) {
+  DecodeSeriesList(buf, offset, data, IsLe());
+}
+
+void DingoSchema<std::vector<double>>::DecodeRange(BufView& buf, int offset,
+                                              size_t begin, size_t end,
+                                              std::vector<double>& data) {
+  DecodeSeriesListRange(buf, offset, begin, end, data, IsLe());
 }
 
 int DingoSchema<std::vector<double>>::GetLengthForKey() {
@@ -158,16 +62,18 @@ int DingoSchema<std::vector<double>>::GetLengthForValue() {
   return -1;
 }
 
-int DingoSchema<std::vector<double>>::SkipKey(Buf&) {
+template <typename B>
+int DingoSchema<std::vector<double>>::SkipKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
   return -1;
 }
 
-int DingoSchema<std::vector<double>>::SkipValue(Buf& buf) {
-  int size = buf.ReadInt() * 8;
-  buf.Skip(size);
+template <typename B>
+int DingoSchema<std::vector<double>>::SkipValueImpl(B& buf) {
+  int len = SeriesListLength<double>(buf, buf.ReadOffset());
+  buf.Skip(len);
 
-  return size + 4;
+  return len;
 }
 
 int DingoSchema<std::vector<double>>::EncodeKey(const std::any&, Buf&) {
@@ -175,40 +81,106 @@ int DingoSchema<std::vector<double>>::EncodeKey(const std::any&, Buf&) {
   return -1;
 }
 
-// {n:4byte}|{value: 8byte}*n
-int DingoSchema<std::vector<double>>::EncodeValue(const std::any& data,
-                                                  Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+// {n:4byte}|{value: 8byte}*n, or series encoded as series_list.h describes.
+int DingoSchema<std::vector<double>>::EncodeValueData(
+    const std::vector<double>* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const std::vector<double>&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
 
-    EncodeDoubleList(ref_data, buf);
-    return ref_data.size() * 8 + 4;
+    return EncodeDoubleList(ref_data, buf);
   }
 
   return 0;
 }
 
-std::any DingoSchema<std::vector<double>>::DecodeKey(Buf&) {
+int DingoSchema<std::vector<double>>::EncodeValue(const std::any& data,
+                                                  Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<double>>(data), buf);
+}
+
+int DingoSchema<std::vector<double>>::EncodeValueVariant(
+    const ColumnValue& data, Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<double>>(data), buf);
+}
+
+int DingoSchema<std::vector<double>>::EncodedValueLength(
+    const std::vector<double>* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  if (!xor_encoded_) {
+    return PlainSeriesLength<double>(data->size());
+  }
+  return XorListLength(*data, XorListStreamSize(*data));
+}
+
+int DingoSchema<std::vector<double>>::GetEncodedValueLength(
+    const std::any& data) {
+  return EncodedValueLength(DataOf<std::vector<double>>(data));
+}
+
+int DingoSchema<std::vector<double>>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<std::vector<double>>(data));
+}
+
+template <typename B>
+std::any DingoSchema<std::vector<double>>::DecodeKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
 }
 
-std::any DingoSchema<std::vector<double>>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<std::vector<double>>::DecodeValueImpl(B& buf) {
   std::vector<double> data;
   DecodeDoubleList(buf, data);
 
   return std::move(std::any(std::move(data)));
 }
 
-std::any DingoSchema<std::vector<double>>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<std::vector<double>>::DecodeValueImpl(B& buf, int offset) {
   std::vector<double> data;
   DecodeDoubleList(buf, data, offset);
 
   return std::move(std::any(std::move(data)));
 }
 
+int DingoSchema<std::vector<double>>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<std::vector<double>>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<std::vector<double>>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<std::vector<double>>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<std::vector<double>>::DecodeKey(Buf& buf) { return DecodeKeyImpl(buf); }
+std::any DingoSchema<std::vector<double>>::DecodeKey(BufView& buf) { return DecodeKeyImpl(buf); }
+
+std::any DingoSchema<std::vector<double>>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<std::vector<double>>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<std::vector<double>>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<std::vector<double>>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<std::vector<double>>::DecodeKey(BufView&, RowSink&, int) {
+  throw std::runtime_error("Unsupport encoding key list type");
+}
+
+void DingoSchema<std::vector<double>>::DecodeValue(BufView& buf, int offset,
+                                                   RowSink& sink, int col) {
+  std::vector<double> data;
+  sink.ReuseList(col, data);
+
+  DecodeDoubleList(buf, data, offset);
+
+  sink.OnDoubleList(col, std::move(data));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -29,138 +29,40 @@ constexpr int kDataLength = 8;
 constexpr int kDataLengthWithNull = kDataLength + 1;
 
 void DingoSchema<double>::EncodeDoubleComparable(double data, Buf& buf) {
-  uint64_t bits;
-  memcpy(&bits, &data, 8);
-
-  if (IsLe() && data >= 0) {
-    buf.Write(bits >> 56 ^ 0x80);
-    buf.Write(bits >> 48);
-    buf.Write(bits >> 40);
-    buf.Write(bits >> 32);
-    buf.Write(bits >> 24);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 8);
-    buf.Write(bits);
-  } else if (IsLe() && data < 0) {
-    buf.Write(~bits >> 56);
-    buf.Write(~bits >> 48);
-    buf.Write(~bits >> 40);
-    buf.Write(~bits >> 32);
-    buf.Write(~bits >> 24);
-    buf.Write(~bits >> 16);
-    buf.Write(~bits >> 8);
-    buf.Write(~bits);
-  } else if (!IsLe() && data >= 0) {
-    buf.Write(bits ^ 0x80);
-    buf.Write(bits >> 8);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 24);
-    buf.Write(bits >> 32);
-    buf.Write(bits >> 40);
-    buf.Write(bits >> 48);
-    buf.Write(bits >> 56);
-  } else {
-    buf.Write(~bits);
-    buf.Write(~bits >> 8);
-    buf.Write(~bits >> 16);
-    buf.Write(~bits >> 24);
-    buf.Write(~bits >> 32);
-    buf.Write(~bits >> 40);
-    buf.Write(~bits >> 48);
-    buf.Write(~bits >> 56);
-  }
+  buf.WriteDoubleComparable(data);
 }
 
-double DingoSchema<double>::DecodeDoubleComparable(Buf& buf) {
-  uint64_t l = buf.Read() & 0xFF;
-  if (IsLe()) {
-    if (l >= 0x80) {
-      l = l ^ 0x80;
-      for (int i = 0; i < 7; ++i) {
-        l <<= 8;
-        l |= buf.Read() & 0xFF;
-      }
-    } else {
-      l = ~l;
-      for (int i = 0; i < 7; ++i) {
-        l <<= 8;
-        l |= ~buf.Read() & 0xFF;
-      }
-    }
-  } else {
-    if (l >= 0x80) {
-      l = l ^ 0x80;
-      for (int i = 1; i < 8; ++i) {
-        l |= (((uint64_t)buf.Read() & 0xFF) << (8 * i));
-      }
-    } else {
-      for (int i = 1; i < 8; ++i) {
-        l |= (((uint64_t)buf.Read() & 0xFF) << (8 * i));
-      }
-      l = ~l;
-    }
-  }
+template <typename B>
+double DingoSchema<double>::DecodeDoubleComparable(B& buf) {
+  uint64_t l = buf.ReadDoubleComparable();
 
-  void* v = &l;
-  return *reinterpret_cast<double*>(v);
+  double data;
+  memcpy(&data, &l, 8);
+  return data;
 }
 
 void DingoSchema<double>::EncodeDoubleNotComparable(double data, Buf& buf) {
   uint64_t bits;
   memcpy(&bits, &data, 8);
-  if (IsLe()) {
-    buf.Write(bits >> 56);
-    buf.Write(bits >> 48);
-    buf.Write(bits >> 40);
-    buf.Write(bits >> 32);
-    buf.Write(bits >> 24);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 8);
-    buf.Write(bits);
-  } else {
-    buf.Write(bits);
-    buf.Write(bits >> 8);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 24);
-    buf.Write(bits >> 32);
-    buf.Write(bits >> 40);
-    buf.Write(bits >> 48);
-    buf.Write(bits >> 56);
-  }
+  buf.WriteLong(bits);
 }
 
-double DingoSchema<double>::DecodeDoubleNotComparable(Buf& buf) {
-  uint64_t data = buf.Read() & 0xFF;
-  if (IsLe()) {
-    for (int i = 0; i < 7; ++i) {
-      data <<= 8;
-      data |= buf.Read() & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 8; ++i) {
-      data |= (((uint64_t)buf.Read() & 0xFF) << (8 * i));
-    }
-  }
+template <typename B>
+double DingoSchema<double>::DecodeDoubleNotComparable(B& buf) {
+  uint64_t l = buf.ReadLong();
 
-  void* v = &data;
-  return *reinterpret_cast<double*>(v);
+  double data;
+  memcpy(&data, &l, 8);
+  return data;
 }
 
-double DingoSchema<double>::DecodeDoubleNotComparable(Buf& buf, int offset) {
-  uint64_t data = buf.Read(offset++) & 0xFF;
-  if (IsLe()) {
-    for (int i = 0; i < 7; ++i) {
-      data <<= 8;
-      data |= buf.Read(offset++) & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 8; ++i) {
-      data |= (((uint64_t)buf.Read(offset++) & 0xFF) << (8 * i));
-    }
-  }
+template <typename B>
+double DingoSchema<double>::DecodeDoubleNotComparable(B& buf, int offset) {
+  uint64_t l = buf.ReadLong(offset);
 
-  void* v = &data;
-  return *reinterpret_cast<double*>(v);
+  double data;
+  memcpy(&data, &l, 8);
+  return data;
 }
 
 inline int DingoSchema<double>::GetLengthForKey() {
@@ -173,27 +75,29 @@ inline int DingoSchema<double>::GetLengthForKey() {
 
 int DingoSchema<double>::GetLengthForValue() { return kDataLength; }
 
-int DingoSchema<double>::SkipKey(Buf& buf) {
+template <typename B>
+int DingoSchema<double>::SkipKeyImpl(B& buf) {
   int len = GetLengthForKey();
   buf.Skip(len);
   return len;
 }
 
-int DingoSchema<double>::SkipValue(Buf& buf) {
+template <typename B>
+int DingoSchema<double>::SkipValueImpl(B& buf) {
   buf.Skip(kDataLength);
   return kDataLength;
 }
 
 // {is_null: 1byte}|{value: 8byte}
-int DingoSchema<double>::EncodeKey(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<double>::EncodeKeyData(const double* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
   if (AllowNull()) {
-    if (data.has_value()) {
+    if (data != nullptr) {
       buf.Write(k_not_null);
-      const auto& ref_data = std::any_cast<const double&>(data);
+      const auto& ref_data = *data;
       EncodeDoubleComparable(ref_data, buf);
     } else {
       buf.Write(k_null);
@@ -201,20 +105,28 @@ int DingoSchema<double>::EncodeKey(const std::any& data, Buf& buf) {
     }
     return kDataLengthWithNull;
   } else {
-    const auto& ref_data = std::any_cast<const double&>(data);
+    const auto& ref_data = *data;
     EncodeDoubleComparable(ref_data, buf);
     return kDataLength;
   }
 }
 
+int DingoSchema<double>::EncodeKey(const std::any& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<double>(data), buf));
+}
+
+int DingoSchema<double>::EncodeKeyVariant(const ColumnValue& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<double>(data), buf));
+}
+
 // {value: 8byte}
-int DingoSchema<double>::EncodeValue(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<double>::EncodeValueData(const double* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const double&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
     EncodeDoubleNotComparable(ref_data, buf);
     return kDataLength;
   }
@@ -222,7 +134,16 @@ int DingoSchema<double>::EncodeValue(const std::any& data, Buf& buf) {
   return 0;
 }
 
-std::any DingoSchema<double>::DecodeKey(Buf& buf) {
+int DingoSchema<double>::EncodeValue(const std::any& data, Buf& buf) {
+  return EncodeValueData(DataOf<double>(data), buf);
+}
+
+int DingoSchema<double>::EncodeValueVariant(const ColumnValue& data, Buf& buf) {
+  return EncodeValueData(DataOf<double>(data), buf);
+}
+
+template <typename B>
+std::any DingoSchema<double>::DecodeKeyImpl(B& buf) {
   if (AllowNull()) {
     if (buf.Read() == k_null) {
       buf.Skip(kDataLength);
@@ -233,13 +154,75 @@ std::any DingoSchema<double>::DecodeKey(Buf& buf) {
   return std::move(std::any(DecodeDoubleComparable(buf)));
 }
 
-inline std::any DingoSchema<double>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<double>::DecodeValueImpl(B& buf) {
   return std::move(std::any(DecodeDoubleNotComparable(buf)));
 }
 
-inline std::any DingoSchema<double>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<double>::DecodeValueImpl(B& buf, int offset) {
   return std::move(std::any(DecodeDoubleNotComparable(buf, offset)));
 }
 
+int DingoSchema<double>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<double>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<double>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<double>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<double>::DecodeKey(Buf& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+std::any DingoSchema<double>::DecodeKey(BufView& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+
+std::any DingoSchema<double>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<double>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<double>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<double>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<double>::DecodeKeyImpl(BufView& buf, RowSink& sink, int col) {
+  if (AllowNull()) {
+    if (buf.Read() == k_null) {
+      buf.Skip(kDataLength);
+      sink.OnNull(col);
+      return;
+    }
+  }
+
+  sink.OnDouble(col, DecodeDoubleComparable(buf));
+}
+
+void DingoSchema<double>::DecodeKey(BufView& buf, RowSink& sink, int col) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    DecodeKeyImpl(key, sink, col);
+    return;
+  }
+  DecodeKeyImpl(buf, sink, col);
+}
+
+void DingoSchema<double>::DecodeValue(BufView& buf, int offset, RowSink& sink,
+                                      int col) {
+  sink.OnDouble(col, DecodeDoubleNotComparable(buf, offset));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -0,0 +1,249 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ENCODED_LIST_VIEW_V2_H_
+#define DINGO_SERIAL_ENCODED_LIST_VIEW_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/byte_swap.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Read-only views over list values as encoded by the list schemas, elements
+ * are byte swapped when read instead of being copied out up front.
+ *
+ * A view points into the value bytes, which must outlive it. A default
+ * constructed view stands for a null column.
+ */
+
+// {n:4byte}|{value: 4/8byte}*n of int32_t, int64_t, float or double.
+template <typename T>
+class EncodedListView {
+  static_assert(std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8),
+                "4 or 8 byte elements");
+
+  using Word = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = T;
+
+    Iterator(const EncodedListView* view, size_t i) : view_(view), i_(i) {}
+
+    T operator*() const { return (*view_)[i_]; }
+    Iterator& operator++() {
+      ++i_;
+      return *this;
+    }
+    bool operator==(const Iterator& other) const { return i_ == other.i_; }
+    bool operator!=(const Iterator& other) const { return i_ != other.i_; }
+
+   private:
+    const EncodedListView* view_;
+    size_t i_;
+  };
+
+  EncodedListView() = default;
+
+  // Point at the list encoded at data[0, size), false when it does not fit.
+  bool Reset(const char* data, size_t size, bool le) {
+    BufView buf(data, size, le);
+    if (size < 4) {
+      return false;
+    }
+    int32_t count = buf.ReadInt(0);
+    if (count < 0 || size - 4 < static_cast<size_t>(count) * sizeof(T)) {
+      return false;
+    }
+
+    data_ = data + 4;
+    size_ = count;
+    swap_ = le;
+    return true;
+  }
+
+  bool IsNull() const { return data_ == nullptr; }
+  size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+
+  T operator[](size_t i) const {
+    Word word;
+    memcpy(&word, data_ + i * sizeof(T), sizeof(T));
+    if (swap_) {
+      if constexpr (sizeof(T) == 4) {
+        word = __builtin_bswap32(word);
+      } else {
+        word = __builtin_bswap64(word);
+      }
+    }
+    T value;
+    memcpy(&value, &word, sizeof(T));
+    return value;
+  }
+
+  T At(size_t i) const {
+    if (i >= size_) {
+      throw std::out_of_range("Out of range.");
+    }
+    return (*this)[i];
+  }
+
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, size_); }
+
+  // The encoded elements, IsSwapped tells whether they are byte swapped
+  // relative to the host.
+  const char* Data() const { return data_; }
+  bool IsSwapped() const { return swap_; }
+
+  // Copy all elements out to Size() slots at out.
+  void CopyTo(T* out) const {
+    if constexpr (sizeof(T) == 4) {
+      CopyWords32(reinterpret_cast<char*>(out), data_, size_, swap_);
+    } else {
+      CopyWords64(reinterpret_cast<char*>(out), data_, size_, swap_);
+    }
+  }
+
+  std::vector<T> ToVector() const {
+    std::vector<T> data(size_);
+    CopyTo(data.data());
+    return data;
+  }
+
+ private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  bool swap_{false};
+};
+
+// {n:4byte}|{len:4byte|bytes}*n, the strings are visited in order.
+class EncodedStringListView {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::string_view;
+
+    Iterator(const char* pos, bool le) : pos_(pos), le_(le) {}
+
+    std::string_view operator*() const {
+      return std::string_view(pos_ + 4, Length());
+    }
+    Iterator& operator++() {
+      pos_ += 4 + Length();
+      return *this;
+    }
+    bool operator==(const Iterator& other) const { return pos_ == other.pos_; }
+    bool operator!=(const Iterator& other) const { return pos_ != other.pos_; }
+
+   private:
+    size_t Length() const { return BufView(pos_, 4, le_).ReadInt(0); }
+
+    const char* pos_;
+    bool le_;
+  };
+
+  EncodedStringListView() = default;
+
+  // Point at the list encoded at data[0, size) after checking every length,
+  // false when it does not fit.
+  bool Reset(const char* data, size_t size, bool le) {
+    BufView buf(data, size, le);
+    if (size < 4) {
+      return false;
+    }
+    int32_t count = buf.ReadInt(0);
+    if (count < 0) {
+      return false;
+    }
+
+    size_t pos = 4;
+    for (int32_t i = 0; i < count; ++i) {
+      if (size - pos < 4) {
+        return false;
+      }
+      int32_t len = buf.ReadInt(pos);
+      if (len < 0 || size - pos - 4 < static_cast<size_t>(len)) {
+        return false;
+      }
+      pos += 4 + len;
+    }
+
+    data_ = data + 4;
+    end_ = data + pos;
+    size_ = count;
+    le_ = le;
+    return true;
+  }
+
+  bool IsNull() const { return data_ == nullptr; }
+  size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+
+  Iterator begin() const { return Iterator(data_, le_); }
+  Iterator end() const { return Iterator(end_, le_); }
+
+  // Walks the strings in front of i.
+  std::string_view At(size_t i) const {
+    if (i >= size_) {
+      throw std::out_of_range("Out of range.");
+    }
+    auto it = begin();
+    while (i-- > 0) {
+      ++it;
+    }
+    return *it;
+  }
+
+  std::vector<std::string> ToVector() const {
+    std::vector<std::string> data;
+    data.reserve(size_);
+    for (auto str : *this) {
+      data.emplace_back(str);
+    }
+    return data;
+  }
+
+ private:
+  const char* data_{nullptr};
+  const char* end_{nullptr};
+  size_t size_{0};
+  bool le_{false};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
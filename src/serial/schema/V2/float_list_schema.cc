@@ -14,105 +14,118 @@
 
 #include "float_list_schema.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <stdexcept>
 #include <cstring>
 #include <utility>
 
+#include "serial/utils/V2/byte_swap.h"
 #include "serial/utils/V2/compiler.h"
 
 namespace dingodb {
 namespace serialV2 {
 
-void DingoSchema<std::vector<float>>::EncodeFloatList(
-    const std::vector<float>& data, Buf& buf) {
-  buf.WriteInt(data.size());
-
-  if (DINGO_LIKELY(IsLe())) {
-    for (const float& value : data) {
-      uint32_t bits;
-      memcpy(&bits, &value, 4);
-      buf.Write(bits >> 24);
-      buf.Write(bits >> 16);
-      buf.Write(bits >> 8);
-      buf.Write(bits);
-    }
+// top bit of the element count, set for the quantized forms.
+constexpr uint32_t kQuantizedFlag = 0x80000000;
 
-  } else {
-    for (const float& value : data) {
-      uint32_t bits;
-      memcpy(&bits, &value, 4);
-      buf.Write(bits);
-      buf.Write(bits >> 8);
-      buf.Write(bits >> 16);
-      buf.Write(bits >> 24);
-    }
-  }
-}
+template <typename B>
+DingoSchema<std::vector<float>>::Layout
+DingoSchema<std::vector<float>>::ReadLayoutImpl(B& buf, size_t offset) {
+  Layout layout;
+  uint32_t raw = buf.ReadInt(offset);
+  layout.size = raw & ~kQuantizedFlag;
+  layout.data_offset = offset + 4;
 
-void DingoSchema<std::vector<float>>::DecodeFloatList(
-    Buf& buf, std::vector<float>& data) {
-  int size = buf.ReadInt();
-  data.resize(size);
-
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < size; ++i) {
-      uint32_t l = 0;
-      l |= (static_cast<uint32_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint32_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint32_t>(buf.Read()) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint32_t>(buf.Read()) & 0xFF);
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<float*>(v);
+  if (raw & kQuantizedFlag) {
+    if (DINGO_UNLIKELY(buf.Size() < layout.data_offset + 1)) {
+      throw std::runtime_error("Out of range.");
+    }
+    uint8_t quantization = buf.Read(layout.data_offset++);
+    if (DINGO_UNLIKELY(quantization <
+                           static_cast<uint8_t>(FloatQuantization::kFp16) ||
+                       quantization >
+                           static_cast<uint8_t>(FloatQuantization::kInt8))) {
+      throw std::runtime_error("Unknown float list quantization.");
     }
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint32_t l = 0;
-      l |= ((static_cast<uint32_t>(buf.Read()) & 0xFF) << (8 * 0));
-      l |= ((static_cast<uint32_t>(buf.Read()) & 0xFF) << (8 * 1));
-      l |= ((static_cast<uint32_t>(buf.Read()) & 0xFF) << (8 * 2));
-      l |= ((static_cast<uint32_t>(buf.Read()) & 0xFF) << (8 * 3));
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<float*>(v);
+    layout.quantization = static_cast<FloatQuantization>(quantization);
+    if (layout.quantization == FloatQuantization::kInt8) {
+      uint32_t bits = buf.ReadInt(layout.data_offset);
+      memcpy(&layout.scale, &bits, 4);
+      layout.data_offset += 4;
     }
   }
+
+  size_t end =
+      layout.data_offset + layout.size * QuantizedWidth(layout.quantization);
+  if (DINGO_UNLIKELY(buf.Size() < end)) {
+    throw std::runtime_error("Out of range.");
+  }
+  layout.length = end - offset;
+  return layout;
 }
 
-void DingoSchema<std::vector<float>>::DecodeFloatList(
-    Buf& buf, std::vector<float>& data, int offset) {
-  int size = buf.ReadInt(offset);
-  data.resize(size);
-  offset += 4;
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < size; ++i) {
-      uint32_t l = 0;
-      l |= (static_cast<uint32_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint32_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint32_t>(buf.Read(offset++)) & 0xFF);
-      l <<= 8;
-      l |= (static_cast<uint32_t>(buf.Read(offset++)) & 0xFF);
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<float*>(v);
-    }
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint32_t l = 0;
-      l |= ((static_cast<uint32_t>(buf.Read(offset++)) & 0xFF) << (8 * 0));
-      l |= ((static_cast<uint32_t>(buf.Read(offset++)) & 0xFF) << (8 * 1));
-      l |= ((static_cast<uint32_t>(buf.Read(offset++)) & 0xFF) << (8 * 2));
-      l |= ((static_cast<uint32_t>(buf.Read(offset++)) & 0xFF) << (8 * 3));
-
-      void* v = &l;
-      data[i] = *reinterpret_cast<float*>(v);
-    }
+DingoSchema<std::vector<float>>::Layout
+DingoSchema<std::vector<float>>::ReadLayout(BufView& buf, size_t offset) {
+  return ReadLayoutImpl(buf, offset);
+}
+
+int DingoSchema<std::vector<float>>::EncodeFloatList(
+    const std::vector<float>& data, Buf& buf) {
+  if (quantization_ == FloatQuantization::kNone) {
+    buf.WriteInt(data.size());
+
+    size_t start = buf.Size();
+    buf.Enlarge(data.size() * 4);
+    CopyWords32(buf.Data() + start, reinterpret_cast<const char*>(data.data()),
+                data.size(), IsLe());
+    return data.size() * 4 + 4;
   }
+
+  size_t begin = buf.Size();
+  buf.WriteInt(data.size() | kQuantizedFlag);
+  buf.Write(static_cast<uint8_t>(quantization_));
+  size_t scale_pos = buf.Size();
+  if (quantization_ == FloatQuantization::kInt8) {
+    buf.WriteInt(0);
+  }
+
+  size_t start = buf.Size();
+  buf.Enlarge(data.size() * QuantizedWidth(quantization_));
+  float scale = Quantize(quantization_, data.data(), data.size(),
+                         buf.Data() + start, IsLe());
+  if (quantization_ == FloatQuantization::kInt8) {
+    uint32_t bits;
+    memcpy(&bits, &scale, 4);
+    buf.WriteInt(scale_pos, bits);
+  }
+  return buf.Size() - begin;
+}
+
+template <typename B>
+int DingoSchema<std::vector<float>>::DecodeFloatList(B& buf,
+                                                     std::vector<float>& data,
+                                                     size_t offset) {
+  Layout layout = ReadLayoutImpl(buf, offset);
+
+  data.resize(layout.size);
+  Dequantize(layout.quantization, buf.Data() + layout.data_offset, layout.size,
+             layout.scale, data.data(), IsLe());
+  return layout.length;
+}
+
+void DingoSchema<std::vector<float>>::DecodeRange(BufView& buf, int offset,
+                                                  size_t begin, size_t end,
+                                                  std::vector<float>& data) {
+  Layout layout = ReadLayoutImpl(buf, offset);
+  end = std::min(end, layout.size);
+  begin = std::min(begin, end);
+
+  data.resize(end - begin);
+  Dequantize(layout.quantization,
+             buf.Data() + layout.data_offset +
+                 begin * QuantizedWidth(layout.quantization),
+             end - begin, layout.scale, data.data(), IsLe());
 }
 
 int DingoSchema<std::vector<float>>::GetLengthForKey() {
@@ -125,16 +138,18 @@ int DingoSchema<std::vector<float>>::GetLengthForValue() {
   return -1;
 }
 
-int DingoSchema<std::vector<float>>::SkipKey(Buf&) {
+template <typename B>
+int DingoSchema<std::vector<float>>::SkipKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
   return -1;
 }
 
-int DingoSchema<std::vector<float>>::SkipValue(Buf& buf) {
-  int size = buf.ReadInt() * 4;
-  buf.Skip(size);
+template <typename B>
+int DingoSchema<std::vector<float>>::SkipValueImpl(B& buf) {
+  int len = ReadLayoutImpl(buf, buf.ReadOffset()).length;
+  buf.Skip(len);
 
-  return size + 4;
+  return len;
 }
 
 int DingoSchema<std::vector<float>>::EncodeKey(const std::any&, Buf&) {
@@ -142,42 +157,109 @@ int DingoSchema<std::vector<float>>::EncodeKey(const std::any&, Buf&) {
   return -1;
 }
 
-// {n:4byte}|{value: 4byte}*n
-int DingoSchema<std::vector<float>>::EncodeValue(const std::any& data,
-                                                 Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+// {n:4byte}|{value: 4byte}*n, or quantized as described in the header.
+int DingoSchema<std::vector<float>>::EncodeValueData(
+    const std::vector<float>* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const std::vector<float>&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
 
-    // if (!ref_data.empty()) {
-    EncodeFloatList(ref_data, buf);
-    return ref_data.size() * 4 + 4;
-    //}
+    return EncodeFloatList(ref_data, buf);
   }
 
   return 0;
 }
 
-std::any DingoSchema<std::vector<float>>::DecodeKey(Buf&) {
+int DingoSchema<std::vector<float>>::EncodeValue(const std::any& data,
+                                                 Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<float>>(data), buf);
+}
+
+int DingoSchema<std::vector<float>>::EncodeValueVariant(const ColumnValue& data,
+                                                        Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<float>>(data), buf);
+}
+
+// the quantized form adds its mode byte and, for int8, the scale.
+int DingoSchema<std::vector<float>>::EncodedValueLength(
+    const std::vector<float>* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  size_t size = data->size();
+  if (quantization_ == FloatQuantization::kNone) {
+    return size * 4 + 4;
+  }
+  int header = quantization_ == FloatQuantization::kInt8 ? 9 : 5;
+  return size * QuantizedWidth(quantization_) + header;
+}
+
+int DingoSchema<std::vector<float>>::GetEncodedValueLength(
+    const std::any& data) {
+  return EncodedValueLength(DataOf<std::vector<float>>(data));
+}
+
+int DingoSchema<std::vector<float>>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<std::vector<float>>(data));
+}
+
+template <typename B>
+std::any DingoSchema<std::vector<float>>::DecodeKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
 }
 
-std::any DingoSchema<std::vector<float>>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<std::vector<float>>::DecodeValueImpl(B& buf) {
   std::vector<float> data;
-  DecodeFloatList(buf, data);
+  buf.Skip(DecodeFloatList(buf, data, buf.ReadOffset()));
 
   return std::move(std::any(std::move(data)));
 }
 
-std::any DingoSchema<std::vector<float>>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<std::vector<float>>::DecodeValueImpl(B& buf, int offset) {
   std::vector<float> data;
   DecodeFloatList(buf, data, offset);
 
   return std::move(std::any(std::move(data)));
 }
 
+int DingoSchema<std::vector<float>>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<std::vector<float>>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<std::vector<float>>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<std::vector<float>>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<std::vector<float>>::DecodeKey(Buf& buf) { return DecodeKeyImpl(buf); }
+std::any DingoSchema<std::vector<float>>::DecodeKey(BufView& buf) { return DecodeKeyImpl(buf); }
+
+std::any DingoSchema<std::vector<float>>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<std::vector<float>>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<std::vector<float>>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<std::vector<float>>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<std::vector<float>>::DecodeKey(BufView&, RowSink&, int) {
+  throw std::runtime_error("Unsupport encoding key list type");
+}
+
+void DingoSchema<std::vector<float>>::DecodeValue(BufView& buf, int offset,
+                                                  RowSink& sink, int col) {
+  std::vector<float> data;
+  sink.ReuseList(col, data);
+
+  DecodeFloatList(buf, data, offset);
+
+  sink.OnFloatList(col, std::move(data));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "dingo_schema.h"
+#include "serial/utils/V2/float_quant.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -39,15 +40,72 @@ class DingoSchema<std::vector<float>> : public BaseSchema {
 
   int EncodeKey(const std::any& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
+  int GetEncodedValueLength(const std::any& data) override;
+  int GetEncodedValueLengthVariant(const ColumnValue& data) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
 
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
+  // Write values lossy as fp16, bf16 or scaled int8, {n | 0x80000000: 4byte} |
+  // {quantization: 1byte} | [{scale: 4byte} for int8] | {elements}. Both
+  // forms are decoded whatever is set.
+  void SetQuantization(FloatQuantization quantization) {
+    quantization_ = quantization;
+  }
+  FloatQuantization GetQuantization() const { return quantization_; }
+
+  // How the float list at offset is stored.
+  struct Layout {
+    size_t size{0};
+    FloatQuantization quantization{FloatQuantization::kNone};
+    float scale{1.0f};
+    size_t data_offset{0};  // first element
+    size_t length{0};       // whole encoded list
+  };
+  static Layout ReadLayout(BufView& buf, size_t offset);
+
+  // Elements [begin, end) of the list value at offset, end clamped to the
+  // list size, only their bytes are read.
+  void DecodeRange(BufView& buf, int offset, size_t begin, size_t end,
+                   std::vector<float>& data);
+
  private:
-  void EncodeFloatList(const std::vector<float>& data, Buf& buf);
-  void DecodeFloatList(Buf& buf, std::vector<float>& data);
-  void DecodeFloatList(Buf& buf, std::vector<float>& data, int offset);
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeValueData(const std::vector<float>* data, Buf& buf);
+  int EncodedValueLength(const std::vector<float>* data);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
+  template <typename B>
+  static Layout ReadLayoutImpl(B& buf, size_t offset);
+
+  int EncodeFloatList(const std::vector<float>& data, Buf& buf);
+  template <typename B>
+  int DecodeFloatList(B& buf, std::vector<float>& data, size_t offset);
+
+  FloatQuantization quantization_{FloatQuantization::kNone};
 };
 
 }  // namespace serialV2
@@ -27,114 +27,39 @@ constexpr int kDataLength = 4;
 constexpr int kDataLengthWithNull = kDataLength + 1;
 
 void DingoSchema<float>::EncodeFloatComparable(float data, Buf& buf) {
-  uint32_t bits;
-  memcpy(&bits, &data, 4);
-  if (DINGO_LIKELY(IsLe() && data >= 0)) {
-    buf.Write(bits >> 24 ^ 0x80);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 8);
-    buf.Write(bits);
-  } else if (IsLe() && data < 0) {
-    buf.Write(~bits >> 24);
-    buf.Write(~bits >> 16);
-    buf.Write(~bits >> 8);
-    buf.Write(~bits);
-  } else if (!IsLe() && data >= 0) {
-    buf.Write(bits ^ 0x80);
-    buf.Write(bits >> 8);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 24);
-  } else {
-    buf.Write(~bits);
-    buf.Write(~bits >> 8);
-    buf.Write(~bits >> 16);
-    buf.Write(~bits >> 24);
-  }
+  buf.WriteFloatComparable(data);
 }
 
-float DingoSchema<float>::DecodeFloatComparable(Buf& buf) {
-  uint32_t in = buf.Read() & 0xFF;
-  if (DINGO_LIKELY(IsLe())) {
-    if (in >= 0x80) {
-      in = in ^ 0x80;
-      for (int i = 0; i < 3; i++) {
-        in <<= 8;
-        in |= buf.Read() & 0xFF;
-      }
-    } else {
-      in = ~in;
-      for (int i = 0; i < 3; i++) {
-        in <<= 8;
-        in |= ~buf.Read() & 0xFF;
-      }
-    }
-  } else {
-    if (in >= 0x80) {
-      in = in ^ 0x80;
-      for (int i = 1; i < 4; i++) {
-        in |= (((uint32_t)buf.Read() & 0xFF) << (8 * i));
-      }
-    } else {
-      for (int i = 1; i < 4; i++) {
-        in |= (((uint32_t)buf.Read() & 0xFF) << (8 * i));
-      }
-      in = ~in;
-    }
-  }
+template <typename B>
+float DingoSchema<float>::DecodeFloatComparable(B& buf) {
+  uint32_t in = buf.ReadFloatComparable();
 
-  void* v = &in;
-  return *reinterpret_cast<float*>(v);
+  float data;
+  memcpy(&data, &in, 4);
+  return data;
 }
 
 void DingoSchema<float>::EncodeFloatNotComparable(float data, Buf& buf) {
   uint32_t bits;
   memcpy(&bits, &data, 4);
-  if (IsLe()) {
-    buf.Write(bits >> 24);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 8);
-    buf.Write(bits);
-  } else {
-    buf.Write(bits);
-    buf.Write(bits >> 8);
-    buf.Write(bits >> 16);
-    buf.Write(bits >> 24);
-  }
+  buf.WriteInt(bits);
 }
-float DingoSchema<float>::DecodeFloatNotComparable(Buf& buf) {
-  uint32_t in = buf.Read() & 0xFF;
+template <typename B>
+float DingoSchema<float>::DecodeFloatNotComparable(B& buf) {
+  uint32_t in = buf.ReadInt();
 
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < 3; i++) {
-      in <<= 8;
-      in |= buf.Read() & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 4; i++) {
-      in |= (((uint32_t)buf.Read() & 0xFF) << (8 * i));
-    }
-  }
-
-  void* v = &in;
-  return *reinterpret_cast<float*>(v);
+  float data;
+  memcpy(&data, &in, 4);
+  return data;
 }
 
-float DingoSchema<float>::DecodeFloatNotComparable(Buf& buf, int offset) {
-  uint32_t in = buf.Read(offset++) & 0xFF;
+template <typename B>
+float DingoSchema<float>::DecodeFloatNotComparable(B& buf, int offset) {
+  uint32_t in = buf.ReadInt(offset);
 
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < 3; i++) {
-      in <<= 8;
-      in |= buf.Read(offset++) & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 4; i++) {
-      in |= (((uint32_t)buf.Read(offset++) & 0xFF) << (8 * i));
-    }
-  }
-
-  void* v = &in;
-  return *reinterpret_cast<float*>(v);
+  float data;
+  memcpy(&data, &in, 4);
+  return data;
 }
 
 int DingoSchema<float>::GetLengthForKey() {
@@ -148,26 +73,28 @@ int DingoSchema<float>::GetLengthForKey() {
 
 int DingoSchema<float>::GetLengthForValue() { return kDataLength; }
 
-int DingoSchema<float>::SkipKey(Buf& buf) {
+template <typename B>
+int DingoSchema<float>::SkipKeyImpl(B& buf) {
   int len = GetLengthForKey();
   buf.Skip(len);
   return len;
 }
 
-int DingoSchema<float>::SkipValue(Buf& buf) {
+template <typename B>
+int DingoSchema<float>::SkipValueImpl(B& buf) {
   buf.Skip(kDataLength);
   return kDataLength;
 }
 
-int DingoSchema<float>::EncodeKey(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<float>::EncodeKeyData(const float* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
   if(AllowNull()) {
-    if (data.has_value()) {
+    if (data != nullptr) {
       buf.Write(k_not_null);
-      const auto& ref_data = std::any_cast<const float&>(data);
+      const auto& ref_data = *data;
       EncodeFloatComparable(ref_data, buf);
     } else {
       buf.Write(k_null);
@@ -176,20 +103,28 @@ int DingoSchema<float>::EncodeKey(const std::any& data, Buf& buf) {
     return kDataLengthWithNull;
   }
   else {
-    const auto& ref_data = std::any_cast<const float&>(data);
+    const auto& ref_data = *data;
     EncodeFloatComparable(ref_data, buf);
     return kDataLength;
   }
 }
 
+int DingoSchema<float>::EncodeKey(const std::any& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<float>(data), buf));
+}
+
+int DingoSchema<float>::EncodeKeyVariant(const ColumnValue& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<float>(data), buf));
+}
+
 // {value: 4byte}
-int DingoSchema<float>::EncodeValue(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<float>::EncodeValueData(const float* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const float&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
     EncodeFloatNotComparable(ref_data, buf);
     return kDataLength;
   }
@@ -197,7 +132,16 @@ int DingoSchema<float>::EncodeValue(const std::any& data, Buf& buf) {
   return 0;
 }
 
-std::any DingoSchema<float>::DecodeKey(Buf& buf) {
+int DingoSchema<float>::EncodeValue(const std::any& data, Buf& buf) {
+  return EncodeValueData(DataOf<float>(data), buf);
+}
+
+int DingoSchema<float>::EncodeValueVariant(const ColumnValue& data, Buf& buf) {
+  return EncodeValueData(DataOf<float>(data), buf);
+}
+
+template <typename B>
+std::any DingoSchema<float>::DecodeKeyImpl(B& buf) {
   if(AllowNull()) {
     if (buf.Read() == k_null) {
       buf.Skip(kDataLength);
@@ -208,13 +152,75 @@ std::any DingoSchema<float>::DecodeKey(Buf& buf) {
   return std::move(std::any(DecodeFloatComparable(buf)));
 }
 
-inline std::any DingoSchema<float>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<float>::DecodeValueImpl(B& buf) {
   return std::move(std::any(DecodeFloatNotComparable(buf)));
 }
 
-inline std::any DingoSchema<float>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<float>::DecodeValueImpl(B& buf, int offset) {
   return std::move(std::any(DecodeFloatNotComparable(buf, offset)));
 }
 
+int DingoSchema<float>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<float>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<float>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<float>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<float>::DecodeKey(Buf& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+std::any DingoSchema<float>::DecodeKey(BufView& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+
+std::any DingoSchema<float>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<float>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<float>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<float>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<float>::DecodeKeyImpl(BufView& buf, RowSink& sink, int col) {
+  if (AllowNull()) {
+    if (buf.Read() == k_null) {
+      buf.Skip(kDataLength);
+      sink.OnNull(col);
+      return;
+    }
+  }
+
+  sink.OnFloat(col, DecodeFloatComparable(buf));
+}
+
+void DingoSchema<float>::DecodeKey(BufView& buf, RowSink& sink, int col) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    DecodeKeyImpl(key, sink, col);
+    return;
+  }
+  DecodeKeyImpl(buf, sink, col);
+}
+
+void DingoSchema<float>::DecodeValue(BufView& buf, int offset, RowSink& sink,
+                                     int col) {
+  sink.OnFloat(col, DecodeFloatNotComparable(buf, offset));
+}
+
 }  // namespace V2
 }  // namespace dingodb
\ No newline at end of file
@@ -35,19 +35,51 @@ class DingoSchema<float> : public BaseSchema {
   int SkipValue(Buf& buf) override;
 
   int EncodeKey(const std::any& data, Buf& buf) override;
+  int EncodeKeyVariant(const ColumnValue& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
 
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
  private:
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeKeyData(const float* data, Buf& buf);
+  int EncodeValueData(const float* data, Buf& buf);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  void DecodeKeyImpl(BufView& buf, RowSink& sink, int col);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
   void EncodeFloatComparable(float data, Buf& buf);
-  float DecodeFloatComparable(Buf& buf);
+  template <typename B>
+  float DecodeFloatComparable(B& buf);
 
   void EncodeFloatNotComparable(float data, Buf& buf);
-  float DecodeFloatNotComparable(Buf& buf);
-  float DecodeFloatNotComparable(Buf& buf, int offset);
+  template <typename B>
+  float DecodeFloatNotComparable(B& buf);
+  template <typename B>
+  float DecodeFloatNotComparable(B& buf, int offset);
 };
 
 }  // namespace V2
@@ -15,9 +15,12 @@
 #include "integer_list_schema.h"
 
 #include <cstdint>
+#include <stdexcept>
 #include <utility>
 
+#include "serial/utils/V2/byte_swap.h"
 #include "serial/utils/V2/compiler.h"
+#include "serial/schema/V2/series_list.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -25,73 +28,29 @@ namespace serialV2 {
 constexpr int kDataLengthForValue = 4;
 constexpr int kDataLengthForKey = kDataLengthForValue + 1;
 
-void DingoSchema<std::vector<int32_t>>::EncodeIntList(
+int DingoSchema<std::vector<int32_t>>::EncodeIntList(
     const std::vector<int32_t>& data, Buf& buf) {
-  buf.WriteInt(data.size());
-
-  if (DINGO_LIKELY(IsLe())) {
-    for (const int32_t& value : data) {
-      uint32_t* v = (uint32_t*)&value;
-      buf.Write(*v >> 24);
-      buf.Write(*v >> 16);
-      buf.Write(*v >> 8);
-      buf.Write(*v);
-    }
-  } else {
-    for (const int32_t& value : data) {
-      uint32_t* v = (uint32_t*)&value;
-      buf.Write(*v);
-      buf.Write(*v >> 8);
-      buf.Write(*v >> 16);
-      buf.Write(*v >> 24);
-    }
+  if (delta_encoded_) {
+    return EncodeDeltaList(data, buf, IsLe());
   }
+  EncodePlainSeries(data, buf, IsLe());
+  return PlainSeriesLength<int32_t>(data.size());
 }
 
-void DingoSchema<std::vector<int32_t>>::DecodeIntList(
-    Buf& buf, std::vector<int32_t>& data) {
-  int size = buf.ReadInt();
-  data.resize(size);
-
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < size; ++i) {
-      uint32_t value = ((buf.Read() & 0xFF) << 24) |
-                       ((buf.Read() & 0xFF) << 16) |
-                       ((buf.Read() & 0xFF) << 8) | (buf.Read() & 0xFF);
-      data[i] = static_cast<int32_t>(value);
-    }
-
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint32_t value = (buf.Read() & 0xFF) | ((buf.Read() & 0xFF) << 8) |
-                       ((buf.Read() & 0xFF) << 16) |
-                       ((buf.Read() & 0xFF) << 24);
-      data[i] = static_cast<int32_t>(value);
-    }
-  }
+template <typename B>
+void DingoSchema<std::vector<int32_t>>::DecodeIntList(B& buf, std::vector<int32_t>& data) {
+  buf.Skip(DecodeSeriesList(buf, buf.ReadOffset(), data, IsLe()));
 }
 
-void DingoSchema<std::vector<int32_t>>::DecodeIntList(
-    Buf& buf, std::vector<int32_t>& data, int offset) {
-  int size = buf.ReadInt(offset);
-  data.resize(size);
-  offset += 4;
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < size; ++i) {
-      uint32_t value = ((buf.Read(offset++) & 0xFF) << 24) |
-                       ((buf.Read(offset++) & 0xFF) << 16) |
-                       ((buf.Read(offset++) & 0xFF) << 8) | (buf.Read(offset++) & 0xFF);
-      data[i] = static_cast<int32_t>(value);
-    }
-
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint32_t value = (buf.Read(offset++) & 0xFF) | ((buf.Read(offset++) & 0xFF) << 8) |
-                       ((buf.Read(offset++) & 0xFF) << 16) |
-                       ((buf.Read(offset++) & 0xFF) << 24);
-      data[i] = static_cast<int32_t>(value);
-    }
-  }
+template <typename B>
+void DingoSchema<std::vector<int32_t>>::DecodeIntList(B& buf, std::vector<int32_t>& data, int offset) {
+  DecodeSeriesList(buf, offset, data, IsLe());
+}
+
+void DingoSchema<std::vector<int32_t>>::DecodeRange(BufView& buf, int offset,
+                                              size_t begin, size_t end,
+                                              std::vector<int32_t>& data) {
+  DecodeSeriesListRange(buf, offset, begin, end, data, IsLe());
 }
 
 int DingoSchema<std::vector<int32_t>>::GetLengthForKey() {
@@ -104,16 +63,18 @@ int DingoSchema<std::vector<int32_t>>::GetLengthForValue() {
   return -1;
 }
 
-int DingoSchema<std::vector<int32_t>>::SkipKey(Buf&) {
+template <typename B>
+int DingoSchema<std::vector<int32_t>>::SkipKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
   return -1;
 }
 
-int DingoSchema<std::vector<int32_t>>::SkipValue(Buf& buf) {
-  int32_t size = buf.ReadInt() * 4;
-  buf.Skip(size);
+template <typename B>
+int DingoSchema<std::vector<int32_t>>::SkipValueImpl(B& buf) {
+  int len = SeriesListLength<int32_t>(buf, buf.ReadOffset());
+  buf.Skip(len);
 
-  return size + 4;
+  return len;
 }
 
 int DingoSchema<std::vector<int32_t>>::EncodeKey(const std::any&, Buf&) {
@@ -121,40 +82,106 @@ int DingoSchema<std::vector<int32_t>>::EncodeKey(const std::any&, Buf&) {
   return -1;
 }
 
-// {n:4byte}|{value: 4byte}*n
-int DingoSchema<std::vector<int32_t>>::EncodeValue(const std::any& data,
-                                                   Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+// {n:4byte}|{value: 4byte}*n, or series encoded as series_list.h describes.
+int DingoSchema<std::vector<int32_t>>::EncodeValueData(
+    const std::vector<int32_t>* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but no data in value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const std::vector<int32_t>&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
 
-    EncodeIntList(ref_data, buf);
-    return ref_data.size() * 4 + 4;
+    return EncodeIntList(ref_data, buf);
   }
 
   return 0;
 }
 
-std::any DingoSchema<std::vector<int32_t>>::DecodeKey(Buf&) {
+int DingoSchema<std::vector<int32_t>>::EncodeValue(const std::any& data,
+                                                   Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<int32_t>>(data), buf);
+}
+
+int DingoSchema<std::vector<int32_t>>::EncodeValueVariant(
+    const ColumnValue& data, Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<int32_t>>(data), buf);
+}
+
+int DingoSchema<std::vector<int32_t>>::EncodedValueLength(
+    const std::vector<int32_t>* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  if (!delta_encoded_) {
+    return PlainSeriesLength<int32_t>(data->size());
+  }
+  return DeltaListLength(*data, DeltaListFrame(*data));
+}
+
+int DingoSchema<std::vector<int32_t>>::GetEncodedValueLength(
+    const std::any& data) {
+  return EncodedValueLength(DataOf<std::vector<int32_t>>(data));
+}
+
+int DingoSchema<std::vector<int32_t>>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<std::vector<int32_t>>(data));
+}
+
+template <typename B>
+std::any DingoSchema<std::vector<int32_t>>::DecodeKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
 }
 
-std::any DingoSchema<std::vector<int32_t>>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<std::vector<int32_t>>::DecodeValueImpl(B& buf) {
   std::vector<int32_t> data;
   DecodeIntList(buf, data);
 
   return std::move(std::any(std::move(data)));
 }
 
-std::any DingoSchema<std::vector<int32_t>>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<std::vector<int32_t>>::DecodeValueImpl(B& buf, int offset) {
   std::vector<int32_t> data;
   DecodeIntList(buf, data, offset);
 
   return std::move(std::any(std::move(data)));
 }
 
+int DingoSchema<std::vector<int32_t>>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<std::vector<int32_t>>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<std::vector<int32_t>>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<std::vector<int32_t>>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<std::vector<int32_t>>::DecodeKey(Buf& buf) { return DecodeKeyImpl(buf); }
+std::any DingoSchema<std::vector<int32_t>>::DecodeKey(BufView& buf) { return DecodeKeyImpl(buf); }
+
+std::any DingoSchema<std::vector<int32_t>>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<std::vector<int32_t>>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<std::vector<int32_t>>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<std::vector<int32_t>>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<std::vector<int32_t>>::DecodeKey(BufView&, RowSink&, int) {
+  throw std::runtime_error("Unsupport encoding key list type");
+}
+
+void DingoSchema<std::vector<int32_t>>::DecodeValue(BufView& buf, int offset,
+                                                    RowSink& sink, int col) {
+  std::vector<int32_t> data;
+  sink.ReuseList(col, data);
+
+  DecodeIntList(buf, data, offset);
+
+  sink.OnInt32List(col, std::move(data));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -39,15 +39,58 @@ class DingoSchema<std::vector<int32_t>> : public BaseSchema {
 
   int EncodeKey(const std::any& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
+  int GetEncodedValueLength(const std::any& data) override;
+  int GetEncodedValueLengthVariant(const ColumnValue& data) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
 
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
+  // Write lists whose neighbouring elements are close as zigzag deltas bit
+  // packed, see series_list.h. Both forms are decoded whatever is set.
+  void SetDeltaEncoded(bool encoded) { delta_encoded_ = encoded; }
+  bool IsDeltaEncoded() const { return delta_encoded_; }
+
+  // Elements [begin, end) of the list value at offset, end clamped to the
+  // list size. A plain list is read in place, a delta encoded one is decoded whole.
+  void DecodeRange(BufView& buf, int offset, size_t begin, size_t end,
+                   std::vector<int32_t>& data);
+
  private:
-  void EncodeIntList(const std::vector<int32_t>& data, Buf& buf);
-  void DecodeIntList(Buf& buf, std::vector<int32_t>& data);
-  void DecodeIntList(Buf& buf, std::vector<int32_t>& data, int offset);
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeValueData(const std::vector<int32_t>* data, Buf& buf);
+  int EncodedValueLength(const std::vector<int32_t>* data);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
+  int EncodeIntList(const std::vector<int32_t>& data, Buf& buf);
+  template <typename B>
+  void DecodeIntList(B& buf, std::vector<int32_t>& data);
+  template <typename B>
+  void DecodeIntList(B& buf, std::vector<int32_t>& data, int offset);
+
+  bool delta_encoded_{false};
 };
 
 }  // namespace serialV2
@@ -16,9 +16,11 @@
 
 #include <any>
 #include <cstdint>
+#include <stdexcept>
 
 #include "serial/schema/dingo_schema.h"
 #include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/varint.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -27,62 +29,57 @@ constexpr int kDataLength = 4;
 constexpr int kLengthWithNull = kDataLength + 1;
 
 void DingoSchema<int32_t>::EncodeIntComparable(int32_t data, Buf& buf) {
-  uint32_t* i = (uint32_t*)&data;
-  if (DINGO_LIKELY(IsLe())) {
-    buf.Write(*i >> 24 ^ 0x80);
-    buf.Write(*i >> 16);
-    buf.Write(*i >> 8);
-    buf.Write(*i);
-  } else {
-    buf.Write(*i ^ 0x80);
-    buf.Write(*i >> 8);
-    buf.Write(*i >> 16);
-    buf.Write(*i >> 24);
-  }
+  buf.WriteIntWithFirstBitNegation(data);
 }
 
-int32_t DingoSchema<int32_t>::DecodeIntComparable(Buf& buf) {
-  uint32_t data;
-  if (DINGO_LIKELY(IsLe())) {
-    data = (((buf.Read() & 0xFF) ^ 0x80) << 24) | ((buf.Read() & 0xFF) << 16) |
-           ((buf.Read() & 0xFF) << 8) | (buf.Read() & 0xFF);
-  } else {
-    data = ((buf.Read() & 0xFF) ^ 0x80) | ((buf.Read() & 0xFF) << 8) |
-           ((buf.Read() & 0xFF) << 16) | ((buf.Read() & 0xFF) << 24);
+template <typename B>
+int32_t DingoSchema<int32_t>::DecodeIntComparable(B& buf) {
+  return buf.ReadIntWithFirstBitNegation();
+}
+
+int DingoSchema<int32_t>::EncodeIntNotComparable(int32_t data, Buf& buf) {
+  if (varint_) {
+    return WriteVarint(buf, ZigZagEncode32(data));
   }
 
-  return static_cast<int32_t>(data);
+  buf.WriteInt(data);
+  return kDataLength;
 }
 
-void DingoSchema<int32_t>::EncodeIntNotComparable(int32_t data, Buf& buf) {
-  uint32_t* i = (uint32_t*)&data;
-  if (DINGO_LIKELY(IsLe())) {
-    buf.Write(*i >> 24);
-    buf.Write(*i >> 16);
-    buf.Write(*i >> 8);
-    buf.Write(*i);
-  } else {
-    buf.Write(*i);
-    buf.Write(*i >> 8);
-    buf.Write(*i >> 16);
-    buf.Write(*i >> 24);
+template <typename B>
+int DingoSchema<int32_t>::ReadVarintValue(B& buf, size_t offset, int32_t& value) {
+  uint64_t raw = 0;
+  int len = offset < buf.Size() ? ReadVarint(buf.Data() + offset,
+                                             buf.Size() - offset, raw,
+                                             kMaxVarint32Length)
+                                : 0;
+  if (DINGO_UNLIKELY(len == 0)) {
+    throw std::runtime_error("Out of range.");
   }
+
+  value = ZigZagDecode32(static_cast<uint32_t>(raw));
+  return len;
 }
 
-int32_t DingoSchema<int32_t>::DecodeIntNotComparable(Buf& buf) {
-  uint32_t data;
-  if (DINGO_LIKELY(IsLe())) {
-    data = ((buf.Read() & 0xFF) << 24) | ((buf.Read() & 0xFF) << 16) |
-           ((buf.Read() & 0xFF) << 8) | (buf.Read() & 0xFF);
-  } else {
-    data = (buf.Read() & 0xFF) | ((buf.Read() & 0xFF) << 8) |
-           ((buf.Read() & 0xFF) << 16) | ((buf.Read() & 0xFF) << 24);
+template <typename B>
+int32_t DingoSchema<int32_t>::DecodeIntNotComparable(B& buf) {
+  if (varint_) {
+    int32_t value;
+    buf.Skip(ReadVarintValue(buf, buf.ReadOffset(), value));
+    return value;
   }
 
-  return static_cast<int32_t>(data);
+  return buf.ReadInt();
 }
 
-int32_t DingoSchema<int32_t>::DecodeIntNotComparable(Buf& buf, int offset) {
+template <typename B>
+int32_t DingoSchema<int32_t>::DecodeIntNotComparable(B& buf, int offset) {
+  if (varint_) {
+    int32_t value;
+    ReadVarintValue(buf, offset, value);
+    return value;
+  }
+
   return static_cast<int32_t>(buf.ReadInt(offset));
 }
 
@@ -94,28 +91,40 @@ inline int DingoSchema<int32_t>::GetLengthForKey() {
   }
 }
 
-inline int DingoSchema<int32_t>::GetLengthForValue() { return kDataLength; }
+inline int DingoSchema<int32_t>::GetLengthForValue() {
+  // a varint has no fixed length.
+  return varint_ ? 0 : kDataLength;
+}
 
-inline int DingoSchema<int32_t>::SkipKey(Buf& buf) {
+template <typename B>
+int DingoSchema<int32_t>::SkipKeyImpl(B& buf) {
   int len = GetLengthForKey();
   buf.Skip(len);
   return len;
 }
 
-inline int DingoSchema<int32_t>::SkipValue(Buf& buf) {
+template <typename B>
+int DingoSchema<int32_t>::SkipValueImpl(B& buf) {
+  if (varint_) {
+    int32_t value;
+    int len = ReadVarintValue(buf, buf.ReadOffset(), value);
+    buf.Skip(len);
+    return len;
+  }
+
   buf.Skip(kDataLength);
   return kDataLength;
 }
 
-int DingoSchema<int32_t>::EncodeKey(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<int32_t>::EncodeKeyData(const int32_t* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
   if (AllowNull()) {
-    if (data.has_value()) {
+    if (data != nullptr) {
       buf.Write(k_not_null);
-      const auto& ref_data = std::any_cast<const int32_t&>(data);
+      const auto& ref_data = *data;
       EncodeIntComparable(ref_data, buf);
     } else {
       buf.Write(k_null);
@@ -124,29 +133,65 @@ int DingoSchema<int32_t>::EncodeKey(const std::any& data, Buf& buf) {
 
     return kLengthWithNull;
   } else {
-    const auto& ref_data = std::any_cast<const int32_t&>(data);
+    const auto& ref_data = *data;
     EncodeIntComparable(ref_data, buf);
 
     return kDataLength;
   }
 }
 
+int DingoSchema<int32_t>::EncodeKey(const std::any& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<int32_t>(data), buf));
+}
+
+int DingoSchema<int32_t>::EncodeKeyVariant(const ColumnValue& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<int32_t>(data), buf));
+}
+
 // {value: 4byte}
-int DingoSchema<int32_t>::EncodeValue(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<int32_t>::EncodeValueData(const int32_t* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const int32_t&>(data);
-    EncodeIntNotComparable(ref_data, buf);
-    return kDataLength;
+  if (data != nullptr) {
+    const auto& ref_data = *data;
+    return EncodeIntNotComparable(ref_data, buf);
   }
 
   return 0;
 }
 
-std::any DingoSchema<int32_t>::DecodeKey(Buf& buf) {
+int DingoSchema<int32_t>::EncodeValue(const std::any& data, Buf& buf) {
+  return EncodeValueData(DataOf<int32_t>(data), buf);
+}
+
+int DingoSchema<int32_t>::EncodeValueVariant(const ColumnValue& data,
+                                             Buf& buf) {
+  return EncodeValueData(DataOf<int32_t>(data), buf);
+}
+
+int DingoSchema<int32_t>::EncodedValueLength(const int32_t* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  if (varint_) {
+    return VarintLength(ZigZagEncode32(*data));
+  }
+  return kDataLength;
+}
+
+int DingoSchema<int32_t>::GetEncodedValueLength(const std::any& data) {
+  return EncodedValueLength(DataOf<int32_t>(data));
+}
+
+int DingoSchema<int32_t>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<int32_t>(data));
+}
+
+template <typename B>
+std::any DingoSchema<int32_t>::DecodeKeyImpl(B& buf) {
   if (AllowNull()) {
     if (buf.Read() == k_null) {
       buf.Skip(kDataLength);
@@ -157,14 +202,75 @@ std::any DingoSchema<int32_t>::DecodeKey(Buf& buf) {
   return std::any(DecodeIntComparable(buf));
 }
 
-inline std::any DingoSchema<int32_t>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<int32_t>::DecodeValueImpl(B& buf) {
   return std::any(DecodeIntNotComparable(buf));
 }
 
-inline std::any DingoSchema<int32_t>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<int32_t>::DecodeValueImpl(B& buf, int offset) {
   return std::any(DecodeIntNotComparable(buf, offset));
 }
 
+int DingoSchema<int32_t>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<int32_t>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<int32_t>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<int32_t>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<int32_t>::DecodeKey(Buf& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+std::any DingoSchema<int32_t>::DecodeKey(BufView& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+
+std::any DingoSchema<int32_t>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<int32_t>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<int32_t>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<int32_t>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<int32_t>::DecodeKeyImpl(BufView& buf, RowSink& sink, int col) {
+  if (AllowNull()) {
+    if (buf.Read() == k_null) {
+      buf.Skip(kDataLength);
+      sink.OnNull(col);
+      return;
+    }
+  }
+
+  sink.OnInt32(col, DecodeIntComparable(buf));
+}
+
+void DingoSchema<int32_t>::DecodeKey(BufView& buf, RowSink& sink, int col) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    DecodeKeyImpl(key, sink, col);
+    return;
+  }
+  DecodeKeyImpl(buf, sink, col);
+}
+
+void DingoSchema<int32_t>::DecodeValue(BufView& buf, int offset, RowSink& sink,
+                                       int col) {
+  sink.OnInt32(col, DecodeIntNotComparable(buf, offset));
+}
 
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
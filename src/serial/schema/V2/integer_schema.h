@@ -37,19 +37,65 @@ class DingoSchema<int32_t> : public BaseSchema {
   int SkipValue(Buf& buf) override;
 
   int EncodeKey(const std::any& data, Buf& buf) override;
+  int EncodeKeyVariant(const ColumnValue& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
+  int GetEncodedValueLength(const std::any& data) override;
+  int GetEncodedValueLengthVariant(const ColumnValue& data) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
 
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
+  // Store values as zigzag LEB128 varints instead of 4 fixed bytes, the key
+  // encoding is unchanged. Writer and reader schemas must agree.
+  void SetVarint(bool varint) { varint_ = varint; }
+  bool IsVarint() const { return varint_; }
+
  private:
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeKeyData(const int32_t* data, Buf& buf);
+  int EncodeValueData(const int32_t* data, Buf& buf);
+  int EncodedValueLength(const int32_t* data);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  void DecodeKeyImpl(BufView& buf, RowSink& sink, int col);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
   void EncodeIntComparable(int32_t data, Buf& buf);
-  int32_t DecodeIntComparable(Buf& buf);
+  template <typename B>
+  int32_t DecodeIntComparable(B& buf);
+
+  int EncodeIntNotComparable(int32_t data, Buf& buf);
+  template <typename B>
+  int32_t DecodeIntNotComparable(B& buf);
+  template <typename B>
+  int32_t DecodeIntNotComparable(B& buf, int offset);
+
+  // length of the varint at offset, value is set from it.
+  template <typename B>
+  static int ReadVarintValue(B& buf, size_t offset, int32_t& value);
 
-  void EncodeIntNotComparable(int32_t data, Buf& buf);
-  int32_t DecodeIntNotComparable(Buf& buf);
-  int32_t DecodeIntNotComparable(Buf& buf, int offset);
+  bool varint_{false};
 };
 
 }  // namespace serialV2
@@ -15,98 +15,39 @@
 #include "long_list_schema.h"
 
 #include <cstdint>
+#include <stdexcept>
 #include <utility>
 
+#include "serial/utils/V2/byte_swap.h"
 #include "serial/utils/V2/compiler.h"
+#include "serial/schema/V2/series_list.h"
 
 namespace dingodb {
 namespace serialV2 {
 
-void DingoSchema<std::vector<int64_t>>::EncodeLongList(
+int DingoSchema<std::vector<int64_t>>::EncodeLongList(
     const std::vector<int64_t>& data, Buf& buf) {
-  buf.WriteInt(data.size());
-  if (DINGO_LIKELY(IsLe())) {
-    for (const int64_t& value : data) {
-      uint64_t* l = (uint64_t*)&value;
-      buf.Write(*l >> 56);
-      buf.Write(*l >> 48);
-      buf.Write(*l >> 40);
-      buf.Write(*l >> 32);
-      buf.Write(*l >> 24);
-      buf.Write(*l >> 16);
-      buf.Write(*l >> 8);
-      buf.Write(*l);
-    }
-  } else {
-    for (const int64_t& value : data) {
-      uint64_t* l = (uint64_t*)&value;
-      buf.Write(*l);
-      buf.Write(*l >> 8);
-      buf.Write(*l >> 16);
-      buf.Write(*l >> 24);
-      buf.Write(*l >> 32);
-      buf.Write(*l >> 40);
-      buf.Write(*l >> 48);
-      buf.Write(*l >> 56);
-    }
+  if (delta_encoded_) {
+    return EncodeDeltaList(data, buf, IsLe());
   }
+  EncodePlainSeries(data, buf, IsLe());
+  return PlainSeriesLength<int64_t>(data.size());
 }
 
-void DingoSchema<std::vector<int64_t>>::DecodeLongList(
-    Buf& buf, std::vector<int64_t>& data) const {
-  int size = buf.ReadInt();
-  data.resize(size);
-
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < size; ++i) {
-      uint64_t value = buf.Read() & 0xFF;
-      for (int j = 0; j < 7; ++j) {
-        value <<= 8;
-        value |= buf.Read() & 0xFF;
-      }
-
-      data[i] = static_cast<int64_t>(value);
-    }
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint64_t value = buf.Read() & 0xFF;
-
-      for (int j = 1; j < 8; ++j) {
-        value |= (((uint64_t)buf.Read() & 0xFF) << (8 * j));
-      }
+template <typename B>
+void DingoSchema<std::vector<int64_t>>::DecodeLongList(B& buf, std::vector<int64_t>& data) const {
+  buf.Skip(DecodeSeriesList(buf, buf.ReadOffset(), data, IsLe()));
+}
 
-      data[i] = static_cast<int64_t>(value);
-    }
-  }
+template <typename B>
+void DingoSchema<std::vector<int64_t>>::DecodeLongList(B& buf, std::vector<int64_t>& data, int offset) const {
+  DecodeSeriesList(buf, offset, data, IsLe());
 }
 
-void DingoSchema<std::vector<int64_t>>::DecodeLongList(
-    Buf& buf, std::vector<int64_t>& data, int offset) const {
-  int size = buf.ReadInt();
-  data.resize(size);
-  offset += 4;
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < size; ++i) {
-      uint64_t value = buf.Read(offset++) & 0xFF;
-
-      for (int j = 0; j < 7; ++j) {
-        value <<= 8;
-        value |= buf.Read(offset++) & 0xFF;
-      }
-
-      data[i] = static_cast<int64_t>(value);
-    }
-  } else {
-    for (int i = 0; i < size; ++i) {
-      uint64_t value = buf.Read(offset++) & 0xFF;
-
-      for (int j = 1; j < 8; ++j) {
-        value |= (((uint64_t)buf.Read(offset++) & 0xFF) << (8 * j));
-      }
-
-      data[i] = static_cast<int64_t>(value);
-    }
-  }
+void DingoSchema<std::vector<int64_t>>::DecodeRange(BufView& buf, int offset,
+                                              size_t begin, size_t end,
+                                              std::vector<int64_t>& data) {
+  DecodeSeriesListRange(buf, offset, begin, end, data, IsLe());
 }
 
 int DingoSchema<std::vector<int64_t>>::GetLengthForKey() {
@@ -119,16 +60,18 @@ int DingoSchema<std::vector<int64_t>>::GetLengthForValue() {
   return -1;
 }
 
-int DingoSchema<std::vector<int64_t>>::SkipKey(Buf&) {
+template <typename B>
+int DingoSchema<std::vector<int64_t>>::SkipKeyImpl(B&) {
   throw std::runtime_error("Unsupport encode key list type");
   return -1;
 }
 
-int DingoSchema<std::vector<int64_t>>::SkipValue(Buf& buf) {
-  int size = buf.ReadInt() * 8;
-  buf.Skip(size);
+template <typename B>
+int DingoSchema<std::vector<int64_t>>::SkipValueImpl(B& buf) {
+  int len = SeriesListLength<int64_t>(buf, buf.ReadOffset());
+  buf.Skip(len);
 
-  return size + 4;
+  return len;
 }
 
 int DingoSchema<std::vector<int64_t>>::EncodeKey(const std::any&, Buf&) {
@@ -136,43 +79,108 @@ int DingoSchema<std::vector<int64_t>>::EncodeKey(const std::any&, Buf&) {
   return -1;
 }
 
-// {n:4byte}|{value: 8byte}*n
-int DingoSchema<std::vector<int64_t>>::EncodeValue(const std::any& data,
-                                                   Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+// {n:4byte}|{value: 8byte}*n, or series encoded as series_list.h describes.
+int DingoSchema<std::vector<int64_t>>::EncodeValueData(
+    const std::vector<int64_t>* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but no data in value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const std::vector<int64_t>&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
 
     // if (!ref_data.empty()) {
-    EncodeLongList(ref_data, buf);
-
-    return ref_data.size() * 8 + 4;
+    return EncodeLongList(ref_data, buf);
     //}
   }
 
   return 0;
 }
 
-std::any DingoSchema<std::vector<int64_t>>::DecodeKey(Buf&) {
+int DingoSchema<std::vector<int64_t>>::EncodeValue(const std::any& data,
+                                                   Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<int64_t>>(data), buf);
+}
+
+int DingoSchema<std::vector<int64_t>>::EncodeValueVariant(
+    const ColumnValue& data, Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<int64_t>>(data), buf);
+}
+
+int DingoSchema<std::vector<int64_t>>::EncodedValueLength(
+    const std::vector<int64_t>* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  if (!delta_encoded_) {
+    return PlainSeriesLength<int64_t>(data->size());
+  }
+  return DeltaListLength(*data, DeltaListFrame(*data));
+}
+
+int DingoSchema<std::vector<int64_t>>::GetEncodedValueLength(
+    const std::any& data) {
+  return EncodedValueLength(DataOf<std::vector<int64_t>>(data));
+}
+
+int DingoSchema<std::vector<int64_t>>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<std::vector<int64_t>>(data));
+}
+
+template <typename B>
+std::any DingoSchema<std::vector<int64_t>>::DecodeKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
 }
 
-std::any DingoSchema<std::vector<int64_t>>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<std::vector<int64_t>>::DecodeValueImpl(B& buf) {
   std::vector<int64_t> data;
   DecodeLongList(buf, data);
 
   return std::move(std::any(std::move(data)));
 }
 
-std::any DingoSchema<std::vector<int64_t>>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<std::vector<int64_t>>::DecodeValueImpl(B& buf, int offset) {
   std::vector<int64_t> data;
   DecodeLongList(buf, data, offset);
 
   return std::move(std::any(std::move(data)));
 }
 
+int DingoSchema<std::vector<int64_t>>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<std::vector<int64_t>>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<std::vector<int64_t>>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<std::vector<int64_t>>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<std::vector<int64_t>>::DecodeKey(Buf& buf) { return DecodeKeyImpl(buf); }
+std::any DingoSchema<std::vector<int64_t>>::DecodeKey(BufView& buf) { return DecodeKeyImpl(buf); }
+
+std::any DingoSchema<std::vector<int64_t>>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<std::vector<int64_t>>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<std::vector<int64_t>>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<std::vector<int64_t>>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<std::vector<int64_t>>::DecodeKey(BufView&, RowSink&, int) {
+  throw std::runtime_error("Unsupport encoding key list type");
+}
+
+void DingoSchema<std::vector<int64_t>>::DecodeValue(BufView& buf, int offset,
+                                                    RowSink& sink, int col) {
+  std::vector<int64_t> data;
+  sink.ReuseList(col, data);
+
+  DecodeLongList(buf, data, offset);
+
+  sink.OnInt64List(col, std::move(data));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
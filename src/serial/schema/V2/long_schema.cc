@@ -15,8 +15,10 @@
 #include "long_schema.h"
 
 #include <cstdint>
+#include <stdexcept>
 
 #include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/varint.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -25,84 +27,56 @@ constexpr int kDataLength = 8;
 constexpr int kDataLengthWithNull = kDataLength + 1;
 
 void DingoSchema<int64_t>::EncodeLongComparable(int64_t data, Buf& buf) {
-  uint64_t* l = (uint64_t*)&data;
-  if (DINGO_LIKELY(IsLe())) {
-    buf.Write(*l >> 56 ^ 0x80);
-    buf.Write(*l >> 48);
-    buf.Write(*l >> 40);
-    buf.Write(*l >> 32);
-    buf.Write(*l >> 24);
-    buf.Write(*l >> 16);
-    buf.Write(*l >> 8);
-    buf.Write(*l);
-  } else {
-    buf.Write(*l ^ 0x80);
-    buf.Write(*l >> 8);
-    buf.Write(*l >> 16);
-    buf.Write(*l >> 24);
-    buf.Write(*l >> 32);
-    buf.Write(*l >> 40);
-    buf.Write(*l >> 48);
-    buf.Write(*l >> 56);
-  }
-}
-
-int64_t DingoSchema<int64_t>::DecodeLongComparable(Buf& buf) {
-  uint64_t l = (buf.Read() & 0xFF) ^ 0x80;
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < 7; i++) {
-      l <<= 8;
-      l |= buf.Read() & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 8; i++) {
-      l |= (((uint64_t)buf.Read() & 0xFF) << (8 * i));
-    }
+  buf.WriteLongWithFirstBitNegation(data);
+}
+
+template <typename B>
+int64_t DingoSchema<int64_t>::DecodeLongComparable(B& buf) {
+  return buf.ReadLongWithFirstBitNegation();
+}
+
+int DingoSchema<int64_t>::EncodeLongNotComparable(int64_t data, Buf& buf) {
+  if (varint_) {
+    return WriteVarint(buf, ZigZagEncode64(data));
   }
 
-  return static_cast<int64_t>(l);
+  buf.WriteLong(data);
+  return kDataLength;
 }
 
-void DingoSchema<int64_t>::EncodeLongNotComparable(int64_t data, Buf& buf) {
-  uint64_t* l = (uint64_t*)&data;
-  if (DINGO_LIKELY(IsLe())) {
-    buf.Write(*l >> 56);
-    buf.Write(*l >> 48);
-    buf.Write(*l >> 40);
-    buf.Write(*l >> 32);
-    buf.Write(*l >> 24);
-    buf.Write(*l >> 16);
-    buf.Write(*l >> 8);
-    buf.Write(*l);
-  } else {
-    buf.Write(*l);
-    buf.Write(*l >> 8);
-    buf.Write(*l >> 16);
-    buf.Write(*l >> 24);
-    buf.Write(*l >> 32);
-    buf.Write(*l >> 40);
-    buf.Write(*l >> 48);
-    buf.Write(*l >> 56);
-  }
-}
-
-int64_t DingoSchema<int64_t>::DecodeLongNotComparable(Buf& buf) {
-  uint64_t l = buf.Read() & 0xFF;
-  if (DINGO_LIKELY(IsLe())) {
-    for (int i = 0; i < 7; i++) {
-      l <<= 8;
-      l |= buf.Read() & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 8; i++) {
-      l |= (((uint64_t)buf.Read() & 0xFF) << (8 * i));
-    }
+template <typename B>
+int DingoSchema<int64_t>::ReadVarintValue(B& buf, size_t offset, int64_t& value) {
+  uint64_t raw = 0;
+  int len = offset < buf.Size() ? ReadVarint(buf.Data() + offset,
+                                             buf.Size() - offset, raw,
+                                             kMaxVarint64Length)
+                                : 0;
+  if (DINGO_UNLIKELY(len == 0)) {
+    throw std::runtime_error("Out of range.");
   }
 
-  return static_cast<int64_t>(l);
+  value = ZigZagDecode64(static_cast<uint64_t>(raw));
+  return len;
 }
 
-int64_t DingoSchema<int64_t>::DecodeLongNotComparable(Buf& buf, int offset) {
+template <typename B>
+int64_t DingoSchema<int64_t>::DecodeLongNotComparable(B& buf) {
+  if (varint_) {
+    int64_t value;
+    buf.Skip(ReadVarintValue(buf, buf.ReadOffset(), value));
+    return value;
+  }
+
+  return buf.ReadLong();
+}
+
+template <typename B>
+int64_t DingoSchema<int64_t>::DecodeLongNotComparable(B& buf, int offset) {
+  if (varint_) {
+    int64_t value;
+    ReadVarintValue(buf, offset, value);
+    return value;
+  }
 
   return static_cast<int64_t>(buf.ReadLong(offset));
 }
@@ -115,28 +89,40 @@ int DingoSchema<int64_t>::GetLengthForKey() {
   }
 }
 
-int DingoSchema<int64_t>::GetLengthForValue() { return kDataLength; }
+int DingoSchema<int64_t>::GetLengthForValue() {
+  // a varint has no fixed length.
+  return varint_ ? 0 : kDataLength;
+}
 
-int DingoSchema<int64_t>::SkipKey(Buf& buf) {
+template <typename B>
+int DingoSchema<int64_t>::SkipKeyImpl(B& buf) {
   int len = GetLengthForKey();
   buf.Skip(len);
   return len;
 }
 
-int DingoSchema<int64_t>::SkipValue(Buf& buf) {
+template <typename B>
+int DingoSchema<int64_t>::SkipValueImpl(B& buf) {
+  if (varint_) {
+    int64_t value;
+    int len = ReadVarintValue(buf, buf.ReadOffset(), value);
+    buf.Skip(len);
+    return len;
+  }
+
   buf.Skip(kDataLength);
   return kDataLength;
 }
 
-int DingoSchema<int64_t>::EncodeKey(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<int64_t>::EncodeKeyData(const int64_t* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
   if (AllowNull()) {
-    if (data.has_value()) {
+    if (data != nullptr) {
       buf.Write(k_not_null);
-      const auto& ref_data = std::any_cast<const int64_t&>(data);
+      const auto& ref_data = *data;
       EncodeLongComparable(ref_data, buf);
     } else {
       buf.Write(k_null);
@@ -145,29 +131,65 @@ int DingoSchema<int64_t>::EncodeKey(const std::any& data, Buf& buf) {
 
     return kDataLengthWithNull;
   } else {
-    const auto& ref_data = std::any_cast<const int64_t&>(data);
+    const auto& ref_data = *data;
     EncodeLongComparable(ref_data, buf);
 
     return kDataLength;
   }
 }
 
+int DingoSchema<int64_t>::EncodeKey(const std::any& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<int64_t>(data), buf));
+}
+
+int DingoSchema<int64_t>::EncodeKeyVariant(const ColumnValue& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<int64_t>(data), buf));
+}
+
 // {value: 8byte}
-int DingoSchema<int64_t>::EncodeValue(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<int64_t>::EncodeValueData(const int64_t* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const int64_t&>(data);
-    EncodeLongNotComparable(ref_data, buf);
-    return kDataLength;
+  if (data != nullptr) {
+    const auto& ref_data = *data;
+    return EncodeLongNotComparable(ref_data, buf);
   }
 
   return 0;
 }
 
-std::any DingoSchema<int64_t>::DecodeKey(Buf& buf) {
+int DingoSchema<int64_t>::EncodeValue(const std::any& data, Buf& buf) {
+  return EncodeValueData(DataOf<int64_t>(data), buf);
+}
+
+int DingoSchema<int64_t>::EncodeValueVariant(const ColumnValue& data,
+                                             Buf& buf) {
+  return EncodeValueData(DataOf<int64_t>(data), buf);
+}
+
+int DingoSchema<int64_t>::EncodedValueLength(const int64_t* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  if (varint_) {
+    return VarintLength(ZigZagEncode64(*data));
+  }
+  return kDataLength;
+}
+
+int DingoSchema<int64_t>::GetEncodedValueLength(const std::any& data) {
+  return EncodedValueLength(DataOf<int64_t>(data));
+}
+
+int DingoSchema<int64_t>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<int64_t>(data));
+}
+
+template <typename B>
+std::any DingoSchema<int64_t>::DecodeKeyImpl(B& buf) {
   if (AllowNull()) {
     if (buf.Read() == k_null) {
       buf.Skip(kDataLength);
@@ -178,13 +200,75 @@ std::any DingoSchema<int64_t>::DecodeKey(Buf& buf) {
   return std::any(DecodeLongComparable(buf));
 }
 
-inline std::any DingoSchema<int64_t>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<int64_t>::DecodeValueImpl(B& buf) {
   return std::any(DecodeLongNotComparable(buf));
 }
 
-inline std::any DingoSchema<int64_t>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<int64_t>::DecodeValueImpl(B& buf, int offset) {
   return std::any(DecodeLongNotComparable(buf, offset));
 }
 
+int DingoSchema<int64_t>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<int64_t>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<int64_t>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<int64_t>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<int64_t>::DecodeKey(Buf& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+std::any DingoSchema<int64_t>::DecodeKey(BufView& buf) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+
+std::any DingoSchema<int64_t>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<int64_t>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<int64_t>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<int64_t>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<int64_t>::DecodeKeyImpl(BufView& buf, RowSink& sink, int col) {
+  if (AllowNull()) {
+    if (buf.Read() == k_null) {
+      buf.Skip(kDataLength);
+      sink.OnNull(col);
+      return;
+    }
+  }
+
+  sink.OnInt64(col, DecodeLongComparable(buf));
+}
+
+void DingoSchema<int64_t>::DecodeKey(BufView& buf, RowSink& sink, int col) {
+  if (IsDescending()) {
+    char bytes[kDataLength + 1];
+    BufView key = AscendingKey(buf, GetLengthForKey(), bytes);
+    DecodeKeyImpl(key, sink, col);
+    return;
+  }
+  DecodeKeyImpl(buf, sink, col);
+}
+
+void DingoSchema<int64_t>::DecodeValue(BufView& buf, int offset, RowSink& sink,
+                                       int col) {
+  sink.OnInt64(col, DecodeLongNotComparable(buf, offset));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ROW_SINK_V2_H_
+#define DINGO_SERIAL_ROW_SINK_V2_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Receiver of typed column values, for decoding straight into the caller's
+ * own representation without std::any.
+ *
+ * col is the output column the value belongs to. A string_view is only valid
+ * during the call, it may point into the decoded key/value bytes or into a
+ * temporary. Lists are handed over and may be moved from.
+ *
+ * Before a list of col is decoded the sink is asked for storage to decode it
+ * into, a sink keeping its rows gives back the list of the row before so that
+ * its capacity is reused. The default gives none.
+ */
+class RowSink {
+ public:
+  virtual ~RowSink() = default;
+
+  virtual void OnNull(int col) = 0;
+
+  virtual void OnBool(int col, bool value) = 0;
+  virtual void OnInt32(int col, int32_t value) = 0;
+  virtual void OnInt64(int col, int64_t value) = 0;
+  virtual void OnFloat(int col, float value) = 0;
+  virtual void OnDouble(int col, double value) = 0;
+  virtual void OnString(int col, std::string_view value) = 0;
+
+  virtual void OnBoolList(int col, std::vector<bool>&& value) = 0;
+  virtual void OnInt32List(int col, std::vector<int32_t>&& value) = 0;
+  virtual void OnInt64List(int col, std::vector<int64_t>&& value) = 0;
+  virtual void OnFloatList(int col, std::vector<float>&& value) = 0;
+  virtual void OnDoubleList(int col, std::vector<double>&& value) = 0;
+  virtual void OnStringList(int col, std::vector<std::string>&& value) = 0;
+
+  virtual void ReuseList(int /*col*/, std::vector<bool>& /*list*/) {}
+  virtual void ReuseList(int /*col*/, std::vector<int32_t>& /*list*/) {}
+  virtual void ReuseList(int /*col*/, std::vector<int64_t>& /*list*/) {}
+  virtual void ReuseList(int /*col*/, std::vector<float>& /*list*/) {}
+  virtual void ReuseList(int /*col*/, std::vector<double>& /*list*/) {}
+  virtual void ReuseList(int /*col*/, std::vector<std::string>& /*list*/) {}
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,294 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_SERIES_LIST_V2_H_
+#define DINGO_SERIAL_SERIES_LIST_V2_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/byte_swap.h"
+#include "serial/utils/V2/compiler.h"
+#include "serial/utils/V2/series_codec.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * The int, long and double list values, plain or series encoded:
+ *
+ *   plain:  {n: 4byte} | {element}*n
+ *   delta:  {n | 0x80000000: 4byte} | {kDelta: 1byte} | {width: 1byte} |
+ *           {first: element} | {base: element} | {packed deltas}
+ *   xor:    {n | 0x80000000: 4byte} | {kXor: 1byte} | {bytes: 4byte} |
+ *           {bytes of xor stream}
+ *
+ * An encoded list is only written when it is smaller than the plain one, so
+ * short and random lists stay plain. The width of a delta list is at least 1,
+ * its packed deltas bound n by the bytes of the value.
+ */
+constexpr uint32_t kSeriesFlag = 0x80000000;
+
+template <typename T>
+inline void StoreSeriesWord(Buf& buf, T value) {
+  if constexpr (sizeof(T) == 4) {
+    buf.WriteInt(static_cast<int32_t>(value));
+  } else {
+    buf.WriteLong(static_cast<int64_t>(value));
+  }
+}
+
+template <typename T, typename B>
+inline T LoadSeriesWord(B& buf, size_t pos) {
+  if constexpr (sizeof(T) == 4) {
+    return static_cast<T>(buf.ReadInt(pos));
+  } else {
+    return static_cast<T>(buf.ReadLong(pos));
+  }
+}
+
+inline void CopySeriesWords(char* dst, const char* src, size_t count,
+                            size_t width, bool swap) {
+  if (width == 4) {
+    CopyWords32(dst, src, count, swap);
+  } else {
+    CopyWords64(dst, src, count, swap);
+  }
+}
+
+template <typename T>
+inline size_t PlainSeriesLength(size_t size) {
+  return 4 + size * sizeof(T);
+}
+
+// The frame of a delta list of data, width 0 when it is written plain.
+template <typename T>
+inline DeltaFrame DeltaListFrame(const std::vector<T>& data) {
+  if (data.size() < 2) {
+    return DeltaFrame();
+  }
+  DeltaFrame frame = PlanDeltas(data.data(), data.size());
+  frame.width = std::max(frame.width, 1);
+  size_t length = 4 + 2 + 2 * sizeof(T) +
+                  PackedDeltasSize(data.size(), frame.width);
+  if (length >= PlainSeriesLength<T>(data.size())) {
+    frame.width = 0;
+  }
+  return frame;
+}
+
+template <typename T>
+inline size_t DeltaListLength(const std::vector<T>& data,
+                              const DeltaFrame& frame) {
+  if (frame.width == 0) {
+    return PlainSeriesLength<T>(data.size());
+  }
+  return 4 + 2 + 2 * sizeof(T) + PackedDeltasSize(data.size(), frame.width);
+}
+
+// Bytes of the xor stream of data, 0 when it is written plain.
+inline size_t XorListStreamSize(const std::vector<double>& data) {
+  if (data.size() < 2) {
+    return 0;
+  }
+  size_t bytes = XorEncodedSize(data.data(), data.size());
+  return 4 + 1 + 4 + bytes < PlainSeriesLength<double>(data.size()) ? bytes
+                                                                     : 0;
+}
+
+inline size_t XorListLength(const std::vector<double>& data, size_t bytes) {
+  return bytes == 0 ? PlainSeriesLength<double>(data.size()) : 4 + 1 + 4 + bytes;
+}
+
+template <typename T>
+inline void EncodePlainSeries(const std::vector<T>& data, Buf& buf, bool le) {
+  buf.WriteInt(data.size());
+  size_t start = buf.Size();
+  buf.Enlarge(data.size() * sizeof(T));
+  CopySeriesWords(buf.Data() + start, reinterpret_cast<const char*>(data.data()),
+                  data.size(), sizeof(T), le);
+}
+
+// Returns the bytes written.
+template <typename T>
+inline int EncodeDeltaList(const std::vector<T>& data, Buf& buf, bool le) {
+  DeltaFrame frame = DeltaListFrame(data);
+  if (frame.width == 0) {
+    EncodePlainSeries(data, buf, le);
+    return PlainSeriesLength<T>(data.size());
+  }
+  size_t begin = buf.Size();
+  buf.WriteInt(data.size() | kSeriesFlag);
+  buf.Write(static_cast<uint8_t>(SeriesEncoding::kDelta));
+  buf.Write(static_cast<uint8_t>(frame.width));
+  StoreSeriesWord(buf, data[0]);
+  StoreSeriesWord(buf, static_cast<T>(frame.base));
+  size_t start = buf.Size();
+  size_t packed = PackedDeltasSize(data.size(), frame.width);
+  buf.Enlarge(packed);
+  PackDeltas(data.data(), data.size(), frame,
+             reinterpret_cast<uint8_t*>(buf.Data() + start));
+  return buf.Size() - begin;
+}
+
+inline int EncodeXorList(const std::vector<double>& data, Buf& buf, bool le) {
+  size_t bytes = XorListStreamSize(data);
+  if (bytes == 0) {
+    EncodePlainSeries(data, buf, le);
+    return PlainSeriesLength<double>(data.size());
+  }
+  buf.WriteInt(data.size() | kSeriesFlag);
+  buf.Write(static_cast<uint8_t>(SeriesEncoding::kXor));
+  buf.WriteInt(bytes);
+  size_t start = buf.Size();
+  buf.Enlarge(bytes);
+  XorEncode(data.data(), data.size(),
+            reinterpret_cast<uint8_t*>(buf.Data() + start));
+  return XorListLength(data, bytes);
+}
+
+// Decode the list at offset of buf in any of its forms into data, returns its
+// length. Integer lists may be delta encoded, double ones xor encoded.
+template <typename T, typename B>
+int DecodeSeriesList(B& buf, size_t offset, std::vector<T>& data, bool le) {
+  constexpr SeriesEncoding encoding = std::is_floating_point_v<T>
+                                          ? SeriesEncoding::kXor
+                                          : SeriesEncoding::kDelta;
+  if (DINGO_UNLIKELY(buf.Size() < offset + 4)) {
+    throw std::runtime_error("Out of range.");
+  }
+  uint32_t raw = buf.ReadInt(offset);
+  size_t size = raw & ~kSeriesFlag;
+  size_t pos = offset + 4;
+  if (!(raw & kSeriesFlag)) {
+    if (DINGO_UNLIKELY(buf.Size() < pos + size * sizeof(T))) {
+      throw std::runtime_error("Out of range.");
+    }
+    data.resize(size);
+    CopySeriesWords(reinterpret_cast<char*>(data.data()), buf.Data() + pos,
+                    size, sizeof(T), le);
+    return 4 + size * sizeof(T);
+  }
+
+  if (DINGO_UNLIKELY(buf.Size() < pos + 1 || size < 2 ||
+                     buf.Read(pos) != static_cast<uint8_t>(encoding))) {
+    throw std::runtime_error("Unknown series list encoding.");
+  }
+  ++pos;
+  if constexpr (encoding == SeriesEncoding::kXor) {
+    if (DINGO_UNLIKELY(buf.Size() < pos + 4)) {
+      throw std::runtime_error("Out of range.");
+    }
+    size_t bytes = static_cast<uint32_t>(buf.ReadInt(pos));
+    pos += 4;
+    // the first element takes 64 bits, every other at least one.
+    if (DINGO_UNLIKELY(buf.Size() - pos < bytes || bytes < 8 ||
+                       size - 1 > (bytes - 8) * 8)) {
+      throw std::runtime_error("Out of range.");
+    }
+    data.resize(size);
+    if (DINGO_UNLIKELY(!XorDecode(
+            reinterpret_cast<const uint8_t*>(buf.Data() + pos), bytes, size,
+            data.data()))) {
+      throw std::runtime_error("Out of range.");
+    }
+    return pos + bytes - offset;
+  } else {
+    if (DINGO_UNLIKELY(buf.Size() < pos + 1 + 2 * sizeof(T))) {
+      throw std::runtime_error("Out of range.");
+    }
+    DeltaFrame frame;
+    frame.width = buf.Read(pos++);
+    if (DINGO_UNLIKELY(frame.width < 1 ||
+                       static_cast<size_t>(frame.width) > 8 * sizeof(T))) {
+      throw std::runtime_error("Unknown series list encoding.");
+    }
+    auto first = LoadSeriesWord<T>(buf, pos);
+    frame.base = static_cast<std::make_unsigned_t<T>>(
+        LoadSeriesWord<T>(buf, pos + sizeof(T)));
+    pos += 2 * sizeof(T);
+    // width >= 1 bounds size by the bytes left.
+    if (DINGO_UNLIKELY(size - 1 > (buf.Size() - pos) * 8)) {
+      throw std::runtime_error("Out of range.");
+    }
+    size_t packed = PackedDeltasSize(size, frame.width);
+    if (DINGO_UNLIKELY(buf.Size() - pos < packed)) {
+      throw std::runtime_error("Out of range.");
+    }
+    data.resize(size);
+    data[0] = first;
+    UnpackDeltas(reinterpret_cast<const uint8_t*>(buf.Data() + pos), size, frame,
+                 data.data());
+    return pos + packed - offset;
+  }
+}
+
+// Elements [begin, end) of the list at offset of buf into data, end clamped
+// to the list size. A plain list is read in place, an encoded one is decoded
+// whole first.
+template <typename T, typename B>
+void DecodeSeriesListRange(B& buf, size_t offset, size_t begin, size_t end,
+                           std::vector<T>& data, bool le) {
+  if (DINGO_UNLIKELY(buf.Size() < offset + 4)) {
+    throw std::runtime_error("Out of range.");
+  }
+  uint32_t raw = buf.ReadInt(offset);
+  if (raw & kSeriesFlag) {
+    DecodeSeriesList(buf, offset, data, le);
+    end = std::min(end, data.size());
+    begin = std::min(begin, end);
+    data.erase(data.begin() + end, data.end());
+    data.erase(data.begin(), data.begin() + begin);
+    return;
+  }
+
+  end = std::min<size_t>(end, raw);
+  begin = std::min(begin, end);
+  if (DINGO_UNLIKELY(buf.Size() < offset + 4 + end * sizeof(T))) {
+    throw std::runtime_error("Out of range.");
+  }
+  data.resize(end - begin);
+  CopySeriesWords(reinterpret_cast<char*>(data.data()),
+                  buf.Data() + offset + 4 + begin * sizeof(T), end - begin,
+                  sizeof(T), le);
+}
+
+// Length of the list at offset of buf, its elements are not decoded.
+template <typename T, typename B>
+int SeriesListLength(B& buf, size_t offset) {
+  uint32_t raw = buf.ReadInt(offset);
+  size_t size = raw & ~kSeriesFlag;
+  if (!(raw & kSeriesFlag)) {
+    return 4 + size * sizeof(T);
+  }
+  size_t pos = offset + 4;
+  if (DINGO_UNLIKELY(buf.Size() < pos + 1)) {
+    throw std::runtime_error("Out of range.");
+  }
+  if (buf.Read(pos) == static_cast<uint8_t>(SeriesEncoding::kXor)) {
+    return 4 + 1 + 4 + static_cast<uint32_t>(buf.ReadInt(pos + 1));
+  }
+  int width = buf.Read(pos + 1);
+  return 4 + 2 + 2 * sizeof(T) + PackedDeltasSize(size, width);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
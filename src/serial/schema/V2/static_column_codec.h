@@ -0,0 +1,299 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_STATIC_COLUMN_CODEC_V2_H_
+#define DINGO_SERIAL_STATIC_COLUMN_CODEC_V2_H_
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "serial/schema/V2/base_schema.h"
+#include "serial/schema/V2/string_schema.h"
+#include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/byte_swap.h"
+#include "serial/utils/V2/compiler.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * The plain V2 encoding of one column type, as its DingoSchema writes it with
+ * no value format option set, without the std::any and virtual calls.
+ *
+ *   kType: the BaseSchema type of the column.
+ *   kKeyLength: bytes of a key column after its null flag, 0 when it varies.
+ *   EncodeKey / EncodeNullKey / DecodeKey: the key bytes after the null flag,
+ *     DecodeKey returns false for bytes not in the key form.
+ *   EncodeValue / DecodeValue: the value bytes at an offset.
+ *
+ * Lists have no key form.
+ */
+template <typename T>
+struct StaticColumnCodec;
+
+template <>
+struct StaticColumnCodec<bool> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kBool;
+  static constexpr bool kKeyAllowed = true;
+  static constexpr int kKeyLength = 1;
+
+  static void EncodeKey(bool data, Buf& buf) { buf.Write(data ? 0x1 : 0x0); }
+  static void EncodeNullKey(Buf& buf) { buf.Write(0x0); }
+  static bool DecodeKey(BufView& buf, bool& data) {
+    data = buf.Read();
+    return true;
+  }
+
+  static void EncodeValue(bool data, Buf& buf) { buf.Write(data ? 0x1 : 0x0); }
+  static void DecodeValue(const BufView& buf, int offset, bool& data) {
+    data = buf.Read(offset);
+  }
+};
+
+template <>
+struct StaticColumnCodec<int32_t> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kInteger;
+  static constexpr bool kKeyAllowed = true;
+  static constexpr int kKeyLength = 4;
+
+  static void EncodeKey(int32_t data, Buf& buf) {
+    buf.WriteIntWithFirstBitNegation(data);
+  }
+  static void EncodeNullKey(Buf& buf) { buf.WriteInt(0); }
+  static bool DecodeKey(BufView& buf, int32_t& data) {
+    data = buf.ReadIntWithFirstBitNegation();
+    return true;
+  }
+
+  static void EncodeValue(int32_t data, Buf& buf) { buf.WriteInt(data); }
+  static void DecodeValue(const BufView& buf, int offset, int32_t& data) {
+    data = buf.ReadInt(offset);
+  }
+};
+
+template <>
+struct StaticColumnCodec<int64_t> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kLong;
+  static constexpr bool kKeyAllowed = true;
+  static constexpr int kKeyLength = 8;
+
+  static void EncodeKey(int64_t data, Buf& buf) {
+    buf.WriteLongWithFirstBitNegation(data);
+  }
+  static void EncodeNullKey(Buf& buf) { buf.WriteLong(0); }
+  static bool DecodeKey(BufView& buf, int64_t& data) {
+    data = buf.ReadLongWithFirstBitNegation();
+    return true;
+  }
+
+  static void EncodeValue(int64_t data, Buf& buf) { buf.WriteLong(data); }
+  static void DecodeValue(const BufView& buf, int offset, int64_t& data) {
+    data = buf.ReadLong(offset);
+  }
+};
+
+template <>
+struct StaticColumnCodec<float> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kFloat;
+  static constexpr bool kKeyAllowed = true;
+  static constexpr int kKeyLength = 4;
+
+  static void EncodeKey(float data, Buf& buf) {
+    buf.WriteFloatComparable(data);
+  }
+  static void EncodeNullKey(Buf& buf) { buf.WriteInt(0); }
+  static bool DecodeKey(BufView& buf, float& data) {
+    uint32_t bits = buf.ReadFloatComparable();
+    memcpy(&data, &bits, 4);
+    return true;
+  }
+
+  static void EncodeValue(float data, Buf& buf) {
+    uint32_t bits;
+    memcpy(&bits, &data, 4);
+    buf.WriteInt(bits);
+  }
+  static void DecodeValue(const BufView& buf, int offset, float& data) {
+    uint32_t bits = buf.ReadInt(offset);
+    memcpy(&data, &bits, 4);
+  }
+};
+
+template <>
+struct StaticColumnCodec<double> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kDouble;
+  static constexpr bool kKeyAllowed = true;
+  static constexpr int kKeyLength = 8;
+
+  static void EncodeKey(double data, Buf& buf) {
+    buf.WriteDoubleComparable(data);
+  }
+  static void EncodeNullKey(Buf& buf) { buf.WriteLong(0); }
+  static bool DecodeKey(BufView& buf, double& data) {
+    uint64_t bits = buf.ReadDoubleComparable();
+    memcpy(&data, &bits, 8);
+    return true;
+  }
+
+  static void EncodeValue(double data, Buf& buf) {
+    uint64_t bits;
+    memcpy(&bits, &data, 8);
+    buf.WriteLong(bits);
+  }
+  static void DecodeValue(const BufView& buf, int offset, double& data) {
+    uint64_t bits = buf.ReadLong(offset);
+    memcpy(&data, &bits, 8);
+  }
+};
+
+template <>
+struct StaticColumnCodec<std::string> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kString;
+  static constexpr bool kKeyAllowed = true;
+  static constexpr int kKeyLength = 0;
+
+  static void EncodeKey(const std::string& data, Buf& buf) {
+    DingoSchema<std::string>::EncodeBytesComparable(data, buf);
+  }
+  // a null string key is its null flag alone.
+  static void EncodeNullKey(Buf&) {}
+  static bool DecodeKey(BufView& buf, std::string& data) {
+    data.clear();
+    return DingoSchema<std::string>::DecodeBytesComparable(buf, data) >= 0;
+  }
+
+  static void EncodeValue(const std::string& data, Buf& buf) {
+    buf.WriteInt(data.size());
+    buf.WriteString(data);
+  }
+  static void DecodeValue(const BufView& buf, int offset, std::string& data) {
+    uint32_t size = buf.ReadInt(offset);
+    if (DINGO_UNLIKELY(size & 0x80000000 ||
+                       buf.Size() < offset + 4 + static_cast<size_t>(size))) {
+      throw std::runtime_error("Out of range.");
+    }
+    data.assign(buf.Data() + offset + 4, size);
+  }
+};
+
+// The numeric lists, an element count then the words as the list schemas
+// copy them.
+template <typename E, BaseSchema::Type type>
+struct StaticWordListCodec {
+  static constexpr BaseSchema::Type kType = type;
+  static constexpr bool kKeyAllowed = false;
+
+  static void EncodeValue(const std::vector<E>& data, Buf& buf) {
+    buf.WriteInt(data.size());
+    size_t start = buf.Size();
+    buf.Enlarge(data.size() * sizeof(E));
+    Copy(buf.Data() + start, reinterpret_cast<const char*>(data.data()),
+         data.size(), buf.IsLe());
+  }
+  static void DecodeValue(const BufView& buf, int offset,
+                          std::vector<E>& data) {
+    int size = buf.ReadInt(offset);
+    offset += 4;
+    if (DINGO_UNLIKELY(size < 0 || buf.Size() < offset + size * sizeof(E))) {
+      throw std::runtime_error("Out of range.");
+    }
+    data.resize(size);
+    Copy(reinterpret_cast<char*>(data.data()), buf.Data() + offset, size,
+         buf.IsLe());
+  }
+
+ private:
+  static void Copy(char* dst, const char* src, size_t count, bool swap) {
+    if constexpr (sizeof(E) == 4) {
+      CopyWords32(dst, src, count, swap);
+    } else {
+      CopyWords64(dst, src, count, swap);
+    }
+  }
+};
+
+template <>
+struct StaticColumnCodec<std::vector<int32_t>>
+    : StaticWordListCodec<int32_t, BaseSchema::kIntegerList> {};
+template <>
+struct StaticColumnCodec<std::vector<int64_t>>
+    : StaticWordListCodec<int64_t, BaseSchema::kLongList> {};
+template <>
+struct StaticColumnCodec<std::vector<float>>
+    : StaticWordListCodec<float, BaseSchema::kFloatList> {};
+template <>
+struct StaticColumnCodec<std::vector<double>>
+    : StaticWordListCodec<double, BaseSchema::kDoubleList> {};
+
+template <>
+struct StaticColumnCodec<std::vector<bool>> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kBoolList;
+  static constexpr bool kKeyAllowed = false;
+
+  static void EncodeValue(const std::vector<bool>& data, Buf& buf) {
+    buf.WriteInt(data.size());
+    for (bool b : data) {
+      buf.Write(b ? 0x1 : 0x0);
+    }
+  }
+  static void DecodeValue(const BufView& buf, int offset,
+                          std::vector<bool>& data) {
+    int size = buf.ReadInt(offset);
+    offset += 4;
+    // a packed list has the top bit of its count set and fails here.
+    if (DINGO_UNLIKELY(size < 0 || buf.Size() < offset + size * 1UL)) {
+      throw std::runtime_error("Out of range.");
+    }
+    data.resize(size);
+    for (int i = 0; i < size; ++i) {
+      data[i] = buf.Read(offset + i);
+    }
+  }
+};
+
+template <>
+struct StaticColumnCodec<std::vector<std::string>> {
+  static constexpr BaseSchema::Type kType = BaseSchema::kStringList;
+  static constexpr bool kKeyAllowed = false;
+
+  static void EncodeValue(const std::vector<std::string>& data, Buf& buf) {
+    buf.WriteInt(data.size());
+    for (const auto& str : data) {
+      buf.WriteInt(str.size());
+      buf.WriteString(str);
+    }
+  }
+  static void DecodeValue(const BufView& buf, int offset,
+                          std::vector<std::string>& data) {
+    int size = buf.ReadInt(offset);
+    offset += 4;
+    if (DINGO_UNLIKELY(size < 0)) {
+      throw std::runtime_error("Out of range.");
+    }
+    data.resize(size);
+    for (auto& str : data) {
+      StaticColumnCodec<std::string>::DecodeValue(buf, offset, str);
+      offset += 4 + str.size();
+    }
+  }
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
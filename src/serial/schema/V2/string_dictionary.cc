@@ -0,0 +1,47 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "string_dictionary.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace dingodb {
+namespace serialV2 {
+
+StringDictionary::StringDictionary(std::vector<std::string> values)
+    : values_(std::move(values)) {
+  if (values_.size() > static_cast<size_t>(INT32_MAX)) {
+    throw std::runtime_error("Too many dictionary values.");
+  }
+
+  codes_.reserve(values_.size());
+  for (size_t i = 0; i < values_.size(); ++i) {
+    if (!codes_.emplace(values_[i], static_cast<int32_t>(i)).second) {
+      throw std::runtime_error("Duplicated dictionary value.");
+    }
+  }
+}
+
+int32_t StringDictionary::Find(const std::string& value) const {
+  return Find(std::string_view(value));
+}
+
+int32_t StringDictionary::Find(std::string_view value) const {
+  auto it = codes_.find(value);
+  return it == codes_.end() ? kNoCode : it->second;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
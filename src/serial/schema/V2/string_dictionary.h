@@ -0,0 +1,73 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_STRING_DICTIONARY_V2_H_
+#define DINGO_SERIAL_STRING_DICTIONARY_V2_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * The distinct values of a low cardinality string column, a value is stored
+ * as its position in values.
+ *
+ * The codes are part of the encoded rows, so a dictionary belongs to a schema
+ * version: a new version may only append values, which keeps the rows of the
+ * older versions decodable.
+ */
+class StringDictionary {
+ public:
+  static constexpr int32_t kNoCode = -1;
+
+  // Throws runtime_error on duplicated values.
+  explicit StringDictionary(std::vector<std::string> values);
+
+  StringDictionary(const StringDictionary&) = delete;
+  StringDictionary& operator=(const StringDictionary&) = delete;
+
+  size_t Size() const { return values_.size(); }
+
+  // Code of value, or kNoCode.
+  int32_t Find(const std::string& value) const;
+  int32_t Find(std::string_view value) const;
+
+  // Value of code, nullptr when code is out of the dictionary.
+  const std::string* Get(int32_t code) const {
+    if (code < 0 || static_cast<size_t>(code) >= values_.size()) {
+      return nullptr;
+    }
+    return &values_[code];
+  }
+
+  const std::vector<std::string>& Values() const { return values_; }
+
+ private:
+  std::vector<std::string> values_;
+  // keys point into values_.
+  std::unordered_map<std::string_view, int32_t> codes_;
+};
+
+using StringDictionaryPtr = std::shared_ptr<const StringDictionary>;
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -36,33 +36,40 @@ int DingoSchema<std::vector<std::string>>::EncodeStringListNotComparable(
   return size;
 }
 
+template <typename B>
 void DingoSchema<std::vector<std::string>>::DecodeStringListNotComparable(
-    Buf& buf, std::vector<std::string>& data) {
+    B& buf, std::vector<std::string>& data) {
   int size = buf.ReadInt();
   data.resize(size);
   for (int i = 0; i < size; ++i) {
     int str_len = buf.ReadInt();
-    std::string str(str_len, '\n');
-    for (int j = 0; j < str_len; ++j) {
-      str[j] = buf.Read();
+    // assigned in place, keeping the capacity of a reused list.
+    std::string& str = data[i];
+    if (DINGO_UNLIKELY(buf.RestReadableSize() <
+                       static_cast<uint32_t>(str_len))) {
+      throw std::runtime_error("Out of range.");
     }
-    data[i] = std::move(str);
+    str.assign(buf.Data() + buf.ReadOffset(), str_len);
+    buf.Skip(str_len);
   }
 }
 
+template <typename B>
 void DingoSchema<std::vector<std::string>>::DecodeStringListNotComparable(
-    Buf& buf, std::vector<std::string>& data, int offset) {
+    B& buf, std::vector<std::string>& data, int offset) {
   int size = buf.ReadInt(offset);
   data.resize(size);
   offset += 4;
   for (int i = 0; i < size; ++i) {
     int str_len = buf.ReadInt(offset);
     offset += 4;
-    std::string str(str_len, '\n');
-    for (int j = 0; j < str_len; ++j) {
-      str[j] = buf.Read(offset++);
+    // assigned in place, keeping the capacity of a reused list.
+    std::string& str = data[i];
+    if (DINGO_UNLIKELY(buf.Size() - offset < static_cast<uint32_t>(str_len))) {
+      throw std::runtime_error("Out of range.");
     }
-    data[i] = std::move(str);
+    str.assign(buf.Data() + offset, str_len);
+    offset += str_len;
   }
 }
 
@@ -76,12 +83,14 @@ int DingoSchema<std::vector<std::string>>::GetLengthForValue() {
   return -1;
 }
 
-int DingoSchema<std::vector<std::string>>::SkipKey(Buf&) {
+template <typename B>
+int DingoSchema<std::vector<std::string>>::SkipKeyImpl(B&) {
   throw std::runtime_error("Unsupport encoding key list type");
   return -1;
 }
 
-int DingoSchema<std::vector<std::string>>::SkipValue(Buf& buf) {
+template <typename B>
+int DingoSchema<std::vector<std::string>>::SkipValueImpl(B& buf) {
   int size = 4;
   int str_num = buf.ReadInt();
   for (int i = 0; i < str_num; ++i) {
@@ -98,37 +107,105 @@ int DingoSchema<std::vector<std::string>>::EncodeKey(const std::any&, Buf&) {
   return -1;
 }
 
-int DingoSchema<std::vector<std::string>>::EncodeValue(const std::any& data,
-                                                       Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<std::vector<std::string>>::EncodeValueData(
+    const std::vector<std::string>* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("Not allow null, but data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const std::vector<std::string>&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
     return EncodeStringListNotComparable(ref_data, buf);
   }
 
   return 0;
 }
 
-std::any DingoSchema<std::vector<std::string>>::DecodeKey(Buf&) {
+int DingoSchema<std::vector<std::string>>::EncodeValue(const std::any& data,
+                                                       Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<std::string>>(data), buf);
+}
+
+int DingoSchema<std::vector<std::string>>::EncodeValueVariant(
+    const ColumnValue& data, Buf& buf) {
+  return EncodeValueData(DataOf<std::vector<std::string>>(data), buf);
+}
+
+int DingoSchema<std::vector<std::string>>::EncodedValueLength(
+    const std::vector<std::string>* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  size_t len = 4;
+  for (const auto& str : *data) {
+    len += str.size() + 4;
+  }
+  return len;
+}
+
+int DingoSchema<std::vector<std::string>>::GetEncodedValueLength(
+    const std::any& data) {
+  return EncodedValueLength(DataOf<std::vector<std::string>>(data));
+}
+
+int DingoSchema<std::vector<std::string>>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<std::vector<std::string>>(data));
+}
+
+template <typename B>
+std::any DingoSchema<std::vector<std::string>>::DecodeKeyImpl(B&) {
   throw std::runtime_error("Unsupported encode key list type");
 }
 
-std::any DingoSchema<std::vector<std::string>>::DecodeValue(Buf& buf) {
+template <typename B>
+std::any DingoSchema<std::vector<std::string>>::DecodeValueImpl(B& buf) {
   std::vector<std::string> data;
   DecodeStringListNotComparable(buf, data);
 
   return std::move(std::any(std::move(data)));
 }
 
-std::any DingoSchema<std::vector<std::string>>::DecodeValue(Buf& buf, int offset) {
+template <typename B>
+std::any DingoSchema<std::vector<std::string>>::DecodeValueImpl(B& buf, int offset) {
   std::vector<std::string> data;
   DecodeStringListNotComparable(buf, data, offset);
 
   return std::move(std::any(std::move(data)));
 }
 
+int DingoSchema<std::vector<std::string>>::SkipKey(Buf& buf) { return SkipKeyImpl(buf); }
+int DingoSchema<std::vector<std::string>>::SkipKey(BufView& buf) { return SkipKeyImpl(buf); }
+
+int DingoSchema<std::vector<std::string>>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<std::vector<std::string>>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<std::vector<std::string>>::DecodeKey(Buf& buf) { return DecodeKeyImpl(buf); }
+std::any DingoSchema<std::vector<std::string>>::DecodeKey(BufView& buf) { return DecodeKeyImpl(buf); }
+
+std::any DingoSchema<std::vector<std::string>>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<std::vector<std::string>>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
+std::any DingoSchema<std::vector<std::string>>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<std::vector<std::string>>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<std::vector<std::string>>::DecodeKey(BufView&, RowSink&, int) {
+  throw std::runtime_error("Unsupport encoding key list type");
+}
+
+void DingoSchema<std::vector<std::string>>::DecodeValue(BufView& buf, int offset,
+                                                        RowSink& sink, int col) {
+  std::vector<std::string> data;
+  sink.ReuseList(col, data);
+
+  DecodeStringListNotComparable(buf, data, offset);
+
+  sink.OnStringList(col, std::move(data));
+}
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -39,17 +39,48 @@ class DingoSchema<std::vector<std::string>> : public BaseSchema {
 
   int EncodeKey(const std::any& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
+  int GetEncodedValueLength(const std::any& data) override;
+  int GetEncodedValueLengthVariant(const ColumnValue& data) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
 
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
  private:
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeValueData(const std::vector<std::string>* data, Buf& buf);
+  int EncodedValueLength(const std::vector<std::string>* data);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
   static int EncodeStringListNotComparable(const std::vector<std::string>& data,
                                            Buf& buf);
-  static void DecodeStringListNotComparable(Buf& buf,
+  template <typename B>
+  static void DecodeStringListNotComparable(B& buf,
                                             std::vector<std::string>& data);
-  static void DecodeStringListNotComparable(Buf& buf,
+  template <typename B>
+  static void DecodeStringListNotComparable(B& buf,
                                             std::vector<std::string>& data,
                                             int offset);
 };
@@ -14,9 +14,12 @@
 
 #include "string_schema.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "serial/utils/V2/compiler.h"
@@ -27,56 +30,252 @@ namespace serialV2 {
 const int kGroupSize = 8;
 const int kPadGroupSize = 9;
 const uint8_t kMarker = 255;
+// the escaped form: a zero byte is followed by kEscapedZero, the string by
+// kEscape | kEscapedTerminator.
+const uint8_t kEscape = 0x00;
+const uint8_t kEscapedZero = 0xFF;
+const uint8_t kEscapedTerminator = 0x01;
+
+// Walk the group markers starting at data, return the number of groups of
+// the encoded string and set pad_count to the padding of the last group, or -1
+// when the bytes are not a complete encoded string. invert is 0xFF for the
+// inverted bytes of a descending key.
+static int ScanBytesComparable(const char* data, size_t rest, int& pad_count,
+                               uint8_t invert = 0) {
+  int group_num = 0;
+  for (;;) {
+    if (rest < kPadGroupSize) {
+      return -1;
+    }
+
+    uint8_t marker = static_cast<uint8_t>(data[kGroupSize]) ^ invert;
+    data += kPadGroupSize;
+    rest -= kPadGroupSize;
+    ++group_num;
+
+    if (marker != kMarker) {
+      pad_count = kMarker - marker;
+      if (pad_count > kGroupSize) {
+        return -1;
+      }
+      return group_num;
+    }
+  }
+}
 
 int DingoSchema<std::string>::EncodeBytesComparable(const std::string& data,
                                                     Buf& buf) {
-  for (uint32_t i = 0; i < data.size(); ++i) {
-    buf.Write(data.at(i));
-    if ((i + 1) % kGroupSize == 0) {
-      buf.Write(kMarker);
-    }
+  int full_group_num = data.size() / kGroupSize;
+  int group_num = full_group_num + 1;
+  int rest = data.size() - full_group_num * kGroupSize;
+  int pad_count = kGroupSize - rest;
+
+  size_t start = buf.Size();
+  buf.Enlarge(group_num * kPadGroupSize);
+
+  char* out = buf.Data() + start;
+  const char* in = data.data();
+  for (int i = 0; i < full_group_num; ++i) {
+    memcpy(out, in, kGroupSize);
+    out[kGroupSize] = static_cast<char>(kMarker);
+    out += kPadGroupSize;
+    in += kGroupSize;
   }
 
-  int group_num = data.size() / kGroupSize + 1;
-  int pad_count = group_num * kGroupSize - data.size();
+  memcpy(out, in, rest);
+  memset(out + rest, 0, pad_count);
+  out[kGroupSize] = static_cast<char>(kMarker - pad_count);
+
+  return group_num * kPadGroupSize;
+}
+
+template <typename B>
+int DingoSchema<std::string>::DecodeBytesComparable(B& buf,
+                                                    std::string& data) {
+  const char* in = buf.Data() + buf.ReadOffset();
+  int pad_count = 0;
+  int group_num = ScanBytesComparable(in, buf.RestReadableSize(), pad_count);
+  if (group_num == -1) {
+    return -1;
+  }
+
+  // padding must be zero.
+  const char* pad = in + (group_num - 1) * kPadGroupSize + kGroupSize - pad_count;
   for (int i = 0; i < pad_count; ++i) {
-    buf.Write(0);
+    if (pad[i] != 0) {
+      return -1;
+    }
   }
-  buf.Write(kMarker - pad_count);
 
-  return group_num * 9;
+  size_t start = data.size();
+  data.resize(start + group_num * kGroupSize - pad_count);
+
+  char* out = data.data() + start;
+  for (int i = 0; i < group_num - 1; ++i) {
+    memcpy(out, in, kGroupSize);
+    out += kGroupSize;
+    in += kPadGroupSize;
+  }
+  memcpy(out, in, kGroupSize - pad_count);
+
+  int size = group_num * kPadGroupSize;
+  buf.Skip(size);
+  return size;
 }
 
-int DingoSchema<std::string>::DecodeBytesComparable(Buf& buf,
-                                                    std::string& data) {
-  int size = 0;
+// Only the marker of every group is looked at, nothing is copied.
+template <typename B>
+int DingoSchema<std::string>::SkipBytesComparable(B& buf) {
+  int pad_count = 0;
+  int group_num = ScanBytesComparable(buf.Data() + buf.ReadOffset(),
+                                      buf.RestReadableSize(), pad_count);
+  if (group_num == -1) {
+    return -1;
+  }
+
+  int size = group_num * kPadGroupSize;
+  buf.Skip(size);
+  return size;
+}
+
+// Length up to and with the terminator of the escaped string starting at
+// data, -1 when the bytes end before it or hold another escape. memchr scans
+// for the zero bytes a word or vector at a time.
+static int ScanBytesEscaped(const char* data, size_t rest, uint8_t invert = 0) {
+  size_t pos = 0;
   for (;;) {
-    if (buf.RestReadableSize() < kPadGroupSize) {
+    const void* zero = memchr(data + pos, kEscape ^ invert, rest - pos);
+    if (zero == nullptr) {
+      return -1;
+    }
+    size_t i = static_cast<const char*>(zero) - data;
+    if (i + 1 >= rest) {
+      return -1;
+    }
+
+    uint8_t next = static_cast<uint8_t>(data[i + 1]) ^ invert;
+    if (next == kEscapedTerminator) {
+      return i + 2;
+    }
+    if (next != kEscapedZero) {
       return -1;
     }
+    pos = i + 2;
+  }
+}
+
+int DingoSchema<std::string>::EscapedLength(const std::string& data) {
+  return data.size() + std::count(data.begin(), data.end(), '\0') + 2;
+}
 
-    uint8_t marker = buf.Read(buf.ReadOffset() + kGroupSize);
+int DingoSchema<std::string>::EncodeBytesEscaped(const std::string& data,
+                                                 Buf& buf) {
+  int size = EscapedLength(data);
+  size_t start = buf.Size();
+  buf.Enlarge(size);
 
-    int pad_count = kMarker - marker;
-    for (int i = 0; i < kGroupSize - pad_count; ++i) {
-      data.push_back(buf.Read());
+  char* out = buf.Data() + start;
+  const char* in = data.data();
+  const char* end = in + data.size();
+  for (;;) {
+    const char* zero = static_cast<const char*>(memchr(in, 0, end - in));
+    if (zero == nullptr) {
+      break;
     }
+    memcpy(out, in, zero + 1 - in);
+    out += zero + 1 - in;
+    *out++ = static_cast<char>(kEscapedZero);
+    in = zero + 1;
+  }
+  memcpy(out, in, end - in);
+  out += end - in;
+  out[0] = static_cast<char>(kEscape);
+  out[1] = static_cast<char>(kEscapedTerminator);
 
-    size += kPadGroupSize;
-    if (pad_count != 0) {
-      for (int i = 0; i < pad_count; ++i) {
-        if (buf.Read() != 0) {
-          return -1;
-        }
-      }
-      buf.Skip(1);  // skip marker
+  return size;
+}
+
+template <typename B>
+int DingoSchema<std::string>::DecodeBytesEscaped(B& buf, std::string& data) {
+  const char* in = buf.Data() + buf.ReadOffset();
+  int size = ScanBytesEscaped(in, buf.RestReadableSize());
+  if (size == -1) {
+    return -1;
+  }
 
+  // every escape keeps its zero byte and drops the one behind it.
+  const char* end = in + size - 2;
+  for (;;) {
+    const char* zero = static_cast<const char*>(memchr(in, 0, end - in));
+    if (zero == nullptr) {
       break;
     }
+    data.append(in, zero + 1 - in);
+    in = zero + 2;
+  }
+  data.append(in, end - in);
+
+  buf.Skip(size);
+  return size;
+}
+
+void DingoSchema<std::string>::SetFixedLength(int length) {
+  if (length < 0) {
+    throw std::runtime_error("Fixed length must not be negative.");
+  }
+  fixed_length_ = length;
+}
+
+void DingoSchema<std::string>::CheckFixedLength(const std::string& data) const {
+  if (DINGO_UNLIKELY(data.size() != static_cast<size_t>(fixed_length_))) {
+    throw std::runtime_error("String length differs from the fixed length.");
+  }
+}
+
+int DingoSchema<std::string>::EncodeKeyBytes(const std::string& data,
+                                             Buf& buf) const {
+  if (fixed_length_ > 0) {
+    CheckFixedLength(data);
+    buf.WriteString(data);
+    return fixed_length_;
+  }
+  return escaped_key_ ? EncodeBytesEscaped(data, buf)
+                      : EncodeBytesComparable(data, buf);
+}
+
+template <typename B>
+int DingoSchema<std::string>::DecodeKeyBytes(B& buf, std::string& data) const {
+  if (fixed_length_ > 0) {
+    if (buf.RestReadableSize() < static_cast<size_t>(fixed_length_)) {
+      return -1;
+    }
+    data.append(buf.Data() + buf.ReadOffset(), fixed_length_);
+    buf.Skip(fixed_length_);
+    return fixed_length_;
+  }
+  return escaped_key_ ? DecodeBytesEscaped(buf, data)
+                      : DecodeBytesComparable(buf, data);
+}
 
-    buf.Skip(1);  // skip marker
+template <typename B>
+int DingoSchema<std::string>::SkipKeyBytes(B& buf) const {
+  if (fixed_length_ > 0) {
+    if (buf.RestReadableSize() < static_cast<size_t>(fixed_length_)) {
+      return -1;
+    }
+    buf.Skip(fixed_length_);
+    return fixed_length_;
+  }
+  if (!escaped_key_) {
+    return SkipBytesComparable(buf);
   }
 
+  int size = ScanBytesEscaped(buf.Data() + buf.ReadOffset(),
+                              buf.RestReadableSize());
+  if (size == -1) {
+    return -1;
+  }
+  buf.Skip(size);
   return size;
 }
 
@@ -88,50 +287,89 @@ int DingoSchema<std::string>::EncodeBytesNotComparable(const std::string& data,
   return data.size() + 4;
 }
 
-void DingoSchema<std::string>::DecodeBytesNotComparable(Buf& buf,
-                                                        std::string& data) {
-  int size = buf.ReadInt();
-  data.resize(size);
-  for (int i = 0; i < size; ++i) {
-    data[i] = buf.Read();
+// top bit of the length, set when a dictionary code takes its place.
+constexpr uint32_t kCodeFlag = 0x80000000;
+
+// The view points into buf, or into the dictionary for a code.
+template <typename B>
+std::string_view DingoSchema<std::string>::DecodeBytesNotComparable(
+    B& buf, int offset) const {
+  if (fixed_length_ > 0) {
+    if (DINGO_UNLIKELY(buf.Size() <
+                       offset + static_cast<size_t>(fixed_length_))) {
+      throw std::runtime_error("Out of range.");
+    }
+    return std::string_view(buf.Data() + offset, fixed_length_);
+  }
+  uint32_t raw = buf.ReadInt(offset);
+  if (raw & kCodeFlag) {
+    const std::string* value =
+        dictionary_ == nullptr
+            ? nullptr
+            : dictionary_->Get(static_cast<int32_t>(raw & ~kCodeFlag));
+    if (DINGO_UNLIKELY(value == nullptr)) {
+      throw std::runtime_error("Unknown dictionary code.");
+    }
+    return *value;
+  }
+
+  if (DINGO_UNLIKELY(buf.Size() < offset + 4 + static_cast<size_t>(raw))) {
+    throw std::runtime_error("Out of range.");
   }
+  return std::string_view(buf.Data() + offset + 4, raw);
+}
+
+std::string_view DingoSchema<std::string>::DecodeValueView(const BufView& buf,
+                                                           int offset) const {
+  return DecodeBytesNotComparable(buf, offset);
 }
 
-void DingoSchema<std::string>::DecodeBytesNotComparable(Buf& buf,
-                                                        std::string& data,
-                                                        int offset) {
-  int size = buf.ReadInt(offset);
-  data.resize(size);
-  offset += 4;
-  for (int i = 0; i < size; ++i) {
-    data[i] = buf.Read(offset++);
+int32_t DingoSchema<std::string>::DecodeCode(BufView& buf, int offset) const {
+  if (fixed_length_ > 0) {
+    return dictionary_ == nullptr
+               ? StringDictionary::kNoCode
+               : dictionary_->Find(DecodeBytesNotComparable(buf, offset));
+  }
+  uint32_t raw = buf.ReadInt(offset);
+  if (raw & kCodeFlag) {
+    return static_cast<int32_t>(raw & ~kCodeFlag);
+  }
+  if (dictionary_ == nullptr) {
+    return StringDictionary::kNoCode;
   }
+  return dictionary_->Find(DecodeBytesNotComparable(buf, offset));
 }
 
 int DingoSchema<std::string>::GetLengthForKey() {
+  if (fixed_length_ > 0) {
+    return AllowNull() ? fixed_length_ + 1 : fixed_length_;
+  }
   throw std::runtime_error("String unsupport length");
 }
 
 int DingoSchema<std::string>::GetLengthForValue() {
+  if (fixed_length_ > 0) {
+    return fixed_length_;
+  }
   throw std::runtime_error("String unsupport length");
 }
 
-int DingoSchema<std::string>::SkipKey(Buf& buf) {
+template <typename B>
+int DingoSchema<std::string>::SkipKeyImpl(B& buf) {
   if (AllowNull()) {
     if (buf.Read() == k_null) {
-      return 1;
+      buf.Skip(fixed_length_);
+      return fixed_length_ + 1;
     }
 
-    std::string data(1024, 0);
-    int size = DecodeBytesComparable(buf, data);
+    int size = SkipKeyBytes(buf);
     if (size == -1) {
       throw std::runtime_error("decode comparable string error.");
     }
 
     return size + 1;  // with null flag.
   } else {
-    std::string data(1024, 0);
-    int size = DecodeBytesComparable(buf, data);
+    int size = SkipKeyBytes(buf);
     if (size == -1) {
       throw std::runtime_error("decode comparable string error.");
     }
@@ -140,58 +378,198 @@ int DingoSchema<std::string>::SkipKey(Buf& buf) {
   }
 }
 
-int DingoSchema<std::string>::SkipValue(Buf& buf) {
-  int size = buf.ReadInt();
-  buf.Skip(size);
+// The descending key in a per thread buffer, valid until the next one.
+template <typename B>
+BufView DingoSchema<std::string>::AscendingKey(B& buf) {
+  thread_local std::string scratch;
+  size_t len = DescendingKeyLength(buf);
+  scratch.resize(len);
+  return BaseSchema::AscendingKey(buf, len, scratch.data());
+}
 
-  return size + 4;
+// Only the inverted markers are looked at, buf is not moved.
+template <typename B>
+int DingoSchema<std::string>::DescendingKeyLength(B& buf) {
+  int len = ScanKeyLength(buf.Data() + buf.ReadOffset(),
+                          buf.RestReadableSize());
+  if (len == -1) {
+    throw std::runtime_error("decode comparable string error.");
+  }
+  return len;
 }
 
-int DingoSchema<std::string>::EncodeKey(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<std::string>::ScanKeyLength(const char* data,
+                                            size_t size) const {
+  uint8_t invert = IsDescending() ? 0xFF : 0x0;
+  int flag = 0;
+  if (AllowNull()) {
+    if (size == 0) {
+      return -1;
+    }
+    if ((static_cast<uint8_t>(data[0]) ^ invert) == k_null) {
+      return size > static_cast<size_t>(fixed_length_) ? fixed_length_ + 1
+                                                         : -1;
+    }
+    flag = 1;
+  }
+
+  if (fixed_length_ > 0) {
+    return size - flag < static_cast<size_t>(fixed_length_)
+               ? -1
+               : flag + fixed_length_;
+  }
+
+  if (escaped_key_) {
+    int len = ScanBytesEscaped(data + flag, size - flag, invert);
+    return len == -1 ? -1 : flag + len;
+  }
+
+  int pad_count = 0;
+  int group_num = ScanBytesComparable(data + flag, size - flag, pad_count, invert);
+  return group_num == -1 ? -1 : flag + group_num * kPadGroupSize;
+}
+
+template <typename B>
+int DingoSchema<std::string>::SkipValueImpl(B& buf) {
+  if (fixed_length_ > 0) {
+    buf.Skip(fixed_length_);
+    return fixed_length_;
+  }
+  uint32_t raw = buf.ReadInt();
+  if (raw & kCodeFlag) {
+    return 4;
+  }
+  buf.Skip(raw);
+
+  return raw + 4;
+}
+
+int DingoSchema<std::string>::EncodeKeyData(const std::string* data, Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("data not has value.");
   }
   if (AllowNull()) {
-    if (data.has_value()) {
+    if (data != nullptr) {
       buf.Write(k_not_null);
-      const auto& ref_data = std::any_cast<const std::string&>(data);
-      return EncodeBytesComparable(ref_data, buf) + 1;
+      const auto& ref_data = *data;
+      return EncodeKeyBytes(ref_data, buf) + 1;
     } else {
+      // a fixed length key keeps its room.
       buf.Write(k_null);
-      return 1;
+      buf.Enlarge(fixed_length_);
+      return fixed_length_ + 1;
     }
   } else {
-    if (data.has_value()) {
-      const auto& ref_data = std::any_cast<const std::string&>(data);
-      return EncodeBytesComparable(ref_data, buf);
+    if (data != nullptr) {
+      const auto& ref_data = *data;
+      return EncodeKeyBytes(ref_data, buf);
     } else {
       return 0;
     }
   }
 }
 
-int DingoSchema<std::string>::EncodeValue(const std::any& data, Buf& buf) {
-  if (DINGO_UNLIKELY(!AllowNull() && !data.has_value())) {
+int DingoSchema<std::string>::EncodeKey(const std::any& data, Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<std::string>(data), buf));
+}
+
+int DingoSchema<std::string>::EncodeKeyVariant(const ColumnValue& data,
+                                               Buf& buf) {
+  return OrderKey(buf, EncodeKeyData(DataOf<std::string>(data), buf));
+}
+
+int DingoSchema<std::string>::EncodeValueData(const std::string* data,
+                                              Buf& buf) {
+  if (DINGO_UNLIKELY(!AllowNull() && data == nullptr)) {
     throw std::runtime_error("data not has value.");
   }
 
-  if (data.has_value()) {
-    const auto& ref_data = std::any_cast<const std::string&>(data);
+  if (data != nullptr) {
+    const auto& ref_data = *data;
+    if (fixed_length_ > 0) {
+      CheckFixedLength(ref_data);
+      buf.WriteString(ref_data);
+      return fixed_length_;
+    }
+    if (dictionary_ != nullptr) {
+      int32_t code = dictionary_->Find(ref_data);
+      if (code != StringDictionary::kNoCode) {
+        buf.WriteInt(static_cast<uint32_t>(code) | kCodeFlag);
+        return 4;
+      }
+    }
     return EncodeBytesNotComparable(ref_data, buf);
   }
 
   return 0;
 }
 
-std::any DingoSchema<std::string>::DecodeKey(Buf& buf) {
+int DingoSchema<std::string>::EncodeValue(const std::any& data, Buf& buf) {
+  return EncodeValueData(DataOf<std::string>(data), buf);
+}
+
+int DingoSchema<std::string>::EncodeValueVariant(const ColumnValue& data,
+                                                 Buf& buf) {
+  return EncodeValueData(DataOf<std::string>(data), buf);
+}
+
+int DingoSchema<std::string>::EncodedKeyLength(const std::string* data) {
+  int len = AllowNull() ? 1 : 0;
+  if (fixed_length_ > 0) {
+    return len + fixed_length_;
+  }
+  if (data != nullptr) {
+    const auto& ref_data = *data;
+    len += escaped_key_ ? EscapedLength(ref_data)
+                        : (ref_data.size() / kGroupSize + 1) * kPadGroupSize;
+  }
+  return len;
+}
+
+int DingoSchema<std::string>::GetEncodedKeyLength(const std::any& data) {
+  return EncodedKeyLength(DataOf<std::string>(data));
+}
+
+int DingoSchema<std::string>::GetEncodedKeyLengthVariant(
+    const ColumnValue& data) {
+  return EncodedKeyLength(DataOf<std::string>(data));
+}
+
+int DingoSchema<std::string>::EncodedValueLength(const std::string* data) {
+  if (data == nullptr) {
+    return 0;
+  }
+  const auto& ref_data = *data;
+  if (fixed_length_ > 0) {
+    return fixed_length_;
+  }
+  if (dictionary_ != nullptr &&
+      dictionary_->Find(ref_data) != StringDictionary::kNoCode) {
+    return 4;
+  }
+  return ref_data.size() + 4;
+}
+
+int DingoSchema<std::string>::GetEncodedValueLength(const std::any& data) {
+  return EncodedValueLength(DataOf<std::string>(data));
+}
+
+int DingoSchema<std::string>::GetEncodedValueLengthVariant(
+    const ColumnValue& data) {
+  return EncodedValueLength(DataOf<std::string>(data));
+}
+
+template <typename B>
+std::any DingoSchema<std::string>::DecodeKeyImpl(B& buf) {
   if (AllowNull()) {
     if (buf.Read() == k_null) {
+      buf.Skip(fixed_length_);
       return std::any();
     }
   }
 
   std::string data;
-  int size = DecodeBytesComparable(buf, data);
+  int size = DecodeKeyBytes(buf, data);
   if (size == -1) {
     throw std::runtime_error("decode comparable string error.");
   }
@@ -199,19 +577,108 @@ std::any DingoSchema<std::string>::DecodeKey(Buf& buf) {
   return std::move(std::any(std::move(data)));
 }
 
-std::any DingoSchema<std::string>::DecodeValue(Buf& buf) {
-  std::string data;
-  DecodeBytesNotComparable(buf, data);
+template <typename B>
+std::any DingoSchema<std::string>::DecodeValueImpl(B& buf) {
+  int offset = buf.ReadOffset();
+  SkipValueImpl(buf);
+
+  return DecodeValueImpl(buf, offset);
+}
+
+template <typename B>
+std::any DingoSchema<std::string>::DecodeValueImpl(B& buf, int offset) {
+  std::string data(DecodeBytesNotComparable(buf, offset));
 
   return std::move(std::any(std::move(data)));
 }
 
+int DingoSchema<std::string>::SkipKey(Buf& buf) {
+  if (IsDescending()) {
+    int len = DescendingKeyLength(buf);
+    buf.Skip(len);
+    return len;
+  }
+  return SkipKeyImpl(buf);
+}
+int DingoSchema<std::string>::SkipKey(BufView& buf) {
+  if (IsDescending()) {
+    int len = DescendingKeyLength(buf);
+    buf.Skip(len);
+    return len;
+  }
+  return SkipKeyImpl(buf);
+}
+
+int DingoSchema<std::string>::SkipValue(Buf& buf) { return SkipValueImpl(buf); }
+int DingoSchema<std::string>::SkipValue(BufView& buf) { return SkipValueImpl(buf); }
+
+std::any DingoSchema<std::string>::DecodeKey(Buf& buf) {
+  if (IsDescending()) {
+    BufView key = AscendingKey(buf);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+std::any DingoSchema<std::string>::DecodeKey(BufView& buf) {
+  if (IsDescending()) {
+    BufView key = AscendingKey(buf);
+    return DecodeKeyImpl(key);
+  }
+  return DecodeKeyImpl(buf);
+}
+
+std::any DingoSchema<std::string>::DecodeValue(Buf& buf) { return DecodeValueImpl(buf); }
+std::any DingoSchema<std::string>::DecodeValue(BufView& buf) { return DecodeValueImpl(buf); }
+
 std::any DingoSchema<std::string>::DecodeValue(Buf& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+std::any DingoSchema<std::string>::DecodeValue(BufView& buf, int offset) {
+  return DecodeValueImpl(buf, offset);
+}
+
+void DingoSchema<std::string>::DecodeKeyImpl(BufView& buf, RowSink& sink,
+                                             int col) {
+  if (AllowNull()) {
+    if (buf.Read() == k_null) {
+      buf.Skip(fixed_length_);
+      sink.OnNull(col);
+      return;
+    }
+  }
+
   std::string data;
-  DecodeBytesNotComparable(buf, data, offset);
+  int size = DecodeKeyBytes(buf, data);
+  if (size == -1) {
+    throw std::runtime_error("decode comparable string error.");
+  }
 
-  return std::move(std::any(std::move(data)));
+  sink.OnString(col, data);
 }
 
+void DingoSchema<std::string>::DecodeKey(BufView& buf, RowSink& sink, int col) {
+  if (IsDescending()) {
+    BufView key = AscendingKey(buf);
+    DecodeKeyImpl(key, sink, col);
+    return;
+  }
+  DecodeKeyImpl(buf, sink, col);
+}
+
+// The value bytes are not escaped, the view points into buf.
+void DingoSchema<std::string>::DecodeValue(BufView& buf, int offset,
+                                           RowSink& sink, int col) {
+  sink.OnString(col, DecodeBytesNotComparable(buf, offset));
+}
+
+template int DingoSchema<std::string>::DecodeBytesComparable(Buf& buf,
+                                                             std::string& data);
+template int DingoSchema<std::string>::DecodeBytesComparable(BufView& buf,
+                                                             std::string& data);
+template int DingoSchema<std::string>::DecodeBytesEscaped(Buf& buf,
+                                                          std::string& data);
+template int DingoSchema<std::string>::DecodeBytesEscaped(BufView& buf,
+                                                          std::string& data);
+
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -15,9 +15,12 @@
 #ifndef DINGO_SERIAL_STRING_SCHEMA_V2_H_
 #define DINGO_SERIAL_STRING_SCHEMA_V2_H_
 
+#include <cstdint>
 #include <memory>
+#include <string_view>
 
 #include "dingo_schema.h"
+#include "string_dictionary.h"
 
 namespace dingodb {
 namespace serialV2 {
@@ -37,19 +40,128 @@ class DingoSchema<std::string> : public BaseSchema {
   int SkipValue(Buf& buf) override;
 
   int EncodeKey(const std::any& data, Buf& buf) override;
+  int EncodeKeyVariant(const ColumnValue& data, Buf& buf) override;
   int EncodeValue(const std::any& data, Buf& buf) override;
+  int EncodeValueVariant(const ColumnValue& data, Buf& buf) override;
+  int GetEncodedKeyLength(const std::any& data) override;
+  int GetEncodedKeyLengthVariant(const ColumnValue& data) override;
+  int GetEncodedValueLength(const std::any& data) override;
+  int GetEncodedValueLengthVariant(const ColumnValue& data) override;
 
   std::any DecodeKey(Buf& buf) override;
   std::any DecodeValue(Buf& buf) override;
   std::any DecodeValue(Buf& buf, int offset) override;
 
- private:
+  int SkipKey(BufView& buf) override;
+  int SkipValue(BufView& buf) override;
+
+  std::any DecodeKey(BufView& buf) override;
+  std::any DecodeValue(BufView& buf) override;
+  std::any DecodeValue(BufView& buf, int offset) override;
+
+  void DecodeKey(BufView& buf, RowSink& sink, int col) override;
+  void DecodeValue(BufView& buf, int offset, RowSink& sink, int col) override;
+
+  // Store the values found in dictionary as {code | 0x80000000: 4byte}, the
+  // others keep the plain form. Decoding a code needs the dictionary of the
+  // schema version that wrote it, or a later one.
+  void SetDictionary(StringDictionaryPtr dictionary) {
+    dictionary_ = std::move(dictionary);
+  }
+  const StringDictionaryPtr& GetDictionary() const { return dictionary_; }
+
+  // The value at offset without a copy: a view into buf, or into the
+  // dictionary for a code, valid while they live.
+  std::string_view DecodeValueView(const BufView& buf, int offset) const;
+
+  // Dictionary code of the value at offset, StringDictionary::kNoCode for a
+  // value stored in the plain form and missing from the dictionary.
+  int32_t DecodeCode(BufView& buf, int offset) const;
+
+  // The memory comparable form of a key string, groups of 8 bytes each
+  // followed by a marker. Decode appends to data and returns -1 for bytes not
+  // in that form.
   static int EncodeBytesComparable(const std::string& data, Buf& buf);
-  static int DecodeBytesComparable(Buf& buf, std::string& data);
+  template <typename B>
+  static int DecodeBytesComparable(B& buf, std::string& data);
+
+  // The escaped memory comparable form, the bytes with every 0x00 followed by
+  // 0xFF and the string ended by 0x00 0x01: 2 bytes over the data for a
+  // string without zero bytes, where the groups take 9 bytes per 8 and at
+  // least 9. Decode as above.
+  static int EncodeBytesEscaped(const std::string& data, Buf& buf);
+  template <typename B>
+  static int DecodeBytesEscaped(B& buf, std::string& data);
+  static int EscapedLength(const std::string& data);
+
+  // Write the key in the escaped form instead of the groups. Strings sort
+  // the same in both, the bytes differ, so writer and reader schemas must
+  // agree.
+  void SetEscapedKey(bool escaped) { escaped_key_ = escaped; }
+  bool IsEscapedKey() const { return escaped_key_; }
+
+  // Bytes of the key column at data with its null flag, found from the group
+  // markers or the terminator alone, -1 when the size bytes end before it or
+  // are not in the key form.
+  int ScanKeyLength(const char* data, size_t size) const;
+
+  // Values of exactly length bytes, such as hash ids or UUIDs, kept as their
+  // raw bytes: no length prefix in the value and no groups in the key, the
+  // raw bytes comparing as the strings do. A null key is its flag then length
+  // zero bytes, so GetLengthForKey / GetLengthForValue are known and the
+  // column takes a fixed slot of a static offsets value. Encoding data of
+  // another length throws, a dictionary is not used. 0 for strings of any
+  // length. Writer and reader schemas must agree.
+  void SetFixedLength(int length);
+  int GetFixedLength() const { return fixed_length_; }
+
+ private:
+  // the encoders of both forms, data is nullptr for null.
+  int EncodeKeyData(const std::string* data, Buf& buf);
+  int EncodedKeyLength(const std::string* data);
+  int EncodeValueData(const std::string* data, Buf& buf);
+  int EncodedValueLength(const std::string* data);
+
+  template <typename B>
+  int SkipKeyImpl(B& buf);
+  template <typename B>
+  int SkipValueImpl(B& buf);
+
+  template <typename B>
+  std::any DecodeKeyImpl(B& buf);
+  void DecodeKeyImpl(BufView& buf, RowSink& sink, int col);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf);
+  template <typename B>
+  std::any DecodeValueImpl(B& buf, int offset);
+
+  template <typename B>
+  static int SkipBytesComparable(B& buf);
+
+  // the key bytes of a not null key in the form of the schema.
+  int EncodeKeyBytes(const std::string& data, Buf& buf) const;
+  template <typename B>
+  int DecodeKeyBytes(B& buf, std::string& data) const;
+  template <typename B>
+  int SkipKeyBytes(B& buf) const;
+
+  // bytes of the descending key at the read offset of buf, and the key
+  // inverted back to its ascending form.
+  template <typename B>
+  int DescendingKeyLength(B& buf);
+  template <typename B>
+  BufView AscendingKey(B& buf);
+
+  // throws for data not of the fixed length.
+  void CheckFixedLength(const std::string& data) const;
 
   static int EncodeBytesNotComparable(const std::string& data, Buf& buf);
-  static void DecodeBytesNotComparable(Buf& buf, std::string& data);
-  static void DecodeBytesNotComparable(Buf& buf, std::string& data, int offset);
+  template <typename B>
+  std::string_view DecodeBytesNotComparable(B& buf, int offset) const;
+
+  StringDictionaryPtr dictionary_;
+  bool escaped_key_{false};
+  int fixed_length_{0};
 };
 
 }  // namespace serialV2
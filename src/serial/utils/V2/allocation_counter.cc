@@ -0,0 +1,58 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/utils/V2/allocation_counter.h"
+
+#if defined(DINGO_SERIAL_COUNT_ALLOCATIONS)
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// constant initialized, so operator new may count before any constructor.
+thread_local dingodb::serialV2::AllocationCounts thread_counts;
+
+void* CountedAlloc(size_t size) {
+  thread_counts.count++;
+  thread_counts.bytes += size;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+#if defined(DINGO_SERIAL_COUNT_ALLOCATIONS)
+bool AllocationCountingEnabled() { return true; }
+AllocationCounts ThreadAllocationCounts() { return thread_counts; }
+#else
+bool AllocationCountingEnabled() { return false; }
+AllocationCounts ThreadAllocationCounts() { return {}; }
+#endif
+
+}  // namespace serialV2
+}  // namespace dingodb
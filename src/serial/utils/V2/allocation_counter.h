@@ -0,0 +1,55 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_ALLOCATION_COUNTER_V2_H_
+#define DINGO_SERIAL_ALLOCATION_COUNTER_V2_H_
+
+#include <cstdint>
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Allocations of the calling thread through the global operator new. They
+ * are only counted in builds with DINGO_SERIAL_COUNT_ALLOCATIONS (cmake
+ * -DWITH_ALLOCATION_COUNTING=ON, meant for debug builds and tests), which
+ * replaces operator new for the whole program; otherwise the counts stay 0.
+ */
+struct AllocationCounts {
+  uint64_t count{0};
+  uint64_t bytes{0};
+};
+
+bool AllocationCountingEnabled();
+AllocationCounts ThreadAllocationCounts();
+
+// Allocations of the thread since construction, e.g. around the rows of a
+// test to compare them with a budget.
+class AllocationScope {
+ public:
+  AllocationScope() : start_(ThreadAllocationCounts()) {}
+
+  AllocationCounts Counts() const {
+    AllocationCounts now = ThreadAllocationCounts();
+    return {now.count - start_.count, now.bytes - start_.bytes};
+  }
+
+ private:
+  AllocationCounts start_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
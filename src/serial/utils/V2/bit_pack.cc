@@ -0,0 +1,137 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/utils/V2/bit_pack.h"
+
+#include <cstring>
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// 8 bytes with byte i at the low end, whatever the host order.
+inline uint64_t LoadLittle64(const uint8_t* p) {
+  uint64_t word;
+  memcpy(&word, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+inline void StoreLittle64(uint8_t* p, uint64_t word) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  memcpy(p, &word, 8);
+}
+
+constexpr uint64_t kLowBits = 0x0101010101010101ULL;
+
+// 8 byte bools to one byte of bits: normalize every byte to 0/1, the multiply
+// then gathers byte i's low bit into bit 56 + i.
+inline uint8_t PackByte(uint64_t bools) {
+  uint64_t ones = ((bools | (bools >> 1) | (bools >> 2) | (bools >> 3) |
+                    (bools >> 4) | (bools >> 5) | (bools >> 6) | (bools >> 7)) &
+                   kLowBits);
+  return static_cast<uint8_t>((ones * 0x0102040810204080ULL) >> 56);
+}
+
+// one byte of bits to 8 byte bools: spread the byte over all lanes, keep bit i
+// in lane i and turn it into 0/1.
+inline uint64_t UnpackByte(uint8_t bits) {
+  uint64_t spread = (bits * kLowBits) & 0x8040201008040201ULL;
+  return ((spread + 0x7F7F7F7F7F7F7F7FULL) >> 7) & kLowBits;
+}
+
+}  // namespace
+
+void PackBools(const uint8_t* bools, size_t count, uint8_t* bits) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    *bits++ = PackByte(LoadLittle64(bools + i));
+  }
+
+  if (i < count) {
+    uint8_t tail[8] = {0};
+    memcpy(tail, bools + i, count - i);
+    *bits = PackByte(LoadLittle64(tail));
+  }
+}
+
+void PackBools(const std::vector<bool>& bools, uint8_t* bits) {
+  // vector<bool> has no byte access, gather a word of bits at a time.
+  size_t count = bools.size();
+  auto it = bools.begin();
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t word = 0;
+    for (int j = 0; j < 64; ++j, ++it) {
+      word |= static_cast<uint64_t>(*it) << j;
+    }
+    StoreLittle64(bits, word);
+    bits += 8;
+  }
+
+  uint8_t byte = 0;
+  for (int j = 0; i < count; ++i, ++j, ++it) {
+    if (j == 8) {
+      *bits++ = byte;
+      byte = 0;
+      j = 0;
+    }
+    byte |= static_cast<uint8_t>(*it) << j;
+  }
+  if (count % 64 != 0) {
+    *bits = byte;
+  }
+}
+
+void UnpackBools(const uint8_t* bits, size_t count, uint8_t* bools) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    StoreLittle64(bools + i, UnpackByte(*bits++));
+  }
+
+  if (i < count) {
+    uint8_t tail[8];
+    StoreLittle64(tail, UnpackByte(*bits));
+    memcpy(bools + i, tail, count - i);
+  }
+}
+
+void UnpackBools(const uint8_t* bits, size_t count, std::vector<bool>& bools) {
+  bools.resize(count);
+  auto it = bools.begin();
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t word = LoadLittle64(bits);
+    bits += 8;
+    for (int j = 0; j < 64; ++j, ++it) {
+      *it = (word >> j) & 1;
+    }
+  }
+
+  for (int j = 0; i < count; ++i, ++j, ++it) {
+    if (j == 8) {
+      ++bits;
+      j = 0;
+    }
+    *it = (*bits >> j) & 1;
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
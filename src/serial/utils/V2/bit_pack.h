@@ -0,0 +1,41 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_BIT_PACK_V2_H_
+#define DINGO_SERIAL_BIT_PACK_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+// Bytes needed for count packed bits.
+inline size_t PackedBitsSize(size_t count) { return (count + 7) / 8; }
+
+// Pack count bools into PackedBitsSize(count) bytes, element i is bit i % 8 of
+// byte i / 8, the unused high bits of the last byte are zero. A byte bool is
+// true when not zero.
+void PackBools(const uint8_t* bools, size_t count, uint8_t* bits);
+void PackBools(const std::vector<bool>& bools, uint8_t* bits);
+
+// The reverse of PackBools, byte bools are 0 or 1.
+void UnpackBools(const uint8_t* bits, size_t count, uint8_t* bools);
+void UnpackBools(const uint8_t* bits, size_t count, std::vector<bool>& bools);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,96 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "bloom_filter.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+// Odd multipliers spreading the low half of a hash over the 8 words, as in
+// the parquet split block filter.
+static constexpr uint32_t kSalts[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                                       0xa2b7289dU, 0x705495c7U, 0x2df1424bU,
+                                       0x9efc4947U, 0x5c6bfb31U};
+
+static inline uint32_t LoadWord(const char* data) {
+  uint32_t word;
+  memcpy(&word, data, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap32(word);
+#endif
+  return word;
+}
+
+static inline void StoreWord(char* data, uint32_t word) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap32(word);
+#endif
+  memcpy(data, &word, 4);
+}
+
+// the high half of the hash picks the block.
+static inline size_t BlockOffset(uint64_t hash, size_t block_count) {
+  return ((hash >> 32) * block_count >> 32) * BlockedBloomFilter::kBlockSize;
+}
+
+BlockedBloomFilter::BlockedBloomFilter(size_t key_count, int bits_per_key) {
+  size_t bits = key_count * (bits_per_key > 0 ? bits_per_key : 1);
+  size_t block_count = (bits + kBlockSize * 8 - 1) / (kBlockSize * 8);
+  data_.resize((block_count > 0 ? block_count : 1) * kBlockSize);
+}
+
+void BlockedBloomFilter::Add(uint64_t hash) {
+  char* block = data_.data() + BlockOffset(hash, data_.size() / kBlockSize);
+  uint32_t key = static_cast<uint32_t>(hash);
+  for (int i = 0; i < 8; ++i) {
+    uint32_t word = LoadWord(block + i * 4) | 1U << ((key * kSalts[i]) >> 27);
+    StoreWord(block + i * 4, word);
+  }
+}
+
+bool BlockedBloomFilter::MayContain(std::string_view data, uint64_t hash) {
+  size_t block_count = data.size() / kBlockSize;
+  if (block_count == 0 || data.size() % kBlockSize != 0) {
+    return false;
+  }
+  const char* block = data.data() + BlockOffset(hash, block_count);
+  uint32_t key = static_cast<uint32_t>(hash);
+
+  // The vector path is taken when the target allows it (-mavx2), x86 being
+  // little endian the words are loaded as they are.
+#if defined(__AVX2__)
+  const __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kSalts));
+  __m256i shifts = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32(key), salts), 27);
+  __m256i masks = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+  __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+  return _mm256_testc_si256(words, masks) != 0;
+#else
+  bool found = true;
+  for (int i = 0; i < 8; ++i) {
+    found &= (LoadWord(block + i * 4) >> ((key * kSalts[i]) >> 27)) & 1;
+  }
+  return found;
+#endif
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,59 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DINGO_SERIAL_BLOOM_FILTER_V2_H_
+#define DINGO_SERIAL_BLOOM_FILTER_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * A split block bloom filter of 64 bits hashes, e.g. of Hash64. A hash picks
+ * one 32 bytes block and sets one bit in each of its 8 words, so a probe reads
+ * one cache line and tests the 8 words at once. About 1% false positives at
+ * 10 bits per key.
+ *
+ * The filter is its bytes, the words little endian, so a filter built on one
+ * host may be stored and probed on any other without copying it.
+ */
+class BlockedBloomFilter {
+ public:
+  static constexpr size_t kBlockSize = 32;
+
+  // Room for key_count keys at bits_per_key bits each, at least one block.
+  explicit BlockedBloomFilter(size_t key_count, int bits_per_key = 10);
+
+  void Add(uint64_t hash);
+  bool MayContain(uint64_t hash) const { return MayContain(data_, hash); }
+
+  // Probe the bytes of a filter, false for data not a whole number of
+  // blocks.
+  static bool MayContain(std::string_view data, uint64_t hash);
+
+  const std::string& Data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
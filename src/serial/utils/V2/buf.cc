@@ -19,8 +19,10 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
+#include "serial/utils/V2/byte_order.h"
 #include "serial/utils/V2/compiler.h"
 
 namespace dingodb {
@@ -38,358 +40,245 @@ Buf::Buf(std::string&& s, bool le) : le_(le) { buf_.swap(s); }
 
 Buf::Buf(std::string&& s) : Buf(s, true) {}
 
-void Buf::Write(uint8_t data) { buf_.push_back(data); }
+Buf::Buf(char* dst, size_t cap, bool le) : le_(le), dst_(dst), dst_cap_(cap) {}
 
-void Buf::WriteWithNegation(uint8_t data) { buf_.push_back(~data); }
+namespace {
 
-void Buf::Enlarge(size_t len) { this->buf_.resize(buf_.size() + len); }
+// Convert between host order and the order bytes are kept in the buffer, for
+// le buffers the bytes are big endian.
+template <typename T>
+inline T ToBufOrder(T v, bool le) {
+  return le ? SwappedByteOrder::Convert(v) : v;
+}
 
-void Buf::WriteInt(int32_t data) {
-  size_t curr_size = buf_.size();
-  buf_.resize(curr_size + 4);
+}  // namespace
 
-  char* buf = buf_.data();
-  uint8_t* i = (uint8_t*)&data;
-  if (DINGO_LIKELY(this->le_)) {
-    buf[curr_size] = *(i + 3);
-    buf[curr_size + 1] = *(i + 2);
-    buf[curr_size + 2] = *(i + 1);
-    buf[curr_size + 3] = *i;
-  } else {
-    buf[curr_size] = *i;
-    buf[curr_size + 1] = *(i + 1);
-    buf[curr_size + 2] = *(i + 2);
-    buf[curr_size + 3] = *(i + 3);
+inline char* Buf::ExtendDst(size_t len) {
+  if (DINGO_UNLIKELY(len > dst_cap_ - dst_size_)) {
+    throw std::out_of_range("Out of range.");
   }
+  char* end = dst_ + dst_size_;
+  dst_size_ += len;
+  return end;
 }
 
-void Buf::WriteByte(size_t pos, uint8_t data) {
-  if (DINGO_UNLIKELY(pos + 1 > buf_.size())) {
-    throw std::runtime_error("Out of range.");
+inline char Buf::At(size_t pos) const {
+  if (dst_ == nullptr) {
+    return buf_.at(pos);
   }
-
-  char* buf = buf_.data();
-  buf[pos] = (char)data;
+  if (DINGO_UNLIKELY(pos >= dst_size_)) {
+    throw std::out_of_range("Out of range.");
+  }
+  return dst_[pos];
 }
 
-void Buf::WriteShort(int16_t data) {
-  size_t curr_size = buf_.size();
-  buf_.resize(curr_size + 2);
-
-  char* buf = buf_.data();
-  uint8_t* i = (uint8_t*)&data;
-  if (DINGO_LIKELY(this->le_)) {
-    buf[curr_size] = *(i + 1);
-    buf[curr_size + 1] = *i;
-  } else {
-    buf[curr_size] = *i;
-    buf[curr_size + 1] = *(i + 1);
+template <typename T>
+inline void Buf::AppendWord(T word) {
+  word = ToBufOrder(word, le_);
+  if (DINGO_UNLIKELY(dst_ != nullptr)) {
+    memcpy(ExtendDst(sizeof(T)), &word, sizeof(T));
+    return;
   }
+  buf_.append(reinterpret_cast<const char*>(&word), sizeof(T));
 }
 
-void Buf::WriteShort(size_t pos, int16_t data) {
-  if (DINGO_UNLIKELY(pos + 2 > buf_.size())) {
+template <typename T>
+inline void Buf::StoreWord(size_t pos, T word) {
+  if (DINGO_UNLIKELY(pos + sizeof(T) > Size())) {
     throw std::runtime_error("Out of range.");
   }
 
-  char* buf = buf_.data();
-  uint8_t* i = (uint8_t*)&data;
-  if (DINGO_LIKELY(this->le_)) {
-    buf[pos] = *(i + 1);
-    buf[pos + 1] = *i;
-  } else {
-    buf[pos] = *i;
-    buf[pos + 1] = *(i + 1);
+  word = ToBufOrder(word, le_);
+  memcpy(Data() + pos, &word, sizeof(T));
+}
+
+template <typename T>
+inline T Buf::LoadWord(size_t pos) const {
+  if (DINGO_UNLIKELY(pos > Size() || sizeof(T) > Size() - pos)) {
+    throw std::out_of_range("Out of range.");
   }
+
+  T word;
+  memcpy(&word, Data() + pos, sizeof(T));
+  return ToBufOrder(word, le_);
 }
 
-void Buf::WriteInt(size_t pos, int32_t data) {
-  if (DINGO_UNLIKELY(pos + 4 > buf_.size())) {
-    throw std::runtime_error("Out of range.");
+// The first byte in the buffer carries the sign bit of the big endian word.
+template <typename T>
+inline T Buf::FirstBitMask() const {
+  return le_ ? SwappedByteOrder::FirstBitMask<T>()
+             : HostByteOrder::FirstBitMask<T>();
+}
+
+void Buf::Write(uint8_t data) {
+  if (DINGO_UNLIKELY(dst_ != nullptr)) {
+    *ExtendDst(1) = data;
+    return;
   }
+  buf_.push_back(data);
+}
+
+void Buf::WriteWithNegation(uint8_t data) { Write(~data); }
+
+void Buf::Enlarge(size_t len) { ReSize(Size() + len); }
 
-  char* buf = buf_.data();
-  uint8_t* i = (uint8_t*)&data;
-  if (DINGO_LIKELY(this->le_)) {
-    buf[pos] = *(i + 3);
-    buf[pos + 1] = *(i + 2);
-    buf[pos + 2] = *(i + 1);
-    buf[pos + 3] = *i;
-  } else {
-    buf[pos] = *i;
-    buf[pos + 1] = *(i + 1);
-    buf[pos + 2] = *(i + 2);
-    buf[pos + 3] = *(i + 3);
+// the bytes grown are zeroed for the caller's memory as for a string.
+void Buf::ReSize(size_t size) {
+  if (dst_ == nullptr) {
+    buf_.resize(size);
+    return;
   }
+  if (size > dst_size_) {
+    memset(ExtendDst(size - dst_size_), 0, size - dst_size_);
+  }
+  dst_size_ = size;
 }
 
-void Buf::WriteLong(int64_t data) {
-  uint8_t* i = (uint8_t*)&data;
-  if (DINGO_LIKELY(this->le_)) {
-    buf_.push_back(*(i + 7));
-    buf_.push_back(*(i + 6));
-    buf_.push_back(*(i + 5));
-    buf_.push_back(*(i + 4));
-    buf_.push_back(*(i + 3));
-    buf_.push_back(*(i + 2));
-    buf_.push_back(*(i + 1));
-    buf_.push_back(*i);
-  } else {
-    buf_.push_back(*i);
-    buf_.push_back(*(i + 1));
-    buf_.push_back(*(i + 2));
-    buf_.push_back(*(i + 3));
-    buf_.push_back(*(i + 4));
-    buf_.push_back(*(i + 5));
-    buf_.push_back(*(i + 6));
-    buf_.push_back(*(i + 7));
+void Buf::WriteByte(size_t pos, uint8_t data) {
+  if (DINGO_UNLIKELY(pos + 1 > Size())) {
+    throw std::runtime_error("Out of range.");
   }
+
+  char* buf = Data();
+  buf[pos] = (char)data;
+}
+
+void Buf::WriteShort(int16_t data) { AppendWord(static_cast<uint16_t>(data)); }
+
+void Buf::WriteShort(size_t pos, int16_t data) {
+  StoreWord(pos, static_cast<uint16_t>(data));
+}
+
+void Buf::WriteInt(int32_t data) { AppendWord(static_cast<uint32_t>(data)); }
+
+void Buf::WriteInt(size_t pos, int32_t data) {
+  StoreWord(pos, static_cast<uint32_t>(data));
+}
+
+void Buf::WriteIntWithNegation(int32_t data) {
+  AppendWord(~static_cast<uint32_t>(data));
+}
+
+void Buf::WriteIntWithFirstBitNegation(int32_t data) {
+  AppendWord(static_cast<uint32_t>(data) ^ FirstBitMask<uint32_t>());
 }
 
+void Buf::WriteLong(int64_t data) { AppendWord(static_cast<uint64_t>(data)); }
+
 void Buf::WriteLongWithNegation(int64_t data) {
-  uint8_t* i = (uint8_t*)&data;
-  if (DINGO_LIKELY(this->le_)) {
-    buf_.push_back(~*(i + 7));
-    buf_.push_back(~*(i + 6));
-    buf_.push_back(~*(i + 5));
-    buf_.push_back(~*(i + 4));
-    buf_.push_back(~*(i + 3));
-    buf_.push_back(~*(i + 2));
-    buf_.push_back(~*(i + 1));
-    buf_.push_back(~*i);
-
-  } else {
-    buf_.push_back(~*i);
-    buf_.push_back(~*(i + 1));
-    buf_.push_back(~*(i + 2));
-    buf_.push_back(~*(i + 3));
-    buf_.push_back(~*(i + 4));
-    buf_.push_back(~*(i + 5));
-    buf_.push_back(~*(i + 6));
-    buf_.push_back(~*(i + 7));
-  }
+  AppendWord(~static_cast<uint64_t>(data));
 }
 
 void Buf::WriteLongWithFirstBitNegation(int64_t data) {
-  uint8_t* i = (uint8_t*)&data;
-  if (DINGO_LIKELY(this->le_)) {
-    buf_.push_back(*(i + 7) ^ 0x80);
-    buf_.push_back(*(i + 6));
-    buf_.push_back(*(i + 5));
-    buf_.push_back(*(i + 4));
-    buf_.push_back(*(i + 3));
-    buf_.push_back(*(i + 2));
-    buf_.push_back(*(i + 1));
-    buf_.push_back(*i);
-
-  } else {
-    buf_.push_back(*i ^ 0x80);
-    buf_.push_back(*(i + 1));
-    buf_.push_back(*(i + 2));
-    buf_.push_back(*(i + 3));
-    buf_.push_back(*(i + 4));
-    buf_.push_back(*(i + 5));
-    buf_.push_back(*(i + 6));
-    buf_.push_back(*(i + 7));
-  }
+  AppendWord(static_cast<uint64_t>(data) ^ FirstBitMask<uint64_t>());
 }
 
-void Buf::WriteString(const std::string& data) {
-  size_t curr_size = buf_.size();
-  buf_.resize(curr_size + data.size());
-
-  memcpy(buf_.data() + curr_size, data.data(), data.size());
+void Buf::WriteFloatComparable(float data) {
+  uint32_t bits;
+  memcpy(&bits, &data, 4);
+  AppendWord(
+      ToComparableFloatWord(bits, !(data >= 0), FirstBitMask<uint32_t>()));
 }
 
-uint8_t Buf::Peek() { return buf_.at(read_offset_); }
-
-int32_t Buf::PeekInt() {
-  if (DINGO_LIKELY(this->le_)) {
-    char* buf = buf_.data();
-    return ((buf[read_offset_] & 0xFF) << 24) |
-           ((buf[read_offset_ + 1] & 0xFF) << 16) |
-           ((buf[read_offset_ + 2] & 0xFF) << 8) |
-           (buf[read_offset_ + 3] & 0xFF);
-  } else {
-    char* buf = buf_.data();
-    return (buf[read_offset_] & 0xFF) | ((buf[read_offset_ + 1] & 0xFF) << 8) |
-           ((buf[read_offset_ + 2] & 0xFF) << 16) |
-           ((buf[read_offset_ + 3] & 0xFF) << 24);
-  }
+void Buf::WriteDoubleComparable(double data) {
+  uint64_t bits;
+  memcpy(&bits, &data, 8);
+  AppendWord(
+      ToComparableFloatWord(bits, !(data >= 0), FirstBitMask<uint64_t>()));
 }
 
-int64_t Buf::PeekLong() {
-  char* buf = buf_.data();
-  int64_t l = 0;
-  if (DINGO_LIKELY(this->le_)) {
-    l |= (buf[read_offset_] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 1] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 2] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 3] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 4] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 5] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 6] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 7] & 0xFF);
-
-  } else {
-    l |= (buf[read_offset_ + 7] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 6] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 5] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 4] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 3] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 2] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_ + 1] & 0xFF);
-    l <<= 8;
-    l |= (buf[read_offset_] & 0xFF);
+void Buf::WriteString(const std::string& data) {
+  if (DINGO_UNLIKELY(dst_ != nullptr)) {
+    memcpy(ExtendDst(data.size()), data.data(), data.size());
+    return;
   }
-  return l;
+  buf_.append(data);
 }
 
-uint8_t Buf::Read() { return buf_.at(read_offset_++); }
+uint8_t Buf::Peek() { return At(read_offset_); }
+
+int32_t Buf::PeekInt() { return static_cast<int32_t>(LoadWord<uint32_t>(read_offset_)); }
+
+int64_t Buf::PeekLong() { return static_cast<int64_t>(LoadWord<uint64_t>(read_offset_)); }
+
+uint8_t Buf::Read() { return At(read_offset_++); }
 
 uint8_t Buf::Read(size_t pos) {
-  uint8_t ret = buf_.at(pos);
+  uint8_t ret = At(pos);
   return ret;
 }
 
 int16_t Buf::ReadShort() {
-  if (DINGO_LIKELY(this->le_)) {
-    int a = Read();
-    int b = Read();
-    return ((a & 0xFF) << 8) | (b & 0xFF);
-  } else {
-    return (Read() & 0xFF) | ((Read() & 0xFF) << 8);
-  }
-}
-
-int16_t Buf::ReadShort(int pos) {
-  int ret = 0;
-  if (DINGO_LIKELY(this->le_)) {
-    ret = ((buf_.at(pos) & 0xFF) << 8) | (buf_.at(pos + 1) & 0xFF);
-  } else {
-    ret = (buf_.at(pos) & 0xFF) | ((buf_.at(pos + 1) & 0xFF) << 8);
-  }
+  int16_t ret = ReadShort(read_offset_);
+  read_offset_ += 2;
   return ret;
 }
 
+int16_t Buf::ReadShort(size_t pos) { return static_cast<int16_t>(LoadWord<uint16_t>(pos)); }
+
 int32_t Buf::ReadInt() {
-  if (DINGO_LIKELY(this->le_)) {
-    return ((Read() & 0xFF) << 24) | ((Read() & 0xFF) << 16) |
-           ((Read() & 0xFF) << 8) | (Read() & 0xFF);
-  } else {
-    return (Read() & 0xFF) | ((Read() & 0xFF) << 8) | ((Read() & 0xFF) << 16) |
-           ((Read() & 0xFF) << 24);
-  }
+  int32_t ret = ReadInt(read_offset_);
+  read_offset_ += 4;
+  return ret;
 }
 
-int32_t Buf::ReadInt(int pos) {
-  if (DINGO_LIKELY(this->le_)) {
-    return ((buf_.at(pos) & 0xFF) << 24) | ((buf_.at(pos + 1) & 0xFF) << 16) |
-           ((buf_.at(pos + 2) & 0xFF) << 8) | (buf_.at(pos + 3) & 0xFF);
-  } else {
-    return (buf_.at(pos) & 0xFF) | ((buf_.at(pos + 1) & 0xFF) << 8) |
-           ((buf_.at(pos + 2) & 0xFF) << 16) |
-           ((buf_.at(pos + 3) & 0xFF) << 24);
-  }
+int32_t Buf::ReadInt(size_t pos) { return static_cast<int32_t>(LoadWord<uint32_t>(pos)); }
+
+int32_t Buf::ReadIntWithNegation() { return ~ReadInt(); }
+
+int32_t Buf::ReadIntWithFirstBitNegation() {
+  return static_cast<int32_t>(static_cast<uint32_t>(ReadInt()) ^ FirstBitMask<uint32_t>());
 }
 
 int64_t Buf::ReadLong() {
-  uint64_t l = Read() & 0xFF;
-  if (DINGO_LIKELY(this->le_)) {
-    for (int i = 0; i < 7; i++) {
-      l <<= 8;
-      l |= Read() & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 8; i++) {
-      l |= (((uint64_t)Read() & 0xFF) << (8 * i));
-    }
-  }
-  return l;
+  int64_t ret = ReadLong(read_offset_);
+  read_offset_ += 8;
+  return ret;
 }
 
-int64_t Buf::ReadLong(int pos) {
-  char* buf = buf_.data();
-  int64_t l = 0;
-  if (DINGO_LIKELY(this->le_)) {
-    l |= (buf[pos] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 1] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 2] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 3] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 4] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 5] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 6] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 7] & 0xFF);
-
-  } else {
-    l |= (buf[pos + 7] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 6] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 5] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 4] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 3] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 2] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos + 1] & 0xFF);
-    l <<= 8;
-    l |= (buf[pos] & 0xFF);
-  }
-  return l;
-}
+int64_t Buf::ReadLong(size_t pos) { return static_cast<int64_t>(LoadWord<uint64_t>(pos)); }
+
+int64_t Buf::ReadLongWithNegation() { return ~ReadLong(); }
 
 int64_t Buf::ReadLongWithFirstBitNegation() {
-  uint64_t l = (Read() & 0xFF) ^ 0x80;
-  if (IsLe()) {
-    for (int i = 0; i < 7; i++) {
-      l <<= 8;
-      l |= Read() & 0xFF;
-    }
-  } else {
-    for (int i = 1; i < 8; i++) {
-      l |= (((uint64_t)Read() & 0xFF) << (8 * i));
-    }
-  }
+  return static_cast<int64_t>(static_cast<uint64_t>(ReadLong()) ^ FirstBitMask<uint64_t>());
+}
+
+uint32_t Buf::ReadFloatComparable() {
+  return FromComparableFloatWord(static_cast<uint32_t>(ReadInt()),
+                                 FirstBitMask<uint32_t>());
+}
 
-  return l;
+uint64_t Buf::ReadDoubleComparable() {
+  return FromComparableFloatWord(static_cast<uint64_t>(ReadLong()),
+                                 FirstBitMask<uint64_t>());
 }
 
 void Buf::Skip(size_t size) {
-  if (DINGO_UNLIKELY(read_offset_ + size > buf_.size())) {
+  if (DINGO_UNLIKELY(read_offset_ + size > Size())) {
     throw std::runtime_error("Out of range.");
   }
 
   read_offset_ += size;
 }
 
-const std::string& Buf::GetString() { return buf_; }
+// the bytes of a buf over the caller's memory are copied out.
+const std::string& Buf::GetString() {
+  if (dst_ != nullptr) {
+    buf_.assign(dst_, dst_size_);
+  }
+  return buf_;
+}
 
-void Buf::GetString(std::string& s) { s.swap(buf_); }
+void Buf::GetString(std::string& s) {
+  if (dst_ != nullptr) {
+    s.assign(dst_, dst_size_);
+    return;
+  }
+  s.swap(buf_);
+}
 
-void Buf::GetString(std::string* s) { s->swap(buf_); }
+void Buf::GetString(std::string* s) { GetString(*s); }
 
 }  // namespace serialV2
 }  // namespace dingodb
\ No newline at end of file
@@ -45,13 +45,17 @@ class Buf {
 
   Buf(std::string&& s, bool le);
   Buf(std::string&& s);
+  // Write into the cap bytes at dst, which the caller owns, instead of a
+  // string of the buf: nothing is copied once encoded, a write past cap
+  // throws std::out_of_range.
+  Buf(char* dst, size_t cap, bool le);
   Buf() = default;
 
   ~Buf() = default;
 
   // le and end checker.
   bool IsLe() const { return le_; }
-  bool IsEnd() const { return read_offset_ == buf_.size(); }
+  bool IsEnd() const { return read_offset_ == Size(); }
 
   /**
    * For reader function with position parameters will not update read_offset_
@@ -72,15 +76,19 @@ class Buf {
   void WriteShort(int16_t data);
   void WriteShort(size_t pos, int16_t data);
   int16_t ReadShort();
-  int16_t ReadShort(int pos);
+  int16_t ReadShort(size_t pos);
   // uint16_t ReverseReadShort(int pos);
 
   // int writter and getter.
   void WriteInt(int32_t data);
   void WriteInt(size_t pos, int32_t data);
+  void WriteIntWithNegation(int32_t data);
+  void WriteIntWithFirstBitNegation(int32_t data);
   int32_t PeekInt();
   int32_t ReadInt();
-  int32_t ReadInt(int pos);
+  int32_t ReadInt(size_t pos);
+  int32_t ReadIntWithNegation();
+  int32_t ReadIntWithFirstBitNegation();
   // int32_t ReverseReadInt(int pos);
 
   // long writter and getter.
@@ -89,9 +97,18 @@ class Buf {
   void WriteLongWithFirstBitNegation(int64_t data);
   int64_t PeekLong();
   int64_t ReadLong();
-  int64_t ReadLong(int pos);
+  int64_t ReadLong(size_t pos);
+  int64_t ReadLongWithNegation();
   int64_t ReadLongWithFirstBitNegation();
 
+  // float / double in their memory comparable form, a negative value
+  // inverted whole and any other with the first bit flipped, read back as
+  // bits.
+  void WriteFloatComparable(float data);
+  void WriteDoubleComparable(double data);
+  uint32_t ReadFloatComparable();
+  uint64_t ReadDoubleComparable();
+
   // string writter and getter.
   void WriteString(const std::string& data);
   const std::string& GetString();
@@ -105,33 +122,60 @@ class Buf {
   void Clear() {
     read_offset_ = 0;
     buf_.clear();
+    dst_size_ = 0;
   }
 
   // Reserve
-  void Reserve(int cap) { buf_.reserve(cap); }
+  void Reserve(int cap) {
+    if (dst_ == nullptr) {
+      buf_.reserve(cap);
+    }
+  }
+  size_t Capacity() const { return dst_ ? dst_cap_ : buf_.capacity(); }
+
+  // raw access.
+  char* Data() { return dst_ ? dst_ : buf_.data(); }
+  const char* Data() const { return dst_ ? dst_ : buf_.data(); }
 
   // size.
-  size_t Size() const { return buf_.size(); }
-  void ReSize(size_t size) { buf_.resize(size); }
+  size_t Size() const { return dst_ ? dst_size_ : buf_.size(); }
+  void ReSize(size_t size);
   void Enlarge(size_t len);
 
   // offset
-  size_t RestReadableSize() const { return buf_.size() - read_offset_; }
+  size_t RestReadableSize() const { return Size() - read_offset_; }
   size_t ReadOffset() const { return read_offset_; }
   void SetReadOffset(size_t offset) {
-    if (DINGO_UNLIKELY(offset >= buf_.size())) {
+    if (DINGO_UNLIKELY(offset >= Size())) {
       throw std::runtime_error("Out of range.");
     }
     read_offset_ = offset;
   }
 
  private:
+  // Fixed width words are moved with a single grow and one unaligned copy.
+  template <typename T>
+  void AppendWord(T word);
+  template <typename T>
+  void StoreWord(size_t pos, T word);
+  template <typename T>
+  T LoadWord(size_t pos) const;
+  template <typename T>
+  T FirstBitMask() const;
+  // len more bytes at the end of dst_, throws past its capacity.
+  char* ExtendDst(size_t len);
+  char At(size_t pos) const;
+
   bool le_{true};
 
   size_t read_offset_{0};
 
   // for memory comparable buf_ is big endian
   std::string buf_;
+  // the caller's bytes written instead of buf_, nullptr for none.
+  char* dst_{nullptr};
+  size_t dst_size_{0};
+  size_t dst_cap_{0};
 };
 
 }  // namespace serialV2
@@ -0,0 +1,200 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_BUF_VIEW_V2_H_
+#define DINGO_SERIAL_BUF_VIEW_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "serial/utils/V2/byte_order.h"
+#include "serial/utils/V2/compiler.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * Read-only, non-owning counterpart of Buf.
+ *
+ * BufView points into bytes owned by someone else (e.g. the storage engine's
+ * key/value slices), so decoding through it never copies the input. It offers
+ * the same reader surface as Buf, with the same byte order rule: when le_ is
+ * true the bytes are big endian.
+ *
+ * The caller must keep the underlying bytes alive while the view is used.
+ */
+class BufView {
+ public:
+  BufView(const char* data, size_t size, bool le) : le_(le), data_(data), size_(size) {}
+  BufView(const char* data, size_t size) : BufView(data, size, true) {}
+
+  BufView(std::string_view s, bool le) : BufView(s.data(), s.size(), le) {}
+  BufView(std::string_view s) : BufView(s.data(), s.size(), true) {}
+  BufView() = default;
+
+  ~BufView() = default;
+
+  // le and end checker.
+  bool IsLe() const { return le_; }
+  bool IsEnd() const { return read_offset_ == size_; }
+
+  /**
+   * For reader function with position parameters will not update read_offset_
+   * field. Only the reader with no position parameters will increase
+   * read_offset_ field.
+   */
+
+  // byte getter.
+  uint8_t Peek() const {
+    CheckRange(read_offset_, 1);
+    return data_[read_offset_];
+  }
+  uint8_t Read() {
+    CheckRange(read_offset_, 1);
+    return data_[read_offset_++];
+  }
+  uint8_t Read(size_t pos) const {
+    CheckRange(pos, 1);
+    return data_[pos];
+  }
+
+  // short getter.
+  int16_t ReadShort() {
+    int16_t ret = ReadShort(read_offset_);
+    read_offset_ += 2;
+    return ret;
+  }
+  int16_t ReadShort(size_t pos) const {
+    CheckRange(pos, 2);
+    uint16_t v;
+    memcpy(&v, data_ + pos, 2);
+    return static_cast<int16_t>(le_ ? SwappedByteOrder::Convert(v) : v);
+  }
+
+  // int getter.
+  int32_t PeekInt() const { return ReadInt(read_offset_); }
+  int32_t ReadInt() {
+    int32_t ret = ReadInt(read_offset_);
+    read_offset_ += 4;
+    return ret;
+  }
+  int32_t ReadInt(size_t pos) const {
+    CheckRange(pos, 4);
+    uint32_t v;
+    memcpy(&v, data_ + pos, 4);
+    return static_cast<int32_t>(le_ ? SwappedByteOrder::Convert(v) : v);
+  }
+  int32_t ReadIntWithNegation() { return ~ReadInt(); }
+  int32_t ReadIntWithFirstBitNegation() {
+    uint32_t mask = le_ ? SwappedByteOrder::FirstBitMask<uint32_t>()
+                      : HostByteOrder::FirstBitMask<uint32_t>();
+    return static_cast<int32_t>(static_cast<uint32_t>(ReadInt()) ^ mask);
+  }
+
+  // long getter.
+  int64_t PeekLong() const { return ReadLong(read_offset_); }
+  int64_t ReadLong() {
+    int64_t ret = ReadLong(read_offset_);
+    read_offset_ += 8;
+    return ret;
+  }
+  int64_t ReadLong(size_t pos) const {
+    CheckRange(pos, 8);
+    uint64_t v;
+    memcpy(&v, data_ + pos, 8);
+    return static_cast<int64_t>(le_ ? SwappedByteOrder::Convert(v) : v);
+  }
+  int64_t ReadLongWithNegation() { return ~ReadLong(); }
+  int64_t ReadLongWithFirstBitNegation() {
+    uint64_t mask = le_ ? SwappedByteOrder::FirstBitMask<uint64_t>()
+                      : HostByteOrder::FirstBitMask<uint64_t>();
+    return static_cast<int64_t>(static_cast<uint64_t>(ReadLong()) ^ mask);
+  }
+
+  // float / double bits from their memory comparable form.
+  uint32_t ReadFloatComparable() {
+    uint32_t first = le_ ? SwappedByteOrder::FirstBitMask<uint32_t>()
+                         : HostByteOrder::FirstBitMask<uint32_t>();
+    return FromComparableFloatWord(static_cast<uint32_t>(ReadInt()), first);
+  }
+  uint64_t ReadDoubleComparable() {
+    uint64_t first = le_ ? SwappedByteOrder::FirstBitMask<uint64_t>()
+                         : HostByteOrder::FirstBitMask<uint64_t>();
+    return FromComparableFloatWord(static_cast<uint64_t>(ReadLong()), first);
+  }
+
+  // The positional getters without the range check, for bytes already
+  // checked to hold what is read, as a trusted decode does.
+  uint8_t ReadUnchecked(size_t pos) const { return data_[pos]; }
+  int16_t ReadShortUnchecked(size_t pos) const {
+    uint16_t v;
+    memcpy(&v, data_ + pos, 2);
+    return static_cast<int16_t>(le_ ? SwappedByteOrder::Convert(v) : v);
+  }
+  int32_t ReadIntUnchecked(size_t pos) const {
+    uint32_t v;
+    memcpy(&v, data_ + pos, 4);
+    return static_cast<int32_t>(le_ ? SwappedByteOrder::Convert(v) : v);
+  }
+
+  // skip.
+  void Skip(size_t size) {
+    if (DINGO_UNLIKELY(read_offset_ + size > size_)) {
+      throw std::runtime_error("Out of range.");
+    }
+
+    read_offset_ += size;
+  }
+
+  // raw access.
+  const char* Data() const { return data_; }
+  std::string_view GetStringView() const { return std::string_view(data_, size_); }
+
+  // size.
+  size_t Size() const { return size_; }
+
+  // offset
+  size_t RestReadableSize() const { return size_ - read_offset_; }
+  size_t ReadOffset() const { return read_offset_; }
+  void SetReadOffset(size_t offset) {
+    if (DINGO_UNLIKELY(offset >= size_)) {
+      throw std::runtime_error("Out of range.");
+    }
+    read_offset_ = offset;
+  }
+
+ private:
+  // pos + len may wrap, a negative position cast to size_t does.
+  void CheckRange(size_t pos, size_t len) const {
+    if (DINGO_UNLIKELY(pos > size_ || len > size_ - pos)) {
+      throw std::out_of_range("Out of range.");
+    }
+  }
+
+  bool le_{true};
+
+  size_t read_offset_{0};
+
+  const char* data_{nullptr};
+  size_t size_{0};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,119 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_BYTE_ORDER_V2_H_
+#define DINGO_SERIAL_BYTE_ORDER_V2_H_
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dingodb {
+namespace serialV2 {
+
+// Words as a buffer keeps them, swapped from host order when kSwap, which is
+// the le flag of the buffer. Codecs pick the order once from their le flag
+// and run their per column code with it fixed.
+template <bool kSwap>
+struct ByteOrder {
+  static constexpr bool kSwapped = kSwap;
+
+  // host order to buffer order, and back.
+  static uint8_t Convert(uint8_t word) { return word; }
+  static uint16_t Convert(uint16_t word) {
+    return kSwap ? __builtin_bswap16(word) : word;
+  }
+  static uint32_t Convert(uint32_t word) {
+    return kSwap ? __builtin_bswap32(word) : word;
+  }
+  static uint64_t Convert(uint64_t word) {
+    return kSwap ? __builtin_bswap64(word) : word;
+  }
+
+  // The bit that is first in the buffer, flipped by memory comparable
+  // numbers.
+  template <typename T>
+  static constexpr T FirstBitMask() {
+    return kSwap ? static_cast<T>(T(0x80) << (sizeof(T) * 8 - 8)) : T(0x80);
+  }
+
+  template <typename T>
+  static T Load(const char* data) {
+    T word;
+    memcpy(&word, data, sizeof(T));
+    return Convert(word);
+  }
+
+  template <typename T>
+  static void Store(char* data, T word) {
+    word = Convert(word);
+    memcpy(data, &word, sizeof(T));
+  }
+
+  // A fixed width value as the number schemas write it, bool as one byte and
+  // the others by the bits of their 4 or 8 byte word.
+  template <typename T>
+  static T LoadValue(const char* data) {
+    if constexpr (std::is_same_v<T, bool>) {
+      return data[0] != 0;
+    } else {
+      static_assert(sizeof(T) == 4 || sizeof(T) == 8, "not a number word");
+      using Word = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+      Word word = Load<Word>(data);
+      T value;
+      memcpy(&value, &word, sizeof(T));
+      return value;
+    }
+  }
+
+  template <typename T>
+  static void StoreValue(char* data, T value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      data[0] = value ? 0x1 : 0x0;
+    } else {
+      static_assert(sizeof(T) == 4 || sizeof(T) == 8, "not a number word");
+      using Word = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+      Word word;
+      memcpy(&word, &value, sizeof(T));
+      Store(data, word);
+    }
+  }
+};
+
+using SwappedByteOrder = ByteOrder<true>;
+using HostByteOrder = ByteOrder<false>;
+
+// The bits of a float or double as a memory comparable word: a negative one
+// inverted whole, any other with its first bit flipped, first being the
+// FirstBitMask of the buffer. negative is !(data >= 0), as the keys have
+// always been written, so -0.0 is flipped and NaN inverted. It is spread into
+// a mask rather than branched on, so mixed sign data costs no mispredictions.
+template <typename W>
+inline W ToComparableFloatWord(W bits, bool negative, W first) {
+  static_assert(std::is_unsigned_v<W>, "not a float word");
+  W mask = W(0) - static_cast<W>(negative);
+  return bits ^ (mask | first);
+}
+
+template <typename W>
+inline W FromComparableFloatWord(W word, W first) {
+  static_assert(std::is_unsigned_v<W>, "not a float word");
+  W positive = W(0) - static_cast<W>((word & first) != 0);
+  return word ^ (~positive | first);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,111 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "byte_swap.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+// The vector paths are taken when the target allows them (e.g. -mavx2,
+// -mssse3, aarch64), the scalar loop handles the rest.
+
+void CopyWords32(char* dst, const char* src, size_t count, bool swap) {
+  if (!swap) {
+    memcpy(dst, src, count * 4);
+    return;
+  }
+
+  size_t i = 0;
+#if defined(__AVX2__)
+  const __m256i mask =
+      _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                       3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  for (; i + 8 <= count; i += 8) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                        _mm256_shuffle_epi8(v, mask));
+  }
+#elif defined(__SSSE3__)
+  const __m128i mask =
+      _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                     _mm_shuffle_epi8(v, mask));
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 4 <= count; i += 4) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i * 4));
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + i * 4), vrev32q_u8(v));
+  }
+#endif
+
+  for (; i < count; ++i) {
+    uint32_t v;
+    memcpy(&v, src + i * 4, 4);
+    v = __builtin_bswap32(v);
+    memcpy(dst + i * 4, &v, 4);
+  }
+}
+
+void CopyWords64(char* dst, const char* src, size_t count, bool swap) {
+  if (!swap) {
+    memcpy(dst, src, count * 8);
+    return;
+  }
+
+  size_t i = 0;
+#if defined(__AVX2__)
+  const __m256i mask =
+      _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                       7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  for (; i + 4 <= count; i += 4) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 8));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 8),
+                        _mm256_shuffle_epi8(v, mask));
+  }
+#elif defined(__SSSE3__)
+  const __m128i mask =
+      _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  for (; i + 2 <= count; i += 2) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 8),
+                     _mm_shuffle_epi8(v, mask));
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 2 <= count; i += 2) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i * 8));
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + i * 8), vrev64q_u8(v));
+  }
+#endif
+
+  for (; i < count; ++i) {
+    uint64_t v;
+    memcpy(&v, src + i * 8, 8);
+    v = __builtin_bswap64(v);
+    memcpy(dst + i * 8, &v, 8);
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
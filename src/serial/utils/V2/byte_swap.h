@@ -0,0 +1,31 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_BYTE_SWAP_V2_H_
+#define DINGO_SERIAL_BYTE_SWAP_V2_H_
+
+#include <cstddef>
+
+namespace dingodb {
+namespace serialV2 {
+
+// Copy count 32/64 bit words from src to dst, byte swapping every word when
+// swap is true. dst and src need not be aligned and must not overlap.
+void CopyWords32(char* dst, const char* src, size_t count, bool swap);
+void CopyWords64(char* dst, const char* src, size_t count, bool swap);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,149 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/utils/V2/codec_stats.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+namespace dingodb {
+namespace serialV2 {
+
+static std::atomic<uint64_t> next_codec_stats_id{1};
+
+// The ids of the stats alive. Never destroyed, stats of static storage may
+// outlive it otherwise.
+struct LiveCodecStats {
+  std::mutex mutex;
+  std::unordered_set<uint64_t> ids;
+};
+
+static LiveCodecStats& LiveStats() {
+  static auto* live = new LiveCodecStats();
+  return *live;
+}
+
+CodecStats::CodecStats()
+    : id_(next_codec_stats_id.fetch_add(1, std::memory_order_relaxed)) {
+  LiveCodecStats& live = LiveStats();
+  std::lock_guard<std::mutex> lock(live.mutex);
+  live.ids.insert(id_);
+}
+
+CodecStats::~CodecStats() {
+  LiveCodecStats& live = LiveStats();
+  std::lock_guard<std::mutex> lock(live.mutex);
+  live.ids.erase(id_);
+}
+
+std::unordered_map<uint64_t, CodecStats::Shard*>& CodecStats::ThreadShards() {
+  thread_local std::unordered_map<uint64_t, Shard*> shards;
+  return shards;
+}
+
+CodecStats::Shard& CodecStats::LocalShard() {
+  // the last stats the thread counted into, most adds hit it.
+  thread_local uint64_t last_id = 0;
+  thread_local Shard* last_shard = nullptr;
+  if (last_id == id_) {
+    return *last_shard;
+  }
+
+  auto& shards = ThreadShards();
+  auto it = shards.find(id_);
+  if (it == shards.end()) {
+    {
+      // the shards of destroyed stats dangle, drop them.
+      LiveCodecStats& live = LiveStats();
+      std::lock_guard<std::mutex> lock(live.mutex);
+      for (auto entry = shards.begin(); entry != shards.end();) {
+        entry = live.ids.count(entry->first) > 0 ? std::next(entry)
+                                                 : shards.erase(entry);
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_.push_back(std::make_unique<Shard>());
+    it = shards.emplace(id_, shards_.back().get()).first;
+  }
+  last_id = id_;
+  last_shard = it->second;
+  return *last_shard;
+}
+
+size_t CodecStats::ThreadShardCount() { return ThreadShards().size(); }
+
+void CodecStats::AddLatency(Shard& shard, bool decode, uint64_t sample_start) {
+  LatencyBuckets* latency = shard.latency.load(std::memory_order_acquire);
+  if (latency == nullptr) {
+    latency = new LatencyBuckets();
+    shard.latency.store(latency, std::memory_order_release);
+  }
+  uint64_t nanos = CycleClock::ToNanos(CycleClock::Now() - sample_start);
+  nanos = std::min(nanos, LatencyHistogram::kMaxValue);
+  int index = LatencyHistogram::BucketIndex(nanos);
+  Add(decode ? latency->decode[index] : latency->encode[index], 1);
+}
+
+CodecStatsSnapshot CodecStats::Snapshot() const {
+  CodecStatsSnapshot snapshot;
+  uint64_t totals[kCounterCount] = {};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& shard : shards_) {
+      for (int i = 0; i < kCounterCount; ++i) {
+        totals[i] += shard->counters[i].load(std::memory_order_relaxed);
+      }
+      LatencyBuckets* latency = shard->latency.load(std::memory_order_acquire);
+      if (latency == nullptr) {
+        continue;
+      }
+      for (int i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        snapshot.encode_latency.RecordBucket(
+            i, latency->encode[i].load(std::memory_order_relaxed));
+        snapshot.decode_latency.RecordBucket(
+            i, latency->decode[i].load(std::memory_order_relaxed));
+      }
+    }
+  }
+
+  snapshot.rows_encoded = totals[kRowsEncoded];
+  snapshot.bytes_encoded = totals[kBytesEncoded];
+  snapshot.rows_decoded = totals[kRowsDecoded];
+  snapshot.bytes_decoded = totals[kBytesDecoded];
+  snapshot.columns_decoded = totals[kColumnsDecoded];
+  snapshot.columns_skipped = totals[kColumnsSkipped];
+  snapshot.v1_fallbacks = totals[kV1Fallbacks];
+  snapshot.decode_failures = totals[kDecodeFailures];
+  return snapshot;
+}
+
+void CodecStats::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& shard : shards_) {
+    for (auto& counter : shard->counters) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    LatencyBuckets* latency = shard->latency.load(std::memory_order_acquire);
+    if (latency != nullptr) {
+      for (int i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        latency->encode[i].store(0, std::memory_order_relaxed);
+        latency->decode[i].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
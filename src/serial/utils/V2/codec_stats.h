@@ -0,0 +1,189 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_CODEC_STATS_V2_H_
+#define DINGO_SERIAL_CODEC_STATS_V2_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "serial/utils/V2/latency.h"
+
+// Codecs count into their CodecStats only when built with
+// DINGO_SERIAL_CODEC_STATS (cmake -DWITH_CODEC_STATS=ON), otherwise the
+// counting compiles away and a CodecStats handed to them stays at zero.
+#if defined(DINGO_SERIAL_CODEC_STATS)
+#define DINGO_CODEC_STATS(stats, call) \
+  do {                                 \
+    if ((stats) != nullptr) {          \
+      (stats)->call;                   \
+    }                                  \
+  } while (0)
+// Declares the start tick of a sampled row as uint64_t var, see SampleStart.
+#define DINGO_CODEC_STATS_SAMPLE(stats, var) \
+  uint64_t var = (stats) != nullptr ? (stats)->SampleStart() : 0
+#else
+#define DINGO_CODEC_STATS(stats, call) \
+  do {                                 \
+  } while (0)
+#define DINGO_CODEC_STATS_SAMPLE(stats, var) \
+  do {                                       \
+  } while (0)
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+struct CodecStatsSnapshot {
+  uint64_t rows_encoded{0};
+  uint64_t bytes_encoded{0};
+  uint64_t rows_decoded{0};
+  uint64_t bytes_decoded{0};
+  uint64_t columns_decoded{0};
+  uint64_t columns_skipped{0};
+  // rows of the V1 codec decoded by the RecordDecoder wrapper.
+  uint64_t v1_fallbacks{0};
+  // decodes returning -1.
+  uint64_t decode_failures{0};
+  // nanoseconds per row of the sampled rows.
+  LatencyHistogram encode_latency;
+  LatencyHistogram decode_latency;
+};
+
+/*
+ * Counters of the rows the codecs of one table encode and decode, hand it to
+ * their SetStats. Every thread counts into a shard of its own, a plain load
+ * and store per counter, Snapshot sums the shards. Reset only while no codec
+ * counts into it, a concurrent add may undo it.
+ *
+ * With SetLatencySampling(n) every n-th row of a thread is timed by
+ * CycleClock into the latency histograms.
+ */
+class CodecStats {
+ public:
+  CodecStats();
+  ~CodecStats();
+  CodecStats(const CodecStats&) = delete;
+  CodecStats& operator=(const CodecStats&) = delete;
+
+  // sample_start is the SampleStart of the row, 0 for none.
+  void AddEncode(uint64_t rows, uint64_t bytes, uint64_t sample_start = 0) {
+    Shard& shard = LocalShard();
+    Add(shard, kRowsEncoded, rows);
+    Add(shard, kBytesEncoded, bytes);
+    if (sample_start != 0) {
+      AddLatency(shard, false, sample_start);
+    }
+  }
+  void AddDecode(uint64_t bytes, uint64_t columns_decoded,
+                 uint64_t columns_skipped, uint64_t sample_start = 0) {
+    Shard& shard = LocalShard();
+    Add(shard, kRowsDecoded, 1);
+    Add(shard, kBytesDecoded, bytes);
+    Add(shard, kColumnsDecoded, columns_decoded);
+    Add(shard, kColumnsSkipped, columns_skipped);
+    if (sample_start != 0) {
+      AddLatency(shard, true, sample_start);
+    }
+  }
+  void AddV1Fallback() { Add(LocalShard(), kV1Fallbacks, 1); }
+  void AddDecodeFailure() { Add(LocalShard(), kDecodeFailures, 1); }
+
+  // Time every n-th row of each thread, 0 (the default) times none.
+  void SetLatencySampling(uint32_t every_n) {
+    sample_every_.store(every_n, std::memory_order_relaxed);
+  }
+
+  // The CycleClock tick a row to time starts at, 0 for a row not sampled.
+  uint64_t SampleStart() {
+    uint32_t every_n = sample_every_.load(std::memory_order_relaxed);
+    if (every_n == 0) {
+      return 0;
+    }
+    Shard& shard = LocalShard();
+    if (++shard.since_sample < every_n) {
+      return 0;
+    }
+    shard.since_sample = 0;
+    return CycleClock::Now() | 1;
+  }
+
+  CodecStatsSnapshot Snapshot() const;
+  void Reset();
+
+  // The shards the calling thread holds, of destroyed stats too until it adds
+  // the next one.
+  static size_t ThreadShardCount();
+
+ private:
+  enum Counter {
+    kRowsEncoded,
+    kBytesEncoded,
+    kRowsDecoded,
+    kBytesDecoded,
+    kColumnsDecoded,
+    kColumnsSkipped,
+    kV1Fallbacks,
+    kDecodeFailures,
+    kCounterCount
+  };
+
+  struct LatencyBuckets {
+    std::atomic<uint64_t> encode[LatencyHistogram::kBucketCount] = {};
+    std::atomic<uint64_t> decode[LatencyHistogram::kBucketCount] = {};
+  };
+
+  // Written by its thread only, on a cache line of its own. The latency
+  // buckets are allocated by the first sample.
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> counters[kCounterCount] = {};
+    uint32_t since_sample{0};
+    std::atomic<LatencyBuckets*> latency{nullptr};
+
+    ~Shard() { delete latency.load(std::memory_order_relaxed); }
+  };
+
+  static void Add(Shard& shard, Counter counter, uint64_t n) {
+    Add(shard.counters[counter], n);
+  }
+
+  static void Add(std::atomic<uint64_t>& value, uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+  }
+
+  void AddLatency(Shard& shard, bool decode, uint64_t sample_start);
+
+  // The shard of the calling thread, created by its first add.
+  Shard& LocalShard();
+  // the shards of the calling thread by stats id.
+  static std::unordered_map<uint64_t, Shard*>& ThreadShards();
+
+  // never reused, threads look their shard up by it and drop it once it is
+  // no longer live.
+  const uint64_t id_;
+  std::atomic<uint32_t> sample_every_{0};
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
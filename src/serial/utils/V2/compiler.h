@@ -35,6 +35,13 @@ namespace serialV2 {
 #define DINGO_UNLIKELY(expr) (expr)
 #endif
 
+// Hint a read of the cache line at addr soon.
+#if defined(COMPILER_GCC)
+#define DINGO_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define DINGO_PREFETCH(addr) ((void)(addr))
+#endif
+
 }  // namespace serialV2
 }  // namespace dingodb
 
@@ -0,0 +1,129 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "compression.h"
+
+#include <zlib.h>
+
+#include <climits>
+
+#if defined(DINGO_SERIAL_WITH_LZ4)
+#include <lz4.h>
+#endif
+#if defined(DINGO_SERIAL_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+// Values are small, favour speed over ratio.
+constexpr int kZlibLevel = 1;
+constexpr int kZstdLevel = 1;
+
+bool IsCompressionSupported(CompressionType type) {
+  switch (type) {
+    case CompressionType::kZlib:
+      return true;
+#if defined(DINGO_SERIAL_WITH_LZ4)
+    case CompressionType::kLz4:
+      return true;
+#endif
+#if defined(DINGO_SERIAL_WITH_ZSTD)
+    case CompressionType::kZstd:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+size_t MaxCompressedSize(CompressionType type, size_t size) {
+  switch (type) {
+    case CompressionType::kZlib:
+      return compressBound(size);
+#if defined(DINGO_SERIAL_WITH_LZ4)
+    case CompressionType::kLz4:
+      return size > LZ4_MAX_INPUT_SIZE ? 0 : LZ4_compressBound(size);
+#endif
+#if defined(DINGO_SERIAL_WITH_ZSTD)
+    case CompressionType::kZstd:
+      return ZSTD_compressBound(size);
+#endif
+    default:
+      return 0;
+  }
+}
+
+size_t Compress(CompressionType type, const char* src, size_t size, char* dst,
+                size_t capacity) {
+  switch (type) {
+    case CompressionType::kZlib: {
+      uLongf len = capacity;
+      int ret = compress2(reinterpret_cast<Bytef*>(dst), &len,
+                          reinterpret_cast<const Bytef*>(src), size,
+                          kZlibLevel);
+      return ret == Z_OK ? len : 0;
+    }
+#if defined(DINGO_SERIAL_WITH_LZ4)
+    case CompressionType::kLz4: {
+      if (size > LZ4_MAX_INPUT_SIZE || capacity > INT_MAX) {
+        return 0;
+      }
+      int len = LZ4_compress_default(src, dst, size, capacity);
+      return len > 0 ? len : 0;
+    }
+#endif
+#if defined(DINGO_SERIAL_WITH_ZSTD)
+    case CompressionType::kZstd: {
+      size_t len = ZSTD_compress(dst, capacity, src, size, kZstdLevel);
+      return ZSTD_isError(len) ? 0 : len;
+    }
+#endif
+    default:
+      return 0;
+  }
+}
+
+bool Decompress(CompressionType type, const char* src, size_t size, char* dst,
+                size_t raw_size) {
+  switch (type) {
+    case CompressionType::kZlib: {
+      uLongf len = raw_size;
+      int ret = uncompress(reinterpret_cast<Bytef*>(dst), &len,
+                           reinterpret_cast<const Bytef*>(src), size);
+      return ret == Z_OK && len == raw_size;
+    }
+#if defined(DINGO_SERIAL_WITH_LZ4)
+    case CompressionType::kLz4: {
+      if (size > INT_MAX || raw_size > INT_MAX) {
+        return false;
+      }
+      int len = LZ4_decompress_safe(src, dst, size, raw_size);
+      return len >= 0 && static_cast<size_t>(len) == raw_size;
+    }
+#endif
+#if defined(DINGO_SERIAL_WITH_ZSTD)
+    case CompressionType::kZstd: {
+      size_t len = ZSTD_decompress(dst, raw_size, src, size);
+      return !ZSTD_isError(len) && len == raw_size;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,51 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_COMPRESSION_V2_H_
+#define DINGO_SERIAL_COMPRESSION_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dingodb {
+namespace serialV2 {
+
+// zlib is always there, lz4 and zstd when built WITH_LZ4 / WITH_ZSTD.
+enum class CompressionType : uint8_t {
+  kNone = 0,
+  kLz4 = 1,
+  kZstd = 2,
+  kZlib = 3,
+};
+
+bool IsCompressionSupported(CompressionType type);
+
+// Bound of the compressed size of size bytes.
+size_t MaxCompressedSize(CompressionType type, size_t size);
+
+// Compress src[0, size) into dst, which holds at least
+// MaxCompressedSize(type, size) bytes. Returns the compressed length, 0 on
+// failure.
+size_t Compress(CompressionType type, const char* src, size_t size, char* dst,
+                size_t capacity);
+
+// Decompress src[0, size) into exactly raw_size bytes of dst, false when the
+// data is corrupt or has another length.
+bool Decompress(CompressionType type, const char* src, size_t size, char* dst,
+                size_t raw_size);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,199 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "crc32c.h"
+
+#include <cstring>
+
+// x86-64 builds carry the SSE4.2 path whatever the target flags, it is taken
+// when the host has it; aarch64 builds when the target has the CRC extension
+// (e.g. -march=armv8-a+crc).
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define DINGO_CRC32C_X86 1
+#define DINGO_CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define DINGO_CRC32C_ARM 1
+#define DINGO_CRC32C_TARGET
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// the reflected Castagnoli polynomial.
+constexpr uint32_t kPoly = 0x82F63B78;
+
+// Bytes of each of the three streams of the hardware path.
+constexpr size_t kStride = 512;
+
+struct Tables {
+  // [k][b]: the CRC of byte b followed by k zero bytes, for slicing by 8.
+  uint32_t bytes[8][256];
+  // [k][b]: byte k of a CRC being b, moved past kStride zero bytes.
+  uint32_t shift[4][256];
+};
+
+// a * b modulo the polynomial, both reflected: bit 31 is x^0.
+constexpr uint32_t MultModP(uint32_t a, uint32_t b) {
+  uint32_t p = 0;
+  for (uint32_t m = 1u << 31; m != 0; m >>= 1) {
+    if (a & m) {
+      p ^= b;
+    }
+    b = (b & 1) ? (b >> 1) ^ kPoly : b >> 1;
+  }
+  return p;
+}
+
+constexpr Tables MakeTables() {
+  Tables tables{};
+  for (uint32_t b = 0; b < 256; ++b) {
+    uint32_t crc = b;
+    for (int i = 0; i < 8; ++i) {
+      crc = (crc & 1) ? (crc >> 1) ^ kPoly : crc >> 1;
+    }
+    tables.bytes[0][b] = crc;
+  }
+  for (int k = 1; k < 8; ++k) {
+    for (int b = 0; b < 256; ++b) {
+      uint32_t prev = tables.bytes[k - 1][b];
+      tables.bytes[k][b] = (prev >> 8) ^ tables.bytes[0][prev & 0xFF];
+    }
+  }
+
+  // x^(8 * kStride), squaring x up from x^1.
+  uint32_t power = 1u << 30;
+  for (size_t bits = 1; bits < 8 * kStride; bits <<= 1) {
+    power = MultModP(power, power);
+  }
+  for (int k = 0; k < 4; ++k) {
+    for (uint32_t b = 0; b < 256; ++b) {
+      tables.shift[k][b] = MultModP(b << (8 * k), power);
+    }
+  }
+  return tables;
+}
+
+constexpr Tables kTables = MakeTables();
+
+inline uint32_t Load32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+// the raw register, without the inversions around it.
+uint32_t SoftwareUpdate(uint32_t crc, const uint8_t* p, size_t size) {
+  const auto& t = kTables.bytes;
+  for (; size >= 8; p += 8, size -= 8) {
+    uint32_t lo = crc ^ Load32(p);
+    uint32_t hi = Load32(p + 4);
+    crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^
+          t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+          t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+  }
+  for (; size > 0; ++p, --size) {
+    crc = t[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if defined(DINGO_CRC32C_X86) || defined(DINGO_CRC32C_ARM)
+
+// crc moved past kStride zero bytes.
+inline uint32_t Shift(uint32_t crc) {
+  const auto& t = kTables.shift;
+  return t[0][crc & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^ t[2][(crc >> 16) & 0xFF] ^
+         t[3][crc >> 24];
+}
+
+DINGO_CRC32C_TARGET inline uint32_t Update8(uint32_t crc, const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+#if defined(DINGO_CRC32C_X86)
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+#else
+  return __crc32cd(crc, v);
+#endif
+}
+
+DINGO_CRC32C_TARGET inline uint32_t Update1(uint32_t crc, uint8_t v) {
+#if defined(DINGO_CRC32C_X86)
+  return _mm_crc32_u8(crc, v);
+#else
+  return __crc32cb(crc, v);
+#endif
+}
+
+// Blocks of three strides run as three independent streams, hiding the
+// latency of the instruction, the CRCs of the later two folded into the
+// first: crc(a | b) = shift(crc(a), |b|) ^ crc(b) for a zero start.
+DINGO_CRC32C_TARGET uint32_t HardwareUpdate(uint32_t crc, const uint8_t* p,
+                                            size_t size) {
+  for (; size >= 3 * kStride; p += 3 * kStride, size -= 3 * kStride) {
+    uint32_t crc1 = 0;
+    uint32_t crc2 = 0;
+    for (size_t i = 0; i < kStride; i += 8) {
+      crc = Update8(crc, p + i);
+      crc1 = Update8(crc1, p + kStride + i);
+      crc2 = Update8(crc2, p + 2 * kStride + i);
+    }
+    crc = Shift(Shift(crc) ^ crc1) ^ crc2;
+  }
+  for (; size >= 8; p += 8, size -= 8) {
+    crc = Update8(crc, p);
+  }
+  for (; size > 0; ++p, --size) {
+    crc = Update1(crc, *p);
+  }
+  return crc;
+}
+
+#endif
+
+bool DetectHardware() {
+#if defined(DINGO_CRC32C_X86)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+#elif defined(DINGO_CRC32C_ARM)
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+bool Crc32cIsHardware() {
+  static const bool hardware = DetectHardware();
+  return hardware;
+}
+
+uint32_t Crc32cSoftware(const char* data, size_t size, uint32_t crc) {
+  return ~SoftwareUpdate(~crc, reinterpret_cast<const uint8_t*>(data), size);
+}
+
+uint32_t Crc32c(const char* data, size_t size, uint32_t crc) {
+#if defined(DINGO_CRC32C_X86) || defined(DINGO_CRC32C_ARM)
+  if (Crc32cIsHardware()) {
+    return ~HardwareUpdate(~crc, reinterpret_cast<const uint8_t*>(data), size);
+  }
+#endif
+  return Crc32cSoftware(data, size, crc);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,40 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_CRC32C_V2_H_
+#define DINGO_SERIAL_CRC32C_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dingodb {
+namespace serialV2 {
+
+// CRC-32C, the Castagnoli polynomial of iSCSI and ext4, of data[0, size).
+// crc is the CRC of the bytes before, so that ranges chain: Crc32c(b, nb,
+// Crc32c(a, na)) is the CRC of a followed by b. Runs on the CRC instructions
+// of SSE4.2 or the ARMv8 CRC extension when the host has them, large inputs
+// as three interleaved streams folded together.
+uint32_t Crc32c(const char* data, size_t size, uint32_t crc = 0);
+
+// The table driven form Crc32c falls back to, the same CRC.
+uint32_t Crc32cSoftware(const char* data, size_t size, uint32_t crc = 0);
+
+// Whether Crc32c runs on the CRC instructions of the host.
+bool Crc32cIsHardware();
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "distinct_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dingodb {
+namespace serialV2 {
+
+void DistinctSketch::Add(uint64_t hash) {
+  if (registers_.empty()) {
+    registers_.resize(kRegisterCount);
+  }
+
+  // the top bits pick the register, it keeps the longest run of leading
+  // zeros seen in the rest plus one.
+  uint64_t rest = hash << kPrecision;
+  uint8_t rank = rest == 0 ? 64 - kPrecision + 1 : __builtin_clzll(rest) + 1;
+  uint8_t& reg = registers_[hash >> (64 - kPrecision)];
+  reg = std::max(reg, rank);
+}
+
+void DistinctSketch::Merge(const DistinctSketch& other) {
+  if (other.registers_.empty()) {
+    return;
+  }
+  if (registers_.empty()) {
+    registers_ = other.registers_;
+    return;
+  }
+  for (int i = 0; i < kRegisterCount; ++i) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+uint64_t DistinctSketch::Estimate() const {
+  if (registers_.empty()) {
+    return 0;
+  }
+
+  double sum = 0;
+  int zeros = 0;
+  for (uint8_t reg : registers_) {
+    sum += std::ldexp(1.0, -reg);
+    zeros += reg == 0;
+  }
+  constexpr double m = kRegisterCount;
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+
+  // small cardinalities are counted better by the empty registers.
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / zeros);
+  }
+  return static_cast<uint64_t>(std::llround(estimate));
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,49 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DINGO_SERIAL_DISTINCT_SKETCH_V2_H_
+#define DINGO_SERIAL_DISTINCT_SKETCH_V2_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+// A HyperLogLog of 64 bits hashes, e.g. of Hash64, estimating how many
+// distinct ones were added within about 3% with 2^kPrecision one byte
+// registers. The registers are allocated by the first Add and kept by Clear,
+// sketches merge into the sketch of the union.
+class DistinctSketch {
+ public:
+  static constexpr int kPrecision = 10;
+  static constexpr int kRegisterCount = 1 << kPrecision;
+
+  void Add(uint64_t hash);
+  void Merge(const DistinctSketch& other);
+
+  uint64_t Estimate() const;
+
+  void Clear() { std::fill(registers_.begin(), registers_.end(), 0); }
+
+ private:
+  std::vector<uint8_t> registers_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
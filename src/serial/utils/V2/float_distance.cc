@@ -0,0 +1,311 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "float_distance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__AVX512F__) || defined(__SSSE3__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+// As in byte_swap.cc the vector path is picked by the target flags, every
+// kernel is written once against the Lanes type of that path and the scalar
+// loop handles the tail.
+
+namespace {
+
+template <bool kSwap>
+inline float LoadFloat(const char* p) {
+  uint32_t word;
+  memcpy(&word, p, 4);
+  if (kSwap) {
+    word = __builtin_bswap32(word);
+  }
+  float value;
+  memcpy(&value, &word, 4);
+  return value;
+}
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+
+struct Lanes {
+  using V = __m512;
+  static constexpr size_t kWidth = 16;
+
+  static V Zero() { return _mm512_setzero_ps(); }
+  template <bool kSwap>
+  static V Load(const char* p) {
+    __m512i v = _mm512_loadu_si512(p);
+    if (kSwap) {
+      const __m512i mask = _mm512_broadcast_i32x4(
+          _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+      v = _mm512_shuffle_epi8(v, mask);
+    }
+    return _mm512_castsi512_ps(v);
+  }
+  static V LoadQuery(const float* q) { return _mm512_loadu_ps(q); }
+  static V Sub(V a, V b) { return _mm512_sub_ps(a, b); }
+  static V Fma(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+  static float Sum(V v) { return _mm512_reduce_add_ps(v); }
+};
+
+#elif defined(__AVX2__)
+
+struct Lanes {
+  using V = __m256;
+  static constexpr size_t kWidth = 8;
+
+  static V Zero() { return _mm256_setzero_ps(); }
+  template <bool kSwap>
+  static V Load(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    if (kSwap) {
+      const __m256i mask = _mm256_setr_epi8(
+          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7,
+          6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+      v = _mm256_shuffle_epi8(v, mask);
+    }
+    return _mm256_castsi256_ps(v);
+  }
+  static V LoadQuery(const float* q) { return _mm256_loadu_ps(q); }
+  static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+  static V Fma(V a, V b, V c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+  }
+  static float Sum(V v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v),
+                          _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+    return _mm_cvtss_f32(s);
+  }
+};
+
+#elif defined(__SSSE3__)
+
+struct Lanes {
+  using V = __m128;
+  static constexpr size_t kWidth = 4;
+
+  static V Zero() { return _mm_setzero_ps(); }
+  template <bool kSwap>
+  static V Load(const char* p) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    if (kSwap) {
+      const __m128i mask =
+          _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+      v = _mm_shuffle_epi8(v, mask);
+    }
+    return _mm_castsi128_ps(v);
+  }
+  static V LoadQuery(const float* q) { return _mm_loadu_ps(q); }
+  static V Sub(V a, V b) { return _mm_sub_ps(a, b); }
+  static V Fma(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+  static float Sum(V v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 0x55));
+    return _mm_cvtss_f32(v);
+  }
+};
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+struct Lanes {
+  using V = float32x4_t;
+  static constexpr size_t kWidth = 4;
+
+  static V Zero() { return vdupq_n_f32(0); }
+  template <bool kSwap>
+  static V Load(const char* p) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    if (kSwap) {
+      v = vrev32q_u8(v);
+    }
+    return vreinterpretq_f32_u8(v);
+  }
+  static V LoadQuery(const float* q) { return vld1q_f32(q); }
+  static V Sub(V a, V b) { return vsubq_f32(a, b); }
+  static V Fma(V a, V b, V c) { return vfmaq_f32(c, a, b); }
+  static float Sum(V v) { return vaddvq_f32(v); }
+};
+
+#else
+#define DINGO_SERIAL_SCALAR_DISTANCE
+#endif
+
+template <bool kSwap>
+float L2SqrImpl(const char* data, const float* query, size_t dim) {
+  size_t i = 0;
+  float sum = 0;
+#if !defined(DINGO_SERIAL_SCALAR_DISTANCE)
+  auto acc = Lanes::Zero();
+  for (; i + Lanes::kWidth <= dim; i += Lanes::kWidth) {
+    auto diff = Lanes::Sub(Lanes::Load<kSwap>(data + i * 4),
+                           Lanes::LoadQuery(query + i));
+    acc = Lanes::Fma(diff, diff, acc);
+  }
+  sum = Lanes::Sum(acc);
+#endif
+  for (; i < dim; ++i) {
+    float diff = LoadFloat<kSwap>(data + i * 4) - query[i];
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+template <bool kSwap>
+float InnerProductImpl(const char* data, const float* query, size_t dim) {
+  size_t i = 0;
+  float sum = 0;
+#if !defined(DINGO_SERIAL_SCALAR_DISTANCE)
+  auto acc = Lanes::Zero();
+  for (; i + Lanes::kWidth <= dim; i += Lanes::kWidth) {
+    acc = Lanes::Fma(Lanes::Load<kSwap>(data + i * 4),
+                     Lanes::LoadQuery(query + i), acc);
+  }
+  sum = Lanes::Sum(acc);
+#endif
+  for (; i < dim; ++i) {
+    sum += LoadFloat<kSwap>(data + i * 4) * query[i];
+  }
+  return sum;
+}
+
+// Dot product and both norms in one pass over the encoded data.
+template <bool kSwap>
+void CosineSums(const char* data, const float* query, size_t dim, float& dot,
+                float& xx, float& qq) {
+  size_t i = 0;
+#if !defined(DINGO_SERIAL_SCALAR_DISTANCE)
+  auto acc_dot = Lanes::Zero();
+  auto acc_xx = Lanes::Zero();
+  auto acc_qq = Lanes::Zero();
+  for (; i + Lanes::kWidth <= dim; i += Lanes::kWidth) {
+    auto x = Lanes::Load<kSwap>(data + i * 4);
+    auto q = Lanes::LoadQuery(query + i);
+    acc_dot = Lanes::Fma(x, q, acc_dot);
+    acc_xx = Lanes::Fma(x, x, acc_xx);
+    acc_qq = Lanes::Fma(q, q, acc_qq);
+  }
+  dot += Lanes::Sum(acc_dot);
+  xx += Lanes::Sum(acc_xx);
+  qq += Lanes::Sum(acc_qq);
+#endif
+  for (; i < dim; ++i) {
+    float x = LoadFloat<kSwap>(data + i * 4);
+    dot += x * query[i];
+    xx += x * x;
+    qq += query[i] * query[i];
+  }
+}
+
+float CosineFromSums(float dot, float xx, float qq) {
+  if (xx == 0 || qq == 0) {
+    return 1.0f;
+  }
+  return 1.0f - dot / std::sqrt(xx * qq);
+}
+
+template <bool kSwap>
+float CosineDistanceImpl(const char* data, const float* query, size_t dim) {
+  float dot = 0;
+  float xx = 0;
+  float qq = 0;
+  CosineSums<kSwap>(data, query, dim, dot, xx, qq);
+  return CosineFromSums(dot, xx, qq);
+}
+
+// Quantized elements are widened a block at a time into a stack buffer that
+// stays in L1, then go through the native float kernels.
+constexpr size_t kDequantizeBlock = 256;
+
+}  // namespace
+
+float L2Sqr(const char* data, const float* query, size_t dim, bool swap) {
+  return swap ? L2SqrImpl<true>(data, query, dim)
+              : L2SqrImpl<false>(data, query, dim);
+}
+
+float InnerProduct(const char* data, const float* query, size_t dim,
+                   bool swap) {
+  return swap ? InnerProductImpl<true>(data, query, dim)
+              : InnerProductImpl<false>(data, query, dim);
+}
+
+float CosineDistance(const char* data, const float* query, size_t dim,
+                     bool swap) {
+  return swap ? CosineDistanceImpl<true>(data, query, dim)
+              : CosineDistanceImpl<false>(data, query, dim);
+}
+
+float Distance(DistanceMetric metric, const char* data, const float* query,
+               size_t dim, bool swap) {
+  switch (metric) {
+    case DistanceMetric::kL2:
+      return L2Sqr(data, query, dim, swap);
+    case DistanceMetric::kInnerProduct:
+      return InnerProduct(data, query, dim, swap);
+    case DistanceMetric::kCosine:
+      return CosineDistance(data, query, dim, swap);
+  }
+  return 0;
+}
+
+float Distance(DistanceMetric metric, FloatQuantization quantization,
+               const char* data, float scale, const float* query, size_t dim,
+               bool swap) {
+  if (quantization == FloatQuantization::kNone) {
+    return Distance(metric, data, query, dim, swap);
+  }
+
+  size_t width = QuantizedWidth(quantization);
+  float block[kDequantizeBlock];
+  float sum = 0;
+  float dot = 0;
+  float xx = 0;
+  float qq = 0;
+  for (size_t i = 0; i < dim; i += kDequantizeBlock) {
+    size_t count = std::min(kDequantizeBlock, dim - i);
+    Dequantize(quantization, data + i * width, count, scale, block, swap);
+    const char* block_data = reinterpret_cast<const char*>(block);
+    switch (metric) {
+      case DistanceMetric::kL2:
+        sum += L2SqrImpl<false>(block_data, query + i, count);
+        break;
+      case DistanceMetric::kInnerProduct:
+        sum += InnerProductImpl<false>(block_data, query + i, count);
+        break;
+      case DistanceMetric::kCosine:
+        CosineSums<false>(block_data, query + i, count, dot, xx, qq);
+        break;
+    }
+  }
+  return metric == DistanceMetric::kCosine ? CosineFromSums(dot, xx, qq) : sum;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
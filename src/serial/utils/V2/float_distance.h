@@ -0,0 +1,52 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_FLOAT_DISTANCE_V2_H_
+#define DINGO_SERIAL_FLOAT_DISTANCE_V2_H_
+
+#include <cstddef>
+
+#include "serial/utils/V2/float_quant.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+enum class DistanceMetric {
+  kL2,            // squared euclidean distance
+  kInnerProduct,  // dot product
+  kCosine,        // 1 - cosine similarity
+};
+
+// The kernels read dim encoded floats from data, swapping each word first
+// when swap is set (the same flag CopyWords32 takes), and compare them with a
+// native query vector. The swap is fused into the loads so the encoded list
+// never has to be copied out.
+float L2Sqr(const char* data, const float* query, size_t dim, bool swap);
+float InnerProduct(const char* data, const float* query, size_t dim,
+                   bool swap);
+// A zero vector has no direction, its cosine distance is 1.
+float CosineDistance(const char* data, const float* query, size_t dim,
+                     bool swap);
+
+float Distance(DistanceMetric metric, const char* data, const float* query,
+               size_t dim, bool swap);
+// The same on elements stored as Quantize wrote them.
+float Distance(DistanceMetric metric, FloatQuantization quantization,
+               const char* data, float scale, const float* query, size_t dim,
+               bool swap);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,232 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "float_quant.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "serial/utils/V2/byte_swap.h"
+
+#if defined(__AVX2__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+inline uint32_t FloatBits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, 4);
+  return bits;
+}
+
+inline float BitsFloat(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, 4);
+  return value;
+}
+
+inline uint16_t LoadWord16(const char* p, bool swap) {
+  uint16_t word;
+  memcpy(&word, p, 2);
+  return swap ? __builtin_bswap16(word) : word;
+}
+
+inline void StoreWord16(char* p, uint16_t word, bool swap) {
+  if (swap) {
+    word = __builtin_bswap16(word);
+  }
+  memcpy(p, &word, 2);
+}
+
+// The vector paths (F16C for fp16, AVX2 for bf16) convert to native words
+// through a small buffer, the 16 bits swap stays scalar.
+constexpr size_t kBlock = 8;
+
+void EncodeHalfs(const float* src, size_t count, char* dst, bool swap) {
+  size_t i = 0;
+#if defined(__F16C__)
+  uint16_t words[kBlock];
+  for (; i + kBlock <= count; i += kBlock) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(words), h);
+    for (size_t j = 0; j < kBlock; ++j) {
+      StoreWord16(dst + (i + j) * 2, words[j], swap);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    StoreWord16(dst + i * 2, FloatToHalf(src[i]), swap);
+  }
+}
+
+void DecodeHalfs(const char* src, size_t count, float* dst, bool swap) {
+  size_t i = 0;
+#if defined(__F16C__)
+  uint16_t words[kBlock];
+  for (; i + kBlock <= count; i += kBlock) {
+    for (size_t j = 0; j < kBlock; ++j) {
+      words[j] = LoadWord16(src + (i + j) * 2, swap);
+    }
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] = HalfToFloat(LoadWord16(src + i * 2, swap));
+  }
+}
+
+void DecodeBf16s(const char* src, size_t count, float* dst, bool swap) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  uint16_t words[kBlock];
+  for (; i + kBlock <= count; i += kBlock) {
+    for (size_t j = 0; j < kBlock; ++j) {
+      words[j] = LoadWord16(src + (i + j) * 2, swap);
+    }
+    __m256i w = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(words)));
+    _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(w, 16)));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] = Bf16ToFloat(LoadWord16(src + i * 2, swap));
+  }
+}
+
+float EncodeInt8s(const float* src, size_t count, char* dst) {
+  float max_abs = 0;
+  for (size_t i = 0; i < count; ++i) {
+    max_abs = std::max(max_abs, std::fabs(src[i]));
+  }
+  float scale = max_abs / 127.0f;
+  float inverse = scale == 0 ? 0 : 1.0f / scale;
+  for (size_t i = 0; i < count; ++i) {
+    float q = std::nearbyint(src[i] * inverse);
+    dst[i] = static_cast<int8_t>(std::clamp(q, -127.0f, 127.0f));
+  }
+  return scale;
+}
+
+}  // namespace
+
+size_t QuantizedWidth(FloatQuantization quantization) {
+  switch (quantization) {
+    case FloatQuantization::kFp16:
+    case FloatQuantization::kBf16:
+      return 2;
+    case FloatQuantization::kInt8:
+      return 1;
+    default:
+      return 4;
+  }
+}
+
+uint16_t FloatToHalf(float value) {
+  uint32_t bits = FloatBits(value);
+  uint16_t sign = (bits >> 16) & 0x8000;
+  uint32_t abs = bits & 0x7FFFFFFF;
+
+  if (abs >= 0x7F800000) {  // inf or NaN
+    return sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0);
+  }
+  if (abs >= 0x477FF000) {  // rounds beyond 65504
+    return sign | 0x7C00;
+  }
+  if (abs < 0x38800000) {  // subnormal half, or zero
+    // Align the 24 bits mantissa on the 2^-24 half unit and round half even.
+    float v = BitsFloat(abs) * BitsFloat(0x4B800000);  // * 2^24
+    return sign | static_cast<uint16_t>(std::nearbyint(v));
+  }
+
+  uint32_t mantissa_odd = (abs >> 13) & 1;
+  abs += 0xC8000FFF + mantissa_odd;  // rebias exponent by -112, round
+  return sign | static_cast<uint16_t>(abs >> 13);
+}
+
+float HalfToFloat(uint16_t value) {
+  uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+  uint32_t exponent = (value >> 10) & 0x1F;
+  uint32_t mantissa = value & 0x3FF;
+
+  if (exponent == 0) {
+    float v = static_cast<float>(mantissa) * BitsFloat(0x33800000);  // 2^-24
+    return BitsFloat(sign | FloatBits(v));
+  }
+  if (exponent == 0x1F) {
+    return BitsFloat(sign | 0x7F800000 | (mantissa << 13));
+  }
+  return BitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint16_t FloatToBf16(float value) {
+  uint32_t bits = FloatBits(value);
+  if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40);  // keep NaN quiet
+  }
+  bits += 0x7FFF + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+float Bf16ToFloat(uint16_t value) {
+  return BitsFloat(static_cast<uint32_t>(value) << 16);
+}
+
+float Quantize(FloatQuantization quantization, const float* src, size_t count,
+               char* dst, bool swap) {
+  switch (quantization) {
+    case FloatQuantization::kFp16:
+      EncodeHalfs(src, count, dst, swap);
+      break;
+    case FloatQuantization::kBf16:
+      for (size_t i = 0; i < count; ++i) {
+        StoreWord16(dst + i * 2, FloatToBf16(src[i]), swap);
+      }
+      break;
+    case FloatQuantization::kInt8:
+      return EncodeInt8s(src, count, dst);
+    default:
+      CopyWords32(dst, reinterpret_cast<const char*>(src), count, swap);
+      break;
+  }
+  return 1.0f;
+}
+
+void Dequantize(FloatQuantization quantization, const char* src, size_t count,
+                float scale, float* dst, bool swap) {
+  switch (quantization) {
+    case FloatQuantization::kFp16:
+      DecodeHalfs(src, count, dst, swap);
+      break;
+    case FloatQuantization::kBf16:
+      DecodeBf16s(src, count, dst, swap);
+      break;
+    case FloatQuantization::kInt8:
+      for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<int8_t>(src[i]) * scale;
+      }
+      break;
+    default:
+      CopyWords32(reinterpret_cast<char*>(dst), src, count, swap);
+      break;
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,53 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_FLOAT_QUANT_V2_H_
+#define DINGO_SERIAL_FLOAT_QUANT_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dingodb {
+namespace serialV2 {
+
+// Lossy element encodings of a float list.
+enum class FloatQuantization : uint8_t {
+  kNone = 0,  // 4 bytes floats.
+  kFp16 = 1,  // IEEE half precision.
+  kBf16 = 2,  // the high half of a float.
+  kInt8 = 3,  // round(x / scale), scale = max|x| / 127 per list.
+};
+
+// Bytes per element.
+size_t QuantizedWidth(FloatQuantization quantization);
+
+// Round to nearest even, overflow gives infinity and NaN stays NaN.
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+uint16_t FloatToBf16(float value);
+float Bf16ToFloat(uint16_t value);
+
+// Write count elements of src into QuantizedWidth(quantization) * count bytes
+// of dst, 16 bits words are swapped when swap is set as CopyWords32 does.
+// Returns the scale of kInt8, 1 otherwise.
+float Quantize(FloatQuantization quantization, const float* src, size_t count,
+               char* dst, bool swap);
+// The reverse of Quantize.
+void Dequantize(FloatQuantization quantization, const char* src, size_t count,
+                float scale, float* dst, bool swap);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hash.h"
+
+#include <cstring>
+
+#include "serial/utils/V2/compiler.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+static constexpr uint64_t kSecret[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+    0x4d5a2da51de1aa47ULL};
+
+static inline void Multiply(uint64_t& lo, uint64_t& hi) {
+  __uint128_t product = static_cast<__uint128_t>(lo) * hi;
+  lo = static_cast<uint64_t>(product);
+  hi = static_cast<uint64_t>(product >> 64);
+}
+
+static inline uint64_t Mix(uint64_t a, uint64_t b) {
+  Multiply(a, b);
+  return a ^ b;
+}
+
+static inline uint64_t Read64(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+static inline uint64_t Read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap32(v);
+#endif
+  return v;
+}
+
+// 1 to 3 bytes, the first, middle and last.
+static inline uint64_t Read3(const uint8_t* p, size_t k) {
+  return (static_cast<uint64_t>(p[0]) << 16) |
+         (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+uint64_t Hash64(const char* data, size_t size, uint64_t seed) {
+  const auto* p = reinterpret_cast<const uint8_t*>(data);
+  seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+  uint64_t a;
+  uint64_t b;
+  if (DINGO_LIKELY(size <= 16)) {
+    if (DINGO_LIKELY(size >= 4)) {
+      size_t step = (size >> 3) << 2;
+      a = (Read32(p) << 32) | Read32(p + step);
+      b = (Read32(p + size - 4) << 32) | Read32(p + size - 4 - step);
+    } else if (size > 0) {
+      a = Read3(p, size);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = size;
+    if (DINGO_UNLIKELY(i > 48)) {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = Mix(Read64(p) ^ kSecret[1], Read64(p + 8) ^ seed);
+        see1 = Mix(Read64(p + 16) ^ kSecret[2], Read64(p + 24) ^ see1);
+        see2 = Mix(Read64(p + 32) ^ kSecret[3], Read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (DINGO_LIKELY(i > 48));
+      seed ^= see1 ^ see2;
+    }
+    while (DINGO_UNLIKELY(i > 16)) {
+      seed = Mix(Read64(p) ^ kSecret[1], Read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = Read64(p + i - 16);
+    b = Read64(p + i - 8);
+  }
+
+  a ^= kSecret[1];
+  b ^= seed;
+  Multiply(a, b);
+  return Mix(a ^ kSecret[0] ^ size, b ^ kSecret[1]);
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,32 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_HASH_V2_H_
+#define DINGO_SERIAL_HASH_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dingodb {
+namespace serialV2 {
+
+// A wyhash style 64 bits hash of data[0, size). Words are read little endian
+// on every host, so a hash may be stored or sent to other nodes. Hashing more
+// ranges into one value chains them, passing one hash as the seed of the next.
+uint64_t Hash64(const char* data, size_t size, uint64_t seed = 0);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -0,0 +1,99 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/utils/V2/latency.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dingodb {
+namespace serialV2 {
+
+static uint64_t MonotonicRawNanos() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static double CalibrateNanosPerTick() {
+#if defined(__x86_64__) || defined(__i386__)
+  constexpr uint64_t kCalibrationNanos = 5000000;
+  uint64_t start_nanos = MonotonicRawNanos();
+  uint64_t start_ticks = CycleClock::Now();
+  uint64_t nanos;
+  do {
+    nanos = MonotonicRawNanos() - start_nanos;
+  } while (nanos < kCalibrationNanos);
+  uint64_t ticks = CycleClock::Now() - start_ticks;
+  return ticks == 0 ? 1.0 : static_cast<double>(nanos) / ticks;
+#else
+  return 1.0;
+#endif
+}
+
+double CycleClock::NanosPerTick() {
+  static const double nanos_per_tick = CalibrateNanosPerTick();
+  return nanos_per_tick;
+}
+
+void LatencyHistogram::RecordBucket(int index, uint64_t count) {
+  if (count == 0) {
+    return;
+  }
+  uint64_t low = BucketLow(index);
+  uint64_t high = low + BucketWidth(index) - 1;
+  buckets_[index] += count;
+  count_ += count;
+  sum_ += (low + (high - low) / 2) * count;
+  min_ = std::min(min_, low);
+  max_ = std::max(max_, high);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kBucketCount; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::Clear() {
+  std::fill(buckets_.begin(), buckets_.end(), 0);
+  count_ = 0;
+  sum_ = 0;
+  min_ = UINT64_MAX;
+  max_ = 0;
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  q = std::min(std::max(q, 0.0), 1.0);
+  uint64_t rank = std::max<uint64_t>(1, std::ceil(q * count_));
+  uint64_t seen = 0;
+  for (int i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      uint64_t middle = BucketLow(i) + (BucketWidth(i) - 1) / 2;
+      return std::min(std::max(middle, Min()), max_);
+    }
+  }
+  return max_;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,148 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_LATENCY_V2_H_
+#define DINGO_SERIAL_LATENCY_V2_H_
+
+#include <time.h>
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace dingodb {
+namespace serialV2 {
+
+// A tick counter for timing rows: the TSC on x86, taken as invariant, else
+// CLOCK_MONOTONIC_RAW in nanoseconds. Neither follows wall clock steps.
+class CycleClock {
+ public:
+  static uint64_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+  }
+
+  // Measured against CLOCK_MONOTONIC_RAW over a few milliseconds by the
+  // first call.
+  static double NanosPerTick();
+
+  static uint64_t ToNanos(uint64_t ticks) {
+    return static_cast<uint64_t>(ticks * NanosPerTick());
+  }
+};
+
+/*
+ * Log bucketed counts of latencies, or any other values, in the manner of an
+ * HDR histogram: a value falls into one of 2^kSubBucketBits buckets between
+ * its power of two and the next, so a percentile is off by at most 1/64 of
+ * the value. Values from 2^40 on, about 18 minutes of nanoseconds, count as
+ * 2^40 - 1. Not thread safe, merge the histograms of the threads.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+  static constexpr int kMaxValueBits = 40;
+  static constexpr uint64_t kMaxValue = (uint64_t(1) << kMaxValueBits) - 1;
+  static constexpr int kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+  LatencyHistogram() : buckets_(kBucketCount, 0) {}
+
+  void Record(uint64_t value) {
+    value = value > kMaxValue ? kMaxValue : value;
+    buckets_[BucketIndex(value)]++;
+    count_++;
+    sum_ += value;
+    min_ = value < min_ ? value : min_;
+    max_ = value > max_ ? value : max_;
+  }
+
+  // Add count values of bucket index, taken at the bucket middle.
+  void RecordBucket(int index, uint64_t count);
+
+  void Merge(const LatencyHistogram& other);
+  void Clear();
+
+  uint64_t Count() const { return count_; }
+  uint64_t Min() const { return count_ == 0 ? 0 : min_; }
+  uint64_t Max() const { return max_; }
+  double Mean() const {
+    return count_ == 0 ? 0 : static_cast<double>(sum_) / count_;
+  }
+
+  // The value below which a share q in [0, 1] of the values fall, the middle
+  // of its bucket within [Min(), Max()]. 0 when empty.
+  uint64_t Percentile(double q) const;
+
+  static int BucketIndex(uint64_t value) {
+    if (value < kSubBucketCount) {
+      return value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBucketCount +
+           static_cast<int>((value >> shift) - kSubBucketCount);
+  }
+
+  // Smallest value and width of bucket index.
+  static uint64_t BucketLow(int index) {
+    if (index < kSubBucketCount) {
+      return index;
+    }
+    int shift = index / kSubBucketCount - 1;
+    return (uint64_t(kSubBucketCount) + index % kSubBucketCount) << shift;
+  }
+  static uint64_t BucketWidth(int index) {
+    return index < kSubBucketCount ? 1
+                                   : uint64_t(1) << (index / kSubBucketCount - 1);
+  }
+
+ private:
+  std::vector<uint64_t> buckets_;
+  uint64_t count_{0};
+  uint64_t sum_{0};
+  uint64_t min_{UINT64_MAX};
+  uint64_t max_{0};
+};
+
+// Records the nanoseconds from its construction to its destruction.
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(LatencyHistogram& histogram)
+      : histogram_(histogram), start_(CycleClock::Now()) {}
+  ~ScopedLatency() {
+    histogram_.Record(CycleClock::ToNanos(CycleClock::Now() - start_));
+  }
+
+  ScopedLatency(const ScopedLatency&) = delete;
+  ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+ private:
+  LatencyHistogram& histogram_;
+  uint64_t start_;
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
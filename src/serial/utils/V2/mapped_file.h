@@ -0,0 +1,48 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_MAPPED_FILE_V2_H_
+#define DINGO_SERIAL_MAPPED_FILE_V2_H_
+
+#include <cstddef>
+#include <string_view>
+
+namespace dingodb {
+namespace serialV2 {
+
+// A file mapped read only, empty when it could not be (or is). The pages
+// are read on first touch, the bytes stay valid while the mapping lives.
+class MappedFile {
+ public:
+  explicit MappedFile(const char* path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool IsOpen() const { return data_ != nullptr; }
+  std::string_view Data() const { return std::string_view(data_, size_); }
+
+  // Have the kernel read the whole file ahead, for a full scan.
+  void WillNeed() const;
+
+ private:
+  const char* data_{nullptr};
+  size_t size_{0};
+};
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
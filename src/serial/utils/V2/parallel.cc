@@ -0,0 +1,126 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// Chunks handed out by a shared counter, and the workers left to finish.
+struct ParallelState {
+  ParallelState(size_t count, size_t chunk_size,
+                const std::function<void(size_t, size_t)>& task)
+      : count(count), chunk_size(chunk_size), task(task) {}
+
+  void Work() {
+    while (!failed.load(std::memory_order_relaxed)) {
+      size_t begin = next.fetch_add(chunk_size, std::memory_order_relaxed);
+      if (begin >= count) {
+        break;
+      }
+      try {
+        task(begin, std::min(count, begin + chunk_size));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed.exchange(true)) {
+          error = std::current_exception();
+        }
+      }
+    }
+  }
+
+  void Done() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--running == 0) {
+      finished.notify_all();
+    }
+  }
+
+  const size_t count;
+  const size_t chunk_size;
+  const std::function<void(size_t, size_t)>& task;
+
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t running{0};
+};
+
+}  // namespace
+
+void ParallelFor(size_t count, const ParallelOptions& options,
+                 const std::function<void(size_t begin, size_t end)>& task) {
+  if (count == 0) {
+    return;
+  }
+
+  size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+  size_t thread_count = options.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, (count + chunk_size - 1) / chunk_size);
+  if (thread_count <= 1) {
+    for (size_t begin = 0; begin < count; begin += chunk_size) {
+      task(begin, std::min(count, begin + chunk_size));
+    }
+    return;
+  }
+
+  // shared with the helpers, they still hold it for a moment after Done.
+  auto state = std::make_shared<ParallelState>(count, chunk_size, task);
+  state->running = thread_count - 1;
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    auto helper = [state]() {
+      state->Work();
+      state->Done();
+    };
+    if (options.executor) {
+      options.executor(helper);
+    } else {
+      threads.emplace_back(helper);
+    }
+  }
+
+  state->Work();
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state]() { return state->running == 0; });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
@@ -0,0 +1,47 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_PARALLEL_V2_H_
+#define DINGO_SERIAL_PARALLEL_V2_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace dingodb {
+namespace serialV2 {
+
+// Runs a closure on some thread of the caller's pool, it must run every closure
+// it is given.
+using Executor = std::function<void(std::function<void()>)>;
+
+struct ParallelOptions {
+  // workers including the calling thread, 0 for one per hardware thread.
+  size_t thread_count{1};
+  // rows a worker takes at a time.
+  size_t chunk_size{1024};
+  // where the extra workers run, threads of our own when empty.
+  Executor executor;
+};
+
+// Call task(begin, end) over [0, count) in chunks of options.chunk_size. Idle
+// workers take the next chunk left, so an uneven chunk does not hold up the
+// others. Returns once every chunk is done, the first exception thrown by
+// task is rethrown here and the chunks not yet started are dropped.
+void ParallelFor(size_t count, const ParallelOptions& options,
+                 const std::function<void(size_t begin, size_t end)>& task);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
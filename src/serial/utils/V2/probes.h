@@ -0,0 +1,56 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_PROBES_V2_H_
+#define DINGO_SERIAL_PROBES_V2_H_
+
+// Static tracing probes of the provider dingo_serial, placed only when built
+// with DINGO_SERIAL_USDT (cmake -DWITH_USDT=ON, needs the sys/sdt.h of
+// systemtap), otherwise they compile away. A probe is a nop until a tracer
+// attaches to it, e.g.
+//   bpftrace -e 'usdt:./libdingo-serial.so:dingo_serial:decode_failure
+//                { @[arg0, arg1] = count(); }'
+//
+//   encode_start(common id, schema version)
+//   encode_done(common id, schema version, key bytes, value bytes)
+//   decode_start(common id, schema version, key bytes, value bytes)
+//   decode_done(common id, schema version, columns decoded)
+//   decode_projected_start(common id, schema version, key bytes, value bytes)
+//   decode_projected_done(common id, schema version, columns decoded)
+//   decode_failure(common id, schema version)
+//   v1_fallback(common id, schema version, key bytes, value bytes)
+//
+// the value bytes are those of the stored value, before decompression, 0
+// for a V1 key decoded alone; a decode that fails fires decode_failure in
+// place of its done probe.
+#if defined(DINGO_SERIAL_USDT)
+#include <sys/sdt.h>
+#define DINGO_SERIAL_PROBE2(name, a, b) DTRACE_PROBE2(dingo_serial, name, a, b)
+#define DINGO_SERIAL_PROBE3(name, a, b, c) \
+  DTRACE_PROBE3(dingo_serial, name, a, b, c)
+#define DINGO_SERIAL_PROBE4(name, a, b, c, d) \
+  DTRACE_PROBE4(dingo_serial, name, a, b, c, d)
+#else
+#define DINGO_SERIAL_PROBE2(name, a, b) \
+  do {                                  \
+  } while (0)
+#define DINGO_SERIAL_PROBE3(name, a, b, c) \
+  do {                                     \
+  } while (0)
+#define DINGO_SERIAL_PROBE4(name, a, b, c, d) \
+  do {                                        \
+  } while (0)
+#endif
+
+#endif
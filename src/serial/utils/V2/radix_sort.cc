@@ -0,0 +1,174 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "radix_sort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace dingodb {
+namespace serialV2 {
+
+// Ranges below this are sorted by insertion.
+static constexpr size_t kInsertionSortSize = 32;
+// Inputs below this are sorted on the calling thread, and ranges below it
+// are not split up front.
+static constexpr size_t kParallelSortSize = 4096;
+static constexpr int kMaxSplitRounds = 4;
+// bucket 0 holds the keys ending at the current byte, bucket b + 1 byte b.
+static constexpr size_t kBuckets = 257;
+
+static inline size_t Bucket(std::string_view key, size_t depth) {
+  return depth < key.size() ? static_cast<uint8_t>(key[depth]) + 1 : 0;
+}
+
+// The key bytes from depth on, compared as memcmp with the shorter first.
+static inline bool Less(std::string_view a, std::string_view b, size_t depth) {
+  return a.substr(depth) < b.substr(depth);
+}
+
+static void InsertionSort(const std::string_view* keys, uint32_t* order,
+                          size_t count, size_t depth) {
+  for (size_t i = 1; i < count; ++i) {
+    uint32_t pos = order[i];
+    size_t j = i;
+    for (; j > 0 && Less(keys[pos], keys[order[j - 1]], depth); --j) {
+      order[j] = order[j - 1];
+    }
+    order[j] = pos;
+  }
+}
+
+// Bytes from depth on that every key of order[0, count) shares.
+static size_t CommonPrefix(const std::string_view* keys, const uint32_t* order,
+                           size_t count, size_t depth) {
+  std::string_view first = keys[order[0]].substr(depth);
+  size_t common = first.size();
+  for (size_t i = 1; i < count && common > 0; ++i) {
+    std::string_view key = keys[order[i]].substr(depth);
+    size_t limit = std::min(common, key.size());
+    size_t n = 0;
+    while (n < limit && key[n] == first[n]) {
+      ++n;
+    }
+    common = n;
+  }
+  return common;
+}
+
+// Scatter order[0, count) into the buckets of their byte at depth through
+// tmp, starts gets the first position of every bucket and one past the end.
+static void Partition(const std::string_view* keys, uint32_t* order,
+                      uint32_t* tmp, size_t count, size_t depth,
+                      size_t (&starts)[kBuckets + 1]) {
+  size_t counts[kBuckets] = {};
+  for (size_t i = 0; i < count; ++i) {
+    ++counts[Bucket(keys[order[i]], depth)];
+  }
+  starts[0] = 0;
+  for (size_t b = 0; b < kBuckets; ++b) {
+    starts[b + 1] = starts[b] + counts[b];
+  }
+
+  size_t next[kBuckets];
+  std::copy(starts, starts + kBuckets, next);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t pos = order[i];
+    tmp[next[Bucket(keys[pos], depth)]++] = pos;
+  }
+  memcpy(order, tmp, count * sizeof(uint32_t));
+}
+
+static void SortRange(const std::string_view* keys, uint32_t* order,
+                      uint32_t* tmp, size_t count, size_t depth) {
+  if (count < kInsertionSortSize) {
+    InsertionSort(keys, order, count, depth);
+    return;
+  }
+
+  depth += CommonPrefix(keys, order, count, depth);
+  size_t starts[kBuckets + 1];
+  Partition(keys, order, tmp, count, depth, starts);
+  // the keys of bucket 0 ended, they are equal and stay in input order.
+  for (size_t b = 1; b < kBuckets; ++b) {
+    size_t size = starts[b + 1] - starts[b];
+    if (size > 1) {
+      SortRange(keys, order + starts[b], tmp + starts[b], size, depth + 1);
+    }
+  }
+}
+
+void RadixSortKeys(const std::string_view* keys, size_t count,
+                   std::vector<uint32_t>& order,
+                   const ParallelOptions& options) {
+  order.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    order[i] = i;
+  }
+  std::vector<uint32_t> tmp(count);
+  if (options.thread_count == 1 || count < kParallelSortSize) {
+    SortRange(keys, order.data(), tmp.data(), count, 0);
+    return;
+  }
+
+  // Split breadth first until there are ranges enough to keep the workers
+  // busy, keys often share their leading bytes past the table prefix so the
+  // first byte alone may give a couple of buckets only.
+  struct Range {
+    size_t begin;
+    size_t count;
+    size_t depth;
+  };
+  std::vector<Range> ranges{{0, count, 0}};
+  size_t workers = options.thread_count == 0 ? std::thread::hardware_concurrency()
+                                             : options.thread_count;
+  for (int round = 0; round < kMaxSplitRounds && ranges.size() < workers * 8;
+       ++round) {
+    std::vector<Range> split;
+    for (const auto& range : ranges) {
+      if (range.count < kParallelSortSize) {
+        split.push_back(range);
+        continue;
+      }
+      uint32_t* range_order = order.data() + range.begin;
+      size_t depth =
+          range.depth + CommonPrefix(keys, range_order, range.count, range.depth);
+      size_t starts[kBuckets + 1];
+      Partition(keys, range_order, tmp.data() + range.begin, range.count, depth,
+                starts);
+      for (size_t b = 1; b < kBuckets; ++b) {
+        size_t size = starts[b + 1] - starts[b];
+        if (size > 1) {
+          split.push_back({range.begin + starts[b], size, depth + 1});
+        }
+      }
+    }
+    ranges.swap(split);
+  }
+
+  // The ranges own disjoint parts of order and tmp.
+  ParallelOptions range_options = options;
+  range_options.chunk_size = 1;
+  ParallelFor(ranges.size(), range_options, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const auto& range = ranges[i];
+      SortRange(keys, order.data() + range.begin, tmp.data() + range.begin,
+                range.count, range.depth);
+    }
+  });
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
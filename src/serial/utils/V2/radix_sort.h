@@ -0,0 +1,42 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_RADIX_SORT_V2_H_
+#define DINGO_SERIAL_RADIX_SORT_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "serial/utils/V2/parallel.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+// Set order to the positions of keys[0, count) sorted by the key bytes as
+// memcmp orders them, a key before the longer keys it is a prefix of, equal
+// keys in their input order. An MSD radix sort: the bytes all keys of a range
+// share are stepped over, the rest is bucketed one byte at a time and small
+// ranges are finished by insertion. With more than one worker in options the
+// keys are first split into ranges over the leading bytes that differ, which
+// are then sorted over the workers.
+void RadixSortKeys(const std::string_view* keys, size_t count,
+                   std::vector<uint32_t>& order /*output*/,
+                   const ParallelOptions& options = {});
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -11,7 +11,11 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include "serial/utils/V2/schema_converter.h"
+
+#include <climits>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -311,4 +315,74 @@ std::vector<serialV2::BaseSchemaPtr> ConvertSchemasV2(
   return std::move(schemas_v2);
 }
 
+DualSchemasPtr MakeDualSchemas(
+    std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas) {
+  auto dual = std::make_shared<DualSchemas>();
+  dual->v2 = ConvertSchemasV2(schemas);
+  dual->v1 = std::move(schemas);
+  return dual;
+}
+
+DualSchemasPtr MakeDualSchemas(
+    const std::vector<serialV2::BaseSchemaPtr>& schemas) {
+  auto dual = std::make_shared<DualSchemas>();
+  dual->v1 = ConvertSchemasV1(schemas);
+  dual->v2 = schemas;
+  return dual;
+}
+
+template <typename Schemas>
+DualSchemasPtr SchemaConversionCache::GetImpl(long common_id,
+                                              int schema_version,
+                                              const Schemas& schemas) {
+  auto key = std::make_pair(common_id, schema_version);
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      return it->second;
+    }
+  }
+
+  // converted outside the lock, a racing conversion of the key is dropped.
+  DualSchemasPtr dual = MakeDualSchemas(schemas);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  return entries_.emplace(key, std::move(dual)).first->second;
+}
+
+DualSchemasPtr SchemaConversionCache::Get(
+    long common_id, int schema_version,
+    std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas) {
+  return GetImpl(common_id, schema_version, schemas);
+}
+
+DualSchemasPtr SchemaConversionCache::Get(
+    long common_id, int schema_version,
+    const std::vector<serialV2::BaseSchemaPtr>& schemas) {
+  return GetImpl(common_id, schema_version, schemas);
+}
+
+DualSchemasPtr SchemaConversionCache::Find(long common_id,
+                                           int schema_version) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = entries_.find(std::make_pair(common_id, schema_version));
+  return it == entries_.end() ? nullptr : it->second;
+}
+
+void SchemaConversionCache::Remove(long common_id) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  entries_.erase(entries_.lower_bound({common_id, INT_MIN}),
+                 entries_.upper_bound({common_id, INT_MAX}));
+}
+
+void SchemaConversionCache::Clear() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  entries_.clear();
+}
+
+size_t SchemaConversionCache::Size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return entries_.size();
+}
+
 }  // namespace dingodb
\ No newline at end of file
@@ -14,7 +14,10 @@
 
 #ifndef DINGO_SCHEMA_CONVERTER_H_
 #define DINGO_SCHEMA_CONVERTER_H_
+#include <map>
 #include <memory>
+#include <shared_mutex>
+#include <utility>
 #include <vector>
 
 #include "serial/record/V2/record_encoder.h"
@@ -29,6 +32,54 @@ std::vector<serialV2::BaseSchemaPtr> ConvertSchemasV2(
     const std::shared_ptr<std::vector<std::shared_ptr<dingodb::BaseSchema>>>
         schemas);
 
+// One schema set in both forms, converted once and then only read, shared by
+// the RecordEncoder / RecordDecoder wrappers built from it.
+struct DualSchemas {
+  std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> v1;
+  std::vector<serialV2::BaseSchemaPtr> v2;
+};
+using DualSchemasPtr = std::shared_ptr<const DualSchemas>;
+
+DualSchemasPtr MakeDualSchemas(
+    std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas);
+DualSchemasPtr MakeDualSchemas(
+    const std::vector<serialV2::BaseSchemaPtr>& schemas);
+
+/*
+ * The conversions of the schema sets in use by (common_id, schema_version),
+ * so that building the wrappers of a table for every request converts its
+ * schemas once. A schema version is immutable, the schemas passed for a key
+ * already cached are not looked at. Lookups only take a shared lock.
+ */
+class SchemaConversionCache {
+ public:
+  SchemaConversionCache() = default;
+  SchemaConversionCache(const SchemaConversionCache&) = delete;
+  SchemaConversionCache& operator=(const SchemaConversionCache&) = delete;
+
+  // The cached conversion, converting schemas on a miss.
+  DualSchemasPtr Get(
+      long common_id, int schema_version,
+      std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas);
+  DualSchemasPtr Get(long common_id, int schema_version,
+                     const std::vector<serialV2::BaseSchemaPtr>& schemas);
+  // nullptr when not cached.
+  DualSchemasPtr Find(long common_id, int schema_version) const;
+
+  // Drop every version of the table.
+  void Remove(long common_id);
+  void Clear();
+  size_t Size() const;
+
+ private:
+  template <typename Schemas>
+  DualSchemasPtr GetImpl(long common_id, int schema_version,
+                         const Schemas& schemas);
+
+  mutable std::shared_mutex mutex_;
+  std::map<std::pair<long, int>, DualSchemasPtr> entries_;
+};
+
 }  // namespace dingodb
 
 #endif
\ No newline at end of file
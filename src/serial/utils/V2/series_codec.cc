@@ -0,0 +1,365 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "serial/utils/V2/series_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "serial/utils/V2/compiler.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+namespace {
+
+// 8 bytes with byte i at the low end, whatever the host order.
+inline uint64_t LoadLittle64(const uint8_t* p) {
+  uint64_t word;
+  memcpy(&word, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+inline void StoreLittle64(uint8_t* p, uint64_t word) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  memcpy(p, &word, 8);
+}
+
+inline uint64_t LowBits(int width) {
+  return width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+}
+
+inline int BitWidth(uint64_t value) {
+  return value == 0 ? 0 : 64 - __builtin_clzll(value);
+}
+
+// Appends fields of 0 to 64 bits, a word at a time.
+class BitWriter {
+ public:
+  explicit BitWriter(uint8_t* out) : out_(out) {}
+
+  void Put(uint64_t bits, int width) {
+    acc_ |= bits << used_;
+    int total = used_ + width;
+    if (total < 64) {
+      used_ = total;
+      return;
+    }
+    StoreLittle64(out_, acc_);
+    out_ += 8;
+    acc_ = used_ == 0 ? 0 : bits >> (64 - used_);
+    used_ = total - 64;
+  }
+
+  // the bytes left in the last word.
+  void Flush() {
+    for (int i = 0; i < used_; i += 8) {
+      *out_++ = static_cast<uint8_t>(acc_ >> i);
+    }
+    acc_ = 0;
+    used_ = 0;
+  }
+
+ private:
+  uint8_t* out_;
+  uint64_t acc_{0};
+  int used_{0};
+};
+
+// Counts the bits a BitWriter would write.
+class BitCounter {
+ public:
+  void Put(uint64_t, int width) { bits_ += width; }
+  size_t Bytes() const { return (bits_ + 7) / 8; }
+
+ private:
+  size_t bits_{0};
+};
+
+class BitReader {
+ public:
+  BitReader(const uint8_t* in, size_t size) : in_(in), size_(size) {}
+
+  bool Has(size_t width) const { return width <= size_ * 8 - pos_; }
+  void Skip(size_t width) { pos_ += width; }
+
+  // The next width bits, Has(width) must hold.
+  uint64_t Get(int width) {
+    if (width == 0) {
+      return 0;
+    }
+    size_t byte = pos_ >> 3;
+    int shift = pos_ & 7;
+    uint64_t word;
+    if (DINGO_LIKELY(byte + 8 <= size_)) {
+      word = LoadLittle64(in_ + byte);
+    } else {
+      uint8_t tail[8] = {0};
+      memcpy(tail, in_ + byte, size_ - byte);
+      word = LoadLittle64(tail);
+    }
+    uint64_t bits = word >> shift;
+    if (shift + width > 64) {
+      bits |= static_cast<uint64_t>(in_[byte + 8]) << (64 - shift);
+    }
+    pos_ += width;
+    return bits & LowBits(width);
+  }
+
+ private:
+  const uint8_t* in_;
+  size_t size_;
+  size_t pos_{0};
+};
+
+template <typename T>
+using UnsignedOf = std::make_unsigned_t<T>;
+
+// value - prev in the wrapping arithmetic of T, zigzag encoded.
+template <typename T>
+inline UnsignedOf<T> ZigZagDelta(T value, T prev) {
+  using U = UnsignedOf<T>;
+  U delta = static_cast<U>(value) - static_cast<U>(prev);
+  U sign = static_cast<U>(static_cast<T>(delta) >> (sizeof(T) * 8 - 1));
+  return static_cast<U>((delta << 1) ^ sign);
+}
+
+template <typename T>
+inline T AddZigZagDelta(T prev, UnsignedOf<T> zigzag) {
+  using U = UnsignedOf<T>;
+  U delta = static_cast<U>((zigzag >> 1) ^ (U(0) - (zigzag & 1)));
+  return static_cast<T>(static_cast<U>(prev) + delta);
+}
+
+template <typename T>
+DeltaFrame PlanDeltasImpl(const T* values, size_t count) {
+  DeltaFrame frame;
+  if (count < 2) {
+    return frame;
+  }
+  UnsignedOf<T> min = ZigZagDelta(values[1], values[0]);
+  UnsignedOf<T> max = min;
+  for (size_t i = 2; i < count; ++i) {
+    UnsignedOf<T> zigzag = ZigZagDelta(values[i], values[i - 1]);
+    min = std::min(min, zigzag);
+    max = std::max(max, zigzag);
+  }
+  frame.base = min;
+  frame.width = BitWidth(max - min);
+  return frame;
+}
+
+template <typename T>
+void PackDeltasImpl(const T* values, size_t count, const DeltaFrame& frame,
+                    uint8_t* packed) {
+  if (frame.width == 0) {
+    return;
+  }
+  auto base = static_cast<UnsignedOf<T>>(frame.base);
+  BitWriter writer(packed);
+  for (size_t i = 1; i < count; ++i) {
+    writer.Put(static_cast<UnsignedOf<T>>(ZigZagDelta(values[i], values[i - 1]) -
+                                          base),
+               frame.width);
+  }
+  writer.Flush();
+}
+
+template <typename T>
+void UnpackDeltasImpl(const uint8_t* packed, size_t count,
+                      const DeltaFrame& frame, T* values) {
+  auto base = static_cast<UnsignedOf<T>>(frame.base);
+  if (frame.width == 0) {
+    // a constant step, nothing packed.
+    for (size_t i = 1; i < count; ++i) {
+      values[i] = AddZigZagDelta(values[i - 1], base);
+    }
+    return;
+  }
+  size_t size = PackedDeltasSize(count, frame.width);
+  size_t i = 1;
+  if (frame.width <= 56) {
+    // a field and its shift fit one unaligned word while 8 bytes are left.
+    int width = frame.width;
+    uint64_t mask = LowBits(width);
+    // the fields starting in the bytes before the last 8.
+    size_t fast = size < 8 ? 1 : std::min(count, ((size - 8) * 8) / width + 2);
+    size_t bit = 0;
+    T prev = values[0];
+    for (; i < fast; ++i, bit += width) {
+      uint64_t bits = LoadLittle64(packed + (bit >> 3)) >> (bit & 7);
+      prev = AddZigZagDelta(
+          prev, static_cast<UnsignedOf<T>>((bits & mask) + base));
+      values[i] = prev;
+    }
+  }
+  BitReader reader(packed, size);
+  reader.Skip((i - 1) * frame.width);
+  for (; i < count; ++i) {
+    auto zigzag = static_cast<UnsignedOf<T>>(reader.Get(frame.width) + base);
+    values[i] = AddZigZagDelta(values[i - 1], zigzag);
+  }
+}
+
+inline uint64_t DoubleBits(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, 8);
+  return bits;
+}
+
+inline double BitsDouble(uint64_t bits) {
+  double value;
+  memcpy(&value, &bits, 8);
+  return value;
+}
+
+// The leading zeros of a window are kept in 5 bits.
+constexpr int kMaxLeading = 31;
+
+// Each element after the first: 0 for the same bits as the one before, 10
+// then the meaningful bits of the xor in the window of the last 11, or 11,
+// 5 bits of leading zeros, 6 bits of the meaningful bit count less one and
+// the meaningful bits, which open a new window. Bits go low first.
+template <typename Sink>
+void XorWalk(const double* values, size_t count, Sink& sink) {
+  if (count == 0) {
+    return;
+  }
+  uint64_t prev = DoubleBits(values[0]);
+  sink.Put(prev, 64);
+  int lead = -1;
+  int trail = 0;
+  for (size_t i = 1; i < count; ++i) {
+    uint64_t bits = DoubleBits(values[i]);
+    uint64_t x = bits ^ prev;
+    prev = bits;
+    if (x == 0) {
+      sink.Put(0, 1);
+      continue;
+    }
+
+    int l = std::min(__builtin_clzll(x), kMaxLeading);
+    int t = __builtin_ctzll(x);
+    if (lead >= 0 && l >= lead && t >= trail) {
+      sink.Put(0b01, 2);
+      sink.Put(x >> trail, 64 - lead - trail);
+      continue;
+    }
+    int meaningful = 64 - l - t;
+    sink.Put(0b11, 2);
+    sink.Put(l, 5);
+    sink.Put(meaningful - 1, 6);
+    sink.Put(x >> t, meaningful);
+    lead = l;
+    trail = t;
+  }
+}
+
+}  // namespace
+
+DeltaFrame PlanDeltas(const int32_t* values, size_t count) {
+  return PlanDeltasImpl(values, count);
+}
+
+DeltaFrame PlanDeltas(const int64_t* values, size_t count) {
+  return PlanDeltasImpl(values, count);
+}
+
+void PackDeltas(const int32_t* values, size_t count, const DeltaFrame& frame,
+                uint8_t* packed) {
+  PackDeltasImpl(values, count, frame, packed);
+}
+
+void PackDeltas(const int64_t* values, size_t count, const DeltaFrame& frame,
+                uint8_t* packed) {
+  PackDeltasImpl(values, count, frame, packed);
+}
+
+void UnpackDeltas(const uint8_t* packed, size_t count, const DeltaFrame& frame,
+                  int32_t* values) {
+  UnpackDeltasImpl(packed, count, frame, values);
+}
+
+void UnpackDeltas(const uint8_t* packed, size_t count, const DeltaFrame& frame,
+                  int64_t* values) {
+  UnpackDeltasImpl(packed, count, frame, values);
+}
+
+size_t XorEncodedSize(const double* values, size_t count) {
+  BitCounter counter;
+  XorWalk(values, count, counter);
+  return counter.Bytes();
+}
+
+void XorEncode(const double* values, size_t count, uint8_t* out) {
+  BitWriter writer(out);
+  XorWalk(values, count, writer);
+  writer.Flush();
+}
+
+bool XorDecode(const uint8_t* in, size_t size, size_t count, double* values) {
+  if (count == 0) {
+    return true;
+  }
+  BitReader reader(in, size);
+  if (!reader.Has(64)) {
+    return false;
+  }
+  uint64_t prev = reader.Get(64);
+  values[0] = BitsDouble(prev);
+  int lead = -1;
+  int trail = 0;
+  for (size_t i = 1; i < count; ++i) {
+    if (!reader.Has(1)) {
+      return false;
+    }
+    if (reader.Get(1) != 0) {
+      if (!reader.Has(1)) {
+        return false;
+      }
+      int meaningful;
+      if (reader.Get(1) == 0) {
+        if (lead < 0) {
+          return false;
+        }
+        meaningful = 64 - lead - trail;
+      } else {
+        if (!reader.Has(11)) {
+          return false;
+        }
+        lead = reader.Get(5);
+        meaningful = reader.Get(6) + 1;
+        trail = 64 - lead - meaningful;
+        if (trail < 0) {
+          return false;
+        }
+      }
+      if (!reader.Has(meaningful)) {
+        return false;
+      }
+      prev ^= reader.Get(meaningful) << trail;
+    }
+    values[i] = BitsDouble(prev);
+  }
+  return true;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
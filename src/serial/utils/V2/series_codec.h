@@ -0,0 +1,75 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_SERIES_CODEC_V2_H_
+#define DINGO_SERIAL_SERIES_CODEC_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dingodb {
+namespace serialV2 {
+
+// Element encodings of number lists whose neighbouring elements are close,
+// such as time series.
+enum class SeriesEncoding : uint8_t {
+  kPlain = 0,
+  // integers: the first element, then the zigzag deltas of the others less
+  // their minimum, each in the same number of bits.
+  kDelta = 1,
+  // doubles: the first element, then each xor the one before in the control
+  // bits and meaningful bits of Gorilla.
+  kXor = 2,
+};
+
+// The frame of reference of delta encoded integers, every zigzag delta less
+// base takes width bits.
+struct DeltaFrame {
+  uint64_t base{0};
+  int width{0};
+};
+
+DeltaFrame PlanDeltas(const int32_t* values, size_t count);
+DeltaFrame PlanDeltas(const int64_t* values, size_t count);
+
+// Bytes of the packed deltas of count elements, the first is kept apart.
+inline size_t PackedDeltasSize(size_t count, int width) {
+  return count < 2 ? 0 : ((count - 1) * width + 7) / 8;
+}
+
+// Pack the deltas of values into PackedDeltasSize bytes of packed. The bit
+// streams here are little endian whatever the host, the unused high bits of
+// the last byte are zero.
+void PackDeltas(const int32_t* values, size_t count, const DeltaFrame& frame,
+                uint8_t* packed);
+void PackDeltas(const int64_t* values, size_t count, const DeltaFrame& frame,
+                uint8_t* packed);
+
+// The reverse of PackDeltas, values[0] must hold the first element.
+void UnpackDeltas(const uint8_t* packed, size_t count, const DeltaFrame& frame,
+                  int32_t* values);
+void UnpackDeltas(const uint8_t* packed, size_t count, const DeltaFrame& frame,
+                  int64_t* values);
+
+// Bytes XorEncode writes for values.
+size_t XorEncodedSize(const double* values, size_t count);
+void XorEncode(const double* values, size_t count, uint8_t* out);
+// The reverse of XorEncode, false when the size bytes of in end before count
+// elements.
+bool XorDecode(const uint8_t* in, size_t size, size_t count, double* values);
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
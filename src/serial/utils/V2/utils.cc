@@ -14,35 +14,70 @@
 
 #include "serial/utils/V2/utils.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "serial/schema/V2/base_schema.h"
+#include "serial/schema/V2/integer_schema.h"
+#include "serial/schema/V2/long_schema.h"
+#include "serial/schema/V2/string_schema.h"
 
 namespace dingodb {
 namespace serialV2 {
 
+namespace {
+
+// 0 for fixed width columns, fixed length strings among them, 1 for other
+// strings and varints, 2 for lists.
+int WidthClass(BaseSchema* schema) {
+  BaseSchema::Type type = schema->GetType();
+  if (type >= BaseSchema::kBoolList) {
+    return 2;
+  }
+  if (type == BaseSchema::kInteger) {
+    return static_cast<DingoSchema<int32_t>*>(schema)->IsVarint() ? 1 : 0;
+  }
+  if (type == BaseSchema::kLong) {
+    return static_cast<DingoSchema<int64_t>*>(schema)->IsVarint() ? 1 : 0;
+  }
+  if (type != BaseSchema::kString) {
+    return 0;
+  }
+  return static_cast<DingoSchema<std::string>*>(schema)->GetFixedLength() > 0
+             ? 0
+             : 1;
+}
+
+}  // namespace
+
+bool ValueLayoutBefore(BaseSchema* a, BaseSchema* b) {
+  int a_class = WidthClass(a);
+  int b_class = WidthClass(b);
+  if (a_class != b_class) {
+    return a_class < b_class;
+  }
+  return a->GetAccessFrequency() > b->GetAccessFrequency();
+}
+
 void SortSchema(std::vector<BaseSchemaPtr>& schemas) {
-  uint32_t flag = 1;
-  for (uint32_t i = 0; i < schemas.size() - flag; i++) {
-    auto bs = schemas.at(i);
-    if (bs != nullptr) {
-      if ((!bs->IsKey()) && (bs->GetLengthForValue() == 0)) {
-        int32_t target = schemas.size() - flag++;
-        auto ts = schemas.at(target);
-        while ((ts->GetLengthForValue() == 0) || ts->IsKey()) {
-          target--;
-          if (static_cast<uint32_t>(target) == i) {
-            return;
-          }
-          flag++;
-        }
-        schemas.at(i) = ts;
-        schemas.at(target) = bs;
-      }
+  std::vector<size_t> slots;
+  std::vector<BaseSchemaPtr> values;
+  for (size_t i = 0; i < schemas.size(); ++i) {
+    if (schemas[i] != nullptr && !schemas[i]->IsKey()) {
+      slots.push_back(i);
+      values.push_back(schemas[i]);
     }
   }
+  std::stable_sort(values.begin(), values.end(),
+                   [](const BaseSchemaPtr& a, const BaseSchemaPtr& b) {
+                     return ValueLayoutBefore(a.get(), b.get());
+                   });
+  for (size_t i = 0; i < slots.size(); ++i) {
+    schemas[slots[i]] = std::move(values[i]);
+  }
 }
 
 void FormatSchema(std::vector<BaseSchemaPtr>& schemas, bool le) {
@@ -69,6 +104,14 @@ bool IsLE() {
   return *c == 1;
 }
 
+size_t HeapSize(const std::string& s) {
+  const char* self = reinterpret_cast<const char*>(&s);
+  if (s.data() >= self && s.data() < self + sizeof(s)) {
+    return 0;
+  }
+  return s.capacity() + 1;
+}
+
 bool StringToBool(const std::string& str) {
   return !(str == "0" || str == "false");
 }
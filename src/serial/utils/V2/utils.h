@@ -15,7 +15,9 @@
 #ifndef DINGO_SERIAL_UTILS_V2_H_
 #define DINGO_SERIAL_UTILS_V2_H_
 
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "serial/schema/V2/base_schema.h"
@@ -23,6 +25,13 @@
 namespace dingodb {
 namespace serialV2 {
 
+// Whether value column a goes ahead of b in the value layout: fixed width
+// columns and fixed length strings, then other strings and varints, then
+// lists, the hotter by access frequency first within each. A strict weak order, meant for a stable sort.
+bool ValueLayoutBefore(BaseSchema* a, BaseSchema* b);
+
+// Reorder the value columns of schemas by ValueLayoutBefore, keeping the
+// positions of the key and null schemas.
 void SortSchema(std::vector<BaseSchemaPtr>& schemas);
 void FormatSchema(std::vector<BaseSchemaPtr>& schemas, bool le);
 bool VectorFindAndRemove(std::vector<int>* v, int t);
@@ -33,6 +42,13 @@ inline bool VectorFind(const std::vector<int>& v, int t, int n) {
 
 bool IsLE();
 
+// Bytes s holds on the heap, 0 while it fits in the string itself.
+size_t HeapSize(const std::string& s);
+template <typename T>
+size_t HeapSize(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
 // string type cast
 bool StringToBool(const std::string& str);
 int32_t StringToInt32(const std::string& str);
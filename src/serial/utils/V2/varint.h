@@ -0,0 +1,98 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_VARINT_V2_H_
+#define DINGO_SERIAL_VARINT_V2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "serial/utils/V2/buf.h"
+
+namespace dingodb {
+namespace serialV2 {
+
+/*
+ * LEB128 varints: 7 bits per byte, low group first, the high bit set on all
+ * bytes but the last. Signed values are zigzag mapped first so that small
+ * negative numbers stay short. The encoding is not memory comparable and is
+ * only used in values.
+ */
+
+constexpr int kMaxVarint32Length = 5;
+constexpr int kMaxVarint64Length = 10;
+
+inline uint32_t ZigZagEncode32(int32_t v) {
+  return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline int32_t ZigZagDecode32(uint32_t v) {
+  return static_cast<int32_t>((v >> 1) ^ (~(v & 1) + 1));
+}
+
+inline uint64_t ZigZagEncode64(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t ZigZagDecode64(uint64_t v) {
+  return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+}
+
+inline int VarintLength(uint64_t v) {
+  int len = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    ++len;
+  }
+  return len;
+}
+
+// Append v to buf, return the encoded length.
+inline int WriteVarint(Buf& buf, uint64_t v) {
+  char bytes[kMaxVarint64Length];
+  int len = 0;
+  while (v >= 0x80) {
+    bytes[len++] = static_cast<char>(v | 0x80);
+    v >>= 7;
+  }
+  bytes[len++] = static_cast<char>(v);
+
+  size_t pos = buf.Size();
+  buf.Enlarge(len);
+  memcpy(buf.Data() + pos, bytes, len);
+  return len;
+}
+
+// Read a varint of at most max_len bytes from data[0, size), return its length
+// or 0 when it is truncated or too long.
+inline int ReadVarint(const char* data, size_t size, uint64_t& value,
+                      int max_len = kMaxVarint64Length) {
+  uint64_t result = 0;
+  size_t limit = size < static_cast<size_t>(max_len) ? size : max_len;
+  for (size_t i = 0; i < limit; ++i) {
+    uint8_t byte = static_cast<uint8_t>(data[i]);
+    result |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      value = result;
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace serialV2
+}  // namespace dingodb
+
+#endif
@@ -48,6 +48,13 @@ Buf::Buf(const std::string& buf, bool le) {
   this->le_ = le;
 }
 
+Buf::Buf(std::string_view buf, bool le) {
+  this->view_data_ = buf.data();
+  this->view_size_ = buf.size();
+  this->reverse_pos_ = this->view_size_ - 1;
+  this->le_ = le;
+}
+
 Buf::~Buf() { this->buf_.clear(); }
 
 void Buf::Init(int size) {
@@ -159,39 +166,39 @@ void Buf::ReverseWriteInt(int32_t i) {
   }
 }
 
-uint8_t Buf::Peek() { return buf_.at(forward_pos_); }
+uint8_t Buf::Peek() { return At(forward_pos_); }
 
 int32_t Buf::PeekInt() {
   if (this->le_) {
-    return ((buf_.at(forward_pos_) & 0xFF) << 24) |
-           ((buf_.at(forward_pos_ + 1) & 0xFF) << 16) |
-           ((buf_.at(forward_pos_ + 2) & 0xFF) << 8) |
-           (buf_.at(forward_pos_ + 3) & 0xFF);
+    return ((At(forward_pos_) & 0xFF) << 24) |
+           ((At(forward_pos_ + 1) & 0xFF) << 16) |
+           ((At(forward_pos_ + 2) & 0xFF) << 8) |
+           (At(forward_pos_ + 3) & 0xFF);
   } else {
-    return ((buf_.at(forward_pos_) & 0xFF) |
-            ((buf_.at(forward_pos_ + 1) & 0xFF) << 8) |
-            ((buf_.at(forward_pos_ + 2) & 0xFF) << 16) |
-            ((buf_.at(forward_pos_ + 3) & 0xFF) << 24));
+    return ((At(forward_pos_) & 0xFF) |
+            ((At(forward_pos_ + 1) & 0xFF) << 8) |
+            ((At(forward_pos_ + 2) & 0xFF) << 16) |
+            ((At(forward_pos_ + 3) & 0xFF) << 24));
   }
 }
 
 int64_t Buf::PeekLong() {
-  uint64_t l = (buf_.at(forward_pos_)) & 0xFF;
+  uint64_t l = (At(forward_pos_)) & 0xFF;
   if (this->le_) {
     for (int i = 0; i < 7; i++) {
       l <<= 8;
-      l |= (buf_.at(forward_pos_ + i + 1)) & 0xFF;
+      l |= (At(forward_pos_ + i + 1)) & 0xFF;
     }
   } else {
     for (int i = 1; i < 8; i++) {
-      l |= (((uint64_t)(buf_.at(forward_pos_ + i)) & 0xFF) << (8 * i));
+      l |= (((uint64_t)(At(forward_pos_ + i)) & 0xFF) << (8 * i));
     }
   }
   return l;
 }
 
-uint8_t Buf::Read() { return buf_.at(forward_pos_++); }
-uint8_t Buf::ReversePeek() { return buf_.at(reverse_pos_); }
+uint8_t Buf::Read() { return At(forward_pos_++); }
+uint8_t Buf::ReversePeek() { return At(reverse_pos_); }
 
 int32_t Buf::ReadInt() {
   if (this->le_) {
@@ -220,11 +227,15 @@ int64_t Buf::ReadLong() {
 
 std::string Buf::ReadString() {
   int internal_forward_pos = forward_pos_;
-  forward_pos_ = buf_.size();
+  forward_pos_ = Size();
+  if (view_data_ != nullptr) {
+    return std::string(view_data_ + internal_forward_pos,
+                       view_size_ - internal_forward_pos);
+  }
   return std::string(buf_.begin() + internal_forward_pos, buf_.end());
 }
 
-uint8_t Buf::ReverseRead() { return buf_.at(reverse_pos_--); }
+uint8_t Buf::ReverseRead() { return At(reverse_pos_--); }
 
 int32_t Buf::ReverseReadInt() {
   if (this->le_) {
@@ -17,7 +17,9 @@
 
 #include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace dingodb {
@@ -29,6 +31,22 @@ class Buf {
   int reverse_pos_ = 0;
   int count_ = 0;
   bool le_;
+  // bytes read in place by a view buf, nullptr when it owns buf_.
+  const char* view_data_ = nullptr;
+  int view_size_ = 0;
+
+  char At(int pos) const {
+    if (view_data_ == nullptr) {
+      return buf_.at(pos);
+    }
+    if (pos < 0 || pos >= view_size_) {
+      throw std::out_of_range("Buf out of range.");
+    }
+    return view_data_[pos];
+  }
+  int Size() const {
+    return view_data_ == nullptr ? static_cast<int>(buf_.size()) : view_size_;
+  }
 
  public:
   Buf(int size, bool le);
@@ -37,6 +55,8 @@ class Buf {
   Buf(std::string* buf);
   Buf(const std::string& buf, bool le);
   Buf(const std::string& buf);
+  // Read only buf over buf in place, buf must outlive it.
+  Buf(std::string_view buf, bool le);
   ~Buf();
   void Init(int size);
   void Init(std::string* buf);
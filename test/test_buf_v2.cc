@@ -15,15 +15,35 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iomanip>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
+#include "serial/utils/V2/allocation_counter.h"
 #include "serial/utils/V2/buf.h"
+#include "serial/utils/V2/bit_pack.h"
+#include "serial/utils/V2/bloom_filter.h"
+#include "serial/utils/V2/buf_view.h"
+#include "serial/utils/V2/byte_order.h"
+#include "serial/utils/V2/byte_swap.h"
+#include "serial/utils/V2/codec_stats.h"
+#include "serial/utils/V2/compression.h"
+#include "serial/utils/V2/distinct_sketch.h"
+#include "serial/utils/V2/float_distance.h"
+#include "serial/utils/V2/hash.h"
+#include "serial/utils/V2/latency.h"
+#include "serial/utils/V2/parallel.h"
+#include "serial/utils/V2/radix_sort.h"
 
 // using namespace dingodb::serialV2;
 
@@ -219,6 +239,36 @@ TEST_F(BufTest, LongTest) {
   ASSERT_EQ(0x04, buf.ReadLong(16));
 }
 
+TEST_F(BufTest, NegationTest) {
+  dingodb::serialV2::Buf buf(24, true);
+
+  buf.WriteIntWithFirstBitNegation(-2);
+  buf.WriteIntWithNegation(0x31323334);
+  buf.WriteLongWithFirstBitNegation(1);
+  buf.WriteLongWithNegation((long)0x31323334aabbccdd);
+
+  ASSERT_EQ(24, buf.Size());
+
+  // sign bit flipped in the first (most significant) byte only.
+  ASSERT_EQ(0x7f, buf.Read(0));
+  ASSERT_EQ(0xfe, buf.Read(3));
+  ASSERT_EQ(0xce, buf.Read(4));
+  ASSERT_EQ(0xcb, buf.Read(7));
+  ASSERT_EQ(0x80, buf.Read(8));
+  ASSERT_EQ(0x01, buf.Read(15));
+  ASSERT_EQ(0xce, buf.Read(16));
+  ASSERT_EQ(0x22, buf.Read(23));
+
+  ASSERT_EQ(-2, buf.ReadIntWithFirstBitNegation());
+  ASSERT_EQ(0x31323334, buf.ReadIntWithNegation());
+  ASSERT_EQ(1, buf.ReadLongWithFirstBitNegation());
+  ASSERT_EQ(0x31323334aabbccdd, buf.ReadLongWithNegation());
+  ASSERT_TRUE(buf.IsEnd());
+
+  ASSERT_THROW(buf.ReadInt(22), std::out_of_range);
+  ASSERT_THROW(buf.WriteInt(22, 0), std::runtime_error);
+}
+
 TEST_F(BufTest, StringTest) {
   dingodb::serialV2::Buf buf(100, true);
 
@@ -234,3 +284,659 @@ TEST_F(BufTest, StringTest) {
   ASSERT_EQ("abcde12345abcde12345", str);
   ASSERT_EQ(0, buf.Size());
 }
+
+TEST_F(BufTest, BufViewRead) {
+  for (bool le : {true, false}) {
+    dingodb::serialV2::Buf buf(64, le);
+    buf.Write(0x11);
+    buf.WriteShort(static_cast<int16_t>(0x2233));
+    buf.WriteInt(0x44556677);
+    buf.WriteLong((long)0x31323334aabbccdd);
+    buf.WriteLongWithFirstBitNegation(-5);
+
+    const std::string& bytes = buf.GetString();
+    dingodb::serialV2::BufView view(bytes, le);
+
+    ASSERT_EQ(bytes.size(), view.Size());
+    ASSERT_EQ(le, view.IsLe());
+    ASSERT_EQ(bytes.data(), view.Data());
+
+    ASSERT_EQ(0x11, view.Peek());
+    ASSERT_EQ(0x11, view.Read());
+    ASSERT_EQ(0x2233, view.ReadShort());
+    ASSERT_EQ(0x44556677, view.PeekInt());
+    ASSERT_EQ(0x44556677, view.ReadInt());
+    ASSERT_EQ(0x31323334aabbccdd, view.PeekLong());
+    ASSERT_EQ(0x31323334aabbccdd, view.ReadLong());
+    ASSERT_EQ(-5, view.ReadLongWithFirstBitNegation());
+    ASSERT_TRUE(view.IsEnd());
+
+    ASSERT_EQ(0x2233, view.ReadShort(1));
+    ASSERT_EQ(0x44556677, view.ReadInt(3));
+    ASSERT_EQ(0x31323334aabbccdd, view.ReadLong(7));
+
+    view.SetReadOffset(3);
+    view.Skip(4);
+    ASSERT_EQ(7, view.ReadOffset());
+    ASSERT_EQ(bytes.size() - 7, view.RestReadableSize());
+  }
+}
+
+TEST_F(BufTest, BufViewOutOfRange) {
+  std::string s = "abc";
+  dingodb::serialV2::BufView view(s);
+
+  ASSERT_THROW(view.ReadInt(), std::out_of_range);
+  ASSERT_THROW(view.Read(3), std::out_of_range);
+  ASSERT_THROW(view.Skip(4), std::runtime_error);
+  ASSERT_THROW(view.SetReadOffset(3), std::runtime_error);
+  // a negative position wraps to one that pos + len overflows.
+  ASSERT_THROW(view.ReadInt(static_cast<size_t>(-2)), std::out_of_range);
+  ASSERT_THROW(view.ReadLong(static_cast<size_t>(-4)), std::out_of_range);
+  ASSERT_THROW(view.ReadShort(static_cast<size_t>(-1)), std::out_of_range);
+
+  view.Skip(3);
+  ASSERT_TRUE(view.IsEnd());
+  ASSERT_THROW(view.Read(), std::out_of_range);
+}
+
+TEST_F(BufTest, BufOverCallerMemory) {
+  for (bool le : {true, false}) {
+    std::string dst(20, '?');
+    dingodb::serialV2::Buf buf(dst.data(), 16, le);
+    buf.WriteInt(0x01020304);
+    buf.Write(5);
+    buf.Enlarge(3);
+    buf.WriteLong(0x0102030405060708LL);
+    ASSERT_EQ(16, buf.Size());
+    EXPECT_EQ(0x01020304, buf.ReadInt(0));
+    EXPECT_EQ(5, buf.Read(4));
+    EXPECT_EQ(0, buf.Read(7));
+    EXPECT_EQ(buf.Data(), dst.data());
+    EXPECT_EQ(0x0102030405060708LL, buf.ReadLong(8));
+    EXPECT_EQ(dst.substr(0, 16), buf.GetString());
+    EXPECT_EQ("????", dst.substr(16));
+
+    // nothing past the capacity.
+    ASSERT_THROW(buf.Write(1), std::out_of_range);
+    ASSERT_THROW(buf.ReSize(17), std::out_of_range);
+    buf.ReSize(4);
+    EXPECT_EQ(4, buf.Size());
+    ASSERT_THROW(buf.ReadInt(4), std::out_of_range);
+  }
+}
+
+TEST_F(BufTest, CopyWords) {
+  // long enough to run both the vector body and the scalar tail.
+  std::vector<uint32_t> ints(37);
+  std::vector<uint64_t> longs(37);
+  for (size_t i = 0; i < ints.size(); ++i) {
+    ints[i] = 0x01020304U * (i + 1) + i;
+    longs[i] = 0x0102030405060708ULL * (i + 3) + i;
+  }
+
+  std::vector<uint32_t> ints_out(ints.size());
+  std::vector<uint64_t> longs_out(longs.size());
+  dingodb::serialV2::CopyWords32(reinterpret_cast<char*>(ints_out.data()),
+                                 reinterpret_cast<const char*>(ints.data()), ints.size(), true);
+  dingodb::serialV2::CopyWords64(reinterpret_cast<char*>(longs_out.data()),
+                                 reinterpret_cast<const char*>(longs.data()), longs.size(), true);
+  for (size_t i = 0; i < ints.size(); ++i) {
+    ASSERT_EQ(__builtin_bswap32(ints[i]), ints_out[i]);
+    ASSERT_EQ(__builtin_bswap64(longs[i]), longs_out[i]);
+  }
+
+  dingodb::serialV2::CopyWords64(reinterpret_cast<char*>(longs_out.data()),
+                                 reinterpret_cast<const char*>(longs.data()), longs.size(), false);
+  ASSERT_EQ(longs, longs_out);
+}
+
+TEST_F(BufTest, PackBools) {
+  for (size_t count : {0, 1, 7, 8, 9, 63, 64, 65, 130}) {
+    std::vector<bool> bools(count);
+    std::vector<uint8_t> bytes(count);
+    for (size_t i = 0; i < count; ++i) {
+      bools[i] = (i * 7 + count) % 3 == 0;
+      bytes[i] = bools[i] ? static_cast<uint8_t>(i + 1) : 0;
+    }
+
+    size_t size = dingodb::serialV2::PackedBitsSize(count);
+    std::vector<uint8_t> bits(size, 0xFF);
+    std::vector<uint8_t> byte_bits(size, 0xFF);
+    dingodb::serialV2::PackBools(bools, bits.data());
+    dingodb::serialV2::PackBools(bytes.data(), count, byte_bits.data());
+    EXPECT_EQ(bits, byte_bits);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(bools[i], static_cast<bool>((bits[i / 8] >> (i % 8)) & 1));
+    }
+    if (count % 8 != 0) {
+      EXPECT_EQ(0, bits.back() >> (count % 8));
+    }
+
+    std::vector<bool> bools_out;
+    std::vector<uint8_t> bytes_out(count);
+    dingodb::serialV2::UnpackBools(bits.data(), count, bools_out);
+    dingodb::serialV2::UnpackBools(bits.data(), count, bytes_out.data());
+    EXPECT_EQ(bools, bools_out);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(bools[i] ? 1 : 0, bytes_out[i]);
+    }
+  }
+}
+
+TEST_F(BufTest, FloatDistance) {
+  using dingodb::serialV2::CopyWords32;
+  using dingodb::serialV2::DistanceMetric;
+
+  for (size_t dim : {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 128}) {
+    std::vector<float> data(dim);
+    std::vector<float> query(dim);
+    for (size_t i = 0; i < dim; ++i) {
+      data[i] = static_cast<float>(i % 7) - 2.5f;
+      query[i] = 0.25f * static_cast<float>(i % 5) + 1.0f;
+    }
+
+    float l2 = 0;
+    float ip = 0;
+    float xx = 0;
+    float qq = 0;
+    for (size_t i = 0; i < dim; ++i) {
+      l2 += (data[i] - query[i]) * (data[i] - query[i]);
+      ip += data[i] * query[i];
+      xx += data[i] * data[i];
+      qq += query[i] * query[i];
+    }
+    float cosine = dim == 0 ? 1.0f : 1.0f - ip / std::sqrt(xx * qq);
+
+    std::string swapped(dim * 4, '\0');
+    CopyWords32(swapped.data(), reinterpret_cast<const char*>(data.data()),
+                dim, true);
+    const char* native = reinterpret_cast<const char*>(data.data());
+
+    float eps = 1e-3f * static_cast<float>(dim + 1);
+    for (bool swap : {false, true}) {
+      const char* encoded = swap ? swapped.data() : native;
+      EXPECT_NEAR(l2, dingodb::serialV2::L2Sqr(encoded, query.data(), dim, swap),
+                  eps);
+      EXPECT_NEAR(ip,
+                  dingodb::serialV2::InnerProduct(encoded, query.data(), dim,
+                                                  swap),
+                  eps);
+      EXPECT_NEAR(cosine,
+                  dingodb::serialV2::Distance(DistanceMetric::kCosine, encoded,
+                                              query.data(), dim, swap),
+                  1e-5f);
+    }
+  }
+}
+
+TEST_F(BufTest, FloatQuantize) {
+  using dingodb::serialV2::Bf16ToFloat;
+  using dingodb::serialV2::FloatQuantization;
+  using dingodb::serialV2::FloatToBf16;
+  using dingodb::serialV2::FloatToHalf;
+  using dingodb::serialV2::HalfToFloat;
+
+  EXPECT_EQ(0x3C00, FloatToHalf(1.0f));
+  EXPECT_EQ(0xC000, FloatToHalf(-2.0f));
+  EXPECT_EQ(0x7BFF, FloatToHalf(65504.0f));
+  EXPECT_EQ(0x7C00, FloatToHalf(65520.0f));
+  EXPECT_EQ(0x0001, FloatToHalf(std::ldexp(1.0f, -24)));
+  EXPECT_EQ(0x0000, FloatToHalf(std::ldexp(1.0f, -26)));
+  EXPECT_EQ(0x3C00, FloatToHalf(1.0f + std::ldexp(1.0f, -11)));  // ties to even
+  EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(std::nanf("")))));
+  EXPECT_EQ(std::ldexp(1.0f, -24), HalfToFloat(0x0001));
+  EXPECT_EQ(65504.0f, HalfToFloat(0x7BFF));
+  EXPECT_EQ(0x3F80, FloatToBf16(1.0f));
+  EXPECT_EQ(-2.0f, Bf16ToFloat(FloatToBf16(-2.0f)));
+  EXPECT_TRUE(std::isnan(Bf16ToFloat(FloatToBf16(std::nanf("")))));
+
+  std::vector<float> data(45);
+  std::vector<float> query(45);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::sin(static_cast<float>(i)) * 3.0f;
+    query[i] = std::cos(static_cast<float>(i));
+  }
+
+  for (auto quantization : {FloatQuantization::kNone, FloatQuantization::kFp16,
+                            FloatQuantization::kBf16, FloatQuantization::kInt8}) {
+    for (bool swap : {false, true}) {
+      std::string bytes(
+          data.size() * dingodb::serialV2::QuantizedWidth(quantization), '\0');
+      float scale = dingodb::serialV2::Quantize(
+          quantization, data.data(), data.size(), bytes.data(), swap);
+      std::vector<float> out(data.size());
+      dingodb::serialV2::Dequantize(quantization, bytes.data(), data.size(),
+                                    scale, out.data(), swap);
+      for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_NEAR(data[i], out[i], 0.02f);
+      }
+
+      // The kernels on the quantized bytes match them on the dequantized
+      // floats.
+      for (auto metric : {dingodb::serialV2::DistanceMetric::kL2,
+                          dingodb::serialV2::DistanceMetric::kInnerProduct,
+                          dingodb::serialV2::DistanceMetric::kCosine}) {
+        float expected = dingodb::serialV2::Distance(
+            metric, reinterpret_cast<const char*>(out.data()), query.data(),
+            out.size(), false);
+        EXPECT_NEAR(expected,
+                    dingodb::serialV2::Distance(metric, quantization,
+                                                bytes.data(), scale,
+                                                query.data(), out.size(), swap),
+                    1e-4f);
+      }
+    }
+  }
+}
+
+TEST_F(BufTest, Compression) {
+  using dingodb::serialV2::CompressionType;
+
+  std::string data;
+  for (int i = 0; i < 1000; ++i) {
+    data += "dingo-" + std::to_string(i % 17);
+  }
+
+  EXPECT_TRUE(dingodb::serialV2::IsCompressionSupported(CompressionType::kZlib));
+  EXPECT_FALSE(dingodb::serialV2::IsCompressionSupported(CompressionType::kNone));
+
+  for (auto type : {CompressionType::kLz4, CompressionType::kZstd,
+                    CompressionType::kZlib}) {
+    if (!dingodb::serialV2::IsCompressionSupported(type)) {
+      continue;
+    }
+
+    std::string compressed(
+        dingodb::serialV2::MaxCompressedSize(type, data.size()), '\0');
+    size_t len = dingodb::serialV2::Compress(type, data.data(), data.size(),
+                                              compressed.data(),
+                                              compressed.size());
+    ASSERT_GT(len, 0);
+    EXPECT_LT(len, data.size());
+
+    std::string out(data.size(), '\0');
+    EXPECT_TRUE(dingodb::serialV2::Decompress(type, compressed.data(), len,
+                                              out.data(), out.size()));
+    EXPECT_EQ(data, out);
+
+    // a wrong raw size or truncated data is rejected.
+    EXPECT_FALSE(dingodb::serialV2::Decompress(type, compressed.data(), len,
+                                               out.data(), out.size() - 1));
+    EXPECT_FALSE(dingodb::serialV2::Decompress(type, compressed.data(), len / 2,
+                                               out.data(), out.size()));
+  }
+}
+
+TEST_F(BufTest, ParallelFor) {
+  using dingodb::serialV2::ParallelFor;
+  using dingodb::serialV2::ParallelOptions;
+
+  std::vector<int> hits(10000, 0);
+  auto mark = [&hits](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ++hits[i];
+    }
+  };
+
+  for (size_t threads : {1, 4, 0}) {
+    ParallelOptions options;
+    options.thread_count = threads;
+    options.chunk_size = 97;
+    std::fill(hits.begin(), hits.end(), 0);
+    ParallelFor(hits.size(), options, mark);
+    EXPECT_EQ(hits.size(), std::count(hits.begin(), hits.end(), 1));
+  }
+
+  // a caller's executor runs the helpers.
+  ParallelOptions options;
+  options.thread_count = 3;
+  options.chunk_size = 100;
+  int submitted = 0;
+  std::vector<std::thread> pool;
+  options.executor = [&](std::function<void()> work) {
+    ++submitted;
+    pool.emplace_back(std::move(work));
+  };
+  std::fill(hits.begin(), hits.end(), 0);
+  ParallelFor(hits.size(), options, mark);
+  for (auto& thread : pool) {
+    thread.join();
+  }
+  EXPECT_EQ(2, submitted);
+  EXPECT_EQ(hits.size(), std::count(hits.begin(), hits.end(), 1));
+
+  options.executor = nullptr;
+  EXPECT_THROW(ParallelFor(hits.size(), options,
+                           [](size_t begin, size_t) {
+                             if (begin >= 5000) {
+                               throw std::runtime_error("task failed");
+                             }
+                           }),
+               std::runtime_error);
+  ParallelFor(0, options, [](size_t, size_t) { FAIL(); });
+}
+
+TEST_F(BufTest, ByteOrder) {
+  using dingodb::serialV2::Buf;
+  using dingodb::serialV2::HostByteOrder;
+  using dingodb::serialV2::SwappedByteOrder;
+
+  for (bool le : {true, false}) {
+    Buf buf(16, le);
+    buf.WriteInt(0x12345678);
+    buf.WriteLong(-0x123456789abcdefL);
+    const char* data = buf.Data();
+    if (le) {
+      EXPECT_EQ(0x12345678, SwappedByteOrder::Load<uint32_t>(data));
+      EXPECT_EQ(-0x123456789abcdefL,
+                SwappedByteOrder::LoadValue<int64_t>(data + 4));
+    } else {
+      EXPECT_EQ(0x12345678, HostByteOrder::Load<uint32_t>(data));
+      EXPECT_EQ(-0x123456789abcdefL,
+                HostByteOrder::LoadValue<int64_t>(data + 4));
+    }
+  }
+
+  char word[8];
+  SwappedByteOrder::StoreValue<double>(word, 1.5);
+  EXPECT_EQ(1.5, SwappedByteOrder::LoadValue<double>(word));
+  EXPECT_EQ(0x3f, static_cast<uint8_t>(word[0]));
+  SwappedByteOrder::StoreValue<bool>(word, true);
+  EXPECT_TRUE(HostByteOrder::LoadValue<bool>(word));
+  EXPECT_EQ(0x80000000u, SwappedByteOrder::FirstBitMask<uint32_t>());
+  EXPECT_EQ(0x80u, HostByteOrder::FirstBitMask<uint32_t>());
+}
+
+TEST_F(BufTest, Hash64) {
+  using dingodb::serialV2::Hash64;
+
+  std::string data;
+  for (int i = 0; i < 200; ++i) {
+    data.push_back(static_cast<char>(i * 7 + 3));
+  }
+
+  // every length takes another path and gives another hash.
+  std::vector<uint64_t> hashes;
+  for (size_t size = 0; size <= data.size(); ++size) {
+    uint64_t hash = Hash64(data.data(), size);
+    EXPECT_EQ(hash, Hash64(std::string(data, 0, size).data(), size));
+    hashes.push_back(hash);
+  }
+  std::sort(hashes.begin(), hashes.end());
+  EXPECT_EQ(hashes.end(), std::adjacent_find(hashes.begin(), hashes.end()));
+
+  // a flipped bit or another seed changes the hash.
+  for (size_t size : {3, 8, 16, 17, 48, 49, 200}) {
+    std::string flipped = data.substr(0, size);
+    flipped[size / 2] ^= 0x10;
+    EXPECT_NE(Hash64(data.data(), size), Hash64(flipped.data(), size));
+    EXPECT_NE(Hash64(data.data(), size), Hash64(data.data(), size, 1));
+  }
+}
+
+TEST_F(BufTest, DistinctSketch) {
+  using dingodb::serialV2::DistinctSketch;
+  using dingodb::serialV2::Hash64;
+
+  DistinctSketch empty;
+  EXPECT_EQ(0, empty.Estimate());
+
+  // within 10% over small and large counts, repeats are not counted.
+  for (uint64_t count : {10, 1000, 100000}) {
+    DistinctSketch sketch;
+    for (int round = 0; round < 2; ++round) {
+      for (uint64_t i = 0; i < count; ++i) {
+        sketch.Add(Hash64(reinterpret_cast<const char*>(&i), 8));
+      }
+    }
+    EXPECT_NEAR(count, sketch.Estimate(), count * 0.1);
+  }
+
+  // the merge of two halves estimates the whole.
+  DistinctSketch low, high, all;
+  for (uint64_t i = 0; i < 20000; ++i) {
+    uint64_t hash = Hash64(reinterpret_cast<const char*>(&i), 8);
+    (i < 10000 ? low : high).Add(hash);
+    all.Add(hash);
+  }
+  low.Merge(high);
+  EXPECT_EQ(all.Estimate(), low.Estimate());
+  low.Merge(empty);
+  EXPECT_EQ(all.Estimate(), low.Estimate());
+
+  low.Clear();
+  EXPECT_EQ(0, low.Estimate());
+}
+
+TEST_F(BufTest, BlockedBloomFilter) {
+  using dingodb::serialV2::BlockedBloomFilter;
+  using dingodb::serialV2::Hash64;
+
+  BlockedBloomFilter filter(10000);
+  EXPECT_EQ(10000 * 10 / 256 + 1, filter.Data().size() / BlockedBloomFilter::kBlockSize);
+  for (uint64_t i = 0; i < 10000; ++i) {
+    filter.Add(Hash64(reinterpret_cast<const char*>(&i), 8));
+  }
+
+  // no false negatives, and about 1% false positives.
+  int positives = 0;
+  for (uint64_t i = 0; i < 20000; ++i) {
+    bool found = filter.MayContain(Hash64(reinterpret_cast<const char*>(&i), 8));
+    if (i < 10000) {
+      EXPECT_TRUE(found);
+    } else {
+      positives += found;
+    }
+  }
+  EXPECT_LT(positives, 10000 * 0.02);
+
+  // the bytes alone probe the same, bytes not in blocks contain nothing.
+  std::string data = filter.Data();
+  uint64_t zero = 0;
+  EXPECT_TRUE(BlockedBloomFilter::MayContain(data, Hash64(reinterpret_cast<const char*>(&zero), 8)));
+  EXPECT_FALSE(BlockedBloomFilter::MayContain(data.substr(1), 0));
+  EXPECT_FALSE(BlockedBloomFilter::MayContain("", 0));
+
+  BlockedBloomFilter empty(0);
+  EXPECT_EQ(BlockedBloomFilter::kBlockSize, empty.Data().size());
+  EXPECT_FALSE(empty.MayContain(12345));
+}
+
+TEST_F(BufTest, CodecStats) {
+  using dingodb::serialV2::CodecStats;
+
+  CodecStats stats;
+  EXPECT_EQ(0, stats.Snapshot().rows_encoded);
+
+  // every thread counts into its own shard, the snapshot sums them.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&stats] {
+      for (int i = 0; i < 1000; ++i) {
+        stats.AddEncode(2, 10);
+        stats.AddDecode(5, 3, 1);
+      }
+      stats.AddV1Fallback();
+      stats.AddDecodeFailure();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = stats.Snapshot();
+  EXPECT_EQ(8000, snapshot.rows_encoded);
+  EXPECT_EQ(40000, snapshot.bytes_encoded);
+  EXPECT_EQ(4000, snapshot.rows_decoded);
+  EXPECT_EQ(20000, snapshot.bytes_decoded);
+  EXPECT_EQ(12000, snapshot.columns_decoded);
+  EXPECT_EQ(4000, snapshot.columns_skipped);
+  EXPECT_EQ(4, snapshot.v1_fallbacks);
+  EXPECT_EQ(4, snapshot.decode_failures);
+
+  // stats of the same thread stay apart.
+  CodecStats other;
+  other.AddEncode(1, 1);
+  stats.AddEncode(1, 1);
+  EXPECT_EQ(1, other.Snapshot().rows_encoded);
+  EXPECT_EQ(8001, stats.Snapshot().rows_encoded);
+
+  stats.Reset();
+  snapshot = stats.Snapshot();
+  EXPECT_EQ(0, snapshot.rows_encoded);
+  EXPECT_EQ(0, snapshot.decode_failures);
+  stats.AddDecodeFailure();
+  EXPECT_EQ(1, stats.Snapshot().decode_failures);
+
+  // the shards of destroyed stats are dropped, stats built where one was
+  // destroyed start from zero.
+  size_t thread_shards = CodecStats::ThreadShardCount();
+  std::optional<CodecStats> reused;
+  for (int i = 0; i < 100; ++i) {
+    reused.emplace();
+    EXPECT_EQ(0, reused->Snapshot().rows_encoded);
+    reused->AddEncode(1, 1);
+    EXPECT_EQ(1, reused->Snapshot().rows_encoded);
+    EXPECT_EQ(thread_shards + 1, CodecStats::ThreadShardCount());
+  }
+  reused.reset();
+  other.AddEncode(1, 1);
+  EXPECT_EQ(2, other.Snapshot().rows_encoded);
+}
+
+TEST_F(BufTest, LatencyHistogram) {
+  using dingodb::serialV2::CycleClock;
+  using dingodb::serialV2::LatencyHistogram;
+
+  // buckets tile the values, each no wider than 1/32 of its low end.
+  for (int i = 1; i < LatencyHistogram::kBucketCount; ++i) {
+    EXPECT_EQ(LatencyHistogram::BucketLow(i - 1) +
+                  LatencyHistogram::BucketWidth(i - 1),
+              LatencyHistogram::BucketLow(i));
+  }
+  for (uint64_t v : {0UL, 31UL, 32UL, 33UL, 1000UL, 123456789UL,
+                     LatencyHistogram::kMaxValue}) {
+    int index = LatencyHistogram::BucketIndex(v);
+    EXPECT_LE(LatencyHistogram::BucketLow(index), v);
+    EXPECT_GT(LatencyHistogram::BucketLow(index) +
+                  LatencyHistogram::BucketWidth(index),
+              v);
+  }
+  EXPECT_EQ(LatencyHistogram::kBucketCount - 1,
+            LatencyHistogram::BucketIndex(LatencyHistogram::kMaxValue));
+
+  LatencyHistogram empty;
+  EXPECT_EQ(0, empty.Percentile(0.5));
+
+  LatencyHistogram histogram;
+  for (uint64_t v = 1; v <= 10000; ++v) {
+    histogram.Record(v * 100);
+  }
+  EXPECT_EQ(10000, histogram.Count());
+  EXPECT_EQ(100, histogram.Min());
+  EXPECT_EQ(1000000, histogram.Max());
+  EXPECT_DOUBLE_EQ(500050, histogram.Mean());
+  EXPECT_NEAR(500000, histogram.Percentile(0.5), 500000 / 64.0);
+  EXPECT_NEAR(990000, histogram.Percentile(0.99), 990000 / 64.0);
+  EXPECT_NEAR(999000, histogram.Percentile(0.999), 999000 / 64.0);
+  EXPECT_EQ(100, histogram.Percentile(0));
+  EXPECT_EQ(1000000, histogram.Percentile(1));
+
+  // a merge counts both, the bucket form keeps the percentiles.
+  LatencyHistogram merged, buckets;
+  merged.Merge(histogram);
+  merged.Merge(histogram);
+  EXPECT_EQ(20000, merged.Count());
+  EXPECT_EQ(histogram.Percentile(0.99), merged.Percentile(0.99));
+  for (int i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+    uint64_t count = 0;
+    for (uint64_t v = 1; v <= 10000; ++v) {
+      count += LatencyHistogram::BucketIndex(v * 100) == i;
+    }
+    buckets.RecordBucket(i, count);
+  }
+  EXPECT_EQ(histogram.Percentile(0.99), buckets.Percentile(0.99));
+  merged.Clear();
+  EXPECT_EQ(0, merged.Count());
+
+  // ticks are nanoseconds within a few percent.
+  uint64_t start = CycleClock::Now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  uint64_t nanos = CycleClock::ToNanos(CycleClock::Now() - start);
+  EXPECT_GE(nanos, 19000000);
+  EXPECT_LT(nanos, 200000000);
+}
+
+TEST_F(BufTest, AllocationCounter) {
+  using dingodb::serialV2::AllocationCountingEnabled;
+  using dingodb::serialV2::AllocationCounts;
+  using dingodb::serialV2::AllocationScope;
+
+  AllocationScope scope;
+  auto* str = new std::string(100, 'x');
+  AllocationCounts counts = scope.Counts();
+  delete str;
+
+  if (AllocationCountingEnabled()) {
+    // the string object and its heap storage.
+    EXPECT_GE(counts.count, 2);
+    EXPECT_GE(counts.bytes, sizeof(std::string) + 100);
+
+    // other threads are not counted.
+    AllocationScope thread_scope;
+    std::thread([] { delete new std::string(100, 'y'); }).join();
+    EXPECT_LE(thread_scope.Counts().bytes, 64);
+  } else {
+    EXPECT_EQ(counts.count, 0);
+    EXPECT_EQ(counts.bytes, 0);
+  }
+}
+
+TEST_F(BufTest, RadixSortKeys) {
+  using dingodb::serialV2::ParallelOptions;
+  using dingodb::serialV2::RadixSortKeys;
+
+  // a shared table prefix, keys that are prefixes of others, zero and 0xFF
+  // bytes and duplicates.
+  std::vector<std::string> strings;
+  uint64_t seed = 42;
+  for (int i = 0; i < 5000; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    std::string key("r\x00\x00\x00\x00\x00\x00\x00\x09", 9);
+    int len = (seed >> 33) % 12;
+    for (int j = 0; j < len; ++j) {
+      uint8_t byte = (seed >> (j * 5 % 56)) & 0x7;
+      key.push_back(byte == 7 ? '\xFF' : static_cast<char>(byte));
+    }
+    strings.push_back(key);
+  }
+  strings.push_back("");
+  strings.push_back(strings[10]);
+
+  std::vector<std::string_view> keys(strings.begin(), strings.end());
+  std::vector<uint32_t> expected(keys.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = i;
+  }
+  std::stable_sort(expected.begin(), expected.end(),
+                   [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+  for (size_t threads : {1, 4}) {
+    ParallelOptions options;
+    options.thread_count = threads;
+    std::vector<uint32_t> order;
+    RadixSortKeys(keys.data(), keys.size(), order, options);
+    EXPECT_EQ(expected, order) << threads;
+  }
+
+  // small inputs are sorted by insertion.
+  std::vector<uint32_t> order;
+  RadixSortKeys(keys.data(), 3, order);
+  std::vector<uint32_t> small{0, 1, 2};
+  std::stable_sort(small.begin(), small.end(),
+                   [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+  EXPECT_EQ(small, order);
+  RadixSortKeys(keys.data(), 0, order);
+  EXPECT_TRUE(order.empty());
+}
@@ -18,7 +18,6 @@
 #include <algorithm>
 #include <any>
 #include <bitset>
-#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -43,12 +42,6 @@ const char kAlphabet[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i',
                           's', 't', 'o', 'v', 'w', 'x', 'y', 'z', '0',
                           '1', '2', '3', '4', '5', '6', '7', '8', '9'};
 
-static int64_t TimestampMs() {
-  return std::chrono::duration_cast<std::chrono::milliseconds>(
-             std::chrono::system_clock::now().time_since_epoch())
-      .count();
-}
-
 // rand string
 static std::string GenRandomString(int len) {
   std::string result;
@@ -315,43 +308,6 @@ std::vector<std::any> GenerateRecordV1(int32_t id) {
 
 class PerformanceTestV2 : public testing::Test {};
 
-TEST_F(PerformanceTestV2, wrapperPerf) {
-  /*
-   * Use the wrapperred decoder and recoder and V2 records.
-   */
-  constexpr int loop_times = 100000;
-  uint64_t start_time = TimestampMs();
-  std::vector<std::vector<std::any>> records;
-  records.reserve(loop_times);
-  for (int32_t i = 0; i < loop_times; ++i) {
-    records.push_back(GenerateRecord(i));
-  }
-
-  std::cout << "Generate record elapsed time: " << TimestampMs() - start_time
-            << "ms" << std::endl;
-  auto schemas = GenerateSchemas();
-
-  start_time = TimestampMs();
-  std::cout << "Start testing..., count: " << loop_times << " ms" << std::endl;
-
-  dingodb::RecordEncoder encoder(1, schemas, 100);
-  dingodb::RecordDecoder decoder(1, schemas, 100);
-
-  for (int i = 0; i < 1; i++) {
-    for (const auto& record : records) {
-      std::string key;
-      std::string value;
-      encoder.Encode('r', record, key, value);
-
-      std::vector<std::any> decode_record;
-      decoder.Decode(std::move(key), std::move(value), decode_record);
-    }
-  }
-
-  std::cout << "Encode/Decode elapsed time: " << TimestampMs() - start_time
-            << "ms" << std::endl;
-}
-
 TEST_F(PerformanceTestV2, wrapperPerf_eq) {
   /*
    * Use the wrapperred decoder and recoder and V2 records.
@@ -716,39 +672,50 @@ TEST_F(PerformanceTestV2, wrapperPerf_v1_schemas_to_v2_schemas) {
   */
 }
 
-TEST_F(PerformanceTestV2, perf) {
+TEST_F(PerformanceTestV2, wrapperPerf_cached_schemas) {
   /*
-   * Use the V2 decoder and recoder directly.
+   * Build the wrappers of a table from one cached conversion.
    */
-  constexpr int loop_times = 100000;
-  uint64_t start_time = TimestampMs();
-  std::vector<std::vector<std::any>> records;
-  records.reserve(loop_times);
-  for (int32_t i = 0; i < loop_times; ++i) {
-    records.push_back(GenerateRecord(i));
-  }
-
-  std::cout << "Generate record elapsed time: " << TimestampMs() - start_time
-            << "ms" << std::endl;
-  auto schemas = GenerateSchemas();
-
-  start_time = TimestampMs();
-  std::cout << "Start testing..., count: " << loop_times << " ms" << std::endl;
-
-  dingodb::serialV2::RecordEncoderV2 encoder(1, schemas, 100);
-  dingodb::serialV2::RecordDecoderV2 decoder(1, schemas, 100);
-
-  for (int i = 0; i < 1; i++) {
-    for (const auto& record : records) {
-      std::string key;
-      std::string value;
-      encoder.Encode('r', record, key, value);
+  std::vector<std::any> record = GenerateRecord(123);
+  auto schemas = GenerateSchemasV1();
 
-      std::vector<std::any> decode_record;
-      decoder.Decode(std::move(key), std::move(value), decode_record);
-    }
+  dingodb::SchemaConversionCache cache;
+  auto dual = cache.Get(100, 1, schemas);
+  EXPECT_EQ(1, cache.Size());
+  EXPECT_EQ(schemas, dual->v1);
+  EXPECT_EQ(schemas->size(), dual->v2.size());
+  // a hit shares the conversion, without looking at the schemas.
+  EXPECT_EQ(dual, cache.Get(100, 1, GenerateSchemas()));
+  EXPECT_EQ(dual, cache.Find(100, 1));
+  EXPECT_EQ(nullptr, cache.Find(100, 2));
+
+  auto dual_v2 = cache.Get(100, 2, GenerateSchemas());
+  EXPECT_NE(dual, dual_v2);
+  EXPECT_EQ(dual_v2->v2.size(), dual_v2->v1->size());
+  EXPECT_EQ(2, cache.Size());
+
+  std::string key, value;
+  for (int i = 0; i < 3; ++i) {
+    dingodb::RecordEncoder encoder(1, dual, 100);
+    dingodb::RecordDecoder decoder(1, dual, 100);
+    encoder.Encode('r', record, key, value);
+
+    std::vector<std::any> decode_record;
+    decoder.Decode(key, value, decode_record);
+    EXPECT_EQ(std::any_cast<int32_t>(record.at(0)),
+              std::any_cast<int32_t>(decode_record.at(0)));
+    EXPECT_EQ(std::any_cast<std::string>(record.at(4)),
+              std::any_cast<std::string>(decode_record.at(4)));
+    EXPECT_EQ(std::any_cast<double>(record.at(10)),
+              std::any_cast<double>(decode_record.at(10)));
   }
-
-  std::cout << "Encode/Decode elapsed time: " << TimestampMs() - start_time
-            << "ms" << std::endl;
+  // the cached schemas are shared, not converted again.
+  EXPECT_EQ(dual, cache.Find(100, 1));
+
+  cache.Get(101, 1, schemas);
+  cache.Remove(100);
+  EXPECT_EQ(1, cache.Size());
+  EXPECT_EQ(nullptr, cache.Find(100, 1));
+  cache.Clear();
+  EXPECT_EQ(0, cache.Size());
 }
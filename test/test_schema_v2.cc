@@ -21,9 +21,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <random>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "serial/record/V2/record_decoder.h"
@@ -1277,6 +1280,38 @@ TEST_F(SchemaTest, stringType) {
   }
 }
 
+TEST_F(SchemaTest, stringSkipKey) {
+  auto schema = std::make_shared<DingoSchema<std::string>>();
+  schema->SetAllowNull(false);
+
+  // exactly two groups, then a trailing pad group.
+  std::any data1 = std::make_any<std::string>("0123456789abcdef");
+  std::any data2 = std::make_any<std::string>("tail");
+
+  Buf buf_key(1024);
+  EXPECT_EQ(27, schema->EncodeKey(data1, buf_key));
+  EXPECT_EQ(9, schema->EncodeKey(data2, buf_key));
+
+  EXPECT_EQ(27, schema->SkipKey(buf_key));
+  EXPECT_EQ(27, buf_key.ReadOffset());
+  EXPECT_EQ("tail", std::any_cast<std::string>(schema->DecodeKey(buf_key)));
+
+  BufView whole(buf_key.GetString());
+  EXPECT_EQ("0123456789abcdef", std::any_cast<std::string>(schema->DecodeKey(whole)));
+
+  // a truncated key can not be skipped nor decoded.
+  std::string bytes = buf_key.GetString().substr(0, 20);
+  BufView view(bytes);
+  EXPECT_THROW(schema->SkipKey(view), std::runtime_error);
+  EXPECT_THROW(schema->DecodeKey(view), std::runtime_error);
+
+  // non zero padding is rejected.
+  std::string bad = buf_key.GetString().substr(27);
+  bad[5] = 'x';
+  BufView bad_view(bad);
+  EXPECT_THROW(schema->DecodeKey(bad_view), std::runtime_error);
+}
+
 TEST_F(SchemaTest, stringListType) {
   {
     /*
@@ -1375,3 +1410,362 @@ TEST_F(SchemaTest, stringListType) {
     }
   }
 }
+
+TEST_F(SchemaTest, varintValue) {
+  DingoSchema<int32_t> int_schema;
+  int_schema.SetIndex(0);
+  int_schema.SetAllowNull(true);
+  int_schema.SetVarint(true);
+  EXPECT_EQ(0, int_schema.GetLengthForValue());
+
+  DingoSchema<int64_t> long_schema;
+  long_schema.SetIndex(1);
+  long_schema.SetAllowNull(true);
+  long_schema.SetVarint(true);
+
+  std::vector<int32_t> ints{0, 1, -1, 63, -64, 64, INT32_MAX, INT32_MIN};
+  std::vector<int64_t> longs{0, 1, -1, 300, -300, INT64_MAX, INT64_MIN};
+
+  Buf buf(64, true);
+  std::vector<int> offsets;
+  for (auto v : ints) {
+    offsets.push_back(buf.Size());
+    int_schema.EncodeValue(v, buf);
+  }
+  for (auto v : longs) {
+    offsets.push_back(buf.Size());
+    long_schema.EncodeValue(v, buf);
+  }
+
+  std::string bytes = buf.GetString();
+  // small numbers take one byte.
+  EXPECT_EQ(1, offsets[1] - offsets[0]);
+  EXPECT_EQ(1, offsets[3] - offsets[2]);
+  EXPECT_EQ(5, offsets[ints.size()] - offsets[ints.size() - 1]);
+
+  BufView view(bytes, true);
+  for (size_t i = 0; i < ints.size(); ++i) {
+    EXPECT_EQ(ints[i], std::any_cast<int32_t>(int_schema.DecodeValue(view, offsets[i])));
+    EXPECT_EQ(ints[i], std::any_cast<int32_t>(int_schema.DecodeValue(view)));
+  }
+  offsets.push_back(bytes.size());
+  for (size_t i = ints.size(); i < offsets.size() - 1; ++i) {
+    EXPECT_EQ(longs[i - ints.size()], std::any_cast<int64_t>(long_schema.DecodeValue(view, offsets[i])));
+    EXPECT_EQ(offsets[i + 1] - offsets[i], long_schema.SkipValue(view));
+  }
+  EXPECT_TRUE(view.IsEnd());
+
+  // truncated.
+  BufView truncated(bytes.data(), offsets[ints.size() - 1] + 2, true);
+  EXPECT_THROW(int_schema.DecodeValue(truncated, offsets[ints.size() - 1]), std::runtime_error);
+}
+
+TEST_F(SchemaTest, packedBoolListType) {
+  auto packed = std::make_shared<DingoSchema<std::vector<bool>>>();
+  packed->SetAllowNull(true);
+  packed->SetPacked(true);
+  auto plain = std::make_shared<DingoSchema<std::vector<bool>>>();
+  plain->SetAllowNull(true);
+
+  std::vector<bool> data(100);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = i % 3 == 0;
+  }
+
+  Buf buf(1024);
+  EXPECT_EQ(4 + 13, packed->EncodeValue(std::make_any<std::vector<bool>>(data), buf));
+  EXPECT_EQ(4 + 100, plain->EncodeValue(std::make_any<std::vector<bool>>(data), buf));
+  EXPECT_EQ(4, packed->EncodeValue(std::make_any<std::vector<bool>>(std::vector<bool>{}), buf));
+  std::string bytes = buf.GetString();
+
+  // both forms decode with either schema.
+  BufView view(bytes);
+  EXPECT_EQ(data, std::any_cast<std::vector<bool>>(plain->DecodeValue(view)));
+  EXPECT_EQ(data, std::any_cast<std::vector<bool>>(packed->DecodeValue(view)));
+  EXPECT_TRUE(std::any_cast<std::vector<bool>>(plain->DecodeValue(view)).empty());
+  EXPECT_TRUE(view.IsEnd());
+
+  EXPECT_EQ(data, std::any_cast<std::vector<bool>>(plain->DecodeValue(view, 0)));
+  EXPECT_EQ(data, std::any_cast<std::vector<bool>>(packed->DecodeValue(view, 17)));
+
+  BufView skip_view(bytes);
+  EXPECT_EQ(17, plain->SkipValue(skip_view));
+  EXPECT_EQ(104, packed->SkipValue(skip_view));
+
+  BufView truncated(bytes.data(), 10);
+  EXPECT_THROW(plain->DecodeValue(truncated, 0), std::runtime_error);
+}
+
+TEST_F(SchemaTest, quantizedFloatListType) {
+  std::vector<float> data(37);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = (static_cast<float>(i) - 18.0f) * 0.75f;
+  }
+
+  auto plain = std::make_shared<DingoSchema<std::vector<float>>>();
+  plain->SetAllowNull(true);
+
+  for (auto quantization : {FloatQuantization::kFp16, FloatQuantization::kBf16,
+                            FloatQuantization::kInt8}) {
+    auto quantized = std::make_shared<DingoSchema<std::vector<float>>>();
+    quantized->SetAllowNull(true);
+    quantized->SetQuantization(quantization);
+
+    Buf buf(1024);
+    int len =
+        quantized->EncodeValue(std::make_any<std::vector<float>>(data), buf);
+    int expected = 4 + 1 + 37 * QuantizedWidth(quantization) +
+                   (quantization == FloatQuantization::kInt8 ? 4 : 0);
+    EXPECT_EQ(expected, len);
+    EXPECT_EQ(4, plain->EncodeValue(
+                     std::make_any<std::vector<float>>(std::vector<float>{}),
+                     buf));
+    std::string bytes = buf.GetString();
+
+    // bf16 keeps 8 bits of mantissa, int8 a step of max / 127.
+    float eps = 0.06f;
+    BufView view(bytes);
+    auto decoded = std::any_cast<std::vector<float>>(plain->DecodeValue(view));
+    ASSERT_EQ(data.size(), decoded.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+      EXPECT_NEAR(data[i], decoded[i], eps);
+    }
+    EXPECT_TRUE(
+        std::any_cast<std::vector<float>>(quantized->DecodeValue(view)).empty());
+    EXPECT_TRUE(view.IsEnd());
+
+    EXPECT_EQ(decoded, std::any_cast<std::vector<float>>(
+                           quantized->DecodeValue(view, 0)));
+
+    BufView skip_view(bytes);
+    EXPECT_EQ(len, plain->SkipValue(skip_view));
+    EXPECT_EQ(4, plain->SkipValue(skip_view));
+
+    BufView truncated(bytes.data(), len - 1);
+    EXPECT_THROW(plain->DecodeValue(truncated, 0), std::runtime_error);
+  }
+}
+
+TEST_F(SchemaTest, dictionaryStringType) {
+  auto dictionary = std::make_shared<StringDictionary>(
+      std::vector<std::string>{"active", "deleted", ""});
+  auto schema = std::make_shared<DingoSchema<std::string>>();
+  schema->SetAllowNull(true);
+  schema->SetDictionary(dictionary);
+
+  Buf buf(64);
+  EXPECT_EQ(4, schema->EncodeValue(std::make_any<std::string>("deleted"), buf));
+  EXPECT_EQ(4, schema->EncodeValue(std::make_any<std::string>(""), buf));
+  EXPECT_EQ(4 + 7, schema->EncodeValue(std::make_any<std::string>("pending"), buf));
+  std::string bytes = buf.GetString();
+
+  BufView view(bytes);
+  EXPECT_EQ("deleted", std::any_cast<std::string>(schema->DecodeValue(view)));
+  EXPECT_EQ("", std::any_cast<std::string>(schema->DecodeValue(view)));
+  EXPECT_EQ("pending", std::any_cast<std::string>(schema->DecodeValue(view)));
+  EXPECT_TRUE(view.IsEnd());
+
+  EXPECT_EQ("pending", std::any_cast<std::string>(schema->DecodeValue(view, 8)));
+  EXPECT_EQ(1, schema->DecodeCode(view, 0));
+  EXPECT_EQ(2, schema->DecodeCode(view, 4));
+  EXPECT_EQ(StringDictionary::kNoCode, schema->DecodeCode(view, 8));
+
+  BufView skip_view(bytes);
+  EXPECT_EQ(4, schema->SkipValue(skip_view));
+  EXPECT_EQ(4, schema->SkipValue(skip_view));
+  EXPECT_EQ(11, schema->SkipValue(skip_view));
+
+  // a code beyond the dictionary.
+  auto small = std::make_shared<DingoSchema<std::string>>();
+  small->SetDictionary(std::make_shared<StringDictionary>(std::vector<std::string>{"active"}));
+  EXPECT_THROW(small->DecodeValue(view, 0), std::runtime_error);
+}
+
+TEST_F(SchemaTest, escapedStringKey) {
+  auto schema = std::make_shared<DingoSchema<std::string>>();
+  schema->SetAllowNull(true);
+  schema->SetEscapedKey(true);
+
+  std::vector<std::string> strings{"", "a", std::string("a\0", 2), std::string("a\0b", 3), "ab",
+                                   std::string(1, '\xff'), std::string("\0\0", 2), "0123456789abcdef"};
+  Buf buf(256);
+  for (const auto& s : strings) {
+    int expected = 1 + s.size() + std::count(s.begin(), s.end(), '\0') + 2;
+    EXPECT_EQ(expected, schema->GetEncodedKeyLength(s));
+    EXPECT_EQ(expected, schema->EncodeKey(s, buf));
+  }
+  EXPECT_EQ(1, schema->EncodeKey(std::any(), buf));
+  std::string bytes = buf.GetString();
+  // 1 byte strings take 4 bytes with the null flag instead of 10.
+  EXPECT_EQ(std::string("\x01" "a\x00\x01", 4), bytes.substr(3, 4));
+
+  BufView view(bytes);
+  for (const auto& s : strings) {
+    EXPECT_EQ(s, std::any_cast<std::string>(schema->DecodeKey(view)));
+  }
+  EXPECT_FALSE(schema->DecodeKey(view).has_value());
+  EXPECT_TRUE(view.IsEnd());
+
+  BufView skip_view(bytes);
+  for (const auto& s : strings) {
+    EXPECT_EQ(static_cast<int>(1 + s.size() + std::count(s.begin(), s.end(), '\0') + 2), schema->SkipKey(skip_view));
+  }
+
+  // the bytes sort as the strings, ascending and descending.
+  auto descending = std::make_shared<DingoSchema<std::string>>();
+  descending->SetEscapedKey(true);
+  descending->SetDescending(true);
+  std::vector<std::string> sorted = strings;
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<std::string> asc_keys, desc_keys;
+  for (const auto& s : sorted) {
+    Buf key(16), desc_key(16);
+    schema->EncodeKey(s, key);
+    descending->EncodeKey(s, desc_key);
+    asc_keys.push_back(key.GetString());
+    desc_keys.push_back(desc_key.GetString());
+    BufView desc_view(desc_keys.back());
+    EXPECT_EQ(s, std::any_cast<std::string>(descending->DecodeKey(desc_view)));
+    EXPECT_TRUE(desc_view.IsEnd());
+  }
+  EXPECT_TRUE(std::is_sorted(asc_keys.begin(), asc_keys.end()));
+  EXPECT_TRUE(std::is_sorted(desc_keys.rbegin(), desc_keys.rend()));
+
+  // unterminated or wrongly escaped bytes are rejected.
+  std::string truncated = bytes.substr(3, 3);
+  BufView truncated_view(truncated);
+  EXPECT_THROW(schema->DecodeKey(truncated_view), std::runtime_error);
+  std::string bad("\x01" "a\x00\x07", 4);
+  BufView bad_view(bad);
+  EXPECT_THROW(schema->SkipKey(bad_view), std::runtime_error);
+}
+
+TEST_F(SchemaTest, comparableFloatKeys) {
+  auto check = [](auto schema, auto values) {
+    using T = typename decltype(values)::value_type;
+    using Word = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    auto bits = [](T value) {
+      Word word;
+      memcpy(&word, &value, sizeof(T));
+      return word;
+    };
+
+    // values is in ascending order, and so are the keys.
+    std::vector<std::string> keys;
+    for (T value : values) {
+      Buf buf(16);
+      schema->EncodeKey(std::any(value), buf);
+      keys.push_back(buf.GetString());
+      BufView view(keys.back());
+      EXPECT_EQ(bits(value), bits(std::any_cast<T>(schema->DecodeKey(view))));
+    }
+    EXPECT_TRUE(std::adjacent_find(keys.begin(), keys.end(), std::greater_equal<std::string>()) == keys.end());
+  };
+
+  check(std::make_shared<DingoSchema<double>>(),
+        std::vector<double>{-std::numeric_limits<double>::infinity(), -1e300, -1.5,
+                            -std::numeric_limits<double>::denorm_min(), 0.0,
+                            std::numeric_limits<double>::denorm_min(), 1.5, 1e300,
+                            std::numeric_limits<double>::infinity()});
+  check(std::make_shared<DingoSchema<float>>(),
+        std::vector<float>{-std::numeric_limits<float>::infinity(), -1e30f, -1.5f,
+                           -std::numeric_limits<float>::denorm_min(), 0.0f,
+                           std::numeric_limits<float>::denorm_min(), 1.5f, 1e30f,
+                           std::numeric_limits<float>::infinity()});
+
+  // the bytes of keys written by the sign branch, -0.0 taken as not negative
+  // and NaN as negative.
+  auto key_of = [](auto schema, auto value) {
+    Buf buf(16);
+    schema->EncodeKey(std::any(value), buf);
+    return buf.GetString();
+  };
+  auto double_schema = std::make_shared<DingoSchema<double>>();
+  EXPECT_EQ(std::string("\x80\x00\x00\x00\x00\x00\x00\x00", 8), key_of(double_schema, 0.0));
+  EXPECT_EQ(std::string(8, '\x00'), key_of(double_schema, -0.0));
+  EXPECT_EQ(std::string("\x80\x07\xFF\xFF\xFF\xFF\xFF\xFF", 8),
+            key_of(double_schema, std::numeric_limits<double>::quiet_NaN()));
+  EXPECT_EQ(std::string("\x00\x07\xFF\xFF\xFF\xFF\xFF\xFF", 8),
+            key_of(double_schema, -std::numeric_limits<double>::quiet_NaN()));
+  auto float_schema = std::make_shared<DingoSchema<float>>();
+  EXPECT_EQ(std::string("\x80\x00\x00\x00", 4), key_of(float_schema, 0.0f));
+  EXPECT_EQ(std::string(4, '\x00'), key_of(float_schema, -0.0f));
+  EXPECT_EQ(std::string("\x80\x3F\xFF\xFF", 4),
+            key_of(float_schema, std::numeric_limits<float>::quiet_NaN()));
+  EXPECT_EQ(std::string("\x00\x3F\xFF\xFF", 4),
+            key_of(float_schema, -std::numeric_limits<float>::quiet_NaN()));
+}
+
+TEST_F(SchemaTest, fixedLengthStringType) {
+  auto schema = std::make_shared<DingoSchema<std::string>>();
+  schema->SetAllowNull(true);
+  schema->SetFixedLength(16);
+  EXPECT_EQ(17, schema->GetLengthForKey());
+  EXPECT_EQ(16, schema->GetLengthForValue());
+  EXPECT_THROW(schema->SetFixedLength(-1), std::runtime_error);
+
+  // the raw bytes, zero bytes and all, in both forms.
+  std::string id("\x00\x01\xFEhash-id-0123\xFF\x00", 16);
+  Buf key(1);
+  Buf value(1);
+  EXPECT_EQ(17, schema->EncodeKey(std::any(id), key));
+  EXPECT_EQ(16, schema->EncodeValue(std::any(id), value));
+  EXPECT_EQ(17, schema->GetEncodedKeyLength(std::any(id)));
+  EXPECT_EQ(16, schema->GetEncodedValueLength(std::any(id)));
+  std::string key_bytes = key.GetString();
+  std::string value_bytes = value.GetString();
+  EXPECT_EQ(id, key_bytes.substr(1));
+  EXPECT_EQ(id, value_bytes);
+  EXPECT_EQ(17, schema->ScanKeyLength(key_bytes.data(), key_bytes.size()));
+  EXPECT_EQ(-1, schema->ScanKeyLength(key_bytes.data(), 16));
+
+  BufView key_view(key_bytes);
+  EXPECT_EQ(id, std::any_cast<std::string>(schema->DecodeKey(key_view)));
+  EXPECT_TRUE(key_view.IsEnd());
+  BufView value_view(value_bytes);
+  EXPECT_EQ(id, std::any_cast<std::string>(schema->DecodeValue(value_view, 0)));
+
+  // a null key keeps the room of the bytes.
+  Buf null_key(1);
+  EXPECT_EQ(17, schema->EncodeKey(std::any(), null_key));
+  std::string null_bytes = null_key.GetString();
+  EXPECT_EQ(17, null_bytes.size());
+  BufView null_view(null_bytes);
+  EXPECT_FALSE(schema->DecodeKey(null_view).has_value());
+  EXPECT_TRUE(null_view.IsEnd());
+
+  // keys sort as the strings do, descending ones the other way.
+  auto descending = std::make_shared<DingoSchema<std::string>>();
+  descending->SetFixedLength(4);
+  descending->SetDescending(true);
+  auto ascending = std::make_shared<DingoSchema<std::string>>();
+  ascending->SetFixedLength(4);
+  std::vector<std::string> values{std::string("\x00\x00\x00\x00", 4),
+                                  std::string("\x00\x00\x00\x01", 4), "abcd",
+                                  "abce", "\xFF\xFF\xFF\xFF"};
+  std::vector<std::string> asc_keys;
+  std::vector<std::string> desc_keys;
+  for (const auto& s : values) {
+    Buf asc(1);
+    Buf desc(1);
+    EXPECT_EQ(4, ascending->EncodeKey(std::any(s), asc));
+    EXPECT_EQ(4, descending->EncodeKey(std::any(s), desc));
+    asc_keys.push_back(asc.GetString());
+    desc_keys.push_back(desc.GetString());
+    BufView desc_view(desc_keys.back());
+    EXPECT_EQ(s, std::any_cast<std::string>(descending->DecodeKey(desc_view)));
+    EXPECT_TRUE(desc_view.IsEnd());
+  }
+  EXPECT_TRUE(std::is_sorted(asc_keys.begin(), asc_keys.end()));
+  EXPECT_TRUE(std::is_sorted(desc_keys.rbegin(), desc_keys.rend()));
+
+  // data of another length is rejected, so are bytes ending early.
+  Buf rejected(1);
+  EXPECT_THROW(schema->EncodeKey(std::any(std::string("short")), rejected),
+               std::runtime_error);
+  EXPECT_THROW(schema->EncodeValue(std::any(std::string(17, 'x')), rejected),
+               std::runtime_error);
+  std::string truncated = key_bytes.substr(0, 10);
+  BufView truncated_view(truncated);
+  EXPECT_THROW(schema->DecodeKey(truncated_view), std::runtime_error);
+}
@@ -24,9 +24,11 @@
 #include <optional>
 #include <string>
 
+#include "serial/record/V2/record_transcoder.h"
 #include "serial/record_decoder.h"
 #include "serial/record_encoder.h"
 #include "serial/schema/base_schema.h"
+#include "serial/utils/V2/schema_converter.h"
 
 using namespace dingodb;
 using namespace std;
@@ -1860,3 +1862,263 @@ TEST_F(DingoSerialTest, wrapperTest) {
   delete rd;
 }
 */
+
+TEST_F(DingoSerialTest, recordDecodeStringViewV1) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV1 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  vector<any>* record1 = GetRecord();
+  std::string key, value;
+  (void)re.Encode('r', *record1, key, value);
+
+  RecordDecoderV1 rd(0, schemas, 0L, this->le);
+  vector<any> record2;
+  ASSERT_EQ(0, rd.Decode(std::string_view(key), std::string_view(value), record2));
+  EXPECT_EQ(*any_cast<optional<shared_ptr<string>>>(record1->at(1)).value(),
+            *any_cast<optional<shared_ptr<string>>>(record2.at(1)).value());
+  EXPECT_EQ(*any_cast<optional<shared_ptr<string>>>(record1->at(4)).value(),
+            *any_cast<optional<shared_ptr<string>>>(record2.at(4)).value());
+  EXPECT_EQ(any_cast<optional<int64_t>>(record1->at(9)).value(),
+            any_cast<optional<int64_t>>(record2.at(9)).value());
+
+  vector<any> record3;
+  ASSERT_EQ(0, rd.DecodeKey(std::string_view(key), record3));
+  EXPECT_EQ(any_cast<optional<int64_t>>(record1->at(3)).value(),
+            any_cast<optional<int64_t>>(record3.at(3)).value());
+
+  // the wrapper reads v1 rows of a v2 key value in place.
+  RecordDecoder wrapper(0, schemas, 0L, this->le);
+  vector<any> record4;
+  ASSERT_EQ(0, wrapper.Decode(dingodb::serialV2::KeyValue(key, value), record4));
+  EXPECT_EQ(*any_cast<optional<shared_ptr<string>>>(record1->at(4)).value(),
+            *any_cast<optional<shared_ptr<string>>>(record4.at(4)).value());
+
+  std::string other_key = key;
+  other_key[1] ^= 0x1;
+  EXPECT_EQ(-1, rd.Decode(std::string_view(other_key), std::string_view(value), record2));
+  EXPECT_THROW(rd.Decode(std::string_view(key), std::string_view(value).substr(0, 6), record2),
+               std::out_of_range);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordTranscodeV1ToV2) {
+  namespace v2 = dingodb::serialV2;
+  auto schemas = std::make_shared<vector<std::shared_ptr<BaseSchema>>>();
+  auto add = [&schemas](std::shared_ptr<BaseSchema> schema, bool key,
+                        bool allow_null) {
+    int index = schemas->size();
+    auto set = [&](auto s) {
+      s->SetIndex(index);
+      s->SetIsKey(key);
+      s->SetAllowNull(allow_null);
+    };
+    switch (schema->GetType()) {
+      case BaseSchema::kBool:
+        set(std::dynamic_pointer_cast<DingoSchema<optional<bool>>>(schema));
+        break;
+      case BaseSchema::kInteger:
+        set(std::dynamic_pointer_cast<DingoSchema<optional<int32_t>>>(schema));
+        break;
+      case BaseSchema::kFloat:
+        set(std::dynamic_pointer_cast<DingoSchema<optional<float>>>(schema));
+        break;
+      case BaseSchema::kLong:
+        set(std::dynamic_pointer_cast<DingoSchema<optional<int64_t>>>(schema));
+        break;
+      case BaseSchema::kDouble:
+        set(std::dynamic_pointer_cast<DingoSchema<optional<double>>>(schema));
+        break;
+      case BaseSchema::kString:
+        set(std::dynamic_pointer_cast<
+            DingoSchema<optional<shared_ptr<string>>>>(schema));
+        break;
+      case BaseSchema::kBoolList:
+        set(std::dynamic_pointer_cast<
+            DingoSchema<optional<shared_ptr<vector<bool>>>>>(schema));
+        break;
+      case BaseSchema::kIntegerList:
+        set(std::dynamic_pointer_cast<
+            DingoSchema<optional<shared_ptr<vector<int32_t>>>>>(schema));
+        break;
+      case BaseSchema::kFloatList:
+        set(std::dynamic_pointer_cast<
+            DingoSchema<optional<shared_ptr<vector<float>>>>>(schema));
+        break;
+      case BaseSchema::kLongList:
+        set(std::dynamic_pointer_cast<
+            DingoSchema<optional<shared_ptr<vector<int64_t>>>>>(schema));
+        break;
+      case BaseSchema::kDoubleList:
+        set(std::dynamic_pointer_cast<
+            DingoSchema<optional<shared_ptr<vector<double>>>>>(schema));
+        break;
+      case BaseSchema::kStringList:
+        set(std::dynamic_pointer_cast<
+            DingoSchema<optional<shared_ptr<vector<string>>>>>(schema));
+        break;
+    }
+    schemas->push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<optional<int32_t>>>(), true, false);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<string>>>>(), true, true);
+  add(std::make_shared<DingoSchema<optional<double>>>(), true, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<string>>>>(), true, false);
+  add(std::make_shared<DingoSchema<optional<bool>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<float>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<int64_t>>>(), false, false);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<string>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<string>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<vector<bool>>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<vector<int32_t>>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<vector<float>>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<vector<int64_t>>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<vector<double>>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<vector<string>>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<shared_ptr<vector<int64_t>>>>>(), false, true);
+  add(std::make_shared<DingoSchema<optional<double>>>(), false, true);
+
+  vector<bool> bools{true, false, true};
+  vector<int32_t> ints{-1, 0, 7};
+  vector<float> floats{1.5f, -2.25f};
+  vector<int64_t> longs{-3L, 1L << 40};
+  vector<double> doubles{0.125, -8.5};
+  vector<string> strings{"a", "", "string list"};
+  vector<any> record1{
+      optional<int32_t>(-42),
+      optional<shared_ptr<string>>(make_shared<string>("key of sixteen b")),
+      optional<double>(-1.75),
+      optional<shared_ptr<string>>(make_shared<string>("k")),
+      optional<bool>(),
+      optional<float>(3.5f),
+      optional<int64_t>(-214748364700L),
+      optional<shared_ptr<string>>(make_shared<string>("value string")),
+      optional<shared_ptr<string>>(),
+      optional<shared_ptr<vector<bool>>>(make_shared<vector<bool>>(bools)),
+      optional<shared_ptr<vector<int32_t>>>(make_shared<vector<int32_t>>(ints)),
+      optional<shared_ptr<vector<float>>>(make_shared<vector<float>>(floats)),
+      optional<shared_ptr<vector<int64_t>>>(make_shared<vector<int64_t>>(longs)),
+      optional<shared_ptr<vector<double>>>(make_shared<vector<double>>(doubles)),
+      optional<shared_ptr<vector<string>>>(make_shared<vector<string>>(strings)),
+      optional<shared_ptr<vector<int64_t>>>(),
+      optional<double>()};
+  vector<any> record2{int32_t(-42), string("key of sixteen b"), -1.75,
+                      string("k"),  any(),  3.5f,
+                      int64_t(-214748364700L), string("value string"), any(),
+                      bools, ints, floats, longs, doubles, strings, any(), any()};
+
+  RecordEncoderV1 re1(1, schemas, 11L, this->le);
+  std::string key1, value1;
+  ASSERT_EQ(0, re1.Encode('r', record1, key1, value1));
+
+  v2::RecordTranscoder transcoder(1, schemas, 11L, this->le);
+  std::string key2, value2;
+  ASSERT_EQ(0, transcoder.Transcode(key1, value1, key2, value2));
+
+  auto schemas_v2 = ConvertSchemasV2(schemas);
+  v2::RecordEncoderV2 re2(1, schemas_v2, 11L, this->le);
+  std::string key3, value3;
+  ASSERT_EQ(0, re2.Encode('r', record2, key3, value3));
+  EXPECT_EQ(key3, key2);
+  EXPECT_EQ(value3, value2);
+
+  v2::RecordDecoderV2 rd2(1, transcoder.GetSchemas(), 11L, this->le);
+  vector<any> record3;
+  ASSERT_EQ(0, rd2.Decode(key2, value2, record3));
+  EXPECT_EQ(-42, any_cast<int32_t>(record3.at(0)));
+  EXPECT_EQ("key of sixteen b", any_cast<string>(record3.at(1)));
+  EXPECT_FALSE(record3.at(4).has_value());
+  EXPECT_EQ(3.5f, any_cast<float>(record3.at(5)));
+  EXPECT_FALSE(record3.at(8).has_value());
+  EXPECT_EQ(strings, any_cast<vector<string>>(record3.at(14)));
+  EXPECT_FALSE(record3.at(16).has_value());
+
+  // keys keep their order.
+  vector<any> record4 = record1;
+  record4.at(0) = optional<int32_t>(-41);
+  std::string key4, value4, key5, value5;
+  ASSERT_EQ(0, re1.Encode('r', record4, key4, value4));
+  ASSERT_EQ(0, transcoder.Transcode(key4, value4, key5, value5));
+  EXPECT_LT(key2, key5);
+
+  std::vector<v2::KeyValue> key_values{v2::KeyValue(key1, value1),
+                                       v2::KeyValue(key4, value4)};
+  std::vector<std::string> keys, values;
+  v2::ParallelOptions options;
+  options.thread_count = 2;
+  options.chunk_size = 1;
+  ASSERT_EQ(0, transcoder.TranscodeBatch(key_values.data(), key_values.size(),
+                                         keys, values, options));
+  EXPECT_EQ(key2, keys[0]);
+  EXPECT_EQ(value5, values[1]);
+
+  EXPECT_EQ(-1, transcoder.TranscodeValue(std::string_view(value1).substr(0, 20),
+                                          value2));
+  v2::RecordTranscoder other_table(1, schemas, 12L, this->le);
+  EXPECT_EQ(-1, other_table.TranscodeKey(key1, key2));
+  v2::RecordTranscoder older(0, schemas, 11L, this->le);
+  EXPECT_EQ(-1, older.TranscodeValue(value1, value2));
+}
+
+TEST_F(DingoSerialTest, wrapperLazyV1) {
+  namespace v2 = dingodb::serialV2;
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  vector<any>* record1 = GetRecord();
+
+  RecordEncoderV1 re1(0, schemas, 0L, this->le);
+  std::string key1, value1;
+  ASSERT_EQ(0, re1.Encode('r', *record1, key1, value1));
+  v2::RecordTranscoder transcoder(0, schemas, 0L, this->le);
+  std::string key2, value2;
+  ASSERT_EQ(0, transcoder.Transcode(key1, value1, key2, value2));
+
+  // the v1 decoder is built at the first v1 row alone.
+  RecordDecoder rd(0, schemas, 0L, this->le);
+  size_t v2_only = rd.MemoryUsage();
+  EXPECT_GT(v2_only, sizeof(RecordDecoder));
+  vector<any> record2;
+  ASSERT_EQ(0, rd.Decode(key2, value2, record2));
+  EXPECT_EQ(v2_only, rd.MemoryUsage());
+  ASSERT_EQ(0, rd.Decode(key1, value1, record2));
+  EXPECT_EQ(v2_only + sizeof(RecordDecoderV1), rd.MemoryUsage());
+  EXPECT_EQ(*any_cast<optional<shared_ptr<string>>>(record1->at(4)).value(),
+            *any_cast<optional<shared_ptr<string>>>(record2.at(4)).value());
+
+  // wrappers over one shared v2 decoder, the v1 schemas converted from its.
+  auto shared = std::make_shared<v2::RecordDecoderV2>(
+      0, dingodb::ConvertSchemasV2(schemas), 0L, this->le);
+  RecordDecoder region1(shared);
+  RecordDecoder region2(shared);
+  EXPECT_EQ(sizeof(RecordDecoder) + shared->MemoryUsage(),
+            region1.MemoryUsage());
+  for (auto* wrapper : {&region1, &region2}) {
+    vector<any> record3;
+    ASSERT_EQ(0, wrapper->Decode(key2, value2, record3));
+    EXPECT_EQ(any_cast<optional<int64_t>>(record1->at(9)).value(),
+              any_cast<int64_t>(record3.at(9)));
+    vector<any> record4;
+    ASSERT_EQ(0, wrapper->Decode(key1, value1, record4));
+    EXPECT_EQ(*any_cast<optional<shared_ptr<string>>>(record1->at(1)).value(),
+              *any_cast<optional<shared_ptr<string>>>(record4.at(1)).value());
+  }
+
+  // the v1 encoder of a wrapper of v2 schemas, built when switched to.
+  RecordEncoder v2_schemas_re(0, dingodb::ConvertSchemasV2(schemas), 0L,
+                              this->le);
+  size_t encoder_v2_only = v2_schemas_re.MemoryUsage();
+  v2_schemas_re.SetCodecVersion(v2::CODEC_VERSION_V1);
+  std::string key3, value3;
+  ASSERT_EQ(0, v2_schemas_re.Encode('r', *record1, key3, value3));
+  EXPECT_EQ(encoder_v2_only + sizeof(RecordEncoderV1),
+            v2_schemas_re.MemoryUsage());
+  EXPECT_EQ(key1, key3);
+  EXPECT_EQ(value1, value3);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <any>
 #include <bitset>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
@@ -30,6 +31,7 @@
 #include "serial/record/V2/record_decoder.h"
 #include "serial/record/V2/record_encoder.h"
 #include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/series_codec.h"
 #include "serial/utils/V2/utils.h"
 
 using namespace dingodb::serialV2;
@@ -1832,3 +1834,564 @@ TEST_F(DingoSerialListTypeTest, recordTest) {
 
   DeleteRecords();
 }
+
+TEST_F(DingoSerialListTypeTest, recordDecodeListView) {
+  InitVector();
+  const auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record = GetRecord();
+  record[17] = std::any();
+
+  std::string key, value;
+  re.Encode('r', record, key, value);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+
+  EncodedListView<float> floats;
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 17, floats));
+  EXPECT_TRUE(floats.IsNull());
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 18, floats));
+  const auto& float2 = std::any_cast<const std::vector<float>&>(record[18]);
+  ASSERT_EQ(float2.size(), floats.Size());
+  for (size_t i = 0; i < float2.size(); ++i) {
+    EXPECT_EQ(float2[i], floats[i]);
+  }
+  EXPECT_EQ(float2, floats.ToVector());
+  EXPECT_THROW(floats.At(float2.size()), std::out_of_range);
+
+  EncodedListView<double> doubles;
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 15, doubles));
+  EXPECT_FALSE(doubles.IsNull());
+  EXPECT_TRUE(doubles.Empty());
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 16, doubles));
+  std::vector<double> double2;
+  for (double d : doubles) {
+    double2.push_back(d);
+  }
+  EXPECT_EQ(std::any_cast<const std::vector<double>&>(record[16]), double2);
+
+  EncodedListView<int32_t> ints;
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 20, ints));
+  EXPECT_EQ(std::any_cast<const std::vector<int32_t>&>(record[20]),
+            ints.ToVector());
+
+  EncodedListView<int64_t> longs;
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 22, longs));
+  EXPECT_EQ(std::any_cast<const std::vector<int64_t>&>(record[22]),
+            longs.ToVector());
+
+  EncodedStringListView strings;
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 23, strings));
+  const auto& string3 =
+      std::any_cast<const std::vector<std::string>&>(record[23]);
+  ASSERT_EQ(string3.size(), strings.Size());
+  size_t i = 0;
+  for (std::string_view s : strings) {
+    EXPECT_EQ(string3[i++], s);
+  }
+  EXPECT_EQ(string3[1], strings.At(1));
+
+  // Type mismatch and out of range columns are rejected.
+  EXPECT_EQ(-1, rd.DecodeListView(key, value, 20, floats));
+  EXPECT_EQ(-1, rd.DecodeListView(key, value, 10, doubles));
+  EXPECT_EQ(-1, rd.DecodeListView(key, value, 25, ints));
+}
+
+TEST_F(DingoSerialListTypeTest, recordDistance) {
+  InitVector();
+  const auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record = GetRecord();
+  std::vector<float> query = {1.0f, -2.0f, 0.5f, 3.0f};
+
+  std::vector<KeyValue> rows;
+  std::vector<std::vector<float>> vectors = {
+      {1.0f, -2.0f, 0.5f, 3.0f}, {0, 0, 0, 0}, {2.5f, 1.0f, -4.0f, 0.125f}};
+  for (const auto& vector : vectors) {
+    record[18] = std::any(vector);
+    std::string key, value;
+    re.Encode('r', record, key, value);
+    rows.emplace_back(key, value);
+  }
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<float> distances(rows.size());
+  ASSERT_EQ(0, rd.DistanceBatch(rows.data(), rows.size(), 18,
+                                DistanceMetric::kL2, query.data(),
+                                query.size(), distances.data()));
+  for (size_t i = 0; i < rows.size(); ++i) {
+    float l2 = 0;
+    for (size_t j = 0; j < query.size(); ++j) {
+      l2 += (vectors[i][j] - query[j]) * (vectors[i][j] - query[j]);
+    }
+    EXPECT_FLOAT_EQ(l2, distances[i]);
+  }
+
+  float distance = 0;
+  ASSERT_EQ(0, rd.Distance(rows[0].GetKey(), rows[0].GetValue(), 18,
+                           DistanceMetric::kInnerProduct, query.data(),
+                           query.size(), distance));
+  EXPECT_FLOAT_EQ(1.0f + 4.0f + 0.25f + 9.0f, distance);
+  ASSERT_EQ(0, rd.Distance(rows[0].GetKey(), rows[0].GetValue(), 18,
+                           DistanceMetric::kCosine, query.data(), query.size(),
+                           distance));
+  EXPECT_NEAR(0.0f, distance, 1e-6f);
+
+  // The empty float list of column 17 has the wrong size, column 20 is no
+  // float list.
+  EXPECT_EQ(-1, rd.Distance(rows[0].GetKey(), rows[0].GetValue(), 17,
+                            DistanceMetric::kL2, query.data(), query.size(),
+                            distance));
+  EXPECT_EQ(-1, rd.Distance(rows[0].GetKey(), rows[0].GetValue(), 20,
+                            DistanceMetric::kL2, query.data(), query.size(),
+                            distance));
+
+  record[17] = std::any();
+  std::string key, value;
+  re.Encode('r', record, key, value);
+  ASSERT_EQ(0, rd.Distance(key, value, 17, DistanceMetric::kL2, query.data(),
+                           query.size(), distance));
+  EXPECT_TRUE(std::isnan(distance));
+}
+
+TEST_F(DingoSerialListTypeTest, recordQuantizedFloatList) {
+  InitVector();
+  auto schemas = GetSchemas();
+  auto quantized = std::dynamic_pointer_cast<DingoSchema<std::vector<float>>>(
+      schemas[18]->Clone());
+  quantized->SetIndex(18);
+  quantized->SetAllowNull(false);
+  quantized->SetIsKey(false);
+  quantized->SetQuantization(FloatQuantization::kFp16);
+  schemas[18] = quantized;
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+  auto record = GetRecord();
+  std::vector<float> vector = {0.5f, -1.25f, 3.0f, 2048.0f, 0.1f};
+  record[18] = std::any(vector);
+
+  std::string key, value;
+  re.Encode('r', record, key, value);
+  EXPECT_TRUE(GetValueFormat(BufView(value, this->le).ReadInt(0)) &
+              VALUE_FORMAT_QUANTIZED_FLOATS);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(key, value, decoded));
+  const auto& floats = std::any_cast<const std::vector<float>&>(decoded[18]);
+  ASSERT_EQ(vector.size(), floats.size());
+  for (size_t i = 0; i < vector.size(); ++i) {
+    EXPECT_NEAR(vector[i], floats[i], 1e-3f * std::fabs(vector[i]));
+  }
+  EXPECT_EQ(std::any_cast<const std::vector<int32_t>&>(record[20]),
+            std::any_cast<const std::vector<int32_t>&>(decoded[20]));
+
+  std::vector<float> query = {1.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+  float distance = 0;
+  ASSERT_EQ(0, rd.Distance(key, value, 18, DistanceMetric::kInnerProduct,
+                           query.data(), query.size(), distance));
+  EXPECT_NEAR(0.5f - 1.25f + 3.0f + 0.1f, distance, 1e-3f);
+
+  EncodedListView<float> view;
+  EXPECT_EQ(-1, rd.DecodeListView(key, value, 18, view));
+}
+
+TEST_F(DingoSerialListTypeTest, recordCompressedValue) {
+  InitVector();
+  const auto schemas = GetSchemas();
+  InitRecord();
+  auto record = GetRecord();
+  record[18] = std::any(std::vector<float>(200, 1.5f));
+
+  RecordEncoderV2 plain_re(0, schemas, 0L, this->le);
+  std::string key, plain_value;
+  plain_re.Encode('r', record, key, plain_value);
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  EXPECT_THROW(re.SetCompression(static_cast<CompressionType>(0x7F)),
+               std::runtime_error);
+  re.SetCompression(CompressionType::kZlib, 256);
+  std::string value;
+  re.EncodeValue(record, value);
+  EXPECT_LT(value.size(), plain_value.size());
+  EXPECT_TRUE(GetValueFormat(BufView(value, this->le).ReadInt(0)) &
+              VALUE_FORMAT_COMPRESSED);
+  // the version stays positive, decoders without compression, checking
+  // version <= schema_version_ alone, see a newer version and reject it.
+  int32_t compressed_version = BufView(value, this->le).ReadInt(0);
+  EXPECT_GT(compressed_version, 0);
+  EXPECT_FALSE(compressed_version <= 0);
+  EXPECT_FALSE(compressed_version <= kSchemaVersionMask);
+  EXPECT_EQ(0, compressed_version & kSchemaVersionMask);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> expected, decoded;
+  ASSERT_EQ(0, rd.Decode(key, plain_value, expected));
+  ASSERT_EQ(0, rd.Decode(key, value, decoded));
+  EXPECT_EQ(std::any_cast<const std::vector<float>&>(expected[18]),
+            std::any_cast<const std::vector<float>&>(decoded[18]));
+  EXPECT_EQ(std::any_cast<const std::vector<std::string>&>(expected[24]),
+            std::any_cast<const std::vector<std::string>&>(decoded[24]));
+  EXPECT_EQ(std::any_cast<double>(expected[10]),
+            std::any_cast<double>(decoded[10]));
+
+  LazyRecordV2 lazy;
+  ASSERT_EQ(0, rd.DecodeLazy(key, value, lazy));
+  // another decode on the thread leaves the lazy record alone.
+  ASSERT_EQ(0, rd.Decode(key, value, decoded));
+  EXPECT_EQ(std::any_cast<const std::vector<int64_t>&>(expected[22]),
+            lazy.Get<std::vector<int64_t>>(22));
+
+  bool matched = false;
+  ASSERT_EQ(0, rd.Evaluate(key, value,
+                           EncodedPredicate::Equal(10, expected[10]), matched));
+  EXPECT_TRUE(matched);
+
+  EncodedListView<float> view;
+  ASSERT_EQ(0, rd.DecodeListView(key, value, 18, view));
+  EXPECT_EQ(200, view.Size());
+  EXPECT_EQ(1.5f, view[199]);
+
+  std::vector<KeyValue> rows = {KeyValue(key, value),
+                                KeyValue(key, plain_value)};
+  auto plan = rd.NewDecodePlan({{17, 0}});
+  ColumnBatch batch;
+  ASSERT_EQ(0, rd.DecodeBatch(rows, plan, batch));
+  EXPECT_EQ(2, batch.NumRows());
+
+  // small values stay raw.
+  record[18] = std::any(std::vector<float>{1.0f});
+  record[23] = std::any(std::vector<std::string>{});
+  record[24] = std::any(std::vector<std::string>{});
+  record[4] = std::any(std::string("a"));
+  re.SetCompression(CompressionType::kZlib, 4096);
+  re.EncodeValue(record, value);
+  EXPECT_FALSE(GetValueFormat(BufView(value, this->le).ReadInt(0)) &
+               VALUE_FORMAT_COMPRESSED);
+  ASSERT_EQ(0, rd.Decode(key, value, decoded));
+  EXPECT_EQ(std::vector<float>{1.0f},
+            std::any_cast<const std::vector<float>&>(decoded[18]));
+
+  // a corrupt compressed value throws.
+  re.SetCompression(CompressionType::kZlib, 0);
+  re.EncodeValue(record, value);
+  ASSERT_TRUE(GetValueFormat(BufView(value, this->le).ReadInt(0)) &
+              VALUE_FORMAT_COMPRESSED);
+  value.resize(value.size() - 2);
+  EXPECT_THROW(rd.Decode(key, value, decoded), std::runtime_error);
+}
+
+TEST_F(DingoSerialListTypeTest, recordValueSlices) {
+  InitVector();
+  const auto schemas = GetSchemas();
+  InitRecord();
+  auto record = GetRecord();
+  // the large elements of a string list are referenced one by one.
+  record[24] = std::any(std::vector<std::string>{
+      "a", std::string(5000, 'y'), "b", std::string(6000, 'z')});
+  record[4] = std::any(std::string(8000, 'x'));
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  std::string key, value;
+  re.Encode('r', record, key, value);
+
+  ValueSlices slices;
+  ASSERT_EQ(value.size(), re.EncodeValue(record, slices));
+  EXPECT_EQ(19000, slices.ExternalSize());
+  const auto& list = std::any_cast<const std::vector<std::string>&>(record[24]);
+  const auto& str = std::any_cast<const std::string&>(record[4]);
+  int referenced = 0;
+  for (const auto& slice : slices.Slices()) {
+    referenced += slice.data() == list[1].data() ||
+                  slice.data() == list[3].data() || slice.data() == str.data();
+  }
+  EXPECT_EQ(3, referenced);
+
+  std::string flat;
+  slices.Flatten(flat);
+  EXPECT_EQ(value, flat);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(key, flat, decoded));
+  EXPECT_EQ(list, std::any_cast<const std::vector<std::string>&>(decoded[24]));
+  EXPECT_EQ(str, std::any_cast<const std::string&>(decoded[4]));
+}
+
+TEST_F(DingoSerialListTypeTest, recordSeriesLists) {
+  InitVector();
+  auto schemas = GetSchemas();
+  auto doubles = std::make_shared<DingoSchema<std::vector<double>>>();
+  doubles->SetXorEncoded(true);
+  auto ints = std::make_shared<DingoSchema<std::vector<int32_t>>>();
+  ints->SetDeltaEncoded(true);
+  auto longs = std::make_shared<DingoSchema<std::vector<int64_t>>>();
+  longs->SetDeltaEncoded(true);
+  for (auto [index, schema] : std::vector<std::pair<int, BaseSchemaPtr>>{
+           {16, doubles}, {20, ints}, {22, longs}}) {
+    schema->SetIndex(index);
+    schema->SetAllowNull(false);
+    schema->SetIsKey(false);
+    schema->SetIsLe(this->le);
+    schemas[index] = schema;
+  }
+
+  // timestamps a second apart with some jitter, readings drifting slowly and
+  // ints wrapping around.
+  std::vector<int64_t> timestamps;
+  std::vector<double> readings;
+  std::vector<int32_t> counters;
+  for (int i = 0; i < 200; ++i) {
+    timestamps.push_back(1700000000000L + i * 1000 + (i * 7) % 13);
+    readings.push_back(20.0 + (i / 10) * 0.25);
+    counters.push_back(static_cast<int32_t>(2147483000u + i * 37u));
+  }
+
+  InitRecord();
+  auto record = GetRecord();
+  record[16] = std::any(readings);
+  record[20] = std::any(counters);
+  record[22] = std::any(timestamps);
+  RecordEncoderV2 plain_re(0, GetSchemas(), 0L, this->le);
+  std::string plain_key, plain_value;
+  plain_re.Encode('r', record, plain_key, plain_value);
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  std::string key, value;
+  re.Encode('r', record, key, value);
+  EXPECT_TRUE(GetValueFormat(BufView(value, this->le).ReadInt(0)) &
+              VALUE_FORMAT_SERIES_LISTS);
+  EXPECT_FALSE(GetValueFormat(BufView(plain_value, this->le).ReadInt(0)) &
+               VALUE_FORMAT_SERIES_LISTS);
+  EXPECT_LT(value.size() * 4, plain_value.size());
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(key, value, decoded));
+  EXPECT_EQ(readings, std::any_cast<const std::vector<double>&>(decoded[16]));
+  EXPECT_EQ(counters, std::any_cast<const std::vector<int32_t>&>(decoded[20]));
+  EXPECT_EQ(timestamps,
+            std::any_cast<const std::vector<int64_t>&>(decoded[22]));
+  EXPECT_EQ(std::any_cast<const std::vector<std::string>&>(record[24]),
+            std::any_cast<const std::vector<std::string>&>(decoded[24]));
+
+  EncodedListView<int64_t> view;
+  EXPECT_EQ(-1, rd.DecodeListView(key, value, 22, view));
+
+  // the schemas alone: lengths, skips and lists not worth encoding.
+  std::vector<int64_t> random = {5, -(int64_t{1} << 62), int64_t{1} << 61, 0, -7};
+  std::vector<double> noisy = {1.5, -3.25e10, 7e-300, 0.0, -0.0};
+  for (const std::any& data :
+       {std::any(timestamps), std::any(random), std::any(std::vector<int64_t>{}),
+        std::any(std::vector<int64_t>{42})}) {
+    Buf buf(16, this->le);
+    int len = longs->EncodeValue(data, buf);
+    EXPECT_EQ(len, buf.Size());
+    EXPECT_EQ(len, longs->GetEncodedValueLength(data));
+    const auto& list = std::any_cast<const std::vector<int64_t>&>(data);
+    if (list.size() < 100) {
+      EXPECT_EQ(4 + list.size() * 8, len);
+    }
+    buf.Write(0x5A);
+    BufView view_buf(buf.Data(), buf.Size(), this->le);
+    EXPECT_EQ(len, longs->SkipValue(view_buf));
+    EXPECT_EQ(0x5A, view_buf.Read());
+    EXPECT_EQ(list, std::any_cast<std::vector<int64_t>>(
+                        longs->DecodeValue(view_buf, 0)));
+  }
+  for (const std::any& data : {std::any(readings), std::any(noisy)}) {
+    Buf buf(16, this->le);
+    int len = doubles->EncodeValue(data, buf);
+    EXPECT_EQ(len, doubles->GetEncodedValueLength(data));
+    BufView view_buf(buf.Data(), buf.Size(), this->le);
+    EXPECT_EQ(len, doubles->SkipValue(view_buf));
+    auto decoded_list =
+        std::any_cast<std::vector<double>>(doubles->DecodeValue(view_buf, 0));
+    const auto& list = std::any_cast<const std::vector<double>&>(data);
+    ASSERT_EQ(list.size(), decoded_list.size());
+    EXPECT_EQ(0, memcmp(list.data(), decoded_list.data(), list.size() * 8));
+  }
+
+  // full width deltas, which the schema writes plain.
+  DeltaFrame frame = PlanDeltas(random.data(), random.size());
+  EXPECT_EQ(64, frame.width);
+  std::vector<uint8_t> packed(PackedDeltasSize(random.size(), frame.width));
+  PackDeltas(random.data(), random.size(), frame, packed.data());
+  std::vector<int64_t> unpacked(random.size());
+  unpacked[0] = random[0];
+  UnpackDeltas(packed.data(), random.size(), frame, unpacked.data());
+  EXPECT_EQ(random, unpacked);
+
+  // a cut value is rejected.
+  Buf buf(16, this->le);
+  int len = doubles->EncodeValue(std::any(readings), buf);
+  BufView cut(buf.Data(), len - 1, this->le);
+  EXPECT_THROW(doubles->DecodeValue(cut, 0), std::runtime_error);
+}
+
+TEST_F(DingoSerialListTypeTest, recordListRange) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](auto schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(true);
+    schema->SetIsLe(this->le);
+    schemas.push_back(schema);
+    return schema;
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false)
+      ->SetDeltaEncoded(true);
+  add(std::make_shared<DingoSchema<std::vector<double>>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<float>>>(), false)
+      ->SetQuantization(FloatQuantization::kBf16);
+  add(std::make_shared<DingoSchema<std::vector<bool>>>(), false)
+      ->SetPacked(true);
+  add(std::make_shared<DingoSchema<std::vector<bool>>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<int32_t>>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<std::string>>>(), false);
+
+  std::vector<int64_t> longs;
+  std::vector<double> doubles;
+  std::vector<float> floats;
+  std::vector<bool> bools;
+  for (int i = 0; i < 100; ++i) {
+    longs.push_back(1700000000000L + i * 1000);
+    doubles.push_back(i * 0.5);
+    floats.push_back(static_cast<float>(i));
+    bools.push_back(i % 3 == 0);
+  }
+  std::vector<std::any> record{int64_t(1), longs, longs, doubles, floats,
+                               bools, bools, std::any(),
+                               std::vector<std::string>{"a", "b"}};
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  std::string key, value;
+  ASSERT_EQ(0, re.Encode('r', record, key, value));
+
+  auto slice = [](const auto& data, size_t begin, size_t end) {
+    return std::decay_t<decltype(data)>(data.begin() + begin,
+                                        data.begin() + end);
+  };
+  std::vector<int64_t> long_range;
+  for (int column : {1, 2}) {
+    ASSERT_EQ(0, rd.DecodeListRange(key, value, column, 10, 20, long_range));
+    EXPECT_EQ(slice(longs, 10, 20), long_range);
+    // the last n, end clamped to the size.
+    ASSERT_EQ(0, rd.DecodeListRange(key, value, column, 95, 1000, long_range));
+    EXPECT_EQ(slice(longs, 95, 100), long_range);
+    ASSERT_EQ(0, rd.DecodeListRange(key, value, column, 200, 300, long_range));
+    EXPECT_TRUE(long_range.empty());
+  }
+
+  std::vector<double> double_range;
+  ASSERT_EQ(0, rd.DecodeListRange(key, value, 3, 42, 43, double_range));
+  EXPECT_EQ(std::vector<double>{21.0}, double_range);
+  std::vector<float> float_range;
+  ASSERT_EQ(0, rd.DecodeListRange(key, value, 4, 3, 7, float_range));
+  EXPECT_EQ(slice(floats, 3, 7), float_range);
+  std::vector<bool> bool_range;
+  for (int column : {5, 6}) {
+    ASSERT_EQ(0, rd.DecodeListRange(key, value, column, 7, 30, bool_range));
+    EXPECT_EQ(slice(bools, 7, 30), bool_range);
+  }
+
+  int length = 0;
+  for (int column : {1, 2, 3, 4, 5, 6}) {
+    ASSERT_EQ(0, rd.ListLength(key, value, column, length));
+    EXPECT_EQ(100, length);
+  }
+  ASSERT_EQ(0, rd.ListLength(key, value, 8, length));
+  EXPECT_EQ(2, length);
+
+  // null has no elements and no length.
+  std::vector<int32_t> int_range{1};
+  ASSERT_EQ(0, rd.DecodeListRange(key, value, 7, 0, 10, int_range));
+  EXPECT_TRUE(int_range.empty());
+  ASSERT_EQ(0, rd.ListLength(key, value, 7, length));
+  EXPECT_EQ(-1, length);
+
+  EXPECT_EQ(-1, rd.DecodeListRange(key, value, 3, 0, 1, long_range));
+  EXPECT_EQ(-1, rd.DecodeListRange(key, value, 0, 0, 1, long_range));
+  EXPECT_EQ(-1, rd.ListLength(key, value, 0, length));
+}
+
+TEST_F(DingoSerialListTypeTest, recordDecodeEmbeddings) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](auto schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(true);
+    schema->SetIsLe(this->le);
+    schemas.push_back(schema);
+    return schema;
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::vector<float>>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<float>>>(), false)
+      ->SetQuantization(FloatQuantization::kBf16);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+
+  constexpr size_t kDim = 6;
+  constexpr size_t kStride = 8;
+  constexpr size_t kRows = 50;
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  std::vector<KeyValue> rows;
+  std::vector<std::vector<float>> vectors;
+  for (size_t i = 0; i < kRows; ++i) {
+    std::vector<float> vector;
+    for (size_t j = 0; j < kDim; ++j) {
+      vector.push_back(static_cast<float>(i) - j * 0.5f);
+    }
+    vectors.push_back(vector);
+    // every 7th row is null.
+    std::any embedding = i % 7 == 3 ? std::any() : std::any(vector);
+    std::vector<std::any> record{int64_t(i), embedding, embedding,
+                                 std::string("x")};
+    std::string key, value;
+    ASSERT_EQ(0, re.Encode('r', record, key, value));
+    rows.emplace_back(key, value);
+  }
+
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  for (int column : {1, 2}) {
+    for (size_t threads : {1, 4}) {
+      ParallelOptions options;
+      options.thread_count = threads;
+      options.chunk_size = 8;
+      std::vector<float> matrix(kRows * kStride, -1.0f);
+      std::vector<uint8_t> nulls(kRows, 2);
+      ASSERT_EQ(0, rd.DecodeEmbeddings(rows.data(), kRows, column, kDim,
+                                       matrix.data(), kStride, nulls.data(),
+                                       options));
+      for (size_t i = 0; i < kRows; ++i) {
+        bool null = i % 7 == 3;
+        EXPECT_EQ(null ? 1 : 0, nulls[i]);
+        for (size_t j = 0; j < kDim; ++j) {
+          // small integers and halves are exact in bf16.
+          EXPECT_EQ(null ? 0.0f : vectors[i][j], matrix[i * kStride + j]);
+        }
+        // the padding is left alone.
+        EXPECT_EQ(-1.0f, matrix[i * kStride + kDim]);
+      }
+    }
+  }
+
+  std::vector<float> matrix(kRows * kDim);
+  EXPECT_EQ(0, rd.DecodeEmbeddings(rows.data(), kRows, 1, kDim, matrix.data(),
+                                   kDim));
+  // not a float list, a stride below dim.
+  EXPECT_EQ(-1, rd.DecodeEmbeddings(rows.data(), kRows, 3, kDim, matrix.data(),
+                                    kDim));
+  EXPECT_EQ(-1, rd.DecodeEmbeddings(rows.data(), kRows, 1, kDim, matrix.data(),
+                                    kDim - 1));
+  // a dimension mismatch fails the rows and zero fills them.
+  std::vector<float> small(kRows * 4, -1.0f);
+  EXPECT_EQ(-1, rd.DecodeEmbeddings(rows.data(), kRows, 1, 4, small.data(), 4));
+  EXPECT_EQ(0.0f, small[0]);
+}
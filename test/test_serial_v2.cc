@@ -14,21 +14,52 @@
 
 #include <byteswap.h>
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <any>
+#include <atomic>
 #include <bitset>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 
+#include "serial/record/V2/batch_wire.h"
+#include "serial/record/V2/chunked_decoder.h"
+#include "serial/record/V2/column_descriptor.h"
+#include "serial/record/V2/decode_cache.h"
+#include "serial/record/V2/delta_record.h"
+#include "serial/record/V2/decoder_registry.h"
+#include "serial/record/V2/encode_stats.h"
+#include "serial/record/V2/encoding_advisor.h"
+#include "serial/record/V2/index_key_builder.h"
+#include "serial/record/V2/key_comparator.h"
+#include "serial/record/V2/key_block.h"
+#include "serial/record/V2/key_hasher.h"
+#include "serial/record/V2/key_prefix_filter.h"
+#include "serial/record/V2/record_block.h"
 #include "serial/record/V2/record_decoder.h"
 #include "serial/record/V2/record_encoder.h"
+#include "serial/record/V2/row_corpus.h"
+#include "serial/record/V2/row_exporter.h"
+#include "serial/record/V2/row_file.h"
+#include "serial/record/V2/row_peek.h"
+#include "serial/record/V2/scan_decoder.h"
+#include "serial/record/V2/static_record_codec.h"
+#include "serial/record/V2/storage_analyzer.h"
+#include "serial/record/V2/value_diff.h"
+#include "serial/record/V2/value_rewriter.h"
+#include "serial/record/V2/version_key.h"
 #include "serial/schema/V2/base_schema.h"
+#include "serial/utils/V2/crc32c.h"
 #include "serial/utils/V2/utils.h"
 
 using namespace dingodb::serialV2;
@@ -1548,3 +1579,5451 @@ TEST_F(DingoSerialTest, recordTest) {
   DeleteSchemas();
   DeleteRecords();
 }
+
+TEST_F(DingoSerialTest, recordDecodeStringView) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  // Place key and value back to back in one storage block, the decoder must
+  // only look at its own slice.
+  std::string block = key + value;
+  std::string_view key_view(block.data(), key.size());
+  std::string_view value_view(block.data() + key.size(), value.size());
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> record2;
+  std::vector<std::any> record3;
+  ASSERT_EQ(0, rd.Decode(key_view, value_view, record2));
+  ASSERT_EQ(0, rd.Decode(key, value, record3));
+  ASSERT_EQ(record2.size(), record3.size());
+
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(0)), std::any_cast<int32_t>(record2.at(0)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(1)), std::any_cast<std::string>(record2.at(1)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), std::any_cast<std::string>(record2.at(2)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(3)), std::any_cast<int64_t>(record2.at(3)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record2.at(4)));
+  EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(record2.at(5)));
+  EXPECT_FALSE(record2.at(6).has_value());
+  EXPECT_FALSE(record2.at(7).has_value());
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(8)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+  std::vector<std::any> key_record;
+  ASSERT_EQ(0, rd.DecodeKey(key_view, key_record));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(1)), std::any_cast<std::string>(key_record.at(1)));
+
+  std::unordered_map<int, int> index_serial{{1, 0}, {4, 1}, {10, 2}};
+  std::vector<std::any> record4;
+  ASSERT_EQ(0, rd.Decode(key_view, value_view, index_serial, record4));
+  ASSERT_EQ(3, record4.size());
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(1)), std::any_cast<std::string>(record4.at(0)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record4.at(1)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record4.at(2)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordEncodeReuseOutput) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  // Encoding again into the same strings keeps their storage.
+  std::string key2, value2;
+  re.EncodeKey('r', record1, key2);
+  re.EncodeValue(record1, value2);
+  const char* key_data = key2.data();
+  const char* value_data = value2.data();
+  re.EncodeKey('r', record1, key2);
+  re.EncodeValue(record1, value2);
+  EXPECT_EQ(key, key2);
+  EXPECT_EQ(value, value2);
+  EXPECT_EQ(key_data, key2.data());
+  EXPECT_EQ(value_data, value2.data());
+
+  // Append into a caller owned buffer after some existing bytes.
+  Buf buf(64, this->le);
+  for (char c : std::string("head")) {
+    buf.Write(c);
+  }
+  int key_len = re.EncodeKey('r', record1, buf);
+  int value_len = re.EncodeValue(record1, buf);
+  ASSERT_EQ(key.size(), key_len);
+  ASSERT_EQ(value.size(), value_len);
+  std::string block = buf.GetString();
+  EXPECT_EQ("head", block.substr(0, 4));
+  EXPECT_EQ(key, block.substr(4, key_len));
+  EXPECT_EQ(value, block.substr(4 + key_len, value_len));
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, rd.Decode(std::string_view(block.data() + 4, key_len),
+                         std::string_view(block.data() + 4 + key_len, value_len), record2));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(1)), std::any_cast<std::string>(record2.at(1)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordEncodePlan) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  // schema version | not null cnt | null cnt | ids | offsets | data.
+  Buf value_buf(value, this->le);
+  EXPECT_EQ(0, value_buf.ReadInt());
+  EXPECT_EQ(5, value_buf.ReadShort());
+  EXPECT_EQ(2, value_buf.ReadShort());
+  for (int id = 4; id <= 10; ++id) {
+    EXPECT_EQ(id, value_buf.ReadShort());
+  }
+  EXPECT_EQ(8 + 7 * 2 + 7 * 4, value_buf.ReadInt());
+
+  // Move a value column into the key, the plan follows after Refresh.
+  size_t key_size = key.size();
+  schemas.at(8)->SetIsKey(true);
+  re.Refresh();
+  re.Encode('r', record1, key, value);
+  EXPECT_EQ(key_size + 4, key.size());
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, rd.Decode(key, value, record2));
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(8)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordDecodePlan) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::unordered_map<int, int> index_serial{{2, 0}, {1, 1}, {8, 2}, {7, 3}};
+  auto plan = rd.NewDecodePlan(index_serial);
+  EXPECT_EQ(4, plan.OutputSize());
+  EXPECT_EQ(9, plan.End());
+  EXPECT_EQ(DecodePlan::kSkip, plan.Slot(0));
+  EXPECT_EQ(1, plan.Slot(1));
+
+  // the plan is reusable, decode twice.
+  for (int i = 0; i < 2; ++i) {
+    std::vector<std::any> record2;
+    std::vector<std::any> record3;
+    ASSERT_EQ(0, rd.Decode(key, value, plan, record2));
+    ASSERT_EQ(0, rd.Decode(key, value, index_serial, record3));
+    ASSERT_EQ(4, record2.size());
+    EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), std::any_cast<std::string>(record2.at(0)));
+    EXPECT_EQ(std::any_cast<std::string>(record1.at(1)), std::any_cast<std::string>(record2.at(1)));
+    EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(2)));
+    EXPECT_FALSE(record2.at(3).has_value());
+    EXPECT_EQ(std::any_cast<int32_t>(record3.at(2)), std::any_cast<int32_t>(record2.at(2)));
+  }
+
+  // a plan built for other schemas is rejected.
+  std::vector<BaseSchemaPtr> other(schemas.begin(), schemas.begin() + 4);
+  std::vector<std::any> record4;
+  ASSERT_EQ(-1, rd.Decode(key, value, DecodePlan(other, index_serial), record4));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordDecodeOtherIdTable) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  // Written by a schema without column 9, the id table differs from the
+  // decoder's one so offsets are looked up by id.
+  std::vector<BaseSchemaPtr> old_schemas = schemas;
+  old_schemas.erase(old_schemas.begin() + 9);
+  RecordEncoderV2 re(0, old_schemas, 0L, this->le);
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, rd.Decode(key, value, record2));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record2.at(4)));
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(8)));
+  EXPECT_FALSE(record2.at(9).has_value());
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+// Collects sink callbacks into std::any so they can be compared with Decode.
+class AnyRowSink : public RowSink {
+ public:
+  explicit AnyRowSink(size_t size) : record(size), seen(size, 0) {}
+
+  void OnNull(int col) override { Set(col, std::any()); }
+  void OnBool(int col, bool value) override { Set(col, value); }
+  void OnInt32(int col, int32_t value) override { Set(col, value); }
+  void OnInt64(int col, int64_t value) override { Set(col, value); }
+  void OnFloat(int col, float value) override { Set(col, value); }
+  void OnDouble(int col, double value) override { Set(col, value); }
+  void OnString(int col, std::string_view value) override { Set(col, std::string(value)); }
+  void OnBoolList(int col, std::vector<bool>&& value) override { Set(col, std::move(value)); }
+  void OnInt32List(int col, std::vector<int32_t>&& value) override { Set(col, std::move(value)); }
+  void OnInt64List(int col, std::vector<int64_t>&& value) override { Set(col, std::move(value)); }
+  void OnFloatList(int col, std::vector<float>&& value) override { Set(col, std::move(value)); }
+  void OnDoubleList(int col, std::vector<double>&& value) override { Set(col, std::move(value)); }
+  void OnStringList(int col, std::vector<std::string>&& value) override { Set(col, std::move(value)); }
+
+  std::vector<std::any> record;
+  std::vector<int> seen;
+
+ private:
+  void Set(int col, std::any value) {
+    record.at(col) = std::move(value);
+    seen.at(col)++;
+  }
+};
+
+TEST_F(DingoSerialTest, recordDecodeRowSink) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  AnyRowSink sink(schemas.size());
+  ASSERT_EQ(0, rd.Decode(key, value, sink));
+  for (int i = 0; i < schemas.size(); ++i) {
+    EXPECT_EQ(1, sink.seen.at(i));
+  }
+
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(0)), std::any_cast<int32_t>(sink.record.at(0)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(1)), std::any_cast<std::string>(sink.record.at(1)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(3)), std::any_cast<int64_t>(sink.record.at(3)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(sink.record.at(4)));
+  EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(sink.record.at(5)));
+  EXPECT_FALSE(sink.record.at(6).has_value());
+  EXPECT_FALSE(sink.record.at(7).has_value());
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(sink.record.at(8)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(sink.record.at(10)));
+
+  std::unordered_map<int, int> index_serial{{2, 0}, {9, 1}};
+  AnyRowSink projected(2);
+  ASSERT_EQ(0, rd.Decode(key, value, rd.NewDecodePlan(index_serial), projected));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), std::any_cast<std::string>(projected.record.at(0)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(projected.record.at(1)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordDecodeBatch) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::vector<KeyValue> key_values(3);
+  for (auto& kv : key_values) {
+    std::string key, value;
+    re.Encode('r', record1, key, value);
+    kv.Set(key, value);
+  }
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::unordered_map<int, int> index_serial{{0, 0}, {2, 1}, {5, 2}, {6, 3}, {9, 4}};
+  auto plan = rd.NewDecodePlan(index_serial);
+
+  ColumnBatch batch;
+  ASSERT_EQ(0, rd.DecodeBatch(key_values, plan, batch));
+  ASSERT_EQ(3, batch.NumRows());
+  ASSERT_EQ(5, batch.NumColumns());
+
+  for (size_t r = 0; r < batch.NumRows(); ++r) {
+    EXPECT_EQ(std::any_cast<int32_t>(record1.at(0)), batch.Column(0).Get<int32_t>(r));
+    EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), batch.Column(1).GetString(r));
+    EXPECT_EQ(std::any_cast<bool>(record1.at(5)), batch.Column(2).Get<bool>(r));
+    EXPECT_TRUE(batch.Column(3).IsNull(r));
+    EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), batch.Column(4).Get<int64_t>(r));
+  }
+  EXPECT_EQ(3, batch.Column(3).NullCount());
+
+  // Buffers are reused by the next batch.
+  ASSERT_EQ(0, rd.DecodeBatch(key_values.data(), 1, plan, batch));
+  EXPECT_EQ(1, batch.NumRows());
+  EXPECT_EQ(1, batch.Column(1).Size());
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), batch.Column(1).GetString(0));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordDecodeLazy) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  LazyRecordV2 lazy;
+  ASSERT_EQ(0, rd.DecodeLazy(key, value, lazy));
+  ASSERT_EQ(schemas.size(), lazy.Size());
+
+  // out of order, the last key column first.
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(3)), lazy.Get<int64_t>(3));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), lazy.Get<std::string>(4));
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(0)), lazy.Get<int32_t>(0));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), lazy.Get<int64_t>(9));
+  EXPECT_TRUE(lazy.IsNull(6));
+  EXPECT_TRUE(lazy.IsNull(7));
+  EXPECT_FALSE(lazy.IsNull(8));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(1)), lazy.Get<std::string>(1));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), lazy.Get<std::string>(2));
+  EXPECT_EQ(std::any_cast<bool>(record1.at(5)), lazy.Get<bool>(5));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), lazy.Get<double>(10));
+  // cached.
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), lazy.Get<std::string>(4));
+
+  std::string other_key = key;
+  other_key[1] ^= 0x1;
+  EXPECT_EQ(-1, rd.DecodeLazy(other_key, value, lazy));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordEvaluatePredicate) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  auto expect = [&](bool match, const EncodedPredicate& predicate) {
+    bool matched = !match;
+    ASSERT_EQ(0, rd.Evaluate(key, value, predicate, matched));
+    EXPECT_EQ(match, matched);
+  };
+
+  int32_t id = std::any_cast<int32_t>(record1.at(0));
+  int32_t age = std::any_cast<int32_t>(record1.at(8));
+  int64_t prev = std::any_cast<int64_t>(record1.at(9));
+  double salary = std::any_cast<double>(record1.at(10));
+  std::string addr = std::any_cast<std::string>(record1.at(4));
+  std::string name = std::any_cast<std::string>(record1.at(1));
+
+  // value columns.
+  expect(true, EncodedPredicate::Equal(8, age));
+  expect(false, EncodedPredicate::Equal(8, age + 1));
+  expect(true, EncodedPredicate::Less(8, int64_t(age) + 1));
+  expect(false, EncodedPredicate::Less(8, age));
+  expect(true, EncodedPredicate::LessEqual(9, prev));
+  expect(true, EncodedPredicate::GreaterEqual(10, salary));
+  expect(false, EncodedPredicate::Greater(10, salary));
+  expect(true, EncodedPredicate::Between(10, salary - 1, salary + 1));
+  expect(false, EncodedPredicate::Between(9, prev + 1, prev + 2));
+  expect(true, EncodedPredicate::Equal(4, addr));
+  expect(false, EncodedPredicate::Equal(4, addr + "x"));
+  expect(true, EncodedPredicate::In(4, {std::string("x"), addr}));
+  expect(true, EncodedPredicate::Equal(5, std::any_cast<bool>(record1.at(5))));
+  expect(true, EncodedPredicate::IsNull(6));
+  expect(true, EncodedPredicate::IsNull(7));
+  expect(false, EncodedPredicate::Equal(7, 0));
+  expect(false, EncodedPredicate::IsNull(8));
+  // another kind never matches.
+  expect(false, EncodedPredicate::Equal(4, 1));
+
+  // key columns.
+  expect(true, EncodedPredicate::Equal(0, id));
+  expect(true, EncodedPredicate::Equal(1, name));
+  expect(true, EncodedPredicate::In(3, {int64_t(-1), record1.at(3)}));
+  expect(false, EncodedPredicate::IsNull(2));
+
+  bool matched;
+  EXPECT_EQ(-1, rd.Evaluate(key, value, EncodedPredicate::IsNull(100), matched));
+  EXPECT_THROW(EncodedPredicate(0, EncodedPredicate::kBetween, {1}), std::runtime_error);
+  EXPECT_THROW(EncodedPredicate::Equal(0, std::any()), std::runtime_error);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordEncodeKeyPrefix) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key1;
+  re.EncodeKey('r', record1, key1);
+
+  std::string prefix, end;
+  ASSERT_LT(0, re.EncodeKeyPrefix('r', record1, 2, prefix));
+  ASSERT_LT(0, re.EncodeKeyPrefixSuccessor('r', record1, 2, end));
+  EXPECT_EQ(0, key1.compare(0, prefix.size(), prefix));
+  EXPECT_LT(key1, end);
+  EXPECT_LE(prefix, key1);
+
+  // same leading columns, in range.
+  auto record2 = record1;
+  record2.at(2) = std::string("zzzzzzzzzzzzzzzzzzzz");
+  record2.at(3) = int64_t(INT64_MAX);
+  std::string key2;
+  re.EncodeKey('r', record2, key2);
+  EXPECT_LE(prefix, key2);
+  EXPECT_LT(key2, end);
+
+  // another name, out of range.
+  auto record3 = record1;
+  record3.at(1) = std::string("tn0");
+  std::string key3;
+  re.EncodeKey('r', record3, key3);
+  EXPECT_FALSE(prefix <= key3 && key3 < end);
+
+  // the string form gives the same prefix.
+  std::string str_prefix, str_end;
+  re.EncodeKeyPrefix('r', std::vector<std::string>{"0", "tn"}, str_prefix);
+  re.EncodeKeyPrefixSuccessor('r', std::vector<std::string>{"0", "tn"}, str_end);
+  EXPECT_EQ(prefix, str_prefix);
+  EXPECT_EQ(end, str_end);
+
+  // every key column, the prefix is the key without codec version.
+  std::string full;
+  re.EncodeKeyPrefix('r', record1, 100, full);
+  EXPECT_EQ(key1.substr(0, key1.size() - 4), full);
+
+  // the table prefix alone, for every namespace.
+  EXPECT_EQ(key1.substr(0, 9), re.KeyPrefix('r'));
+  std::string table_prefix;
+  re.EncodeKeyPrefix('t', record1, 0, table_prefix);
+  EXPECT_EQ(table_prefix, re.KeyPrefix('t'));
+
+  // the decoder takes any namespace but only its common_id.
+  RecordEncoderV2 other(0, schemas, 0x0102030405060708L, this->le);
+  EXPECT_EQ(0x08, static_cast<uint8_t>(other.KeyPrefix('r')[this->le ? 8 : 1]));
+  std::string value1, key4, value4;
+  re.Encode('x', record1, key4, value1);
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> decoded;
+  EXPECT_EQ(0, rd.Decode(key4, value1, decoded));
+  other.Encode('r', record1, key4, value4);
+  EXPECT_EQ(-1, rd.Decode(key4, value4, decoded));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordCompactValueHeader) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  RecordEncoderV2 compact_re(0, schemas, 0L, this->le);
+  compact_re.SetCompactValueHeader(true);
+  std::string compact_key, compact_value;
+  compact_re.Encode('r', record1, compact_key, compact_value);
+
+  // 7 value columns, each 1 id byte and 2 offset bytes less.
+  EXPECT_EQ(key, compact_key);
+  EXPECT_EQ(value.size() - 7 * 3, compact_value.size());
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, rd.Decode(compact_key, compact_value, record2));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record2.at(4)));
+  EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(record2.at(5)));
+  EXPECT_FALSE(record2.at(6).has_value());
+  EXPECT_FALSE(record2.at(7).has_value());
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(8)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+  // decoders with other schemas go through the id table.
+  auto other_schemas = schemas;
+  other_schemas.at(5) = nullptr;
+  RecordDecoderV2 other_rd(0, other_schemas, 0L, this->le);
+  std::vector<std::any> record3;
+  ASSERT_EQ(0, other_rd.Decode(compact_key, compact_value, record3));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record3.at(4)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record3.at(10)));
+  EXPECT_FALSE(record3.at(7).has_value());
+
+  // too large for 2 bytes offsets, the ids stay compact.
+  auto record4 = record1;
+  record4.at(4) = std::string(70000, 'a');
+  std::string large_value;
+  compact_re.EncodeValue(record4, large_value);
+  std::vector<std::any> record5;
+  ASSERT_EQ(0, rd.Decode(compact_key, large_value, record5));
+  EXPECT_EQ(std::any_cast<std::string>(record4.at(4)), std::any_cast<std::string>(record5.at(4)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record5.at(10)));
+
+  // unknown format flags are rejected.
+  Buf version(4, this->le);
+  version.WriteInt(SetValueFormat(0, 0x80));
+  std::string unknown_value = compact_value;
+  unknown_value.replace(0, 4, version.GetString());
+  EXPECT_EQ(-1, rd.Decode(compact_key, unknown_value, record5));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordNullBitmap) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  for (bool compact : {false, true}) {
+    RecordEncoderV2 bitmap_re(0, schemas, 0L, this->le);
+    bitmap_re.SetNullBitmap(true);
+    bitmap_re.SetCompactValueHeader(compact);
+    std::string bitmap_value;
+    bitmap_re.EncodeValue(record1, bitmap_value);
+
+    // 2 null columns leave the tables, 1 bitmap byte is added.
+    if (!compact) {
+      EXPECT_EQ(value.size() - 2 * 6 + 1, bitmap_value.size());
+    }
+
+    RecordDecoderV2 rd(0, schemas, 0L, this->le);
+    std::vector<std::any> record2;
+    ASSERT_EQ(0, rd.Decode(key, bitmap_value, record2));
+    EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record2.at(4)));
+    EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(record2.at(5)));
+    EXPECT_FALSE(record2.at(6).has_value());
+    EXPECT_FALSE(record2.at(7).has_value());
+    EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(8)));
+    EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+    EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+    LazyRecordV2 lazy;
+    ASSERT_EQ(0, rd.DecodeLazy(key, bitmap_value, lazy));
+    EXPECT_TRUE(lazy.IsNull(6));
+    EXPECT_TRUE(lazy.IsNull(7));
+    EXPECT_FALSE(lazy.IsNull(8));
+    EXPECT_EQ(std::any_cast<double>(record1.at(10)), lazy.Get<double>(10));
+
+    // another decoder searches the not null ids.
+    auto other_schemas = schemas;
+    other_schemas.at(4) = nullptr;
+    RecordDecoderV2 other_rd(0, other_schemas, 0L, this->le);
+    std::vector<std::any> record3;
+    ASSERT_EQ(0, other_rd.Decode(key, bitmap_value, record3));
+    EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(record3.at(5)));
+    EXPECT_FALSE(record3.at(7).has_value());
+    EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record3.at(10)));
+
+    // more nulls.
+    auto record4 = record1;
+    record4.at(4) = std::any();
+    record4.at(10) = std::any();
+    std::string sparse_value;
+    bitmap_re.EncodeValue(record4, sparse_value);
+    std::vector<std::any> record5;
+    ASSERT_EQ(0, rd.Decode(key, sparse_value, record5));
+    EXPECT_FALSE(record5.at(4).has_value());
+    EXPECT_FALSE(record5.at(10).has_value());
+    EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record5.at(9)));
+  }
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordStaticOffsets) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  // the flag is past the top byte, older decoders see a newer version.
+  int32_t version = SetValueFormat(3, VALUE_FORMAT_STATIC_OFFSETS);
+  EXPECT_EQ(VALUE_FORMAT_STATIC_OFFSETS, GetValueFormat(version));
+  EXPECT_EQ(3, version & kSchemaVersionMask);
+  EXPECT_LT(3, version & 0x00FFFFFF);
+
+  for (bool compact : {false, true}) {
+    RecordEncoderV2 static_re(0, schemas, 0L, this->le);
+    static_re.SetStaticOffsets(true);
+    static_re.SetCompactValueHeader(compact);
+    std::string static_value;
+    static_re.EncodeValue(record1, static_value);
+    EXPECT_TRUE(GetValueFormat(BufView(static_value, this->le).ReadInt(0)) &
+                VALUE_FORMAT_STATIC_OFFSETS);
+
+    // 5 fixed width columns lose their offsets and the nulls keep their room,
+    // a fixed column count and a bitmap byte are added.
+    if (!compact) {
+      EXPECT_EQ(value.size() - 5 * 4 + 4 + 2 + 1, static_value.size());
+    }
+
+    RecordDecoderV2 rd(0, schemas, 0L, this->le);
+    std::vector<std::any> record2;
+    ASSERT_EQ(0, rd.Decode(key, static_value, record2));
+    EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record2.at(4)));
+    EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(record2.at(5)));
+    EXPECT_FALSE(record2.at(6).has_value());
+    EXPECT_FALSE(record2.at(7).has_value());
+    EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(8)));
+    EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+    EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+    LazyRecordV2 lazy;
+    ASSERT_EQ(0, rd.DecodeLazy(key, static_value, lazy));
+    EXPECT_TRUE(lazy.IsNull(6));
+    EXPECT_TRUE(lazy.IsNull(7));
+    EXPECT_FALSE(lazy.IsNull(8));
+    EXPECT_EQ(std::any_cast<double>(record1.at(10)), lazy.Get<double>(10));
+
+    // another decoder sums up the fixed width columns of the writer.
+    auto other_schemas = schemas;
+    other_schemas.at(4) = nullptr;
+    other_schemas.at(6) = nullptr;
+    RecordDecoderV2 other_rd(0, other_schemas, 0L, this->le);
+    std::vector<std::any> record3;
+    ASSERT_EQ(0, other_rd.Decode(key, static_value, record3));
+    EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(record3.at(5)));
+    EXPECT_FALSE(record3.at(7).has_value());
+    EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record3.at(9)));
+    EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record3.at(10)));
+
+    // more nulls, and compressed.
+    auto record4 = record1;
+    record4.at(4) = std::any();
+    record4.at(10) = std::any();
+    static_re.SetCompression(CompressionType::kZlib, 0);
+    std::string sparse_value;
+    static_re.EncodeValue(record4, sparse_value);
+    std::vector<std::any> record5;
+    ASSERT_EQ(0, rd.Decode(key, sparse_value, record5));
+    EXPECT_FALSE(record5.at(4).has_value());
+    EXPECT_FALSE(record5.at(10).has_value());
+    EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record5.at(8)));
+    EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record5.at(9)));
+  }
+
+  // a fixed width column unknown to the decoder hides the ones behind it.
+  RecordEncoderV2 static_re(0, schemas, 0L, this->le);
+  static_re.SetStaticOffsets(true);
+  std::string static_value;
+  static_re.EncodeValue(record1, static_value);
+  auto dropped_schemas = schemas;
+  dropped_schemas.at(5) = nullptr;
+  RecordDecoderV2 dropped_rd(0, dropped_schemas, 0L, this->le);
+  std::vector<std::any> record6;
+  EXPECT_THROW(dropped_rd.Decode(key, static_value, record6), std::runtime_error);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordUpdateValue) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  using Updates = std::map<int, std::any>;
+  std::vector<Updates> cases{
+      {{8, int32_t(21)}},
+      {{5, true}, {9, int64_t(-1)}, {10, 0.5}},
+      {{4, std::string("short")}},
+      {{4, std::string(300, 'x')}, {8, int32_t(7)}},
+      {{4, std::any()}, {6, std::string("pic")}},
+      {{7, int32_t(3)}, {10, std::any()}},
+  };
+
+  for (int layout = 0; layout < 5; ++layout) {
+    RecordEncoderV2 re(0, schemas, 0L, this->le);
+    re.SetCompactValueHeader(layout == 1);
+    re.SetNullBitmap(layout == 2);
+    re.SetStaticOffsets(layout == 3);
+    if (layout == 4) {
+      re.SetCompression(CompressionType::kZlib, 0);
+    }
+    std::string value;
+    re.EncodeValue(record1, value);
+
+    for (const auto& updates : cases) {
+      auto record2 = record1;
+      bool null_change = false;
+      for (const auto& [index, data] : updates) {
+        null_change = null_change ||
+                      record2.at(index).has_value() != data.has_value();
+        record2.at(index) = data;
+      }
+
+      std::string updated;
+      if (layout == 2 && null_change) {
+        EXPECT_EQ(-1, re.UpdateValue(value, updates, updated));
+        continue;
+      }
+      ASSERT_LT(0, re.UpdateValue(value, updates, updated));
+      std::string expected;
+      re.EncodeValue(record2, expected);
+      EXPECT_EQ(expected, updated) << "layout " << layout;
+
+      // and again on the patched value.
+      std::string back;
+      Updates restore;
+      for (const auto& update : updates) {
+        restore[update.first] = record1.at(update.first);
+      }
+      ASSERT_LT(0, re.UpdateValue(updated, restore, back));
+      EXPECT_EQ(value, back) << "layout " << layout;
+    }
+
+    std::string updated;
+    EXPECT_EQ(-1, re.UpdateValue(value, {{0, int32_t(1)}}, updated));
+    EXPECT_EQ(-1, re.UpdateValue(value, {{11, int32_t(1)}}, updated));
+  }
+
+  // a row without the column can not be patched.
+  auto other_schemas = schemas;
+  other_schemas.at(6) = nullptr;
+  RecordEncoderV2 other_re(0, other_schemas, 0L, this->le);
+  std::string other_value;
+  other_re.EncodeValue(record1, other_value);
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  std::string updated;
+  EXPECT_EQ(-1, re.UpdateValue(other_value, {{6, std::string("pic")}}, updated));
+  ASSERT_LT(0, re.UpdateValue(other_value, {{8, int32_t(9)}}, updated));
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::string key;
+  re.EncodeKey('r', record1, key);
+  std::vector<std::any> record3;
+  ASSERT_EQ(0, rd.Decode(key, updated, record3));
+  EXPECT_EQ(9, std::any_cast<int32_t>(record3.at(8)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), std::any_cast<std::string>(record3.at(4)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordEncodedSize) {
+  using Codec = StaticRecordCodec<
+      Column<int64_t, Key>, Column<std::string, Key, Nullable>,
+      Column<double, Key, Nullable>, Column<std::string, Value, Nullable>,
+      Column<int32_t, Value>, Column<bool, Value, Nullable>,
+      Column<int64_t, Value, Nullable>, Column<std::vector<int64_t>, Value, Nullable>,
+      Column<std::vector<std::string>, Value>, Column<std::vector<bool>, Value>,
+      Column<std::vector<float>, Value, Nullable>, Column<std::vector<double>, Value>,
+      Column<std::vector<int32_t>, Value, Nullable>>;
+
+  std::vector<std::vector<std::any>> records{
+      {int64_t(-5), std::string("encoded size key"), 0.5, std::string("dict"),
+       int32_t(-20), true, int64_t(1) << 40, std::vector<int64_t>{1, -2, 3},
+       std::vector<std::string>{"a", "", "bc"},
+       std::vector<bool>(13, true), std::vector<float>{1.0f, -2.5f, 3.0f},
+       std::vector<double>{0.25}, std::vector<int32_t>{7, 8}},
+      {int64_t(7), std::any(), std::any(), std::string("not in dictionary"),
+       int32_t(300), std::any(), std::any(), std::any(),
+       std::vector<std::string>{}, std::vector<bool>{}, std::any(),
+       std::vector<double>{}, std::any()},
+      {int64_t(0), std::string(16, 'k'), -1.0, std::string(70000, 'v'),
+       int32_t(0), false, int64_t(-1), std::vector<int64_t>{},
+       std::vector<std::string>{std::string(100, 's')},
+       std::vector<bool>{false}, std::vector<float>(40, 0.125f),
+       std::vector<double>{1.0, 2.0}, std::vector<int32_t>(5, -1)},
+  };
+
+  for (int layout = 0; layout < 5; ++layout) {
+    auto schemas = Codec::MakeSchemas();
+    if (layout == 4) {
+      std::static_pointer_cast<DingoSchema<std::string>>(schemas.at(3))
+          ->SetDictionary(std::make_shared<StringDictionary>(
+              std::vector<std::string>{"dict"}));
+      std::static_pointer_cast<DingoSchema<int32_t>>(schemas.at(4))->SetVarint(true);
+      std::static_pointer_cast<DingoSchema<int64_t>>(schemas.at(6))->SetVarint(true);
+      std::static_pointer_cast<DingoSchema<std::vector<bool>>>(schemas.at(9))
+          ->SetPacked(true);
+      std::static_pointer_cast<DingoSchema<std::vector<float>>>(schemas.at(10))
+          ->SetQuantization(FloatQuantization::kInt8);
+    }
+    RecordEncoderV2 re(1, schemas, 3L, this->le);
+    re.SetCompactValueHeader(layout == 1 || layout == 4);
+    re.SetNullBitmap(layout == 2);
+    re.SetStaticOffsets(layout == 3);
+
+    for (const auto& record : records) {
+      std::string key, value;
+      ASSERT_EQ(0, re.Encode('r', record, key, value));
+      EXPECT_EQ(key.size(), re.EncodedKeySize(record)) << "layout " << layout;
+      EXPECT_EQ(value.size(), re.EncodedValueSize(record)) << "layout " << layout;
+      EXPECT_EQ(key.size() + value.size(), re.EncodedSize(record));
+    }
+
+    // compressed values are no larger than the raw size.
+    re.SetCompression(CompressionType::kZlib, 0);
+    for (const auto& record : records) {
+      std::string value;
+      re.EncodeValue(record, value);
+      EXPECT_GE(re.EncodedValueSize(record), value.size());
+    }
+  }
+}
+
+TEST_F(DingoSerialTest, recordEncodeStats) {
+  using Codec = StaticRecordCodec<
+      Column<int64_t, Key>, Column<std::string, Key, Nullable>,
+      Column<double, Value, Nullable>, Column<std::vector<int32_t>, Value, Nullable>,
+      Column<bool, Value>>;
+  auto schemas = Codec::MakeSchemas();
+  RecordEncoderV2 re(1, schemas, 3L, this->le);
+
+  std::vector<std::vector<std::any>> records;
+  for (int i = 0; i < 3000; ++i) {
+    std::any name = i % 3 == 0 ? std::any() : std::any("name" + std::to_string(i % 100));
+    std::any score = i % 5 == 0 ? std::any() : std::any(i * 0.5 - 100);
+    std::any list = i % 2 == 0 ? std::any() : std::any(std::vector<int32_t>{i % 7});
+    records.push_back({int64_t(i - 1000), name, score, list, i % 4 == 0});
+  }
+
+  auto stats = re.NewStatsCollector();
+  std::string key, value;
+  for (const auto& record : records) {
+    ASSERT_EQ(0, re.Encode('r', record, key, value, stats));
+  }
+  EXPECT_EQ(3000, stats.RowCount());
+
+  const auto& columns = stats.Columns();
+  ASSERT_EQ(5, columns.size());
+  EXPECT_EQ(0, columns[0].null_count);
+  EXPECT_EQ(3000, columns[0].value_count);
+  EXPECT_EQ(-1000, std::any_cast<int64_t>(columns[0].min));
+  EXPECT_EQ(1999, std::any_cast<int64_t>(columns[0].max));
+  EXPECT_NEAR(3000, columns[0].distinct.Estimate(), 300);
+
+  EXPECT_EQ(1000, columns[1].null_count);
+  EXPECT_EQ("name0", std::any_cast<std::string>(columns[1].min));
+  EXPECT_EQ("name99", std::any_cast<std::string>(columns[1].max));
+  EXPECT_NEAR(100, columns[1].distinct.Estimate(), 10);
+
+  EXPECT_EQ(600, columns[2].null_count);
+  EXPECT_EQ(2400, columns[2].value_count);
+  EXPECT_EQ(-99.5, std::any_cast<double>(columns[2].min));
+  EXPECT_EQ(1399.5, std::any_cast<double>(columns[2].max));
+
+  // lists have no range, only a sketch.
+  EXPECT_EQ(1500, columns[3].null_count);
+  EXPECT_FALSE(columns[3].min.has_value());
+  EXPECT_EQ(7, columns[3].distinct.Estimate());
+
+  EXPECT_FALSE(std::any_cast<bool>(columns[4].min));
+  EXPECT_TRUE(std::any_cast<bool>(columns[4].max));
+  EXPECT_EQ(2, columns[4].distinct.Estimate());
+
+  // a parallel batch merges its workers into the same result.
+  auto batch_stats = re.NewStatsCollector();
+  std::vector<std::string> keys, values;
+  ParallelOptions options{4, 100, {}};
+  ASSERT_EQ(0, re.EncodeBatch('r', records, keys, values, batch_stats, options));
+  EXPECT_EQ(value, values.back());
+  EXPECT_EQ(3000, batch_stats.RowCount());
+  for (int i = 0; i < 5; ++i) {
+    const auto& batch_column = batch_stats.Columns()[i];
+    EXPECT_EQ(columns[i].null_count, batch_column.null_count);
+    EXPECT_EQ(columns[i].value_count, batch_column.value_count);
+    EXPECT_EQ(columns[i].distinct.Estimate(), batch_column.distinct.Estimate());
+  }
+  EXPECT_EQ(-1000, std::any_cast<int64_t>(batch_stats.Columns()[0].min));
+  EXPECT_EQ(1399.5, std::any_cast<double>(batch_stats.Columns()[2].max));
+
+  batch_stats.Reset();
+  EXPECT_EQ(0, batch_stats.RowCount());
+  EXPECT_FALSE(batch_stats.Columns()[0].min.has_value());
+  EXPECT_EQ(0, batch_stats.Columns()[0].distinct.Estimate());
+
+  auto other_schemas = schemas;
+  other_schemas.pop_back();
+  EXPECT_THROW(stats.Merge(EncodeStatsCollector(other_schemas)), std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordVarintValue) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  // age and prev as varints.
+  std::static_pointer_cast<DingoSchema<int32_t>>(schemas.at(8))->SetVarint(true);
+  std::static_pointer_cast<DingoSchema<int64_t>>(schemas.at(9))->SetVarint(true);
+  RecordEncoderV2 varint_re(0, schemas, 0L, this->le);
+  std::string varint_value;
+  varint_re.EncodeValue(record1, varint_value);
+  EXPECT_EQ(value.size() - (4 - 1) - (8 - 6), varint_value.size());
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, rd.Decode(key, varint_value, record2));
+  EXPECT_EQ(std::any_cast<int32_t>(record1.at(8)), std::any_cast<int32_t>(record2.at(8)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+  EXPECT_EQ(std::any_cast<double>(record1.at(10)), std::any_cast<double>(record2.at(10)));
+
+  bool matched = false;
+  ASSERT_EQ(0, rd.Evaluate(key, varint_value, EncodedPredicate::Equal(9, record1.at(9)), matched));
+  EXPECT_TRUE(matched);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordDictionaryString) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+  std::string addr = std::any_cast<std::string>(record1.at(4));
+
+  auto dictionary = std::make_shared<StringDictionary>(
+      std::vector<std::string>{"other", addr});
+  EXPECT_EQ(1, dictionary->Find(addr));
+  EXPECT_EQ(StringDictionary::kNoCode, dictionary->Find(std::string("zzz")));
+  EXPECT_THROW(StringDictionary({"a", "a"}), std::runtime_error);
+
+  RecordEncoderV2 plain_re(0, schemas, 0L, this->le);
+  std::string key, plain_value;
+  plain_re.Encode('r', record1, key, plain_value);
+
+  auto addr_schema = std::static_pointer_cast<DingoSchema<std::string>>(schemas.at(4));
+  addr_schema->SetDictionary(dictionary);
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  std::string value;
+  re.EncodeValue(record1, value);
+  EXPECT_EQ(plain_value.size() - addr.size(), value.size());
+  EXPECT_TRUE(GetValueFormat(BufView(value, this->le).ReadInt(0)) & VALUE_FORMAT_DICT_STRINGS);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, rd.Decode(key, value, record2));
+  EXPECT_EQ(addr, std::any_cast<std::string>(record2.at(4)));
+  EXPECT_EQ(std::any_cast<bool>(record1.at(5)), std::any_cast<bool>(record2.at(5)));
+
+  int32_t code = StringDictionary::kNoCode;
+  ASSERT_EQ(0, rd.DecodeDictionaryCode(key, value, 4, code));
+  EXPECT_EQ(1, code);
+  // plain rows resolve through the dictionary too.
+  ASSERT_EQ(0, rd.DecodeDictionaryCode(key, plain_value, 4, code));
+  EXPECT_EQ(1, code);
+  ASSERT_EQ(0, rd.DecodeDictionaryCode(key, value, 6, code));
+  EXPECT_EQ(StringDictionary::kNoCode, code);
+  EXPECT_EQ(-1, rd.DecodeDictionaryCode(key, value, 1, code));
+  EXPECT_EQ(-1, rd.DecodeDictionaryCode(key, value, 5, code));
+
+  bool matched = false;
+  ASSERT_EQ(0, rd.Evaluate(key, value, EncodedPredicate::Equal(4, addr), matched));
+  EXPECT_TRUE(matched);
+
+  // values missing from the dictionary keep the plain form.
+  auto record3 = record1;
+  record3.at(4) = std::string("zzz");
+  std::string value3;
+  re.EncodeValue(record3, value3);
+  ASSERT_EQ(0, rd.Decode(key, value3, record2));
+  EXPECT_EQ("zzz", std::any_cast<std::string>(record2.at(4)));
+  ASSERT_EQ(0, rd.DecodeDictionaryCode(key, value3, 4, code));
+  EXPECT_EQ(StringDictionary::kNoCode, code);
+
+  // a code can not be resolved without its dictionary.
+  addr_schema->SetDictionary(nullptr);
+  EXPECT_THROW(rd.Decode(key, value, record2), std::runtime_error);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordBlock) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  RecordBlockBuilder builder(0, schemas, 0L, this->le);
+  std::vector<std::vector<std::any>> records;
+  std::vector<std::string> keys;
+  for (int32_t i = 0; i < 40; ++i) {
+    auto record = record1;
+    record.at(0) = i * 2;
+    record.at(4) = "address " + std::to_string(i);
+    if (i % 3 == 0) {
+      record.at(10) = std::any();
+    }
+    ASSERT_EQ(0, builder.Add('r', record));
+    std::string key;
+    re.EncodeKey('r', record, key);
+    keys.push_back(key);
+    records.push_back(record);
+  }
+  EXPECT_EQ(40, builder.RowCount());
+  // keys must grow.
+  EXPECT_EQ(-1, builder.Add('r', records.at(5)));
+  EXPECT_EQ(40, builder.RowCount());
+
+  size_t estimated = builder.EstimatedSize();
+  std::string block;
+  ASSERT_EQ(estimated, builder.Finish(block));
+  EXPECT_TRUE(builder.Empty());
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  RecordBlockReader reader(0, schemas, 0L, this->le);
+  ASSERT_EQ(0, reader.Open(block));
+  ASSERT_EQ(40, reader.RowCount());
+
+  std::vector<std::any> record2;
+  std::vector<std::any> record3;
+  for (size_t r = 0; r < records.size(); ++r) {
+    ASSERT_TRUE(reader.Next(record2));
+    EXPECT_EQ(keys[r], reader.Key());
+    std::string value;
+    re.EncodeValue(records[r], value);
+    ASSERT_EQ(0, rd.Decode(keys[r], value, record3));
+    EXPECT_EQ(std::any_cast<int32_t>(record3.at(0)), std::any_cast<int32_t>(record2.at(0)));
+    EXPECT_EQ(std::any_cast<std::string>(record3.at(1)), std::any_cast<std::string>(record2.at(1)));
+    EXPECT_EQ(std::any_cast<int64_t>(record3.at(3)), std::any_cast<int64_t>(record2.at(3)));
+    EXPECT_EQ(std::any_cast<std::string>(record3.at(4)), std::any_cast<std::string>(record2.at(4)));
+    EXPECT_EQ(std::any_cast<bool>(record3.at(5)), std::any_cast<bool>(record2.at(5)));
+    EXPECT_FALSE(record2.at(6).has_value());
+    EXPECT_EQ(std::any_cast<int64_t>(record3.at(9)), std::any_cast<int64_t>(record2.at(9)));
+    EXPECT_EQ(record3.at(10).has_value(), record2.at(10).has_value());
+  }
+  EXPECT_FALSE(reader.Next(record2));
+
+  // past a restart, between keys and past the end.
+  reader.Seek(keys[21]);
+  EXPECT_EQ(21, reader.Position());
+  ASSERT_TRUE(reader.Next(record2));
+  EXPECT_EQ(42, std::any_cast<int32_t>(record2.at(0)));
+  auto between = records[33];
+  between.at(0) = 65;
+  std::string between_key;
+  re.EncodeKey('r', between, between_key);
+  reader.Seek(between_key);
+  EXPECT_EQ(33, reader.Position());
+  ASSERT_TRUE(reader.Next(record2));
+  EXPECT_EQ("address 33", std::any_cast<std::string>(record2.at(4)));
+  reader.Seek(keys[0]);
+  EXPECT_EQ(0, reader.Position());
+  auto last = records[39];
+  last.at(0) = 100;
+  std::string last_key;
+  re.EncodeKey('r', last, last_key);
+  reader.Seek(last_key);
+  EXPECT_TRUE(reader.AtEnd());
+
+  std::unordered_map<int, int> index_serial{{0, 0}, {4, 1}, {6, 2}, {10, 3}};
+  auto plan = rd.NewDecodePlan(index_serial);
+  ColumnBatch batch;
+  reader.Seek(keys[10]);
+  ASSERT_EQ(25, reader.NextBatch(plan, 25, batch));
+  ASSERT_EQ(25, batch.NumRows());
+  for (size_t r = 0; r < batch.NumRows(); ++r) {
+    EXPECT_EQ(static_cast<int32_t>((r + 10) * 2), batch.Column(0).Get<int32_t>(r));
+    EXPECT_EQ("address " + std::to_string(r + 10), batch.Column(1).GetString(r));
+    EXPECT_TRUE(batch.Column(2).IsNull(r));
+    EXPECT_EQ((r + 10) % 3 == 0, batch.Column(3).IsNull(r));
+  }
+  EXPECT_EQ(5, reader.NextBatch(plan, 25, batch));
+  EXPECT_EQ(0, reader.NextBatch(plan, 25, batch));
+
+  // corrupt or foreign blocks are refused.
+  EXPECT_EQ(-1, reader.Open(block.substr(0, block.size() - 1)));
+  RecordBlockReader old_reader(-1, schemas, 0L, this->le);
+  EXPECT_EQ(-1, old_reader.Open(block));
+
+  EXPECT_LT(0, builder.Finish(block));
+  ASSERT_EQ(0, reader.Open(block));
+  EXPECT_EQ(0, reader.RowCount());
+  EXPECT_TRUE(reader.AtEnd());
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordDecoderRegistry) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  // version 1 had no salary column yet.
+  auto old_schemas = schemas;
+  old_schemas.at(10) = nullptr;
+  RecordEncoderV2 old_re(1, old_schemas, 0L, this->le);
+  std::string key, old_value;
+  old_re.Encode('r', record1, key, old_value);
+  RecordEncoderV2 re(2, schemas, 0L, this->le);
+  std::string value;
+  auto record_null = record1;
+  record_null.at(10) = std::any();
+  re.EncodeValue(record_null, value);
+
+  DecoderRegistry registry(this->le);
+  EXPECT_EQ(nullptr, registry.Get(0L));
+  ASSERT_EQ(0, registry.Register(0L, 1, old_schemas));
+  std::vector<std::any> defaults(schemas.size());
+  defaults.at(10) = 1.5;
+  ASSERT_EQ(0, registry.Register(0L, 2, schemas, defaults));
+  EXPECT_EQ(-1, registry.Register(0L, 2, schemas));
+  EXPECT_EQ(2, registry.Size());
+
+  auto decoder = registry.Get(0L);
+  ASSERT_NE(nullptr, decoder);
+  EXPECT_EQ(decoder, registry.Get(0L, 2));
+  EXPECT_EQ(decoder, registry.Get(0L, std::string_view(old_value)));
+  EXPECT_NE(decoder, registry.Get(0L, 1));
+  EXPECT_EQ(nullptr, registry.Get(0L, 3));
+  EXPECT_EQ(nullptr, registry.Get(1L));
+
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, registry.Decode(0L, key, old_value, record2));
+  EXPECT_EQ(1.5, std::any_cast<double>(record2.at(10)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+  EXPECT_FALSE(record2.at(6).has_value());
+  // a null of the current version stays null.
+  ASSERT_EQ(0, registry.Decode(0L, key, value, record2));
+  EXPECT_FALSE(record2.at(10).has_value());
+
+  // rows newer than every registered version are refused.
+  RecordEncoderV2 new_re(3, schemas, 0L, this->le);
+  std::string new_value;
+  new_re.EncodeValue(record1, new_value);
+  EXPECT_EQ(nullptr, registry.Get(0L, std::string_view(new_value)));
+  EXPECT_EQ(-1, registry.Decode(0L, key, new_value, record2));
+
+  registry.Remove(0L);
+  EXPECT_EQ(0, registry.Size());
+  EXPECT_EQ(-1, registry.Decode(0L, key, value, record2));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordSharedCodec) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  re.SetNullBitmap(true);
+  const RecordEncoderV2& shared_re = re;
+  const RecordDecoderV2 shared_rd(0, schemas, 0L, this->le);
+
+  std::vector<int> failures(4, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t]() {
+      auto record = record1;
+      std::string key, value;
+      std::vector<std::any> record2;
+      for (int32_t i = 0; i < 1000; ++i) {
+        record.at(0) = t * 1000 + i;
+        shared_re.Encode('r', record, key, value);
+        if (shared_rd.Decode(key, value, record2) != 0 ||
+            std::any_cast<int32_t>(record2.at(0)) != t * 1000 + i ||
+            std::any_cast<std::string>(record2.at(4)) !=
+                std::any_cast<std::string>(record1.at(4))) {
+          ++failures[t];
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int failure : failures) {
+    EXPECT_EQ(0, failure);
+  }
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordParallelBatch) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  std::vector<std::vector<std::any>> records(3000, record1);
+  for (size_t i = 0; i < records.size(); ++i) {
+    records[i].at(0) = static_cast<int32_t>(i);
+  }
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  ParallelOptions options;
+  options.thread_count = 4;
+  options.chunk_size = 64;
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  ASSERT_EQ(0, re.EncodeBatch('r', records, keys, values, options));
+  ASSERT_EQ(records.size(), keys.size());
+  ASSERT_EQ(records.size(), values.size());
+
+  std::vector<KeyValue> key_values(records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    std::string key, value;
+    re.Encode('r', records[i], key, value);
+    EXPECT_EQ(key, keys[i]);
+    EXPECT_EQ(value, values[i]);
+    key_values[i].Set(keys[i], values[i]);
+  }
+
+  std::vector<std::vector<std::any>> decoded;
+  ASSERT_EQ(0, rd.DecodeBatch(key_values.data(), key_values.size(), decoded, options));
+  ASSERT_EQ(records.size(), decoded.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    EXPECT_EQ(static_cast<int32_t>(i), std::any_cast<int32_t>(decoded[i].at(0)));
+    EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(decoded[i].at(9)));
+  }
+
+  // one bad row fails the batch, the rest still decode.
+  std::string bad_key = keys[100];
+  bad_key[1] ^= 0x1;
+  key_values[100].SetKey(bad_key);
+  EXPECT_EQ(-1, rd.DecodeBatch(key_values.data(), key_values.size(), decoded, options));
+  EXPECT_EQ(2999, std::any_cast<int32_t>(decoded[2999].at(0)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordStaticCodec) {
+  using Codec = StaticRecordCodec<
+      Column<int64_t, Key>, Column<std::string, Key, Nullable>,
+      Column<double, Key, Nullable>, Column<std::string, Value, Nullable>,
+      Column<int32_t, Value>, Column<bool, Value, Nullable>,
+      Column<float, Value>, Column<std::vector<int64_t>, Value, Nullable>,
+      Column<std::vector<std::string>, Value>, Column<std::vector<bool>, Value>,
+      Column<std::vector<float>, Value, Nullable>>;
+
+  Codec codec(2, 7L, this->le);
+  Codec::Row row1{-5L, "static key string", std::nullopt, "value",
+                  -20, std::nullopt, 1.25f, std::vector<int64_t>{1, -2, 3},
+                  std::vector<std::string>{"a", "", "bc"},
+                  std::vector<bool>{true, false}, std::nullopt};
+  std::string key1, value1;
+  ASSERT_EQ(0, codec.Encode('r', row1, key1, value1));
+
+  auto schemas = Codec::MakeSchemas();
+  std::vector<std::any> record{int64_t(-5), std::string("static key string"),
+                               std::any(), std::string("value"), int32_t(-20),
+                               std::any(), 1.25f, std::vector<int64_t>{1, -2, 3},
+                               std::vector<std::string>{"a", "", "bc"},
+                               std::vector<bool>{true, false}, std::any()};
+  RecordEncoderV2 re(2, schemas, 7L, this->le);
+  std::string key2, value2;
+  ASSERT_EQ(0, re.Encode('r', record, key2, value2));
+  EXPECT_EQ(key2, key1);
+  EXPECT_EQ(value2, value1);
+
+  Codec::Row row2;
+  ASSERT_EQ(0, codec.Decode(key1, value1, row2));
+  EXPECT_EQ(row1, row2);
+
+  RecordDecoderV2 rd(2, schemas, 7L, this->le);
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(key1, value1, decoded));
+  EXPECT_EQ("value", std::any_cast<std::string>(decoded.at(3)));
+  EXPECT_FALSE(decoded.at(5).has_value());
+
+  // a row of an older version without the last columns.
+  auto old_schemas = Codec::MakeSchemas();
+  old_schemas.resize(9);
+  RecordEncoderV2 old_re(1, old_schemas, 7L, this->le);
+  std::vector<std::any> old_record(record.begin(), record.begin() + 9);
+  std::string old_key, old_value;
+  ASSERT_EQ(0, old_re.Encode('r', old_record, old_key, old_value));
+  Codec::Row row3;
+  EXPECT_EQ(-1, codec.Decode(old_key, old_value, row3));
+  using OldCodec = StaticRecordCodec<
+      Column<int64_t, Key>, Column<std::string, Key, Nullable>,
+      Column<double, Key, Nullable>, Column<std::string, Value, Nullable>,
+      Column<int32_t, Value>, Column<bool, Value, Nullable>,
+      Column<float, Value>, Column<std::vector<int64_t>, Value, Nullable>,
+      Column<std::vector<std::string>, Value>,
+      Column<std::vector<bool>, Value, Nullable>,
+      Column<std::vector<float>, Value, Nullable>>;
+  OldCodec old_codec(2, 7L, this->le);
+  OldCodec::Row row4;
+  ASSERT_EQ(0, old_codec.Decode(old_key, old_value, row4));
+  EXPECT_EQ(std::get<8>(row1), std::get<8>(row4));
+  EXPECT_FALSE(std::get<9>(row4).has_value());
+
+  // keys keep their order.
+  Codec::Row row5 = row1;
+  std::get<0>(row5) = 3L;
+  std::string key5;
+  codec.EncodeKey('r', row5, key5);
+  EXPECT_LT(key1, key5);
+
+  // only the plain layout is read.
+  re.SetNullBitmap(true);
+  ASSERT_EQ(0, re.Encode('r', record, key2, value2));
+  EXPECT_EQ(-1, codec.DecodeValue(value2, row2));
+  Codec newer(1, 7L, this->le);
+  EXPECT_EQ(-1, newer.DecodeValue(value1, row2));
+  Codec other_table(2, 8L, this->le);
+  EXPECT_EQ(-1, other_table.DecodeKey(key1, row2));
+}
+
+TEST_F(DingoSerialTest, recordColumnDescriptors) {
+  using Codec = StaticRecordCodec<
+      Column<int64_t, Key>, Column<std::string, Key, Nullable>,
+      Column<bool, Key, Nullable>, Column<int32_t, Value, Nullable>,
+      Column<std::string, Value>, Column<std::vector<double>, Value>>;
+  auto schemas = Codec::MakeSchemas();
+  schemas.push_back(nullptr);
+
+  auto columns = CompileColumnDescriptors(schemas);
+  ASSERT_EQ(schemas.size(), columns.size());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(schemas[i].get(), columns[i].schema);
+    EXPECT_EQ(schemas[i]->GetType(), columns[i].type);
+    EXPECT_EQ(schemas[i]->GetIndex(), columns[i].index);
+    EXPECT_EQ(i < 3, columns[i].is_key);
+    EXPECT_EQ(schemas[i]->AllowNull(), columns[i].allow_null);
+  }
+  EXPECT_EQ(nullptr, columns[6].schema);
+
+  EXPECT_EQ(8, columns[0].key_length);
+  EXPECT_EQ(0, columns[1].key_length);
+  EXPECT_EQ(2, columns[2].key_length);
+  EXPECT_EQ(4, columns[3].value_length);
+  EXPECT_EQ(0, columns[4].value_length);
+  EXPECT_EQ(0, columns[5].value_length);
+
+  std::vector<int> slots;
+  for (const auto& column : columns) {
+    slots.push_back(column.value_slot);
+  }
+  EXPECT_EQ((std::vector<int>{-1, -1, -1, 0, 1, 2, -1}), slots);
+
+  // fixed keys are skipped by their length, the others by their schema.
+  Codec codec(1, 3L, this->le);
+  Codec::Row row{9L, std::string("key"), true, 1, "a", {1.0}};
+  std::string key, value;
+  ASSERT_EQ(0, codec.Encode('r', row, key, value));
+  BufView key_buf(key, this->le);
+  key_buf.Skip(9);
+  for (int i = 0; i < 3; ++i) {
+    columns[i].SkipKey(key_buf);
+  }
+  EXPECT_EQ(key.size() - 4, key_buf.ReadOffset());
+
+  // a null schema between the columns decodes like before.
+  RecordDecoderV2 rd(1, schemas, 3L, this->le);
+  std::vector<std::any> record;
+  ASSERT_EQ(0, rd.Decode(key, value, record));
+  EXPECT_EQ("key", std::any_cast<std::string>(record.at(1)));
+  EXPECT_EQ(1, std::any_cast<int32_t>(record.at(3)));
+}
+
+TEST_F(DingoSerialTest, recordKeyComparator) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+  KeyComparator comparator(schemas, this->le);
+  EXPECT_EQ(4, comparator.KeyColumnCount());
+
+  auto record1 = GetRecord();
+  std::string key1;
+  re.EncodeKey('r', record1, key1);
+
+  // the prefix ranges are the keys of EncodeKeyPrefix.
+  for (int count = 0; count <= 5; ++count) {
+    std::string prefix;
+    re.EncodeKeyPrefix('r', record1, count, prefix);
+    EXPECT_EQ(prefix, comparator.Prefix(key1, count));
+    EXPECT_EQ(prefix.substr(9), comparator.Columns(key1, count));
+  }
+
+  // same id and name, another gender and score.
+  auto record2 = record1;
+  record2.at(2) = std::string("m");
+  record2.at(3) = int64_t(-3);
+  std::string key2;
+  re.EncodeKey('r', record2, key2);
+  EXPECT_EQ(0, comparator.Compare(key1, key2, 0));
+  EXPECT_EQ(0, comparator.Compare(key1, key2, 2));
+  EXPECT_GT(0, comparator.Compare(key1, key2, 3));
+  EXPECT_LT(0, comparator.Compare(key2, key1));
+
+  // a longer name that starts with the other.
+  auto record3 = record1;
+  record3.at(1) = std::string("tn") + std::string(20, '\0');
+  std::string key3;
+  re.EncodeKey('r', record3, key3);
+  EXPECT_GT(0, comparator.Compare(key1, key3, 2));
+  EXPECT_EQ(0, comparator.Compare(key1, key3, 1));
+
+  // ordering agrees with the decoded columns.
+  std::vector<std::string> keys;
+  for (int64_t score : {5L, -7L, 0L, 1L << 40}) {
+    for (const char* name : {"b", "", "ab", "a"}) {
+      auto record = record1;
+      record.at(1) = std::string(name);
+      record.at(3) = score;
+      keys.emplace_back();
+      re.EncodeKey('r', record, keys.back());
+    }
+  }
+  std::sort(keys.begin(), keys.end(),
+            [&](const std::string& lhs, const std::string& rhs) {
+              return comparator.Compare(lhs, rhs) < 0;
+            });
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  for (size_t i = 1; i < keys.size(); ++i) {
+    std::vector<std::any> lhs, rhs;
+    ASSERT_EQ(0, rd.DecodeKey(keys[i - 1], lhs));
+    ASSERT_EQ(0, rd.DecodeKey(keys[i], rhs));
+    auto lhs_columns = std::make_pair(std::any_cast<std::string>(lhs.at(1)),
+                                      std::any_cast<int64_t>(lhs.at(3)));
+    auto rhs_columns = std::make_pair(std::any_cast<std::string>(rhs.at(1)),
+                                      std::any_cast<int64_t>(rhs.at(3)));
+    EXPECT_LT(lhs_columns, rhs_columns);
+  }
+
+  EXPECT_THROW(comparator.Prefix(key1.substr(0, 12), 2), std::runtime_error);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordKeyHasher) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+  auto record1 = GetRecord();
+  std::string key1;
+  re.EncodeKey('r', record1, key1);
+
+  EXPECT_THROW(KeyHasher(schemas, {4}), std::runtime_error);
+
+  // id and score are of fixed length, name is not.
+  KeyHasher fixed_hasher(schemas, {0});
+  KeyHasher hasher(schemas, {0, 3});
+  KeyHasher name_hasher(schemas, {1});
+
+  // the other columns do not count, nor does the table.
+  auto record2 = record1;
+  record2.at(2) = std::string("other gender");
+  record2.at(4) = std::string("other address");
+  std::string key2;
+  RecordEncoderV2 other_re(0, schemas, 9L, this->le);
+  other_re.EncodeKey('t', record2, key2);
+  EXPECT_EQ(fixed_hasher.Hash(key1), fixed_hasher.Hash(key2));
+  EXPECT_EQ(hasher.Hash(key1), hasher.Hash(key2));
+  EXPECT_EQ(name_hasher.Hash(key1), name_hasher.Hash(key2));
+
+  record2.at(3) = int64_t(1);
+  record2.at(1) = std::string("other name");
+  key2.clear();
+  other_re.EncodeKey('t', record2, key2);
+  EXPECT_EQ(fixed_hasher.Hash(key1), fixed_hasher.Hash(key2));
+  EXPECT_NE(hasher.Hash(key1), hasher.Hash(key2));
+  EXPECT_NE(name_hasher.Hash(key1), name_hasher.Hash(key2));
+
+  // the same columns in a table of other key columns.
+  auto narrow_score = std::make_shared<DingoSchema<int64_t>>();
+  narrow_score->SetIndex(0);
+  narrow_score->SetIsKey(true);
+  auto narrow_name = std::make_shared<DingoSchema<std::string>>();
+  narrow_name->SetIndex(1);
+  narrow_name->SetIsKey(true);
+  std::vector<BaseSchemaPtr> narrow_schemas{narrow_score, narrow_name};
+  RecordEncoderV2 narrow_re(0, narrow_schemas, 0L, this->le);
+  std::string narrow_key;
+  narrow_re.EncodeKey('r', {record1.at(3), record1.at(1)}, narrow_key);
+  KeyHasher score_hasher(schemas, {3});
+  EXPECT_EQ(score_hasher.Hash(key1),
+            KeyHasher(narrow_schemas, {0}).Hash(narrow_key));
+  EXPECT_EQ(name_hasher.Hash(key1),
+            KeyHasher(narrow_schemas, {1}).Hash(narrow_key));
+
+  std::vector<std::string_view> keys{key1, key2};
+  std::vector<uint64_t> hashes(2);
+  hasher.HashBatch(keys.data(), 2, hashes.data());
+  EXPECT_EQ(hasher.Hash(key1), hashes[0]);
+  EXPECT_EQ(hasher.Hash(key2), hashes[1]);
+  EXPECT_THROW(hasher.Hash(key1.substr(0, 20)), std::runtime_error);
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordKeyPrefixFilter) {
+  using Codec = StaticRecordCodec<
+      Column<int64_t, Key>, Column<std::string, Key, Nullable>,
+      Column<int32_t, Key>, Column<std::string, Value>>;
+  auto schemas = Codec::MakeSchemas();
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+
+  EXPECT_THROW(KeyPrefixFilterBuilder(schemas, 0, 10), std::runtime_error);
+  EXPECT_THROW(KeyPrefixFilterBuilder(schemas, 4, 10), std::runtime_error);
+
+  // 1000 prefixes of 2 columns, 5 keys each.
+  auto record = [](int i, int j) {
+    return std::vector<std::any>{
+        int64_t(i / 10), i % 10 == 0 ? std::any() : std::any("user" + std::to_string(i)),
+        int32_t(j), std::string("value")};
+  };
+  KeyPrefixFilterBuilder builder(schemas, 2, 1000);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      std::string key;
+      re.EncodeKey('r', record(i, j), key);
+      builder.AddKey(key);
+      keys.push_back(key);
+    }
+  }
+
+  std::string data = builder.Data();
+  KeyPrefixFilter filter(schemas, 2, data);
+  for (const auto& key : keys) {
+    EXPECT_TRUE(filter.MayContainKey(key));
+  }
+  int positives = 0;
+  for (int i = 1000; i < 3000; ++i) {
+    std::string prefix;
+    re.EncodeKeyPrefix('r', record(i, 0), 2, prefix);
+    positives += filter.MayContainPrefix(prefix);
+
+    std::string key;
+    re.EncodeKey('r', record(i, 0), key);
+    EXPECT_EQ(filter.MayContainPrefix(prefix), filter.MayContainKey(key));
+  }
+  EXPECT_LT(positives, 2000 * 0.03);
+
+  // a lookup by prefix matches the keys of the prefix.
+  std::string prefix;
+  re.EncodeKeyPrefix('r', record(7, 3), 2, prefix);
+  EXPECT_TRUE(filter.MayContainPrefix(prefix));
+  EXPECT_THROW(filter.MayContainPrefix("r"), std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordAggregate) {
+  using Codec = StaticRecordCodec<
+      Column<int64_t, Key>, Column<int32_t, Value, Nullable>,
+      Column<int64_t, Value>, Column<float, Value, Nullable>,
+      Column<double, Value>, Column<int64_t, Value, Nullable>,
+      Column<std::string, Value, Nullable>>;
+
+  std::vector<std::vector<std::any>> records;
+  for (int i = 0; i < 1000; ++i) {
+    records.push_back(
+        {int64_t(i), i % 3 == 0 ? std::any() : std::any(int32_t(i - 500)),
+         int64_t(i) << 33, i % 7 == 0 ? std::any() : std::any(i * 0.25f),
+         -i * 1.5, i % 2 == 0 ? std::any() : std::any(int64_t(-i)),
+         i % 5 == 0 ? std::any() : std::any(std::string("s"))});
+  }
+
+  // by decoding every row.
+  std::vector<ColumnAggregate> expected(7);
+  for (const auto& record : records) {
+    for (int c = 1; c < 7; ++c) {
+      auto& agg = expected[c];
+      const auto& data = record[c];
+      if (!data.has_value()) {
+        agg.null_count++;
+        continue;
+      }
+      agg.count++;
+      if (data.type() == typeid(int32_t) || data.type() == typeid(int64_t)) {
+        int64_t v = data.type() == typeid(int32_t) ? std::any_cast<int32_t>(data)
+                                                   : std::any_cast<int64_t>(data);
+        agg.int_sum += v;
+        agg.int_min = std::min(agg.int_min, v);
+        agg.int_max = std::max(agg.int_max, v);
+      } else if (data.type() != typeid(std::string)) {
+        double v = data.type() == typeid(float) ? std::any_cast<float>(data)
+                                                : std::any_cast<double>(data);
+        agg.sum += v;
+        agg.min = std::min(agg.min, v);
+        agg.max = std::max(agg.max, v);
+      }
+    }
+  }
+
+  for (int layout = 0; layout < 5; ++layout) {
+    auto schemas = Codec::MakeSchemas();
+    std::static_pointer_cast<DingoSchema<int64_t>>(schemas.at(5))->SetVarint(true);
+    RecordEncoderV2 re(1, schemas, 3L, this->le);
+    re.SetCompactValueHeader(layout == 1);
+    re.SetNullBitmap(layout == 2);
+    re.SetStaticOffsets(layout == 3);
+    if (layout == 4) {
+      re.SetCompression(CompressionType::kZlib, 0);
+    }
+    std::vector<std::string> keys, values;
+    re.EncodeBatch('r', records, keys, values);
+    std::vector<KeyValue> key_values(records.size());
+    std::vector<std::string_view> views;
+    for (size_t i = 0; i < records.size(); ++i) {
+      key_values[i].Set(keys[i], values[i]);
+      views.push_back(values[i]);
+    }
+
+    RecordDecoderV2 rd(1, schemas, 3L, this->le);
+    for (int c = 1; c < 7; ++c) {
+      ColumnAggregate agg;
+      ASSERT_EQ(0, rd.Aggregate(key_values.data(), key_values.size(), c, agg));
+      EXPECT_EQ(expected[c].count, agg.count) << layout << " " << c;
+      EXPECT_EQ(expected[c].null_count, agg.null_count);
+      EXPECT_EQ(expected[c].int_sum, agg.int_sum);
+      EXPECT_EQ(expected[c].int_min, agg.int_min);
+      EXPECT_EQ(expected[c].int_max, agg.int_max);
+      EXPECT_DOUBLE_EQ(expected[c].sum, agg.sum);
+      EXPECT_EQ(expected[c].min, agg.min);
+      EXPECT_EQ(expected[c].max, agg.max);
+
+      // two halves merge into the whole.
+      ColumnAggregate low, high;
+      ASSERT_EQ(0, rd.Aggregate(views.data(), 600, c, low));
+      ASSERT_EQ(0, rd.Aggregate(views.data() + 600, views.size() - 600, c, high));
+      low.Merge(high);
+      EXPECT_EQ(agg.count, low.count);
+      EXPECT_EQ(agg.int_sum, low.int_sum);
+      EXPECT_DOUBLE_EQ(agg.sum, low.sum);
+      EXPECT_EQ(agg.max, low.max);
+    }
+
+    ColumnAggregate agg;
+    EXPECT_EQ(-1, rd.Aggregate(views.data(), views.size(), 0, agg));
+    EXPECT_EQ(-1, rd.Aggregate(views.data(), views.size(), 7, agg));
+    RecordDecoderV2 other_table(1, schemas, 4L, this->le);
+    EXPECT_EQ(-1, other_table.Aggregate(key_values.data(), key_values.size(), 1, agg));
+  }
+}
+
+TEST_F(DingoSerialTest, recordCodecStats) {
+  auto schemas = StaticRecordCodec<Column<int64_t, Key>, Column<int32_t, Value>,
+                                   Column<std::string, Value, Nullable>,
+                                   Column<double, Value>>::MakeSchemas();
+  dingodb::serialV2::CodecStats stats;
+  RecordEncoderV2 re(1, schemas, 3L, this->le);
+  RecordDecoderV2 rd(1, schemas, 3L, this->le);
+  re.SetStats(&stats);
+  rd.SetStats(&stats);
+  stats.SetLatencySampling(1);
+
+  std::vector<std::vector<std::any>> records;
+  for (int i = 0; i < 10; ++i) {
+    records.push_back({int64_t(i), int32_t(i), std::string("name"), i * 0.5});
+  }
+  std::string key, value;
+  re.Encode('r', records[0], key, value);
+  std::vector<std::string> keys, values;
+  re.EncodeBatch('r', records, keys, values);
+
+  std::vector<std::any> record;
+  ASSERT_EQ(0, rd.Decode(key, value, record));
+  std::unordered_map<int, int> column_indexes_serial{{2, 0}};
+  ASSERT_EQ(0, rd.Decode(key, value, column_indexes_serial, record));
+  ASSERT_EQ(0, rd.DecodeKey(key, record));
+  // a value of a newer schema version.
+  std::string newer_value;
+  RecordEncoderV2(2, schemas, 3L, this->le).EncodeValue(records[0], newer_value);
+  EXPECT_EQ(-1, rd.Decode(key, newer_value, record));
+
+  auto snapshot = stats.Snapshot();
+#if defined(DINGO_SERIAL_CODEC_STATS)
+  size_t bytes = key.size() + value.size();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    bytes += keys[i].size() + values[i].size();
+  }
+  EXPECT_EQ(11, snapshot.rows_encoded);
+  EXPECT_EQ(bytes, snapshot.bytes_encoded);
+  EXPECT_EQ(3, snapshot.rows_decoded);
+  EXPECT_EQ(2 * (key.size() + value.size()) + key.size(),
+            snapshot.bytes_decoded);
+  EXPECT_EQ(4 + 1 + 1, snapshot.columns_decoded);
+  EXPECT_EQ(0 + 3 + 3, snapshot.columns_skipped);
+  EXPECT_EQ(1, snapshot.decode_failures);
+  // every row of Encode and Decode was timed, not those of EncodeBatch.
+  EXPECT_EQ(1, snapshot.encode_latency.Count());
+  EXPECT_EQ(3, snapshot.decode_latency.Count());
+  EXPECT_GT(snapshot.decode_latency.Max(), 0);
+#else
+  // compiled out, nothing is counted.
+  EXPECT_EQ(0, snapshot.rows_encoded);
+  EXPECT_EQ(0, snapshot.rows_decoded);
+  EXPECT_EQ(0, snapshot.decode_failures);
+  EXPECT_EQ(0, snapshot.decode_latency.Count());
+#endif
+}
+
+TEST_F(DingoSerialTest, recordScanDecoder) {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetAllowNull(true);
+  auto scores = std::make_shared<DingoSchema<std::vector<int32_t>>>();
+  scores->SetIndex(2);
+  scores->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, name, scores};
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  auto rd = std::make_shared<RecordDecoderV2>(1, schemas, 5L, this->le);
+
+  // longest row first, the others fit into its storage.
+  std::vector<std::pair<std::string, std::string>> rows;
+  for (int i = 0; i < 6; ++i) {
+    std::any name_value;
+    if (i != 3) {
+      name_value = std::string(40 - i, 'a' + i);
+    }
+    std::vector<int32_t> score_values(10 - i, i);
+    std::string key, value;
+    re.Encode('r', {int64_t(i), name_value, score_values}, key, value);
+    rows.emplace_back(key, value);
+  }
+
+  struct RowIterator {
+    const std::vector<std::pair<std::string, std::string>>* rows;
+    size_t i{0};
+    bool Valid() const { return i < rows->size(); }
+    void Next() { ++i; }
+    const std::string& key() const { return (*rows)[i].first; }
+    const std::string& value() const { return (*rows)[i].second; }
+  };
+
+  std::unordered_map<int, int> column_indexes_serial{{1, 0}, {2, 1}, {0, 2}};
+  ScanDecoder scan(rd, column_indexes_serial);
+  ASSERT_EQ(0, scan.Decode(rows[0].first, rows[0].second));
+  const char* name_data = std::any_cast<std::string>(&scan.Record()[0])->data();
+  const int32_t* scores_data =
+      std::any_cast<std::vector<int32_t>>(&scan.Record()[1])->data();
+
+  RowIterator iter{&rows};
+  int64_t expected = 0;
+  long decoded = scan.Scan(iter, [&](const std::vector<std::any>& record) {
+    EXPECT_EQ(3, record.size());
+    EXPECT_EQ(expected, std::any_cast<int64_t>(record[2]));
+    if (expected == 3) {
+      EXPECT_FALSE(record[0].has_value());
+    } else {
+      const auto& str = std::any_cast<const std::string&>(record[0]);
+      EXPECT_EQ(std::string(40 - expected, 'a' + expected), str);
+      // the null row put the storage aside, the string of row 0 is reused.
+      EXPECT_EQ(name_data, str.data());
+    }
+    const auto& list = std::any_cast<const std::vector<int32_t>&>(record[1]);
+    EXPECT_EQ(std::vector<int32_t>(10 - expected, expected), list);
+    EXPECT_EQ(scores_data, list.data());
+    return ++expected < 5;
+  });
+  EXPECT_EQ(5, decoded);
+  EXPECT_EQ(4, iter.i);
+
+  // a row of other schemas fails the scan at it.
+  std::string other_value;
+  RecordEncoderV2(2, schemas, 5L, this->le)
+      .EncodeValue({int64_t(9), std::any(), std::any()}, other_value);
+  rows[5].second = other_value;
+  iter.i = 5;
+  EXPECT_EQ(-1, scan.Scan(iter, [](const std::vector<std::any>&) { return true; }));
+  EXPECT_EQ(5, iter.i);
+}
+
+TEST_F(DingoSerialTest, recordColumnValue) {
+  using dingodb::serialV2::ColumnValue;
+  using dingodb::serialV2::FromAny;
+  using dingodb::serialV2::ToAny;
+
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto code = std::make_shared<DingoSchema<std::string>>();
+  code->SetIndex(1);
+  code->SetIsKey(true);
+  auto age = std::make_shared<DingoSchema<int32_t>>();
+  age->SetIndex(2);
+  age->SetAllowNull(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(3);
+  name->SetAllowNull(true);
+  auto weights = std::make_shared<DingoSchema<std::vector<double>>>();
+  weights->SetIndex(4);
+  weights->SetAllowNull(true);
+  auto tags = std::make_shared<DingoSchema<std::vector<std::string>>>();
+  tags->SetIndex(5);
+  tags->SetAllowNull(true);
+  auto flag = std::make_shared<DingoSchema<bool>>();
+  flag->SetIndex(6);
+  flag->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, code, age, name, weights, tags, flag};
+
+  std::vector<std::any> record{int64_t(42),
+                               std::string("key-42"),
+                               int32_t(7),
+                               std::string("a name long enough for the heap"),
+                               std::vector<double>{1.5, -2.5},
+                               std::vector<std::string>{"x", "yz"},
+                               std::any()};
+  std::vector<ColumnValue> values = FromAny(record);
+  ASSERT_EQ(7, values.size());
+  EXPECT_EQ(42, std::get<int64_t>(values[0]));
+  EXPECT_EQ(schemas[3]->GetType() + 1, values[3].index());
+  EXPECT_TRUE(dingodb::serialV2::IsNull(values[6]));
+
+  // every value layout writes the same bytes for both forms.
+  for (int layout = 0; layout < 4; ++layout) {
+    RecordEncoderV2 re(1, schemas, 9L, this->le);
+    re.SetCompactValueHeader(layout == 1);
+    re.SetNullBitmap(layout == 2);
+    re.SetStaticOffsets(layout == 3);
+
+    std::string key1, value1, key2, value2;
+    ASSERT_EQ(0, re.Encode('r', record, key1, value1));
+    ASSERT_EQ(0, re.Encode('r', values, key2, value2));
+    EXPECT_EQ(key1, key2);
+    EXPECT_EQ(value1, value2);
+    EXPECT_EQ(re.EncodedSize(record), re.EncodedSize(values));
+
+    RecordDecoderV2 rd(1, schemas, 9L, this->le);
+    std::vector<ColumnValue> decoded;
+    ASSERT_EQ(0, rd.Decode(key2, value2, decoded));
+    EXPECT_EQ(values, decoded);
+  }
+
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  std::string key, value;
+  re.Encode('r', values, key, value);
+
+  // the projected decode, and the storage of the record reused.
+  auto plan = rd.NewDecodePlan({{3, 0}, {0, 1}, {5, 2}});
+  std::vector<ColumnValue> projected;
+  ASSERT_EQ(0, rd.Decode(key, value, plan, projected));
+  ASSERT_EQ(3, projected.size());
+  EXPECT_EQ(values[3], projected[0]);
+  EXPECT_EQ(values[0], projected[1]);
+  EXPECT_EQ(values[5], projected[2]);
+  const char* name_data = std::get<std::string>(projected[0]).data();
+  const std::string* tags_data =
+      std::get<std::vector<std::string>>(projected[2]).data();
+  ASSERT_EQ(0, rd.Decode(key, value, plan, projected));
+  EXPECT_EQ(name_data, std::get<std::string>(projected[0]).data());
+  EXPECT_EQ(tags_data, std::get<std::vector<std::string>>(projected[2]).data());
+
+  // the std::any adapters.
+  std::vector<std::any> back = ToAny(values);
+  EXPECT_EQ(std::any_cast<std::string>(record[3]),
+            std::any_cast<std::string>(back[3]));
+  EXPECT_FALSE(back[6].has_value());
+  EXPECT_THROW(FromAny(std::any('c')), std::runtime_error);
+
+  // a newer schema version is rejected as for std::any records.
+  std::string newer_value;
+  RecordEncoderV2(2, schemas, 9L, this->le).EncodeValue(values, newer_value);
+  EXPECT_EQ(-1, rd.Decode(key, newer_value, projected));
+}
+
+TEST_F(DingoSerialTest, recordEncodeColumnar) {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto code = std::make_shared<DingoSchema<std::string>>();
+  code->SetIndex(1);
+  code->SetIsKey(true);
+  code->SetAllowNull(true);
+  auto age = std::make_shared<DingoSchema<int32_t>>();
+  age->SetIndex(2);
+  age->SetAllowNull(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(3);
+  name->SetAllowNull(true);
+  auto weights = std::make_shared<DingoSchema<std::vector<double>>>();
+  weights->SetIndex(4);
+  weights->SetAllowNull(true);
+  auto tags = std::make_shared<DingoSchema<std::vector<std::string>>>();
+  tags->SetIndex(5);
+  tags->SetAllowNull(true);
+  auto flag = std::make_shared<DingoSchema<bool>>();
+  flag->SetIndex(6);
+  flag->SetAllowNull(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(7);
+  std::vector<BaseSchemaPtr> schemas{id,      code, age,  name,
+                                     weights, tags, flag, score};
+
+  // the same rows as records and as columns.
+  const size_t rows = 20;
+  std::vector<std::vector<std::any>> records;
+  std::vector<ColumnVector> vectors;
+  for (const auto& schema : schemas) {
+    vectors.emplace_back(schema->GetType());
+  }
+  for (size_t i = 0; i < rows; ++i) {
+    bool null = i % 3 == 1;
+    std::vector<std::any> record(schemas.size());
+    record[0] = int64_t(i) - 5;
+    vectors[0].Append(int64_t(i) - 5);
+    if (null) {
+      for (int col = 1; col < 7; ++col) {
+        vectors[col].AppendNull();
+      }
+    } else {
+      record[1] = std::string(i, 'k');
+      vectors[1].AppendString(std::string(i, 'k'));
+      record[2] = int32_t(i * 7);
+      vectors[2].Append(int32_t(i * 7));
+      record[3] = "name-" + std::to_string(i);
+      vectors[3].AppendString("name-" + std::to_string(i));
+      std::vector<double> weight_list(i % 4, i * 0.5);
+      record[4] = weight_list;
+      vectors[4].AppendList(weight_list);
+      std::vector<std::string> tag_list(i % 3, std::to_string(i));
+      record[5] = tag_list;
+      vectors[5].AppendStringList(tag_list);
+      record[6] = i % 2 == 0;
+      vectors[6].Append(i % 2 == 0);
+    }
+    record[7] = i * 1.25;
+    vectors[7].Append(i * 1.25);
+    records.push_back(std::move(record));
+  }
+  std::vector<ColumnArray> columns;
+  for (const auto& vector : vectors) {
+    columns.push_back(vector.Array());
+  }
+
+  // every value layout writes the bytes of the row encode.
+  EncodedBatch batch;
+  for (int layout = 0; layout < 5; ++layout) {
+    RecordEncoderV2 re(1, schemas, 9L, this->le);
+    re.SetCompactValueHeader(layout == 1);
+    re.SetNullBitmap(layout == 2);
+    re.SetStaticOffsets(layout == 3);
+    if (layout == 4) {
+      re.SetCompression(CompressionType::kZlib, 0);
+    }
+
+    ASSERT_EQ(0, re.EncodeBatch('r', columns, rows, batch));
+    ASSERT_EQ(rows, batch.Size());
+    size_t arena_size = 0;
+    for (size_t i = 0; i < rows; ++i) {
+      std::string key, value;
+      ASSERT_EQ(0, re.Encode('r', records[i], key, value));
+      EXPECT_EQ(key, batch.Key(i)) << layout << " " << i;
+      EXPECT_EQ(value, batch.Value(i)) << layout << " " << i;
+      EXPECT_EQ(batch.Arena().data() + arena_size, batch.Key(i).data());
+      arena_size += key.size() + value.size();
+    }
+    EXPECT_EQ(arena_size, batch.Arena().size());
+  }
+
+  // an empty batch, and a column of another type.
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  ASSERT_EQ(0, re.EncodeBatch('r', columns, 0, batch));
+  EXPECT_EQ(0, batch.Size());
+  EXPECT_TRUE(batch.Arena().empty());
+
+  ColumnVector wrong(BaseSchema::kLong);
+  columns[2] = wrong.Array();
+  EXPECT_EQ(-1, re.EncodeBatch('r', columns, rows, batch));
+  columns.pop_back();
+  EXPECT_EQ(-1, re.EncodeBatch('r', columns, rows, batch));
+}
+
+TEST_F(DingoSerialTest, recordArenaBatch) {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetAllowNull(true);
+  auto tags = std::make_shared<DingoSchema<std::vector<int32_t>>>();
+  tags->SetIndex(2);
+  tags->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, name, tags};
+
+  std::vector<std::vector<std::any>> records;
+  for (int i = 0; i < 10; ++i) {
+    std::vector<std::any> record{int64_t(i), std::any(), std::any()};
+    if (i % 4 != 3) {
+      record[1] = "row " + std::to_string(i);
+      record[2] = std::vector<int32_t>(i, i);
+    }
+    records.push_back(std::move(record));
+  }
+
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  EncodedBatch rows;
+  ASSERT_EQ(0, re.EncodeBatch('r', records, rows));
+  ASSERT_EQ(records.size(), rows.Size());
+  std::vector<KeyValue> key_values;
+  for (size_t i = 0; i < records.size(); ++i) {
+    std::string key, value;
+    re.Encode('r', records[i], key, value);
+    EXPECT_EQ(key, rows.Key(i));
+    EXPECT_EQ(value, rows.Value(i));
+    key_values.emplace_back(key, value);
+  }
+  EXPECT_EQ(rows.Key(0).data(), rows.Arena().data());
+  EXPECT_EQ(rows.Value(rows.Size() - 1).data() +
+                rows.Value(rows.Size() - 1).size(),
+            rows.Arena().data() + rows.Arena().size());
+
+  // decoded from the arena as from KeyValues.
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  auto plan = rd.NewDecodePlan({{2, 0}, {1, 1}, {0, 2}});
+  ColumnBatch from_rows;
+  ColumnBatch from_key_values;
+  ASSERT_EQ(0, rd.DecodeBatch(rows, plan, from_rows));
+  ASSERT_EQ(0, rd.DecodeBatch(key_values, plan, from_key_values));
+  ASSERT_EQ(records.size(), from_rows.NumRows());
+  for (size_t r = 0; r < records.size(); ++r) {
+    ASSERT_EQ(r % 4 == 3, from_rows.Column(0).IsNull(r));
+    ASSERT_EQ(r % 4 == 3, from_rows.Column(1).IsNull(r));
+    EXPECT_EQ(int64_t(r), from_rows.Column(2).Get<int64_t>(r));
+    if (r % 4 == 3) {
+      continue;
+    }
+    EXPECT_EQ(std::any_cast<std::string>(records[r][1]),
+              from_rows.Column(1).GetString(r));
+    EXPECT_EQ(from_key_values.Column(1).GetString(r),
+              from_rows.Column(1).GetString(r));
+    ASSERT_EQ(r, from_rows.Column(0).ListSize(r));
+    for (size_t i = 0; i < r; ++i) {
+      EXPECT_EQ(int32_t(r), from_rows.Column(0).GetListElement<int32_t>(r, i));
+    }
+  }
+
+  // the batch is encoded into again in place.
+  records.resize(2);
+  ASSERT_EQ(0, re.EncodeBatch('r', records, rows));
+  ASSERT_EQ(2, rows.Size());
+  EXPECT_EQ(key_values[1].GetValue(), rows.Value(1));
+
+  rows.Clear();
+  EXPECT_EQ(0, rows.Size());
+  ASSERT_EQ(0, rd.DecodeBatch(rows, plan, from_rows));
+  EXPECT_EQ(0, from_rows.NumRows());
+}
+
+TEST_F(DingoSerialTest, recordEncodeAndSortKeys) {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetIsKey(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(2);
+  std::vector<BaseSchemaPtr> schemas{id, name, score};
+
+  // ids repeat with names in another order, the key order is (id, name).
+  std::vector<std::vector<std::any>> records;
+  for (int i = 0; i < 300; ++i) {
+    int64_t row_id = (i * 37) % 50 - 25;
+    std::string row_name(1 + i % 5, static_cast<char>('a' + i % 7));
+    records.push_back({row_id, row_name, i * 0.5});
+  }
+
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  EncodedBatch keys;
+  std::vector<uint32_t> order;
+  ParallelOptions options;
+  options.thread_count = 2;
+  ASSERT_EQ(0, re.EncodeAndSortKeys('r', records, keys, order, options));
+  ASSERT_EQ(records.size(), keys.Size());
+  ASSERT_EQ(records.size(), order.size());
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    std::string key;
+    re.EncodeKey('r', records[i], key);
+    EXPECT_EQ(key, keys.Key(i));
+    EXPECT_TRUE(keys.Value(i).empty());
+  }
+  for (size_t i = 1; i < order.size(); ++i) {
+    const auto& prev = records[order[i - 1]];
+    const auto& next = records[order[i]];
+    auto prev_id = std::any_cast<int64_t>(prev[0]);
+    auto next_id = std::any_cast<int64_t>(next[0]);
+    ASSERT_LE(prev_id, next_id);
+    if (prev_id == next_id) {
+      ASSERT_LE(std::any_cast<std::string>(prev[1]),
+                std::any_cast<std::string>(next[1]));
+    }
+    ASSERT_LE(keys.Key(order[i - 1]), keys.Key(order[i]));
+  }
+}
+
+TEST_F(DingoSerialTest, recordDescendingKey) {
+  auto id = std::make_shared<DingoSchema<int32_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  id->SetDescending(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetIsKey(true);
+  name->SetAllowNull(true);
+  name->SetDescending(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(2);
+  score->SetIsKey(true);
+  auto flag = std::make_shared<DingoSchema<bool>>();
+  flag->SetIndex(3);
+  flag->SetIsKey(true);
+  flag->SetAllowNull(true);
+  flag->SetDescending(true);
+  auto ts = std::make_shared<DingoSchema<int64_t>>();
+  ts->SetIndex(4);
+  ts->SetIsKey(true);
+  ts->SetDescending(true);
+  auto ratio = std::make_shared<DingoSchema<float>>();
+  ratio->SetIndex(5);
+  ratio->SetIsKey(true);
+  ratio->SetAllowNull(true);
+  ratio->SetDescending(true);
+  auto note = std::make_shared<DingoSchema<std::string>>();
+  note->SetIndex(6);
+  note->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, name, score, flag, ts, ratio, note};
+
+  std::vector<std::vector<std::any>> records;
+  for (int32_t row_id : {3, -2, 0}) {
+    for (const char* row_name : std::initializer_list<const char*>{"b", "", "ab", "abcdefghi", nullptr}) {
+      for (double row_score : {-1.5, 2.0}) {
+        std::any row_flag = row_id == 0 ? std::any() : std::any(row_score > 0);
+        std::any row_ratio = row_score > 0 ? std::any(-0.25f) : std::any();
+        records.push_back({row_id, row_name ? std::any(std::string(row_name)) : std::any(), row_score, row_flag,
+                           int64_t(row_id) << 40, row_ratio, std::any(std::string("n"))});
+      }
+    }
+  }
+
+  RecordEncoderV2 re(0, schemas, 5L, this->le);
+  RecordDecoderV2 rd(0, schemas, 5L, this->le);
+  KeyComparator comparator(schemas, this->le);
+  std::vector<std::pair<std::string, std::string>> rows;
+  for (const auto& record : records) {
+    std::string key, value;
+    ASSERT_EQ(0, re.Encode('r', record, key, value));
+    rows.emplace_back(key, value);
+
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, rd.Decode(key, value, decoded));
+    AnyRowSink sink(schemas.size());
+    ASSERT_EQ(0, rd.Decode(key, value, sink));
+    for (const auto* out : {&decoded, &sink.record}) {
+      EXPECT_EQ(std::any_cast<int32_t>(record[0]), std::any_cast<int32_t>(out->at(0)));
+      EXPECT_EQ(record[1].has_value(), out->at(1).has_value());
+      if (record[1].has_value()) {
+        EXPECT_EQ(std::any_cast<std::string>(record[1]), std::any_cast<std::string>(out->at(1)));
+      }
+      EXPECT_EQ(std::any_cast<double>(record[2]), std::any_cast<double>(out->at(2)));
+      EXPECT_EQ(record[3].has_value(), out->at(3).has_value());
+      if (record[3].has_value()) {
+        EXPECT_EQ(std::any_cast<bool>(record[3]), std::any_cast<bool>(out->at(3)));
+      }
+      EXPECT_EQ(std::any_cast<int64_t>(record[4]), std::any_cast<int64_t>(out->at(4)));
+      EXPECT_EQ(record[5].has_value(), out->at(5).has_value());
+      EXPECT_EQ("n", std::any_cast<std::string>(out->at(6)));
+    }
+  }
+
+  // bytewise order is id, name (nulls last), flag, ts and ratio descending
+  // with score ascending in between.
+  std::sort(rows.begin(), rows.end());
+  for (size_t i = 1; i < rows.size(); ++i) {
+    std::vector<std::any> prev, next;
+    ASSERT_EQ(0, rd.DecodeKey(rows[i - 1].first, prev));
+    ASSERT_EQ(0, rd.DecodeKey(rows[i].first, next));
+    EXPECT_GT(0, comparator.Compare(rows[i - 1].first, rows[i].first));
+
+    auto prev_id = std::any_cast<int32_t>(prev[0]);
+    auto next_id = std::any_cast<int32_t>(next[0]);
+    ASSERT_GE(prev_id, next_id);
+    if (prev_id != next_id) {
+      continue;
+    }
+    if (!next[1].has_value()) {
+      if (!prev[1].has_value()) {
+        EXPECT_LT(std::any_cast<double>(prev[2]), std::any_cast<double>(next[2]));
+      }
+      continue;
+    }
+    ASSERT_TRUE(prev[1].has_value());
+    auto prev_name = std::any_cast<std::string>(prev[1]);
+    auto next_name = std::any_cast<std::string>(next[1]);
+    ASSERT_GE(prev_name, next_name);
+    if (prev_name == next_name) {
+      EXPECT_LT(std::any_cast<double>(prev[2]), std::any_cast<double>(next[2]));
+    }
+  }
+
+  // the descending bytes are the ascending ones inverted.
+  auto ascending = std::make_shared<DingoSchema<std::string>>();
+  ascending->SetAllowNull(true);
+  Buf asc(16, this->le), desc(16, this->le);
+  ascending->EncodeKey(std::string("abc"), asc);
+  name->EncodeKey(std::string("abc"), desc);
+  ASSERT_EQ(asc.Size(), desc.Size());
+  for (size_t i = 0; i < asc.Size(); ++i) {
+    EXPECT_EQ(static_cast<char>(~asc.Data()[i]), desc.Data()[i]);
+  }
+  BufView view(desc.Data(), desc.Size(), this->le);
+  EXPECT_EQ(static_cast<int>(desc.Size()), name->SkipKey(view));
+  EXPECT_TRUE(view.IsEnd());
+}
+
+TEST_F(DingoSerialTest, recordVersionKey) {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetIsKey(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(2);
+  std::vector<BaseSchemaPtr> schemas{id, name, score};
+  RecordEncoderV2 re(0, schemas, 3L, this->le);
+  RecordDecoderV2 rd(0, schemas, 3L, this->le);
+  KeyComparator comparator(schemas, this->le);
+
+  std::vector<std::any> record{int64_t(7), std::string("abc"), 1.5};
+  std::string key;
+  re.EncodeKey('r', record, key);
+
+  // the versions of a key sort newest first, next to each other.
+  std::vector<std::string> versions;
+  for (int64_t ts : {int64_t(5), int64_t(0), int64_t(1) << 50, int64_t(100)}) {
+    std::string version;
+    ASSERT_EQ(static_cast<int>(key.size() + kTsLength), re.EncodeVersionKey('r', record, ts, version));
+    EXPECT_EQ(key, StripTs(version));
+    EXPECT_EQ(ts, DecodeTs(version));
+    EXPECT_EQ(SeekKey(key, ts), version);
+    std::vector<ColumnValue> cells{int64_t(7), std::string("abc"), 1.5};
+    std::string cell_version;
+    re.EncodeVersionKey('r', cells, ts, cell_version);
+    EXPECT_EQ(version, cell_version);
+    versions.push_back(version);
+  }
+  std::sort(versions.begin(), versions.end());
+  std::vector<int64_t> order;
+  for (const auto& version : versions) {
+    order.push_back(DecodeTs(version));
+    EXPECT_EQ(0, CompareIgnoringTs(version, versions[0]));
+    EXPECT_EQ(0, comparator.Compare(version, key));
+
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, rd.DecodeKey(StripTs(version), decoded));
+    EXPECT_EQ(7, std::any_cast<int64_t>(decoded.at(0)));
+    EXPECT_EQ("abc", std::any_cast<std::string>(decoded.at(1)));
+  }
+  EXPECT_EQ((std::vector<int64_t>{int64_t(1) << 50, 100, 5, 0}), order);
+
+  // a seek lands on the latest version at or before ts.
+  auto seek = [&](int64_t ts) {
+    auto it = std::lower_bound(versions.begin(), versions.end(), SeekKey(key, ts));
+    return it == versions.end() ? int64_t(-1) : DecodeTs(*it);
+  };
+  EXPECT_EQ(100, seek(100));
+  EXPECT_EQ(100, seek(999));
+  EXPECT_EQ(5, seek(99));
+  EXPECT_EQ(0, seek(4));
+  EXPECT_EQ(int64_t(1) << 50, seek(INT64_MAX));
+
+  // the versions of another key do not mix with them.
+  std::vector<std::any> other{int64_t(7), std::string("abd"), 1.5};
+  std::string other_version;
+  re.EncodeVersionKey('r', other, INT64_MAX, other_version);
+  EXPECT_GT(other_version, versions.back());
+  EXPECT_LT(0, CompareIgnoringTs(other_version, versions.back()));
+
+  EXPECT_THROW(SeekKey(key, -1), std::runtime_error);
+  EXPECT_THROW(StripTs("abc"), std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordKeyBlock) {
+  auto tenant = std::make_shared<DingoSchema<std::string>>();
+  tenant->SetIndex(0);
+  tenant->SetIsKey(true);
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(1);
+  id->SetIsKey(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(2);
+  std::vector<BaseSchemaPtr> schemas{tenant, id, score};
+
+  RecordEncoderV2 re(0, schemas, 11L, this->le);
+  KeyBlockBuilder builder(this->le);
+  std::vector<std::string> keys;
+  size_t key_bytes = 0;
+  for (int64_t i = 0; i < 40; ++i) {
+    std::vector<std::any> record{std::string("tenant-with-a-long-name-") + std::to_string(i / 20), i * 2, 0.5};
+    std::string key;
+    re.EncodeKey('r', record, key);
+    ASSERT_EQ(0, builder.Add(key));
+    key_bytes += key.size();
+    keys.push_back(key);
+  }
+  EXPECT_EQ(40, builder.KeyCount());
+  // keys must grow.
+  EXPECT_EQ(-1, builder.Add(keys.at(5)));
+  EXPECT_EQ(40, builder.KeyCount());
+
+  size_t estimated = builder.EstimatedSize();
+  std::string block;
+  ASSERT_EQ(estimated, builder.Finish(block));
+  EXPECT_TRUE(builder.Empty());
+  // the shared prefix, tenant and high id bytes are stored once a restart.
+  EXPECT_LT(block.size() * 3, key_bytes);
+
+  KeyBlockReader reader(0, schemas, 11L, this->le);
+  ASSERT_EQ(0, reader.Open(block));
+  ASSERT_EQ(40, reader.KeyCount());
+  std::vector<std::any> record;
+  for (size_t r = 0; r < keys.size(); ++r) {
+    ASSERT_TRUE(reader.Next(record));
+    EXPECT_EQ(keys[r], reader.Key());
+    EXPECT_EQ("tenant-with-a-long-name-" + std::to_string(r / 20), std::any_cast<std::string>(record.at(0)));
+    EXPECT_EQ(static_cast<int64_t>(r * 2), std::any_cast<int64_t>(record.at(1)));
+  }
+  EXPECT_FALSE(reader.Next());
+
+  // past a restart, between keys and past the end.
+  reader.Seek(keys[21]);
+  EXPECT_EQ(21, reader.Position());
+  ASSERT_TRUE(reader.Next());
+  EXPECT_EQ(keys[21], reader.Key());
+  std::string between_key;
+  re.EncodeKey('r', std::vector<std::any>{std::string("tenant-with-a-long-name-1"), int64_t(65), 0.5}, between_key);
+  reader.Seek(between_key);
+  EXPECT_EQ(33, reader.Position());
+  reader.Seek(keys[0]);
+  EXPECT_EQ(0, reader.Position());
+  reader.Seek(keys[39] + "\xff");
+  EXPECT_TRUE(reader.AtEnd());
+
+  RecordDecoderV2 rd(0, schemas, 11L, this->le);
+  std::unordered_map<int, int> index_serial{{1, 0}, {0, 1}, {2, 2}};
+  auto plan = rd.NewDecodePlan(index_serial);
+  ColumnBatch batch;
+  reader.Seek(keys[10]);
+  ASSERT_EQ(25, reader.NextBatch(plan, 25, batch));
+  ASSERT_EQ(25, batch.NumRows());
+  for (size_t r = 0; r < batch.NumRows(); ++r) {
+    EXPECT_EQ(static_cast<int64_t>((r + 10) * 2), batch.Column(0).Get<int64_t>(r));
+    EXPECT_EQ("tenant-with-a-long-name-" + std::to_string((r + 10) / 20), batch.Column(1).GetString(r));
+    EXPECT_TRUE(batch.Column(2).IsNull(r));
+  }
+  EXPECT_EQ(5, reader.NextBatch(plan, 25, batch));
+  EXPECT_EQ(0, reader.NextBatch(plan, 25, batch));
+
+  // corrupt blocks are refused.
+  EXPECT_EQ(-1, reader.Open(block.substr(0, block.size() - 1)));
+  EXPECT_EQ(-1, reader.Open(block.substr(4)));
+
+  EXPECT_LT(0, builder.Finish(block));
+  ASSERT_EQ(0, reader.Open(block));
+  EXPECT_EQ(0, reader.KeyCount());
+  EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST_F(DingoSerialTest, recordNormalizedKeyPrefix) {
+  auto id = std::make_shared<DingoSchema<int32_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetIsKey(true);
+  std::vector<BaseSchemaPtr> schemas{id, name};
+  RecordEncoderV2 re(0, schemas, 4L, this->le);
+  KeyComparator comparator(schemas, this->le);
+
+  std::vector<std::string> keys;
+  for (int32_t row_id : {-3, 0, 7}) {
+    for (const char* row_name : {"", "a", "ab", "abcdef", "b"}) {
+      keys.emplace_back();
+      re.EncodeKey('r', std::vector<std::any>{row_id, std::string(row_name)}, keys.back());
+    }
+  }
+
+  // the prefix is the big endian value of the key bytes behind the common id.
+  uint64_t expected = 0;
+  for (size_t i = 9; i < 17; ++i) {
+    expected = (expected << 8) | static_cast<uint8_t>(keys[0][i]);
+  }
+  EXPECT_EQ(expected, comparator.NormalizedPrefix(keys[0]));
+  EXPECT_EQ(uint64_t(0x0102) << 40, comparator.NormalizedPrefix(std::string(10, '\0') + "\x01\x02"));
+  EXPECT_EQ(0, comparator.NormalizedPrefix("r"));
+
+  // integers order the keys but for ties, of 8 and of 16 bytes.
+  for (const auto& lhs : keys) {
+    for (const auto& rhs : keys) {
+      uint64_t lhs_prefix = comparator.NormalizedPrefix(lhs);
+      uint64_t rhs_prefix = comparator.NormalizedPrefix(rhs);
+      if (lhs_prefix < rhs_prefix) {
+        EXPECT_LT(lhs, rhs);
+      } else if (lhs_prefix == rhs_prefix) {
+        uint64_t lhs_next = comparator.NormalizedPrefix(lhs, KeyComparator::kNormalizedPrefixOffset + 8);
+        uint64_t rhs_next = comparator.NormalizedPrefix(rhs, KeyComparator::kNormalizedPrefixOffset + 8);
+        if (lhs_next < rhs_next) {
+          EXPECT_LT(lhs, rhs);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(DingoSerialTest, recordSparseValues) {
+  // a wide table, column ids past a byte.
+  std::vector<BaseSchemaPtr> schemas;
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  schemas.push_back(id);
+  for (int i = 1; i < 300; ++i) {
+    BaseSchemaPtr column;
+    if (i % 3 == 0) {
+      column = std::make_shared<DingoSchema<std::string>>();
+    } else if (i % 3 == 1) {
+      column = std::make_shared<DingoSchema<int64_t>>();
+    } else {
+      column = std::make_shared<DingoSchema<double>>();
+    }
+    column->SetIndex(i);
+    column->SetAllowNull(true);
+    schemas.push_back(column);
+  }
+
+  std::vector<std::any> sparse(schemas.size());
+  sparse[0] = int64_t(7);
+  sparse[4] = int64_t(-4);
+  sparse[150] = std::string("one fifty");
+  sparse[251] = 2.5;
+  sparse[298] = int64_t(298);
+  std::vector<std::any> dense(schemas.size());
+  dense[0] = int64_t(8);
+  for (int i = 1; i < 300; i += 2) {
+    dense[i] = i % 3 == 0 ? std::any(std::to_string(i)) : i % 3 == 1 ? std::any(int64_t(i)) : std::any(double(i));
+  }
+
+  RecordEncoderV2 wide_re(0, schemas, 0L, this->le);
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::string key, wide_value;
+  wide_re.Encode('r', sparse, key, wide_value);
+
+  for (int variant = 0; variant < 3; ++variant) {
+    RecordEncoderV2 re(0, schemas, 0L, this->le);
+    re.SetSparseValues(true);
+    re.SetCompactValueHeader(variant == 1);
+    if (variant == 2) {
+      re.SetCompression(CompressionType::kZlib, 0);
+    }
+    std::string value;
+    re.EncodeValue(sparse, value);
+    if (variant == 0) {
+      // 295 nulls leave the tables, the format is not flagged.
+      EXPECT_EQ(wide_value.size() - 295 * 6, value.size());
+      EXPECT_EQ(BufView(wide_value, this->le).ReadInt(0), BufView(value, this->le).ReadInt(0));
+    }
+    if (variant != 2) {
+      EXPECT_EQ(value.size(), re.EncodedValueSize(sparse)) << "variant " << variant;
+    }
+
+    std::vector<std::any> record;
+    ASSERT_EQ(0, rd.Decode(key, value, record));
+    for (size_t i = 1; i < schemas.size(); ++i) {
+      ASSERT_EQ(sparse[i].has_value(), record[i].has_value()) << i;
+    }
+    EXPECT_EQ(-4, std::any_cast<int64_t>(record[4]));
+    EXPECT_EQ("one fifty", std::any_cast<std::string>(record[150]));
+    EXPECT_EQ(2.5, std::any_cast<double>(record[251]));
+    EXPECT_EQ(298, std::any_cast<int64_t>(record[298]));
+
+    std::vector<ColumnValue> values;
+    ASSERT_EQ(0, rd.Decode(key, value, values));
+    EXPECT_EQ(2.5, std::get<double>(values[251]));
+    EXPECT_TRUE(IsNull(values[252]));
+
+    // projected, a null between populated columns.
+    std::unordered_map<int, int> index_serial{{150, 0}, {151, 1}, {298, 2}};
+    std::vector<std::any> projected;
+    ASSERT_EQ(0, rd.Decode(key, value, index_serial, projected));
+    EXPECT_EQ("one fifty", std::any_cast<std::string>(projected[0]));
+    EXPECT_FALSE(projected[1].has_value());
+    EXPECT_EQ(298, std::any_cast<int64_t>(projected[2]));
+
+    std::vector<KeyValue> key_values(2);
+    key_values[0].Set(key, value);
+    key_values[1].Set(key, value);
+    auto plan = rd.NewDecodePlan({{0, 0}, {4, 1}, {5, 2}, {150, 3}});
+    ColumnBatch batch;
+    ASSERT_EQ(0, rd.DecodeBatch(key_values, plan, batch));
+    ASSERT_EQ(2, batch.NumRows());
+    for (size_t r = 0; r < batch.NumRows(); ++r) {
+      EXPECT_EQ(7, batch.Column(0).Get<int64_t>(r));
+      EXPECT_EQ(-4, batch.Column(1).Get<int64_t>(r));
+      EXPECT_TRUE(batch.Column(2).IsNull(r));
+      EXPECT_EQ("one fifty", batch.Column(3).GetString(r));
+    }
+
+    // a row with less than half the columns null keeps the plain layout.
+    std::string dense_value, wide_dense_value;
+    re.EncodeValue(dense, dense_value);
+    RecordEncoderV2 plain_re(0, schemas, 0L, this->le);
+    plain_re.SetCompactValueHeader(variant == 1);
+    if (variant == 2) {
+      plain_re.SetCompression(CompressionType::kZlib, 0);
+    }
+    plain_re.EncodeValue(dense, wide_dense_value);
+    EXPECT_EQ(wide_dense_value, dense_value) << "variant " << variant;
+  }
+
+  // batches of sparse rows are encoded row by row.
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  re.SetSparseValues(true);
+  std::vector<std::vector<std::any>> records{sparse, dense, sparse};
+  EncodedBatch rows;
+  ASSERT_EQ(0, re.EncodeBatch('r', records, rows));
+  for (size_t i = 0; i < records.size(); ++i) {
+    std::string row_key, row_value;
+    re.Encode('r', records[i], row_key, row_value);
+    EXPECT_EQ(row_value, rows.Value(i));
+  }
+}
+
+TEST_F(DingoSerialTest, recordColumnGroups) {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(1);
+  name->SetAllowNull(true);
+  auto blob = std::make_shared<DingoSchema<std::string>>();
+  blob->SetIndex(2);
+  blob->SetAllowNull(true);
+  blob->SetColumnGroup(2);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(3);
+  score->SetAllowNull(true);
+  auto tags = std::make_shared<DingoSchema<std::vector<int64_t>>>();
+  tags->SetIndex(4);
+  tags->SetAllowNull(true);
+  tags->SetColumnGroup(1);
+  std::vector<BaseSchemaPtr> schemas{id, name, blob, score, tags};
+
+  std::vector<std::any> record1{int64_t(11), std::string("hot"), std::string(1000, 'x'), 0.5,
+                                std::vector<int64_t>{1, 2, 3}};
+
+  for (bool compact : {false, true}) {
+    RecordEncoderV2 re(0, schemas, 5L, this->le);
+    re.SetCompactValueHeader(compact);
+    re.SetCompression(CompressionType::kZlib, 512);
+    ASSERT_EQ(3, re.ColumnGroupCount());
+
+    std::string key, whole;
+    re.Encode('r', record1, key, whole);
+    std::string group_key;
+    std::vector<std::string> values;
+    ASSERT_EQ(0, re.EncodeColumnGroups('r', record1, group_key, values));
+    EXPECT_EQ(key, group_key);
+    ASSERT_EQ(3, values.size());
+
+    // the hot group is a row of its own, the cold columns null in it.
+    RecordDecoderV2 rd(0, schemas, 5L, this->le);
+    std::vector<std::any> hot;
+    ASSERT_EQ(0, rd.Decode(key, values[0], hot));
+    EXPECT_EQ(11, std::any_cast<int64_t>(hot[0]));
+    EXPECT_EQ("hot", std::any_cast<std::string>(hot[1]));
+    EXPECT_FALSE(hot[2].has_value());
+    EXPECT_EQ(0.5, std::any_cast<double>(hot[3]));
+    EXPECT_FALSE(hot[4].has_value());
+    EXPECT_LT(values[0].size(), 100);
+
+    // the blob compresses in its own group, the other groups are left alone.
+    std::vector<std::any> cold;
+    ASSERT_EQ(0, rd.Decode(key, values[2], cold));
+    EXPECT_EQ(std::string(1000, 'x'), std::any_cast<std::string>(cold[2]));
+    EXPECT_FALSE(cold[1].has_value());
+    EXPECT_LT(values[2].size(), 200);
+
+    // all groups merged give the row.
+    std::vector<std::any> record2;
+    ASSERT_EQ(0, rd.DecodeColumnGroups(key, {values[0], values[1], values[2]}, record2));
+    std::vector<std::any> record3;
+    ASSERT_EQ(0, rd.Decode(key, whole, record3));
+    ASSERT_EQ(record3.size(), record2.size());
+    EXPECT_EQ("hot", std::any_cast<std::string>(record2[1]));
+    EXPECT_EQ(std::any_cast<std::string>(record3[2]), std::any_cast<std::string>(record2[2]));
+    EXPECT_EQ(0.5, std::any_cast<double>(record2[3]));
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), std::any_cast<std::vector<int64_t>>(record2[4]));
+
+    // a projection reads the groups of its columns only.
+    std::unordered_map<int, int> hot_serial{{0, 0}, {1, 1}, {3, 2}};
+    EXPECT_EQ(std::vector<int>{0}, rd.ColumnGroups(hot_serial));
+    std::unordered_map<int, int> index_serial{{4, 0}, {1, 1}, {0, 2}};
+    EXPECT_EQ((std::vector<int>{0, 1}), rd.ColumnGroups(index_serial));
+    std::vector<std::any> projected;
+    ASSERT_EQ(0, rd.DecodeColumnGroups(key, {values[0], values[1]}, index_serial, projected));
+    ASSERT_EQ(3, projected.size());
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), std::any_cast<std::vector<int64_t>>(projected[0]));
+    EXPECT_EQ("hot", std::any_cast<std::string>(projected[1]));
+    EXPECT_EQ(11, std::any_cast<int64_t>(projected[2]));
+
+    // a group not read decodes as null, group 0 is needed.
+    std::vector<std::any> partial;
+    ASSERT_EQ(0, rd.DecodeColumnGroups(key, {values[0]}, partial));
+    EXPECT_FALSE(partial[2].has_value());
+    EXPECT_FALSE(partial[4].has_value());
+    EXPECT_EQ(-1, rd.DecodeColumnGroups(key, {std::string_view(), values[1]}, partial));
+
+    // the group keys sort right behind the row.
+    EXPECT_EQ(key, ColumnGroupKey(key, 0));
+    std::string key1 = ColumnGroupKey(key, 1);
+    std::string key2 = ColumnGroupKey(key, 2);
+    EXPECT_LT(key, key1);
+    EXPECT_LT(key1, key2);
+    EXPECT_EQ(key, RowKeyOfColumnGroup(key2, 2));
+    EXPECT_THROW(ColumnGroupKey(key, kMaxColumnGroups), std::runtime_error);
+  }
+
+  // without groups the row is one value.
+  tags->SetColumnGroup(0);
+  blob->SetColumnGroup(0);
+  RecordEncoderV2 re(0, schemas, 5L, this->le);
+  ASSERT_EQ(1, re.ColumnGroupCount());
+  std::string key, value;
+  std::vector<std::string> values;
+  re.Encode('r', record1, key, value);
+  ASSERT_EQ(0, re.EncodeColumnGroups('r', record1, key, values));
+  ASSERT_EQ(1, values.size());
+  EXPECT_EQ(value, values[0]);
+
+  blob->SetColumnGroup(kMaxColumnGroups);
+  EXPECT_THROW(RecordEncoderV2(0, schemas, 5L, this->le), std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordDecodeCache) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+  auto record1 = GetRecord();
+
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+  auto decoder = std::make_shared<RecordDecoderV2>(0, schemas, 0L, this->le);
+
+  DecodeCache cache(decoder, 1 << 20, 4);
+  auto first = cache.Decode(key, value);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(0, cache.Hits());
+  EXPECT_EQ(1, cache.Misses());
+  EXPECT_EQ(1, cache.Size());
+  EXPECT_GT(cache.Charge(), key.size() + value.size());
+
+  // a hit is the cached record itself.
+  EXPECT_EQ(first, cache.Decode(key, value));
+  EXPECT_EQ(1, cache.Hits());
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, cache.Decode(key, value, record2));
+  EXPECT_EQ(2, cache.Hits());
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), std::any_cast<std::string>(record2.at(2)));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+  EXPECT_FALSE(record2.at(6).has_value());
+
+  // the row written again under its key misses and replaces the record.
+  auto record3 = record1;
+  record3.at(9) = int64_t(-9);
+  std::string value3;
+  re.EncodeValue(record3, value3);
+  auto third = cache.Decode(key, value3);
+  ASSERT_NE(nullptr, third);
+  EXPECT_NE(first, third);
+  EXPECT_EQ(-9, std::any_cast<int64_t>(third->at(9)));
+  EXPECT_EQ(2, cache.Misses());
+  EXPECT_EQ(1, cache.Size());
+  // the evicted record is still held by its users.
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(first->at(9)));
+
+  // failed rows are not cached.
+  RecordEncoderV2 new_re(1, schemas, 0L, this->le);
+  std::string bad_value;
+  new_re.EncodeValue(record1, bad_value);
+  EXPECT_EQ(nullptr, cache.Decode(key, bad_value));
+  EXPECT_EQ(-1, cache.Decode(key, bad_value, record2));
+
+  cache.Erase(key);
+  EXPECT_EQ(0, cache.Size());
+  EXPECT_EQ(0, cache.Charge());
+
+  // the budget evicts the least recently used rows.
+  size_t row_charge;
+  {
+    DecodeCache one(decoder, 1 << 20, 1);
+    one.Decode(key, value);
+    row_charge = one.Charge();
+  }
+  DecodeCache small(decoder, row_charge * 3, 1);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 4; ++i) {
+    auto record = record1;
+    record.at(0) = int32_t(i);
+    std::string row_key;
+    re.EncodeKey('r', record, row_key);
+    ASSERT_NE(nullptr, small.Decode(row_key, value));
+    keys.push_back(row_key);
+    if (i == 1) {
+      // keys[0] becomes the most recently used.
+      small.Decode(keys[0], value);
+    }
+  }
+  EXPECT_EQ(3, small.Size());
+  EXPECT_LE(small.Charge(), small.Capacity());
+  uint64_t misses = small.Misses();
+  small.Decode(keys[0], value);
+  small.Decode(keys[3], value);
+  EXPECT_EQ(misses, small.Misses());
+  small.Decode(keys[1], value);
+  EXPECT_EQ(misses + 1, small.Misses());
+
+  // rows above a shard's part are decoded but not kept.
+  DecodeCache tiny(decoder, row_charge / 2, 1);
+  ASSERT_NE(nullptr, tiny.Decode(key, value));
+  EXPECT_EQ(0, tiny.Size());
+  small.Clear();
+  EXPECT_EQ(0, small.Size());
+
+  // a projection is cached as decoded.
+  DecodeCache projected(decoder, {{9, 0}, {2, 1}}, 1 << 20);
+  auto row = projected.Decode(key, value);
+  ASSERT_NE(nullptr, row);
+  ASSERT_EQ(2, row->size());
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(row->at(0)));
+  EXPECT_EQ(std::any_cast<std::string>(record1.at(2)), std::any_cast<std::string>(row->at(1)));
+  EXPECT_EQ(row, projected.Decode(key, value));
+
+  // shared by threads.
+  DecodeCache shared(decoder, 1 << 20);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 200; ++i) {
+        auto cached = shared.Decode(keys[i % keys.size()], value);
+        ASSERT_NE(nullptr, cached);
+        EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(cached->at(9)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(800, shared.Hits() + shared.Misses());
+  EXPECT_EQ(keys.size(), shared.Size());
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordPeek) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+  RecordDecoderV2 rd(3, schemas, 0L, this->le);
+
+  for (int layout = 0; layout < 4; ++layout) {
+    for (bool compact : {false, true}) {
+      RecordEncoderV2 re(3, schemas, 0L, this->le);
+      re.SetCompactValueHeader(compact);
+      re.SetNullBitmap(layout == 1);
+      re.SetStaticOffsets(layout == 2);
+      re.SetSparseValues(layout == 3);
+      auto record = record1;
+      if (layout == 3) {
+        record.at(4) = std::any();
+        record.at(9) = std::any();
+      }
+      std::string key, value;
+      re.Encode('r', record, key, value);
+
+      EXPECT_EQ(CODEC_VERSION_V2, PeekCodecVersion(key, this->le));
+      EXPECT_EQ(3, PeekSchemaVersion(value, this->le));
+      EXPECT_EQ(GetValueFormat(BufView(value, this->le).ReadInt(0)), PeekValueFormat(value, this->le));
+
+      int cnt_not_null_col, cnt_null_col;
+      ASSERT_EQ(0, PeekColumnCounts(value, this->le, cnt_not_null_col, cnt_null_col));
+      EXPECT_EQ(layout == 3 ? 3 : 5, cnt_not_null_col);
+      EXPECT_EQ(layout == 3 ? 0 : 2, cnt_null_col);
+
+      std::vector<std::any> decoded;
+      ASSERT_EQ(0, rd.Decode(key, value, decoded));
+      for (int column = 4; column < 11; ++column) {
+        bool is_null = false;
+        ASSERT_EQ(0, PeekIsNull(value, this->le, column, is_null));
+        EXPECT_EQ(!decoded.at(column).has_value(), is_null) << "layout " << layout << " column " << column;
+      }
+      // a column the writer did not have.
+      bool is_null = false;
+      ASSERT_EQ(0, PeekIsNull(value, this->le, 42, is_null));
+      EXPECT_TRUE(is_null);
+
+      // too short for the tables.
+      EXPECT_EQ(-1, PeekIsNull(std::string_view(value).substr(0, 9), this->le, 4, is_null));
+    }
+  }
+
+  // compressed tables are not peeked at, the versions still are.
+  RecordEncoderV2 re(3, schemas, 0L, this->le);
+  re.SetCompression(CompressionType::kZlib, 0);
+  std::string value;
+  re.EncodeValue(record1, value);
+  EXPECT_EQ(3, PeekSchemaVersion(value, this->le));
+  bool is_null;
+  int cnt_not_null_col, cnt_null_col;
+  EXPECT_EQ(-1, PeekIsNull(value, this->le, 4, is_null));
+  EXPECT_EQ(-1, PeekColumnCounts(value, this->le, cnt_not_null_col, cnt_null_col));
+
+  EXPECT_EQ(-1, PeekCodecVersion("abc", this->le));
+  EXPECT_EQ(-1, PeekSchemaVersion("", this->le));
+  EXPECT_EQ(-1, PeekColumnCounts(std::string_view(value).substr(0, 4), this->le, cnt_not_null_col, cnt_null_col));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordTrustedInput) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  RecordDecoderV2 trusted_rd(0, schemas, 0L, this->le);
+  EXPECT_FALSE(trusted_rd.IsTrustedInput());
+  trusted_rd.SetTrustedInput(true);
+  EXPECT_TRUE(trusted_rd.IsTrustedInput());
+
+  // other schemas of the writer make the decoders search the ids.
+  auto other_schemas = schemas;
+  other_schemas.at(7) = nullptr;
+  for (const auto& writer_schemas : {schemas, other_schemas}) {
+    for (int layout = 0; layout < 3; ++layout) {
+      for (bool compact : {false, true}) {
+        RecordEncoderV2 re(0, writer_schemas, 0L, this->le);
+        re.SetCompactValueHeader(compact);
+        re.SetNullBitmap(layout == 1);
+        re.SetStaticOffsets(layout == 2);
+        std::string key, value;
+        re.Encode('r', record1, key, value);
+
+        std::vector<std::any> checked, trusted;
+        ASSERT_EQ(0, rd.Decode(key, value, checked));
+        ASSERT_EQ(0, trusted_rd.Decode(key, value, trusted));
+        ASSERT_EQ(checked.size(), trusted.size());
+        for (size_t i = 0; i < checked.size(); ++i) {
+          ASSERT_EQ(checked[i].has_value(), trusted[i].has_value()) << "layout " << layout << " column " << i;
+        }
+        EXPECT_EQ(std::any_cast<bool>(checked.at(5)), std::any_cast<bool>(trusted.at(5)));
+        EXPECT_EQ(std::any_cast<int32_t>(checked.at(8)), std::any_cast<int32_t>(trusted.at(8)));
+        EXPECT_EQ(std::any_cast<int64_t>(checked.at(9)), std::any_cast<int64_t>(trusted.at(9)));
+        EXPECT_EQ(std::any_cast<double>(checked.at(10)), std::any_cast<double>(trusted.at(10)));
+        EXPECT_EQ(std::any_cast<std::string>(checked.at(4)), std::any_cast<std::string>(trusted.at(4)));
+
+        std::unordered_map<int, int> index_serial{{10, 0}, {9, 1}, {7, 2}};
+        std::vector<std::any> projected;
+        ASSERT_EQ(0, trusted_rd.Decode(key, value, index_serial, projected));
+        EXPECT_EQ(std::any_cast<double>(checked.at(10)), std::any_cast<double>(projected[0]));
+        EXPECT_EQ(std::any_cast<int64_t>(checked.at(9)), std::any_cast<int64_t>(projected[1]));
+        EXPECT_FALSE(projected[2].has_value());
+
+        // the tables are checked once, up front.
+        std::string cut = value.substr(0, 12);
+        EXPECT_THROW(trusted_rd.Decode(key, cut, trusted), std::out_of_range);
+      }
+    }
+  }
+
+  // back to checked reads.
+  trusted_rd.SetTrustedInput(false);
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+  std::vector<std::any> record2;
+  ASSERT_EQ(0, trusted_rd.Decode(key, value, record2));
+  EXPECT_EQ(std::any_cast<int64_t>(record1.at(9)), std::any_cast<int64_t>(record2.at(9)));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordValueSlices) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+  // one string past the threshold, the others below it.
+  record1.at(4) = std::string(10000, 'x');
+  std::vector<ColumnValue> values = FromAny(record1);
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  for (int layout = 0; layout < 3; ++layout) {
+    for (bool compact : {false, true}) {
+      RecordEncoderV2 re(0, schemas, 0L, this->le);
+      re.SetCompactValueHeader(compact);
+      re.SetNullBitmap(layout == 1);
+      re.SetStaticOffsets(layout == 2);
+      std::string key, value;
+      re.Encode('r', record1, key, value);
+
+      ValueSlices slices;
+      ASSERT_EQ(value.size(), re.EncodeValue(record1, slices));
+      EXPECT_EQ(value.size(), slices.Size());
+      EXPECT_EQ(10000, slices.ExternalSize());
+      ASSERT_GE(slices.SliceCount(), 2);
+      // the string is referenced, not copied.
+      const auto& big = std::any_cast<const std::string&>(record1.at(4));
+      int referenced = 0;
+      for (const auto& slice : slices.Slices()) {
+        referenced += slice.data() == big.data() && slice.size() == big.size();
+      }
+      EXPECT_EQ(1, referenced);
+      std::string flat;
+      slices.Flatten(flat);
+      EXPECT_EQ(value, flat) << "layout " << layout << " compact " << compact;
+
+      ASSERT_EQ(value.size(), re.EncodeValue(values, slices));
+      slices.Flatten(flat);
+      EXPECT_EQ(value, flat);
+
+      std::vector<std::any> record2;
+      ASSERT_EQ(0, rd.Decode(key, flat, record2));
+      EXPECT_EQ(big, std::any_cast<std::string>(record2.at(4)));
+    }
+  }
+
+  // small values keep to one slice, headers compact as in EncodeValue.
+  auto record3 = GetRecord();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  re.SetCompactValueHeader(true);
+  std::string value;
+  re.EncodeValue(record3, value);
+  ValueSlices slices(8);
+  re.EncodeValue(record3, slices);
+  std::string flat;
+  slices.Flatten(flat);
+  EXPECT_EQ(value, flat);
+
+  // a compressed value is one slice.
+  re.SetCompression(CompressionType::kZlib, 0);
+  re.EncodeValue(record1, value);
+  re.EncodeValue(record1, slices);
+  ASSERT_EQ(1, slices.SliceCount());
+  EXPECT_EQ(0, slices.ExternalSize());
+  EXPECT_EQ(value, slices.Slice(0));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordEncodeTo) {
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+  record1.at(4) = std::string(10000, 'x');
+  std::vector<ColumnValue> values = FromAny(record1);
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+
+  // too small: the size needed, nothing written.
+  std::string dst(4, '?');
+  EXPECT_EQ(key.size(), re.EncodeKeyTo('r', record1, dst.data(), dst.size()));
+  EXPECT_EQ(value.size(), re.EncodeValueTo(record1, dst.data(), dst.size()));
+  EXPECT_EQ("????", dst);
+
+  dst.assign(value.size() + 8, '?');
+  ASSERT_EQ(key.size(), re.EncodeKeyTo('r', record1, dst.data(), dst.size()));
+  EXPECT_EQ(key, dst.substr(0, key.size()));
+  ASSERT_EQ(key.size(), re.EncodeKeyTo('r', values, dst.data(), dst.size()));
+  EXPECT_EQ(key, dst.substr(0, key.size()));
+
+  ASSERT_EQ(value.size(), re.EncodeValueTo(record1, dst.data(), value.size()));
+  EXPECT_EQ(value, dst.substr(0, value.size()));
+  EXPECT_EQ('?', dst[value.size()]);
+  ASSERT_EQ(value.size(), re.EncodeValueTo(values, dst.data(), dst.size()));
+  EXPECT_EQ(value, dst.substr(0, value.size()));
+
+  // narrowed offsets: written in place with room for the wide ones, aside
+  // with only the room of the narrowed value.
+  re.SetCompactValueHeader(true);
+  re.EncodeValue(record1, value);
+  dst.assign(value.size() + 256, '?');
+  ASSERT_EQ(value.size(), re.EncodeValueTo(record1, dst.data(), dst.size()));
+  EXPECT_EQ(value, dst.substr(0, value.size()));
+  dst.assign(value.size() + 1, '?');
+  ASSERT_EQ(value.size(), re.EncodeValueTo(values, dst.data(), value.size()));
+  EXPECT_EQ(value, dst.substr(0, value.size()));
+  EXPECT_EQ('?', dst[value.size()]);
+  re.SetCompactValueHeader(false);
+
+  // compressed, the size is known once encoded.
+  re.SetCompression(CompressionType::kZlib, 0);
+  re.EncodeValue(record1, value);
+  EXPECT_EQ(value.size(), re.EncodeValueTo(record1, dst.data(), 4));
+  ASSERT_EQ(value.size(), re.EncodeValueTo(record1, dst.data(), dst.size()));
+  EXPECT_EQ(value, dst.substr(0, value.size()));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordDecodeBatchPrefetch) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::vector<KeyValue> key_values(20);
+  for (size_t r = 0; r < key_values.size(); ++r) {
+    record1.at(0) = static_cast<int32_t>(r);
+    record1.at(9) = static_cast<int64_t>(r * 1000);
+    std::string key, value;
+    re.Encode('r', record1, key, value);
+    key_values[r].Set(key, value);
+  }
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  EXPECT_EQ(RecordDecoderV2::kDefaultPrefetchDistance, rd.GetPrefetchDistance());
+  EXPECT_THROW(rd.SetPrefetchDistance(-1), std::out_of_range);
+  auto plan = rd.NewDecodePlan({{0, 0}, {4, 1}, {9, 2}});
+
+  // the rows decode the same with any distance, past the batch included.
+  for (int distance : {0, 1, 4, 19, 64}) {
+    rd.SetPrefetchDistance(distance);
+    ColumnBatch batch;
+    ASSERT_EQ(0, rd.DecodeBatch(key_values, plan, batch));
+    ASSERT_EQ(key_values.size(), batch.NumRows());
+    for (size_t r = 0; r < batch.NumRows(); ++r) {
+      EXPECT_EQ(r, batch.Column(0).Get<int32_t>(r));
+      EXPECT_EQ(std::any_cast<std::string>(record1.at(4)), batch.Column(1).GetString(r));
+      EXPECT_EQ(r * 1000, batch.Column(2).Get<int64_t>(r));
+    }
+  }
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordSelectByKey) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::vector<KeyValue> key_values(10);
+  for (size_t r = 0; r < key_values.size(); ++r) {
+    record1.at(0) = static_cast<int32_t>(r);
+    record1.at(9) = static_cast<int64_t>(r * 1000);
+    std::string key, value;
+    re.Encode('r', record1, key, value);
+    key_values[r].Set(key, value);
+  }
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  std::vector<uint32_t> selection;
+  ASSERT_EQ(0, rd.SelectByKey(key_values,
+                              {EncodedPredicate::Between(0, 2, 7),
+                               EncodedPredicate::Less(0, int64_t{6}),
+                               EncodedPredicate::Equal(3, record1.at(3))},
+                              selection));
+  EXPECT_EQ((std::vector<uint32_t>{2, 3, 4, 5}), selection);
+
+  auto plan = rd.NewDecodePlan({{0, 0}, {9, 1}});
+  ColumnBatch batch;
+  ASSERT_EQ(0, rd.DecodeBatch(key_values, selection, plan, batch));
+  ASSERT_EQ(4, batch.NumRows());
+  for (size_t r = 0; r < batch.NumRows(); ++r) {
+    EXPECT_EQ(selection[r], batch.Column(0).Get<int32_t>(r));
+    EXPECT_EQ(selection[r] * 1000, batch.Column(1).Get<int64_t>(r));
+  }
+
+  // a string key column, and no row left.
+  ASSERT_EQ(0, rd.SelectByKey(key_values, {EncodedPredicate::Equal(1, record1.at(1))},
+                              selection));
+  EXPECT_EQ(10, selection.size());
+  ASSERT_EQ(0, rd.SelectByKey(key_values, {EncodedPredicate::Equal(2, std::string("none"))},
+                              selection));
+  EXPECT_TRUE(selection.empty());
+  ASSERT_EQ(0, rd.DecodeBatch(key_values, selection, plan, batch));
+  EXPECT_EQ(0, batch.NumRows());
+
+  // the value bytes of the rows left out are never read.
+  auto broken = key_values;
+  broken[0].Set(broken[0].GetKey(), "bad");
+  ASSERT_EQ(0, rd.SelectByKey(broken, {EncodedPredicate::Greater(0, 0)}, selection));
+  ASSERT_EQ(0, rd.DecodeBatch(broken, selection, plan, batch));
+  EXPECT_EQ(9, batch.NumRows());
+
+  // value columns are no key predicates.
+  EXPECT_EQ(-1, rd.SelectByKey(key_values, {EncodedPredicate::Equal(9, int64_t{0})},
+                               selection));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordBatchWire) {
+  InitVector();
+  auto schemas = GetSchemas();
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  InitRecord();
+
+  auto record1 = GetRecord();
+  std::vector<KeyValue> key_values(64);
+  size_t kv_bytes = 0;
+  for (size_t r = 0; r < key_values.size(); ++r) {
+    record1.at(0) = static_cast<int32_t>(r);
+    record1.at(4) = r % 3 == 0 ? std::any() : std::any(std::string(r % 2 ? "odd" : "even"));
+    record1.at(9) = static_cast<int64_t>(r) - 20;
+    record1.at(2) = "row " + std::to_string(r);
+    std::string key, value;
+    re.Encode('r', record1, key, value);
+    kv_bytes += key.size() + value.size();
+    key_values[r].Set(key, value);
+  }
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  auto plan = rd.NewDecodePlan({{0, 0}, {4, 1}, {6, 2}, {9, 3}, {10, 4}, {5, 5}, {2, 6}});
+  ColumnBatch batch;
+  ASSERT_EQ(0, rd.DecodeBatch(key_values, plan, batch));
+
+  for (bool compact : {true, false}) {
+    BatchWireOptions options;
+    options.varint = compact;
+    options.dictionary = compact;
+    std::string wire;
+    int len = EncodeBatchWire(batch, options, wire);
+    ASSERT_EQ(len, wire.size());
+    EXPECT_LT(wire.size(), kv_bytes);
+
+    BatchWireReader reader;
+    ASSERT_EQ(0, reader.Open(wire));
+    ASSERT_EQ(batch.NumRows(), reader.NumRows());
+    ASSERT_EQ(batch.NumColumns(), reader.NumColumns());
+    EXPECT_EQ(compact ? BatchWireReader::kVarint : BatchWireReader::kPlain,
+              reader.GetColumn(0).GetEncoding());
+    EXPECT_EQ(compact ? BatchWireReader::kDictionary : BatchWireReader::kPlain,
+              reader.GetColumn(1).GetEncoding());
+    // a distinct value per row is no dictionary.
+    EXPECT_EQ(BatchWireReader::kPlain, reader.GetColumn(6).GetEncoding());
+    for (size_t r = 0; r < batch.NumRows(); ++r) {
+      EXPECT_EQ(batch.Column(0).Get<int32_t>(r), reader.GetColumn(0).Get<int32_t>(r));
+      ASSERT_EQ(batch.Column(1).IsNull(r), reader.GetColumn(1).IsNull(r));
+      EXPECT_EQ(batch.Column(1).GetString(r), reader.GetColumn(1).GetString(r));
+      EXPECT_TRUE(reader.GetColumn(2).IsNull(r));
+      EXPECT_EQ(batch.Column(3).Get<int64_t>(r), reader.GetColumn(3).Get<int64_t>(r));
+      EXPECT_EQ(batch.Column(4).Get<double>(r), reader.GetColumn(4).Get<double>(r));
+      EXPECT_EQ(batch.Column(5).Get<bool>(r), reader.GetColumn(5).Get<bool>(r));
+      EXPECT_EQ(batch.Column(6).GetString(r), reader.GetColumn(6).GetString(r));
+    }
+    // the strings are read in place.
+    const char* begin = wire.data();
+    EXPECT_TRUE(reader.GetColumn(6).GetString(0).data() >= begin &&
+                reader.GetColumn(6).GetString(0).data() < begin + wire.size());
+
+    // truncated or trailing bytes.
+    EXPECT_EQ(-1, reader.Open(std::string_view(wire).substr(0, wire.size() - 1)));
+    EXPECT_EQ(-1, reader.Open(wire + "x"));
+    EXPECT_EQ(-1, reader.Open(std::string_view()));
+  }
+
+  // list columns.
+  ColumnBatch lists;
+  lists.Reset({BaseSchema::kIntegerList, BaseSchema::kStringList});
+  lists.Column(0).AppendList(std::vector<int32_t>{1, 2, 3});
+  lists.Column(1).AppendStringList({"a", "bc"});
+  lists.Column(0).AppendNull();
+  lists.Column(1).AppendStringList({});
+  lists.SetNumRows(2);
+  std::string wire;
+  EncodeBatchWire(lists, wire);
+  BatchWireReader reader;
+  ASSERT_EQ(0, reader.Open(wire));
+  const auto& ints = reader.GetColumn(0);
+  ASSERT_EQ(3, ints.ListSize(0));
+  EXPECT_EQ(3, ints.GetListElement<int32_t>(0, 2));
+  EXPECT_TRUE(ints.IsNull(1));
+  EXPECT_EQ(0, ints.ListSize(1));
+  const auto& strings = reader.GetColumn(1);
+  ASSERT_EQ(2, strings.ListSize(0));
+  EXPECT_EQ("bc", strings.GetListString(0, 1));
+  EXPECT_EQ(0, strings.ListSize(1));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordEncodeKeys) {
+  auto region = std::make_shared<DingoSchema<int32_t>>();
+  region->SetIndex(0);
+  region->SetIsKey(true);
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(1);
+  id->SetIsKey(true);
+  id->SetAllowNull(true);
+  auto ts = std::make_shared<DingoSchema<double>>();
+  ts->SetIndex(2);
+  ts->SetIsKey(true);
+  ts->SetAllowNull(true);
+  ts->SetDescending(true);
+  auto flag = std::make_shared<DingoSchema<bool>>();
+  flag->SetIndex(3);
+  flag->SetIsKey(true);
+  auto ratio = std::make_shared<DingoSchema<float>>();
+  ratio->SetIndex(4);
+  ratio->SetIsKey(true);
+  ratio->SetAllowNull(true);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(5);
+  name->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{region, id, ts, flag, ratio, name};
+
+  const size_t rows = 50;
+  std::vector<std::vector<std::any>> records;
+  std::vector<ColumnVector> vectors;
+  for (const auto& schema : schemas) {
+    vectors.emplace_back(schema->GetType());
+  }
+  for (size_t i = 0; i < rows; ++i) {
+    int64_t n = static_cast<int64_t>(i) - 25;
+    std::vector<std::any> record(schemas.size());
+    record[0] = int32_t(n * 1000);
+    vectors[0].Append(int32_t(n * 1000));
+    if (i % 5 == 2) {
+      vectors[1].AppendNull();
+      vectors[2].AppendNull();
+      vectors[4].AppendNull();
+    } else {
+      record[1] = n * 123456789;
+      vectors[1].Append(n * 123456789);
+      // -0.0 and NaN as well, whose key bytes follow the sign test.
+      double real = i == 11   ? -0.0
+                    : i == 13 ? std::numeric_limits<double>::quiet_NaN()
+                              : n * 0.75;
+      record[2] = real;
+      vectors[2].Append(real);
+      record[4] = float(real) / 3;
+      vectors[4].Append(float(real) / 3);
+    }
+    record[3] = i % 2 == 0;
+    vectors[3].Append(i % 2 == 0);
+    record[5] = "row " + std::to_string(i);
+    vectors[5].AppendString("row " + std::to_string(i));
+    records.push_back(std::move(record));
+  }
+  std::vector<ColumnArray> columns;
+  for (const auto& vector : vectors) {
+    columns.push_back(vector.Array());
+  }
+
+  // the fixed width keys built column by column are those of EncodeKey, alone
+  // and in the rows of EncodeBatch.
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  EncodedBatch keys, batch;
+  ASSERT_EQ(0, re.EncodeKeys('r', columns, rows, keys));
+  ASSERT_EQ(0, re.EncodeBatch('r', columns, rows, batch));
+  ASSERT_EQ(rows, keys.Size());
+  ASSERT_EQ(rows, batch.Size());
+  for (size_t i = 0; i < rows; ++i) {
+    std::string key, value;
+    ASSERT_EQ(0, re.Encode('r', records[i], key, value));
+    EXPECT_EQ(key, keys.Key(i)) << i;
+    EXPECT_TRUE(keys.Value(i).empty());
+    EXPECT_EQ(key, batch.Key(i)) << i;
+    EXPECT_EQ(value, batch.Value(i)) << i;
+  }
+  EXPECT_EQ(rows * keys.Key(0).size(), keys.Arena().size());
+
+  // a string key is left to the schema row by row.
+  name->SetIsKey(true);
+  RecordEncoderV2 string_key(1, schemas, 9L, this->le);
+  ASSERT_EQ(0, string_key.EncodeKeys('r', columns, rows, keys));
+  ASSERT_EQ(rows, keys.Size());
+  for (size_t i = 0; i < rows; ++i) {
+    std::string key;
+    string_key.EncodeKey('r', records[i], key);
+    EXPECT_EQ(key, keys.Key(i)) << i;
+  }
+  name->SetIsKey(false);
+
+  // a null in a key column that does not allow it, and a wrong type.
+  ColumnVector nulls(BaseSchema::kInteger);
+  nulls.Append(int32_t(1));
+  nulls.AppendNull();
+  std::vector<ColumnArray> null_columns = columns;
+  null_columns[0] = nulls.Array();
+  EXPECT_THROW(re.EncodeKeys('r', null_columns, 2, keys), std::runtime_error);
+  columns[1] = nulls.Array();
+  EXPECT_EQ(-1, re.EncodeKeys('r', columns, 2, keys));
+}
+
+TEST_F(DingoSerialTest, recordProjectionStopsEarly) {
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto code = std::make_shared<DingoSchema<std::string>>();
+  code->SetIndex(1);
+  code->SetIsKey(true);
+  auto age = std::make_shared<DingoSchema<int32_t>>();
+  age->SetIndex(2);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(3);
+  name->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, code, age, name};
+
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  std::vector<std::any> record{int64_t(-42), std::string("code"), int32_t(7),
+                               std::string("name")};
+  std::string key, value;
+  ASSERT_EQ(0, re.Encode('r', record, key, value));
+
+  // the key with the bytes of code cut down to one that is no string key:
+  // prefix | id | garbage | codec version.
+  std::string cut = key.substr(0, 9 + 8) + "\x07" + key.substr(key.size() - 4);
+
+  std::unordered_map<int, int> id_only{{0, 0}};
+  std::vector<std::any> projected;
+  ASSERT_EQ(0, rd.Decode(cut, value, id_only, projected));
+  ASSERT_EQ(1, projected.size());
+  EXPECT_EQ(-42, std::any_cast<int64_t>(projected[0]));
+
+  // with a plan the key stops after id and only the projected values are
+  // visited.
+  std::unordered_map<int, int> id_and_age{{0, 1}, {2, 0}};
+  DecodePlan plan = rd.NewDecodePlan(id_and_age);
+  EXPECT_EQ(1, plan.KeyEnd());
+  EXPECT_EQ(std::vector<size_t>{2}, plan.ValueColumns());
+  ASSERT_EQ(0, rd.Decode(cut, value, plan, projected));
+  ASSERT_EQ(2, projected.size());
+  EXPECT_EQ(7, std::any_cast<int32_t>(projected[0]));
+  EXPECT_EQ(-42, std::any_cast<int64_t>(projected[1]));
+
+  std::vector<KeyValue> rows{KeyValue(cut, value)};
+  ColumnBatch batch;
+  ASSERT_EQ(0, rd.DecodeBatch(rows, plan, batch));
+  EXPECT_EQ(7, batch.Column(0).Get<int32_t>(0));
+  EXPECT_EQ(-42, batch.Column(1).Get<int64_t>(0));
+
+  // the whole key is still checked when a later key column is projected.
+  std::unordered_map<int, int> code_only{{1, 0}};
+  EXPECT_THROW(rd.Decode(cut, value, rd.NewDecodePlan(code_only), projected),
+               std::runtime_error);
+  ASSERT_EQ(0, rd.Decode(key, value, rd.NewDecodePlan(code_only), projected));
+  EXPECT_EQ("code", std::any_cast<std::string>(projected[0]));
+}
+
+TEST_F(DingoSerialTest, recordIndexKey) {
+  auto id = std::make_shared<DingoSchema<int32_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  auto tenant = std::make_shared<DingoSchema<std::string>>();
+  tenant->SetIndex(1);
+  tenant->SetIsKey(true);
+  auto path = std::make_shared<DingoSchema<std::string>>();
+  path->SetIndex(2);
+  path->SetIsKey(true);
+  path->SetEscapedKey(true);
+  auto tag = std::make_shared<DingoSchema<std::string>>();
+  tag->SetIndex(3);
+  tag->SetIsKey(true);
+  tag->SetAllowNull(true);
+  tag->SetDescending(true);
+  auto score = std::make_shared<DingoSchema<double>>();
+  score->SetIndex(4);
+  auto name = std::make_shared<DingoSchema<std::string>>();
+  name->SetIndex(5);
+  name->SetIsKey(true);
+  name->SetAllowNull(true);
+  std::vector<BaseSchemaPtr> schemas{id, tenant, path, tag, score, name};
+
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  std::vector<std::vector<std::any>> records{
+      {int32_t(7), std::string("tenant-with-a-long-name"),
+       std::string("a\0b/c", 5), std::string("blue"), 1.5,
+       std::string("seventh")},
+      {int32_t(-3), std::string(), std::string(), std::any(), 2.5, std::any()},
+  };
+
+  for (const auto& record : records) {
+    std::string key, value;
+    ASSERT_EQ(0, re.Encode('r', record, key, value));
+    std::vector<uint32_t> offsets;
+    ASSERT_EQ(0, rd.IndexKey(key, offsets));
+    ASSERT_EQ(schemas.size() + 1, offsets.size());
+    EXPECT_EQ(9, offsets[0]);
+    EXPECT_EQ(key.size() - 4, offsets.back());
+    // the value column takes no key bytes.
+    EXPECT_EQ(offsets[4], offsets[5]);
+
+    // each key column alone, as its schema writes it.
+    for (size_t i : {0, 1, 2, 3, 5}) {
+      Buf column(64, this->le);
+      schemas[i]->EncodeKey(record[i], column);
+      EXPECT_EQ(column.GetString(),
+                key.substr(offsets[i], offsets[i + 1] - offsets[i]))
+          << i;
+    }
+
+    // the projection reads only its key columns, the value one stays.
+    std::unordered_map<int, int> index_serial{{5, 0}, {0, 1}, {4, 2}};
+    DecodePlan plan = rd.NewDecodePlan(index_serial);
+    std::vector<ColumnValue> projected;
+    ASSERT_EQ(0, rd.DecodeKey(key, offsets, plan, projected));
+    ASSERT_EQ(3, projected.size());
+    if (record[5].has_value()) {
+      EXPECT_EQ(std::any_cast<std::string>(record[5]),
+                std::get<std::string>(projected[0]));
+    } else {
+      EXPECT_TRUE(IsNull(projected[0]));
+    }
+    EXPECT_EQ(std::any_cast<int32_t>(record[0]), std::get<int32_t>(projected[1]));
+    EXPECT_TRUE(IsNull(projected[2]));
+
+    // predicates on any key column, reusing the offsets.
+    bool matched = false;
+    ASSERT_EQ(0, rd.Evaluate(key, offsets,
+                             EncodedPredicate::Equal(0, record[0]), matched));
+    EXPECT_TRUE(matched);
+    ASSERT_EQ(0, rd.Evaluate(key, offsets,
+                             EncodedPredicate::Equal(2, record[2]), matched));
+    EXPECT_TRUE(matched);
+    ASSERT_EQ(0, rd.Evaluate(key, offsets, EncodedPredicate::IsNull(3),
+                             matched));
+    EXPECT_EQ(!record[3].has_value(), matched);
+    ASSERT_EQ(0, rd.Evaluate(key, offsets,
+                             EncodedPredicate::Equal(1, std::string("x")),
+                             matched));
+    EXPECT_FALSE(matched);
+    EXPECT_EQ(-1, rd.Evaluate(key, offsets,
+                              EncodedPredicate::Equal(4, 1.5), matched));
+  }
+
+  // a key cut inside a string column.
+  std::string key, value;
+  re.Encode('r', records[0], key, value);
+  std::string cut = key.substr(0, 9 + 4 + 5) + key.substr(key.size() - 4);
+  std::vector<uint32_t> offsets;
+  EXPECT_EQ(-1, rd.IndexKey(cut, offsets));
+  EXPECT_EQ(-1, rd.IndexKey(key.substr(0, key.size() - 1), offsets));
+}
+
+TEST_F(DingoSerialTest, recordValueLayout) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(true);
+    schemas.push_back(schema);
+    return schema;
+  };
+  add(std::make_shared<DingoSchema<int32_t>>(), true);
+  add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<int32_t>>(), false);
+  add(std::make_shared<DingoSchema<double>>(), false)->SetAccessFrequency(10);
+  add(std::make_shared<DingoSchema<bool>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), false)
+      ->SetAccessFrequency(5);
+
+  std::vector<std::any> record{int32_t(7),
+                               std::vector<int64_t>{1, -2, 3},
+                               std::string("cold"),
+                               int32_t(-9),
+                               2.5,
+                               true,
+                               std::string("hot")};
+
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  re.SetStaticOffsets(true);
+  std::string key, value;
+  ASSERT_EQ(0, re.Encode('r', record, key, value));
+
+  // the hot double, the other fixed width columns, the hot string, then the
+  // cold one and the list.
+  BufView value_buf(value, this->le);
+  int version = value_buf.ReadInt();
+  ValueHeader header(value_buf, GetValueFormat(version));
+  ASSERT_EQ(6, header.entry_cnt);
+  EXPECT_EQ(3, header.fixed_cnt);
+  std::vector<int> ids;
+  for (int i = 0; i < header.entry_cnt; ++i) {
+    ids.push_back(header.ReadId(value_buf, i));
+  }
+  EXPECT_EQ((std::vector<int>{4, 3, 5, 6, 2, 1}), ids);
+
+  auto check = [&](RecordDecoderV2& rd) {
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, rd.Decode(key, value, decoded));
+    EXPECT_EQ(-9, std::any_cast<int32_t>(decoded[3]));
+    EXPECT_EQ(2.5, std::any_cast<double>(decoded[4]));
+    EXPECT_TRUE(std::any_cast<bool>(decoded[5]));
+    EXPECT_EQ("hot", std::any_cast<std::string>(decoded[6]));
+    EXPECT_EQ("cold", std::any_cast<std::string>(decoded[2]));
+    EXPECT_EQ((std::vector<int64_t>{1, -2, 3}),
+              std::any_cast<std::vector<int64_t>>(decoded[1]));
+  };
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  check(rd);
+
+  // a reader without the hints lays the columns out otherwise, the id table
+  // still finds them.
+  std::vector<BaseSchemaPtr> plain;
+  for (const auto& schema : schemas) {
+    auto copy = schema->Clone();
+    copy->SetIndex(schema->GetIndex());
+    copy->SetIsKey(schema->IsKey());
+    copy->SetAllowNull(true);
+    plain.push_back(copy);
+  }
+  RecordDecoderV2 plain_rd(1, plain, 9L, this->le);
+  check(plain_rd);
+
+  // SortSchema orders the value schemas the same way, the key stays.
+  auto sorted = schemas;
+  SortSchema(sorted);
+  std::vector<int> order;
+  for (const auto& schema : sorted) {
+    order.push_back(schema->GetIndex());
+  }
+  EXPECT_EQ((std::vector<int>{0, 4, 3, 5, 6, 2, 1}), order);
+}
+
+TEST_F(DingoSerialTest, recordFixedLengthString) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](auto schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(true);
+    schemas.push_back(schema);
+    return schema;
+  };
+  add(std::make_shared<DingoSchema<std::string>>(), true)->SetFixedLength(16);
+  add(std::make_shared<DingoSchema<int32_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), false)->SetFixedLength(32);
+  add(std::make_shared<DingoSchema<int64_t>>(), false);
+
+  // the key and value lengths are known, the column is one of fixed width.
+  auto columns = CompileColumnDescriptors(schemas);
+  EXPECT_EQ(17, columns[0].key_length);
+  EXPECT_EQ(0, columns[2].value_length);
+  EXPECT_EQ(32, columns[3].value_length);
+
+  std::string id(16, '\0');
+  std::string uuid(32, '\0');
+  for (int i = 0; i < 32; ++i) {
+    uuid[i] = static_cast<char>(i * 37);
+    if (i < 16) {
+      id[i] = static_cast<char>(255 - i);
+    }
+  }
+  std::vector<std::any> record{id, int32_t(3), std::string("name"), uuid,
+                               int64_t(-5)};
+
+  for (bool static_offsets : {false, true}) {
+    RecordEncoderV2 re(1, schemas, 9L, this->le);
+    re.SetStaticOffsets(static_offsets);
+    std::string key, value;
+    ASSERT_EQ(0, re.Encode('r', record, key, value));
+    EXPECT_EQ(9 + 17 + 5 + 4, key.size());
+    EXPECT_EQ(id, key.substr(10, 16));
+
+    BufView value_buf(value, this->le);
+    int version = value_buf.ReadInt();
+    EXPECT_NE(0, GetValueFormat(version) & VALUE_FORMAT_FIXED_STRINGS);
+    EXPECT_EQ(1, version & kSchemaVersionMask);
+    if (static_offsets) {
+      ValueHeader header(value_buf, GetValueFormat(version));
+      EXPECT_EQ(2, header.fixed_cnt);
+      EXPECT_EQ(3, header.ReadId(value_buf, 0));
+      EXPECT_EQ(4, header.ReadId(value_buf, 1));
+    }
+
+    RecordDecoderV2 rd(1, schemas, 9L, this->le);
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, rd.Decode(key, value, decoded));
+    EXPECT_EQ(id, std::any_cast<std::string>(decoded[0]));
+    EXPECT_EQ(3, std::any_cast<int32_t>(decoded[1]));
+    EXPECT_EQ("name", std::any_cast<std::string>(decoded[2]));
+    EXPECT_EQ(uuid, std::any_cast<std::string>(decoded[3]));
+    EXPECT_EQ(-5, std::any_cast<int64_t>(decoded[4]));
+
+    // null keeps the room of the bytes, a new id goes in place.
+    auto null_record = record;
+    null_record[0] = std::any();
+    null_record[3] = std::any();
+    std::string null_key, null_value;
+    ASSERT_EQ(0, re.Encode('r', null_record, null_key, null_value));
+    EXPECT_EQ(key.size(), null_key.size());
+    ASSERT_EQ(0, rd.Decode(null_key, null_value, decoded));
+    EXPECT_FALSE(decoded[0].has_value());
+    EXPECT_FALSE(decoded[3].has_value());
+    EXPECT_EQ(-5, std::any_cast<int64_t>(decoded[4]));
+
+    std::string other(32, 'u');
+    std::string updated;
+    ASSERT_LT(0, re.UpdateValue(value, {{3, other}}, updated));
+    EXPECT_EQ(value.size(), updated.size());
+    ASSERT_EQ(0, rd.Decode(key, updated, decoded));
+    EXPECT_EQ(other, std::any_cast<std::string>(decoded[3]));
+    EXPECT_EQ("name", std::any_cast<std::string>(decoded[2]));
+
+    // data of another length is not encoded.
+    auto wrong = record;
+    wrong[3] = std::string("short");
+    EXPECT_THROW(re.Encode('r', wrong, key, value), std::runtime_error);
+  }
+}
+
+TEST_F(DingoSerialTest, recordStringValueView) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](auto schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(true);
+    schemas.push_back(schema);
+    return schema;
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), false)
+      ->SetDictionary(std::make_shared<StringDictionary>(
+          std::vector<std::string>{"beijing", "shanghai"}));
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<int32_t>>(), false);
+
+  std::vector<std::any> record{int64_t(1), std::string(300, 'n'),
+                               std::string("shanghai"), std::any(), int32_t(2)};
+  RecordEncoderV2 re(1, schemas, 9L, this->le);
+  RecordDecoderV2 rd(1, schemas, 9L, this->le);
+  std::string key, value;
+  ASSERT_EQ(0, re.Encode('r', record, key, value));
+
+  // the plain string is viewed in place, the code in the dictionary.
+  std::string_view view;
+  ASSERT_EQ(0, rd.DecodeStringView(key, value, 1, view));
+  EXPECT_EQ(std::string(300, 'n'), view);
+  EXPECT_GE(view.data(), value.data());
+  EXPECT_LE(view.data() + view.size(), value.data() + value.size());
+  ASSERT_EQ(0, rd.DecodeStringView(key, value, 2, view));
+  EXPECT_EQ("shanghai", view);
+  ASSERT_EQ(0, rd.DecodeStringView(key, value, 3, view));
+  EXPECT_EQ(nullptr, view.data());
+
+  // an empty string is not null.
+  record[1] = std::string();
+  ASSERT_EQ(0, re.Encode('r', record, key, value));
+  ASSERT_EQ(0, rd.DecodeStringView(key, value, 1, view));
+  EXPECT_NE(nullptr, view.data());
+  EXPECT_TRUE(view.empty());
+
+  EXPECT_EQ(-1, rd.DecodeStringView(key, value, 0, view));
+  EXPECT_EQ(-1, rd.DecodeStringView(key, value, 4, view));
+  EXPECT_EQ(-1, rd.DecodeStringView(key, value, 5, view));
+}
+
+TEST_F(DingoSerialTest, recordIndexKeyBuilder) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key, bool allow_null) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(allow_null);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true, false);
+  add(std::make_shared<DingoSchema<std::string>>(), false, true);
+  add(std::make_shared<DingoSchema<int32_t>>(), false, true);
+  add(std::make_shared<DingoSchema<std::string>>(), true, false);
+  add(std::make_shared<DingoSchema<double>>(), false, true);
+  add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false, true);
+
+  std::vector<IndexDefinition> indexes{
+      {101, {1}},            // city, then the table key id and name.
+      {102, {2, 1}, true},   // age and city alone.
+      {103, {3, 4}}};        // name and score, then id.
+  IndexKeyBuilder builder(88, schemas, indexes, this->le);
+  EXPECT_EQ(3, builder.IndexCount());
+
+  // the key RecordEncoderV2 writes with columns as the key columns.
+  auto expected_key = [&](int64_t common_id, const std::vector<int>& columns,
+                          const std::vector<std::any>& record) {
+    std::vector<BaseSchemaPtr> key_schemas;
+    std::vector<std::any> key_record;
+    for (int column : columns) {
+      auto schema = schemas[column]->Clone();
+      schema->SetIndex(key_schemas.size());
+      schema->SetIsKey(true);
+      schema->SetAllowNull(schemas[column]->AllowNull());
+      key_schemas.push_back(schema);
+      key_record.push_back(record[column]);
+    }
+    RecordEncoderV2 re(1, key_schemas, common_id, this->le);
+    std::string key;
+    re.EncodeKey('i', key_record, key);
+    return key;
+  };
+
+  std::vector<std::vector<std::any>> records{
+      {int64_t(7), std::string("beijing"), int32_t(30), std::string("alice"),
+       1.5, std::vector<int64_t>{1, 2}},
+      {int64_t(-3), std::any(), std::any(), std::string(20, 'b'), std::any(),
+       std::any()}};
+  std::vector<std::string> keys;
+  for (const auto& record : records) {
+    ASSERT_EQ(4, builder.Build('i', record, keys));
+    ASSERT_EQ(4, keys.size());
+    EXPECT_EQ(expected_key(88, {0, 3}, record), keys[0]);
+    EXPECT_EQ(expected_key(101, {1, 0, 3}, record), keys[1]);
+    EXPECT_EQ(expected_key(102, {2, 1}, record), keys[2]);
+    EXPECT_EQ(expected_key(103, {3, 4, 0}, record), keys[3]);
+
+    // the row key is the one of the table encoder.
+    RecordEncoderV2 re(1, schemas, 88, this->le);
+    std::string key;
+    re.EncodeKey('i', record, key);
+    EXPECT_EQ(key, keys[0]);
+
+    std::vector<ColumnValue> values = FromAny(record);
+    std::vector<std::string> variant_keys;
+    ASSERT_EQ(4, builder.Build('i', values, variant_keys));
+    EXPECT_EQ(keys, variant_keys);
+  }
+
+  EXPECT_THROW(IndexKeyBuilder(88, schemas, {{104, {5}}}, this->le),
+               std::runtime_error);
+  EXPECT_THROW(IndexKeyBuilder(88, schemas, {{104, {6}}}, this->le),
+               std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordRowExporter) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<double>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<int32_t>>>(), false);
+  add(std::make_shared<DingoSchema<bool>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<std::string>>>(), false);
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  auto rd = std::make_shared<RecordDecoderV2>(1, schemas, 5L, this->le);
+
+  std::vector<KeyValue> rows;
+  auto add_row = [&](const std::vector<std::any>& record) {
+    std::string key, value;
+    ASSERT_EQ(0, re.Encode('r', record, key, value));
+    rows.emplace_back(key, value);
+  };
+  add_row({int64_t(-7), std::string("plain"), 0.1,
+           std::vector<int32_t>{1, -2, 3}, true,
+           std::vector<std::string>{"a", "b\"c"}});
+  add_row({int64_t(9), std::string("a,\"quoted\"\nline"),
+           std::numeric_limits<double>::infinity(), std::vector<int32_t>{},
+           false, std::any()});
+  add_row({int64_t(10), std::string(), std::any(), std::any(), std::any(),
+           std::vector<std::string>{}});
+
+  // every column, in a reordered projection.
+  std::unordered_map<int, int> all{{0, 0}, {1, 1}, {2, 2},
+                                   {3, 3}, {4, 4}, {5, 5}};
+  std::vector<std::string> names{"id", "name", "score", "tags", "ok", "words"};
+  RowExporter csv(rd, all, names, ExportFormat::kCsv);
+  std::string out;
+  csv.Header(out);
+  ASSERT_EQ(3, csv.Export(rows.data(), rows.size(), out));
+  EXPECT_EQ(
+      "id,name,score,tags,ok,words\n"
+      "-7,plain,0.1,\"[1,-2,3]\",true,\"[\"\"a\"\",\"\"b\\\"\"c\"\"]\"\n"
+      "9,\"a,\"\"quoted\"\"\nline\",inf,[],false,\n"
+      "10,\"\",,,,[]\n",
+      out);
+
+  RowExporter json(rd, all, names, ExportFormat::kJsonLines);
+  out.clear();
+  json.Header(out);
+  ASSERT_EQ(3, json.Export(rows.data(), rows.size(), out));
+  EXPECT_EQ(
+      "{\"id\":-7,\"name\":\"plain\",\"score\":0.1,\"tags\":[1,-2,3],"
+      "\"ok\":true,\"words\":[\"a\",\"b\\\"c\"]}\n"
+      "{\"id\":9,\"name\":\"a,\\\"quoted\\\"\\nline\",\"score\":null,"
+      "\"tags\":[],\"ok\":false,\"words\":null}\n"
+      "{\"id\":10,\"name\":\"\",\"score\":null,\"tags\":null,\"ok\":null,"
+      "\"words\":[]}\n",
+      out);
+
+  // UTF-8 kept, every other byte of a string as U+FFFD: a lone byte, an
+  // overlong slash, a surrogate and a cut sequence.
+  std::string key, value;
+  ASSERT_EQ(0, re.Encode('r',
+                         {int64_t(11),
+                          std::string("caf\xC3\xA9 \xF0\x9F\x98\x80 \xFF "
+                                      "\xC0\xAF \xED\xA0\x80 \xE2\x82"),
+                          std::any(), std::any(), std::any(), std::any()},
+                         key, value));
+  RowExporter names_only(rd, {{0, 0}, {1, 1}}, {"id", "name"},
+                         ExportFormat::kJsonLines);
+  out.clear();
+  ASSERT_EQ(0, names_only.Export(key, value, out));
+  EXPECT_EQ(
+      "{\"id\":11,\"name\":\"caf\xC3\xA9 \xF0\x9F\x98\x80 \\ufffd "
+      "\\ufffd\\ufffd \\ufffd\\ufffd\\ufffd \\ufffd\\ufffd\"}\n",
+      out);
+
+  // a projection, slots give the output order.
+  RowExporter projected(rd, {{2, 0}, {0, 1}}, {"score", "id"},
+                        ExportFormat::kCsv);
+  out.clear();
+  ASSERT_EQ(0, projected.Export(rows[0].GetKey(), rows[0].GetValue(), out));
+  EXPECT_EQ("0.1,-7\n", out);
+
+  // a row of a newer schema version leaves out alone.
+  std::string newer_value;
+  RecordEncoderV2(2, schemas, 5L, this->le)
+      .EncodeValue({int64_t(-7), std::string("plain"), 0.1, std::any(), true,
+                    std::any()},
+                   newer_value);
+  EXPECT_EQ(-1, projected.Export(rows[0].GetKey(), newer_value, out));
+  EXPECT_EQ("0.1,-7\n", out);
+  EXPECT_THROW(RowExporter(rd, all, {"id"}, ExportFormat::kCsv),
+               std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordColumnPeek) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<int64_t>>(), false);
+  add(std::make_shared<DingoSchema<float>>(), false);
+  add(std::make_shared<DingoSchema<bool>>(), false);
+  add(std::make_shared<DingoSchema<int32_t>>(), false);
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  RecordDecoderV2 rd(1, schemas, 5L, this->le);
+
+  std::string key, value, null_key, null_value;
+  ASSERT_EQ(0, re.Encode('r',
+                         std::vector<std::any>{int64_t(1), std::string("row"),
+                                               int64_t(1700000000123L), 2.5f,
+                                               true, int32_t(-3)},
+                         key, value));
+  ASSERT_EQ(0, re.Encode('r',
+                         std::vector<std::any>{int64_t(2), std::any(),
+                                               std::any(), std::any(),
+                                               std::any(), std::any()},
+                         null_key, null_value));
+
+  auto ts = rd.NewColumnPeek(2);
+  auto score = rd.NewColumnPeek(3);
+  auto flag = rd.NewColumnPeek(4);
+  auto small = rd.NewColumnPeek(5);
+  std::optional<int64_t> number;
+  std::optional<double> real;
+  ASSERT_EQ(0, rd.Peek(ts, value, number));
+  EXPECT_EQ(1700000000123L, number);
+  ASSERT_EQ(0, rd.Peek(flag, value, number));
+  EXPECT_EQ(1, number);
+  ASSERT_EQ(0, rd.Peek(small, value, number));
+  EXPECT_EQ(-3, number);
+  ASSERT_EQ(0, rd.Peek(score, value, real));
+  EXPECT_EQ(2.5, real);
+
+  for (const auto& peek : {ts, flag, small}) {
+    number = 7;
+    ASSERT_EQ(0, rd.Peek(peek, null_value, number));
+    EXPECT_FALSE(number.has_value());
+  }
+  real = 1.0;
+  ASSERT_EQ(0, rd.Peek(score, null_value, real));
+  EXPECT_FALSE(real.has_value());
+
+  // a column the writer lacked reads as null.
+  auto wider = schemas;
+  auto added = std::make_shared<DingoSchema<int64_t>>();
+  added->SetIndex(wider.size());
+  added->SetAllowNull(true);
+  wider.push_back(added);
+  RecordDecoderV2 wider_rd(1, wider, 5L, this->le);
+  ASSERT_EQ(0, wider_rd.Peek(wider_rd.NewColumnPeek(6), value, number));
+  EXPECT_FALSE(number.has_value());
+
+  // the other kind of number, a value of another schema version.
+  EXPECT_EQ(-1, rd.Peek(ts, value, real));
+  EXPECT_EQ(-1, rd.Peek(score, value, number));
+  std::string newer_value;
+  RecordEncoderV2(2, schemas, 5L, this->le)
+      .EncodeValue(std::vector<std::any>{int64_t(1), std::any(), int64_t(5),
+                                         std::any(), std::any(), std::any()},
+                   newer_value);
+  EXPECT_EQ(-1, rd.Peek(ts, newer_value, number));
+  // key columns and columns of no fixed width have no peek.
+  EXPECT_THROW(rd.NewColumnPeek(0), std::runtime_error);
+  EXPECT_THROW(rd.NewColumnPeek(1), std::runtime_error);
+  EXPECT_THROW(rd.NewColumnPeek(9), std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordValueRewriter) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<int64_t>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<double>>>(), false);
+  add(std::make_shared<DingoSchema<int32_t>>(), false);
+
+  // after dropping column 2 the table is schema version 2, the columns after
+  // it moved down one id.
+  std::vector<BaseSchemaPtr> dropped;
+  for (int i : {0, 1, 3, 4, 5}) {
+    auto schema = schemas[i]->Clone();
+    schema->SetIndex(dropped.size());
+    schema->SetIsKey(schemas[i]->IsKey());
+    schema->SetAllowNull(schemas[i]->AllowNull());
+    dropped.push_back(schema);
+  }
+  ValueRewriter rewriter({0, 1, ValueRewriter::kDrop, 2, 3, 4}, this->le);
+  rewriter.SetSchemaVersion(2);
+  RecordDecoderV2 rd(2, dropped, 5L, this->le);
+
+  std::vector<std::vector<std::any>> records{
+      {int64_t(1), std::string("keep"), std::string(5000, 'x'), int64_t(7),
+       std::vector<double>{1.5, 2.5}, int32_t(-9)},
+      {int64_t(2), std::any(), std::string("gone"), std::any(),
+       std::vector<double>{}, int32_t(4)},
+      {int64_t(3), std::string("only"), std::any(), int64_t(8), std::any(),
+       std::any()}};
+  for (int layout = 0; layout < 3; ++layout) {
+    RecordEncoderV2 re(1, schemas, 5L, this->le);
+    re.SetCompactValueHeader(layout > 0);
+    re.SetNullBitmap(layout > 1);
+    for (const auto& record : records) {
+      std::string key, value, rewritten;
+      ASSERT_EQ(0, re.Encode('r', record, key, value));
+      ASSERT_GT(rewriter.Rewrite(value, rewritten), 0);
+      EXPECT_EQ(1, rewriter.Affects(value));
+      if (record[2].has_value()) {
+        EXPECT_LT(rewritten.size(), value.size());
+      }
+
+      std::vector<std::any> decoded;
+      ASSERT_EQ(0, rd.Decode(key, rewritten, decoded));
+      ASSERT_EQ(5, decoded.size());
+      auto expect_same = [&](const std::any& expected, const std::any& actual,
+                             auto tag) {
+        using T = decltype(tag);
+        ASSERT_EQ(expected.has_value(), actual.has_value());
+        if (expected.has_value()) {
+          EXPECT_EQ(std::any_cast<T>(expected), std::any_cast<T>(actual));
+        }
+      };
+      expect_same(record[0], decoded[0], int64_t());
+      expect_same(record[1], decoded[1], std::string());
+      expect_same(record[3], decoded[2], int64_t());
+      expect_same(record[4], decoded[3], std::vector<double>());
+      expect_same(record[5], decoded[4], int32_t());
+    }
+  }
+
+  // compressed and static offsets values are left to a full rewrite.
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  re.SetStaticOffsets(true);
+  std::string key, value, rewritten;
+  ASSERT_EQ(0, re.Encode('r', records[0], key, value));
+  EXPECT_EQ(-1, rewriter.Rewrite(value, rewritten));
+  EXPECT_EQ(-1, rewriter.Affects(value));
+  EXPECT_EQ(-1, rewriter.Rewrite(value.substr(0, 6), rewritten));
+  // so are checksummed values, compressed or not.
+  for (int compress = 0; compress < 2; ++compress) {
+    RecordEncoderV2 checksum_re(1, schemas, 5L, this->le);
+    checksum_re.SetChecksum(true);
+    if (compress == 1) {
+      checksum_re.SetCompression(CompressionType::kZlib, 0);
+    }
+    ASSERT_EQ(0, checksum_re.Encode('r', records[0], key, value));
+    EXPECT_EQ(-1, rewriter.Rewrite(value, rewritten)) << compress;
+    EXPECT_EQ(-1, rewriter.Affects(value)) << compress;
+  }
+
+  // column 1 moved onto column 5, which keeps its id past the map.
+  RecordEncoderV2 plain(1, schemas, 5L, this->le);
+  ASSERT_EQ(0, plain.Encode('r', records[0], key, value));
+  EXPECT_EQ(-1, ValueRewriter({0, 5}, this->le).Rewrite(value, rewritten));
+  // a drop of a column the value does not hold changes nothing.
+  EXPECT_EQ(0, ValueRewriter({0, 1, 2, 3, 4, 5, 6, ValueRewriter::kDrop},
+                             this->le)
+                   .Affects(value));
+
+  EXPECT_THROW(ValueRewriter({0, 1, 1}), std::runtime_error);
+  EXPECT_THROW(ValueRewriter({0, -2}), std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordDeltaMerge) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<int64_t>>(), false);
+  add(std::make_shared<DingoSchema<int32_t>>(), false);
+  add(std::make_shared<DingoSchema<double>>(), false);
+  add(std::make_shared<DingoSchema<float>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<double>>>(), false);
+  add(std::make_shared<DingoSchema<bool>>(), false);
+  std::static_pointer_cast<DingoSchema<int64_t>>(schemas.at(1))->SetVarint(true);
+
+  DeltaRecordEncoder de(1, schemas, this->le);
+  std::vector<std::string> deltas(3);
+  de.AddInt(1, 5);
+  de.AddInt(2, 1);
+  de.AddReal(3, 0.5);
+  ASSERT_GT(de.Encode(deltas[0]), 0);
+  de.Clear();
+  de.Set(5, std::string("new"));
+  de.AddInt(1, -10);
+  de.Set(7, std::any());
+  ASSERT_EQ(3, de.OpCount());
+  ASSERT_GT(de.Encode(deltas[1]), 0);
+  de.Clear();
+  de.AddReal(4, 1.5);
+  de.Set(3, 2.0);
+  de.AddReal(3, 0.25);
+  ASSERT_GT(de.Encode(deltas[2]), 0);
+  std::vector<std::string_view> operands(deltas.begin(), deltas.end());
+
+  std::vector<std::any> record{int64_t(1),
+                               int64_t(100),
+                               int32_t(INT32_MAX),
+                               1.0,
+                               std::any(),
+                               std::string("old"),
+                               std::vector<double>{1.5, 2.5},
+                               true};
+  // the counters wrap in their width, a null adds from zero.
+  std::vector<std::any> expected{int64_t(1),
+                                 int64_t(95),
+                                 int32_t(INT32_MIN),
+                                 2.25,
+                                 1.5f,
+                                 std::string("new"),
+                                 std::vector<double>{1.5, 2.5},
+                                 std::any()};
+
+  DeltaMerger merger(1, schemas, this->le);
+  RecordDecoderV2 rd(1, schemas, 5L, this->le);
+  auto expect_record = [&](const std::string& key, const std::string& value,
+                           const std::vector<std::any>& expect) {
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, rd.Decode(key, value, decoded));
+    ASSERT_EQ(expect.size(), decoded.size());
+    for (size_t i = 0; i < expect.size(); ++i) {
+      ASSERT_EQ(expect[i].has_value(), decoded[i].has_value()) << i;
+    }
+    EXPECT_EQ(std::any_cast<int64_t>(expect[1]),
+              std::any_cast<int64_t>(decoded[1]));
+    EXPECT_EQ(std::any_cast<int32_t>(expect[2]),
+              std::any_cast<int32_t>(decoded[2]));
+    EXPECT_EQ(std::any_cast<double>(expect[3]),
+              std::any_cast<double>(decoded[3]));
+    if (expect[4].has_value()) {
+      EXPECT_EQ(std::any_cast<float>(expect[4]),
+                std::any_cast<float>(decoded[4]));
+    }
+    if (expect[5].has_value()) {
+      EXPECT_EQ(std::any_cast<std::string>(expect[5]),
+                std::any_cast<std::string>(decoded[5]));
+    }
+    if (expect[6].has_value()) {
+      EXPECT_EQ(std::any_cast<std::vector<double>>(expect[6]),
+                std::any_cast<std::vector<double>>(decoded[6]));
+    }
+  };
+
+  for (int layout = 0; layout < 3; ++layout) {
+    RecordEncoderV2 re(1, schemas, 5L, this->le);
+    re.SetCompactValueHeader(layout > 0);
+    re.SetNullBitmap(layout > 1);
+    std::string key, value, merged;
+    ASSERT_EQ(0, re.Encode('r', record, key, value));
+    ASSERT_GT(merger.Merge(value, operands.data(), operands.size(), merged), 0);
+    expect_record(key, merged, expected);
+
+    // merging in steps gives the same row.
+    std::string step, folded;
+    ASSERT_GT(merger.Merge(value, operands.data(), 1, step), 0);
+    ASSERT_GT(merger.Merge(step, operands.data() + 1, 2, folded), 0);
+    expect_record(key, folded, expected);
+  }
+
+  // a row with no value yet holds the touched columns alone.
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  std::string key, value, merged;
+  ASSERT_EQ(0, re.Encode('r', record, key, value));
+  ASSERT_GT(merger.Merge("", operands.data(), 1, merged), 0);
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(key, merged, decoded));
+  EXPECT_EQ(5, std::any_cast<int64_t>(decoded[1]));
+  EXPECT_EQ(1, std::any_cast<int32_t>(decoded[2]));
+  EXPECT_EQ(0.5, std::any_cast<double>(decoded[3]));
+  EXPECT_FALSE(decoded[5].has_value());
+  EXPECT_FALSE(decoded[6].has_value());
+
+  // newer schemas, truncated deltas and layouts the merger does not take.
+  EXPECT_EQ(-1, DeltaMerger(0, schemas, this->le)
+                    .Merge(value, operands.data(), 1, merged));
+  std::string_view truncated = std::string_view(deltas[0]).substr(0, 10);
+  EXPECT_EQ(-1, merger.Merge(value, &truncated, 1, merged));
+  RecordEncoderV2 static_re(1, schemas, 5L, this->le);
+  static_re.SetStaticOffsets(true);
+  ASSERT_EQ(0, static_re.Encode('r', record, key, value));
+  EXPECT_EQ(-1, merger.Merge(value, operands.data(), 1, merged));
+  // a checksummed base, compressed or not, would lose its trailer.
+  for (int compress = 0; compress < 2; ++compress) {
+    RecordEncoderV2 checksum_re(1, schemas, 5L, this->le);
+    checksum_re.SetChecksum(true);
+    if (compress == 1) {
+      checksum_re.SetCompression(CompressionType::kZlib, 0);
+    }
+    ASSERT_EQ(0, checksum_re.Encode('r', record, key, value));
+    EXPECT_EQ(-1, merger.Merge(value, operands.data(), 1, merged)) << compress;
+  }
+
+  EXPECT_THROW(de.AddInt(3, 1), std::runtime_error);
+  EXPECT_THROW(de.AddReal(1, 1.0), std::runtime_error);
+  EXPECT_THROW(de.Set(0, int64_t(1)), std::runtime_error);
+  EXPECT_THROW(de.AddInt(8, 1), std::runtime_error);
+}
+
+TEST_F(DingoSerialTest, recordValueDiff) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<int64_t>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<double>>>(), false);
+  add(std::make_shared<DingoSchema<int32_t>>(), false);
+  add(std::make_shared<DingoSchema<double>>(), false);
+
+  std::vector<std::any> old_record{int64_t(1), std::string("same"),
+                                   int64_t(7), std::vector<double>{1.5, 2.5},
+                                   int32_t(3), std::any()};
+  std::vector<std::any> new_record{int64_t(1), std::string("same"),
+                                   int64_t(7), std::vector<double>{1.5, 3.5},
+                                   std::any(), 0.5};
+
+  ValueDiff diff(1, schemas, this->le);
+  DeltaMerger merger(1, schemas, this->le);
+  RecordDecoderV2 rd(1, schemas, 5L, this->le);
+  for (int layout = 0; layout < 4; ++layout) {
+    RecordEncoderV2 re(1, schemas, 5L, this->le);
+    re.SetCompactValueHeader(layout == 1);
+    re.SetNullBitmap(layout == 2);
+    if (layout == 3) {
+      re.SetCompression(CompressionType::kZlib, 0);
+    }
+    std::string key, old_value, new_value;
+    ASSERT_EQ(0, re.Encode('r', old_record, key, old_value));
+    ASSERT_GT(re.EncodeValue(new_record, new_value), 0);
+
+    std::vector<int> changed;
+    ASSERT_EQ(3, diff.Diff(old_value, new_value, changed));
+    EXPECT_EQ((std::vector<int>{3, 4, 5}), changed);
+    ASSERT_EQ(0, diff.Diff(old_value, old_value, changed));
+    EXPECT_TRUE(changed.empty());
+
+    EXPECT_EQ(1, diff.IsNoOpUpdate(re, old_value, old_record));
+    EXPECT_EQ(0, diff.IsNoOpUpdate(re, old_value, new_record));
+
+    // the patch folded into the old value gives the new row.
+    std::string patch, patched;
+    ASSERT_GT(diff.Patch(old_value, new_value, patch), 0);
+    EXPECT_LT(patch.size(), new_value.size());
+    std::string_view operand(patch);
+    ASSERT_GT(merger.Merge(old_value, &operand, 1, patched), 0);
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, rd.Decode(key, patched, decoded));
+    EXPECT_EQ("same", std::any_cast<std::string>(decoded[1]));
+    EXPECT_EQ(7, std::any_cast<int64_t>(decoded[2]));
+    EXPECT_EQ((std::vector<double>{1.5, 3.5}),
+              std::any_cast<std::vector<double>>(decoded[3]));
+    EXPECT_FALSE(decoded[4].has_value());
+    EXPECT_EQ(0.5, std::any_cast<double>(decoded[5]));
+    ASSERT_EQ(0, diff.Diff(new_value, patched, changed));
+  }
+
+  // a varint column reads other bytes, every column differs.
+  auto varint = schemas;
+  varint[2] = schemas[2]->Clone();
+  varint[2]->SetIndex(2);
+  varint[2]->SetAllowNull(true);
+  std::static_pointer_cast<DingoSchema<int64_t>>(varint[2])->SetVarint(true);
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  RecordEncoderV2 varint_re(1, varint, 5L, this->le);
+  std::string old_value, new_value;
+  ASSERT_GT(re.EncodeValue(old_record, old_value), 0);
+  ASSERT_GT(varint_re.EncodeValue(old_record, new_value), 0);
+  std::vector<int> changed;
+  EXPECT_EQ(4, diff.Diff(old_value, new_value, changed));
+
+  RecordEncoderV2 static_re(1, schemas, 5L, this->le);
+  static_re.SetStaticOffsets(true);
+  ASSERT_GT(static_re.EncodeValue(old_record, new_value), 0);
+  EXPECT_EQ(-1, diff.Diff(old_value, new_value, changed));
+  EXPECT_EQ(-1, diff.IsNoOpUpdate(static_re, old_value, old_record));
+
+  // checksummed values, compressed or not, on either side.
+  for (int compress = 0; compress < 2; ++compress) {
+    RecordEncoderV2 checksum_re(1, schemas, 5L, this->le);
+    checksum_re.SetChecksum(true);
+    if (compress == 1) {
+      checksum_re.SetCompression(CompressionType::kZlib, 0);
+    }
+    std::string checksum_value;
+    ASSERT_GT(checksum_re.EncodeValue(old_record, checksum_value), 0);
+    EXPECT_EQ(-1, diff.Diff(old_value, checksum_value, changed)) << compress;
+    EXPECT_EQ(-1, diff.Diff(checksum_value, old_value, changed)) << compress;
+    EXPECT_EQ(-1, diff.IsNoOpUpdate(checksum_re, checksum_value, old_record));
+    std::string patch;
+    EXPECT_EQ(-1, diff.Patch(old_value, checksum_value, patch)) << compress;
+  }
+}
+
+TEST_F(DingoSerialTest, recordBoolBits) {
+  // flags of a wide table, three bools to every long or string.
+  std::vector<BaseSchemaPtr> schemas;
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetIndex(0);
+  id->SetIsKey(true);
+  schemas.push_back(id);
+  for (int i = 1; i <= 40; ++i) {
+    BaseSchemaPtr column;
+    if (i % 4 != 0) {
+      column = std::make_shared<DingoSchema<bool>>();
+    } else if (i % 8 == 0) {
+      column = std::make_shared<DingoSchema<std::string>>();
+    } else {
+      column = std::make_shared<DingoSchema<int64_t>>();
+    }
+    column->SetIndex(i);
+    column->SetAllowNull(true);
+    schemas.push_back(column);
+  }
+
+  std::vector<std::any> record(schemas.size());
+  record[0] = int64_t(11);
+  for (int i = 1; i <= 40; ++i) {
+    if (i % 4 != 0) {
+      // every fifth bool null.
+      if (i % 5 != 0) {
+        record[i] = i % 3 == 1;
+      }
+    } else if (i % 8 == 0) {
+      record[i] = std::string(i, 's');
+    } else if (i != 20) {
+      record[i] = int64_t(-i);
+    }
+  }
+
+  RecordEncoderV2 plain_re(0, schemas, 0L, this->le);
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  RecordDecoderV2 trusted_rd(0, schemas, 0L, this->le);
+  trusted_rd.SetTrustedInput(true);
+  std::string key, plain_value;
+  plain_re.Encode('r', record, key, plain_value);
+
+  for (int variant = 0; variant < 3; ++variant) {
+    RecordEncoderV2 re(0, schemas, 0L, this->le);
+    re.SetBoolBits(true);
+    re.SetCompactValueHeader(variant == 1);
+    if (variant == 2) {
+      re.SetCompression(CompressionType::kZlib, 0);
+    }
+    std::string value;
+    re.EncodeValue(record, value);
+    if (variant != 2) {
+      EXPECT_EQ(value.size(), re.EncodedValueSize(record)) << "variant " << variant;
+      EXPECT_NE(0, PeekValueFormat(value, this->le) & VALUE_FORMAT_BOOL_BITS);
+    }
+    if (variant == 0) {
+      // 24 not null bools of 7 bytes each become a 2 bytes id and a bit, the
+      // 6 null bools and the null long leave the tables.
+      EXPECT_EQ(plain_value.size() + 2 - 24 * 7 + 24 * 2 + 3 + 2 - 7 * 6,
+                value.size());
+    }
+
+    for (auto* decoder : {&rd, &trusted_rd}) {
+      std::vector<std::any> decoded;
+      ASSERT_EQ(0, decoder->Decode(key, value, decoded));
+      for (size_t i = 1; i < schemas.size(); ++i) {
+        ASSERT_EQ(record[i].has_value(), decoded[i].has_value()) << i;
+        if (i % 4 != 0 && record[i].has_value()) {
+          EXPECT_EQ(std::any_cast<bool>(record[i]), std::any_cast<bool>(decoded[i])) << i;
+        }
+      }
+      EXPECT_EQ(-12, std::any_cast<int64_t>(decoded[12]));
+      EXPECT_EQ(std::string(40, 's'), std::any_cast<std::string>(decoded[40]));
+    }
+
+    std::vector<ColumnValue> values;
+    ASSERT_EQ(0, rd.Decode(key, value, values));
+    EXPECT_EQ(true, std::get<bool>(values[1]));
+    EXPECT_EQ(false, std::get<bool>(values[2]));
+    EXPECT_TRUE(IsNull(values[5]));
+
+    std::unordered_map<int, int> index_serial{{7, 0}, {10, 1}, {24, 2}, {39, 3}};
+    std::vector<std::any> projected;
+    ASSERT_EQ(0, rd.Decode(key, value, index_serial, projected));
+    EXPECT_TRUE(std::any_cast<bool>(projected[0]));
+    EXPECT_FALSE(projected[1].has_value());
+    EXPECT_EQ(std::string(24, 's'), std::any_cast<std::string>(projected[2]));
+    EXPECT_FALSE(std::any_cast<bool>(projected[3]));
+
+    std::vector<KeyValue> key_values(2);
+    key_values[0].Set(key, value);
+    key_values[1].Set(key, value);
+    auto plan = rd.NewDecodePlan({{0, 0}, {13, 1}, {15, 2}, {20, 3}});
+    ColumnBatch batch;
+    ASSERT_EQ(0, rd.DecodeBatch(key_values, plan, batch));
+    ASSERT_EQ(2, batch.NumRows());
+    for (size_t r = 0; r < batch.NumRows(); ++r) {
+      EXPECT_EQ(11, batch.Column(0).Get<int64_t>(r));
+      EXPECT_TRUE(batch.Column(1).Get<bool>(r));
+      EXPECT_TRUE(batch.Column(2).IsNull(r));
+      EXPECT_TRUE(batch.Column(3).IsNull(r));
+    }
+
+    if (variant != 2) {
+      bool is_null;
+      ASSERT_EQ(0, PeekIsNull(value, this->le, 2, is_null));
+      EXPECT_FALSE(is_null);
+      ASSERT_EQ(0, PeekIsNull(value, this->le, 15, is_null));
+      EXPECT_TRUE(is_null);
+      ASSERT_EQ(0, PeekIsNull(value, this->le, 16, is_null));
+      EXPECT_FALSE(is_null);
+      ASSERT_EQ(0, PeekIsNull(value, this->le, 20, is_null));
+      EXPECT_TRUE(is_null);
+    }
+
+    // the byte level writers leave the layout to a full rewrite.
+    std::string output;
+    EXPECT_EQ(-1, re.UpdateValue(value, {{12, int64_t(1)}}, output));
+    ValueDiff diff(0, schemas, this->le);
+    std::vector<int> changed;
+    EXPECT_EQ(-1, diff.Diff(value, value, changed));
+  }
+
+  // schemas without a bool value column keep their layout, batches are
+  // encoded row by row.
+  std::vector<BaseSchemaPtr> no_bools{schemas[0], schemas[4], schemas[8]};
+  RecordEncoderV2 no_bools_re(0, no_bools, 0L, this->le);
+  no_bools_re.SetBoolBits(true);
+  std::vector<std::any> no_bools_record(9);
+  no_bools_record[0] = int64_t(1);
+  no_bools_record[4] = int64_t(4);
+  no_bools_record[8] = std::string("8");
+  std::string no_bools_key, no_bools_value;
+  no_bools_re.Encode('r', no_bools_record, no_bools_key, no_bools_value);
+  EXPECT_EQ(0, PeekValueFormat(no_bools_value, this->le));
+
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  re.SetBoolBits(true);
+
+  // a row of bools alone, no data behind the bool section.
+  std::vector<std::any> bools_only(schemas.size());
+  bools_only[0] = int64_t(12);
+  bools_only[3] = true;
+  bools_only[38] = false;
+  std::string bools_key, bools_value;
+  re.Encode('r', bools_only, bools_key, bools_value);
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(bools_key, bools_value, decoded));
+  EXPECT_TRUE(std::any_cast<bool>(decoded[3]));
+  EXPECT_FALSE(std::any_cast<bool>(decoded[38]));
+  EXPECT_FALSE(decoded[4].has_value());
+  EXPECT_FALSE(decoded[5].has_value());
+
+  auto other = record;
+  other[1] = std::any();
+  other[3] = true;
+  std::vector<std::vector<std::any>> records{record, other};
+  EncodedBatch rows;
+  ASSERT_EQ(0, re.EncodeBatch('r', records, rows));
+  for (size_t i = 0; i < records.size(); ++i) {
+    std::string row_key, row_value;
+    re.Encode('r', records[i], row_key, row_value);
+    EXPECT_EQ(row_value, rows.Value(i));
+  }
+}
+
+TEST_F(DingoSerialTest, recordEncodingAdvisor) {
+  auto make_schemas = [] {
+    std::vector<BaseSchemaPtr> schemas;
+    auto add = [&](BaseSchemaPtr schema, bool is_key) {
+      schema->SetIndex(schemas.size());
+      schema->SetIsKey(is_key);
+      schema->SetAllowNull(!is_key);
+      schemas.push_back(schema);
+    };
+    add(std::make_shared<DingoSchema<int64_t>>(), true);
+    add(std::make_shared<DingoSchema<int64_t>>(), false);        // small counts
+    add(std::make_shared<DingoSchema<std::string>>(), false);    // a few colors
+    add(std::make_shared<DingoSchema<std::string>>(), false);    // 16 byte ids
+    add(std::make_shared<DingoSchema<double>>(), false);
+    add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false);  // times
+    add(std::make_shared<DingoSchema<bool>>(), false);
+    add(std::make_shared<DingoSchema<int64_t>>(), false);        // hashes
+    return schemas;
+  };
+  auto schemas = make_schemas();
+
+  const std::vector<std::string> colors{"crimson", "emerald", "sapphire"};
+  std::vector<std::vector<std::any>> records;
+  uint64_t hash = 88172645463325252ULL;
+  for (int i = 0; i < 64; ++i) {
+    hash ^= hash << 13;
+    hash ^= hash >> 7;
+    hash ^= hash << 17;
+    std::vector<std::any> record(schemas.size());
+    record[0] = int64_t(i);
+    record[1] = int64_t(i % 100);
+    record[2] = colors[i % 3];
+    std::string id(16, 'a');
+    id[15] += i % 26;
+    id[14] += i / 26;
+    record[3] = id;
+    record[4] = i * 0.5;
+    std::vector<int64_t> times;
+    for (int t = 0; t < 8; ++t) {
+      times.push_back(1700000000000LL + i * 1000 + t * 10);
+    }
+    record[5] = times;
+    if (i % 2 == 0) {
+      record[6] = i % 4 == 0;
+    }
+    record[7] = static_cast<int64_t>(hash | (uint64_t(1) << 62));
+    records.push_back(std::move(record));
+  }
+
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  EncodingAdvisor advisor(1, schemas, 5L, this->le);
+  size_t plain_bytes = 0;
+  for (const auto& record : records) {
+    std::string key, value;
+    re.Encode('r', record, key, value);
+    plain_bytes += value.size();
+    ASSERT_EQ(0, advisor.AddRow(key, value));
+  }
+  EXPECT_EQ(-1, advisor.AddRow("not a key", "not a value"));
+  EXPECT_EQ(64, advisor.RowCount());
+
+  auto advice = advisor.Advise();
+  EXPECT_EQ(64, advice.rows);
+  ASSERT_EQ(7, advice.columns.size());
+  auto column = [&](int index) -> const ColumnAdvice& {
+    return advice.columns[index - 1];
+  };
+  EXPECT_EQ(1, column(1).column);
+  EXPECT_EQ(ColumnEncoding::kVarint, column(1).recommended);
+  EXPECT_EQ(0, column(1).min_integer);
+  EXPECT_EQ(63, column(1).max_integer);
+  ASSERT_EQ(2, column(1).estimates.size());
+  EXPECT_EQ(64 * 8, column(1).estimates[0].bytes);
+  EXPECT_EQ(64, column(1).estimates[1].bytes);
+
+  EXPECT_EQ(ColumnEncoding::kDictionary, column(2).recommended);
+  EXPECT_EQ(3, column(2).distinct);
+  EXPECT_EQ(colors, column(2).dictionary);
+  EXPECT_EQ(7, column(2).min_length);
+  EXPECT_EQ(8, column(2).max_length);
+
+  EXPECT_EQ(ColumnEncoding::kFixedLength, column(3).recommended);
+  EXPECT_EQ(64, column(3).distinct);
+  EXPECT_TRUE(column(3).dictionary.empty());
+
+  EXPECT_EQ(ColumnEncoding::kPlain, column(4).recommended);
+  EXPECT_EQ(1, column(4).estimates.size());
+  EXPECT_EQ(0, column(4).min_real);
+  EXPECT_EQ(31.5, column(4).max_real);
+
+  EXPECT_EQ(ColumnEncoding::kDelta, column(5).recommended);
+  EXPECT_EQ(8, column(5).min_length);
+  EXPECT_EQ(1700000000000LL, column(5).min_integer);
+
+  EXPECT_EQ(32, column(6).nulls);
+  EXPECT_EQ(2, column(6).distinct);
+
+  // full width hashes lose to their varints.
+  EXPECT_EQ(ColumnEncoding::kPlain, column(7).recommended);
+
+  // the layouts with and without the compact header, bool bits as there is
+  // a bool column; the plain layout is the first.
+  ASSERT_EQ(10, advice.layouts.size());
+  EXPECT_EQ(plain_bytes, advice.layouts[0].bytes);
+  EXPECT_TRUE(advice.recommended_layout.compact_header);
+  for (const auto& layout : advice.layouts) {
+    EXPECT_LE(advice.recommended_layout.bytes, layout.bytes);
+  }
+  EXPECT_NE(std::string::npos, advice.ToString().find("-> dictionary"));
+
+  // a schema version with the advice applied, smaller and decoding alike.
+  auto advised = make_schemas();
+  advice.ApplyTo(advised);
+  RecordEncoderV2 advised_re(2, advised, 5L, this->le);
+  advice.ApplyTo(advised_re);
+  RecordDecoderV2 advised_rd(2, advised, 5L, this->le);
+  size_t advised_bytes = 0;
+  for (const auto& record : records) {
+    std::string key, value;
+    advised_re.Encode('r', record, key, value);
+    advised_bytes += value.size();
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, advised_rd.Decode(key, value, decoded));
+    EXPECT_EQ(std::any_cast<std::string>(record[2]), std::any_cast<std::string>(decoded[2]));
+    EXPECT_EQ(std::any_cast<std::string>(record[3]), std::any_cast<std::string>(decoded[3]));
+    EXPECT_EQ(std::any_cast<std::vector<int64_t>>(record[5]),
+              std::any_cast<std::vector<int64_t>>(decoded[5]));
+    EXPECT_EQ(std::any_cast<int64_t>(record[7]), std::any_cast<int64_t>(decoded[7]));
+    EXPECT_EQ(record[6].has_value(), decoded[6].has_value());
+  }
+  EXPECT_LT(advised_bytes * 5, plain_bytes * 3);
+}
+
+TEST_F(DingoSerialTest, recordRowCorpus) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schema->SetIsLe(this->le);
+    schema->SetName("c" + std::to_string(schemas.size()));
+    schemas.push_back(schema);
+  };
+  auto id = std::make_shared<DingoSchema<int64_t>>();
+  id->SetDescending(true);
+  add(id, true);
+  auto count = std::make_shared<DingoSchema<int64_t>>();
+  count->SetVarint(true);
+  count->SetAccessFrequency(-3);
+  add(count, false);
+  auto color = std::make_shared<DingoSchema<std::string>>();
+  color->SetDictionary(std::make_shared<StringDictionary>(
+      std::vector<std::string>{"red", "green"}));
+  color->SetColumnGroup(1);
+  add(color, false);
+  auto embedding = std::make_shared<DingoSchema<std::vector<float>>>();
+  embedding->SetQuantization(FloatQuantization::kBf16);
+  add(embedding, false);
+  auto flags = std::make_shared<DingoSchema<std::vector<bool>>>();
+  flags->SetPacked(true);
+  add(flags, false);
+  auto uuid = std::make_shared<DingoSchema<std::string>>();
+  uuid->SetFixedLength(4);
+  add(uuid, false);
+
+  RecordEncoderV2 re(3, schemas, -5L, this->le);
+  re.SetNullBitmap(true);
+  RowCorpusWriter writer(3, schemas, -5L, this->le);
+  writer.SetSampleRate(2);
+  std::vector<std::vector<std::any>> records;
+  for (int i = 0; i < 10; ++i) {
+    std::vector<std::any> record(schemas.size());
+    record[0] = int64_t(i);
+    record[1] = int64_t(i * 3);
+    if (i % 3 != 0) {
+      record[2] = std::string(i % 2 == 0 ? "red" : "blue");
+    }
+    record[3] = std::vector<float>{1.0f, -2.0f, 0.5f * i};
+    record[4] = std::vector<bool>{true, i % 2 == 0, false};
+    record[5] = std::string("id") + char('0' + i) + char('a' + i);
+    std::string key, value;
+    re.Encode('r', record, key, value);
+    EXPECT_EQ(i % 2 == 1, writer.Sample(key, value));
+    if (i % 2 == 1) {
+      records.push_back(std::move(record));
+    }
+  }
+  EXPECT_EQ(5, writer.RowCount());
+
+  std::string data = "prefix";
+  size_t size = writer.Write(data);
+  EXPECT_EQ(data.size() - 6, size);
+  std::string_view corpus_bytes = std::string_view(data).substr(6);
+
+  RowCorpus corpus;
+  ASSERT_EQ(0, corpus.Open(corpus_bytes));
+  EXPECT_EQ(3, corpus.SchemaVersion());
+  EXPECT_EQ(-5L, corpus.CommonId());
+  EXPECT_EQ(this->le, corpus.IsLe());
+  ASSERT_EQ(schemas.size(), corpus.Schemas().size());
+  for (size_t i = 0; i < schemas.size(); ++i) {
+    const auto& schema = corpus.Schemas()[i];
+    EXPECT_EQ(schemas[i]->GetType(), schema->GetType());
+    EXPECT_EQ(schemas[i]->GetIndex(), schema->GetIndex());
+    EXPECT_EQ(schemas[i]->GetName(), schema->GetName());
+    EXPECT_EQ(schemas[i]->IsKey(), schema->IsKey());
+    EXPECT_EQ(schemas[i]->AllowNull(), schema->AllowNull());
+    EXPECT_EQ(schemas[i]->IsDescending(), schema->IsDescending());
+    EXPECT_EQ(schemas[i]->GetColumnGroup(), schema->GetColumnGroup());
+    EXPECT_EQ(schemas[i]->GetAccessFrequency(), schema->GetAccessFrequency());
+    EXPECT_EQ(this->le, schema->IsLe());
+  }
+  auto* read_count =
+      static_cast<DingoSchema<int64_t>*>(corpus.Schemas()[1].get());
+  EXPECT_TRUE(read_count->IsVarint());
+  auto* read_color =
+      static_cast<DingoSchema<std::string>*>(corpus.Schemas()[2].get());
+  ASSERT_NE(nullptr, read_color->GetDictionary());
+  EXPECT_EQ(color->GetDictionary()->Values(),
+            read_color->GetDictionary()->Values());
+  auto* read_embedding =
+      static_cast<DingoSchema<std::vector<float>>*>(corpus.Schemas()[3].get());
+  EXPECT_EQ(FloatQuantization::kBf16, read_embedding->GetQuantization());
+  auto* read_flags =
+      static_cast<DingoSchema<std::vector<bool>>*>(corpus.Schemas()[4].get());
+  EXPECT_TRUE(read_flags->IsPacked());
+  auto* read_uuid =
+      static_cast<DingoSchema<std::string>*>(corpus.Schemas()[5].get());
+  EXPECT_EQ(4, read_uuid->GetFixedLength());
+
+  // the rows are views into the corpus and decode alike with its schemas.
+  RecordDecoderV2 rd(3, schemas, -5L, this->le);
+  RecordDecoderV2 corpus_rd(corpus.SchemaVersion(), corpus.Schemas(),
+                            corpus.CommonId(), corpus.IsLe());
+  ASSERT_EQ(5, corpus.RowCount());
+  for (size_t r = 0; r < corpus.RowCount(); ++r) {
+    EXPECT_GE(corpus.Key(r).data(), corpus_bytes.data());
+    EXPECT_LT(corpus.Value(r).data(), corpus_bytes.data() + size);
+    std::vector<std::any> expected;
+    std::vector<std::any> decoded;
+    ASSERT_EQ(0, rd.Decode(corpus.Key(r), corpus.Value(r), expected));
+    ASSERT_EQ(0, corpus_rd.Decode(corpus.Key(r), corpus.Value(r), decoded));
+    const auto& record = records[r];
+    EXPECT_EQ(std::any_cast<int64_t>(record[0]),
+              std::any_cast<int64_t>(decoded[0]));
+    EXPECT_EQ(std::any_cast<int64_t>(record[1]),
+              std::any_cast<int64_t>(decoded[1]));
+    ASSERT_EQ(record[2].has_value(), decoded[2].has_value());
+    if (record[2].has_value()) {
+      EXPECT_EQ(std::any_cast<std::string>(record[2]),
+                std::any_cast<std::string>(decoded[2]));
+    }
+    EXPECT_EQ(std::any_cast<std::vector<float>>(expected[3]),
+              std::any_cast<std::vector<float>>(decoded[3]));
+    EXPECT_EQ(std::any_cast<std::vector<bool>>(record[4]),
+              std::any_cast<std::vector<bool>>(decoded[4]));
+    EXPECT_EQ(std::any_cast<std::string>(record[5]),
+              std::any_cast<std::string>(decoded[5]));
+  }
+
+  // every truncation, a trailing byte, another magic or version fail.
+  for (size_t len = 0; len < corpus_bytes.size(); ++len) {
+    EXPECT_EQ(-1, corpus.Open(corpus_bytes.substr(0, len))) << len;
+    EXPECT_EQ(0, corpus.RowCount());
+    EXPECT_TRUE(corpus.Schemas().empty());
+  }
+  std::string bad(corpus_bytes);
+  bad.push_back(0);
+  EXPECT_EQ(-1, corpus.Open(bad));
+  bad = std::string(corpus_bytes);
+  bad[0] = 'X';
+  EXPECT_EQ(-1, corpus.Open(bad));
+  bad = std::string(corpus_bytes);
+  bad[4] = RowCorpus::kVersion + 1;
+  EXPECT_EQ(-1, corpus.Open(bad));
+
+  // no rows, no schemas.
+  RowCorpusWriter empty_writer(1, {}, 0L, this->le);
+  std::string empty;
+  empty_writer.Write(empty);
+  ASSERT_EQ(0, corpus.Open(empty));
+  EXPECT_EQ(0, corpus.RowCount());
+  EXPECT_TRUE(corpus.Schemas().empty());
+  writer.Clear();
+  EXPECT_EQ(0, writer.RowCount());
+}
+
+TEST_F(DingoSerialTest, recordValueChecksum) {
+  // the check values of CRC-32C, RFC 3720 B.4.
+  std::string digits = "123456789";
+  EXPECT_EQ(0xE3069283u, Crc32c(digits.data(), digits.size()));
+  std::string zeros(32, '\0');
+  EXPECT_EQ(0x8A9136AAu, Crc32c(zeros.data(), zeros.size()));
+  std::string ones(32, '\xFF');
+  EXPECT_EQ(0x62A8AB43u, Crc32c(ones.data(), ones.size()));
+  std::string ascending(32, '\0');
+  for (int i = 0; i < 32; ++i) {
+    ascending[i] = static_cast<char>(i);
+  }
+  EXPECT_EQ(0x46DD794Eu, Crc32c(ascending.data(), ascending.size()));
+
+  // the instructions, when the host has them, agree with the tables past
+  // the interleaved blocks, at any alignment and chained.
+  std::string random(5000, '\0');
+  uint32_t seed = 7;
+  for (auto& c : random) {
+    seed = seed * 1103515245 + 12345;
+    c = static_cast<char>(seed >> 16);
+  }
+  for (size_t len : {0, 1, 7, 8, 9, 511, 1535, 1536, 1537, 3072, 4999}) {
+    for (size_t offset : {0, 1, 3}) {
+      const char* data = random.data() + offset;
+      uint32_t crc = Crc32cSoftware(data, len);
+      ASSERT_EQ(crc, Crc32c(data, len)) << len << " at " << offset;
+      size_t half = len / 2;
+      EXPECT_EQ(crc, Crc32c(data + half, len - half, Crc32c(data, half)));
+      EXPECT_EQ(crc, Crc32cSoftware(data + half, len - half,
+                                    Crc32cSoftware(data, half)));
+    }
+  }
+
+  InitVector();
+  auto schemas = GetSchemas();
+  InitRecord();
+  auto record1 = GetRecord();
+
+  RecordDecoderV2 rd(0, schemas, 0L, this->le);
+  RecordDecoderV2 verify_rd(0, schemas, 0L, this->le);
+  EXPECT_FALSE(verify_rd.IsVerifyingChecksums());
+  verify_rd.SetVerifyChecksums(true);
+  EXPECT_TRUE(verify_rd.IsVerifyingChecksums());
+  EXPECT_TRUE(verify_rd.IsTrustedInput());
+
+  for (int layout = 0; layout < 3; ++layout) {
+    for (bool compact : {false, true}) {
+      for (bool compress : {false, true}) {
+        RecordEncoderV2 plain_re(0, schemas, 0L, this->le);
+        RecordEncoderV2 re(0, schemas, 0L, this->le);
+        for (auto* encoder : {&plain_re, &re}) {
+          encoder->SetCompactValueHeader(compact);
+          encoder->SetNullBitmap(layout == 1);
+          encoder->SetStaticOffsets(layout == 2);
+          if (compress) {
+            encoder->SetCompression(CompressionType::kZlib, 0);
+          }
+        }
+        re.SetChecksum(true);
+        std::string key, plain, value;
+        plain_re.Encode('r', record1, key, plain);
+        re.Encode('r', record1, key, value);
+        ASSERT_EQ(plain.size() + kValueChecksumSize, value.size());
+        if (!compress) {
+          EXPECT_EQ(value.size(), re.EncodedValueSize(record1));
+        }
+        int format = PeekValueFormat(value, this->le);
+        EXPECT_TRUE(format & VALUE_FORMAT_CHECKSUM);
+        EXPECT_EQ(compress, (format & VALUE_FORMAT_COMPRESSED) != 0);
+        EXPECT_EQ(1, VerifyValueChecksum(value, this->le));
+        EXPECT_EQ(0, VerifyValueChecksum(plain, this->le));
+
+        std::vector<std::any> expected, checked, verified;
+        ASSERT_EQ(0, rd.Decode(key, plain, expected));
+        ASSERT_EQ(0, rd.Decode(key, value, checked));
+        ASSERT_EQ(0, verify_rd.Decode(key, value, verified));
+        for (const auto* decoded : {&checked, &verified}) {
+          ASSERT_EQ(expected.size(), decoded->size());
+          EXPECT_EQ(std::any_cast<int32_t>(expected.at(8)),
+                    std::any_cast<int32_t>(decoded->at(8)));
+          EXPECT_EQ(std::any_cast<int64_t>(expected.at(9)),
+                    std::any_cast<int64_t>(decoded->at(9)));
+          EXPECT_EQ(std::any_cast<std::string>(expected.at(4)),
+                    std::any_cast<std::string>(decoded->at(4)));
+        }
+
+        // any flipped bit is caught before the unchecked reads.
+        for (size_t i = 0; i < value.size(); i += 3) {
+          std::string corrupt = value;
+          corrupt[i] ^= 0x10;
+          EXPECT_EQ(-1, VerifyValueChecksum(corrupt, this->le)) << i;
+          std::vector<std::any> rejected;
+          EXPECT_EQ(-1, verify_rd.Decode(key, corrupt, rejected)) << i;
+        }
+        std::vector<std::any> rejected;
+        EXPECT_EQ(-1, verify_rd.Decode(key, plain, rejected));
+
+        // an update carries a checksum of its own.
+        std::string updated;
+        ASSERT_LT(0, re.UpdateValue(value, {{8, int32_t(9)}}, updated));
+        EXPECT_EQ(1, VerifyValueChecksum(updated, this->le));
+        std::vector<std::any> update_decoded;
+        ASSERT_EQ(0, verify_rd.Decode(key, updated, update_decoded));
+        EXPECT_EQ(9, std::any_cast<int32_t>(update_decoded.at(8)));
+        ASSERT_LT(0, plain_re.UpdateValue(value, {{8, int32_t(9)}}, updated));
+        EXPECT_EQ(0, VerifyValueChecksum(updated, this->le));
+        ASSERT_EQ(0, rd.Decode(key, updated, update_decoded));
+        EXPECT_EQ(9, std::any_cast<int32_t>(update_decoded.at(8)));
+
+        if (!compress) {
+          bool is_null = true;
+          ASSERT_EQ(0, PeekIsNull(value, this->le, 8, is_null));
+          EXPECT_FALSE(is_null);
+        }
+      }
+    }
+  }
+
+  // the byte rewrites would leave the trailer stale.
+  RecordEncoderV2 re(0, schemas, 0L, this->le);
+  re.SetChecksum(true);
+  std::string key, value;
+  re.Encode('r', record1, key, value);
+  std::vector<int> id_map(schemas.size());
+  for (size_t i = 0; i < id_map.size(); ++i) {
+    id_map[i] = i;
+  }
+  ValueRewriter rewriter(id_map, this->le);
+  std::string rewritten;
+  EXPECT_EQ(-1, rewriter.Rewrite(value, rewritten));
+  int32_t version;
+  std::vector<ValueSpan> spans;
+  EXPECT_EQ(-1, ReadValueSpans(value, this->le, version, spans));
+
+  // too short for its trailer.
+  std::string cut = value.substr(0, 6);
+  EXPECT_EQ(-1, VerifyValueChecksum(cut, this->le));
+
+  DeleteSchemas();
+  DeleteRecords();
+}
+
+TEST_F(DingoSerialTest, recordChunkedDecode) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  auto tags = std::make_shared<DingoSchema<std::vector<int64_t>>>();
+  tags->SetDeltaEncoded(true);
+  add(tags, false);
+  add(std::make_shared<DingoSchema<double>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<bool>>(), false);
+
+  std::vector<int64_t> long_tags;
+  for (int64_t i = 0; i < 2000; ++i) {
+    long_tags.push_back(i * i * 1000);
+  }
+  std::vector<std::vector<std::any>> records{
+      {int64_t(7), std::string(8000, 'n'), long_tags, 2.5, std::string("k"),
+       std::string("note"), true},
+      {int64_t(-3), std::any(), std::any(), 1.0, std::string("k2"),
+       std::any(), std::any()},
+      {int64_t(0), std::string(), std::vector<int64_t>{}, std::any(),
+       std::string(), std::string(300, 'x'), false}};
+
+  RecordDecoderV2 rd(0, schemas, 9L, this->le);
+  ChunkedValueDecoder chunked(rd);
+  for (int layout = 0; layout < 7; ++layout) {
+    RecordEncoderV2 re(0, schemas, 9L, this->le);
+    re.SetCompactValueHeader(layout == 1);
+    re.SetNullBitmap(layout == 2);
+    re.SetSparseValues(layout == 3);
+    re.SetStaticOffsets(layout == 4);
+    if (layout == 5) {
+      re.SetCompression(CompressionType::kZlib, 0);
+    }
+    re.SetChecksum(layout == 6);
+    bool streamed = layout < 4;
+
+    for (const auto& record : records) {
+      std::string key, value;
+      re.Encode('r', record, key, value);
+      std::vector<ColumnValue> expected;
+      ASSERT_EQ(0, rd.Decode(key, value, expected));
+
+      for (size_t chunk : {size_t(1), size_t(7), size_t(1000), value.size()}) {
+        AnyRowSink sink(schemas.size());
+        ASSERT_EQ(0, chunked.Begin(key, sink));
+        for (size_t pos = 0; pos < value.size(); pos += chunk) {
+          ASSERT_EQ(0, chunked.Append(value.substr(pos, chunk)))
+              << layout << " " << chunk;
+        }
+        ASSERT_EQ(0, chunked.Finish()) << layout << " " << chunk;
+        EXPECT_EQ(5, chunked.DecodedColumns());
+        EXPECT_EQ(0, chunked.BufferedBytes());
+        for (size_t i = 0; i < schemas.size(); ++i) {
+          EXPECT_EQ(1, sink.seen.at(i)) << layout << " " << i;
+        }
+        EXPECT_EQ(expected, FromAny(sink.record)) << layout << " " << chunk;
+        if (streamed && chunk < 1000 && &record == &records[0]) {
+          // the string and the list are let go once the next column is in.
+          EXPECT_LT(chunked.PeakBufferedBytes(), value.size() - 4000);
+        }
+        if (!streamed) {
+          EXPECT_EQ(value.size(), chunked.PeakBufferedBytes());
+        }
+      }
+
+      // the columns of a streamed value go to the sink before it is whole.
+      AnyRowSink sink(schemas.size());
+      ASSERT_EQ(0, chunked.Begin(key, sink));
+      ASSERT_EQ(0, chunked.Append(value.substr(0, value.size() - 1)));
+      if (streamed) {
+        EXPECT_EQ(1, sink.seen.at(0));
+        EXPECT_EQ(1, sink.seen.at(4));
+        EXPECT_GE(chunked.DecodedColumns(), 4);
+      } else {
+        EXPECT_EQ(0, chunked.DecodedColumns());
+      }
+      ASSERT_EQ(0, chunked.Append(value.substr(value.size() - 1)));
+      ASSERT_EQ(0, chunked.Finish());
+      EXPECT_EQ(expected, FromAny(sink.record));
+    }
+  }
+
+  // a key of another table, a newer schema version, a truncated value.
+  RecordEncoderV2 re(0, schemas, 9L, this->le);
+  std::string key, value;
+  re.Encode('r', records[0], key, value);
+  AnyRowSink sink(schemas.size());
+  RecordEncoderV2 other_re(0, schemas, 10L, this->le);
+  std::string other_key, other_value;
+  other_re.Encode('r', records[0], other_key, other_value);
+  EXPECT_EQ(-1, chunked.Begin(other_key, sink));
+  EXPECT_EQ(-1, chunked.Append(other_value));
+  EXPECT_EQ(-1, chunked.Finish());
+
+  RecordEncoderV2 newer_re(3, schemas, 9L, this->le);
+  std::string newer_key, newer_value;
+  newer_re.Encode('r', records[0], newer_key, newer_value);
+  ASSERT_EQ(0, chunked.Begin(newer_key, sink));
+  EXPECT_EQ(0, chunked.Append(newer_value.substr(0, 2)));
+  EXPECT_EQ(-1, chunked.Append(newer_value.substr(2, 2)));
+  EXPECT_EQ(-1, chunked.Append(newer_value.substr(4)));
+
+  ASSERT_EQ(0, chunked.Begin(key, sink));
+  ASSERT_EQ(0, chunked.Append(value.substr(0, 6)));
+  EXPECT_EQ(-1, chunked.Finish());
+  ASSERT_EQ(0, chunked.Begin(key, sink));
+  ASSERT_EQ(0, chunked.Append(value.substr(0, value.size() / 2)));
+  EXPECT_EQ(-1, chunked.Finish());
+
+  // a decoder verifying checksums takes checksummed values only.
+  RecordDecoderV2 verify_rd(0, schemas, 9L, this->le);
+  verify_rd.SetVerifyChecksums(true);
+  ChunkedValueDecoder verify_chunked(verify_rd);
+  ASSERT_EQ(0, verify_chunked.Begin(key, sink));
+  EXPECT_EQ(-1, verify_chunked.Append(value));
+}
+
+TEST_F(DingoSerialTest, recordStorageAnalyzer) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key, bool allow_null) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(allow_null);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true, false);
+  add(std::make_shared<DingoSchema<std::string>>(), true, true);
+  add(std::make_shared<DingoSchema<std::string>>(), false, true);
+  add(std::make_shared<DingoSchema<int64_t>>(), false, true);
+  add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false, true);
+  add(std::make_shared<DingoSchema<double>>(), false, true);
+
+  std::vector<std::vector<std::any>> records;
+  for (int64_t i = 0; i < 40; ++i) {
+    std::vector<std::any> record(schemas.size());
+    record[0] = i;
+    record[1] = std::string(i % 20, 'k');
+    record[2] = std::string("name-") + std::to_string(i);
+    if (i % 4 != 0) {
+      record[3] = i * 3;
+      record[4] = std::vector<int64_t>(i % 5, i);
+    }
+    record[5] = i * 0.5;
+    records.push_back(record);
+  }
+
+  for (int layout = 0; layout < 5; ++layout) {
+    RecordEncoderV2 re(2, schemas, 11L, this->le);
+    re.SetCompactValueHeader(layout == 1);
+    re.SetNullBitmap(layout == 2);
+    re.SetStaticOffsets(layout == 3);
+    if (layout == 4) {
+      re.SetCompression(CompressionType::kZlib, 0);
+      re.SetChecksum(true);
+    }
+    StorageAnalyzer analyzer(2, schemas, 11L, this->le);
+    std::vector<std::string> keys(records.size());
+    std::vector<std::string> values(records.size());
+    size_t key_bytes = 0;
+    size_t value_bytes = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+      re.Encode('r', records[i], keys[i], values[i]);
+      ASSERT_EQ(0, analyzer.AddRow(keys[i], values[i]));
+      key_bytes += keys[i].size();
+      value_bytes += values[i].size();
+    }
+    const StorageAnalysis& analysis = analyzer.Analyze();
+    ASSERT_EQ(records.size(), analysis.rows);
+    EXPECT_EQ(key_bytes, analysis.key_bytes);
+    EXPECT_EQ(value_bytes, analysis.stored_value_bytes);
+
+    // the parts add up to the rows, the value inflated.
+    const StorageBreakdown& bytes = analysis.bytes;
+    EXPECT_EQ(9 * records.size(), bytes.key_prefix);
+    EXPECT_EQ(4 * records.size(), bytes.codec_version);
+    EXPECT_EQ(analysis.key_bytes + analysis.value_bytes + bytes.checksum,
+              bytes.Total())
+        << layout;
+    if (layout == 4) {
+      EXPECT_EQ(records.size(), analysis.compressed_values);
+      EXPECT_EQ(4 * records.size(), bytes.checksum);
+    } else {
+      EXPECT_EQ(value_bytes, analysis.value_bytes);
+      EXPECT_EQ(0, bytes.checksum);
+    }
+    EXPECT_EQ(layout == 3 ? records.size() : 0, analysis.unattributed_values);
+
+    ASSERT_EQ(schemas.size(), analysis.columns.size());
+    StorageBreakdown key_columns;
+    for (const auto& column : analysis.columns) {
+      EXPECT_EQ(records.size(), column.rows);
+      if (column.is_key) {
+        key_columns.Add(column.bytes);
+      }
+    }
+    EXPECT_EQ(key_bytes - 13 * records.size(), key_columns.Total());
+    // the id is 8 bytes, the nullable key string a flag then its groups.
+    EXPECT_EQ(8 * records.size(), analysis.columns[0].bytes.payload);
+    EXPECT_EQ(records.size(), analysis.columns[1].bytes.null_flags);
+    size_t key_string = 0;
+    for (const auto& record : records) {
+      key_string += std::any_cast<const std::string&>(record[1]).size();
+    }
+    EXPECT_EQ(key_string, analysis.columns[1].bytes.payload);
+    EXPECT_GT(analysis.columns[1].bytes.string_padding, 0);
+    EXPECT_EQ(10, analysis.columns[3].nulls);
+    EXPECT_EQ(10, analysis.columns[4].nulls);
+
+    if (layout != 3) {
+      // a value column's data is its encoded value.
+      size_t name_bytes = 0;
+      for (const auto& record : records) {
+        name_bytes += schemas[2]->GetEncodedValueLength(record[2]);
+      }
+      EXPECT_EQ(name_bytes, analysis.columns[2].bytes.payload) << layout;
+      StorageBreakdown value_columns;
+      for (size_t i = 2; i < schemas.size(); ++i) {
+        value_columns.Add(analysis.columns[i].bytes);
+      }
+      EXPECT_EQ(bytes.payload - key_columns.payload, value_columns.payload);
+      EXPECT_EQ(bytes.null_entries - key_columns.null_entries,
+                value_columns.null_entries);
+      // the plain tables list the nulls, the null bitmap leaves them out.
+      EXPECT_EQ(layout == 0 || layout == 4 ? 20 * 6
+                    : layout == 1        ? 20 * 3
+                                         : 0,
+                value_columns.null_entries)
+          << layout;
+    }
+
+    // the estimates of a layout match what the encoder writes.
+    ASSERT_EQ(6, analysis.header_estimates.size());
+    if (layout < 3) {
+      int estimate = layout == 0 ? 0 : layout == 1 ? 1 : 4;
+      EXPECT_EQ(bytes.value_header + bytes.null_entries -
+                    key_columns.null_entries,
+                analysis.header_estimates[estimate].bytes)
+          << layout;
+      EXPECT_LT(analysis.header_estimates[1].bytes,
+                analysis.header_estimates[0].bytes);
+      EXPECT_LT(analysis.header_estimates[4].bytes,
+                analysis.header_estimates[0].bytes);
+    }
+    EXPECT_FALSE(analysis.ToString().empty());
+  }
+
+  // a key of another table changes nothing.
+  StorageAnalyzer analyzer(2, schemas, 11L, this->le);
+  RecordEncoderV2 other_re(2, schemas, 12L, this->le);
+  std::string key, value;
+  other_re.Encode('r', records[1], key, value);
+  EXPECT_EQ(-1, analyzer.AddRow(key, value));
+  EXPECT_EQ(0, analyzer.RowCount());
+  EXPECT_EQ(0, analyzer.Analyze().bytes.Total());
+}
+
+TEST_F(DingoSerialTest, recordRowFile) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<std::vector<int64_t>>>(), false);
+  add(std::make_shared<DingoSchema<double>>(), false);
+
+  // the rows in key order, every third value compressed.
+  RecordEncoderV2 re(1, schemas, 21L, this->le);
+  RecordEncoderV2 compressed_re(1, schemas, 21L, this->le);
+  compressed_re.SetCompression(CompressionType::kZlib, 0);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (int64_t i = 0; i < 500; ++i) {
+    std::vector<std::any> record(schemas.size());
+    record[0] = i * 2;
+    record[1] = std::string(i % 50, 'a' + i % 26);
+    if (i % 5 != 0) {
+      record[2] = std::vector<int64_t>(i % 7, i);
+    }
+    record[3] = i * 0.5;
+    std::string key, value;
+    (i % 3 == 0 ? compressed_re : re).Encode('r', record, key, value);
+    keys.push_back(key);
+    values.push_back(value);
+  }
+
+  RowFileWriter writer(1, schemas, 21L, this->le);
+  writer.SetBlockSize(1024);
+  std::string file;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_EQ(0, writer.Add(keys[i], values[i]));
+    if (i % 100 == 99) {
+      writer.Flush(file);
+    }
+  }
+  EXPECT_EQ(-1, writer.Add(keys[10], values[10]));
+  EXPECT_EQ(keys.size(), writer.RowCount());
+  writer.Finish(file);
+  EXPECT_EQ(0, writer.RowCount());
+
+  RowFileReader reader;
+  ASSERT_EQ(0, reader.Open(file));
+  reader.SetVerifyChecksums(true);
+  EXPECT_EQ(1, reader.SchemaVersion());
+  EXPECT_EQ(21L, reader.CommonId());
+  EXPECT_EQ(this->le, reader.IsLe());
+  ASSERT_EQ(schemas.size(), reader.Schemas().size());
+  EXPECT_EQ(keys.size(), reader.RowCount());
+  EXPECT_GT(reader.BlockCount(), 10);
+  size_t key_bytes = 0;
+  size_t value_bytes = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    key_bytes += keys[i].size();
+    value_bytes += values[i].size();
+  }
+  EXPECT_EQ(key_bytes, reader.KeyBytes());
+  EXPECT_EQ(value_bytes, reader.ValueBytes());
+
+  // every row as written, decoded with the schemas of the footer.
+  RecordDecoderV2 rd(1, schemas, 21L, this->le);
+  RecordDecoderV2 file_rd(reader.SchemaVersion(), reader.Schemas(),
+                          reader.CommonId(), reader.IsLe());
+  RowFileReader::Iterator it(reader);
+  size_t row = 0;
+  for (it.SeekToFirst(); it.Valid(); it.Next(), ++row) {
+    ASSERT_LT(row, keys.size());
+    ASSERT_EQ(keys[row], it.Key());
+    ASSERT_EQ(values[row], it.Value());
+    std::vector<ColumnValue> expected, actual;
+    ASSERT_EQ(0, rd.Decode(keys[row], values[row], expected));
+    ASSERT_EQ(0, file_rd.Decode(it.Key(), it.Value(), actual));
+    EXPECT_EQ(expected, actual);
+  }
+  EXPECT_EQ(keys.size(), row);
+  EXPECT_EQ(0, it.Status());
+
+  // seeks to a key, between keys, before the first and past the last.
+  for (size_t i : {size_t(0), size_t(1), size_t(137), size_t(499)}) {
+    it.Seek(keys[i]);
+    ASSERT_TRUE(it.Valid());
+    EXPECT_EQ(keys[i], it.Key());
+    std::string between = keys[i];
+    between.back()++;
+    it.Seek(between);
+    if (i + 1 < keys.size()) {
+      ASSERT_TRUE(it.Valid());
+      EXPECT_EQ(keys[i + 1], it.Key());
+    } else {
+      EXPECT_FALSE(it.Valid());
+    }
+  }
+  it.Seek(std::string(1, '\0'));
+  ASSERT_TRUE(it.Valid());
+  EXPECT_EQ(keys[0], it.Key());
+  it.Seek(std::string(40, '\xFF'));
+  EXPECT_FALSE(it.Valid());
+  EXPECT_EQ(reader.BlockCount(), reader.SeekBlock(std::string(40, '\xFF')));
+
+  // a key range, and a scan stopped early.
+  std::vector<std::string_view> scanned;
+  EXPECT_EQ(150, reader.Scan(keys[100], keys[250],
+                             [&](std::string_view key, std::string_view) {
+                               scanned.push_back(key);
+                               return true;
+                             }));
+  ASSERT_EQ(150, scanned.size());
+  EXPECT_EQ(keys[100], scanned.front());
+  EXPECT_EQ(keys[249], scanned.back());
+  EXPECT_EQ(3, reader.Scan("", "", [](std::string_view, std::string_view) {
+    static int left = 3;
+    return --left > 0;
+  }));
+
+  // blocks read by four workers, each row once.
+  std::vector<std::atomic<int>> seen(keys.size());
+  ParallelOptions options;
+  options.thread_count = 4;
+  EXPECT_EQ(keys.size(),
+            reader.ParallelScan(options, [&](size_t block, std::string_view key,
+                                             std::string_view value) {
+              EXPECT_LT(block, reader.BlockCount());
+              std::vector<std::any> record;
+              ASSERT_EQ(0, file_rd.Decode(key, value, record));
+              size_t r = std::any_cast<int64_t>(record[0]) / 2;
+              ASSERT_EQ(keys[r], key);
+              seen[r]++;
+            }));
+  for (const auto& count : seen) {
+    EXPECT_EQ(1, count.load());
+  }
+
+  // the file mapped from disk.
+  char name[] = "/tmp/dingo_serial_row_file_XXXXXX";
+  int fd = mkstemp(name);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(file.size(), write(fd, file.data(), file.size()));
+  close(fd);
+  RowFileReader mapped;
+  ASSERT_EQ(0, mapped.OpenFile(name));
+  unlink(name);
+  EXPECT_EQ(keys.size(), mapped.RowCount());
+  RowFileReader::Iterator mapped_it(mapped);
+  mapped_it.Seek(keys[321]);
+  ASSERT_TRUE(mapped_it.Valid());
+  EXPECT_EQ(values[321], mapped_it.Value());
+  EXPECT_EQ(-1, mapped.OpenFile("/nonexistent/dingo_serial_row_file"));
+
+  // a block damaged fails its CRC when verified, a cut file fails to open.
+  std::string damaged = file;
+  damaged[reader.Block(3).offset + 2] ^= 0x40;
+  RowFileReader damaged_reader;
+  ASSERT_EQ(0, damaged_reader.Open(damaged));
+  damaged_reader.SetVerifyChecksums(true);
+  std::vector<std::string_view> block_keys, block_values;
+  EXPECT_EQ(0, damaged_reader.ReadBlock(2, block_keys, block_values));
+  EXPECT_EQ(-1, damaged_reader.ReadBlock(3, block_keys, block_values));
+  EXPECT_EQ(-1, damaged_reader.Scan("", "", [](std::string_view,
+                                               std::string_view) {
+    return true;
+  }));
+  EXPECT_EQ(-1, damaged_reader.ParallelScan(
+                    options, [](size_t, std::string_view, std::string_view) {}));
+  EXPECT_EQ(-1, RowFileReader().Open(file.substr(0, file.size() - 1)));
+  EXPECT_EQ(-1, RowFileReader().Open(file.substr(1)));
+
+  // a file without rows.
+  std::string empty;
+  RowFileWriter(1, schemas, 21L, this->le).Finish(empty);
+  RowFileReader empty_reader;
+  ASSERT_EQ(0, empty_reader.Open(empty));
+  EXPECT_EQ(0, empty_reader.BlockCount());
+  RowFileReader::Iterator empty_it(empty_reader);
+  empty_it.SeekToFirst();
+  EXPECT_FALSE(empty_it.Valid());
+}
+
+TEST_F(DingoSerialTest, recordNegativeValueOffset) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int64_t>>(), true);
+  add(std::make_shared<DingoSchema<int64_t>>(), false);
+  add(std::make_shared<DingoSchema<std::string>>(), false);
+  add(std::make_shared<DingoSchema<int32_t>>(), false);
+
+  std::vector<std::any> record{int64_t(1), int64_t(2), std::string("abc"),
+                               int32_t(3)};
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  RecordDecoderV2 rd(1, schemas, 5L, this->le);
+  std::string key, value;
+  re.Encode('r', record, key, value);
+
+  BufView view(value, this->le);
+  int32_t version = view.ReadInt();
+  ValueHeader header(view, GetValueFormat(version));
+  ASSERT_EQ(4, header.offset_unit);
+  ASSERT_EQ(3, header.entry_cnt);
+
+  // an offset a little below 0 wraps to a small one when added to a width
+  // as size_t, every column must still be refused.
+  for (int entry = 0; entry < header.entry_cnt; ++entry) {
+    for (int32_t offset : {-2, -4, -8, INT32_MIN}) {
+      std::string crafted = value;
+      Buf offset_buf(4, this->le);
+      offset_buf.WriteInt(offset);
+      memcpy(crafted.data() + header.offset_pos + entry * 4,
+             offset_buf.Data(), 4);
+      std::vector<std::any> decoded;
+      EXPECT_THROW(rd.Decode(key, crafted, decoded), std::exception)
+          << "entry " << entry << " offset " << offset;
+    }
+  }
+
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(key, value, decoded));
+  EXPECT_EQ("abc", std::any_cast<std::string>(decoded[2]));
+}
+
+TEST_F(DingoSerialTest, recordStaticOffsetsVarint) {
+  std::vector<BaseSchemaPtr> schemas;
+  auto add = [&](BaseSchemaPtr schema, bool is_key) {
+    schema->SetIndex(schemas.size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(!is_key);
+    schemas.push_back(schema);
+  };
+  add(std::make_shared<DingoSchema<int32_t>>(), true);
+  auto varint = std::make_shared<DingoSchema<int32_t>>();
+  varint->SetVarint(true);
+  add(varint, false);
+  add(std::make_shared<DingoSchema<int64_t>>(), false);
+
+  RecordEncoderV2 re(1, schemas, 5L, this->le);
+  re.SetStaticOffsets(true);
+  RecordDecoderV2 rd(1, schemas, 5L, this->le);
+  std::vector<std::any> record{int32_t(1), int32_t(300), int64_t(7)};
+  std::string key, value;
+  ASSERT_EQ(0, re.Encode('r', record, key, value));
+  EXPECT_EQ(value.size(), re.EncodedValueSize(record));
+
+  std::vector<std::any> decoded;
+  ASSERT_EQ(0, rd.Decode(key, value, decoded));
+  EXPECT_EQ(300, std::any_cast<int32_t>(decoded[1]));
+  EXPECT_EQ(7, std::any_cast<int64_t>(decoded[2]));
+
+  // the varint grows, then shrinks, the fixed slot stays put.
+  for (int32_t data : {int32_t(1) << 20, -1, 0}) {
+    std::string updated;
+    ASSERT_LT(0, re.UpdateValue(value, {{1, data}, {2, int64_t(-9)}},
+                                updated));
+    std::string expected;
+    re.EncodeValue(std::vector<std::any>{int32_t(1), data, int64_t(-9)},
+                   expected);
+    EXPECT_EQ(expected, updated) << data;
+    ASSERT_EQ(0, rd.Decode(key, updated, decoded));
+    EXPECT_EQ(data, std::any_cast<int32_t>(decoded[1]));
+  }
+
+  std::optional<int64_t> number;
+  ASSERT_EQ(0, rd.Peek(rd.NewColumnPeek(2), value, number));
+  EXPECT_EQ(7, number);
+  ASSERT_EQ(0, rd.Peek(rd.NewColumnPeek(1), value, number));
+  EXPECT_EQ(300, number);
+}